@@ -98,6 +98,10 @@ buildtc_xibase_src_ex   = tc_main.c
 buildtc_xibase_cflags   = -I${basedir}/include
 buildtc_xibase_ldflags  = -lxibase ${basedir}/src/base/xibasetest.def
 
+buildbc_xibase_src_mk     = $(wildcard $(basedir)/src/base/bench/*.c)
+buildbc_xibase_cflags   = -I${basedir}/include
+buildbc_xibase_ldflags  = -lxibase
+
 
 ########################
 # Compile Target : Ext
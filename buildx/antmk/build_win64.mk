@@ -112,6 +112,10 @@ buildtc_xibase_src_ex   = tc_main.c
 buildtc_xibase_cflags   = -I${basedir}/include
 buildtc_xibase_ldflags  = "xibase.lib" -DEF:"${basedir}/src/base/xibasetest.def"
 
+buildbc_xibase_src_mk   = $(wildcard $(basedir)/src/base/bench/*.c)
+buildbc_xibase_cflags   = -I${basedir}/include
+buildbc_xibase_ldflags  = "xibase.lib"
+
 
 ########################
 # Compile Target : Ext
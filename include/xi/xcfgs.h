@@ -46,8 +46,6 @@
 #define XCFG_ONAME_C16           16         ///< Object-Name : 16 bytes long
 #define XCFG_ONAME_MAX           32         ///< Maximum length of Object-Name
 
-#define XCFG_MUTEX_MAX           1024       ///< Maximum number of mutex
-#define XCFG_COND_MAX            1024       ///< Maximum number of cond
 #define XCFG_THREAD_MAX          128        ///< Maximum number of threads
 
 #define XCFG_THREAD_PRIOR_MIN    1          ///< Has minimum priority
@@ -0,0 +1,238 @@
+/*
+ * Copyright 2013 Cheolmin Jo (webos21@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _XI_AIO_H_
+#define _XI_AIO_H_
+
+/**
+ * @brief XI Asynchronous I/O API
+ *
+ * @file xi_aio.h
+ * @date 2013-07-02
+ * @author Cheolmin Jo (webos21@gmail.com)
+ */
+
+#include "xi_file.h"
+#include "xi_socket.h"
+
+/**
+ * Start Declaration
+ */
+_XI_EXTERN_C_BEGIN
+
+/**
+ * @defgroup xi_aio Asynchronous I/O API
+ * @ingroup XI
+ * @{
+ * @brief
+ *
+ * An aio object takes a batch of requests at once, and reports each of them
+ * later by calling its callback from xi_aio_complete.
+ * On linux it is backed by io_uring, and elsewhere (or on an old kernel)
+ * by a pool of worker threads doing the blocking calls.
+ *
+ * The descriptor of xi_aio_fd becomes readable when a completion waits,
+ * so that an aio object lives in a pollset or an event-loop like a socket:
+ * @code
+ * xi_evloop_add(loop, idx, xi_aio_fd(aio), XI_POLL_EVENT_IN, on_aio, aio);
+ * // on_aio() calls xi_aio_complete(aio, 0)
+ * @endcode
+ *
+ * An aio object is used by one thread at a time (submit and complete).
+ * The buffer of a request, and the request itself, must stay valid
+ * until its callback is called.
+ */
+
+/**
+ * Return values of AIO Functions
+ */
+typedef enum _e_aio_rv {
+	XI_AIO_RV_OK           = 0,    ///< OK
+	XI_AIO_RV_ERR_OP       = -1,   ///< Failed to operate native func
+	XI_AIO_RV_ERR_NOMEM    = -2,   ///< Insufficient memory
+	XI_AIO_RV_ERR_FULL     = -3,   ///< Too many requests in flight
+	XI_AIO_RV_ERR_TRYLATER = -4,   ///< Not ready on a non-blocking descriptor
+	XI_AIO_RV_ERR_FD       = -5,   ///< Invalid descriptor
+	XI_AIO_RV_ERR_CANCELED = -6,   ///< Canceled
+	XI_AIO_RV_ERR_TIMEOUT  = -7,   ///< Timed out
+	XI_AIO_RV_ERR_ARGS     = -8    ///< Invalid Arguments
+} xi_aio_re;
+
+
+/**
+ * AIO Option
+ */
+typedef enum _e_aio_opt {
+	XI_AIO_OPT_THREADS     = 0x00000001  ///< Use the worker threads, even if io_uring is there.
+} xi_aio_opt_e;
+
+
+/**
+ * AIO Backend
+ */
+typedef enum _e_aio_backend {
+	XI_AIO_BACKEND_THREADS = 1,    ///< Worker threads doing the blocking calls
+	XI_AIO_BACKEND_URING   = 2     ///< Linux io_uring
+} xi_aio_backend_e;
+
+
+/**
+ * AIO Operations
+ */
+typedef enum _e_aio_op {
+	XI_AIO_OP_READ         = 1,    ///< xi_file_read : buf, len, off
+	XI_AIO_OP_WRITE        = 2,    ///< xi_file_write : buf, len, off
+	XI_AIO_OP_RECV         = 3,    ///< xi_socket_recv : buf, len
+	XI_AIO_OP_SEND         = 4,    ///< xi_socket_send : buf, len
+	XI_AIO_OP_ACCEPT       = 5,    ///< xi_socket_accept4 : flags (xi_sock_accept_e)
+	XI_AIO_OP_FSYNC        = 6     ///< xi_file_sync : flags (xi_aio_fsync_e)
+} xi_aio_op_e;
+
+
+/**
+ * Flags of XI_AIO_OP_FSYNC
+ */
+typedef enum _e_aio_fsync {
+	XI_AIO_FSYNC_DATA      = 0x1   ///< Flush the data only, not the metadata (fdatasync)
+} xi_aio_fsync_e;
+
+
+/**
+ * Abstract handle of aio object
+ */
+typedef struct _xi_aio xi_aio_t;
+
+
+/**
+ * The structure of aio request
+ */
+typedef struct _st_aio_req xi_aio_req_t;
+
+
+/**
+ * The signature of completion callback
+ *
+ * @param aio The aio object
+ * @param req The completed request, whose res is filled
+ */
+typedef xvoid (*xi_aio_fn)(xi_aio_t *aio, xi_aio_req_t *req);
+
+
+/**
+ * The structure of aio request
+ */
+struct _st_aio_req {
+	xi_aio_op_e      op;       ///< xi_aio_op_e
+	xint32           fd;       ///< file or socket descriptor
+	xvoid           *buf;      ///< buffer of read/write/recv/send
+	xsize            len;      ///< length of buf
+	xoff64           off;      ///< file offset of read/write (-1 : the current position)
+	xint32           flags;    ///< flags of accept/fsync
+	xi_aio_fn        func;     ///< completion callback
+	xvoid           *arg;      ///< user-defined context
+	xssize           res;      ///< (out) bytes, the accepted socket, or xi_aio_re
+	xi_aio_req_t    *next;     ///< (internal) do not touch while in flight
+};
+
+
+/**
+ * Create an aio object
+ *
+ * @param depth The maximum number of requests in flight
+ * @param nthreads The number of worker threads, when they are used (0 : default)
+ * @param opt Optional flags (xi_aio_opt_e)
+ * @return The newly created object, or NULL
+ */
+xi_aio_t      *xi_aio_create(xuint32 depth, xuint32 nthreads, xint32 opt);
+
+
+/**
+ * Get the backend of an aio object
+ *
+ * @param aio The aio object
+ * @return xi_aio_backend_e
+ */
+xint32         xi_aio_backend(xi_aio_t *aio);
+
+
+/**
+ * Get the completion descriptor of an aio object
+ *
+ * @param aio The aio object
+ * @return The descriptor which becomes readable when a completion waits
+ *
+ * @remark Do not read or close it. Just poll it for XI_POLL_EVENT_IN.
+ */
+xint32         xi_aio_fd(xi_aio_t *aio);
+
+
+/**
+ * Submit a batch of requests
+ *
+ * @param aio The aio object
+ * @param reqs The requests to submit
+ * @param nreqs The number of reqs
+ * @return The number of submitted requests from the head of reqs,
+ *         which is less than nreqs when the depth is reached,
+ *         or XI_AIO_RV_ERR_FULL if none is submitted
+ *
+ * @remark The whole batch is handed over to the kernel by one system call.
+ */
+xint32         xi_aio_submit(xi_aio_t *aio, xi_aio_req_t **reqs, xint32 nreqs);
+
+
+/**
+ * Call the callbacks of the completed requests
+ *
+ * @param aio The aio object
+ * @param msecs The milliseconds to wait for the first completion
+ *              (0 : no wait, -1 : forever)
+ * @return The number of completed requests, XI_AIO_RV_ERR_TIMEOUT if none
+ *
+ * @remark A callback may submit new requests.
+ */
+xint32         xi_aio_complete(xi_aio_t *aio, xint32 msecs);
+
+
+/**
+ * Get the number of requests in flight
+ *
+ * @param aio The aio object
+ * @return The number of the submitted requests, whose callbacks are not called yet
+ */
+xint32         xi_aio_pending(xi_aio_t *aio);
+
+
+/**
+ * Destroy an aio object
+ *
+ * @param aio The aio object to destroy
+ *
+ * @remark The requests in flight must be completed before.
+ *         A blocking accept or recv can be woken up by shutting down its socket.
+ */
+xi_aio_re      xi_aio_destroy(xi_aio_t *aio);
+
+/**
+ * @}  // end of xi_aio
+ */
+
+/**
+ * End Declaration
+ */
+_XI_EXTERN_C_END
+
+#endif // _XI_AIO_H_
@@ -48,6 +48,11 @@ _XI_EXTERN_C_BEGIN
  *  - Linux/SMP8654 use same GCC Built-in API.
  *  - BCM use kernel API.
  *  - Win32 uses the VC intrinsic API.
+ *
+ * The functions above are exported (out-of-line) and fully ordered.
+ * The xi_atomic_*_explicit functions at the end are inlined into the caller
+ * and take one of XI_ATOMIC_RELAXED/ACQUIRE/RELEASE/ACQ_REL/SEQ_CST, for
+ * the lock-free structures which want to pay for the ordering they need only.
  */
 
 /**
@@ -347,6 +352,278 @@ xuint32      xi_atomic_dec32(volatile xuint32 *mem);
 xuint64      xi_atomic_dec64(volatile xuint64 *mem);
 
 
+// ----------------------------------------------
+// Inline Atomics with explicit memory order
+// ----------------------------------------------
+
+/**
+ * Memory orders of the xi_atomic_*_explicit functions
+ * (the same semantics as the C11 memory_order)
+ */
+#if defined(__ATOMIC_RELAXED)
+#define XI_ATOMIC_RELAXED   __ATOMIC_RELAXED   ///< No ordering, atomicity only
+#define XI_ATOMIC_ACQUIRE   __ATOMIC_ACQUIRE   ///< Later accesses stay after (load)
+#define XI_ATOMIC_RELEASE   __ATOMIC_RELEASE   ///< Earlier accesses stay before (store)
+#define XI_ATOMIC_ACQ_REL   __ATOMIC_ACQ_REL   ///< Both of acquire and release (read-modify-write)
+#define XI_ATOMIC_SEQ_CST   __ATOMIC_SEQ_CST   ///< Single total order (full barrier)
+#else
+#define XI_ATOMIC_RELAXED   0                  ///< No ordering, atomicity only
+#define XI_ATOMIC_ACQUIRE   2                  ///< Later accesses stay after (load)
+#define XI_ATOMIC_RELEASE   3                  ///< Earlier accesses stay before (store)
+#define XI_ATOMIC_ACQ_REL   4                  ///< Both of acquire and release (read-modify-write)
+#define XI_ATOMIC_SEQ_CST   5                  ///< Single total order (full barrier)
+#endif
+
+/*
+ * xi_atomic_fence(order)
+ *   : a memory fence of the given order
+ * xi_atomic_load{32,64,ptr}_explicit(mem, order)
+ *   : return *mem
+ * xi_atomic_store{32,64,ptr}_explicit(mem, val, order)
+ *   : *mem = val
+ * xi_atomic_cas{32,64,ptr}_explicit(mem, with, cmp, order)
+ *   : if *mem == cmp then *mem = with, and return the old value of *mem
+ * xi_atomic_xchg{32,64,ptr}_explicit(mem, val, order)
+ *   : *mem = val, and return the old value of *mem
+ * xi_atomic_add{32,64}_explicit(mem, val, order)
+ * xi_atomic_sub{32,64}_explicit(mem, val, order)
+ *   : *mem += (-=) val, and return the old value of *mem
+ */
+#if defined(__ATOMIC_RELAXED) // GCC 4.7+, clang
+
+// the failure order of CAS cannot be a release
+#define XG_ATOMIC_CAS_FAIL(o) \
+	((o) == XI_ATOMIC_RELEASE ? XI_ATOMIC_RELAXED : ((o) == XI_ATOMIC_ACQ_REL ? XI_ATOMIC_ACQUIRE : (o)))
+
+_XI_INLINE xvoid xi_atomic_fence(xint32 order) {
+	__atomic_thread_fence(order);
+}
+
+_XI_INLINE xuint32 xi_atomic_load32_explicit(volatile xuint32 *mem, xint32 order) {
+	return __atomic_load_n(mem, order);
+}
+
+_XI_INLINE xuint64 xi_atomic_load64_explicit(volatile xuint64 *mem, xint32 order) {
+	return __atomic_load_n(mem, order);
+}
+
+_XI_INLINE xvoid *xi_atomic_loadptr_explicit(volatile xvoid **mem, xint32 order) {
+	return (xvoid *) __atomic_load_n(mem, order);
+}
+
+_XI_INLINE xvoid xi_atomic_store32_explicit(volatile xuint32 *mem, xuint32 val, xint32 order) {
+	__atomic_store_n(mem, val, order);
+}
+
+_XI_INLINE xvoid xi_atomic_store64_explicit(volatile xuint64 *mem, xuint64 val, xint32 order) {
+	__atomic_store_n(mem, val, order);
+}
+
+_XI_INLINE xvoid xi_atomic_storeptr_explicit(volatile xvoid **mem, xvoid *val, xint32 order) {
+	__atomic_store_n(mem, val, order);
+}
+
+_XI_INLINE xuint32 xi_atomic_cas32_explicit(volatile xuint32 *mem, xuint32 with, xuint32 cmp, xint32 order) {
+	__atomic_compare_exchange_n(mem, &cmp, with, 0, order, XG_ATOMIC_CAS_FAIL(order));
+	return cmp;
+}
+
+_XI_INLINE xuint64 xi_atomic_cas64_explicit(volatile xuint64 *mem, xuint64 with, xuint64 cmp, xint32 order) {
+	__atomic_compare_exchange_n(mem, &cmp, with, 0, order, XG_ATOMIC_CAS_FAIL(order));
+	return cmp;
+}
+
+_XI_INLINE xvoid *xi_atomic_casptr_explicit(volatile xvoid **mem, xvoid *with, const xvoid *cmp, xint32 order) {
+	xvoid *old = (xvoid *) cmp;
+	__atomic_compare_exchange_n(mem, (const xvoid **) &old, with, 0, order, XG_ATOMIC_CAS_FAIL(order));
+	return old;
+}
+
+_XI_INLINE xuint32 xi_atomic_xchg32_explicit(volatile xuint32 *mem, xuint32 val, xint32 order) {
+	return __atomic_exchange_n(mem, val, order);
+}
+
+_XI_INLINE xuint64 xi_atomic_xchg64_explicit(volatile xuint64 *mem, xuint64 val, xint32 order) {
+	return __atomic_exchange_n(mem, val, order);
+}
+
+_XI_INLINE xvoid *xi_atomic_xchgptr_explicit(volatile xvoid **mem, xvoid *val, xint32 order) {
+	return (xvoid *) __atomic_exchange_n(mem, val, order);
+}
+
+_XI_INLINE xuint32 xi_atomic_add32_explicit(volatile xuint32 *mem, xuint32 val, xint32 order) {
+	return __atomic_fetch_add(mem, val, order);
+}
+
+_XI_INLINE xuint64 xi_atomic_add64_explicit(volatile xuint64 *mem, xuint64 val, xint32 order) {
+	return __atomic_fetch_add(mem, val, order);
+}
+
+_XI_INLINE xuint32 xi_atomic_sub32_explicit(volatile xuint32 *mem, xuint32 val, xint32 order) {
+	return __atomic_fetch_sub(mem, val, order);
+}
+
+_XI_INLINE xuint64 xi_atomic_sub64_explicit(volatile xuint64 *mem, xuint64 val, xint32 order) {
+	return __atomic_fetch_sub(mem, val, order);
+}
+
+#elif defined(_MSC_VER) // VC intrinsics : x86/x64 keep the loads/stores ordered
+
+_XI_EXTERN_C_END
+#include <intrin.h>
+_XI_EXTERN_C_BEGIN
+
+_XI_INLINE xvoid xi_atomic_fence(xint32 order) {
+	if (order == XI_ATOMIC_SEQ_CST) {
+		volatile long fence = 0;
+		_InterlockedExchange(&fence, 0);
+	} else {
+		_ReadWriteBarrier();
+	}
+}
+
+_XI_INLINE xuint32 xi_atomic_cas32_explicit(volatile xuint32 *mem, xuint32 with, xuint32 cmp, xint32 order) {
+	(void) order;
+	return (xuint32) _InterlockedCompareExchange((volatile long *) mem, (long) with, (long) cmp);
+}
+
+_XI_INLINE xuint64 xi_atomic_cas64_explicit(volatile xuint64 *mem, xuint64 with, xuint64 cmp, xint32 order) {
+	(void) order;
+	return (xuint64) _InterlockedCompareExchange64((volatile __int64 *) mem, (__int64) with, (__int64) cmp);
+}
+
+_XI_INLINE xvoid *xi_atomic_casptr_explicit(volatile xvoid **mem, xvoid *with, const xvoid *cmp, xint32 order) {
+#ifdef _WIN64
+	return (xvoid *) xi_atomic_cas64_explicit((volatile xuint64 *) mem, (xuint64) with, (xuint64) cmp, order);
+#else
+	return (xvoid *) xi_atomic_cas32_explicit((volatile xuint32 *) mem, (xuint32) with, (xuint32) cmp, order);
+#endif
+}
+
+_XI_INLINE xuint32 xi_atomic_xchg32_explicit(volatile xuint32 *mem, xuint32 val, xint32 order) {
+	(void) order;
+	return (xuint32) _InterlockedExchange((volatile long *) mem, (long) val);
+}
+
+_XI_INLINE xuint64 xi_atomic_xchg64_explicit(volatile xuint64 *mem, xuint64 val, xint32 order) {
+	xuint64 old;
+	do {
+		old = *mem;
+	} while (xi_atomic_cas64_explicit(mem, val, old, order) != old);
+	return old;
+}
+
+_XI_INLINE xvoid *xi_atomic_xchgptr_explicit(volatile xvoid **mem, xvoid *val, xint32 order) {
+#ifdef _WIN64
+	return (xvoid *) xi_atomic_xchg64_explicit((volatile xuint64 *) mem, (xuint64) val, order);
+#else
+	return (xvoid *) xi_atomic_xchg32_explicit((volatile xuint32 *) mem, (xuint32) val, order);
+#endif
+}
+
+_XI_INLINE xuint32 xi_atomic_load32_explicit(volatile xuint32 *mem, xint32 order) {
+	xuint32 val = *mem;
+	(void) order;
+	_ReadWriteBarrier();
+	return val;
+}
+
+_XI_INLINE xuint64 xi_atomic_load64_explicit(volatile xuint64 *mem, xint32 order) {
+#ifdef _WIN64
+	xuint64 val = *mem;
+	(void) order;
+	_ReadWriteBarrier();
+	return val;
+#else
+	return xi_atomic_cas64_explicit(mem, 0, 0, order); // no atomic 64-bit load
+#endif
+}
+
+_XI_INLINE xvoid *xi_atomic_loadptr_explicit(volatile xvoid **mem, xint32 order) {
+	xvoid *val = (xvoid *) *mem;
+	(void) order;
+	_ReadWriteBarrier();
+	return val;
+}
+
+_XI_INLINE xvoid xi_atomic_store32_explicit(volatile xuint32 *mem, xuint32 val, xint32 order) {
+	if (order == XI_ATOMIC_SEQ_CST) {
+		xi_atomic_xchg32_explicit(mem, val, order);
+	} else {
+		_ReadWriteBarrier();
+		*mem = val;
+	}
+}
+
+_XI_INLINE xvoid xi_atomic_store64_explicit(volatile xuint64 *mem, xuint64 val, xint32 order) {
+#ifdef _WIN64
+	if (order != XI_ATOMIC_SEQ_CST) {
+		_ReadWriteBarrier();
+		*mem = val;
+		return;
+	}
+#endif
+	xi_atomic_xchg64_explicit(mem, val, order);
+}
+
+_XI_INLINE xvoid xi_atomic_storeptr_explicit(volatile xvoid **mem, xvoid *val, xint32 order) {
+	if (order == XI_ATOMIC_SEQ_CST) {
+		xi_atomic_xchgptr_explicit(mem, val, order);
+	} else {
+		_ReadWriteBarrier();
+		*mem = val;
+	}
+}
+
+_XI_INLINE xuint32 xi_atomic_add32_explicit(volatile xuint32 *mem, xuint32 val, xint32 order) {
+	(void) order;
+	return (xuint32) _InterlockedExchangeAdd((volatile long *) mem, (long) val);
+}
+
+_XI_INLINE xuint64 xi_atomic_add64_explicit(volatile xuint64 *mem, xuint64 val, xint32 order) {
+	xuint64 old;
+	do {
+		old = *mem;
+	} while (xi_atomic_cas64_explicit(mem, old + val, old, order) != old);
+	return old;
+}
+
+_XI_INLINE xuint32 xi_atomic_sub32_explicit(volatile xuint32 *mem, xuint32 val, xint32 order) {
+	return xi_atomic_add32_explicit(mem, (0 - val), order);
+}
+
+_XI_INLINE xuint64 xi_atomic_sub64_explicit(volatile xuint64 *mem, xuint64 val, xint32 order) {
+	return xi_atomic_add64_explicit(mem, (0 - val), order);
+}
+
+#else // the others : fully ordered, on the exported functions
+
+_XI_INLINE xvoid xi_atomic_fence(xint32 order) {
+	volatile xuint32 fence = 0;
+	(void) order;
+	xi_atomic_cas32(&fence, 0, 0);
+}
+
+#define xi_atomic_load32_explicit(mem, order)           xi_atomic_cas32((mem), 0, 0)
+#define xi_atomic_load64_explicit(mem, order)           xi_atomic_cas64((mem), 0, 0)
+#define xi_atomic_loadptr_explicit(mem, order)          xi_atomic_casptr((mem), NULL, NULL)
+#define xi_atomic_store32_explicit(mem, val, order)     ((xvoid) xi_atomic_xchg32((mem), (val)))
+#define xi_atomic_store64_explicit(mem, val, order)     ((xvoid) xi_atomic_xchg64((mem), (val)))
+#define xi_atomic_storeptr_explicit(mem, val, order)    ((xvoid) xi_atomic_xchgptr((mem), (val)))
+#define xi_atomic_cas32_explicit(mem, with, cmp, order) xi_atomic_cas32((mem), (with), (cmp))
+#define xi_atomic_cas64_explicit(mem, with, cmp, order) xi_atomic_cas64((mem), (with), (cmp))
+#define xi_atomic_casptr_explicit(mem, with, cmp, order) xi_atomic_casptr((mem), (with), (cmp))
+#define xi_atomic_xchg32_explicit(mem, val, order)      xi_atomic_xchg32((mem), (val))
+#define xi_atomic_xchg64_explicit(mem, val, order)      xi_atomic_xchg64((mem), (val))
+#define xi_atomic_xchgptr_explicit(mem, val, order)     xi_atomic_xchgptr((mem), (val))
+#define xi_atomic_add32_explicit(mem, val, order)       xi_atomic_add32((mem), (val))
+#define xi_atomic_add64_explicit(mem, val, order)       xi_atomic_add64((mem), (val))
+#define xi_atomic_sub32_explicit(mem, val, order)       (xi_atomic_add32((mem), 0 - (val)))
+#define xi_atomic_sub64_explicit(mem, val, order)       (xi_atomic_add64((mem), 0 - (val)))
+
+#endif // __ATOMIC_RELAXED
+
+
 
 /**
  * @}  // end of xi_atomic
@@ -72,12 +72,55 @@ xint64      xi_clock_msec();
 
 /**
  * Tick from the system-boot by Nanoseconds.
+ * It is monotonic, so that it fits to measure the elapsed time.
  *
  * @return	xint64 Nanoseconds
  */
 xint64      xi_clock_ntick();
 
 
+/**
+ * Coarse tick from the system-boot by Nanoseconds.
+ * It is monotonic and cheaper than xi_clock_ntick (no system call on linux),
+ * but it advances only at the scheduler tick (1 ~ 16 milliseconds).
+ *
+ * @return	xint64 Nanoseconds
+ */
+xint64      xi_clock_ntick_coarse();
+
+
+/**
+ * Read the cycle counter of the CPU (TSC on x86, CNTVCT on ARMv8).
+ * It costs a few nanoseconds, so that it fits to time the hot-path.
+ * Where the counter is missing or not constant (without invariant TSC),
+ * it falls back to xi_clock_ntick, and one cycle is one nanosecond.
+ *
+ * @return	xuint64 Cycles
+ *
+ * @remark Convert the difference of two readings with xi_clock_cycles2nsec.
+ */
+xuint64     xi_clock_cycles();
+
+
+/**
+ * Get the frequency of the cycle counter.
+ * The first call calibrates the counter against xi_clock_ntick,
+ * which takes about 10 milliseconds, so call it once at the start-up.
+ *
+ * @return	xuint64 Cycles per second
+ */
+xuint64     xi_clock_cycles_hz();
+
+
+/**
+ * Convert the cycles to Nanoseconds
+ *
+ * @param  	cycles The difference of two xi_clock_cycles
+ * @return	xint64 Nanoseconds
+ */
+xint64      xi_clock_cycles2nsec(xuint64 cycles);
+
+
 /**
  * Get Time-Zone
  *
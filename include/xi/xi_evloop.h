@@ -0,0 +1,268 @@
+/*
+ * Copyright 2013 Cheolmin Jo (webos21@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _XI_EVLOOP_H_
+#define _XI_EVLOOP_H_
+
+/**
+ * @brief XI Event-Loop API
+ *
+ * @file xi_evloop.h
+ * @date 2013-06-20
+ * @author Cheolmin Jo (webos21@gmail.com)
+ */
+
+#include "xi_poll.h"
+#include "xi_timer.h"
+
+/**
+ * Start Declaration
+ */
+_XI_EXTERN_C_BEGIN
+
+/**
+ * @defgroup xi_evloop Event-Loop API
+ * @ingroup XI
+ * @{
+ * @brief
+ *
+ * An event-loop runs N loop threads, and each of them owns a pollset.
+ * A descriptor belongs to one loop thread, and its callback is always
+ * called on that thread.
+ * The functions that take the index of a loop thread (add, modify, remove)
+ * should be called on that loop thread, that is from its callbacks or tasks.
+ * Other threads hand the work over with xi_evloop_post or xi_evloop_handoff,
+ * which wake up the target loop thread.
+ * Each loop thread also runs a timer object, whose nearest timer bounds
+ * the wait of its pollset.
+ */
+
+/**
+ * Return values of Event-Loop Functions
+ */
+typedef enum _e_evloop_rv {
+	XI_EVLOOP_RV_OK          = 0,    ///< OK
+	XI_EVLOOP_RV_ERR_OP      = -1,   ///< Failed to operate native func
+	XI_EVLOOP_RV_ERR_NOMEM   = -2,   ///< Insufficient memory
+	XI_EVLOOP_RV_ERR_NF      = -3,   ///< Not Found
+	XI_EVLOOP_RV_ERR_STATE   = -4,   ///< Already started or stopped
+	XI_EVLOOP_RV_ERR_ARGS    = -5    ///< Invalid Arguments
+} xi_evloop_re;
+
+
+/**
+ * Abstract handle of event-loop
+ */
+typedef struct _xi_evloop xi_evloop_t;
+
+
+/**
+ * The signature of I/O callback
+ *
+ * @param loop The event-loop
+ * @param idx The index of the loop thread which calls it
+ * @param desc The signaled descriptor
+ * @param evts The signaled events (xi_poll_event_e)
+ * @param arg The argument given at the registration
+ */
+typedef xvoid (*xi_evloop_io_fn)(xi_evloop_t *loop, xint32 idx, xint32 desc,
+		xint32 evts, xvoid *arg);
+
+
+/**
+ * The signature of task callback
+ *
+ * @param loop The event-loop
+ * @param idx The index of the loop thread which calls it
+ * @param arg The argument given to xi_evloop_post
+ */
+typedef xvoid (*xi_evloop_task_fn)(xi_evloop_t *loop, xint32 idx, xvoid *arg);
+
+
+/**
+ * The signature of accept callback
+ *
+ * @param loop The event-loop
+ * @param idx The index of the loop thread which owns the new connection
+ * @param csock The accepted socket (non-blocking)
+ * @param arg The argument given to xi_evloop_listen
+ */
+typedef xvoid (*xi_evloop_accept_fn)(xi_evloop_t *loop, xint32 idx,
+		xint32 csock, xvoid *arg);
+
+
+/**
+ * Create an event-loop object
+ *
+ * @param nloops The number of loop threads
+ * @param size The maximum number of descriptors that each loop thread can hold
+ * @return The pointer in which to return the newly created object
+ */
+xi_evloop_t   *xi_evloop_create(xuint32 nloops, xuint32 size);
+
+
+/**
+ * Start the loop threads
+ *
+ * @param loop The event-loop to start
+ */
+xi_evloop_re   xi_evloop_start(xi_evloop_t *loop);
+
+
+/**
+ * Stop the loop threads and wait for them to exit
+ *
+ * @param loop The event-loop to stop
+ *
+ * @remark It must not be called on a loop thread.
+ *         The pending tasks are dropped, and the pending handoffs close their sockets.
+ */
+xi_evloop_re   xi_evloop_stop(xi_evloop_t *loop);
+
+
+/**
+ * Destroy an event-loop object
+ *
+ * @param loop The event-loop to destroy
+ *
+ * @remark The registered descriptors are not closed.
+ */
+xi_evloop_re   xi_evloop_destroy(xi_evloop_t *loop);
+
+
+/**
+ * Get the number of loop threads
+ *
+ * @param loop The event-loop
+ * @return The number of loop threads
+ */
+xint32         xi_evloop_count(xi_evloop_t *loop);
+
+
+/**
+ * Pick a loop thread in round-robin
+ *
+ * @param loop The event-loop
+ * @return The index of the next loop thread
+ */
+xint32         xi_evloop_next(xi_evloop_t *loop);
+
+
+/**
+ * Get the timer object of a loop thread
+ *
+ * @param loop The event-loop
+ * @param idx The index of the loop thread
+ * @return The timer object, whose callbacks are called on the loop thread
+ *
+ * @remark The timer object should be used on its loop thread only.
+ *         Other threads can add a timer with xi_evloop_post.
+ */
+xi_timer_t    *xi_evloop_timer(xi_evloop_t *loop, xint32 idx);
+
+
+/**
+ * Register a descriptor to a loop thread
+ *
+ * @param loop The event-loop
+ * @param idx The index of the loop thread, which is the caller
+ * @param desc The descriptor to add
+ * @param evts The events to wait for (xi_poll_event_e)
+ * @param func The callback to be called with the signaled events
+ * @param arg The argument of the callback
+ */
+xi_evloop_re   xi_evloop_add(xi_evloop_t *loop, xint32 idx, xint32 desc,
+		xint32 evts, xi_evloop_io_fn func, xvoid *arg);
+
+
+/**
+ * Change the events of a registered descriptor
+ *
+ * @param loop The event-loop
+ * @param idx The index of the loop thread, which is the caller
+ * @param desc The registered descriptor
+ * @param evts The events to wait for (xi_poll_event_e)
+ */
+xi_evloop_re   xi_evloop_modify(xi_evloop_t *loop, xint32 idx, xint32 desc,
+		xint32 evts);
+
+
+/**
+ * Unregister a descriptor from a loop thread
+ *
+ * @param loop The event-loop
+ * @param idx The index of the loop thread, which is the caller
+ * @param desc The registered descriptor
+ *
+ * @remark Pending events of the descriptor are not reported.
+ *         Unregister it before closing it.
+ */
+xi_evloop_re   xi_evloop_remove(xi_evloop_t *loop, xint32 idx, xint32 desc);
+
+
+/**
+ * Run a task on a loop thread
+ *
+ * @param loop The event-loop
+ * @param idx The index of the loop thread
+ * @param func The task to run
+ * @param arg The argument of the task
+ *
+ * @remark It can be called from any thread, and wakes up the loop thread.
+ */
+xi_evloop_re   xi_evloop_post(xi_evloop_t *loop, xint32 idx,
+		xi_evloop_task_fn func, xvoid *arg);
+
+
+/**
+ * Hand a connected socket over to a loop thread
+ *
+ * @param loop The event-loop
+ * @param idx The index of the loop thread to own the socket
+ * @param csock The socket to hand over
+ * @param func The callback to be called on the loop thread
+ * @param arg The argument of the callback
+ *
+ * @remark It can be called from any thread, and wakes up the loop thread.
+ */
+xi_evloop_re   xi_evloop_handoff(xi_evloop_t *loop, xint32 idx, xint32 csock,
+		xi_evloop_accept_fn func, xvoid *arg);
+
+
+/**
+ * Accept connections on the first loop thread, and hand them over
+ * to the loop threads in round-robin
+ *
+ * @param loop The event-loop
+ * @param lsock The listening socket, which is made non-blocking
+ * @param func The callback to be called on the loop thread owning a new connection
+ * @param arg The argument of the callback
+ *
+ * @remark It can be called from any thread.
+ */
+xi_evloop_re   xi_evloop_listen(xi_evloop_t *loop, xint32 lsock,
+		xi_evloop_accept_fn func, xvoid *arg);
+
+/**
+ * @}  // end of xi_evloop
+ */
+
+/**
+ * End Declaration
+ */
+_XI_EXTERN_C_END
+
+#endif // _XI_EVLOOP_H_
@@ -60,7 +60,9 @@ typedef enum _e_file_rv {
 	XI_FILE_RV_ERR_BIG     = -12, ///< Big
 	XI_FILE_RV_ERR_BUSY    = -13, ///< File is used
 	XI_FILE_RV_ERR_NOTEMPT = -14, ///< Not empty
-	XI_FILE_RV_ERR_IO      = -15  ///< I/O Error
+	XI_FILE_RV_ERR_IO      = -15, ///< I/O Error
+	XI_FILE_RV_ERR_NS      = -16, ///< Not supported
+	XI_FILE_RV_ERR_AGAIN   = -17  ///< Try it later (non-blocking descriptor)
 } xi_file_re;
 
 
@@ -128,12 +130,34 @@ typedef enum _e_file_seek {
 } xi_file_seek_e;
 
 
+/**
+ * Access Pattern Advice (xi_file_advise)
+ */
+typedef enum _e_file_advice {
+	XI_FILE_ADVICE_NORMAL     = 0,  ///< No special pattern
+	XI_FILE_ADVICE_SEQUENTIAL = 1,  ///< Sequential access (read ahead more)
+	XI_FILE_ADVICE_RANDOM     = 2,  ///< Random access (do not read ahead)
+	XI_FILE_ADVICE_WILLNEED   = 3,  ///< Will be accessed soon (read ahead now)
+	XI_FILE_ADVICE_DONTNEED   = 4   ///< Will not be accessed soon (drop the cache)
+} xi_file_advice_e;
+
+
+/**
+ * Flags of xi_file_splice / xi_file_tee
+ */
+typedef enum _e_file_splice {
+	XI_FILE_SPLICE_MOVE     = 1,  ///< Move the pages instead of copying (hint)
+	XI_FILE_SPLICE_NONBLOCK = 2,  ///< Do not block on the pipe
+	XI_FILE_SPLICE_MORE     = 4   ///< More data will be coming (socket)
+} xi_file_splice_e;
+
+
 /**
  * The structure represents a IO Vector.
  */
 typedef struct _st_file_iovec {
     xvoid  *iov_base;    ///< Starting address
-    xint32  iov_len;     ///< Number of bytes to transfer
+    xsize   iov_len;     ///< Number of bytes to transfer (laid out as struct iovec)
 } xi_file_iovec_t;
 
 
@@ -251,6 +275,77 @@ xssize       xi_file_readv(xint32 fd, const xi_file_iovec_t *iov, xint32 iovlen)
 xssize       xi_file_writev(xint32 fd, const xi_file_iovec_t *iov, xint32 iovlen);
 
 
+/**
+ * Read data from the specified file at the given offset,
+ * without using the file offset. Threads can read one descriptor at once.
+ *
+ * @param fd The file descriptor to read from.
+ * @param buf The buffer to store the data to.
+ * @param buflen The length of buffer and the number of bytes to read.
+ * @param off The offset of the file to read from.
+ * @return the number of bytes read, 0 at the end of file, or the error value < 0.
+ *
+ * @remark On win32, the file offset is moved after the data read.
+ */
+xssize       xi_file_pread(xint32 fd, xvoid *buf, xsize buflen, xoff64 off);
+
+
+/**
+ * Write data to the specified file at the given offset,
+ * without using the file offset.
+ *
+ * @param fd The file descriptor to write to.
+ * @param buf The buffer which contains the data.
+ * @param buflen The length of buffer and the number of bytes to write.
+ * @param off The offset of the file to write to.
+ * @return the number of bytes written, or the error value < 0.
+ *
+ * @remark On win32, the file offset is moved after the data written.
+ */
+xssize       xi_file_pwrite(xint32 fd, const xvoid *buf, xsize buflen, xoff64 off);
+
+
+/**
+ * Read vector data from the specified file at the given offset,
+ * without using the file offset.
+ *
+ * @param fd The file descriptor to read from.
+ * @param iov The structure of IOVEC.
+ * @param iovlen The length of structure of IOVEC.
+ * @param off The offset of the file to read from.
+ * @return the number of bytes read, 0 at the end of file, or the error value < 0.
+ */
+xssize       xi_file_preadv(xint32 fd, const xi_file_iovec_t *iov, xint32 iovlen, xoff64 off);
+
+
+/**
+ * Write vector data to the specified file at the given offset,
+ * without using the file offset.
+ *
+ * @param fd The file descriptor to write to.
+ * @param iov The structure of IOVEC.
+ * @param iovlen The length of structure of IOVEC.
+ * @param off The offset of the file to write to.
+ * @return the number of bytes written, or the error value < 0.
+ */
+xssize       xi_file_pwritev(xint32 fd, const xi_file_iovec_t *iov, xint32 iovlen, xoff64 off);
+
+
+/**
+ * Tell the access pattern of a file area, to tune the read-ahead and the cache.
+ *
+ * @param fd The file descriptor.
+ * @param off The offset of the area.
+ * @param len The length of the area (0 : up to the end of file).
+ * @param advice The access pattern. (xi_file_advice_e)
+ * @return XI_FILE_RV_OK, or XI_FILE_RV_ERR_NS where the advice is not available.
+ *
+ * @remark It is a hint only. XI_FILE_ADVICE_WILLNEED starts the read-ahead
+ *         of the area in the background.
+ */
+xi_file_re   xi_file_advise(xint32 fd, xoff64 off, xoff64 len, xint32 advice);
+
+
 /**
  * Move the read/write file offset to a specified byte within a file.
  *
@@ -302,6 +397,31 @@ xi_file_re   xi_file_unlock(xint32 fd, xoff64 spos, xoff64 len);
 xi_file_re   xi_file_sync(xint32 fd);
 
 
+/**
+ * Get the alignment of buffer, offset and length for XI_FILE_MODE_DIRECT.
+ *
+ * @return The alignment in bytes (the page size).
+ */
+xsize        xi_file_direct_align();
+
+
+/**
+ * Allocate a buffer for XI_FILE_MODE_DIRECT, aligned by xi_file_direct_align.
+ *
+ * @param size The size of buffer, rounded up to the alignment.
+ * @return The buffer, or NULL. It should be freed by xi_file_direct_free.
+ */
+xvoid       *xi_file_direct_alloc(xsize size);
+
+
+/**
+ * Free a buffer allocated by xi_file_direct_alloc.
+ *
+ * @param buf The buffer to free.
+ */
+xvoid        xi_file_direct_free(xvoid *buf);
+
+
 /**
  * Synchronize the specified file.
  *
@@ -310,6 +430,56 @@ xi_file_re   xi_file_sync(xint32 fd);
 xi_file_re   xi_file_pipe(xint32 fd[2]);
 
 
+/**
+ * Move data between two descriptors (file, socket or pipe) without copying
+ * it through the user space where the system allows (splice).
+ * When neither side is a pipe, the data is relayed by an internal pipe.
+ * Otherwise, it is copied through a buffer.
+ *
+ * @param infd The descriptor to read from.
+ * @param inoff The offset to read from, updated by the moved bytes
+ *              (NULL : the file position; ignored for a pipe or a socket).
+ * @param outfd The descriptor to write to.
+ * @param outoff The offset to write to, updated by the moved bytes
+ *               (NULL : the file position; ignored for a pipe or a socket).
+ * @param count The maximum number of bytes to move.
+ * @param flags The OR-ed xi_file_splice_e flags.
+ * @return The number of bytes moved, which may be less than @a count
+ *         like read(), 0 at the end of input, or the error value < 0.
+ */
+xssize       xi_file_splice(xint32 infd, xoff64 *inoff, xint32 outfd, xoff64 *outoff, xsize count, xint32 flags);
+
+
+/**
+ * Duplicate the data of a pipe to another pipe without consuming it (tee).
+ *
+ * @param infd The pipe to read from.
+ * @param outfd The pipe to write to.
+ * @param count The maximum number of bytes to duplicate.
+ * @param flags The OR-ed xi_file_splice_e flags.
+ * @return The number of bytes duplicated, or the error value < 0
+ *         (XI_FILE_RV_ERR_NS where tee is not available).
+ */
+xssize       xi_file_tee(xint32 infd, xint32 outfd, xsize count, xint32 flags);
+
+
+/**
+ * Copy a range of a file to another file inside the kernel (copy_file_range),
+ * falling back to xi_file_splice.
+ *
+ * @param infd The file to read from.
+ * @param inoff The offset to read from, updated by the copied bytes
+ *              (NULL : the file position).
+ * @param outfd The file to write to.
+ * @param outoff The offset to write to, updated by the copied bytes
+ *               (NULL : the file position).
+ * @param count The number of bytes to copy.
+ * @return The number of bytes copied (less than @a count only at the end of
+ *         input), or the error value < 0.
+ */
+xssize       xi_file_copy_range(xint32 infd, xoff64 *inoff, xint32 outfd, xoff64 *outoff, xsize count);
+
+
 /**
  * Close the specified file.
  *
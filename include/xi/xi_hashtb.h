@@ -52,6 +52,11 @@ _XI_EXTERN_C_BEGIN
 
 /**
  * Abstract type for hash tables.
+ *
+ * @remark The table is an open addressing one, probed by the groups of slots.
+ *         When it grows, the entries are moved into the new array by a few
+ *         groups at each insertion, so that no single insertion rehashes
+ *         the whole table.
  */
 typedef struct _xi_hashtb xi_hashtb_t;
 
@@ -70,8 +75,9 @@ typedef xuint32 (*xi_hashtb_keygen)(const xvoid *key, xint32 *klen);
 
 /**
  * Create a hash table.
+ * The keys are hashed by a 64 bits hash seeded per table.
  *
- * @return The hash table just created
+ * @return The hash table just created, or NULL if it fails
  */
 xi_hashtb_t *xi_hashtb_create();
 
@@ -79,6 +85,10 @@ xi_hashtb_t *xi_hashtb_create();
  * Create a hash table with custom hash-function
  *
  * @param func A custom hash function.
+ * @return The hash table just created, or NULL if it fails
+ *
+ * @remark The 32 bits value of func is mixed with the seed of the table
+ *         before it is used.
  */
 xi_hashtb_t *xi_hashtb_create_custom(xi_hashtb_keygen func);
 
@@ -118,7 +128,8 @@ xuint32 xi_hashtb_count(xi_hashtb_t *htb);
  * Get the maximum available number of the hash table.
  *
  * @param htb The hash table
- * @return The maximum available number of the hash table.
+ * @return The number of key/value pairs which the current array holds
+ *         before it grows.
  */
 xuint32 xi_hashtb_max(xi_hashtb_t *htb);
 
@@ -131,7 +142,8 @@ xuint32 xi_hashtb_max(xi_hashtb_t *htb);
  * @remark  There is no restriction on adding or deleting hash entries during
  * an iteration (although the results may be unpredictable unless all you do
  * is delete the current entry) and multiple iterations can be in
- * progress at the same time.
+ * progress at the same time. Adding an entry may move the other ones,
+ * and may invalidate the current entry.
  *
  * @par Example:
  *
@@ -196,6 +208,122 @@ xi_hashtb_t *xi_hashtb_clone(xi_hashtb_t *htb);
  */
 xvoid xi_hashtb_destroy(xi_hashtb_t *htb);
 
+/**
+ * Abstract type for concurrent hash tables.
+ *
+ * @remark The lookups take no lock : they only announce themselves on
+ *         a striped reader counter. The insertions and the deletions lock
+ *         a stripe of the buckets. The removed entries are freed later,
+ *         when no lookup can see them any more, and the writers never wait
+ *         for the readers.
+ */
+typedef struct _xi_hashtb_conc xi_hashtb_conc_t;
+
+/**
+ * The iteration state of a concurrent hash table, owned by the caller.
+ *
+ * @remark The fields are for the internal use only.
+ */
+typedef struct _xi_hashtb_conc_idx {
+	xi_hashtb_conc_t *ht; ///< The hash table (NULL when it is done)
+	xvoid *arr;           ///< The bucket array which is iterated
+	xvoid *curr;          ///< The current entry
+	xuint32 index;        ///< The next bucket
+	xuint32 slot;         ///< The reader counter entered
+} xi_hashtb_conc_idx_t;
+
+/**
+ * Create a concurrent hash table.
+ *
+ * @param func A custom hash function, or NULL for the default one.
+ * @return The hash table just created, or NULL if it fails
+ */
+xi_hashtb_conc_t *xi_hashtb_conc_create(xi_hashtb_keygen func);
+
+/**
+ * Associate a value with a key in a concurrent hash table.
+ *
+ * @param htb The hash table
+ * @param key Pointer to the key
+ * @param klen Length of the key. Can be XI_HASHTB_KEY_STRING to use the string length.
+ * @param val Value to associate with the key
+ *
+ * @remark The key is copied into the table, unlike xi_hashtb_set.
+ * @remark If the value is NULL the hash entry is deleted.
+ * @remark A value which was replaced or deleted may still be returned by
+ *         the lookups which run at the same time.
+ */
+xvoid xi_hashtb_conc_set(xi_hashtb_conc_t *htb, const xvoid *key, xint32 klen,
+		const xvoid *val);
+
+/**
+ * Look up the value associated with a key in a concurrent hash table.
+ * It does not take any lock.
+ *
+ * @param htb The hash table
+ * @param key Pointer to the key
+ * @param klen Length of the key. Can be XI_HASHTB_KEY_STRING to use the string length.
+ * @return Returns NULL if the key is not present.
+ */
+xvoid *xi_hashtb_conc_get(xi_hashtb_conc_t *htb, const xvoid *key, xint32 klen);
+
+/**
+ * Get the number of key/value pairs in a concurrent hash table.
+ *
+ * @param htb The hash table
+ * @return The number of key/value pairs in the hash table.
+ */
+xuint32 xi_hashtb_conc_count(xi_hashtb_conc_t *htb);
+
+/**
+ * Start iterating over the entries in a concurrent hash table.
+ *
+ * @param htb The hash table
+ * @param hidx The iteration state, which is owned by the caller
+ * @return hidx, or NULL if there is no entry
+ *
+ * @remark The iteration runs as a lookup : the entries stay valid until
+ *         it ends, and the changes made during it may or may not be seen.
+ *         An iteration which is left before xi_hashtb_conc_next returns NULL
+ *         must be ended by xi_hashtb_conc_done.
+ */
+xi_hashtb_conc_idx_t *xi_hashtb_conc_first(xi_hashtb_conc_t *htb,
+		xi_hashtb_conc_idx_t *hidx);
+
+/**
+ * Continue iterating over the entries in a concurrent hash table.
+ *
+ * @param hidx The iteration state
+ * @return hidx, or NULL if there are no more entries (the iteration is done)
+ */
+xi_hashtb_conc_idx_t *xi_hashtb_conc_next(xi_hashtb_conc_idx_t *hidx);
+
+/**
+ * Get the current entry's details from the iteration state.
+ *
+ * @param hidx The iteration state
+ * @param key Return pointer for the pointer to the key (the copy in the table).
+ * @param klen Return pointer for the key length.
+ * @param val Return pointer for the associated value.
+ */
+xvoid xi_hashtb_conc_this(xi_hashtb_conc_idx_t *hidx, const xvoid **key,
+		xint32 *klen, xvoid **val);
+
+/**
+ * End an iteration before its end. It does nothing if it is done already.
+ *
+ * @param hidx The iteration state
+ */
+xvoid xi_hashtb_conc_done(xi_hashtb_conc_idx_t *hidx);
+
+/**
+ * Destroy a concurrent hash table.
+ * No other thread may use it any more.
+ *
+ * @param htb The hash table
+ */
+xvoid xi_hashtb_conc_destroy(xi_hashtb_conc_t *htb);
+
 /**
  * @}  // end of xi_hashtb
  */
@@ -46,6 +46,25 @@ _XI_EXTERN_C_BEGIN
 #define XI_LOG_NAME_MAX	 64     ///< Maximum length of logger-name
 #define XI_LOG_INST_MAX  128    ///< Maximum number of logger
 
+/**
+ * Return values of Log Functions
+ */
+typedef enum _e_log_rv {
+	XI_LOG_RV_OK        = 0,    ///< OK
+	XI_LOG_RV_ERR_ARGS  = -1,   ///< Invalid arguments
+	XI_LOG_RV_ERR_NOMEM = -2,   ///< Insufficient memory
+	XI_LOG_RV_ERR_BUSY  = -3,   ///< Already started
+	XI_LOG_RV_ERR_OP    = -4    ///< Failed to start the writer thread
+} xi_log_re;
+
+/**
+ * What a logging thread does when the ring of the async mode is full
+ */
+typedef enum _e_log_overflow {
+	XI_LOG_OVERFLOW_DROP  = 0,  ///< Drop the log, and count it
+	XI_LOG_OVERFLOW_BLOCK = 1   ///< Wait for the writer to make room
+} xi_log_overflow_e;
+
 /**
  * The level of Logs
  */
@@ -100,7 +119,8 @@ xvoid        xi_logger_set_handle(xi_log_fn fn);
  * Get or create a specific logger.
  *
  * @param id the id of logger
- * @return the pointer of logger instance
+ * @return the pointer of logger instance,
+ *         or NULL (the default logger) if XI_LOG_INST_MAX loggers exist
  *
  * @remark do not use it. use logger_get
  */
@@ -144,20 +164,117 @@ xvoid        xi_logger_set_conf(xi_logger_t *logger, xi_logopt_t opt);
 xvoid        xi_logger_write(xi_logger_t *logger, xi_log_level_e level,
 		               const xchar *fname, const xchar *function, xuint32 line,
                        const xchar *format, ...);
+
+/**
+ * Start the async mode.
+ * The logging threads format each log once into a slot of a ring,
+ * and a background thread writes the filled slots in batches (writev),
+ * or hands them to the custom logging function.
+ *
+ * @param slots the number of slots, rounded up to a power of 2 (0 : 1024)
+ * @param overflow xi_log_overflow_e
+ * @return xi_log_re
+ *
+ * @remark Each slot takes XI_LOG_LINE_MAX bytes.
+ */
+xi_log_re    xi_logger_async_start(xuint32 slots, xi_log_overflow_e overflow);
+
+/**
+ * Wait until the logs written so far are out of the ring.
+ */
+xvoid        xi_logger_async_flush();
+
+/**
+ * Flush the ring, stop the background thread and go back to the sync mode.
+ */
+xvoid        xi_logger_async_stop();
+
+/**
+ * Get the number of logs dropped by XI_LOG_OVERFLOW_DROP
+ *
+ * @return the number of dropped logs since xi_logger_async_start
+ */
+xuint32      xi_logger_async_dropped();
+
+/**
+ * Start the binary mode.
+ * A log is recorded as the pointers of its format, file and function,
+ * the timestamp and the raw arguments, without being formatted.
+ * Each of the strings is recorded once, when its pointer is seen first.
+ * It takes the slots of the ring in the async mode,
+ * and is written to the file by the logging thread in the sync mode.
+ *
+ * @param pathname the file to record, which is truncated
+ * @return xi_log_re
+ *
+ * @remark The custom logging function is not called in this mode.
+ *         The file is decoded offline by xi_logger_bin_decode (xilogdec).
+ */
+xi_log_re    xi_logger_bin_start(const xchar *pathname);
+
+/**
+ * Stop the binary mode, after the recorded logs are written.
+ */
+xvoid        xi_logger_bin_stop();
+
+/**
+ * Decode a file of the binary mode into the text logs.
+ *
+ * @param infd the descriptor of the recorded file, which must be seekable
+ * @param outfd the descriptor to write the text logs
+ * @return xi_log_re (XI_LOG_RV_ERR_ARGS : not a file of this machine)
+ *
+ * @remark The file must be decoded by the same build of the program,
+ *         which has the same byte order and the same format strings.
+ */
+xi_log_re    xi_logger_bin_decode(xint32 infd, xint32 outfd);
 /// @}
 
 #define XDLOG  NULL  ///< Default Logger
 
+/**
+ * The lowest level compiled in, as the number of xi_log_level_e.
+ * The calls of the lower levels are removed by the preprocessor,
+ * with their arguments, e.g. -DXCFG_LOG_LEVEL_MIN=3 leaves log_info and above.
+ */
+#ifndef XCFG_LOG_LEVEL_MIN
+#	define XCFG_LOG_LEVEL_MIN    0
+#endif // XCFG_LOG_LEVEL_MIN
+
 #ifdef XCFG_DEBUG
 #		define logger_get(id)                      xi_logger_fetch(id)               ///< Get the logger (xi_logger_fetch)
 #		define logger_get_conf(logger)             xi_logger_get_conf(logger)        ///< Get the options of logger
 #		define logger_set_conf(logger, opt)        xi_logger_set_conf(logger, opt)   ///< Set the options of logger
+#	if XCFG_LOG_LEVEL_MIN <= 1
 #		define log_trace(logger, format, ...)      xi_logger_write(logger, XI_LOG_LEVEL_TRACE, __FILE__, __FUNCTION__, __LINE__, format, ## __VA_ARGS__)  ///< Print the TRACE level log
+#	else
+#		define log_trace(logger, format, ...)      ///< Compiled out by XCFG_LOG_LEVEL_MIN
+#	endif
+#	if XCFG_LOG_LEVEL_MIN <= 2
 #		define log_debug(logger, format, ...)      xi_logger_write(logger, XI_LOG_LEVEL_DEBUG, __FILE__, __FUNCTION__, __LINE__, format, ## __VA_ARGS__)  ///< Print the DEBUG level log
+#	else
+#		define log_debug(logger, format, ...)      ///< Compiled out by XCFG_LOG_LEVEL_MIN
+#	endif
+#	if XCFG_LOG_LEVEL_MIN <= 3
 #		define log_info(logger, format, ...)       xi_logger_write(logger, XI_LOG_LEVEL_INFO,  __FILE__, __FUNCTION__, __LINE__, format, ## __VA_ARGS__)  ///< Print the INFO  level log
+#	else
+#		define log_info(logger, format, ...)       ///< Compiled out by XCFG_LOG_LEVEL_MIN
+#	endif
+#	if XCFG_LOG_LEVEL_MIN <= 4
 #		define log_warn(logger, format, ...)       xi_logger_write(logger, XI_LOG_LEVEL_WARN,  __FILE__, __FUNCTION__, __LINE__, format, ## __VA_ARGS__)  ///< Print the WARN  level log
+#	else
+#		define log_warn(logger, format, ...)       ///< Compiled out by XCFG_LOG_LEVEL_MIN
+#	endif
+#	if XCFG_LOG_LEVEL_MIN <= 5
 #		define log_error(logger, format, ...)      xi_logger_write(logger, XI_LOG_LEVEL_ERROR, __FILE__, __FUNCTION__, __LINE__, format, ## __VA_ARGS__)  ///< Print the ERROR level log
+#	else
+#		define log_error(logger, format, ...)      ///< Compiled out by XCFG_LOG_LEVEL_MIN
+#	endif
+#	if XCFG_LOG_LEVEL_MIN <= 6
 #		define log_fatal(logger, format, ...)      xi_logger_write(logger, XI_LOG_LEVEL_FATAL, __FILE__, __FUNCTION__, __LINE__, format, ## __VA_ARGS__)  ///< Print the FATAL level log
+#	else
+#		define log_fatal(logger, format, ...)      ///< Compiled out by XCFG_LOG_LEVEL_MIN
+#	endif
 #		define log_print(logger, format, ...)      xi_logger_write(logger, XI_LOG_LEVEL_PRINT, __FILE__, __FUNCTION__, __LINE__, format, ## __VA_ARGS__)  ///< Print the PRINT level log
 #else // !XCFG_DEBUG
 #		define logger_get(id)                      NULL  ///< Get the logger (xi_logger_fetch)
@@ -26,6 +26,7 @@
  */
 
 #include "xtype.h"
+#include "xi_log.h"
 
 /**
  * Start Declaration
@@ -165,6 +166,223 @@ xssize	xi_mem_read(xvoid *addr, xsize size, xvoid *buf);
  */
 xssize	xi_mem_write(xvoid *addr, xsize size, xvoid *buf);
 
+
+/**
+ * Abstract handle of arena : the bump allocator of a scope
+ */
+typedef struct _xi_mem_arena xi_mem_arena_t;
+
+
+/**
+ * Create an arena.
+ * An arena hands out the memory from its chunks by bumping an offset,
+ * and takes all of it back at once by xi_mem_arena_reset or destroy.
+ * There is no free of each allocation.
+ *
+ * @param chunk The bytes of a chunk (0 : 64K)
+ * @return a new arena, or NULL
+ *
+ * @remark An arena is used by one thread at a time.
+ */
+xi_mem_arena_t *xi_mem_arena_create(xsize chunk);
+
+
+/**
+ * Allocates size bytes from the arena, aligned for any type.
+ * The memory is not cleared.
+ *
+ * @param arena The arena
+ * @param size The size of memory to allocate
+ * @return a pointer of allocated memory, or NULL
+ *
+ * @remark A request over a quarter of the chunk gets its own block.
+ */
+xvoid  *xi_mem_arena_alloc(xi_mem_arena_t *arena, xsize size);
+
+
+/**
+ * Allocates memory for an array from the arena.
+ * The memory is set to zero.
+ *
+ * @param arena The arena
+ * @param nmemb The number of memory block
+ * @param size The size of each memory block
+ * @return a pointer of allocated memory, or NULL
+ */
+xvoid  *xi_mem_arena_calloc(xi_mem_arena_t *arena, xsize nmemb, xsize size);
+
+
+/**
+ * Get the bytes allocated from the arena since the last reset
+ *
+ * @param arena The arena
+ * @return the allocated bytes, rounded up by the alignment
+ */
+xsize   xi_mem_arena_used(xi_mem_arena_t *arena);
+
+
+/**
+ * Take back all the memory allocated from the arena.
+ * The chunks are kept for the next allocations.
+ *
+ * @param arena The arena
+ */
+xvoid   xi_mem_arena_reset(xi_mem_arena_t *arena);
+
+
+/**
+ * Destroy the arena, and free all of its memory
+ *
+ * @param arena The arena
+ */
+xvoid   xi_mem_arena_destroy(xi_mem_arena_t *arena);
+
+
+/**
+ * Abstract handle of slab : the cache of fixed-size objects
+ */
+typedef struct _xi_mem_slab xi_mem_slab_t;
+
+
+/**
+ * Create a slab.
+ * Each thread keeps two magazines of the free objects,
+ * so that most of the alloc and free calls take no lock.
+ * The magazines are exchanged with the depot of the slab when they run out,
+ * and the depot carves new objects from the pages of the slab.
+ *
+ * @param objsize The size of an object
+ * @return a new slab, or NULL
+ */
+xi_mem_slab_t *xi_mem_slab_create(xsize objsize);
+
+
+/**
+ * Allocates an object from the slab, aligned for any type.
+ * The memory is not cleared.
+ *
+ * @param slab The slab
+ * @return a pointer of an object, or NULL
+ */
+xvoid  *xi_mem_slab_alloc(xi_mem_slab_t *slab);
+
+
+/**
+ * Give an object back to the slab.
+ * It may be freed by any thread.
+ *
+ * @param slab The slab which allocated obj
+ * @param obj The object to be freed
+ */
+xvoid   xi_mem_slab_free(xi_mem_slab_t *slab, xvoid *obj);
+
+
+/**
+ * Give the objects of the magazines of the calling thread back to the depot.
+ *
+ * @param slab The slab
+ *
+ * @remark Call it before a thread exits, or its cached objects stay idle
+ *         until the slab is destroyed.
+ */
+xvoid   xi_mem_slab_flush(xi_mem_slab_t *slab);
+
+
+/**
+ * Destroy the slab, and free all of its objects
+ *
+ * @param slab The slab
+ *
+ * @remark No thread may use the slab or its objects any more.
+ */
+xvoid   xi_mem_slab_destroy(xi_mem_slab_t *slab);
+
+
+/**
+ * Return values of the tracking functions
+ */
+typedef enum _e_mem_rv {
+	XI_MEM_RV_OK        = 0,    ///< OK
+	XI_MEM_RV_ERR_ARGS  = -1,   ///< Invalid arguments
+	XI_MEM_RV_ERR_OP    = -2,   ///< Failed to operate native func
+	XI_MEM_RV_ERR_FULL  = -3    ///< No more tags
+} xi_mem_re;
+
+#define XI_MEM_TAG_MAX      64     ///< Maximum number of tags
+#define XI_MEM_TAG_DEFAULT  0      ///< The tag of a thread which has not set one
+
+
+/**
+ * The counters of a tag
+ */
+typedef struct _st_mem_stat {
+	xuint64 bytes;        ///< Bytes in use
+	xuint64 bytes_peak;   ///< The peak of bytes
+	xuint64 count;        ///< Allocations in use
+	xuint64 count_peak;   ///< The peak of allocations
+} xi_mem_stat_t;
+
+
+/**
+ * Start tracking the allocations of xi_mem_alloc / calloc / realloc.
+ * Each tracked allocation carries a small header with its size and tag,
+ * which are counted to the tag of the allocating thread.
+ * One of every sample allocations of a thread captures its call stack,
+ * so that the sites holding the most memory are shown by xi_mem_track_dump.
+ *
+ * @param sample The period of sampling the call stacks (0 : no sampling)
+ * @return xi_mem_re
+ *
+ * @remark The memory allocated before the start is not counted,
+ *         but it may still be freed or reallocated as usual.
+ */
+xi_mem_re xi_mem_track_start(xuint32 sample);
+
+
+/**
+ * Stop tracking the new allocations.
+ * The tracked ones are still counted out when they are freed.
+ */
+xvoid   xi_mem_track_stop();
+
+
+/**
+ * Get or register a tag
+ *
+ * @param name The name of the tag
+ * @return The tag (>= 0), or xi_mem_re
+ */
+xint32  xi_mem_track_tag(const xchar *name);
+
+
+/**
+ * Set the tag of the allocations of the calling thread
+ *
+ * @param tag The tag from xi_mem_track_tag
+ * @return The previous tag of the thread, or xi_mem_re
+ */
+xint32  xi_mem_track_tag_set(xint32 tag);
+
+
+/**
+ * Get the counters of a tag
+ *
+ * @param tag The tag
+ * @param[out] stat The counters
+ * @return xi_mem_re
+ */
+xi_mem_re xi_mem_track_stat(xint32 tag, xi_mem_stat_t *stat);
+
+
+/**
+ * Write the counters of the tags and the sampled sites
+ * holding the most memory to a logger (XI_LOG_LEVEL_INFO)
+ *
+ * @param logger The logger (NULL : the default logger)
+ * @param nsites The number of the sites to write (up to 32)
+ */
+xvoid   xi_mem_track_dump(xi_logger_t *logger, xuint32 nsites);
+
 #ifndef __arm__
 
 #ifdef _WIN32
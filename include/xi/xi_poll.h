@@ -57,7 +57,7 @@ typedef enum _e_pollset_rv {
  * Poll Option
  */
 typedef enum _e_pollset_opt {
-	XI_POLLSET_OPT_USELOCK  = 0x00000001, ///< Use the lock for Thread-Safe.
+	XI_POLLSET_OPT_USELOCK  = 0x00000001, ///< Use the lock for Thread-Safe. With EPOLL, the wait itself does not hold it.
 	XI_POLLSET_OPT_EPOLL    = 0x00000002  ///< Use EPOLL, if not set, use the normal POLL.
 } xi_pollset_opt_e;
 
@@ -66,12 +66,14 @@ typedef enum _e_pollset_opt {
  * Poll Events
  */
 typedef enum _e_poll_event {
-	XI_POLL_EVENT_IN   = 0x001, ///< There is data to read.
-	XI_POLL_EVENT_PRI  = 0x002, ///< There is urgent data to read.
-	XI_POLL_EVENT_OUT  = 0x004, ///< Writing now will not block.
-	XI_POLL_EVENT_ERR  = 0x010, ///< Error condition (output only).
-	XI_POLL_EVENT_HUP  = 0x020, ///< Hang up (output only).
-	XI_POLL_EVENT_NVAL = 0x040  ///< Invalid request: fd not open (output only).
+	XI_POLL_EVENT_IN      = 0x001, ///< There is data to read.
+	XI_POLL_EVENT_PRI     = 0x002, ///< There is urgent data to read.
+	XI_POLL_EVENT_OUT     = 0x004, ///< Writing now will not block.
+	XI_POLL_EVENT_ERR     = 0x010, ///< Error condition (output only).
+	XI_POLL_EVENT_HUP     = 0x020, ///< Hang up (output only).
+	XI_POLL_EVENT_NVAL    = 0x040, ///< Invalid request: fd not open (output only).
+	XI_POLL_EVENT_ET      = 0x100, ///< Edge-triggered: signal only on changes (input only, EPOLL only).
+	XI_POLL_EVENT_ONESHOT = 0x200  ///< Disarm after one signal until xi_pollset_modify (input only).
 } xi_poll_event_e;
 
 
@@ -112,6 +114,10 @@ xi_pollset_t  *xi_pollset_create(xuint32 size, xint32 opt);
  *
  * @param pset The pollset to which to add the descriptor
  * @param fd The descriptor to add
+ *
+ * @remark A descriptor can be added only once to the same pollset.
+ * @remark On an XI_POLLSET_OPT_EPOLL pollset created with XI_POLLSET_OPT_USELOCK,
+ *         it can be called while another thread is blocked in xi_pollset_poll.
  */
 xi_pollset_re  xi_pollset_add(xi_pollset_t *pset, xi_pollfd_t fd);
 
@@ -120,11 +126,28 @@ xi_pollset_re  xi_pollset_add(xi_pollset_t *pset, xi_pollfd_t fd);
  * Remove a descriptor from a pollset
  *
  * @param pset The pollset from which to remove the descriptor
- * @param fd The descriptor to remove
+ * @param fd The descriptor to remove (only fd.desc is used)
+ *
+ * @remark On an XI_POLLSET_OPT_EPOLL pollset created with XI_POLLSET_OPT_USELOCK,
+ *         it can be called while another thread is blocked in xi_pollset_poll.
+ *         Pending events of the removed descriptor are not reported.
  */
 xi_pollset_re  xi_pollset_remove(xi_pollset_t *pset, xi_pollfd_t fd);
 
 
+/**
+ * Change the events and the context of a descriptor in a pollset
+ *
+ * @param pset The pollset in which the descriptor was added
+ * @param fd The descriptor to modify, with its new events and context
+ *
+ * @remark It re-arms a descriptor disarmed by XI_POLL_EVENT_ONESHOT.
+ * @remark On an XI_POLLSET_OPT_EPOLL pollset created with XI_POLLSET_OPT_USELOCK,
+ *         it can be called while another thread is blocked in xi_pollset_poll.
+ */
+xi_pollset_re  xi_pollset_modify(xi_pollset_t *pset, xi_pollfd_t fd);
+
+
 /**
  * Destroy a pollset object
  *
@@ -144,7 +167,9 @@ xi_pollset_re  xi_pollset_destroy(xi_pollset_t *pset);
  *              function will return before this time.  If timeout is
  *              negative, the function will block until a descriptor is
  *              signaled.
- * @return The number of signaled descriptors
+ * @return The number of signaled descriptors, XI_POLLSET_RV_ERR_TIMEOUT on timeout,
+ *         XI_POLLSET_RV_ERR_INTR if interrupted or if every signaled descriptor
+ *         was removed while waiting
  */
 xint32        xi_pollset_poll(xi_pollset_t *pset, xi_pollfd_t  *rfds,
 		        xint32 rlen, xint32 msecs);
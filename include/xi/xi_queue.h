@@ -0,0 +1,220 @@
+/*
+ * Copyright 2013 Cheolmin Jo (webos21@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _XI_QUEUE_H_
+#define _XI_QUEUE_H_
+
+/**
+ * @brief XI Concurrent Queue API
+ *
+ * @file xi_queue.h
+ * @date 2013-06-28
+ * @author Cheolmin Jo (webos21@gmail.com)
+ */
+
+#include "xtype.h"
+
+/**
+ * Start Declaration
+ */
+_XI_EXTERN_C_BEGIN
+
+/**
+ * @defgroup xi_queue Concurrent Queue API
+ * @ingroup XI
+ * @{
+ * @brief
+ *
+ * Bounded lock-free queues of pointers, built on the xi_atomic API.
+ *  - SPSC : a ring for exactly one producer thread and one consumer thread.
+ *  - MPMC : a queue for any number of producer and consumer threads.
+ *
+ * push/pop never block : they fail with XI_QUEUE_RV_ERR_FULL/EMPTY.
+ * put/take wait for room/item up to the given milliseconds (-1 is forever).
+ * They spin for a while before sleeping, and a sleeping thread is woken up
+ * by the next pop/push of the other side.
+ * NULL can be queued like any other pointer.
+ */
+
+/**
+ * Return values of Queue Functions
+ */
+typedef enum _e_queue_rv {
+	XI_QUEUE_RV_OK          = 0,    ///< OK
+	XI_QUEUE_RV_ERR_NOMEM   = -1,   ///< Insufficient memory
+	XI_QUEUE_RV_ERR_FULL    = -2,   ///< No room to push
+	XI_QUEUE_RV_ERR_EMPTY   = -3,   ///< No item to pop
+	XI_QUEUE_RV_ERR_TIMEOUT = -4,   ///< Timeout occurred
+	XI_QUEUE_RV_ERR_ARGS    = -5    ///< Invalid arguments
+} xi_queue_re;
+
+
+/**
+ * Abstract handle of SPSC ring
+ */
+typedef struct _xi_queue_spsc xi_queue_spsc_t;
+
+/**
+ * Abstract handle of MPMC queue
+ */
+typedef struct _xi_queue_mpmc xi_queue_mpmc_t;
+
+
+/**
+ * Create a single-producer / single-consumer ring
+ *
+ * @param capacity The number of items, rounded up to a power of 2
+ * @return The newly created ring, or NULL
+ */
+xi_queue_spsc_t   *xi_queue_spsc_create(xuint32 capacity);
+
+
+/**
+ * Push an item without blocking (producer thread only)
+ *
+ * @param q The ring
+ * @param item The item to push
+ * @return XI_QUEUE_RV_OK, or XI_QUEUE_RV_ERR_FULL
+ */
+xi_queue_re        xi_queue_spsc_push(xi_queue_spsc_t *q, xvoid *item);
+
+
+/**
+ * Pop an item without blocking (consumer thread only)
+ *
+ * @param q The ring
+ * @param item The pointer in which to return the item
+ * @return XI_QUEUE_RV_OK, or XI_QUEUE_RV_ERR_EMPTY
+ */
+xi_queue_re        xi_queue_spsc_pop(xi_queue_spsc_t *q, xvoid **item);
+
+
+/**
+ * Push an item, waiting for room (producer thread only)
+ *
+ * @param q The ring
+ * @param item The item to push
+ * @param msec The milliseconds to wait (-1 : forever)
+ * @return XI_QUEUE_RV_OK, or XI_QUEUE_RV_ERR_TIMEOUT
+ */
+xi_queue_re        xi_queue_spsc_put(xi_queue_spsc_t *q, xvoid *item, xint32 msec);
+
+
+/**
+ * Pop an item, waiting for one (consumer thread only)
+ *
+ * @param q The ring
+ * @param item The pointer in which to return the item
+ * @param msec The milliseconds to wait (-1 : forever)
+ * @return XI_QUEUE_RV_OK, or XI_QUEUE_RV_ERR_TIMEOUT
+ */
+xi_queue_re        xi_queue_spsc_take(xi_queue_spsc_t *q, xvoid **item, xint32 msec);
+
+
+/**
+ * Get the number of queued items (a snapshot)
+ *
+ * @param q The ring
+ * @return The number of items
+ */
+xuint32            xi_queue_spsc_count(xi_queue_spsc_t *q);
+
+
+/**
+ * Destroy a ring. The remaining items are just dropped.
+ *
+ * @param q The ring to destroy
+ */
+xi_queue_re        xi_queue_spsc_destroy(xi_queue_spsc_t *q);
+
+
+/**
+ * Create a multi-producer / multi-consumer queue
+ *
+ * @param capacity The number of items, rounded up to a power of 2 (at least 2)
+ * @return The newly created queue, or NULL
+ */
+xi_queue_mpmc_t   *xi_queue_mpmc_create(xuint32 capacity);
+
+
+/**
+ * Push an item without blocking
+ *
+ * @param q The queue
+ * @param item The item to push
+ * @return XI_QUEUE_RV_OK, or XI_QUEUE_RV_ERR_FULL
+ */
+xi_queue_re        xi_queue_mpmc_push(xi_queue_mpmc_t *q, xvoid *item);
+
+
+/**
+ * Pop an item without blocking
+ *
+ * @param q The queue
+ * @param item The pointer in which to return the item
+ * @return XI_QUEUE_RV_OK, or XI_QUEUE_RV_ERR_EMPTY
+ */
+xi_queue_re        xi_queue_mpmc_pop(xi_queue_mpmc_t *q, xvoid **item);
+
+
+/**
+ * Push an item, waiting for room
+ *
+ * @param q The queue
+ * @param item The item to push
+ * @param msec The milliseconds to wait (-1 : forever)
+ * @return XI_QUEUE_RV_OK, or XI_QUEUE_RV_ERR_TIMEOUT
+ */
+xi_queue_re        xi_queue_mpmc_put(xi_queue_mpmc_t *q, xvoid *item, xint32 msec);
+
+
+/**
+ * Pop an item, waiting for one
+ *
+ * @param q The queue
+ * @param item The pointer in which to return the item
+ * @param msec The milliseconds to wait (-1 : forever)
+ * @return XI_QUEUE_RV_OK, or XI_QUEUE_RV_ERR_TIMEOUT
+ */
+xi_queue_re        xi_queue_mpmc_take(xi_queue_mpmc_t *q, xvoid **item, xint32 msec);
+
+
+/**
+ * Get the number of queued items (a snapshot)
+ *
+ * @param q The queue
+ * @return The number of items
+ */
+xuint32            xi_queue_mpmc_count(xi_queue_mpmc_t *q);
+
+
+/**
+ * Destroy a queue. The remaining items are just dropped.
+ *
+ * @param q The queue to destroy
+ */
+xi_queue_re        xi_queue_mpmc_destroy(xi_queue_mpmc_t *q);
+
+/**
+ * @}  // end of xi_queue
+ */
+
+/**
+ * End Declaration
+ */
+_XI_EXTERN_C_END
+
+#endif // _XI_QUEUE_H_
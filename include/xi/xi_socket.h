@@ -119,6 +119,7 @@ typedef enum _e_sock_opt {
 	XI_SOCK_OPT_DEBUG      = 4,     ///< Debug Info on/off
 	XI_SOCK_OPT_NONBLOCK   = 8,     ///< Turn blocking on/off
 	XI_SOCK_OPT_REUSEADDR  = 16,    ///< Reuse address on/off
+	XI_SOCK_OPT_REUSEPORT  = 32,    ///< Share the port by listeners on/off (XI_SOCK_RV_ERR_NS if not supported)
 	XI_SOCK_OPT_SENDBUF    = 64,    ///< Send Buffer Size
 	XI_SOCK_OPT_RECVBUF    = 128,   ///< Receive Buffer Size
 	XI_SOCK_OPT_SNDTIMEO   = 140,   ///< Send Timeout
@@ -127,6 +128,15 @@ typedef enum _e_sock_opt {
 } xi_sock_opt_e;
 
 
+/**
+ * Flags of the accepted socket (xi_socket_accept4)
+ */
+typedef enum _e_sock_accept {
+	XI_SOCK_ACCEPT_NONBLOCK = 1,    ///< Accepted socket is non-blocking
+	XI_SOCK_ACCEPT_CLOEXEC  = 2     ///< Accepted socket is closed on exec
+} xi_sock_accept_e;
+
+
 /**
  * Socket address type, used to ensure protocol independence.
  */
@@ -139,12 +149,45 @@ typedef struct _st_sock_addr {
 } xi_sock_addr_t;
 
 
+/**
+ * Binary socket address (IPv4 / IPv6 only).
+ *
+ * It carries the raw address instead of the text, so the *_bin functions
+ * just copy it from/to the sockaddr of the system.
+ * The unused bytes of addr are always zero, so that two addresses can be
+ * compared with xi_mem_cmp.
+ */
+typedef struct _st_sock_addr_bin {
+	xuint16           family;                     ///< family (xi_sock_family_e)
+	xuint16           port;                       ///< port (host byte order)
+	xuint32           scope;                      ///< scope-id (IPv6 only)
+	xuint8            addr[16];                   ///< address (network byte order, 4 bytes for IPv4)
+} xi_sock_addr_bin_t;
+
+
+/**
+ * Datagram for the batched I/O (xi_socket_recvmmsg / xi_socket_sendmmsg)
+ */
+typedef struct _st_sock_msg {
+	xvoid              *buf;                      ///< data buffer
+	xsize               blen;                     ///< buffer size (recv) / data length (send)
+	xssize              len;                      ///< received / sent bytes (set by the call)
+	xi_sock_addr_bin_t  addr;                     ///< source (recv) / destination (send)
+} xi_sock_msg_t;
+
+
 /**
  * Abstract handle of socket (same as file descriptor)
  */
 typedef xfd  xi_sock_t;
 
 
+/**
+ * Abstract handle of listener group
+ */
+typedef struct _xi_sock_lgroup xi_sock_lgroup_t;
+
+
 /**
  * Create a socket.
  *
@@ -359,6 +402,195 @@ xi_sock_re   xi_socket_get_peer(xint32 sfd, xi_sock_addr_t *addr);
 xi_sock_re   xi_socket_get_local(xint32 sfd, xi_sock_addr_t *addr);
 
 
+/**
+ * Convert a text address to the binary address.
+ *
+ * @param addr The text address (XI_SOCK_FAMILY_INET or XI_SOCK_FAMILY_INET6)
+ * @param baddr The converted binary address
+ */
+xi_sock_re   xi_socket_addr_pton(const xi_sock_addr_t *addr, xi_sock_addr_bin_t *baddr);
+
+
+/**
+ * Convert a binary address to the text address.
+ * The type and proto of @a addr are left untouched.
+ *
+ * @param baddr The binary address
+ * @param addr The converted text address
+ */
+xi_sock_re   xi_socket_addr_ntop(const xi_sock_addr_bin_t *baddr, xi_sock_addr_t *addr);
+
+
+/**
+ * Bind the socket to the binary address.
+ *
+ * @param sfd The socket to bind
+ * @param baddr The binary address to bind to
+ * @see xi_socket_bind
+ */
+xi_sock_re   xi_socket_bind_bin(xint32 sfd, const xi_sock_addr_bin_t *baddr);
+
+
+/**
+ * Accept a new connection request, returning the binary address of the peer.
+ *
+ * @param sfd The socket we are listening on.
+ * @param fromaddr Newly arrived connection address (can be NULL)
+ * @return The accepted socket, or XI_SOCK_RV_ERR_TRYLATER on the non-blocking
+ *         socket without any pending connection.
+ * @see xi_socket_accept
+ */
+xint32       xi_socket_accept_bin(xint32 sfd, xi_sock_addr_bin_t *fromaddr);
+
+
+/**
+ * Connect to the binary address.
+ * XI_SOCK_FAMILY_UNSPEC dissolves the association of a datagram socket.
+ *
+ * @param sfd The socket we wish to use for our side of the connection
+ * @param caddr The binary address to connect to
+ * @see xi_socket_connect
+ */
+xi_sock_re   xi_socket_connect_bin(xint32 sfd, const xi_sock_addr_bin_t *caddr);
+
+
+/**
+ * Accept a new connection request, setting the flags of the accepted socket
+ * in the same system call (accept4) where available.
+ *
+ * @param sfd The socket we are listening on.
+ * @param fromaddr Newly arrived connection address (can be NULL)
+ * @param flags The OR-ed xi_sock_accept_e flags (0 is the same as
+ *              xi_socket_accept_bin)
+ * @return The accepted socket, or XI_SOCK_RV_ERR_TRYLATER on the non-blocking
+ *         socket without any pending connection.
+ * @see xi_socket_accept_bin
+ */
+xint32       xi_socket_accept4(xint32 sfd, xi_sock_addr_bin_t *fromaddr, xint32 flags);
+
+
+/**
+ * Read data from a socket, returning the binary address of the sender.
+ *
+ * @param sfd The socket to use
+ * @param buf  The buffer to use
+ * @param blen  The length of the available buffer
+ * @param fromaddr Updated with the address from which the data was received
+ *                 (can be NULL)
+ * @return The received bytes, or XI_SOCK_RV_ERR_TRYLATER on the non-blocking
+ *         socket without any data.
+ * @see xi_socket_recvfrom
+ */
+xssize       xi_socket_recvfrom_bin(xint32 sfd, xvoid *buf, xsize blen, xi_sock_addr_bin_t *fromaddr);
+
+
+/**
+ * Send data to the binary address.
+ *
+ * @param sfd The socket to send from
+ * @param buf  The data to send
+ * @param blen  The length of the data to send
+ * @param toaddr The binary address where to send the data
+ * @return The sent bytes, or XI_SOCK_RV_ERR_TRYLATER on the non-blocking
+ *         socket with the full send buffer.
+ * @see xi_socket_sendto
+ */
+xssize       xi_socket_sendto_bin(xint32 sfd, const xvoid *buf, xsize blen, const xi_sock_addr_bin_t *toaddr);
+
+
+/**
+ * Return the binary address of the peer
+ *
+ * @param sfd The socket to use
+ * @param addr The returned binary address
+ */
+xi_sock_re   xi_socket_get_peer_bin(xint32 sfd, xi_sock_addr_bin_t *addr);
+
+
+/**
+ * Return the binary address of the local
+ *
+ * @param sfd The socket to use
+ * @param addr The returned binary address
+ */
+xi_sock_re   xi_socket_get_local_bin(xint32 sfd, xi_sock_addr_bin_t *addr);
+
+
+/**
+ * Open a group of TCP listeners on the same address, one per worker.
+ * Each listener is a separate socket with XI_SOCK_OPT_REUSEPORT, so that the
+ * kernel spreads the incoming connections over their listen queues.
+ * Where the option is not supported, the group has a single listener
+ * that is shared by all workers.
+ *
+ * @param baddr The binary address to listen on (port 0 : any free port,
+ *              the same for all listeners)
+ * @param count The number of listeners (workers)
+ * @param backlog The listen queue size of each listener
+ * @return The new listener group, or NULL
+ */
+xi_sock_lgroup_t *xi_socket_lgroup_open(const xi_sock_addr_bin_t *baddr, xint32 count, xint32 backlog);
+
+
+/**
+ * Get the number of listening sockets in the group
+ *
+ * @param grp The listener group
+ * @return The number of sockets (1 without XI_SOCK_OPT_REUSEPORT)
+ */
+xint32       xi_socket_lgroup_count(xi_sock_lgroup_t *grp);
+
+
+/**
+ * Get the listening socket of a worker
+ *
+ * @param grp The listener group
+ * @param idx The index of the worker (0 ~ count of xi_socket_lgroup_open - 1)
+ * @return The listening socket to accept on
+ */
+xint32       xi_socket_lgroup_fd(xi_sock_lgroup_t *grp, xint32 idx);
+
+
+/**
+ * Close all listeners and release the group
+ *
+ * @param grp The listener group to close
+ */
+xi_sock_re   xi_socket_lgroup_close(xi_sock_lgroup_t *grp);
+
+
+/**
+ * Receive a burst of datagrams with a single system call (recvmmsg).
+ *
+ * @param sfd The datagram socket to use
+ * @param msgs The array of datagrams : buf and blen are given,
+ *             len and addr are returned.
+ * @param count The number of datagrams in @a msgs
+ * @return The number of received datagrams, or the error value < 0
+ *         (XI_SOCK_RV_ERR_TRYLATER on the non-blocking socket without any data)
+ *
+ * @remark On the blocking socket, it waits for the first datagram only and
+ *      takes the rest that are already queued, without waiting any more.
+ *      Where recvmmsg is not available, it is done by repeating recvfrom.
+ */
+xint32       xi_socket_recvmmsg(xint32 sfd, xi_sock_msg_t *msgs, xint32 count);
+
+
+/**
+ * Send a burst of datagrams with a single system call (sendmmsg).
+ *
+ * @param sfd The datagram socket to use
+ * @param msgs The array of datagrams : buf, blen and addr are given
+ *             (XI_SOCK_FAMILY_UNSPEC addr for the connected socket),
+ *             len is returned.
+ * @param count The number of datagrams in @a msgs
+ * @return The number of sent datagrams, or the error value < 0
+ *
+ * @remark Where sendmmsg is not available, it is done by repeating sendto.
+ */
+xint32       xi_socket_sendmmsg(xint32 sfd, xi_sock_msg_t *msgs, xint32 count);
+
+
 /**
  * Join a Multicast Group
  *
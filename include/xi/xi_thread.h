@@ -26,6 +26,7 @@
  */
 
 #include "xtype.h"
+#include "xi_hashtb.h"
 
 /**
  * Start Declaration
@@ -58,6 +59,16 @@ typedef xuintptr  xi_thread_mutex_t;
  */
 typedef xuintptr  xi_thread_cond_t;
 
+/**
+ * The type of reader-writer lock handle
+ */
+typedef xuintptr  xi_thread_rwlock_t;
+
+/**
+ * The type of sequence lock handle
+ */
+typedef xuintptr  xi_thread_seqlock_t;
+
 
 /**
  * Return values of Thread Functions
@@ -138,6 +149,30 @@ typedef enum _e_cond_rv {
 	XI_COND_RV_ERR_ARGS    = -6   ///< Invalid arguments.
 } xi_thread_cond_re;
 
+
+/**
+ * Return values of RWLock Functions
+ */
+typedef enum _e_rwlock_rv {
+	XI_RWLOCK_RV_OK         = 0,
+	XI_RWLOCK_RV_ERR_NOMORE = -1,  ///< Cannot create (or read-lock) any more.
+	XI_RWLOCK_RV_ERR_NOMEM  = -2,  ///< Insufficient memory.
+	XI_RWLOCK_RV_ERR_PERM   = -3,  ///< Insufficient privilege of Caller.
+	XI_RWLOCK_RV_ERR_BUSY   = -4,  ///< Already Locked by other.
+	XI_RWLOCK_RV_ERR_AGAIN  = -5,  ///< Already Write-Locked by self.
+	XI_RWLOCK_RV_ERR_ARGS   = -6   ///< Invalid arguments.
+} xi_thread_rwlock_re;
+
+
+/**
+ * Return values of SeqLock Functions
+ */
+typedef enum _e_seqlock_rv {
+	XI_SEQLOCK_RV_OK        = 0,
+	XI_SEQLOCK_RV_ERR_NOMEM = -2,  ///< Insufficient memory.
+	XI_SEQLOCK_RV_ERR_ARGS  = -6   ///< Invalid arguments.
+} xi_thread_seqlock_re;
+
 /**
  * The signature of thread function (function pointer)
  */
@@ -183,6 +218,10 @@ xi_thread_key_re    xi_thread_key_destroy(xi_thread_key_t key);
  * @param lock the memory address where the newly created mutex will be
  *        stored.
  * @param mname the name of the newly created mutex.
+ *
+ * @remark Where the platform supports it, a contended lock spins for a short
+ * while before the thread is put to sleep (glibc adaptive mutex on posix,
+ * critical section with a spin count on win32).
  */
 xi_thread_mutex_re  xi_thread_mutex_create(xi_thread_mutex_t *lock, xchar *mname);
 
@@ -304,6 +343,134 @@ xi_thread_cond_re   xi_thread_cond_signal(xi_thread_cond_t *cond);
 xi_thread_cond_re   xi_thread_cond_destroy(xi_thread_cond_t *cond);
 
 
+/**
+ * Create and initialize a reader-writer lock, which lets many readers or
+ * a single writer hold it at a time.
+ *
+ * @param rwlock the memory address where the newly created lock will be
+ *        stored.
+ * @param rname the name of the newly created lock.
+ */
+xi_thread_rwlock_re xi_thread_rwlock_create(xi_thread_rwlock_t *rwlock, xchar *rname);
+
+
+/**
+ * Acquire a shared read lock. If a writer holds (or, depending on the
+ * platform, waits for) the lock, the current thread will be put to sleep.
+ *
+ * @param rwlock the lock on which to acquire the read lock.
+ */
+xi_thread_rwlock_re xi_thread_rwlock_rdlock(xi_thread_rwlock_t *rwlock);
+
+
+/**
+ * Attempt to acquire a shared read lock. If a writer holds the lock,
+ * the call returns immediately with XI_RWLOCK_RV_ERR_BUSY.
+ *
+ * @param rwlock the lock on which to acquire the read lock.
+ */
+xi_thread_rwlock_re xi_thread_rwlock_tryrdlock(xi_thread_rwlock_t *rwlock);
+
+
+/**
+ * Acquire an exclusive write lock. If any reader or writer holds the lock,
+ * the current thread will be put to sleep.
+ *
+ * @param rwlock the lock on which to acquire the write lock.
+ */
+xi_thread_rwlock_re xi_thread_rwlock_wrlock(xi_thread_rwlock_t *rwlock);
+
+
+/**
+ * Attempt to acquire an exclusive write lock. If any reader or writer holds
+ * the lock, the call returns immediately with XI_RWLOCK_RV_ERR_BUSY.
+ *
+ * @param rwlock the lock on which to acquire the write lock.
+ */
+xi_thread_rwlock_re xi_thread_rwlock_trywrlock(xi_thread_rwlock_t *rwlock);
+
+
+/**
+ * Release the read or write lock held by the current thread.
+ *
+ * @param rwlock the lock from which to release.
+ */
+xi_thread_rwlock_re xi_thread_rwlock_unlock(xi_thread_rwlock_t *rwlock);
+
+
+/**
+ * Destroy the reader-writer lock and free the associated memory.
+ *
+ * @param rwlock the lock to destroy.
+ */
+xi_thread_rwlock_re xi_thread_rwlock_destroy(xi_thread_rwlock_t *rwlock);
+
+
+/**
+ * Create and initialize a sequence lock, which protects a small snapshot
+ * that is rarely written and often read. Readers never block a writer nor
+ * write to the lock; they retry when a write has overlapped their read.
+ *
+ * @code
+ * do {
+ *     seq = xi_thread_seqlock_read_begin(&sl);
+ *     copy = shared;
+ * } while (xi_thread_seqlock_read_retry(&sl, seq));
+ * @endcode
+ *
+ * @param seqlock the memory address where the newly created lock will be
+ *        stored.
+ * @param sname the name of the newly created lock.
+ */
+xi_thread_seqlock_re xi_thread_seqlock_create(xi_thread_seqlock_t *seqlock, xchar *sname);
+
+
+/**
+ * Start a write, excluding the other writers.
+ *
+ * @param seqlock the lock on which to start a write.
+ */
+xi_thread_seqlock_re xi_thread_seqlock_lock(xi_thread_seqlock_t *seqlock);
+
+
+/**
+ * Finish the write started by xi_thread_seqlock_lock.
+ *
+ * @param seqlock the lock on which to finish the write.
+ */
+xi_thread_seqlock_re xi_thread_seqlock_unlock(xi_thread_seqlock_t *seqlock);
+
+
+/**
+ * Start a read. It waits while a write is in progress.
+ *
+ * @param seqlock the lock on which to start a read.
+ * @return The sequence to give to xi_thread_seqlock_read_retry
+ *
+ * @remark The data read before xi_thread_seqlock_read_retry returns FALSE
+ * may be torn, so it must be copied, not followed as pointers.
+ */
+xuint32             xi_thread_seqlock_read_begin(xi_thread_seqlock_t *seqlock);
+
+
+/**
+ * Check whether a write has overlapped the read started with the given sequence.
+ *
+ * @param seqlock the lock on which the read was started.
+ * @param seq the value returned by xi_thread_seqlock_read_begin.
+ * @return TRUE if the read must be retried, FALSE if the data read is consistent
+ */
+xbool               xi_thread_seqlock_read_retry(xi_thread_seqlock_t *seqlock, xuint32 seq);
+
+
+/**
+ * Destroy the sequence lock and free the associated memory.
+ *
+ * @param seqlock the lock to destroy.
+ */
+xi_thread_seqlock_re xi_thread_seqlock_destroy(xi_thread_seqlock_t *seqlock);
+
+
 /**
  * Create a new thread of execution
  *
@@ -549,8 +716,10 @@ xint32        xi_thread_is_suspendable(xi_thread_t tid);
 
 /**
  * Get the thread-list
+ *
+ * @return The xi_hashtb_conc_t of the threads, keyed by xi_thread_t
  */
-xvoid        *xi_thread_list();
+xi_hashtb_conc_t *xi_thread_list();
 
 
 /**
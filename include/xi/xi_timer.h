@@ -0,0 +1,158 @@
+/*
+ * Copyright 2013 Cheolmin Jo (webos21@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _XI_TIMER_H_
+#define _XI_TIMER_H_
+
+/**
+ * @brief XI Timer API
+ *
+ * @file xi_timer.h
+ * @date 2013-06-24
+ * @author Cheolmin Jo (webos21@gmail.com)
+ */
+
+#include "xtype.h"
+
+/**
+ * Start Declaration
+ */
+_XI_EXTERN_C_BEGIN
+
+/**
+ * @defgroup xi_timer Timer API
+ * @ingroup XI
+ * @{
+ * @brief
+ *
+ * A timer object is a hierarchical timing wheel driven by xi_clock_ntick.
+ * Adding and cancelling a timer take constant time, whatever the number
+ * of timers is. It does not own any thread: the owner calls xi_timer_run
+ * after waiting for xi_timer_next milliseconds, typically as the timeout
+ * of xi_pollset_poll. A timer object is not thread-safe.
+ */
+
+/**
+ * Return values of Timer Functions
+ */
+typedef enum _e_timer_rv {
+	XI_TIMER_RV_OK         = 0,    ///< OK
+	XI_TIMER_RV_ERR_NOMEM  = -1,   ///< Insufficient memory
+	XI_TIMER_RV_ERR_NF     = -2,   ///< Not Found (already fired or cancelled)
+	XI_TIMER_RV_ERR_ARGS   = -3    ///< Invalid Arguments
+} xi_timer_re;
+
+
+/**
+ * Abstract handle of timer object
+ */
+typedef struct _xi_timer xi_timer_t;
+
+
+/**
+ * The signature of timer callback
+ *
+ * @param timer The timer object
+ * @param tid The id of the expired timer
+ * @param arg The argument given to xi_timer_add
+ */
+typedef xvoid (*xi_timer_fn)(xi_timer_t *timer, xint64 tid, xvoid *arg);
+
+
+/**
+ * Create a timer object
+ *
+ * @param resolution The length of a tick in milliseconds (0 means 1)
+ * @return The pointer in which to return the newly created object
+ */
+xi_timer_t    *xi_timer_create(xuint32 resolution);
+
+
+/**
+ * Destroy a timer object, without calling the pending timers
+ *
+ * @param timer The timer object to destroy
+ */
+xi_timer_re    xi_timer_destroy(xi_timer_t *timer);
+
+
+/**
+ * Add a timer
+ *
+ * @param timer The timer object
+ * @param msecs The delay in milliseconds
+ * @param interval The period in milliseconds of a repeating timer, 0 for a one-shot timer
+ * @param func The callback to be called from xi_timer_run
+ * @param arg The argument of the callback
+ * @return The id of the new timer (>= 0), or xi_timer_re (< 0)
+ *
+ * @remark It can be called from a timer callback.
+ */
+xint64         xi_timer_add(xi_timer_t *timer, xuint32 msecs, xuint32 interval,
+		xi_timer_fn func, xvoid *arg);
+
+
+/**
+ * Cancel a timer
+ *
+ * @param timer The timer object
+ * @param tid The id returned by xi_timer_add
+ *
+ * @remark A repeating timer can cancel itself from its callback.
+ */
+xi_timer_re    xi_timer_cancel(xi_timer_t *timer, xint64 tid);
+
+
+/**
+ * Get the number of pending timers
+ *
+ * @param timer The timer object
+ * @return The number of pending timers
+ */
+xint32         xi_timer_count(xi_timer_t *timer);
+
+
+/**
+ * Get the time to wait before the next call of xi_timer_run
+ *
+ * @param timer The timer object
+ * @return The milliseconds to wait, or -1 if no timer is pending
+ *         (as the timeout of xi_pollset_poll)
+ *
+ * @remark The far timers are cascaded to the near wheel on the way,
+ *         so that it can be shorter than the delay of the nearest timer.
+ */
+xint32         xi_timer_next(xi_timer_t *timer);
+
+
+/**
+ * Call the callbacks of the expired timers
+ *
+ * @param timer The timer object
+ * @return The number of called callbacks
+ */
+xint32         xi_timer_run(xi_timer_t *timer);
+
+/**
+ * @}  // end of xi_timer
+ */
+
+/**
+ * End Declaration
+ */
+_XI_EXTERN_C_END
+
+#endif // _XI_TIMER_H_
@@ -80,6 +80,22 @@ public interface IFileSystem {
 	public long writeDirect(int fileDescriptor, int address, int offset,
 			int length) throws IOException;
 
+	/**
+	 * Reads at the file position, not moving the file pointer.
+	 * Returns -1 at the end of file.
+	 */
+	public long pread(int fileDescriptor, byte[] bytes, int offset,
+			int length, long position) throws IOException;
+
+	public long pwrite(int fileDescriptor, byte[] bytes, int offset,
+			int length, long position) throws IOException;
+
+	public long preadDirect(int fileDescriptor, int address, int offset,
+			int length, long position) throws IOException;
+
+	public long pwriteDirect(int fileDescriptor, int address, int offset,
+			int length, long position) throws IOException;
+
 	public long length(int fd);
 
 	public boolean lock(int fileDescriptor, long start, long length, int type,
@@ -105,6 +121,29 @@ public interface IFileSystem {
 	public long transfer(int fileHandler, FileDescriptor socketDescriptor,
 			long offset, long count) throws IOException;
 
+	/**
+	 * Moves up to count bytes of the file at offset to a socket or a pipe,
+	 * without copying them through the user space where possible.
+	 * Returns 0 if the non-blocking target is full.
+	 */
+	public long spliceTo(int fileHandler, long offset,
+			FileDescriptor targetDescriptor, long count) throws IOException;
+
+	/**
+	 * Moves up to count bytes from a socket or a pipe to the file at offset,
+	 * without copying them through the user space where possible.
+	 * Returns 0 if the non-blocking source has nothing to read.
+	 */
+	public long spliceFrom(FileDescriptor sourceDescriptor, int fileHandler,
+			long offset, long count) throws IOException;
+
+	/**
+	 * Copies count bytes (less only at the end of the source) between two
+	 * files inside the kernel where possible. The file positions are kept.
+	 */
+	public long copyRange(int srcHandler, long srcOffset, int dstHandler,
+			long dstOffset, long count) throws IOException;
+
 	// BEGIN android-deleted
 	// public long ttyAvailable() throws IOException;
 	// public long ttyRead(byte[] bytes, int offset, int length) throws
@@ -70,6 +70,27 @@ public interface INetworkSystem {
 			int address, int offset, int length, boolean peek, boolean connected)
 			throws IOException;
 
+	/**
+	 * Receives up to {@code count} datagrams into the packets from
+	 * {@code offset} at once. Blocks (if the fd is blocking) only until the
+	 * first one arrives.
+	 * 
+	 * @return the number of packets filled, which may be less than
+	 *         {@code count}
+	 */
+	public int recvBatch(FileDescriptor fd, DatagramPacket[] packets,
+			int offset, int count, boolean connected) throws IOException;
+
+	/**
+	 * Sends up to {@code count} packets from {@code offset} at once. A packet
+	 * without an address goes to the connected peer.
+	 * 
+	 * @return the number of packets sent, which may be less than
+	 *         {@code count}
+	 */
+	public int sendBatch(FileDescriptor fd, DatagramPacket[] packets,
+			int offset, int count) throws IOException;
+
 	public void disconnectDatagram(FileDescriptor fd) throws SocketException;
 
 	public void socket(FileDescriptor fd, boolean stream)
@@ -122,6 +143,80 @@ public interface INetworkSystem {
 			int numReadable, int numWritable, long timeout, int[] flags)
 			throws SocketException;
 
+	/**
+	 * Creates a persistent poll set able to hold {@code size} descriptors.
+	 * Unlike {@link #select}, registrations survive between waits, so only
+	 * changes have to be passed down to the kernel.
+	 * 
+	 * @param size
+	 *            the maximum number of descriptors the set can hold
+	 * @return an opaque handle of the poll set
+	 * @throws SocketException
+	 */
+	public long pollsetCreate(int size) throws SocketException;
+
+	/**
+	 * Releases a poll set created by {@link #pollsetCreate}.
+	 */
+	public void pollsetDestroy(long pollset);
+
+	/**
+	 * Registers a descriptor in the poll set.
+	 * 
+	 * @param ops
+	 *            a combination of {@code SelectorImpl.READABLE} and
+	 *            {@code SelectorImpl.WRITABLE}
+	 * @param index
+	 *            a caller-defined index reported back by {@link #pollsetWait}
+	 * @return the native descriptor, to be passed to {@link #pollsetRemove}
+	 *         once the {@code FileDescriptor} may already be closed
+	 * @throws SocketException
+	 */
+	public int pollsetAdd(long pollset, FileDescriptor fd, int ops, int index)
+			throws SocketException;
+
+	/**
+	 * Changes the interest set of a registered descriptor in place, without
+	 * unregistering it first.
+	 * 
+	 * @param fd
+	 *            the native descriptor returned by {@link #pollsetAdd}
+	 * @param ops
+	 *            the new interest set, not empty
+	 * @param index
+	 *            the index to report from now on
+	 * @throws SocketException
+	 */
+	public void pollsetModify(long pollset, int fd, int ops, int index)
+			throws SocketException;
+
+	/**
+	 * Unregisters a descriptor from the poll set. Removing a descriptor that
+	 * has been closed in the meantime is not an error.
+	 * 
+	 * @throws SocketException
+	 */
+	public void pollsetRemove(long pollset, int fd, int ops)
+			throws SocketException;
+
+	/**
+	 * Waits for registered descriptors to become ready.
+	 * 
+	 * @param indexes
+	 *            for output. Receives the index given to {@link #pollsetAdd}
+	 *            of each ready descriptor; its length, up to 1024, bounds
+	 *            the number of reported descriptors
+	 * @param ops
+	 *            for output. Receives the ready operations of each reported
+	 *            descriptor
+	 * @param timeout
+	 *            timeout in milliseconds, negative to block
+	 * @return the number of ready descriptors, 0 on timeout or interruption
+	 * @throws SocketException
+	 */
+	public int pollsetWait(long pollset, int[] indexes, int[] ops, long timeout)
+			throws SocketException;
+
 	/*
 	 * Query the IP stack for the local port to which this socket is bound.
 	 * 
@@ -109,6 +109,21 @@ class OSFileSystem implements IFileSystem {
 	public native long write(int fd, byte[] bytes, int offset, int length)
 			throws IOException;
 
+	/*
+	 * Positional read/writes leave the file pointer alone.
+	 */
+	public native long pread(int fd, byte[] bytes, int offset, int length,
+			long position) throws IOException;
+
+	public native long pwrite(int fd, byte[] bytes, int offset, int length,
+			long position) throws IOException;
+
+	public native long preadDirect(int fd, int address, int offset,
+			int length, long position) throws IOException;
+
+	public native long pwriteDirect(int fd, int address, int offset,
+			int length, long position) throws IOException;
+
 	/*
 	 * Scatter/gather calls.
 	 */
@@ -125,6 +140,15 @@ class OSFileSystem implements IFileSystem {
 	public native long transfer(int fd, FileDescriptor sd, long offset,
 			long count) throws IOException;
 
+	public native long spliceTo(int fd, long offset, FileDescriptor target,
+			long count) throws IOException;
+
+	public native long spliceFrom(FileDescriptor source, int fd, long offset,
+			long count) throws IOException;
+
+	public native long copyRange(int srcFd, long srcOffset, int dstFd,
+			long dstOffset, long count) throws IOException;
+
 	public native int ioctlAvailable(FileDescriptor fileDescriptor)
 			throws IOException;
 }
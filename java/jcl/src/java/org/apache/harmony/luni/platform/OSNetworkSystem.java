@@ -83,6 +83,9 @@ final class OSNetworkSystem implements INetworkSystem {
 			int address, int offset, int length, boolean peek, boolean connected)
 			throws IOException;
 
+	public native int recvBatch(FileDescriptor fd, DatagramPacket[] packets,
+			int offset, int count, boolean connected) throws IOException;
+
 	public boolean select(FileDescriptor[] readFDs, FileDescriptor[] writeFDs,
 			int numReadable, int numWritable, long timeout, int[] flags)
 			throws SocketException {
@@ -103,12 +106,31 @@ final class OSNetworkSystem implements INetworkSystem {
 			FileDescriptor[] writefd, int cread, int cwirte, int[] flags,
 			long timeout);
 
+	public native long pollsetCreate(int size) throws SocketException;
+
+	public native void pollsetDestroy(long pollset);
+
+	public native int pollsetAdd(long pollset, FileDescriptor fd, int ops,
+			int index) throws SocketException;
+
+	public native void pollsetModify(long pollset, int fd, int ops, int index)
+			throws SocketException;
+
+	public native void pollsetRemove(long pollset, int fd, int ops)
+			throws SocketException;
+
+	public native int pollsetWait(long pollset, int[] indexes, int[] ops,
+			long timeout) throws SocketException;
+
 	public native int send(FileDescriptor fd, byte[] data, int offset,
 			int length, int port, InetAddress inetAddress) throws IOException;
 
 	public native int sendDirect(FileDescriptor fd, int address, int offset,
 			int length, int port, InetAddress inetAddress) throws IOException;
 
+	public native int sendBatch(FileDescriptor fd, DatagramPacket[] packets,
+			int offset, int count) throws IOException;
+
 	public native void sendUrgentData(FileDescriptor fd, byte value);
 
 	public native void setInetAddress(InetAddress sender, byte[] address);
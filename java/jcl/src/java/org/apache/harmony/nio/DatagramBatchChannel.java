@@ -0,0 +1,66 @@
+/*
+ *  Licensed to the Apache Software Foundation (ASF) under one or more
+ *  contributor license agreements.  See the NOTICE file distributed with
+ *  this work for additional information regarding copyright ownership.
+ *  The ASF licenses this file to You under the Apache License, Version 2.0
+ *  (the "License"); you may not use this file except in compliance with
+ *  the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+package org.apache.harmony.nio;
+
+import java.io.IOException;
+import java.net.SocketAddress;
+import java.nio.ByteBuffer;
+
+/**
+ * This interface declares the burst receive/send of a datagram channel, which
+ * moves many datagrams with a few system calls.
+ * <p>
+ * The channels returned by {@code DatagramChannel.open()} implement it.
+ */
+public interface DatagramBatchChannel {
+
+	/**
+	 * Receives datagrams into the given buffers, one datagram per buffer.
+	 * <p>
+	 * In blocking mode, waits for the first datagram only. The filled buffers
+	 * are the first ones of {@code targets}, their positions are advanced,
+	 * and their senders are stored in {@code senders}. A datagram refused by
+	 * the security manager is dropped, and is not counted.
+	 * 
+	 * @param targets
+	 *            the buffers to fill
+	 * @param senders
+	 *            the array for the senders, at least as long as
+	 *            {@code targets}
+	 * @return the number of filled buffers, 0 if nothing is available.
+	 * @throws IOException
+	 *             if an I/O error occurs.
+	 */
+	int receive(ByteBuffer[] targets, SocketAddress[] senders)
+			throws IOException;
+
+	/**
+	 * Sends the remaining bytes of each buffer as a datagram.
+	 * 
+	 * @param sources
+	 *            the buffers to send
+	 * @param targets
+	 *            the destination of each buffer
+	 * @return the number of datagrams sent, which may be less than
+	 *         {@code sources.length} in non-blocking mode.
+	 * @throws IOException
+	 *             if an I/O error occurs.
+	 */
+	int send(ByteBuffer[] sources, SocketAddress[] targets) throws IOException;
+
+}
@@ -44,12 +44,13 @@ import org.apache.harmony.luni.platform.FileDescriptorHandler;
 import org.apache.harmony.luni.platform.INetworkSystem;
 import org.apache.harmony.luni.platform.Platform;
 import org.apache.harmony.nio.AddressUtil;
+import org.apache.harmony.nio.DatagramBatchChannel;
 
 /*
  * The default implementation class of java.nio.channels.DatagramChannel.
  */
 class DatagramChannelImpl extends DatagramChannel implements
-		FileDescriptorHandler {
+		FileDescriptorHandler, DatagramBatchChannel {
 
 	// The singleton to do the native network operation.
 	private static final INetworkSystem networkSystem = Platform
@@ -325,26 +326,7 @@ class DatagramChannelImpl extends DatagramChannel implements
 
 		// transfer socketAddress
 		InetSocketAddress isa = (InetSocketAddress) socketAddress;
-		if (null == isa.getAddress()) {
-			throw new IOException();
-		}
-
-		if (isConnected()) {
-			if (!connectAddress.equals(isa)) {
-				throw new IllegalArgumentException();
-			}
-		} else {
-			// not connected, check security
-			SecurityManager sm = System.getSecurityManager();
-			if (sm != null) {
-				if (isa.getAddress().isMulticastAddress()) {
-					sm.checkMulticast(isa.getAddress());
-				} else {
-					sm.checkConnect(isa.getAddress().getHostAddress(),
-							isa.getPort());
-				}
-			}
-		}
+		checkTarget(isa);
 
 		// the return value.
 		int sendCount = 0;
@@ -382,6 +364,162 @@ class DatagramChannelImpl extends DatagramChannel implements
 		}
 	}
 
+	/**
+	 * @see org.apache.harmony.nio.DatagramBatchChannel#receive(java.nio.ByteBuffer[],
+	 *      java.net.SocketAddress[])
+	 */
+	public int receive(ByteBuffer[] targets, SocketAddress[] senders)
+			throws IOException {
+		if (senders.length < targets.length) {
+			throw new IndexOutOfBoundsException();
+		}
+		for (int i = 0; i < targets.length; i++) {
+			FileChannelImpl.checkWritable(targets[i]);
+		}
+		checkOpen();
+
+		if (!isBound || targets.length == 0) {
+			return 0;
+		}
+
+		int received = 0;
+		try {
+			begin();
+
+			synchronized (readLock) {
+				received = receiveBatchImpl(targets, senders, isBlocking());
+			}
+		} catch (InterruptedIOException e) {
+			// this line used in Linux
+			return 0;
+		} finally {
+			end(received > 0);
+		}
+		return received;
+	}
+
+	/*
+	 * Receive a burst of datagrams. The packets borrow the arrays of heap
+	 * buffers, the others are copied after receiving.
+	 */
+	private int receiveBatchImpl(ByteBuffer[] targets, SocketAddress[] senders,
+			boolean loop) throws IOException {
+		DatagramPacket[] packets = new DatagramPacket[targets.length];
+		for (int i = 0; i < targets.length; i++) {
+			ByteBuffer target = targets[i];
+			if (target.hasArray()) {
+				packets[i] = new DatagramPacket(target.array(),
+						target.position() + target.arrayOffset(),
+						target.remaining());
+			} else {
+				packets[i] = new DatagramPacket(new byte[target.remaining()],
+						target.remaining());
+			}
+		}
+
+		int received = 0;
+		int accepted = 0;
+		do {
+			// the native call shrinks the length of a packet to its datagram
+			for (int i = 0; i < packets.length; i++) {
+				packets[i].setLength(targets[i].remaining());
+			}
+			received = networkSystem.recvBatch(fd, packets, 0, packets.length,
+					isConnected());
+
+			SecurityManager sm = System.getSecurityManager();
+			for (int i = 0; i < received; i++) {
+				DatagramPacket packet = packets[i];
+				senders[i] = null;
+				// security check
+				if (!isConnected() && null != sm) {
+					try {
+						sm.checkAccept(packet.getAddress().getHostAddress(),
+								packet.getPort());
+					} catch (SecurityException e) {
+						// do discard the datagram packet
+						continue;
+					}
+				}
+				if (null == packet.getAddress() && !isConnected()) {
+					continue;
+				}
+
+				// the accepted ones are moved down over the discarded ones
+				ByteBuffer target = targets[accepted];
+				int length = Math.min(packet.getLength(), target.remaining());
+				if (length > 0) {
+					if (accepted == i && target.hasArray()) {
+						target.position(target.position() + length);
+					} else {
+						// copy the data of received packet
+						target.put(packet.getData(), packet.getOffset(), length);
+					}
+				}
+				senders[accepted] = isConnected() ? connectAddress
+						: packet.getSocketAddress();
+				accepted++;
+			}
+		} while (loop && received > 0 && accepted == 0);
+		return accepted;
+	}
+
+	/**
+	 * @see org.apache.harmony.nio.DatagramBatchChannel#send(java.nio.ByteBuffer[],
+	 *      java.net.SocketAddress[])
+	 */
+	public int send(ByteBuffer[] sources, SocketAddress[] targets)
+			throws IOException {
+		if (targets.length < sources.length) {
+			throw new IndexOutOfBoundsException();
+		}
+		checkOpen();
+
+		DatagramPacket[] packets = new DatagramPacket[sources.length];
+		for (int i = 0; i < sources.length; i++) {
+			ByteBuffer source = sources[i];
+			checkNotNull(source);
+			InetSocketAddress isa = (InetSocketAddress) targets[i];
+			checkTarget(isa);
+
+			byte[] array;
+			int start = source.position();
+			int length = source.remaining();
+			if (source.hasArray()) {
+				array = source.array();
+				start += source.arrayOffset();
+			} else {
+				// direct or read-only buffers are copied, keeping the position
+				array = new byte[length];
+				source.duplicate().get(array);
+				start = 0;
+			}
+			packets[i] = new DatagramPacket(array, start, length,
+					isa.getAddress(), isa.getPort());
+		}
+
+		int sent = 0;
+		try {
+			begin();
+			synchronized (writeLock) {
+				while (sent < packets.length) {
+					int count = networkSystem.sendBatch(fd, packets, sent,
+							packets.length - sent);
+					if (count <= 0) {
+						break;
+					}
+					sent += count;
+				}
+			}
+			for (int i = 0; i < sent; i++) {
+				sources[i].position(sources[i].limit());
+			}
+			return sent;
+		} finally {
+			end(sent > 0);
+		}
+	}
+
 	@Override
 	public int read(ByteBuffer target) throws IOException {
 		FileChannelImpl.checkWritable(target);
@@ -615,6 +753,32 @@ class DatagramChannelImpl extends DatagramChannel implements
 		}
 	}
 
+	/*
+	 * Target check for send, must be resolved and allowed
+	 */
+	private void checkTarget(InetSocketAddress isa) throws IOException {
+		if (null == isa.getAddress()) {
+			throw new IOException();
+		}
+
+		if (isConnected()) {
+			if (!connectAddress.equals(isa)) {
+				throw new IllegalArgumentException();
+			}
+		} else {
+			// not connected, check security
+			SecurityManager sm = System.getSecurityManager();
+			if (sm != null) {
+				if (isa.getAddress().isMulticastAddress()) {
+					sm.checkMulticast(isa.getAddress());
+				} else {
+					sm.checkConnect(isa.getAddress().getHostAddress(),
+							isa.getPort());
+				}
+			}
+		}
+	}
+
 	/*
 	 * Buffer check, must not null
 	 */
@@ -32,11 +32,15 @@ import java.nio.ByteBuffer;
 import java.nio.MappedByteBuffer;
 import java.nio.MappedByteBufferAdapter;
 import java.nio.channels.ClosedChannelException;
+import java.nio.channels.DatagramChannel;
 import java.nio.channels.FileChannel;
 import java.nio.channels.FileLock;
+import java.nio.channels.NonReadableChannelException;
 import java.nio.channels.NonWritableChannelException;
+import java.nio.channels.NotYetConnectedException;
 import java.nio.channels.ReadableByteChannel;
 import java.nio.channels.WritableByteChannel;
+import org.apache.harmony.luni.platform.FileDescriptorHandler;
 import org.apache.harmony.luni.platform.IFileSystem;
 import org.apache.harmony.luni.platform.Platform;
 import org.apache.harmony.luni.platform.PlatformAddress;
@@ -229,17 +233,29 @@ public abstract class FileChannelImpl extends FileChannel {
 		if (!buffer.hasRemaining()) {
 			return 0;
 		}
-		synchronized (repositioningLock) {
-			int bytesRead = 0;
-			long preReadPosition = position();
-			position(position);
-			try {
-				bytesRead = read(buffer);
-			} finally {
-				position(preReadPosition);
+		// pread leaves the file pointer alone, so no repositioning lock
+		boolean completed = false;
+		int bytesRead = 0;
+		try {
+			begin();
+			if (buffer.isDirect()) {
+				DirectBuffer directBuffer = (DirectBuffer) buffer;
+				int address = directBuffer.getEffectiveAddress().toInt();
+				bytesRead = (int) fileSystem.preadDirect(handle, address,
+						buffer.position(), buffer.remaining(), position);
+			} else {
+				bytesRead = (int) fileSystem.pread(handle, buffer.array(),
+						buffer.arrayOffset() + buffer.position(),
+						buffer.remaining(), position);
 			}
-			return bytesRead;
+			completed = true;
+		} finally {
+			end(completed && bytesRead >= 0);
 		}
+		if (bytesRead > 0) {
+			buffer.position(buffer.position() + bytesRead);
+		}
+		return bytesRead;
 	}
 
 	public int read(ByteBuffer buffer) throws IOException {
@@ -382,6 +398,33 @@ public abstract class FileChannelImpl extends FileChannel {
 			return 0;
 		}
 
+		if (src instanceof FileChannelImpl) {
+			if (src instanceof WriteOnlyFileChannel) {
+				throw new NonReadableChannelException();
+			}
+			// file to file is copied inside the kernel
+			FileChannelImpl fileSrc = (FileChannelImpl) src;
+			long filePosition = fileSrc.position();
+			count = Math.min(count, fileSrc.size() - filePosition);
+			if (count <= 0) {
+				return 0;
+			}
+			long ret = kernelCopy(fileSrc.handle, filePosition, handle,
+					position, count);
+			fileSrc.position(filePosition + ret);
+			return ret;
+		}
+		if (src instanceof FileDescriptorHandler
+				&& !(src instanceof DatagramChannel)) {
+			if (src instanceof SocketChannelImpl
+					&& !((SocketChannelImpl) src).isConnected()) {
+				throw new NotYetConnectedException();
+			}
+			// socket or pipe is spliced into the file
+			return kernelSpliceFrom(((FileDescriptorHandler) src).getFD(),
+					position, count);
+		}
+
 		ByteBuffer buffer = null;
 
 		try {
@@ -427,10 +470,28 @@ public abstract class FileChannelImpl extends FileChannel {
 		ByteBuffer buffer = null;
 		count = Math.min(count, size() - position);
 		if (target instanceof SocketChannelImpl) {
+			if (!((SocketChannelImpl) target).isConnected()) {
+				throw new NotYetConnectedException();
+			}
 			// only socket can be transfered by system call
 			return kernelTransfer(handle, ((SocketChannelImpl) target).getFD(),
 					position, count);
 		}
+		if (target instanceof FileChannelImpl) {
+			// file to file is copied inside the kernel
+			FileChannelImpl fileTarget = (FileChannelImpl) target;
+			long filePosition = fileTarget.position();
+			long ret = kernelCopy(handle, position, fileTarget.handle,
+					filePosition, count);
+			fileTarget.position(filePosition + ret);
+			return ret;
+		}
+		if (target instanceof FileDescriptorHandler
+				&& !(target instanceof DatagramChannel)) {
+			// pipe is spliced from the file
+			return kernelSpliceTo(position,
+					((FileDescriptorHandler) target).getFD(), count);
+		}
 
 		try {
 			buffer = map(MapMode.READ_ONLY, position, count);
@@ -458,6 +519,46 @@ public abstract class FileChannelImpl extends FileChannel {
 		}
 	}
 
+	private long kernelCopy(int srcHandle, long srcPosition, int dstHandle,
+			long dstPosition, long count) throws IOException {
+		boolean completed = false;
+		try {
+			begin();
+			long ret = fileSystem.copyRange(srcHandle, srcPosition, dstHandle,
+					dstPosition, count);
+			completed = true;
+			return ret;
+		} finally {
+			end(completed);
+		}
+	}
+
+	private long kernelSpliceTo(long position, FileDescriptor fd, long count)
+			throws IOException {
+		boolean completed = false;
+		try {
+			begin();
+			long ret = fileSystem.spliceTo(handle, position, fd, count);
+			completed = true;
+			return ret;
+		} finally {
+			end(completed);
+		}
+	}
+
+	private long kernelSpliceFrom(FileDescriptor fd, long position, long count)
+			throws IOException {
+		boolean completed = false;
+		try {
+			begin();
+			long ret = fileSystem.spliceFrom(fd, handle, position, count);
+			completed = true;
+			return ret;
+		} finally {
+			end(completed);
+		}
+	}
+
 	public FileChannel truncate(long size) throws IOException {
 		openCheck();
 		if (size < 0) {
@@ -496,15 +597,27 @@ public abstract class FileChannelImpl extends FileChannel {
 		if (!buffer.hasRemaining()) {
 			return 0;
 		}
+		// pwrite leaves the file pointer alone, so no repositioning lock
+		boolean completed = false;
 		int bytesWritten = 0;
-		synchronized (repositioningLock) {
-			long preWritePosition = position();
-			position(position);
-			try {
-				bytesWritten = writeImpl(buffer);
-			} finally {
-				position(preWritePosition);
+		try {
+			begin();
+			if (buffer.isDirect()) {
+				DirectBuffer directBuffer = (DirectBuffer) buffer;
+				int address = directBuffer.getEffectiveAddress().toInt();
+				bytesWritten = (int) fileSystem.pwriteDirect(handle, address,
+						buffer.position(), buffer.remaining(), position);
+			} else {
+				bytesWritten = (int) fileSystem.pwrite(handle, buffer.array(),
+						buffer.arrayOffset() + buffer.position(),
+						buffer.remaining(), position);
 			}
+			completed = true;
+		} finally {
+			end(completed);
+		}
+		if (bytesWritten > 0) {
+			buffer.position(buffer.position() + bytesWritten);
 		}
 		return bytesWritten;
 	}
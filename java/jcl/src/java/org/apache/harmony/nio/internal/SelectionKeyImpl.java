@@ -37,9 +37,19 @@ final class SelectionKeyImpl extends AbstractSelectionKey {
 
 	private SelectorImpl selector;
 
-	// BEGIN android-removed
-	// private int index;
-	// END android-removed
+	private int index;
+
+	/**
+	 * The operations this key is registered with in the selector's poll set,
+	 * 0 if it is not registered. Only accessed by the selecting thread.
+	 */
+	private int registeredOps;
+
+	/**
+	 * The native descriptor the key was registered with, which remains valid
+	 * for unregistering after the channel has been closed.
+	 */
+	private int nativeFD = -1;
 
 	public SelectionKeyImpl(AbstractSelectableChannel channel, int operations,
 			Object attachment, SelectorImpl selector) {
@@ -76,9 +86,7 @@ final class SelectionKeyImpl extends AbstractSelectionKey {
 		}
 		synchronized (selector.keysLock) {
 			interestOps = operations;
-			// BEGIN android-removed
-			// selector.modKey(this);
-			// END android-removed
+			selector.modKey(this);
 		}
 		return this;
 	}
@@ -101,15 +109,29 @@ final class SelectionKeyImpl extends AbstractSelectionKey {
 		this.readyOps = readyOps;
 	}
 
-	// BEGIN android-removed
-	// int getIndex() {
-	// return index;
-	// }
+	int getIndex() {
+		return index;
+	}
+
+	void setIndex(int index) {
+		this.index = index;
+	}
+
+	int getRegisteredOps() {
+		return registeredOps;
+	}
+
+	void setRegisteredOps(int registeredOps) {
+		this.registeredOps = registeredOps;
+	}
+
+	int getNativeFD() {
+		return nativeFD;
+	}
 
-	// void setIndex(int index) {
-	// this.index = index;
-	// }
-	// END android-removed
+	void setNativeFD(int nativeFD) {
+		this.nativeFD = nativeFD;
+	}
 
 	private void checkValid() {
 		if (!isValid()) {
@@ -17,26 +17,25 @@ package org.apache.harmony.nio.internal;
 
 import java.io.FileDescriptor;
 import java.io.IOException;
+import java.net.SocketException;
 import java.nio.ByteBuffer;
 import java.nio.channels.ClosedSelectorException;
 import java.nio.channels.IllegalSelectorException;
 import java.nio.channels.Pipe;
-import java.nio.channels.SelectableChannel;
 import java.nio.channels.SelectionKey;
 import static java.nio.channels.SelectionKey.*;
 import java.nio.channels.Selector;
-import java.nio.channels.SocketChannel;
 import java.nio.channels.spi.AbstractSelectableChannel;
 import java.nio.channels.spi.AbstractSelectionKey;
 import java.nio.channels.spi.AbstractSelector;
 import java.nio.channels.spi.SelectorProvider;
-import java.util.Arrays;
 import java.util.Collection;
 import java.util.Collections;
 import java.util.HashSet;
 import java.util.Iterator;
 import java.util.Set;
 import org.apache.harmony.luni.platform.FileDescriptorHandler;
+import org.apache.harmony.luni.platform.INetworkSystem;
 import org.apache.harmony.luni.platform.Platform;
 
 /*
@@ -44,11 +43,6 @@ import org.apache.harmony.luni.platform.Platform;
  */
 final class SelectorImpl extends AbstractSelector {
 
-	private static final int[] EMPTY_INT_ARRAY = new int[0];
-
-	private static final FileDescriptor[] EMPTY_FILE_DESCRIPTORS_ARRAY = new FileDescriptor[0];
-	private static final SelectionKeyImpl[] EMPTY_SELECTION_KEY_IMPLS_ARRAY = new SelectionKeyImpl[0];
-
 	private static final int CONNECT_OR_WRITE = OP_CONNECT | OP_WRITE;
 
 	private static final int ACCEPT_OR_READ = OP_ACCEPT | OP_READ;
@@ -57,8 +51,6 @@ final class SelectorImpl extends AbstractSelector {
 
 	private static final int WAKEUP_READ_SIZE = 8;
 
-	private static final int NA = 0;
-
 	private static final int READABLE = 1;
 
 	private static final int WRITABLE = 2;
@@ -67,6 +59,19 @@ final class SelectorImpl extends AbstractSelector {
 
 	private static final int SELECT_NOW = 0;
 
+	private static final int POLLSET_INITIAL_SIZE = 64;
+
+	/**
+	 * The most ready keys reported by one wait. The others stay ready, and
+	 * are reported by the next select.
+	 */
+	private static final int READY_BATCH_SIZE = 1024;
+
+	/**
+	 * The poll set index of the wakeup channel. Keys use the indexes above it.
+	 */
+	private static final int WAKEUP_INDEX = 0;
+
 	/**
 	 * Used to synchronize when a key's interest ops change.
 	 */
@@ -98,38 +103,65 @@ final class SelectorImpl extends AbstractSelector {
 	 */
 	private final Pipe wakeupPipe;
 
+	private final INetworkSystem networkSystem;
+
+	/**
+	 * The native poll set owned by this selector. Registrations live as long
+	 * as their keys, so a select only hands the changed keys to the kernel.
+	 */
+	private long pollset;
+
+	/**
+	 * The capacity of the poll set.
+	 */
+	private int pollsetSize;
+
 	/**
-	 * File descriptors we're interested in reading from. When actively
-	 * selecting, the first element is always the wakeup channel's file
-	 * descriptor, and the other elements are user-specified file descriptors.
-	 * Otherwise, all elements are null.
+	 * The number of descriptors in the poll set, including the wakeup channel.
 	 */
-	private FileDescriptor[] readableFDs = EMPTY_FILE_DESCRIPTORS_ARRAY;
+	private int pollsetUsed;
 
 	/**
-	 * File descriptors we're interested in writing from. May be empty. When not
-	 * actively selecting, all elements are null.
+	 * Keys indexed by the poll set index they were registered with. The
+	 * element at {@code WAKEUP_INDEX} is always null.
 	 */
-	private FileDescriptor[] writableFDs = EMPTY_FILE_DESCRIPTORS_ARRAY;
+	private SelectionKeyImpl[] keySlots = new SelectionKeyImpl[POLLSET_INITIAL_SIZE];
 
 	/**
-	 * Selection keys that correspond to the concatenation of readableFDs and
-	 * writableFDs. This is used to interpret the results returned by select().
-	 * When not actively selecting, all elements are null.
+	 * Indexes of {@code keySlots} released by cancelled keys.
 	 */
-	private SelectionKeyImpl[] readyKeys = EMPTY_SELECTION_KEY_IMPLS_ARRAY;
+	private int[] freeSlots = new int[POLLSET_INITIAL_SIZE];
+
+	private int freeSlotCount;
+
+	private int nextSlot = WAKEUP_INDEX + 1;
 
 	/**
-	 * Selection flags that define the ready ops on the ready keys. When not
-	 * actively selecting, all elements are 0. Corresponds to the ready keys
-	 * set.
+	 * Keys registered or whose interest ops changed since the last select.
+	 * Guarded by {@code keysLock}.
 	 */
-	private int[] flags = EMPTY_INT_ARRAY;
+	private final Set<SelectionKeyImpl> updatedKeys = new HashSet<SelectionKeyImpl>();
+
+	/**
+	 * The poll set indexes of the ready keys, filled in by a select.
+	 */
+	private final int[] readyIndexes = new int[READY_BATCH_SIZE];
+
+	/**
+	 * The ready operations matching {@code readyIndexes}.
+	 */
+	private final int[] readyOps = new int[READY_BATCH_SIZE];
 
 	public SelectorImpl(SelectorProvider selectorProvider) throws IOException {
 		super(selectorProvider);
 		wakeupPipe = selectorProvider.openPipe();
 		wakeupPipe.source().configureBlocking(false);
+		networkSystem = Platform.getNetworkSystem();
+		pollsetSize = POLLSET_INITIAL_SIZE;
+		pollset = networkSystem.pollsetCreate(pollsetSize);
+		networkSystem.pollsetAdd(pollset, getWakeupFD(), READABLE,
+				WAKEUP_INDEX);
+		pollsetUsed = 1;
 	}
 
 	@Override
@@ -144,6 +176,8 @@ final class SelectorImpl extends AbstractSelector {
 					for (SelectionKey sk : mutableKeys) {
 						deregister((AbstractSelectionKey) sk);
 					}
+					networkSystem.pollsetDestroy(pollset);
+					pollset = 0;
 				}
 			}
 		}
@@ -159,12 +193,24 @@ final class SelectorImpl extends AbstractSelector {
 			synchronized (unmodifiableKeys) {
 				SelectionKeyImpl selectionKey = new SelectionKeyImpl(channel,
 						operations, attachment, this);
+				selectionKey.setIndex(allocateSlot(selectionKey));
 				mutableKeys.add(selectionKey);
+				synchronized (keysLock) {
+					updatedKeys.add(selectionKey);
+				}
 				return selectionKey;
 			}
 		}
 	}
 
+	/**
+	 * Schedules the poll set registration of the key to be refreshed by the
+	 * next select. The caller must hold {@code keysLock}.
+	 */
+	void modKey(SelectionKeyImpl key) {
+		updatedKeys.add(key);
+	}
+
 	@Override
 	public synchronized Set<SelectionKey> keys() {
 		closeCheck();
@@ -205,41 +251,23 @@ final class SelectorImpl extends AbstractSelector {
 				synchronized (selectedKeys) {
 					doCancel();
 					boolean isBlock = (SELECT_NOW != timeout);
-					int readableKeysCount = 1; // first is always the wakeup
-												// channel
-					int writableKeysCount = 0;
 					synchronized (keysLock) {
-						for (SelectionKeyImpl key : mutableKeys) {
-							int ops = key.interestOpsNoCheck();
-							if ((ACCEPT_OR_READ & ops) != 0) {
-								readableKeysCount++;
-							}
-							if ((CONNECT_OR_WRITE & ops) != 0) {
-								writableKeysCount++;
-							}
-						}
-						prepareChannels(readableKeysCount, writableKeysCount);
+						updateRegistrations();
 					}
-					boolean success;
+					int count;
 					try {
 						if (isBlock) {
 							begin();
 						}
-						success = Platform.getNetworkSystem().select(
-								readableFDs, writableFDs, readableKeysCount,
-								writableKeysCount, timeout, flags);
+						count = networkSystem.pollsetWait(pollset,
+								readyIndexes, readyOps, timeout);
 					} finally {
 						if (isBlock) {
 							end();
 						}
 					}
 
-					int selected = success ? processSelectResult() : 0;
-
-					Arrays.fill(readableFDs, null);
-					Arrays.fill(writableFDs, null);
-					Arrays.fill(readyKeys, null);
-					Arrays.fill(flags, 0);
+					int selected = (count > 0) ? processSelectResult(count) : 0;
 
 					selected -= doCancel();
 
@@ -249,97 +277,191 @@ final class SelectorImpl extends AbstractSelector {
 		}
 	}
 
-	private int getReadyOps(SelectionKeyImpl key) {
-		SelectableChannel channel = key.channel();
-		return ((channel instanceof SocketChannel) && !((SocketChannel) channel)
-				.isConnectionPending()) ? OP_WRITE : CONNECT_OR_WRITE;
+	private FileDescriptor getWakeupFD() {
+		return ((FileDescriptorHandler) wakeupPipe.source()).getFD();
 	}
 
 	/**
-	 * Prepare the readableFDs, writableFDs, readyKeys and flags arrays in
-	 * preparation for a call to {@code INetworkSystem#select()}. After they're
-	 * used, the array elements must be cleared.
+	 * Returns the poll set operations matching the given interest ops.
 	 */
-	private void prepareChannels(int numReadable, int numWritable) {
-		// grow each array to sufficient capacity. Always grow to at least 1.5x
-		// to avoid growing too frequently
-		if (readableFDs.length < numReadable) {
-			int newSize = Math.max((int) (readableFDs.length * 1.5f),
-					numReadable);
-			readableFDs = new FileDescriptor[newSize];
-		}
-		if (writableFDs.length < numWritable) {
-			int newSize = Math.max((int) (writableFDs.length * 1.5f),
-					numWritable);
-			writableFDs = new FileDescriptor[newSize];
-		}
-		int total = numReadable + numWritable;
-		if (readyKeys.length < total) {
-			int newSize = Math.max((int) (readyKeys.length * 1.5f), total);
-			readyKeys = new SelectionKeyImpl[newSize];
-			flags = new int[newSize];
-		}
-
-		// populate the FDs, including the wakeup channel
-		readableFDs[0] = ((FileDescriptorHandler) wakeupPipe.source()).getFD();
-		int r = 1;
-		int w = 0;
-		for (SelectionKeyImpl key : mutableKeys) {
-			int interestOps = key.interestOpsNoCheck();
-			if ((ACCEPT_OR_READ & interestOps) != 0) {
-				readableFDs[r] = ((FileDescriptorHandler) key.channel())
-						.getFD();
-				readyKeys[r] = key;
-				r++;
+	private static int nativeOps(int interestOps) {
+		int ops = 0;
+		if ((ACCEPT_OR_READ & interestOps) != 0) {
+			ops |= READABLE;
+		}
+		if ((CONNECT_OR_WRITE & interestOps) != 0) {
+			ops |= WRITABLE;
+		}
+		return ops;
+	}
+
+	private int allocateSlot(SelectionKeyImpl key) {
+		int slot;
+		if (freeSlotCount > 0) {
+			slot = freeSlots[--freeSlotCount];
+		} else {
+			slot = nextSlot++;
+			if (slot == keySlots.length) {
+				SelectionKeyImpl[] newSlots = new SelectionKeyImpl[slot * 2];
+				System.arraycopy(keySlots, 0, newSlots, 0, slot);
+				keySlots = newSlots;
 			}
-			if ((getReadyOps(key) & interestOps) != 0) {
-				writableFDs[w] = ((FileDescriptorHandler) key.channel())
-						.getFD();
-				readyKeys[w + numReadable] = key;
-				w++;
+		}
+		keySlots[slot] = key;
+		return slot;
+	}
+
+	private void releaseSlot(int slot) {
+		keySlots[slot] = null;
+		if (freeSlotCount == freeSlots.length) {
+			int[] newFree = new int[freeSlotCount * 2];
+			System.arraycopy(freeSlots, 0, newFree, 0, freeSlotCount);
+			freeSlots = newFree;
+		}
+		freeSlots[freeSlotCount++] = slot;
+	}
+
+	/**
+	 * Passes the interest ops changed since the last select down to the poll
+	 * set. The caller must hold {@code keysLock}.
+	 */
+	private void updateRegistrations() throws IOException {
+		try {
+			for (SelectionKeyImpl key : updatedKeys) {
+				if (!key.isValid()) {
+					// doCancel() drops the registration
+					continue;
+				}
+				int ops = nativeOps(key.interestOpsNoCheck());
+				int registered = key.getRegisteredOps();
+				if (ops == registered) {
+					continue;
+				}
+				if (registered != 0 && ops != 0 && modifyInPollset(key, ops)) {
+					continue;
+				}
+				if (registered != 0) {
+					removeFromPollset(key);
+				}
+				if (ops != 0) {
+					if (pollsetUsed == pollsetSize) {
+						growPollset();
+					}
+					addToPollset(pollset, key, ops);
+				}
 			}
+		} finally {
+			updatedKeys.clear();
+		}
+	}
+
+	private void addToPollset(long target, SelectionKeyImpl key, int ops)
+			throws IOException {
+		int fd = networkSystem.pollsetAdd(target,
+				((FileDescriptorHandler) key.channel()).getFD(), ops, key
+						.getIndex());
+		if (fd < 0) {
+			// the channel has been closed, its key is about to be cancelled
+			key.setRegisteredOps(0);
+			return;
+		}
+		key.setNativeFD(fd);
+		key.setRegisteredOps(ops);
+		pollsetUsed++;
+	}
+
+	/**
+	 * Changes the interest set of a registered key in place. Returns false if
+	 * the poll set refused the change, the caller then re-registers the key.
+	 */
+	private boolean modifyInPollset(SelectionKeyImpl key, int ops) {
+		try {
+			networkSystem.pollsetModify(pollset, key.getNativeFD(), ops, key
+					.getIndex());
+		} catch (SocketException e) {
+			return false;
+		}
+		key.setRegisteredOps(ops);
+		return true;
+	}
+
+	private void removeFromPollset(SelectionKeyImpl key) {
+		try {
+			networkSystem.pollsetRemove(pollset, key.getNativeFD(), key
+					.getRegisteredOps());
+		} catch (SocketException ignored) {
 		}
+		key.setRegisteredOps(0);
+		pollsetUsed--;
 	}
 
 	/**
-	 * Updates the key ready ops and selected key set with data from the flags
-	 * array.
+	 * Moves every registration to a poll set of twice the size. This is rare,
+	 * so the cost is amortized over the registrations that required it.
 	 */
-	private int processSelectResult() throws IOException {
-		// If there's something in the wakeup pipe, read it all --- the
-		// definition of the various
-		// select methods says that one select swallows all outstanding wakeups.
-		// We made this
-		// channel non-blocking in our constructor so that we can just loop
-		// until read returns 0.
-		if (flags[0] == READABLE) {
-			ByteBuffer buf = ByteBuffer.allocate(WAKEUP_READ_SIZE);
-			while (wakeupPipe.source().read(buf) > 0) {
-				buf.flip();
+	private void growPollset() throws IOException {
+		int newSize = pollsetSize * 2;
+		long newPollset = networkSystem.pollsetCreate(newSize);
+		int oldUsed = pollsetUsed;
+		pollsetUsed = 0;
+		try {
+			networkSystem.pollsetAdd(newPollset, getWakeupFD(), READABLE,
+					WAKEUP_INDEX);
+			pollsetUsed++;
+			for (SelectionKeyImpl key : mutableKeys) {
+				int ops = key.getRegisteredOps();
+				if (ops != 0) {
+					addToPollset(newPollset, key, ops);
+				}
 			}
+		} catch (IOException e) {
+			networkSystem.pollsetDestroy(newPollset);
+			pollsetUsed = oldUsed;
+			throw e;
 		}
+		networkSystem.pollsetDestroy(pollset);
+		pollset = newPollset;
+		pollsetSize = newSize;
+	}
 
+	/**
+	 * Updates the key ready ops and selected key set with the {@code count}
+	 * ready keys reported by the poll set.
+	 */
+	private int processSelectResult(int count) throws IOException {
 		int selected = 0;
-		for (int i = 1; i < flags.length; i++) {
-			if (flags[i] == NA) {
+		for (int i = 0; i < count; i++) {
+			int index = readyIndexes[i];
+			if (index == WAKEUP_INDEX) {
+				// If there's something in the wakeup pipe, read it all --- the
+				// definition of the various select methods says that one
+				// select swallows all outstanding wakeups. We made this
+				// channel non-blocking in our constructor so that we can just
+				// loop until read returns 0.
+				ByteBuffer buf = ByteBuffer.allocate(WAKEUP_READ_SIZE);
+				while (wakeupPipe.source().read(buf) > 0) {
+					buf.flip();
+				}
+				continue;
+			}
+
+			SelectionKeyImpl key = keySlots[index];
+			if (key == null) {
 				continue;
 			}
 
-			SelectionKeyImpl key = readyKeys[i];
 			int ops = key.interestOpsNoCheck();
 			int selectedOp = 0;
 
-			switch (flags[i]) {
-			case READABLE:
-				selectedOp = ACCEPT_OR_READ & ops;
-				break;
-			case WRITABLE:
+			if ((readyOps[i] & READABLE) != 0) {
+				selectedOp |= ACCEPT_OR_READ & ops;
+			}
+			if ((readyOps[i] & WRITABLE) != 0) {
 				if (key.isConnected()) {
-					selectedOp = OP_WRITE & ops;
+					selectedOp |= OP_WRITE & ops;
 				} else {
-					selectedOp = OP_CONNECT & ops;
+					selectedOp |= OP_CONNECT & ops;
 				}
-				break;
 			}
 
 			if (selectedOp != 0) {
@@ -376,6 +498,14 @@ final class SelectorImpl extends AbstractSelector {
 		synchronized (cancelledKeys) {
 			if (cancelledKeys.size() > 0) {
 				for (SelectionKey currentKey : cancelledKeys) {
+					SelectionKeyImpl key = (SelectionKeyImpl) currentKey;
+					if (key.getRegisteredOps() != 0) {
+						removeFromPollset(key);
+					}
+					synchronized (keysLock) {
+						updatedKeys.remove(key);
+					}
+					releaseSlot(key.getIndex());
 					mutableKeys.remove(currentKey);
 					deregister((AbstractSelectionKey) currentKey);
 					if (mutableSelectedKeys.remove(currentKey)) {
@@ -407,6 +407,63 @@ jobject socketAddressToInetAddress(JNIEnv* env, xi_sock_addr_t* ss) {
 	return byteArrayToInetAddress(env, byteArray);
 }
 
+bool byteArrayToSocketAddressBin(JNIEnv* env, jbyteArray byteArray, int port,
+		xi_sock_addr_bin_t *ss) {
+	if (byteArray == NULL) {
+		jniThrowNullPointerException(env, NULL);
+		return false;
+	}
+
+	// The address bytes are copied as they are, without any text conversion.
+	xsize addressLength = env->GetArrayLength(byteArray);
+	xi_mem_set(ss, 0, sizeof(*ss));
+	if (addressLength == 4) {
+		ss->family = XI_SOCK_FAMILY_INET;
+	} else if (addressLength == 16) {
+		ss->family = XI_SOCK_FAMILY_INET6;
+	} else {
+		char buf[64];
+		xi_snprintf(buf, sizeof(buf),
+				"byteArrayToSocketAddressBin bad array length (%i)", addressLength);
+		jniThrowException(env, "java/lang/IllegalArgumentException", buf);
+		return false;
+	}
+	ss->port = port;
+	env->GetByteArrayRegion(byteArray, 0, addressLength,
+			reinterpret_cast<jbyte*> (ss->addr));
+	return true;
+}
+
+jbyteArray socketAddressBinToByteArray(JNIEnv* env, const xi_sock_addr_bin_t *ss) {
+	xint32 addressLength;
+
+	if (ss->family == XI_SOCK_FAMILY_INET) {
+		addressLength = 4;
+	} else if (ss->family == XI_SOCK_FAMILY_INET6) {
+		addressLength = 16;
+	} else {
+		char buf[64];
+		xi_snprintf(buf, sizeof(buf),
+				"socketAddressBinToByteArray bad family (%d)", ss->family);
+		jniThrowException(env, "java/lang/IllegalArgumentException", buf);
+		return NULL;
+	}
+
+	jbyteArray byteArray = env->NewByteArray(addressLength);
+	if (byteArray == NULL) {
+		return NULL;
+	}
+	env->SetByteArrayRegion(byteArray, 0, addressLength,
+			reinterpret_cast<const jbyte*> (ss->addr));
+
+	return byteArray;
+}
+
+jobject socketAddressBinToInetAddress(JNIEnv* env, const xi_sock_addr_bin_t *ss) {
+	jbyteArray byteArray = socketAddressBinToByteArray(env, ss);
+	return byteArrayToInetAddress(env, byteArray);
+}
+
 bool setBlocking(int fd, bool blocking) {
 	xint32 rc = 0;
 	xint32 block = (!blocking) ? 1 : 0;
@@ -33,5 +33,15 @@ jbyteArray socketAddressToByteArray(JNIEnv* env, xi_sock_addr_t *ss);
 // Convert from sockaddr_storage to InetAddress.
 jobject socketAddressToInetAddress(JNIEnv* env, xi_sock_addr_t *ss);
 
+// Convert from byte[] to the binary socket address.
+bool byteArrayToSocketAddressBin(JNIEnv* env, jbyteArray byteArray, int port,
+		xi_sock_addr_bin_t *ss);
+
+// Convert from the binary socket address to byte[].
+jbyteArray socketAddressBinToByteArray(JNIEnv* env, const xi_sock_addr_bin_t *ss);
+
+// Convert from the binary socket address to InetAddress.
+jobject socketAddressBinToInetAddress(JNIEnv* env, const xi_sock_addr_bin_t *ss);
+
 // Changes 'fd' to be blocking/non-blocking. Returns false and sets errno on failure.
 bool setBlocking(int fd, bool blocking);
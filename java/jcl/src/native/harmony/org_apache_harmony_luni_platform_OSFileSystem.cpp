@@ -255,6 +255,72 @@ Java_org_apache_harmony_luni_platform_OSFileSystem_transfer(JNIEnv* env,
 	return rc;
 }
 
+/*
+ static jlong OSFileSystem_spliceTo(JNIEnv* env, jobject, jint fd,
+ jlong offset, jobject target, jlong count) {
+ */
+JNIEXPORT jlong JNICALL
+Java_org_apache_harmony_luni_platform_OSFileSystem_spliceTo(JNIEnv* env,
+		jobject, jint fd, jlong offset, jobject target, jlong count) {
+	int outFd = jniGetFDFromFileDescriptor(env, target);
+	if (outFd == -1) {
+		return -1;
+	}
+
+	xoff64 off = offset;
+	xssize rc = xi_file_splice(fd, &off, outFd, NULL, count, 0);
+	if (rc == XI_FILE_RV_ERR_AGAIN) {
+		// the non-blocking target is full
+		return 0;
+	}
+	if (rc < 0) {
+		jniThrowIOExceptionMsg(env, "splice error!!", rc);
+	}
+	return rc;
+}
+
+/*
+ static jlong OSFileSystem_spliceFrom(JNIEnv* env, jobject, jobject source,
+ jint fd, jlong offset, jlong count) {
+ */
+JNIEXPORT jlong JNICALL
+Java_org_apache_harmony_luni_platform_OSFileSystem_spliceFrom(JNIEnv* env,
+		jobject, jobject source, jint fd, jlong offset, jlong count) {
+	int inFd = jniGetFDFromFileDescriptor(env, source);
+	if (inFd == -1) {
+		return -1;
+	}
+
+	xoff64 off = offset;
+	xssize rc = xi_file_splice(inFd, NULL, fd, &off, count, 0);
+	if (rc == XI_FILE_RV_ERR_AGAIN) {
+		// nothing to read from the non-blocking source
+		return 0;
+	}
+	if (rc < 0) {
+		jniThrowIOExceptionMsg(env, "splice error!!", rc);
+	}
+	return rc;
+}
+
+/*
+ static jlong OSFileSystem_copyRange(JNIEnv* env, jobject, jint srcFd,
+ jlong srcOffset, jint dstFd, jlong dstOffset, jlong count) {
+ */
+JNIEXPORT jlong JNICALL
+Java_org_apache_harmony_luni_platform_OSFileSystem_copyRange(JNIEnv* env,
+		jobject, jint srcFd, jlong srcOffset, jint dstFd, jlong dstOffset,
+		jlong count) {
+	xoff64 inOff = srcOffset;
+	xoff64 outOff = dstOffset;
+
+	xssize rc = xi_file_copy_range(srcFd, &inOff, dstFd, &outOff, count);
+	if (rc < 0) {
+		jniThrowIOExceptionMsg(env, "copy_file_range error!!", rc);
+	}
+	return rc;
+}
+
 /*
  static jlong OSFileSystem_readDirect(JNIEnv* env, jobject, jint fd,
  jint buf, jint offset, jint byteCount) {
@@ -335,6 +401,87 @@ Java_org_apache_harmony_luni_platform_OSFileSystem_write(JNIEnv* env, jobject,
 			NULL, fd, buf, offset, byteCount);
 }
 
+/*
+ static jlong OSFileSystem_preadDirect(JNIEnv* env, jobject, jint fd,
+ jint buf, jint offset, jint byteCount, jlong position) {
+ */
+JNIEXPORT jlong JNICALL
+Java_org_apache_harmony_luni_platform_OSFileSystem_preadDirect(JNIEnv* env,
+		jobject, jint fd, jint buf, jint offset, jint byteCount, jlong position) {
+	if (byteCount == 0) {
+		return 0;
+	}
+	jbyte* dst = reinterpret_cast<jbyte*> (buf + offset);
+	jlong rc = xi_file_pread(fd, dst, byteCount, position);
+	if (rc == 0) {
+		return -1;
+	}
+	if (rc < 0) {
+		// We return 0 rather than throw if we try to read from an empty non-blocking pipe.
+		if (rc == XI_FILE_RV_ERR_AGAIN) {
+			return 0;
+		}
+		jniThrowIOExceptionMsg(env, "pread direct error!!", rc);
+	}
+	return rc;
+}
+
+/*
+ static jlong OSFileSystem_pread(JNIEnv* env, jobject, jint fd,
+ jbyteArray byteArray, jint offset, jint byteCount, jlong position) {
+ */
+JNIEXPORT jlong JNICALL
+Java_org_apache_harmony_luni_platform_OSFileSystem_pread(JNIEnv* env, jobject,
+		jint fd, jbyteArray byteArray, jint offset, jint byteCount,
+		jlong position) {
+	ScopedByteArrayRW bytes(env, byteArray);
+	if (bytes.get() == NULL) {
+		return 0;
+	}
+	jint buf = static_cast<jint> (reinterpret_cast<xlong> (bytes.get()));
+	return Java_org_apache_harmony_luni_platform_OSFileSystem_preadDirect(env,
+			NULL, fd, buf, offset, byteCount, position);
+}
+
+/*
+ static jlong OSFileSystem_pwriteDirect(JNIEnv* env, jobject, jint fd,
+ jint buf, jint offset, jint byteCount, jlong position) {
+ */
+JNIEXPORT jlong JNICALL
+Java_org_apache_harmony_luni_platform_OSFileSystem_pwriteDirect(JNIEnv* env,
+		jobject, jint fd, jint buf, jint offset, jint byteCount, jlong position) {
+	if (byteCount == 0) {
+		return 0;
+	}
+	jbyte* src = reinterpret_cast<jbyte*> (buf + offset);
+	jlong rc = xi_file_pwrite(fd, src, byteCount, position);
+	if (rc < 0) {
+		// Nothing is written to a full non-blocking pipe.
+		if (rc == XI_FILE_RV_ERR_AGAIN) {
+			return 0;
+		}
+		jniThrowIOExceptionMsg(env, "pwrite direct error!!", rc);
+	}
+	return rc;
+}
+
+/*
+ static jlong OSFileSystem_pwrite(JNIEnv* env, jobject, jint fd,
+ jbyteArray byteArray, jint offset, jint byteCount, jlong position) {
+ */
+JNIEXPORT jlong JNICALL
+Java_org_apache_harmony_luni_platform_OSFileSystem_pwrite(JNIEnv* env, jobject,
+		jint fd, jbyteArray byteArray, jint offset, jint byteCount,
+		jlong position) {
+	ScopedByteArrayRO bytes(env, byteArray);
+	if (bytes.get() == NULL) {
+		return 0;
+	}
+	jint buf = static_cast<jint> (reinterpret_cast<xlong> (bytes.get()));
+	return Java_org_apache_harmony_luni_platform_OSFileSystem_pwriteDirect(env,
+			NULL, fd, buf, offset, byteCount, position);
+}
+
 //static jlong OSFileSystem_seek(JNIEnv* env, jobject, jint fd, jlong offset, jint javaWhence) {
 JNIEXPORT jlong JNICALL
 Java_org_apache_harmony_luni_platform_OSFileSystem_seek(JNIEnv* env, jobject,
@@ -523,6 +670,10 @@ Java_org_apache_harmony_luni_platform_OSFileSystem_length(JNIEnv* env, jobject,
  NATIVE_METHOD(OSFileSystem, length, "(I)J"),
  NATIVE_METHOD(OSFileSystem, lockImpl, "(IJJIZ)I"),
  NATIVE_METHOD(OSFileSystem, open, "(Ljava/lang/String;I)I"),
+ NATIVE_METHOD(OSFileSystem, pread, "(I[BIIJ)J"),
+ NATIVE_METHOD(OSFileSystem, preadDirect, "(IIIIJ)J"),
+ NATIVE_METHOD(OSFileSystem, pwrite, "(I[BIIJ)J"),
+ NATIVE_METHOD(OSFileSystem, pwriteDirect, "(IIIIJ)J"),
  NATIVE_METHOD(OSFileSystem, read, "(I[BII)J"),
  NATIVE_METHOD(OSFileSystem, readDirect, "(IIII)J"),
  NATIVE_METHOD(OSFileSystem, readv, "(I[I[I[II)J"),
@@ -201,6 +201,26 @@ static bool inetAddressToSocketAddress(JNIEnv* env, jobject inetAddress,
 	return byteArrayToSocketAddress(env, NULL, addressBytes, port, ss);
 }
 
+/**
+ * Converts an InetAddress object and port number to a binary address.
+ */
+static bool inetAddressToSocketAddressBin(JNIEnv* env, jobject inetAddress,
+		int port, xi_sock_addr_bin_t* ss) {
+	if (inetAddress == NULL) {
+		jniThrowNullPointerException(env, NULL);
+		return false;
+	}
+
+	jclass inetAddressClass = env->FindClass("java/net/InetAddress");
+	jfieldID iaddr_ipaddress = env->GetFieldID(inetAddressClass, "ipaddress",
+			"[B");
+	jbyteArray addressBytes =
+			reinterpret_cast<jbyteArray> (env->GetObjectField(inetAddress,
+					iaddr_ipaddress));
+
+	return byteArrayToSocketAddressBin(env, addressBytes, port, ss);
+}
+
 /*
  // Converts a number of milliseconds to a timeval.
  static timeval toTimeval(long ms) {
@@ -811,12 +831,12 @@ Java_org_apache_harmony_luni_platform_OSNetworkSystem_accept(JNIEnv* env,
 	}
 
 	//sockaddr_storage ss;
-	xi_sock_addr_t ss;
+	xi_sock_addr_bin_t ss;
 	int clientFd;
 	{
 		int intFd = serverFd.get();
 		AsynchronousSocketCloseMonitor monitor(intFd);
-		clientFd = xi_socket_accept(intFd, &ss);
+		clientFd = xi_socket_accept_bin(intFd, &ss);
 	}
 	if (env->ExceptionOccurred()) {
 		return;
@@ -848,12 +868,12 @@ Java_org_apache_harmony_luni_platform_OSNetworkSystem_accept(JNIEnv* env,
 	 */
 	if (ss.family == XI_SOCK_FAMILY_INET || ss.family == XI_SOCK_FAMILY_INET6) {
 		// Remote address and port.
-		jobject remoteAddress = socketAddressToInetAddress(env, &ss);
+		jobject remoteAddress = socketAddressBinToInetAddress(env, &ss);
 		if (remoteAddress == NULL) {
 			xi_socket_close(clientFd);
 			return;
 		}
-		int remotePort = getSocketAddressPort(&ss);
+		int remotePort = ss.port;
 		jclass socketImplClass = env->FindClass("java/net/SocketImpl");
 		jfieldID socketimpl_address = env->GetFieldID(socketImplClass,
 				"address", "Ljava/net/InetAddress;");
@@ -864,8 +884,7 @@ Java_org_apache_harmony_luni_platform_OSNetworkSystem_accept(JNIEnv* env,
 		env->SetIntField(newSocket, socketimpl_port, remotePort);
 
 		// Local port.
-		xi_mem_set(&ss, 0, sizeof(xi_sock_addr_t));
-		int rc = xi_socket_get_local(clientFd, &ss);
+		int rc = xi_socket_get_local_bin(clientFd, &ss);
 		if (rc < 0) {
 			xi_socket_close(clientFd);
 			jniThrowSocketExceptionMsg(env, "java/net/SocketException",
@@ -873,7 +892,7 @@ Java_org_apache_harmony_luni_platform_OSNetworkSystem_accept(JNIEnv* env,
 			//jniThrowSocketException(env, errno);
 			return;
 		}
-		int localPort = getSocketAddressPort(&ss);
+		int localPort = ss.port;
 		jfieldID socketimpl_localport = env->GetFieldID(socketImplClass,
 				"localport", "I");
 
@@ -1018,14 +1037,13 @@ Java_org_apache_harmony_luni_platform_OSNetworkSystem_recvDirect(JNIEnv* env,
 	char* buf =
 			reinterpret_cast<char*> (static_cast<xuint32> (address + offset));
 	//const int flags = peek ? MSG_PEEK : 0;
-	xi_sock_addr_t ss;
-	xi_mem_set(&ss, 0, sizeof(ss));
+	xi_sock_addr_bin_t ss;
 
 	xint32 bytesReceived;
 	{
 		int intFd = fd.get();
 		AsynchronousSocketCloseMonitor monitor(intFd);
-		bytesReceived = xi_socket_recvfrom(intFd, buf, length, &ss);
+		bytesReceived = xi_socket_recvfrom_bin(intFd, buf, length, &ss);
 	}
 	if (env->ExceptionOccurred()) {
 		return -1;
@@ -1049,11 +1067,11 @@ Java_org_apache_harmony_luni_platform_OSNetworkSystem_recvDirect(JNIEnv* env,
 				"I");
 		env->SetIntField(packet, dpack_length, bytesReceived);
 		if (!connected) {
-			jbyteArray addr = socketAddressToByteArray(env, &ss);
+			jbyteArray addr = socketAddressBinToByteArray(env, &ss);
 			if (addr == NULL) {
 				return 0;
 			}
-			int port = getSocketAddressPort(&ss);
+			int port = ss.port;
 			jobject sender = byteArrayToInetAddress(env, addr);
 			if (sender == NULL) {
 				return 0;
@@ -1100,8 +1118,8 @@ Java_org_apache_harmony_luni_platform_OSNetworkSystem_sendDirect(JNIEnv* env,
 		return -1;
 	}
 
-	xi_sock_addr_t receiver;
-	if (inetAddress != NULL && !inetAddressToSocketAddress(env, inetAddress,
+	xi_sock_addr_bin_t receiver;
+	if (inetAddress != NULL && !inetAddressToSocketAddressBin(env, inetAddress,
 			port, &receiver)) {
 		return -1;
 	}
@@ -1115,7 +1133,11 @@ Java_org_apache_harmony_luni_platform_OSNetworkSystem_sendDirect(JNIEnv* env,
 	{
 		int intFd = fd.get();
 		AsynchronousSocketCloseMonitor monitor(intFd);
-		bytesSent = xi_socket_sendto(intFd, buf, length, receiver);
+		if (inetAddress != NULL) {
+			bytesSent = xi_socket_sendto_bin(intFd, buf, length, &receiver);
+		} else {
+			bytesSent = xi_socket_send(intFd, buf, length);
+		}
 	}
 	if (env->ExceptionOccurred()) {
 		return -1;
@@ -1154,6 +1176,191 @@ Java_org_apache_harmony_luni_platform_OSNetworkSystem_send(JNIEnv* env,
 			length, port, inetAddress);
 }
 
+/*
+ * The number of packets handled by one recvBatch/sendBatch call.
+ * The caller loops for more.
+ */
+#define NET_BATCH_MAX 32
+
+/**
+ * Pins the data of the packets from offset, and fills the message vector.
+ * Returns the number of pinned packets (stops at a null packet).
+ */
+static jint batchPin(JNIEnv* env, jobjectArray packets, jint offset,
+		jint count,
+		jbyteArray* arrays, jbyte** bytes, xi_sock_msg_t* msgs, bool send) {
+	jclass datagramPacketClass = env->FindClass("java/net/DatagramPacket");
+	jfieldID dpack_data = env->GetFieldID(datagramPacketClass, "data", "[B");
+	jfieldID dpack_offset = env->GetFieldID(datagramPacketClass, "offset",
+			"I");
+	jfieldID dpack_length = env->GetFieldID(datagramPacketClass, "length",
+			"I");
+	jfieldID dpack_address = env->GetFieldID(datagramPacketClass, "address",
+			"Ljava/net/InetAddress;");
+	jfieldID dpack_port = env->GetFieldID(datagramPacketClass, "port", "I");
+
+	jint i;
+	for (i = 0; i < count; i++) {
+		jobject packet = env->GetObjectArrayElement(packets, offset + i);
+		if (packet == NULL) {
+			break;
+		}
+		arrays[i] = reinterpret_cast<jbyteArray> (env->GetObjectField(packet,
+				dpack_data));
+		bytes[i] = env->GetByteArrayElements(arrays[i], NULL);
+		if (bytes[i] == NULL) {
+			break;
+		}
+		msgs[i].buf = bytes[i] + env->GetIntField(packet, dpack_offset);
+		msgs[i].blen = env->GetIntField(packet, dpack_length);
+		msgs[i].len = 0;
+		xi_mem_set(&msgs[i].addr, 0, sizeof(msgs[i].addr));
+		if (send) {
+			jobject inetAddress = env->GetObjectField(packet, dpack_address);
+			if (inetAddress != NULL && !inetAddressToSocketAddressBin(env,
+					inetAddress, env->GetIntField(packet, dpack_port),
+					&msgs[i].addr)) {
+				env->ReleaseByteArrayElements(arrays[i], bytes[i], JNI_ABORT);
+				break;
+			}
+		}
+		env->DeleteLocalRef(packet);
+	}
+	return i;
+}
+
+/*
+ static jint OSNetworkSystem_recvBatch(JNIEnv* env, jobject, jobject fd,
+ jobjectArray packets, jint offset, jint count, jboolean connected) {
+ */
+JNIEXPORT jint JNICALL
+Java_org_apache_harmony_luni_platform_OSNetworkSystem_recvBatch(JNIEnv* env,
+		jobject, jobject fileDescriptor, jobjectArray packets, jint offset,
+		jint count, jboolean connected) {
+	NetFd fd(env, fileDescriptor);
+	if (fd.isClosed()) {
+		return 0;
+	}
+
+	jbyteArray arrays[NET_BATCH_MAX];
+	jbyte* bytes[NET_BATCH_MAX];
+	xi_sock_msg_t msgs[NET_BATCH_MAX];
+
+	jint pinned = batchPin(env, packets, offset, (count < NET_BATCH_MAX) ? count
+			: NET_BATCH_MAX, arrays, bytes, msgs, false);
+	if (env->ExceptionOccurred()) {
+		for (jint i = 0; i < pinned; i++) {
+			env->ReleaseByteArrayElements(arrays[i], bytes[i], JNI_ABORT);
+		}
+		return -1;
+	}
+	if (pinned <= 0) {
+		return 0;
+	}
+
+	xint32 received;
+	{
+		int intFd = fd.get();
+		AsynchronousSocketCloseMonitor monitor(intFd);
+		received = xi_socket_recvmmsg(intFd, msgs, pinned);
+	}
+	for (jint i = 0; i < pinned; i++) {
+		env->ReleaseByteArrayElements(arrays[i], bytes[i],
+				(i < received) ? 0 : JNI_ABORT);
+	}
+	if (env->ExceptionOccurred()) {
+		return -1;
+	}
+	if (received == XI_SOCK_RV_ERR_TRYLATER) {
+		// nothing to receive on a non-blocking socket
+		return 0;
+	}
+	if (received < 0) {
+		jniThrowSocketExceptionMsg(env, "java/net/SocketException",
+				"recvmmsg error!!", received);
+		return 0;
+	}
+
+	jclass datagramPacketClass = env->FindClass("java/net/DatagramPacket");
+	jfieldID dpack_length = env->GetFieldID(datagramPacketClass, "length", "I");
+	jfieldID dpack_address = env->GetFieldID(datagramPacketClass, "address",
+			"Ljava/net/InetAddress;");
+	jfieldID dpack_port = env->GetFieldID(datagramPacketClass, "port", "I");
+	for (jint i = 0; i < received; i++) {
+		jobject packet = env->GetObjectArrayElement(packets, offset + i);
+		env->SetIntField(packet, dpack_length, static_cast<jint> (msgs[i].len));
+		if (!connected) {
+			jbyteArray addr = socketAddressBinToByteArray(env, &msgs[i].addr);
+			if (addr == NULL) {
+				return 0;
+			}
+			jobject sender = byteArrayToInetAddress(env, addr);
+			if (sender == NULL) {
+				return 0;
+			}
+			env->SetObjectField(packet, dpack_address, sender);
+			env->SetIntField(packet, dpack_port, msgs[i].addr.port);
+			env->DeleteLocalRef(sender);
+			env->DeleteLocalRef(addr);
+		}
+		env->DeleteLocalRef(packet);
+	}
+	return received;
+}
+
+/*
+ static jint OSNetworkSystem_sendBatch(JNIEnv* env, jobject, jobject fd,
+ jobjectArray packets, jint offset, jint count) {
+ */
+JNIEXPORT jint JNICALL
+Java_org_apache_harmony_luni_platform_OSNetworkSystem_sendBatch(JNIEnv* env,
+		jobject, jobject fileDescriptor, jobjectArray packets, jint offset,
+		jint count) {
+	NetFd fd(env, fileDescriptor);
+	if (fd.isClosed()) {
+		return -1;
+	}
+
+	jbyteArray arrays[NET_BATCH_MAX];
+	jbyte* bytes[NET_BATCH_MAX];
+	xi_sock_msg_t msgs[NET_BATCH_MAX];
+
+	jint pinned = batchPin(env, packets, offset, (count < NET_BATCH_MAX) ? count
+			: NET_BATCH_MAX, arrays, bytes, msgs, true);
+	if (env->ExceptionOccurred()) {
+		for (jint i = 0; i < pinned; i++) {
+			env->ReleaseByteArrayElements(arrays[i], bytes[i], JNI_ABORT);
+		}
+		return -1;
+	}
+	if (pinned <= 0) {
+		return 0;
+	}
+
+	xint32 sent;
+	{
+		int intFd = fd.get();
+		AsynchronousSocketCloseMonitor monitor(intFd);
+		sent = xi_socket_sendmmsg(intFd, msgs, pinned);
+	}
+	for (jint i = 0; i < pinned; i++) {
+		env->ReleaseByteArrayElements(arrays[i], bytes[i], JNI_ABORT);
+	}
+	if (env->ExceptionOccurred()) {
+		return -1;
+	}
+	if (sent == XI_SOCK_RV_ERR_TRYLATER) {
+		// no room to send on a non-blocking socket
+		return 0;
+	}
+	if (sent < 0) {
+		jniThrowSocketExceptionMsg(env, "java/net/SocketException",
+				"sendmmsg error!!", sent);
+		return 0;
+	}
+	return sent;
+}
+
 //
 //static bool isValidFd(int fd) {
 //	return fd >= 0 && fd < 64;
@@ -1324,6 +1531,149 @@ Java_org_apache_harmony_luni_platform_OSNetworkSystem_selectImpl(JNIEnv* env,
 	return JNI_TRUE;
 }
 
+static xint32 pollsetOpsToEvents(jint ops) {
+	xint32 evts = 0;
+	if (ops & SOCKET_OP_READ) {
+		evts |= XI_POLL_EVENT_IN;
+	}
+	if (ops & SOCKET_OP_WRITE) {
+		evts |= XI_POLL_EVENT_OUT;
+	}
+	return evts;
+}
+
+static jint pollsetEventsToOps(xint32 evts) {
+	jint ops = SOCKET_OP_NONE;
+	if (evts & XI_POLL_EVENT_IN) {
+		ops |= SOCKET_OP_READ;
+	}
+	if (evts & XI_POLL_EVENT_OUT) {
+		ops |= SOCKET_OP_WRITE;
+	}
+	// error and hang-up wake whoever is interested, as select(2) does
+	if (evts & (XI_POLL_EVENT_ERR | XI_POLL_EVENT_HUP)) {
+		ops |= SOCKET_OP_READ | SOCKET_OP_WRITE;
+	}
+	return ops;
+}
+
+JNIEXPORT jlong JNICALL
+Java_org_apache_harmony_luni_platform_OSNetworkSystem_pollsetCreate(
+		JNIEnv* env, jobject, jint size) {
+	xi_pollset_t *pset = xi_pollset_create((xuint32) size, XI_POLLSET_OPT_EPOLL);
+	if (pset == NULL) {
+		jniThrowSocketExceptionMsg(env, "java/net/SocketException",
+				"cannot create the pollset!!", size);
+		return 0;
+	}
+	return reinterpret_cast<jlong> (pset);
+}
+
+JNIEXPORT void JNICALL
+Java_org_apache_harmony_luni_platform_OSNetworkSystem_pollsetDestroy(
+		JNIEnv*, jobject, jlong pollset) {
+	xi_pollset_destroy(reinterpret_cast<xi_pollset_t *> (pollset));
+}
+
+JNIEXPORT jint JNICALL
+Java_org_apache_harmony_luni_platform_OSNetworkSystem_pollsetAdd(JNIEnv* env,
+		jobject, jlong pollset, jobject fileDescriptor, jint ops, jint index) {
+	const int fd = jniGetFDFromFileDescriptor(env, fileDescriptor);
+	if (fd < 0) {
+		return -1;
+	}
+
+	xi_pollfd_t pfd;
+
+	pfd.desc = fd;
+	pfd.evts = pollsetOpsToEvents(ops);
+	pfd.context = reinterpret_cast<xvoid *> (static_cast<xintptr> (index));
+
+	int ret = xi_pollset_add(reinterpret_cast<xi_pollset_t *> (pollset), pfd);
+	if (ret != XI_POLLSET_RV_OK) {
+		jniThrowSocketExceptionMsg(env, "java/net/SocketException",
+				"pollset add error!!", ret);
+		return -1;
+	}
+	return fd;
+}
+
+JNIEXPORT void JNICALL
+Java_org_apache_harmony_luni_platform_OSNetworkSystem_pollsetModify(
+		JNIEnv* env, jobject, jlong pollset, jint fd, jint ops, jint index) {
+	xi_pollfd_t pfd;
+
+	pfd.desc = fd;
+	pfd.evts = pollsetOpsToEvents(ops);
+	pfd.context = reinterpret_cast<xvoid *> (static_cast<xintptr> (index));
+
+	int ret = xi_pollset_modify(reinterpret_cast<xi_pollset_t *> (pollset), pfd);
+	if (ret != XI_POLLSET_RV_OK) {
+		jniThrowSocketExceptionMsg(env, "java/net/SocketException",
+				"pollset modify error!!", ret);
+	}
+}
+
+JNIEXPORT void JNICALL
+Java_org_apache_harmony_luni_platform_OSNetworkSystem_pollsetRemove(
+		JNIEnv* env, jobject, jlong pollset, jint fd, jint ops) {
+	xi_pollfd_t pfd;
+
+	pfd.desc = fd;
+	pfd.evts = pollsetOpsToEvents(ops);
+	pfd.context = NULL;
+
+	int ret = xi_pollset_remove(reinterpret_cast<xi_pollset_t *> (pollset), pfd);
+	if (ret != XI_POLLSET_RV_OK && ret != XI_POLLSET_RV_ERR_NF) {
+		jniThrowSocketExceptionMsg(env, "java/net/SocketException",
+				"pollset remove error!!", ret);
+	}
+}
+
+// the ready descriptors of a wait, which are on the stack of xi_pollset_poll too
+#define NET_POLL_WAIT_MAX 1024
+
+JNIEXPORT jint JNICALL
+Java_org_apache_harmony_luni_platform_OSNetworkSystem_pollsetWait(JNIEnv* env,
+		jobject, jlong pollset, jintArray outIndexes, jintArray outOps,
+		jlong timeoutMs) {
+	xi_pollfd_t rfds[NET_POLL_WAIT_MAX];
+	jint indexes[NET_POLL_WAIT_MAX];
+	jint ops[NET_POLL_WAIT_MAX];
+
+	jsize rlen = env->GetArrayLength(outIndexes);
+	if (env->GetArrayLength(outOps) < rlen) {
+		rlen = env->GetArrayLength(outOps);
+	}
+	if (rlen <= 0) {
+		return 0;
+	}
+	if (rlen > NET_POLL_WAIT_MAX) {
+		// the rest stay ready for the next wait
+		rlen = NET_POLL_WAIT_MAX;
+	}
+
+	xint32 msecs = (timeoutMs > XI_INT_MAX) ? XI_INT_MAX : (xint32) timeoutMs;
+	int result = xi_pollset_poll(reinterpret_cast<xi_pollset_t *> (pollset),
+			rfds, rlen, msecs);
+	if (result == XI_POLLSET_RV_ERR_TIMEOUT || result == XI_POLLSET_RV_ERR_INTR) {
+		return 0;
+	} else if (result < 0) {
+		jniThrowSocketExceptionMsg(env, "java/net/SocketException",
+				"poll error!!", result);
+		return -1;
+	}
+
+	for (int i = 0; i < result; i++) {
+		indexes[i] = static_cast<jint> (reinterpret_cast<xintptr> (rfds[i].context));
+		ops[i] = pollsetEventsToOps(rfds[i].evts);
+	}
+	env->SetIntArrayRegion(outIndexes, 0, result, indexes);
+	env->SetIntArrayRegion(outOps, 0, result, ops);
+
+	return result;
+}
+
 /*
  static jobject OSNetworkSystem_getSocketLocalAddress(JNIEnv* env,
  jobject, jobject fileDescriptor) {
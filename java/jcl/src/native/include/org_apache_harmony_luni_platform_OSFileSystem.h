@@ -71,6 +71,38 @@ JNIEXPORT jlong JNICALL Java_org_apache_harmony_luni_platform_OSFileSystem_readD
 JNIEXPORT jlong JNICALL Java_org_apache_harmony_luni_platform_OSFileSystem_writeDirect
   (JNIEnv *, jobject, jint, jint, jint, jint);
 
+/*
+ * Class:     org_apache_harmony_luni_platform_OSFileSystem
+ * Method:    pread
+ * Signature: (I[BIIJ)J
+ */
+JNIEXPORT jlong JNICALL Java_org_apache_harmony_luni_platform_OSFileSystem_pread
+  (JNIEnv *, jobject, jint, jbyteArray, jint, jint, jlong);
+
+/*
+ * Class:     org_apache_harmony_luni_platform_OSFileSystem
+ * Method:    pwrite
+ * Signature: (I[BIIJ)J
+ */
+JNIEXPORT jlong JNICALL Java_org_apache_harmony_luni_platform_OSFileSystem_pwrite
+  (JNIEnv *, jobject, jint, jbyteArray, jint, jint, jlong);
+
+/*
+ * Class:     org_apache_harmony_luni_platform_OSFileSystem
+ * Method:    preadDirect
+ * Signature: (IIIIJ)J
+ */
+JNIEXPORT jlong JNICALL Java_org_apache_harmony_luni_platform_OSFileSystem_preadDirect
+  (JNIEnv *, jobject, jint, jint, jint, jint, jlong);
+
+/*
+ * Class:     org_apache_harmony_luni_platform_OSFileSystem
+ * Method:    pwriteDirect
+ * Signature: (IIIIJ)J
+ */
+JNIEXPORT jlong JNICALL Java_org_apache_harmony_luni_platform_OSFileSystem_pwriteDirect
+  (JNIEnv *, jobject, jint, jint, jint, jint, jlong);
+
 /*
  * Class:     org_apache_harmony_luni_platform_OSFileSystem
  * Method:    read
@@ -127,6 +159,30 @@ JNIEXPORT jint JNICALL Java_org_apache_harmony_luni_platform_OSFileSystem_open
 JNIEXPORT jlong JNICALL Java_org_apache_harmony_luni_platform_OSFileSystem_transfer
   (JNIEnv *, jobject, jint, jobject, jlong, jlong);
 
+/*
+ * Class:     org_apache_harmony_luni_platform_OSFileSystem
+ * Method:    spliceTo
+ * Signature: (IJLjava/io/FileDescriptor;J)J
+ */
+JNIEXPORT jlong JNICALL Java_org_apache_harmony_luni_platform_OSFileSystem_spliceTo
+  (JNIEnv *, jobject, jint, jlong, jobject, jlong);
+
+/*
+ * Class:     org_apache_harmony_luni_platform_OSFileSystem
+ * Method:    spliceFrom
+ * Signature: (Ljava/io/FileDescriptor;IJJ)J
+ */
+JNIEXPORT jlong JNICALL Java_org_apache_harmony_luni_platform_OSFileSystem_spliceFrom
+  (JNIEnv *, jobject, jobject, jint, jlong, jlong);
+
+/*
+ * Class:     org_apache_harmony_luni_platform_OSFileSystem
+ * Method:    copyRange
+ * Signature: (IJIJJ)J
+ */
+JNIEXPORT jlong JNICALL Java_org_apache_harmony_luni_platform_OSFileSystem_copyRange
+  (JNIEnv *, jobject, jint, jlong, jint, jlong, jlong);
+
 /*
  * Class:     org_apache_harmony_luni_platform_OSFileSystem
  * Method:    ioctlAvailable
@@ -127,6 +127,14 @@ JNIEXPORT jint JNICALL Java_org_apache_harmony_luni_platform_OSNetworkSystem_rec
 JNIEXPORT jint JNICALL Java_org_apache_harmony_luni_platform_OSNetworkSystem_recvDirect
   (JNIEnv *, jobject, jobject, jobject, jint, jint, jint, jboolean, jboolean);
 
+/*
+ * Class:     org_apache_harmony_luni_platform_OSNetworkSystem
+ * Method:    recvBatch
+ * Signature: (Ljava/io/FileDescriptor;[Ljava/net/DatagramPacket;IIZ)I
+ */
+JNIEXPORT jint JNICALL Java_org_apache_harmony_luni_platform_OSNetworkSystem_recvBatch
+  (JNIEnv *, jobject, jobject, jobjectArray, jint, jint, jboolean);
+
 /*
  * Class:     org_apache_harmony_luni_platform_OSNetworkSystem
  * Method:    selectImpl
@@ -135,6 +143,54 @@ JNIEXPORT jint JNICALL Java_org_apache_harmony_luni_platform_OSNetworkSystem_rec
 JNIEXPORT jboolean JNICALL Java_org_apache_harmony_luni_platform_OSNetworkSystem_selectImpl
   (JNIEnv *, jclass, jobjectArray, jobjectArray, jint, jint, jintArray, jlong);
 
+/*
+ * Class:     org_apache_harmony_luni_platform_OSNetworkSystem
+ * Method:    pollsetCreate
+ * Signature: (I)J
+ */
+JNIEXPORT jlong JNICALL Java_org_apache_harmony_luni_platform_OSNetworkSystem_pollsetCreate
+  (JNIEnv *, jobject, jint);
+
+/*
+ * Class:     org_apache_harmony_luni_platform_OSNetworkSystem
+ * Method:    pollsetDestroy
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_org_apache_harmony_luni_platform_OSNetworkSystem_pollsetDestroy
+  (JNIEnv *, jobject, jlong);
+
+/*
+ * Class:     org_apache_harmony_luni_platform_OSNetworkSystem
+ * Method:    pollsetAdd
+ * Signature: (JLjava/io/FileDescriptor;II)I
+ */
+JNIEXPORT jint JNICALL Java_org_apache_harmony_luni_platform_OSNetworkSystem_pollsetAdd
+  (JNIEnv *, jobject, jlong, jobject, jint, jint);
+
+/*
+ * Class:     org_apache_harmony_luni_platform_OSNetworkSystem
+ * Method:    pollsetModify
+ * Signature: (JIII)V
+ */
+JNIEXPORT void JNICALL Java_org_apache_harmony_luni_platform_OSNetworkSystem_pollsetModify
+  (JNIEnv *, jobject, jlong, jint, jint, jint);
+
+/*
+ * Class:     org_apache_harmony_luni_platform_OSNetworkSystem
+ * Method:    pollsetRemove
+ * Signature: (JII)V
+ */
+JNIEXPORT void JNICALL Java_org_apache_harmony_luni_platform_OSNetworkSystem_pollsetRemove
+  (JNIEnv *, jobject, jlong, jint, jint);
+
+/*
+ * Class:     org_apache_harmony_luni_platform_OSNetworkSystem
+ * Method:    pollsetWait
+ * Signature: (J[I[IJ)I
+ */
+JNIEXPORT jint JNICALL Java_org_apache_harmony_luni_platform_OSNetworkSystem_pollsetWait
+  (JNIEnv *, jobject, jlong, jintArray, jintArray, jlong);
+
 /*
  * Class:     org_apache_harmony_luni_platform_OSNetworkSystem
  * Method:    send
@@ -151,6 +207,14 @@ JNIEXPORT jint JNICALL Java_org_apache_harmony_luni_platform_OSNetworkSystem_sen
 JNIEXPORT jint JNICALL Java_org_apache_harmony_luni_platform_OSNetworkSystem_sendDirect
   (JNIEnv *, jobject, jobject, jint, jint, jint, jint, jobject);
 
+/*
+ * Class:     org_apache_harmony_luni_platform_OSNetworkSystem
+ * Method:    sendBatch
+ * Signature: (Ljava/io/FileDescriptor;[Ljava/net/DatagramPacket;II)I
+ */
+JNIEXPORT jint JNICALL Java_org_apache_harmony_luni_platform_OSNetworkSystem_sendBatch
+  (JNIEnv *, jobject, jobject, jobjectArray, jint, jint);
+
 /*
  * Class:     org_apache_harmony_luni_platform_OSNetworkSystem
  * Method:    sendUrgentData
@@ -55,6 +55,8 @@ current_dir_rel        = $(notdir $(current_dir_abs))
 module_dir_target      = $(basedir)/amk/$(TARGET)/xi/$(current_dir_rel)
 module_dir_object      = $(module_dir_target)/object
 module_dir_test        = $(module_dir_target)/test
+module_dir_bench       = $(module_dir_target)/bench
+module_dir_tools       = $(module_dir_target)/tools
 # Output
 module_dir_output_base = $(basedir)/amk/$(TARGET)/emul
 module_dir_output_bin  = $(module_dir_output_base)/bin
@@ -81,9 +83,20 @@ module_test_target_a   = $(build_opt_a_pre)xibasetest.$(build_opt_a_ext)
 module_test_target_so  = $(build_opt_so_pre)xibasetest.$(build_opt_so_ext)
 module_test_target_bin = xibase$(build_opt_exe_ext)
 
+module_bench_src_mk    = $(buildbc_xibase_src_mk)
+module_bench_cflags    = $(buildbc_xibase_cflags)
+module_bench_ldflags   = -LIBPATH:$(module_dir_target) $(buildbc_xibase_ldflags)
+module_bench_target_bin = xibench$(build_opt_exe_ext)
+
+# the tools take the flags of the bench
+module_tool_src_mk     = $(current_dir_abs)/tools/xilogdec.c
+module_tool_cflags     = $(buildbc_xibase_cflags)
+module_tool_ldflags    = -LIBPATH:$(module_dir_target) $(buildbc_xibase_ldflags)
+module_tool_target_bin = xilogdec$(build_opt_exe_ext)
+
 # PREPARE : Set VPATH!!
 vpath
-vpath %.c $(current_dir_abs)/src/_all:$(current_dir_abs)/src/win32:$(current_dir_abs)/test
+vpath %.c $(current_dir_abs)/src/_all:$(current_dir_abs)/src/win32:$(current_dir_abs)/test:$(current_dir_abs)/bench:$(current_dir_abs)/tools
 
 # PREPARE : Build Targets
 ifeq ($(build_run_a),1)
@@ -113,18 +126,34 @@ module_link_tbin_tmp3  = $(notdir $(module_objs_tbin))
 module_link_tbin       = $(addprefix $(module_dir_test)/,$(module_link_tbin_tmp3))
 module_target_test     = $(module_test_target_bin)
 endif
+module_objs_bench      = $(patsubst %.c,%.o,$(module_bench_src_mk))
+module_link_bench_tmp1 = $(notdir $(module_objs_bench))
+module_link_bench      = $(addprefix $(module_dir_bench)/,$(module_link_bench_tmp1))
+module_objs_tool       = $(patsubst %.c,%.o,$(module_tool_src_mk))
+module_link_tool_tmp1  = $(notdir $(module_objs_tool))
+module_link_tool       = $(addprefix $(module_dir_tools)/,$(module_link_tool_tmp1))
+ifeq ($(build_run_test),1)
+module_target_bench    = $(module_bench_target_bin)
+module_target_tool     = $(module_tool_target_bin)
+endif
 
 
 ###################
 # build-targets
 ###################
 
-all: prepare $(module_target_static) $(module_target_shared) $(module_target_test) post
+all: prepare $(module_target_static) $(module_target_shared) $(module_target_test) $(module_target_bench) $(module_target_tool) post
+
+bench: prepare $(module_bench_target_bin)
+
+tools: prepare $(module_tool_target_bin)
 
 prepare_mkdir_base:
 	@$(MKDIR) -p "$(module_dir_target)"
 	@$(MKDIR) -p "$(module_dir_object)"
 	@$(MKDIR) -p "$(module_dir_test)"
+	@$(MKDIR) -p "$(module_dir_bench)"
+	@$(MKDIR) -p "$(module_dir_tools)"
 
 prepare_mkdir_output:
 	@$(MKDIR) -p "$(module_dir_output_base)"
@@ -244,6 +273,36 @@ $(module_test_target_bin): $(module_link_tbin) $(module_test_target_so)
 	@echo "================================================================"
 
 
+$(module_bench_target_bin): $(module_link_bench) $(module_build_target_so)
+	@echo "================================================================"
+	@echo "BUILD : $(module_bench_target_bin)"
+	@echo "----------------------------------------------------------------"
+	$(build_tool_linker) \
+		$(build_opt_ld) \
+		-PDB:$(module_dir_target)/$(module_bench_target_bin).pdb \
+		$(build_opt_cl_out) \
+		$(build_opt_ld_out)$(module_dir_target)/$(module_bench_target_bin) \
+		$(module_link_bench) \
+		$(module_bench_ldflags) \
+		$(build_opt_ld_mgwcc)
+	@echo "================================================================"
+
+
+$(module_tool_target_bin): $(module_link_tool) $(module_build_target_so)
+	@echo "================================================================"
+	@echo "BUILD : $(module_tool_target_bin)"
+	@echo "----------------------------------------------------------------"
+	$(build_tool_linker) \
+		$(build_opt_ld) \
+		-PDB:$(module_dir_target)/$(module_tool_target_bin).pdb \
+		$(build_opt_cl_out) \
+		$(build_opt_ld_out)$(module_dir_target)/$(module_tool_target_bin) \
+		$(module_link_tool) \
+		$(module_tool_ldflags) \
+		$(build_opt_ld_mgwcc)
+	@echo "================================================================"
+
+
 post:
 	@echo "================================================================"
 	@echo "OUTPUT : $(current_dir_abs)"
@@ -266,6 +325,12 @@ post:
 	$(TEST_FILE) $(module_dir_target)/$(module_test_target_bin) $(TEST_THEN) \
 		$(CP) $(module_dir_target)/$(module_test_target_bin) $(module_dir_output_test) \
 	$(TEST_END)
+	$(TEST_FILE) $(module_dir_target)/$(module_bench_target_bin) $(TEST_THEN) \
+		$(CP) $(module_dir_target)/$(module_bench_target_bin) $(module_dir_output_test) \
+	$(TEST_END)
+	$(TEST_FILE) $(module_dir_target)/$(module_tool_target_bin) $(TEST_THEN) \
+		$(CP) $(module_dir_target)/$(module_tool_target_bin) $(module_dir_output_bin) \
+	$(TEST_END)
 	@echo "================================================================"
 
 
@@ -289,3 +354,9 @@ $(module_dir_test)/%.o: %.c
 $(module_dir_test)/%.lo: %.c
 	$(build_tool_cc) $(build_opt_c) $(build_opt_fPIC) $(module_test_cflags) $(build_opt_cl_conly) -Fd$(module_dir_test)/vc100.pdb $(build_opt_cl_pfx)$@ $<
 
+$(module_dir_bench)/%.o: %.c
+	$(build_tool_cc) $(build_opt_c) $(module_bench_cflags) $(build_opt_cl_conly) -Fd$(module_dir_bench)/vc100.pdb $(build_opt_cl_pfx)$@ $<
+
+$(module_dir_tools)/%.o: %.c
+	$(build_tool_cc) $(build_opt_c) $(module_tool_cflags) $(build_opt_cl_conly) -Fd$(module_dir_tools)/vc100.pdb $(build_opt_cl_pfx)$@ $<
+
@@ -0,0 +1,115 @@
+/*
+ * Copyright 2013 Cheolmin Jo (webos21@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * File : bc.h
+ *
+ * The benchmark framework of xibench.
+ *
+ * A case does n operations in its run function and returns the elapsed
+ * nanoseconds of them, so that the setup of every run is not counted.
+ * The runner calls it for the warmup, grows n until one run takes
+ * the minimum time, and then reports ns/op of the repeated runs.
+ *
+ * The percentiles are over the latencies which a case gives to bc_sample
+ * in the measured runs, or over the means of the runs if it gives none.
+ * Those of the runs only tell the variance between the runs.
+ */
+
+#ifndef _BC_H_
+#define _BC_H_
+
+#include "xi/xtype.h"
+
+/**
+ * One benchmark case
+ */
+typedef struct _st_bc_case {
+	const xchar *name;                          ///< name of the case (suite/name)
+	xint64     (*run)(xvoid *state, xint64 n);  ///< does n ops and returns the elapsed ns (< 0 : error)
+	xint32     (*setup)(xvoid **state);         ///< prepares the state once (NULL : none, < 0 : error)
+	xvoid      (*teardown)(xvoid *state);       ///< releases the state (NULL : none)
+	xint64       ops;                           ///< fixed ops of a run (0 : calibrated by the time)
+	xint64       bytes;                         ///< bytes of an op for the bandwidth (0 : none)
+} bc_case_t;
+
+/**
+ * A suite is the array of cases, terminated by the NULL name
+ */
+typedef struct _st_bc_suite {
+	const xchar     *name;                      ///< name of the suite
+	const bc_case_t *cases;                     ///< cases of the suite
+} bc_suite_t;
+
+/**
+ * Options of the runner
+ */
+typedef struct _st_bc_opt {
+	xint32       runs;                          ///< measured runs of a case
+	xint32       warmups;                       ///< runs before measuring
+	xint32       msec;                          ///< minimum time of a calibrated run
+	xint32       threads;                       ///< threads of the contention cases
+	xint32       format;                        ///< BC_FMT_*
+	const xchar *dir;                           ///< directory of the temporary files
+} bc_opt_t;
+
+#define BC_FMT_TEXT  0
+#define BC_FMT_CSV   1
+#define BC_FMT_JSON  2
+
+#define BC_RUNS_MAX     1000
+#define BC_SAMPLES_MAX  65536   // the reservoir of the latencies of a case
+
+// bc_core.c
+extern bc_opt_t bc_opt;
+
+xvoid  bc_report_begin();
+xint32 bc_run_case(const bc_suite_t *suite, const bc_case_t *bcase);
+xvoid  bc_report_end();
+
+/**
+ * Record the latency of a batch of ops in the measured runs, as ns/op.
+ * It is called on the thread of the run function only.
+ */
+xvoid  bc_sample(xint64 ns, xint64 ops);
+
+/**
+ * The team of the threads for the contention cases.
+ * Every thread is created once, and bc_team_run starts them together.
+ */
+typedef xvoid (*bc_work_fn)(xint32 id, xint64 n, xvoid *arg);
+
+typedef struct _st_bc_team bc_team_t;
+
+bc_team_t *bc_team_create(xint32 threads, bc_work_fn fn, xvoid *arg);
+xint64     bc_team_run(bc_team_t *team, xint64 n);  // elapsed ns until the last one is done
+xvoid      bc_team_destroy(bc_team_t *team);
+
+/**
+ * A cheap random number (splitmix64) for the keys and the data
+ */
+xuint64    bc_rand(xuint64 *seed);
+
+// suites
+extern const bc_case_t bc_xi_hashtb[];
+extern const bc_case_t bc_xi_thread[];
+extern const bc_case_t bc_xi_atomic[];
+extern const bc_case_t bc_xi_poll[];
+extern const bc_case_t bc_xi_file[];
+extern const bc_case_t bc_xi_base64[];
+extern const bc_case_t bc_xi_log[];
+
+#endif // _BC_H_
@@ -0,0 +1,422 @@
+/*
+ * Copyright 2013 Cheolmin Jo (webos21@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * File : bc_core.c
+ */
+
+#include "bc.h"
+
+#include "xi/xi_arrays.h"
+#include "xi/xi_clock.h"
+#include "xi/xi_mem.h"
+#include "xi/xi_string.h"
+#include "xi/xi_sysinfo.h"
+#include "xi/xi_thread.h"
+
+#include <stdio.h>
+
+#define BC_CALIB_MAX  (1LL << 40)
+
+bc_opt_t bc_opt = { 10, 1, 20, 4, BC_FMT_TEXT, "." };
+
+static xint32 _g_results = 0;
+
+// the latencies of the measured runs, sampled by a reservoir
+static xfloat64 _g_lat[BC_SAMPLES_MAX];
+static xint64   _g_lat_seen = 0;
+static xuint64  _g_lat_seed = 0x5EED;
+static xbool    _g_lat_on = FALSE;
+
+typedef struct _st_bc_stat {
+	xint32    runs;
+	xint64    ops;
+	xint32    samples;   // of the percentiles
+	xbool     perop;     // the samples are the latencies, or the means of the runs
+	xfloat64  min;
+	xfloat64  p50;
+	xfloat64  p90;
+	xfloat64  p99;
+	xfloat64  max;
+	xfloat64  mean;      // of the runs
+	xfloat64  opss;      // ops per second at the median run
+	xfloat64  mbps;      // MB per second at the median run
+} bc_stat_t;
+
+static xint32 bc_cmp_f64(const xvoid *a, const xvoid *b) {
+	xfloat64 x = *((const xfloat64 *) a);
+	xfloat64 y = *((const xfloat64 *) b);
+	return (x < y) ? -1 : ((x > y) ? 1 : 0);
+}
+
+// nearest-rank on the sorted samples
+static xfloat64 bc_pct(const xfloat64 *sorted, xint32 cnt, xint32 pct) {
+	xint32 rank = (pct * cnt + 99) / 100;
+	if (rank < 1) {
+		rank = 1;
+	}
+	return sorted[rank - 1];
+}
+
+// the throughput is of the runs, and the percentiles are of the latencies if any
+static xvoid bc_stat_make(bc_stat_t *st, xfloat64 *runs, xint32 cnt,
+		xfloat64 *lat, xint32 nlat, xint64 ops, xint64 bytes) {
+	xint32 i;
+	xfloat64 sum = 0;
+	xfloat64 med;
+
+	xi_arrays_qsort(runs, (xsize) cnt, sizeof(xfloat64), bc_cmp_f64);
+	for (i = 0; i < cnt; i++) {
+		sum += runs[i];
+	}
+	med = bc_pct(runs, cnt, 50);
+
+	st->perop = (nlat > 0);
+	if (!st->perop) {
+		lat = runs;
+		nlat = cnt;
+	} else {
+		xi_arrays_qsort(lat, (xsize) nlat, sizeof(xfloat64), bc_cmp_f64);
+	}
+
+	st->runs = cnt;
+	st->ops = ops;
+	st->samples = nlat;
+	st->min = lat[0];
+	st->p50 = bc_pct(lat, nlat, 50);
+	st->p90 = bc_pct(lat, nlat, 90);
+	st->p99 = bc_pct(lat, nlat, 99);
+	st->max = lat[nlat - 1];
+	st->mean = sum / cnt;
+	st->opss = (med > 0) ? (1e9 / med) : 0;
+	st->mbps = (bytes > 0) ? (st->opss * (xfloat64) bytes / (1024.0 * 1024.0)) : 0;
+}
+
+static xvoid bc_report(const xchar *sname, const xchar *cname,
+		const bc_stat_t *st) {
+	switch (bc_opt.format) {
+	case BC_FMT_CSV:
+		if (st == NULL) {
+			printf("%s/%s,failed,0,0,,0,0,0,0,0,0,0,0,0\n", sname, cname);
+			break;
+		}
+		printf("%s/%s,ok,%d,%lld,%s,%d,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.0f,%.1f\n",
+				sname, cname, st->runs, st->ops, st->perop ? "ops" : "runs",
+				st->samples, st->min, st->p50, st->p90, st->p99, st->max,
+				st->mean, st->opss, st->mbps);
+		break;
+	case BC_FMT_JSON:
+		printf("%s\n    {\"case\": \"%s/%s\", ", (_g_results > 0) ? "," : "",
+				sname, cname);
+		if (st == NULL) {
+			printf("\"status\": \"failed\"}");
+			break;
+		}
+		printf("\"status\": \"ok\", \"runs\": %d, \"ops\": %lld, ", st->runs,
+				st->ops);
+		printf("\"pct_of\": \"%s\", \"samples\": %d, ",
+				st->perop ? "ops" : "runs", st->samples);
+		printf("\"min_ns\": %.1f, \"p50_ns\": %.1f, \"p90_ns\": %.1f, ",
+				st->min, st->p50, st->p90);
+		printf("\"p99_ns\": %.1f, \"max_ns\": %.1f, \"mean_ns\": %.1f, ",
+				st->p99, st->max, st->mean);
+		printf("\"ops_per_sec\": %.0f, \"mb_per_sec\": %.1f}", st->opss,
+				st->mbps);
+		break;
+	default:
+		if (st == NULL) {
+			printf("%s/%-*s  FAILED\n", sname, (xint32) (29 - xi_strlen(sname)),
+					cname);
+			break;
+		}
+		printf("%s/%-*s %10lld %7d %-4s %10.1f %10.1f %10.1f %10.1f %12.0f",
+				sname, (xint32) (29 - xi_strlen(sname)), cname, st->ops,
+				st->samples, st->perop ? "ops" : "runs", st->min, st->p50,
+				st->p90, st->p99, st->opss);
+		if (st->mbps > 0) {
+			printf(" %9.1f", st->mbps);
+		}
+		printf("\n");
+		break;
+	}
+	fflush(stdout);
+	_g_results++;
+}
+
+xvoid bc_report_begin() {
+	xchar osname[64];
+	xchar osver[64];
+
+	if (xi_sysinfo_os_name(osname, sizeof(osname)) < 0) {
+		xi_strcpy(osname, "unknown");
+	}
+	if (xi_sysinfo_os_ver(osver, sizeof(osver)) < 0) {
+		xi_strcpy(osver, "unknown");
+	}
+
+	switch (bc_opt.format) {
+	case BC_FMT_CSV:
+		printf("case,status,runs,ops,pct_of,samples,min_ns,p50_ns,p90_ns,p99_ns,"
+				"max_ns,mean_ns,ops_per_sec,mb_per_sec\n");
+		break;
+	case BC_FMT_JSON:
+		printf("{\n  \"system\": {\"arch\": \"%s\", \"cpus\": %ld, "
+				"\"os\": \"%s\", \"version\": \"%s\"},\n",
+				xi_sysinfo_cpu_arch(), (long) xi_sysinfo_cpu_num(), osname, osver);
+		printf("  \"options\": {\"runs\": %d, \"warmups\": %d, \"msec\": %d, "
+				"\"threads\": %d},\n", bc_opt.runs, bc_opt.warmups, bc_opt.msec,
+				bc_opt.threads);
+		printf("  \"results\": [");
+		break;
+	default:
+		printf("xibench : %s, %ld cpus, %s %s\n", xi_sysinfo_cpu_arch(),
+				(long) xi_sysinfo_cpu_num(), osname, osver);
+		printf("          runs=%d, warmups=%d, msec=%d, threads=%d\n",
+				bc_opt.runs, bc_opt.warmups, bc_opt.msec, bc_opt.threads);
+		printf("          the percentiles are of the sampled ops, "
+				"or of the means of the runs\n\n");
+		printf("%-30s %10s %12s %10s %10s %10s %10s %12s %9s\n", "case",
+				"ops/run", "pct of", "min ns", "p50 ns", "p90 ns", "p99 ns",
+				"ops/s", "MB/s");
+		break;
+	}
+	fflush(stdout);
+	_g_results = 0;
+}
+
+xvoid bc_report_end() {
+	if (bc_opt.format == BC_FMT_JSON) {
+		printf("\n  ]\n}\n");
+	}
+	fflush(stdout);
+}
+
+xvoid bc_sample(xint64 ns, xint64 ops) {
+	xuint64 slot;
+
+	if (!_g_lat_on || ops <= 0) {
+		return;
+	}
+	// keeps an even sample of all, when there are more than the reservoir
+	if (_g_lat_seen < BC_SAMPLES_MAX) {
+		slot = (xuint64) _g_lat_seen;
+	} else {
+		slot = bc_rand(&_g_lat_seed) % (xuint64) (_g_lat_seen + 1);
+	}
+	_g_lat_seen++;
+	if (slot < BC_SAMPLES_MAX) {
+		_g_lat[slot] = (xfloat64) ns / (xfloat64) ops;
+	}
+}
+
+// grows n until a run takes bc_opt.msec
+static xint64 bc_calibrate(const bc_case_t *bcase, xvoid *state) {
+	xint64 n = 1;
+	xint64 el;
+	xint64 target = (xint64) bc_opt.msec * 1000000LL;
+
+	for (;;) {
+		el = bcase->run(state, n);
+		if (el < 0) {
+			return -1;
+		}
+		if (el >= target || n >= BC_CALIB_MAX) {
+			return n;
+		}
+		if (el < target / 100) {
+			n *= 100;
+		} else {
+			// aim a little over the target, not to stop just below it
+			n = (xint64) ((xfloat64) n * (xfloat64) target * 1.2 / (xfloat64) el) + 1;
+		}
+	}
+}
+
+xint32 bc_run_case(const bc_suite_t *suite, const bc_case_t *bcase) {
+	xvoid *state = NULL;
+	xfloat64 samples[BC_RUNS_MAX];
+	bc_stat_t st;
+	xint64 n, el;
+	xint32 i, ret = 0;
+
+	if (bcase->setup != NULL && bcase->setup(&state) < 0) {
+		// the teardown releases what is made before the failure
+		if (bcase->teardown != NULL && state != NULL) {
+			bcase->teardown(state);
+		}
+		bc_report(suite->name, bcase->name, NULL);
+		return -1;
+	}
+
+	n = (bcase->ops > 0) ? bcase->ops : bc_calibrate(bcase, state);
+	for (i = 0; n > 0 && i < bc_opt.warmups; i++) {
+		if (bcase->run(state, n) < 0) {
+			n = -1;
+		}
+	}
+
+	// only the measured runs give the latencies
+	_g_lat_seen = 0;
+	_g_lat_on = TRUE;
+	for (i = 0; n > 0 && i < bc_opt.runs; i++) {
+		el = bcase->run(state, n);
+		if (el < 0) {
+			n = -1;
+			break;
+		}
+		samples[i] = (xfloat64) el / (xfloat64) n;
+	}
+	_g_lat_on = FALSE;
+
+	if (n > 0) {
+		bc_stat_make(&st, samples, bc_opt.runs, _g_lat,
+				(xint32) ((_g_lat_seen < BC_SAMPLES_MAX) ? _g_lat_seen : BC_SAMPLES_MAX),
+				n, bcase->bytes);
+		bc_report(suite->name, bcase->name, &st);
+	} else {
+		bc_report(suite->name, bcase->name, NULL);
+		ret = -1;
+	}
+
+	if (bcase->teardown != NULL) {
+		bcase->teardown(state);
+	}
+	return ret;
+}
+
+struct _st_bc_team {
+	xi_thread_mutex_t  lock;
+	xi_thread_cond_t   go;         // the workers wait for a new round
+	xi_thread_cond_t   done;       // the runner waits for the end of a round
+	bc_work_fn         fn;
+	xvoid             *arg;
+	xint32             threads;
+	xint32             started;    // gives the id to the workers
+	xint32             round;
+	xint32             finished;   // workers done in this round
+	xint32             exited;
+	xbool              quit;
+	xint64             n;
+	xint64             end;        // the time the last one is done
+};
+
+static xvoid *bc_team_worker(xvoid *arg) {
+	bc_team_t *team = arg;
+	xint32 id, seen = 0;
+	xint64 n;
+
+	xi_thread_mutex_lock(&team->lock);
+	id = team->started++;
+	for (;;) {
+		while (team->round == seen && !team->quit) {
+			xi_thread_cond_wait(&team->go, &team->lock);
+		}
+		if (team->quit) {
+			break;
+		}
+		seen = team->round;
+		n = team->n;
+		xi_thread_mutex_unlock(&team->lock);
+
+		team->fn(id, n, team->arg);
+
+		xi_thread_mutex_lock(&team->lock);
+		if (++team->finished == team->threads) {
+			team->end = xi_clock_ntick();
+			xi_thread_cond_signal(&team->done);
+		}
+	}
+	team->exited++;
+	xi_thread_cond_signal(&team->done);
+	xi_thread_mutex_unlock(&team->lock);
+
+	return NULL;
+}
+
+bc_team_t *bc_team_create(xint32 threads, bc_work_fn fn, xvoid *arg) {
+	bc_team_t *team;
+	xi_thread_t tid;
+	xint32 i;
+
+	team = xi_mem_calloc(1, sizeof(bc_team_t));
+	if (team == NULL) {
+		return NULL;
+	}
+	team->fn = fn;
+	team->arg = arg;
+	team->threads = threads;
+	if (xi_thread_mutex_create(&team->lock, "bc_team") != XI_MUTEX_RV_OK) {
+		xi_mem_free(team);
+		return NULL;
+	}
+	xi_thread_cond_create(&team->go, "bc_team_go");
+	xi_thread_cond_create(&team->done, "bc_team_done");
+
+	for (i = 0; i < threads; i++) {
+		if (xi_thread_create(&tid, "BCTEAM", bc_team_worker, team, 256 * 1024,
+				XCFG_THREAD_PRIOR_NORM) != XI_THREAD_RV_OK) {
+			// the created ones are stopped by bc_team_destroy
+			team->threads = i;
+			bc_team_destroy(team);
+			return NULL;
+		}
+	}
+
+	return team;
+}
+
+xint64 bc_team_run(bc_team_t *team, xint64 n) {
+	xint64 start;
+
+	xi_thread_mutex_lock(&team->lock);
+	team->finished = 0;
+	team->n = n;
+	team->round++;
+	start = xi_clock_ntick();
+	xi_thread_cond_broadcast(&team->go);
+	while (team->finished < team->threads) {
+		xi_thread_cond_wait(&team->done, &team->lock);
+	}
+	xi_thread_mutex_unlock(&team->lock);
+
+	return team->end - start;
+}
+
+xvoid bc_team_destroy(bc_team_t *team) {
+	if (team == NULL) {
+		return;
+	}
+
+	xi_thread_mutex_lock(&team->lock);
+	team->quit = TRUE;
+	xi_thread_cond_broadcast(&team->go);
+	while (team->exited < team->threads) {
+		xi_thread_cond_wait(&team->done, &team->lock);
+	}
+	xi_thread_mutex_unlock(&team->lock);
+
+	xi_thread_cond_destroy(&team->done);
+	xi_thread_cond_destroy(&team->go);
+	xi_thread_mutex_destroy(&team->lock);
+	xi_mem_free(team);
+}
+
+xuint64 bc_rand(xuint64 *seed) {
+	xuint64 z = (*seed += 0x9E3779B97F4A7C15ULL);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
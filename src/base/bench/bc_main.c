@@ -0,0 +1,150 @@
+/*
+ * Copyright 2013 Cheolmin Jo (webos21@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * File : bc_main.c
+ *
+ * Usage : xibench [options] [filter ...]
+ *
+ * The filters select the cases whose "suite/case" name has any of them.
+ * Every case runs on this machine only (loopback and local files).
+ */
+
+#include "bc.h"
+
+#include "xi/xi_string.h"
+#include "xi/xi_sysinfo.h"
+
+#include <stdio.h>
+
+static const bc_suite_t _g_suites[] = {
+		{ "hashtb", bc_xi_hashtb },
+		{ "thread", bc_xi_thread },
+		{ "atomic", bc_xi_atomic },
+		{ "poll",   bc_xi_poll },
+		{ "file",   bc_xi_file },
+		{ "base64", bc_xi_base64 },
+		{ "log",    bc_xi_log },
+		{ NULL,     NULL }
+};
+
+static xvoid bc_usage(const xchar *prog, const bc_opt_t *def) {
+	fprintf(stderr, "Usage : %s [options] [filter ...]\n", prog);
+	fprintf(stderr, "  -l          list the cases\n");
+	fprintf(stderr, "  -f <fmt>    output format : text, csv, json (default: text)\n");
+	fprintf(stderr, "  -r <runs>   measured runs of a case (default: %d)\n", def->runs);
+	fprintf(stderr, "  -w <runs>   warmup runs of a case (default: %d)\n", def->warmups);
+	fprintf(stderr, "  -t <msec>   minimum time of a run (default: %d)\n", def->msec);
+	fprintf(stderr, "  -j <num>    threads of the contention cases (default: %d)\n", def->threads);
+	fprintf(stderr, "  -d <dir>    directory of the temporary files (default: %s)\n", def->dir);
+}
+
+static xbool bc_selected(const xchar *sname, const xchar *cname,
+		xint32 argc, xchar **argv, xint32 first) {
+	xchar full[128];
+	xint32 i;
+
+	if (first >= argc) {
+		return TRUE;
+	}
+	xi_snprintf(full, sizeof(full), "%s/%s", sname, cname);
+	for (i = first; i < argc; i++) {
+		if (xi_strstr(full, argv[i]) != NULL) {
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+int main(int argc, char **argv) {
+	xint32 i, s, c;
+	xint32 failed = 0;
+	xbool list = FALSE;
+	xlong cpus;
+	bc_opt_t def;
+
+	cpus = xi_sysinfo_cpu_num();
+	bc_opt.threads = (cpus < 2) ? 2 : ((cpus > 4) ? 4 : (xint32) cpus);
+	def = bc_opt;
+
+	for (i = 1; i < argc && argv[i][0] == '-'; i++) {
+		if (xi_strcmp(argv[i], "-l") == 0) {
+			list = TRUE;
+			continue;
+		}
+		if (i + 1 >= argc) {
+			bc_usage(argv[0], &def);
+			return 1;
+		}
+		if (xi_strcmp(argv[i], "-f") == 0) {
+			i++;
+			if (xi_strcmp(argv[i], "text") == 0) {
+				bc_opt.format = BC_FMT_TEXT;
+			} else if (xi_strcmp(argv[i], "csv") == 0) {
+				bc_opt.format = BC_FMT_CSV;
+			} else if (xi_strcmp(argv[i], "json") == 0) {
+				bc_opt.format = BC_FMT_JSON;
+			} else {
+				bc_usage(argv[0], &def);
+				return 1;
+			}
+		} else if (xi_strcmp(argv[i], "-r") == 0) {
+			bc_opt.runs = xi_strtoi(argv[++i], NULL, 10);
+		} else if (xi_strcmp(argv[i], "-w") == 0) {
+			bc_opt.warmups = xi_strtoi(argv[++i], NULL, 10);
+		} else if (xi_strcmp(argv[i], "-t") == 0) {
+			bc_opt.msec = xi_strtoi(argv[++i], NULL, 10);
+		} else if (xi_strcmp(argv[i], "-j") == 0) {
+			bc_opt.threads = xi_strtoi(argv[++i], NULL, 10);
+		} else if (xi_strcmp(argv[i], "-d") == 0) {
+			bc_opt.dir = argv[++i];
+		} else {
+			bc_usage(argv[0], &def);
+			return 1;
+		}
+	}
+	if (bc_opt.runs < 1 || bc_opt.runs > BC_RUNS_MAX || bc_opt.warmups < 0
+			|| bc_opt.msec < 1 || bc_opt.threads < 1) {
+		bc_usage(argv[0], &def);
+		return 1;
+	}
+
+	if (list) {
+		for (s = 0; _g_suites[s].name != NULL; s++) {
+			for (c = 0; _g_suites[s].cases[c].name != NULL; c++) {
+				if (bc_selected(_g_suites[s].name, _g_suites[s].cases[c].name,
+						argc, argv, i)) {
+					printf("%s/%s\n", _g_suites[s].name, _g_suites[s].cases[c].name);
+				}
+			}
+		}
+		return 0;
+	}
+
+	bc_report_begin();
+	for (s = 0; _g_suites[s].name != NULL; s++) {
+		for (c = 0; _g_suites[s].cases[c].name != NULL; c++) {
+			if (bc_selected(_g_suites[s].name, _g_suites[s].cases[c].name,
+					argc, argv, i)
+					&& bc_run_case(&_g_suites[s], &_g_suites[s].cases[c]) < 0) {
+				failed++;
+			}
+		}
+	}
+	bc_report_end();
+
+	return (failed > 0) ? 1 : 0;
+}
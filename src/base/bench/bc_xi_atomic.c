@@ -0,0 +1,136 @@
+/*
+ * Copyright 2013 Cheolmin Jo (webos21@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * File : bc_xi_atomic.c
+ */
+
+#include "bc.h"
+
+#include "xi/xi_atomic.h"
+#include "xi/xi_clock.h"
+#include "xi/xi_mem.h"
+
+#define BC_ATOMIC_LINE    64
+#define BC_ATOMIC_SLOTS   64
+
+typedef struct _st_bc_atomic {
+	volatile xuint32   u32;
+	volatile xuint64   u64;
+	bc_team_t         *team;
+	// one cache line for every thread (inc64_private_mt)
+	volatile xuint64   slot[BC_ATOMIC_SLOTS][BC_ATOMIC_LINE / sizeof(xuint64)];
+} bc_atomic_t;
+
+static xint32 bc_atomic_setup(xvoid **state) {
+	bc_atomic_t *ba;
+
+	ba = xi_mem_calloc(1, sizeof(bc_atomic_t));
+	if (ba == NULL) {
+		return -1;
+	}
+	*state = ba;
+	return 0;
+}
+
+static xvoid bc_atomic_teardown(xvoid *state) {
+	bc_atomic_t *ba = state;
+
+	bc_team_destroy(ba->team);
+	xi_mem_free(ba);
+}
+
+static xint64 bc_atomic_inc32(xvoid *state, xint64 n) {
+	bc_atomic_t *ba = state;
+	xint64 i, start;
+
+	start = xi_clock_ntick();
+	for (i = 0; i < n; i++) {
+		xi_atomic_inc32(&ba->u32);
+	}
+	return xi_clock_ntick() - start;
+}
+
+static xint64 bc_atomic_cas32(xvoid *state, xint64 n) {
+	bc_atomic_t *ba = state;
+	xint64 i, start;
+	xuint32 old;
+
+	start = xi_clock_ntick();
+	for (i = 0; i < n; i++) {
+		old = xi_atomic_read32(&ba->u32);
+		xi_atomic_cas32(&ba->u32, old + 1, old);
+	}
+	return xi_clock_ntick() - start;
+}
+
+static xvoid bc_atomic_shared_work(xint32 id, xint64 n, xvoid *arg) {
+	bc_atomic_t *ba = arg;
+	xint64 i;
+
+	UNUSED(id);
+
+	for (i = 0; i < n; i++) {
+		xi_atomic_add64(&ba->u64, 1);
+	}
+}
+
+static xvoid bc_atomic_private_work(xint32 id, xint64 n, xvoid *arg) {
+	bc_atomic_t *ba = arg;
+	volatile xuint64 *mine = ba->slot[id % BC_ATOMIC_SLOTS];
+	xint64 i;
+
+	for (i = 0; i < n; i++) {
+		xi_atomic_add64(mine, 1);
+	}
+}
+
+static xint32 bc_atomic_setup_shared(xvoid **state) {
+	bc_atomic_t *ba;
+
+	if (bc_atomic_setup(state) < 0) {
+		return -1;
+	}
+	ba = *state;
+	ba->team = bc_team_create(bc_opt.threads, bc_atomic_shared_work, ba);
+	return (ba->team == NULL) ? -1 : 0;
+}
+
+static xint32 bc_atomic_setup_private(xvoid **state) {
+	bc_atomic_t *ba;
+
+	if (bc_atomic_setup(state) < 0) {
+		return -1;
+	}
+	ba = *state;
+	ba->team = bc_team_create(bc_opt.threads, bc_atomic_private_work, ba);
+	return (ba->team == NULL) ? -1 : 0;
+}
+
+static xint64 bc_atomic_mt(xvoid *state, xint64 n) {
+	bc_atomic_t *ba = state;
+	xint64 per = n / bc_opt.threads;
+
+	return bc_team_run(ba->team, (per > 0) ? per : 1);
+}
+
+const bc_case_t bc_xi_atomic[] = {
+		{ "inc32_single", bc_atomic_inc32, bc_atomic_setup, bc_atomic_teardown, 0, 0 },
+		{ "cas32_single", bc_atomic_cas32, bc_atomic_setup, bc_atomic_teardown, 0, 0 },
+		{ "add64_shared_mt", bc_atomic_mt, bc_atomic_setup_shared, bc_atomic_teardown, 0, 0 },
+		{ "add64_private_mt", bc_atomic_mt, bc_atomic_setup_private, bc_atomic_teardown, 0, 0 },
+		{ NULL, NULL, NULL, NULL, 0, 0 }
+};
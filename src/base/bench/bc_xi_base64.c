@@ -0,0 +1,99 @@
+/*
+ * Copyright 2013 Cheolmin Jo (webos21@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * File : bc_xi_base64.c
+ */
+
+#include "bc.h"
+
+#include "xi/xi_base64.h"
+#include "xi/xi_clock.h"
+#include "xi/xi_mem.h"
+
+#define BC_B64_SMALL   64
+#define BC_B64_LARGE   (16 * 1024)
+
+typedef struct _st_bc_b64 {
+	xchar   plain[BC_B64_LARGE + 1];
+	xchar   coded[(BC_B64_LARGE + 2) / 3 * 4 + 1];
+	xchar   small[(BC_B64_SMALL + 2) / 3 * 4 + 1];
+} bc_b64_t;
+
+static xint32 bc_b64_setup(xvoid **state) {
+	bc_b64_t *bb;
+	xuint64 seed = 0x5EED;
+	xint32 i;
+
+	bb = xi_mem_calloc(1, sizeof(bc_b64_t));
+	if (bb == NULL) {
+		return -1;
+	}
+	*state = bb;
+	for (i = 0; i < BC_B64_LARGE; i++) {
+		bb->plain[i] = (xchar) bc_rand(&seed);
+	}
+	xi_base64_encode(bb->coded, bb->plain, BC_B64_LARGE);
+	xi_base64_encode(bb->small, bb->plain, BC_B64_SMALL);
+	return 0;
+}
+
+static xvoid bc_b64_teardown(xvoid *state) {
+	xi_mem_free(state);
+}
+
+static xint64 bc_b64_encode_small(xvoid *state, xint64 n) {
+	bc_b64_t *bb = state;
+	xint64 i, start;
+
+	start = xi_clock_ntick();
+	for (i = 0; i < n; i++) {
+		xi_base64_encode(bb->small, bb->plain, BC_B64_SMALL);
+	}
+	return xi_clock_ntick() - start;
+}
+
+static xint64 bc_b64_encode_large(xvoid *state, xint64 n) {
+	bc_b64_t *bb = state;
+	xint64 i, start;
+
+	start = xi_clock_ntick();
+	for (i = 0; i < n; i++) {
+		xi_base64_encode(bb->coded, bb->plain, BC_B64_LARGE);
+	}
+	return xi_clock_ntick() - start;
+}
+
+static xint64 bc_b64_decode_large(xvoid *state, xint64 n) {
+	bc_b64_t *bb = state;
+	xint64 i, start;
+
+	start = xi_clock_ntick();
+	for (i = 0; i < n; i++) {
+		if (xi_base64_decode_binary((xuint8 *) bb->plain, bb->coded)
+				!= BC_B64_LARGE) {
+			return -1;
+		}
+	}
+	return xi_clock_ntick() - start;
+}
+
+const bc_case_t bc_xi_base64[] = {
+		{ "encode_64", bc_b64_encode_small, bc_b64_setup, bc_b64_teardown, 0, BC_B64_SMALL },
+		{ "encode_16k", bc_b64_encode_large, bc_b64_setup, bc_b64_teardown, 0, BC_B64_LARGE },
+		{ "decode_16k", bc_b64_decode_large, bc_b64_setup, bc_b64_teardown, 0, BC_B64_LARGE },
+		{ NULL, NULL, NULL, NULL, 0, 0 }
+};
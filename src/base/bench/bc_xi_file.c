@@ -0,0 +1,174 @@
+/*
+ * Copyright 2013 Cheolmin Jo (webos21@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * File : bc_xi_file.c
+ *
+ * The file is small enough to stay in the page cache, so that these
+ * measure the cost of the calls and the copies rather than the disk.
+ */
+
+#include "bc.h"
+
+#include "xi/xi_clock.h"
+#include "xi/xi_file.h"
+#include "xi/xi_mem.h"
+#include "xi/xi_mmap.h"
+#include "xi/xi_string.h"
+
+#define BC_FILE_NAME     "xibench_file.dat"
+#define BC_FILE_SIZE     (16 * 1024 * 1024)
+#define BC_FILE_BLOCK    (64 * 1024)
+#define BC_FILE_PAGE     4096
+
+typedef struct _st_bc_file {
+	xchar              path[XCFG_PATHNAME_MAX];
+	xint32             fd;
+	xvoid             *map;
+	xuint64            seed;
+	volatile xuint64   sink;
+	xchar              buf[BC_FILE_BLOCK];
+} bc_file_t;
+
+static xvoid bc_file_teardown(xvoid *state) {
+	bc_file_t *bf = state;
+
+	if (bf->map != NULL) {
+		xi_mmap_unmap(bf->map, BC_FILE_SIZE);
+	}
+	if (bf->fd >= 0) {
+		xi_file_close(bf->fd);
+		xi_file_remove(bf->path);
+	}
+	xi_mem_free(bf);
+}
+
+static xint32 bc_file_setup(xvoid **state) {
+	bc_file_t *bf;
+	xint32 i;
+
+	bf = xi_mem_calloc(1, sizeof(bc_file_t));
+	if (bf == NULL) {
+		return -1;
+	}
+	*state = bf;
+	bf->seed = 0x5EED;
+	for (i = 0; i < BC_FILE_BLOCK; i++) {
+		bf->buf[i] = (xchar) bc_rand(&bf->seed);
+	}
+
+	xi_snprintf(bf->path, sizeof(bf->path), "%s/%s", bc_opt.dir, BC_FILE_NAME);
+	bf->fd = xi_file_open(bf->path, XI_FILE_MODE_READ | XI_FILE_MODE_WRITE
+			| XI_FILE_MODE_CREATE | XI_FILE_MODE_TRUNCATE, 0644);
+	if (bf->fd < 0) {
+		return -1;
+	}
+	for (i = 0; i < BC_FILE_SIZE / BC_FILE_BLOCK; i++) {
+		if (xi_file_write(bf->fd, bf->buf, BC_FILE_BLOCK) != BC_FILE_BLOCK) {
+			return -1;
+		}
+	}
+	return 0;
+}
+
+static xint32 bc_file_setup_map(xvoid **state) {
+	bc_file_t *bf;
+
+	if (bc_file_setup(state) < 0) {
+		return -1;
+	}
+	bf = *state;
+	if (xi_mmap_map(&bf->map, BC_FILE_SIZE, XI_MMAP_PROT_READ,
+			XI_MMAP_TYPE_SHARED, bf->fd, 0) != XI_MMAP_RV_OK) {
+		bf->map = NULL;
+		return -1;
+	}
+	return 0;
+}
+
+static xint64 bc_file_write(xvoid *state, xint64 n) {
+	bc_file_t *bf = state;
+	xint64 i, start;
+	xoff64 off;
+
+	start = xi_clock_ntick();
+	for (i = 0; i < n; i++) {
+		off = (xoff64) ((i % (BC_FILE_SIZE / BC_FILE_BLOCK)) * BC_FILE_BLOCK);
+		if (xi_file_pwrite(bf->fd, bf->buf, BC_FILE_BLOCK, off) != BC_FILE_BLOCK) {
+			return -1;
+		}
+	}
+	return xi_clock_ntick() - start;
+}
+
+static xint64 bc_file_read(xvoid *state, xint64 n) {
+	bc_file_t *bf = state;
+	xint64 i, start;
+	xoff64 off;
+
+	start = xi_clock_ntick();
+	for (i = 0; i < n; i++) {
+		off = (xoff64) ((i % (BC_FILE_SIZE / BC_FILE_BLOCK)) * BC_FILE_BLOCK);
+		if (xi_file_pread(bf->fd, bf->buf, BC_FILE_BLOCK, off) != BC_FILE_BLOCK) {
+			return -1;
+		}
+	}
+	return xi_clock_ntick() - start;
+}
+
+static xint64 bc_file_read_rand(xvoid *state, xint64 n) {
+	bc_file_t *bf = state;
+	xint64 i, start;
+	xoff64 off;
+
+	start = xi_clock_ntick();
+	for (i = 0; i < n; i++) {
+		off = (xoff64) ((bc_rand(&bf->seed) % (BC_FILE_SIZE / BC_FILE_PAGE))
+				* BC_FILE_PAGE);
+		if (xi_file_pread(bf->fd, bf->buf, BC_FILE_PAGE, off) != BC_FILE_PAGE) {
+			return -1;
+		}
+	}
+	return xi_clock_ntick() - start;
+}
+
+// reads every word of the block through the mapping
+static xint64 bc_file_mmap_read(xvoid *state, xint64 n) {
+	bc_file_t *bf = state;
+	const xuint64 *blk;
+	xint64 i, start;
+	xint32 w;
+	xuint64 sum = 0;
+
+	start = xi_clock_ntick();
+	for (i = 0; i < n; i++) {
+		blk = (const xuint64 *) ((xchar *) bf->map
+				+ (i % (BC_FILE_SIZE / BC_FILE_BLOCK)) * BC_FILE_BLOCK);
+		for (w = 0; w < (xint32) (BC_FILE_BLOCK / sizeof(xuint64)); w++) {
+			sum += blk[w];
+		}
+	}
+	bf->sink = sum;
+	return xi_clock_ntick() - start;
+}
+
+const bc_case_t bc_xi_file[] = {
+		{ "pwrite_64k", bc_file_write, bc_file_setup, bc_file_teardown, 0, BC_FILE_BLOCK },
+		{ "pread_64k", bc_file_read, bc_file_setup, bc_file_teardown, 0, BC_FILE_BLOCK },
+		{ "pread_4k_rand", bc_file_read_rand, bc_file_setup, bc_file_teardown, 0, BC_FILE_PAGE },
+		{ "mmap_read_64k", bc_file_mmap_read, bc_file_setup_map, bc_file_teardown, 0, BC_FILE_BLOCK },
+		{ NULL, NULL, NULL, NULL, 0, 0 }
+};
@@ -0,0 +1,205 @@
+/*
+ * Copyright 2013 Cheolmin Jo (webos21@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * File : bc_xi_hashtb.c
+ */
+
+#include "bc.h"
+
+#include "xi/xi_clock.h"
+#include "xi/xi_hashtb.h"
+#include "xi/xi_mem.h"
+
+#define BC_HTB_KEYS   100000
+#define BC_HTB_BATCH  64       // sets of a latency sample
+
+typedef struct _st_bc_htb {
+	xuint64            keys[BC_HTB_KEYS];    // in the table
+	xuint64            miss[BC_HTB_KEYS];    // not in the table
+	xi_hashtb_t       *htb;
+	xi_hashtb_conc_t  *conc;
+	bc_team_t         *team;
+	volatile xuint32   sink;
+} bc_htb_t;
+
+static xint32 bc_htb_setup(xvoid **state) {
+	bc_htb_t *bh;
+	xuint64 seed = 0x5EED;
+	xint32 i;
+
+	bh = xi_mem_calloc(1, sizeof(bc_htb_t));
+	if (bh == NULL) {
+		return -1;
+	}
+	for (i = 0; i < BC_HTB_KEYS; i++) {
+		bh->keys[i] = bc_rand(&seed);
+		bh->miss[i] = bc_rand(&seed);
+	}
+	*state = bh;
+	return 0;
+}
+
+static xint32 bc_htb_setup_full(xvoid **state) {
+	bc_htb_t *bh;
+	xint32 i;
+
+	if (bc_htb_setup(state) < 0) {
+		return -1;
+	}
+	bh = *state;
+	bh->htb = xi_hashtb_create();
+	if (bh->htb == NULL) {
+		return -1;
+	}
+	for (i = 0; i < BC_HTB_KEYS; i++) {
+		xi_hashtb_set(bh->htb, &bh->keys[i], sizeof(xuint64), &bh->keys[i]);
+	}
+	return 0;
+}
+
+static xvoid bc_htb_teardown(xvoid *state) {
+	bc_htb_t *bh = state;
+
+	if (bh == NULL) {
+		return;
+	}
+	bc_team_destroy(bh->team);
+	if (bh->htb != NULL) {
+		xi_hashtb_destroy(bh->htb);
+	}
+	if (bh->conc != NULL) {
+		xi_hashtb_conc_destroy(bh->conc);
+	}
+	xi_mem_free(bh);
+}
+
+// a run fills a new table, and the batches with a resize are in the tail
+static xint64 bc_htb_insert(xvoid *state, xint64 n) {
+	bc_htb_t *bh = state;
+	xi_hashtb_t *htb;
+	xint64 i, start, bstart, now, el;
+
+	htb = xi_hashtb_create();
+	if (htb == NULL) {
+		return -1;
+	}
+	start = xi_clock_ntick();
+	bstart = start;
+	for (i = 0; i < n; i++) {
+		xi_hashtb_set(htb, &bh->keys[i], sizeof(xuint64), &bh->keys[i]);
+		if ((i % BC_HTB_BATCH) == BC_HTB_BATCH - 1) {
+			now = xi_clock_ntick();
+			bc_sample(now - bstart, BC_HTB_BATCH);
+			bstart = now;
+		}
+	}
+	el = xi_clock_ntick() - start;
+	xi_hashtb_destroy(htb);
+
+	return el;
+}
+
+static xint64 bc_htb_hit(xvoid *state, xint64 n) {
+	bc_htb_t *bh = state;
+	xint64 i, start;
+	xint32 k = 0;
+	xuint32 found = 0;
+
+	start = xi_clock_ntick();
+	for (i = 0; i < n; i++) {
+		found += (xi_hashtb_get(bh->htb, &bh->keys[k], sizeof(xuint64)) != NULL);
+		if (++k == BC_HTB_KEYS) {
+			k = 0;
+		}
+	}
+	bh->sink = found;
+	return xi_clock_ntick() - start;
+}
+
+static xint64 bc_htb_miss(xvoid *state, xint64 n) {
+	bc_htb_t *bh = state;
+	xint64 i, start;
+	xint32 k = 0;
+	xuint32 found = 0;
+
+	start = xi_clock_ntick();
+	for (i = 0; i < n; i++) {
+		found += (xi_hashtb_get(bh->htb, &bh->miss[k], sizeof(xuint64)) != NULL);
+		if (++k == BC_HTB_KEYS) {
+			k = 0;
+		}
+	}
+	bh->sink = found;
+	return xi_clock_ntick() - start;
+}
+
+// 1 set of the 8 ops on the concurrent table, the others are the lookups
+static xvoid bc_htb_conc_work(xint32 id, xint64 n, xvoid *arg) {
+	bc_htb_t *bh = arg;
+	xint64 i;
+	xint32 k = (id * 7919) % BC_HTB_KEYS;
+	xuint32 found = 0;
+
+	for (i = 0; i < n; i++) {
+		if ((i & 7) == 7) {
+			xi_hashtb_conc_set(bh->conc, &bh->keys[k], sizeof(xuint64),
+					&bh->keys[k]);
+		} else {
+			found += (xi_hashtb_conc_get(bh->conc, &bh->keys[k],
+					sizeof(xuint64)) != NULL);
+		}
+		if (++k == BC_HTB_KEYS) {
+			k = 0;
+		}
+	}
+	bh->sink = found;
+}
+
+static xint32 bc_htb_conc_setup(xvoid **state) {
+	bc_htb_t *bh;
+	xint32 i;
+
+	if (bc_htb_setup(state) < 0) {
+		return -1;
+	}
+	bh = *state;
+	bh->conc = xi_hashtb_conc_create(NULL);
+	if (bh->conc == NULL) {
+		return -1;
+	}
+	for (i = 0; i < BC_HTB_KEYS; i++) {
+		xi_hashtb_conc_set(bh->conc, &bh->keys[i], sizeof(xuint64), &bh->keys[i]);
+	}
+	bh->team = bc_team_create(bc_opt.threads, bc_htb_conc_work, bh);
+	return (bh->team == NULL) ? -1 : 0;
+}
+
+// n is the ops of all the threads
+static xint64 bc_htb_conc_mixed(xvoid *state, xint64 n) {
+	bc_htb_t *bh = state;
+	xint64 per = n / bc_opt.threads;
+
+	return bc_team_run(bh->team, (per > 0) ? per : 1);
+}
+
+const bc_case_t bc_xi_hashtb[] = {
+		{ "insert_100k", bc_htb_insert, bc_htb_setup, bc_htb_teardown, BC_HTB_KEYS, 0 },
+		{ "lookup_hit", bc_htb_hit, bc_htb_setup_full, bc_htb_teardown, 0, 0 },
+		{ "lookup_miss", bc_htb_miss, bc_htb_setup_full, bc_htb_teardown, 0, 0 },
+		{ "conc_mixed_mt", bc_htb_conc_mixed, bc_htb_conc_setup, bc_htb_teardown, 0, 0 },
+		{ NULL, NULL, NULL, NULL, 0, 0 }
+};
@@ -0,0 +1,150 @@
+/*
+ * Copyright 2013 Cheolmin Jo (webos21@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * File : bc_xi_log.c
+ *
+ * The text logs go to a function which drops them, so that these measure
+ * the logger itself rather than the terminal.
+ */
+
+#include "bc.h"
+
+#include "xi/xi_clock.h"
+#include "xi/xi_file.h"
+#include "xi/xi_log.h"
+#include "xi/xi_mem.h"
+#include "xi/xi_string.h"
+
+#define BC_LOG_NAME   "xibench_log.bin"
+#define BC_LOG_SLOTS  4096
+
+typedef struct _st_bc_log {
+	xi_logger_t  *logger;
+	xchar         path[XCFG_PATHNAME_MAX];
+	xbool         async;
+	xbool         bin;
+} bc_log_t;
+
+static volatile xuint32 _g_log_lines = 0;
+
+static xvoid bc_log_sink(xchar *msg) {
+	UNUSED(msg);
+	_g_log_lines++;
+}
+
+static xint32 bc_log_setup(xvoid **state) {
+	bc_log_t *bl;
+	xi_logopt_t opt;
+
+	bl = xi_mem_calloc(1, sizeof(bc_log_t));
+	if (bl == NULL) {
+		return -1;
+	}
+	*state = bl;
+	bl->logger = xi_logger_fetch("XIBENCH");
+	if (bl->logger == NULL) {
+		return -1;
+	}
+	opt.level = XI_LOG_LEVEL_INFO;
+	opt.showDate = TRUE;
+	opt.showFile = TRUE;
+	opt.showFunc = TRUE;
+	opt.showLine = TRUE;
+	xi_logger_set_conf(bl->logger, opt);
+	xi_logger_set_handle(bc_log_sink);
+	return 0;
+}
+
+static xint32 bc_log_setup_async(xvoid **state) {
+	bc_log_t *bl;
+
+	if (bc_log_setup(state) < 0) {
+		return -1;
+	}
+	bl = *state;
+	if (xi_logger_async_start(BC_LOG_SLOTS, XI_LOG_OVERFLOW_BLOCK)
+			!= XI_LOG_RV_OK) {
+		return -1;
+	}
+	bl->async = TRUE;
+	return 0;
+}
+
+static xint32 bc_log_setup_bin(xvoid **state) {
+	bc_log_t *bl;
+
+	if (bc_log_setup(state) < 0) {
+		return -1;
+	}
+	bl = *state;
+	xi_snprintf(bl->path, sizeof(bl->path), "%s/%s", bc_opt.dir, BC_LOG_NAME);
+	if (xi_logger_bin_start(bl->path) != XI_LOG_RV_OK) {
+		return -1;
+	}
+	bl->bin = TRUE;
+	return 0;
+}
+
+static xvoid bc_log_teardown(xvoid *state) {
+	bc_log_t *bl = state;
+
+	if (bl->bin) {
+		xi_logger_bin_stop();
+		xi_file_remove(bl->path);
+	}
+	if (bl->async) {
+		xi_logger_async_stop();
+	}
+	xi_logger_set_handle(NULL);
+	xi_mem_free(bl);
+}
+
+static xint64 bc_log_write(xvoid *state, xint64 n) {
+	bc_log_t *bl = state;
+	xint64 i, start;
+
+	start = xi_clock_ntick();
+	for (i = 0; i < n; i++) {
+		xi_logger_write(bl->logger, XI_LOG_LEVEL_INFO, __FILE__, __FUNCTION__,
+				__LINE__, "bench line %lld of %s (%d)\n", i, "xibench", 42);
+	}
+	if (bl->async) {
+		// the run is over when the writer has taken all of them
+		xi_logger_async_flush();
+	}
+	return xi_clock_ntick() - start;
+}
+
+static xint64 bc_log_filtered(xvoid *state, xint64 n) {
+	bc_log_t *bl = state;
+	xint64 i, start;
+
+	start = xi_clock_ntick();
+	for (i = 0; i < n; i++) {
+		xi_logger_write(bl->logger, XI_LOG_LEVEL_DEBUG, __FILE__, __FUNCTION__,
+				__LINE__, "bench line %lld of %s (%d)\n", i, "xibench", 42);
+	}
+	return xi_clock_ntick() - start;
+}
+
+const bc_case_t bc_xi_log[] = {
+		{ "write_sync", bc_log_write, bc_log_setup, bc_log_teardown, 0, 0 },
+		{ "write_filtered", bc_log_filtered, bc_log_setup, bc_log_teardown, 0, 0 },
+		{ "write_async", bc_log_write, bc_log_setup_async, bc_log_teardown, 0, 0 },
+		{ "write_bin", bc_log_write, bc_log_setup_bin, bc_log_teardown, 0, 0 },
+		{ NULL, NULL, NULL, NULL, 0, 0 }
+};
@@ -0,0 +1,231 @@
+/*
+ * Copyright 2013 Cheolmin Jo (webos21@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * File : bc_xi_poll.c
+ *
+ * The echo server of a pollset runs in a thread, and the clients of
+ * the benchmark thread talk to it over the loopback.
+ */
+
+#include "bc.h"
+
+#include "xi/xi_atomic.h"
+#include "xi/xi_clock.h"
+#include "xi/xi_mem.h"
+#include "xi/xi_poll.h"
+#include "xi/xi_socket.h"
+#include "xi/xi_string.h"
+#include "xi/xi_thread.h"
+
+#define BC_POLL_CONNS_MAX  8
+#define BC_POLL_BUFSIZE    (64 * 1024)
+
+typedef struct _st_bc_echo {
+	xi_pollset_t      *pset;
+	xint32             lsn;
+	xint32             conns;
+	xint32             clt[BC_POLL_CONNS_MAX];
+	xint32             svr[BC_POLL_CONNS_MAX];
+	xsize              msglen;
+	xbool              started;
+	volatile xuint32   quit;
+	volatile xuint32   exited;
+	xchar              sbuf[BC_POLL_BUFSIZE];  // of the server
+	xchar              cbuf[BC_POLL_BUFSIZE];  // of the clients
+} bc_echo_t;
+
+static xvoid *bc_echo_server(xvoid *arg) {
+	bc_echo_t *be = arg;
+	xi_pollfd_t rfds[BC_POLL_CONNS_MAX];
+	xint32 i, cnt;
+	xssize rlen, slen, sent;
+
+	while (!xi_atomic_read32(&be->quit)) {
+		cnt = xi_pollset_poll(be->pset, rfds, BC_POLL_CONNS_MAX, 50);
+		for (i = 0; i < cnt; i++) {
+			if (!(rfds[i].evts & (XI_POLL_EVENT_IN | XI_POLL_EVENT_HUP))) {
+				continue;
+			}
+			rlen = xi_socket_recv(rfds[i].desc, be->sbuf, sizeof(be->sbuf));
+			if (rlen <= 0) {
+				// the client is closed by the teardown
+				xi_pollset_remove(be->pset, rfds[i]);
+				continue;
+			}
+			for (sent = 0; sent < rlen; sent += slen) {
+				slen = xi_socket_send(rfds[i].desc, be->sbuf + sent,
+						(xsize) (rlen - sent));
+				if (slen <= 0) {
+					break;
+				}
+			}
+		}
+	}
+
+	xi_atomic_set32(&be->exited, 1);
+	return NULL;
+}
+
+static xint32 bc_echo_open(xvoid **state, xint32 opt, xint32 conns, xsize msglen) {
+	bc_echo_t *be;
+	xi_sock_addr_t addr = { XI_SOCK_FAMILY_INET, XI_SOCK_TYPE_STREAM,
+			XI_SOCK_PROTO_IP, { '\0' }, 0 };
+	xi_sock_addr_bin_t baddr;
+	xi_pollfd_t pfd;
+	xi_thread_t tid;
+	xint32 i;
+
+	be = xi_mem_calloc(1, sizeof(bc_echo_t));
+	if (be == NULL) {
+		return -1;
+	}
+	*state = be;
+	be->lsn = -1;
+	be->conns = 0;
+	be->msglen = msglen;
+	xi_mem_set(be->cbuf, 'x', sizeof(be->cbuf));
+
+	be->pset = xi_pollset_create(BC_POLL_CONNS_MAX, opt);
+	if (be->pset == NULL) {
+		return -1;
+	}
+
+	// the port 0 of the loopback is picked by the system
+	xi_strcpy(addr.host, "127.0.0.1");
+	xi_socket_addr_pton(&addr, &baddr);
+	be->lsn = xi_socket_open(XI_SOCK_FAMILY_INET, XI_SOCK_TYPE_STREAM,
+			XI_SOCK_PROTO_IP);
+	if (be->lsn < 0 || xi_socket_bind_bin(be->lsn, &baddr) != XI_SOCK_RV_OK
+			|| xi_socket_listen(be->lsn, conns) != XI_SOCK_RV_OK
+			|| xi_socket_get_local_bin(be->lsn, &baddr) != XI_SOCK_RV_OK) {
+		return -1;
+	}
+
+	for (i = 0; i < conns; i++) {
+		be->clt[i] = xi_socket_open(XI_SOCK_FAMILY_INET, XI_SOCK_TYPE_STREAM,
+				XI_SOCK_PROTO_IP);
+		if (be->clt[i] < 0) {
+			return -1;
+		}
+		be->svr[i] = -1;
+		be->conns++;
+		if (xi_socket_connect_bin(be->clt[i], &baddr) != XI_SOCK_RV_OK) {
+			return -1;
+		}
+		be->svr[i] = xi_socket_accept_bin(be->lsn, NULL);
+		if (be->svr[i] < 0) {
+			return -1;
+		}
+		pfd.desc = be->svr[i];
+		pfd.evts = XI_POLL_EVENT_IN;
+		pfd.context = NULL;
+		if (xi_pollset_add(be->pset, pfd) != XI_POLLSET_RV_OK) {
+			return -1;
+		}
+	}
+
+	if (xi_thread_create(&tid, "BCECHO", bc_echo_server, be, 256 * 1024,
+			XCFG_THREAD_PRIOR_NORM) != XI_THREAD_RV_OK) {
+		return -1;
+	}
+	be->started = TRUE;
+
+	return 0;
+}
+
+static xvoid bc_echo_close(xvoid *state) {
+	bc_echo_t *be = state;
+	xint32 i;
+
+	xi_atomic_set32(&be->quit, 1);
+	for (i = 0; i < be->conns; i++) {
+		xi_socket_close(be->clt[i]);
+	}
+	while (be->started && !xi_atomic_read32(&be->exited)) {
+		xi_thread_sleep(1);
+	}
+	if (be->pset != NULL) {
+		xi_pollset_destroy(be->pset);
+	}
+	for (i = 0; i < be->conns; i++) {
+		if (be->svr[i] >= 0) {
+			xi_socket_close(be->svr[i]);
+		}
+	}
+	if (be->lsn >= 0) {
+		xi_socket_close(be->lsn);
+	}
+	xi_mem_free(be);
+}
+
+static xint32 bc_echo_recv(xint32 sfd, xchar *buf, xsize len) {
+	xsize got;
+	xssize ret;
+
+	for (got = 0; got < len; got += (xsize) ret) {
+		ret = xi_socket_recv(sfd, buf + got, len - got);
+		if (ret <= 0) {
+			return -1;
+		}
+	}
+	return 0;
+}
+
+static xint32 bc_echo_setup_poll(xvoid **state) {
+	return bc_echo_open(state, 0, 1, 64);
+}
+
+static xint32 bc_echo_setup_epoll(xvoid **state) {
+	return bc_echo_open(state, XI_POLLSET_OPT_EPOLL, 1, 64);
+}
+
+static xint32 bc_echo_setup_stream(xvoid **state) {
+	return bc_echo_open(state, XI_POLLSET_OPT_EPOLL, BC_POLL_CONNS_MAX, 4096);
+}
+
+// every connection sends a message, and then waits for all the echoes.
+// a round is a latency sample.
+static xint64 bc_echo_run(xvoid *state, xint64 n) {
+	bc_echo_t *be = state;
+	xint64 i, start, rstart;
+	xint32 c;
+
+	start = xi_clock_ntick();
+	for (i = 0; i < n; i += be->conns) {
+		rstart = xi_clock_ntick();
+		for (c = 0; c < be->conns; c++) {
+			if (xi_socket_send(be->clt[c], be->cbuf, be->msglen)
+					!= (xssize) be->msglen) {
+				return -1;
+			}
+		}
+		for (c = 0; c < be->conns; c++) {
+			if (bc_echo_recv(be->clt[c], be->cbuf, be->msglen) < 0) {
+				return -1;
+			}
+		}
+		bc_sample(xi_clock_ntick() - rstart, be->conns);
+	}
+	return xi_clock_ntick() - start;
+}
+
+const bc_case_t bc_xi_poll[] = {
+		{ "echo_rtt_poll", bc_echo_run, bc_echo_setup_poll, bc_echo_close, 0, 64 },
+		{ "echo_rtt_epoll", bc_echo_run, bc_echo_setup_epoll, bc_echo_close, 0, 64 },
+		{ "echo_stream_x8", bc_echo_run, bc_echo_setup_stream, bc_echo_close, 0, 4096 },
+		{ NULL, NULL, NULL, NULL, 0, 0 }
+};
@@ -0,0 +1,194 @@
+/*
+ * Copyright 2013 Cheolmin Jo (webos21@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * File : bc_xi_thread.c
+ */
+
+#include "bc.h"
+
+#include "xi/xi_clock.h"
+#include "xi/xi_mem.h"
+#include "xi/xi_thread.h"
+
+typedef struct _st_bc_sync {
+	xi_thread_mutex_t  lock;
+	xi_thread_cond_t   cond;
+	bc_team_t         *team;
+	xint32             turn;     // the id of the thread to go (cond_pingpong)
+	xint64             count;
+} bc_sync_t;
+
+static xint32 bc_sync_setup(xvoid **state) {
+	bc_sync_t *bs;
+
+	bs = xi_mem_calloc(1, sizeof(bc_sync_t));
+	if (bs == NULL) {
+		return -1;
+	}
+	*state = bs;
+	if (xi_thread_mutex_create(&bs->lock, "bc_sync") != XI_MUTEX_RV_OK) {
+		xi_mem_free(bs);
+		*state = NULL;
+		return -1;
+	}
+	xi_thread_cond_create(&bs->cond, "bc_sync");
+	return 0;
+}
+
+static xvoid bc_sync_teardown(xvoid *state) {
+	bc_sync_t *bs = state;
+
+	bc_team_destroy(bs->team);
+	xi_thread_cond_destroy(&bs->cond);
+	xi_thread_mutex_destroy(&bs->lock);
+	xi_mem_free(bs);
+}
+
+static xint64 bc_mutex_single(xvoid *state, xint64 n) {
+	bc_sync_t *bs = state;
+	xint64 i, start;
+
+	start = xi_clock_ntick();
+	for (i = 0; i < n; i++) {
+		xi_thread_mutex_lock(&bs->lock);
+		bs->count++;
+		xi_thread_mutex_unlock(&bs->lock);
+	}
+	return xi_clock_ntick() - start;
+}
+
+static xvoid bc_mutex_work(xint32 id, xint64 n, xvoid *arg) {
+	bc_sync_t *bs = arg;
+	xint64 i;
+
+	UNUSED(id);
+
+	for (i = 0; i < n; i++) {
+		xi_thread_mutex_lock(&bs->lock);
+		bs->count++;
+		xi_thread_mutex_unlock(&bs->lock);
+	}
+}
+
+static xint32 bc_mutex_setup_mt(xvoid **state) {
+	bc_sync_t *bs;
+
+	if (bc_sync_setup(state) < 0) {
+		return -1;
+	}
+	bs = *state;
+	bs->team = bc_team_create(bc_opt.threads, bc_mutex_work, bs);
+	return (bs->team == NULL) ? -1 : 0;
+}
+
+static xint64 bc_mutex_mt(xvoid *state, xint64 n) {
+	bc_sync_t *bs = state;
+	xint64 per = n / bc_opt.threads;
+
+	return bc_team_run(bs->team, (per > 0) ? per : 1);
+}
+
+// two threads pass the turn to each other, an op is one handoff
+static xvoid bc_cond_work(xint32 id, xint64 n, xvoid *arg) {
+	bc_sync_t *bs = arg;
+	xint64 i;
+
+	xi_thread_mutex_lock(&bs->lock);
+	for (i = 0; i < n; i++) {
+		while (bs->turn != id) {
+			xi_thread_cond_wait(&bs->cond, &bs->lock);
+		}
+		bs->turn = 1 - id;
+		bs->count++;
+		xi_thread_cond_signal(&bs->cond);
+	}
+	xi_thread_mutex_unlock(&bs->lock);
+}
+
+static xint32 bc_cond_setup(xvoid **state) {
+	bc_sync_t *bs;
+
+	if (bc_sync_setup(state) < 0) {
+		return -1;
+	}
+	bs = *state;
+	bs->team = bc_team_create(2, bc_cond_work, bs);
+	return (bs->team == NULL) ? -1 : 0;
+}
+
+static xint64 bc_cond_pingpong(xvoid *state, xint64 n) {
+	bc_sync_t *bs = state;
+	xint64 per = n / 2;
+
+	// every round starts with the thread 0, and ends with the turn of it
+	bs->turn = 0;
+	return bc_team_run(bs->team, (per > 0) ? per : 1);
+}
+
+// all the threads wait for a broadcast, an op is one wakeup of a thread
+static xvoid bc_cond_bcast_work(xint32 id, xint64 n, xvoid *arg) {
+	bc_sync_t *bs = arg;
+	xint64 i;
+
+	xi_thread_mutex_lock(&bs->lock);
+	for (i = 0; i < n; i++) {
+		if (id == 0) {
+			// the thread 0 releases everyone when all have arrived
+			bs->count++;
+			while (bs->count % bc_opt.threads != 0) {
+				xi_thread_cond_wait(&bs->cond, &bs->lock);
+			}
+			bs->turn++;
+			xi_thread_cond_broadcast(&bs->cond);
+		} else {
+			xint32 gen = bs->turn;
+			bs->count++;
+			xi_thread_cond_broadcast(&bs->cond);
+			while (bs->turn == gen) {
+				xi_thread_cond_wait(&bs->cond, &bs->lock);
+			}
+		}
+	}
+	xi_thread_mutex_unlock(&bs->lock);
+}
+
+static xint32 bc_cond_bcast_setup(xvoid **state) {
+	bc_sync_t *bs;
+
+	if (bc_sync_setup(state) < 0) {
+		return -1;
+	}
+	bs = *state;
+	bs->team = bc_team_create(bc_opt.threads, bc_cond_bcast_work, bs);
+	return (bs->team == NULL) ? -1 : 0;
+}
+
+static xint64 bc_cond_bcast(xvoid *state, xint64 n) {
+	bc_sync_t *bs = state;
+	xint64 per = n / bc_opt.threads;
+
+	bs->count = 0;
+	return bc_team_run(bs->team, (per > 0) ? per : 1);
+}
+
+const bc_case_t bc_xi_thread[] = {
+		{ "mutex_single", bc_mutex_single, bc_sync_setup, bc_sync_teardown, 0, 0 },
+		{ "mutex_contended_mt", bc_mutex_mt, bc_mutex_setup_mt, bc_sync_teardown, 0, 0 },
+		{ "cond_pingpong", bc_cond_pingpong, bc_cond_setup, bc_sync_teardown, 0, 0 },
+		{ "cond_barrier_mt", bc_cond_bcast, bc_cond_bcast_setup, bc_sync_teardown, 0, 0 },
+		{ NULL, NULL, NULL, NULL, 0, 0 }
+};
@@ -0,0 +1,807 @@
+/*
+ * Copyright 2013 Cheolmin Jo (webos21@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * File   : xg_evloop.c
+ */
+
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif // !_WIN32
+
+#ifdef __linux__
+#include <sys/eventfd.h>
+#define XG_EVLOOP_EVENTFD
+#endif // __linux__
+
+#include "xi/xi_evloop.h"
+#include "xi/xi_atomic.h"
+#include "xi/xi_log.h"
+#include "xi/xi_mem.h"
+#include "xi/xi_string.h"
+#include "xi/xi_thread.h"
+#include "xi/xi_timer.h"
+
+// ----------------------------------------------
+// Inner Structure
+// ----------------------------------------------
+
+#define XG_EVLOOP_RFDS_MAX      64
+#define XG_EVLOOP_IOMAP_INIT    64
+
+#define XG_EVLOOP_STATE_CREATED 0
+#define XG_EVLOOP_STATE_STARTED 1
+#define XG_EVLOOP_STATE_STOPPED 2
+
+typedef struct _st_evloop_io {
+	xint32 desc;
+	xint32 evts;
+	xi_evloop_io_fn func;
+	xvoid *arg;
+	struct _st_evloop_io *next;
+} xg_evloop_io_t;
+
+/*
+ * A posted task runs tfunc, a handoff runs afunc with csock.
+ */
+typedef struct _st_evloop_task {
+	xi_evloop_task_fn tfunc;
+	xi_evloop_accept_fn afunc;
+	xint32 csock;
+	xvoid *arg;
+	struct _st_evloop_task *next;
+} xg_evloop_task_t;
+
+typedef struct _st_evloop_lsnr {
+	xint32 lsock;
+	xi_evloop_accept_fn func;
+	xvoid *arg;
+	struct _st_evloop_lsnr *next;
+} xg_evloop_lsnr_t;
+
+typedef struct _st_evloop_thr {
+	xi_evloop_t *loop;
+	xint32 idx;
+	xi_thread_t tid;
+	xi_pollset_t *pset;
+	xi_timer_t *timer;
+	xint32 wfd[2];           // [0] : read-end, [1] : write-end
+	volatile xuint32 running;
+	xi_thread_mutex_t qlock;
+	xg_evloop_task_t *qhead; // guarded by qlock
+	xg_evloop_task_t *qtail; // guarded by qlock
+	xbool wpending;          // guarded by qlock
+	xg_evloop_io_t **iomap;  // desc -> registration
+	xint32 iomax;
+	xg_evloop_io_t *garbage; // removed during a dispatch
+	xi_pollfd_t rfds[XG_EVLOOP_RFDS_MAX];
+} xg_evloop_thr_t;
+
+struct _xi_evloop {
+	xg_evloop_thr_t *thrs;
+	xint32 nloops;
+	volatile xuint32 rr;
+	xint32 state;
+	xi_thread_mutex_t lock;
+	xi_thread_cond_t cond;
+	xint32 alive;            // guarded by lock
+	xg_evloop_lsnr_t *lsnrs; // guarded by lock
+};
+
+// ----------------------------------------------
+// Part Internal Functions
+// ----------------------------------------------
+
+/*
+ * The wakeup descriptor of a loop thread is an eventfd on linux,
+ * a pipe on the other posix systems, and a loopback UDP socket
+ * connected to itself on win32 (select() takes sockets only).
+ */
+#ifdef _WIN32
+static xint32 xg_evloop_wakeup_open(xint32 wfd[2]) {
+	xint32 sock;
+	xi_sock_addr_t addr = { XI_SOCK_FAMILY_INET, XI_SOCK_TYPE_DATAGRAM,
+			XI_SOCK_PROTO_UDP, { '\0' }, 0 };
+
+	sock = xi_socket_open(addr.family, addr.type, addr.proto);
+	if (sock < 0) {
+		return -1;
+	}
+
+	xi_strcpy(addr.host, "127.0.0.1");
+	if (xi_socket_bind(sock, addr) != XI_SOCK_RV_OK
+			|| xi_socket_get_local(sock, &addr) != XI_SOCK_RV_OK
+			|| xi_socket_connect(sock, addr) != XI_SOCK_RV_OK
+			|| xi_socket_opt_set(sock, XI_SOCK_OPT_NONBLOCK, TRUE) != XI_SOCK_RV_OK) {
+		xi_socket_close(sock);
+		return -1;
+	}
+
+	wfd[0] = wfd[1] = sock;
+	return 0;
+}
+
+static xvoid xg_evloop_wakeup_close(xint32 wfd[2]) {
+	if (wfd[0] >= 0) {
+		xi_socket_close(wfd[0]);
+	}
+	wfd[0] = wfd[1] = -1;
+}
+
+static xvoid xg_evloop_wakeup(xg_evloop_thr_t *thr) {
+	xchar one = 1;
+	// a full buffer means that the loop thread is already signaled
+	xi_socket_send(thr->wfd[1], &one, sizeof(one));
+}
+
+static xvoid xg_evloop_wakeup_drain(xg_evloop_thr_t *thr) {
+	xchar buf[64];
+	while (xi_socket_recv(thr->wfd[0], buf, sizeof(buf)) > 0) {
+		// consume all
+	}
+}
+#else // !_WIN32
+static xint32 xg_evloop_wakeup_open(xint32 wfd[2]) {
+#ifdef XG_EVLOOP_EVENTFD
+	wfd[0] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (wfd[0] < 0) {
+		return -1;
+	}
+	wfd[1] = wfd[0];
+#else // !XG_EVLOOP_EVENTFD
+	if (pipe(wfd) < 0) {
+		return -1;
+	}
+	fcntl(wfd[0], F_SETFL, fcntl(wfd[0], F_GETFL) | O_NONBLOCK);
+	fcntl(wfd[1], F_SETFL, fcntl(wfd[1], F_GETFL) | O_NONBLOCK);
+	fcntl(wfd[0], F_SETFD, FD_CLOEXEC);
+	fcntl(wfd[1], F_SETFD, FD_CLOEXEC);
+#endif // XG_EVLOOP_EVENTFD
+	return 0;
+}
+
+static xvoid xg_evloop_wakeup_close(xint32 wfd[2]) {
+	if (wfd[0] >= 0) {
+		close(wfd[0]);
+	}
+	if (wfd[1] >= 0 && wfd[1] != wfd[0]) {
+		close(wfd[1]);
+	}
+	wfd[0] = wfd[1] = -1;
+}
+
+static xvoid xg_evloop_wakeup(xg_evloop_thr_t *thr) {
+	xssize rv;
+#ifdef XG_EVLOOP_EVENTFD
+	xuint64 one = 1;
+	rv = write(thr->wfd[1], &one, sizeof(one));
+#else // !XG_EVLOOP_EVENTFD
+	xchar one = 1;
+	rv = write(thr->wfd[1], &one, sizeof(one));
+#endif // XG_EVLOOP_EVENTFD
+	// EAGAIN means that the loop thread is already signaled
+	if (rv < 0 && errno != EAGAIN) {
+		log_error(XDLOG, "cannot wake up the loop thread %d (errno=%d)\n",
+				thr->idx, errno);
+	}
+}
+
+static xvoid xg_evloop_wakeup_drain(xg_evloop_thr_t *thr) {
+#ifdef XG_EVLOOP_EVENTFD
+	xuint64 cnt;
+	// one read resets the counter of an eventfd
+	if (read(thr->wfd[0], &cnt, sizeof(cnt)) < 0 && errno != EAGAIN) {
+		log_error(XDLOG, "cannot drain the loop thread %d (errno=%d)\n",
+				thr->idx, errno);
+	}
+#else // !XG_EVLOOP_EVENTFD
+	xchar buf[64];
+	// a pipe holds a byte per wakeup
+	while (read(thr->wfd[0], buf, sizeof(buf)) > 0) {
+		// consume all
+	}
+#endif // XG_EVLOOP_EVENTFD
+}
+#endif // _WIN32
+
+static xvoid xg_evloop_task_drop(xg_evloop_task_t *task) {
+	while (task != NULL) {
+		xg_evloop_task_t *next = task->next;
+		if (task->afunc != NULL) {
+			xi_socket_close(task->csock);
+		}
+		xi_mem_free(task);
+		task = next;
+	}
+}
+
+static xi_evloop_re xg_evloop_enqueue(xi_evloop_t *loop, xint32 idx,
+		xg_evloop_task_t *task) {
+	xbool wakeup;
+	xg_evloop_thr_t *thr = &(loop->thrs[idx]);
+
+	task->next = NULL;
+
+	xi_thread_mutex_lock(&thr->qlock);
+	if (thr->qtail == NULL) {
+		thr->qhead = task;
+	} else {
+		thr->qtail->next = task;
+	}
+	thr->qtail = task;
+	// one wakeup is enough until the loop thread takes the queue
+	wakeup = !thr->wpending;
+	thr->wpending = TRUE;
+	xi_thread_mutex_unlock(&thr->qlock);
+
+	if (wakeup) {
+		xg_evloop_wakeup(thr);
+	}
+
+	return XI_EVLOOP_RV_OK;
+}
+
+static xvoid xg_evloop_run_tasks(xg_evloop_thr_t *thr) {
+	xg_evloop_task_t *task;
+
+	xg_evloop_wakeup_drain(thr);
+
+	xi_thread_mutex_lock(&thr->qlock);
+	task = thr->qhead;
+	thr->qhead = NULL;
+	thr->qtail = NULL;
+	thr->wpending = FALSE;
+	xi_thread_mutex_unlock(&thr->qlock);
+
+	while (task != NULL) {
+		xg_evloop_task_t *next = task->next;
+		if (!thr->running) {
+			// stopped by a former task
+			xg_evloop_task_drop(task);
+			return;
+		}
+		if (task->afunc != NULL) {
+			task->afunc(thr->loop, thr->idx, task->csock, task->arg);
+		} else {
+			task->tfunc(thr->loop, thr->idx, task->arg);
+		}
+		xi_mem_free(task);
+		task = next;
+	}
+}
+
+static xvoid xg_evloop_gc(xg_evloop_thr_t *thr) {
+	while (thr->garbage != NULL) {
+		xg_evloop_io_t *next = thr->garbage->next;
+		xi_mem_free(thr->garbage);
+		thr->garbage = next;
+	}
+}
+
+static xvoid *xg_evloop_thread(xvoid *args) {
+	xint32 i, ret;
+	xg_evloop_thr_t *thr = (xg_evloop_thr_t *) args;
+	xi_evloop_t *loop = thr->loop;
+
+	while (thr->running) {
+		ret = xi_pollset_poll(thr->pset, thr->rfds, XG_EVLOOP_RFDS_MAX,
+				xi_timer_next(thr->timer));
+		if (ret == XI_POLLSET_RV_ERR_INTR || ret == XI_POLLSET_RV_ERR_TIMEOUT) {
+			xi_timer_run(thr->timer);
+			continue;
+		} else if (ret < 0) {
+			log_error(XDLOG, "loop thread %d cannot poll: %d\n", thr->idx, ret);
+			break;
+		}
+
+		for (i = 0; i < ret && thr->running; i++) {
+			xg_evloop_io_t *io;
+
+			if (thr->rfds[i].context == thr) {
+				xg_evloop_run_tasks(thr);
+				continue;
+			}
+
+			io = (xg_evloop_io_t *) thr->rfds[i].context;
+			if (io->func == NULL) {
+				// removed by a former callback of this batch
+				continue;
+			}
+			io->func(loop, thr->idx, io->desc, thr->rfds[i].evts, io->arg);
+		}
+
+		xg_evloop_gc(thr);
+
+		if (thr->running) {
+			xi_timer_run(thr->timer);
+		}
+	}
+
+	xi_thread_mutex_lock(&loop->lock);
+	loop->alive--;
+	xi_thread_cond_broadcast(&loop->cond);
+	xi_thread_mutex_unlock(&loop->lock);
+
+	return NULL;
+}
+
+static xvoid xg_evloop_on_accept(xi_evloop_t *loop, xint32 idx, xint32 desc,
+		xint32 evts, xvoid *arg) {
+	xg_evloop_lsnr_t *lsnr = (xg_evloop_lsnr_t *) arg;
+
+	UNUSED(evts);
+
+	for (;;) {
+		xint32 csock, target;
+
+		// the loop threads must not block on the accepted sockets
+		csock = xi_socket_accept4(desc, NULL, XI_SOCK_ACCEPT_NONBLOCK);
+		if (csock < 0) {
+			if (csock != XI_SOCK_RV_ERR_TRYLATER && csock != XI_SOCK_RV_ERR_INTR) {
+				log_error(XDLOG, "cannot accept on %d: %d\n", desc, csock);
+			}
+			return;
+		}
+
+		target = xi_evloop_next(loop);
+		if (target == idx) {
+			lsnr->func(loop, idx, csock, lsnr->arg);
+		} else if (xi_evloop_handoff(loop, target, csock, lsnr->func,
+				lsnr->arg) != XI_EVLOOP_RV_OK) {
+			xi_socket_close(csock);
+		}
+	}
+}
+
+static xvoid xg_evloop_listen_task(xi_evloop_t *loop, xint32 idx, xvoid *arg) {
+	xi_evloop_re ret;
+	xg_evloop_lsnr_t *lsnr = (xg_evloop_lsnr_t *) arg;
+
+	ret = xi_evloop_add(loop, idx, lsnr->lsock, XI_POLL_EVENT_IN,
+			xg_evloop_on_accept, lsnr);
+	if (ret != XI_EVLOOP_RV_OK) {
+		log_error(XDLOG, "cannot listen on %d: %d\n", lsnr->lsock, ret);
+	}
+}
+
+// ----------------------------------------------
+// XI Functions
+// ----------------------------------------------
+
+xi_evloop_t *xi_evloop_create(xuint32 nloops, xuint32 size) {
+	xint32 i;
+	xi_evloop_t *loop;
+
+	if (nloops == 0 || nloops > XCFG_THREAD_MAX || size == 0) {
+		return NULL;
+	}
+
+	loop = xi_mem_calloc(1, sizeof(xi_evloop_t));
+	if (loop == NULL) {
+		return NULL;
+	}
+
+	loop->thrs = xi_mem_calloc(nloops, sizeof(xg_evloop_thr_t));
+	if (loop->thrs == NULL) {
+		xi_mem_free(loop);
+		return NULL;
+	}
+	loop->nloops = (xint32) nloops;
+	loop->state = XG_EVLOOP_STATE_CREATED;
+
+	if (xi_thread_mutex_create(&loop->lock, "xg_evloop") != XI_MUTEX_RV_OK) {
+		xi_mem_free(loop->thrs);
+		xi_mem_free(loop);
+		return NULL;
+	}
+	if (xi_thread_cond_create(&loop->cond, "xg_evloop") != XI_COND_RV_OK) {
+		xi_thread_mutex_destroy(&loop->lock);
+		xi_mem_free(loop->thrs);
+		xi_mem_free(loop);
+		return NULL;
+	}
+
+	for (i = 0; i < loop->nloops; i++) {
+		xi_pollfd_t pfd;
+		xg_evloop_thr_t *thr = &(loop->thrs[i]);
+
+		thr->loop = loop;
+		thr->idx = i;
+		thr->wfd[0] = thr->wfd[1] = -1;
+
+		// one more for the wakeup descriptor
+		thr->pset = xi_pollset_create(size + 1, XI_POLLSET_OPT_EPOLL);
+		if (thr->pset == NULL) {
+			break;
+		}
+		thr->timer = xi_timer_create(1);
+		if (thr->timer == NULL) {
+			break;
+		}
+		if (xg_evloop_wakeup_open(thr->wfd) < 0) {
+			xi_timer_destroy(thr->timer);
+			break;
+		}
+		if (xi_thread_mutex_create(&thr->qlock, "xg_evloop_q") != XI_MUTEX_RV_OK) {
+			xg_evloop_wakeup_close(thr->wfd);
+			xi_timer_destroy(thr->timer);
+			break;
+		}
+
+		pfd.desc = thr->wfd[0];
+		pfd.evts = XI_POLL_EVENT_IN;
+		pfd.context = thr;
+		if (xi_pollset_add(thr->pset, pfd) != XI_POLLSET_RV_OK) {
+			xi_thread_mutex_destroy(&thr->qlock);
+			xg_evloop_wakeup_close(thr->wfd);
+			xi_timer_destroy(thr->timer);
+			break;
+		}
+	}
+
+	if (i < loop->nloops) {
+		log_error(XDLOG, "cannot create the loop thread %d\n", i);
+		if (loop->thrs[i].pset != NULL) {
+			xi_pollset_destroy(loop->thrs[i].pset);
+		}
+		loop->nloops = i;
+		xi_evloop_destroy(loop);
+		return NULL;
+	}
+
+	return loop;
+}
+
+xi_evloop_re xi_evloop_start(xi_evloop_t *loop) {
+	xint32 i;
+
+	if (loop == NULL) {
+		return XI_EVLOOP_RV_ERR_ARGS;
+	}
+
+	xi_thread_mutex_lock(&loop->lock);
+	if (loop->state != XG_EVLOOP_STATE_CREATED) {
+		xi_thread_mutex_unlock(&loop->lock);
+		return XI_EVLOOP_RV_ERR_STATE;
+	}
+	loop->state = XG_EVLOOP_STATE_STARTED;
+
+	for (i = 0; i < loop->nloops; i++) {
+		xg_evloop_thr_t *thr = &(loop->thrs[i]);
+
+		thr->running = TRUE;
+		if (xi_thread_create(&thr->tid, "xg_evloop", xg_evloop_thread, thr,
+				256 * 1024, XCFG_THREAD_PRIOR_NORM) != XI_THREAD_RV_OK) {
+			thr->running = FALSE;
+			break;
+		}
+		loop->alive++;
+	}
+	xi_thread_mutex_unlock(&loop->lock);
+
+	if (i < loop->nloops) {
+		log_error(XDLOG, "cannot start the loop thread %d\n", i);
+		xi_evloop_stop(loop);
+		return XI_EVLOOP_RV_ERR_OP;
+	}
+
+	return XI_EVLOOP_RV_OK;
+}
+
+xi_evloop_re xi_evloop_stop(xi_evloop_t *loop) {
+	xint32 i;
+
+	if (loop == NULL) {
+		return XI_EVLOOP_RV_ERR_ARGS;
+	}
+
+	xi_thread_mutex_lock(&loop->lock);
+	if (loop->state != XG_EVLOOP_STATE_STARTED) {
+		xi_thread_mutex_unlock(&loop->lock);
+		return XI_EVLOOP_RV_ERR_STATE;
+	}
+	loop->state = XG_EVLOOP_STATE_STOPPED;
+
+	for (i = 0; i < loop->nloops; i++) {
+		if (loop->thrs[i].running) {
+			loop->thrs[i].running = FALSE;
+			xg_evloop_wakeup(&(loop->thrs[i]));
+		}
+	}
+
+	while (loop->alive > 0) {
+		xi_thread_cond_wait(&loop->cond, &loop->lock);
+	}
+	xi_thread_mutex_unlock(&loop->lock);
+
+	for (i = 0; i < loop->nloops; i++) {
+		xg_evloop_task_t *task;
+		xg_evloop_thr_t *thr = &(loop->thrs[i]);
+
+		xi_thread_mutex_lock(&thr->qlock);
+		task = thr->qhead;
+		thr->qhead = NULL;
+		thr->qtail = NULL;
+		xi_thread_mutex_unlock(&thr->qlock);
+
+		xg_evloop_task_drop(task);
+		xg_evloop_gc(thr);
+	}
+
+	return XI_EVLOOP_RV_OK;
+}
+
+xi_evloop_re xi_evloop_destroy(xi_evloop_t *loop) {
+	xint32 i, j;
+
+	if (loop == NULL) {
+		return XI_EVLOOP_RV_ERR_ARGS;
+	}
+
+	if (loop->state == XG_EVLOOP_STATE_STARTED) {
+		xi_evloop_stop(loop);
+	}
+
+	for (i = 0; i < loop->nloops; i++) {
+		xg_evloop_thr_t *thr = &(loop->thrs[i]);
+
+		for (j = 0; j < thr->iomax; j++) {
+			xi_mem_free(thr->iomap[j]);
+		}
+		xi_mem_free(thr->iomap);
+		xg_evloop_gc(thr);
+		xg_evloop_task_drop(thr->qhead);
+
+		xi_pollset_destroy(thr->pset);
+		xi_timer_destroy(thr->timer);
+		xg_evloop_wakeup_close(thr->wfd);
+		xi_thread_mutex_destroy(&thr->qlock);
+	}
+
+	while (loop->lsnrs != NULL) {
+		xg_evloop_lsnr_t *next = loop->lsnrs->next;
+		xi_mem_free(loop->lsnrs);
+		loop->lsnrs = next;
+	}
+
+	xi_thread_cond_destroy(&loop->cond);
+	xi_thread_mutex_destroy(&loop->lock);
+	xi_mem_free(loop->thrs);
+	xi_mem_free(loop);
+
+	return XI_EVLOOP_RV_OK;
+}
+
+xint32 xi_evloop_count(xi_evloop_t *loop) {
+	if (loop == NULL) {
+		return XI_EVLOOP_RV_ERR_ARGS;
+	}
+	return loop->nloops;
+}
+
+xint32 xi_evloop_next(xi_evloop_t *loop) {
+	if (loop == NULL) {
+		return XI_EVLOOP_RV_ERR_ARGS;
+	}
+	return (xint32) (xi_atomic_inc32(&loop->rr) % (xuint32) loop->nloops);
+}
+
+xi_timer_t *xi_evloop_timer(xi_evloop_t *loop, xint32 idx) {
+	if (loop == NULL || idx < 0 || idx >= loop->nloops) {
+		return NULL;
+	}
+	return loop->thrs[idx].timer;
+}
+
+xi_evloop_re xi_evloop_add(xi_evloop_t *loop, xint32 idx, xint32 desc,
+		xint32 evts, xi_evloop_io_fn func, xvoid *arg) {
+	xi_pollfd_t pfd;
+	xg_evloop_io_t *io;
+	xg_evloop_thr_t *thr;
+
+	if (loop == NULL || idx < 0 || idx >= loop->nloops || desc < 0
+			|| func == NULL) {
+		return XI_EVLOOP_RV_ERR_ARGS;
+	}
+
+	thr = &(loop->thrs[idx]);
+
+	if (desc >= thr->iomax) {
+		xint32 nmax = (thr->iomax == 0) ? XG_EVLOOP_IOMAP_INIT : thr->iomax;
+		xg_evloop_io_t **nmap;
+
+		while (nmax <= desc) {
+			nmax *= 2;
+		}
+		nmap = xi_mem_calloc((xuint32) nmax, sizeof(xg_evloop_io_t *));
+		if (nmap == NULL) {
+			return XI_EVLOOP_RV_ERR_NOMEM;
+		}
+		if (thr->iomap != NULL) {
+			xi_mem_copy(nmap, thr->iomap,
+					sizeof(xg_evloop_io_t *) * (xuint32) thr->iomax);
+			xi_mem_free(thr->iomap);
+		}
+		thr->iomap = nmap;
+		thr->iomax = nmax;
+	}
+
+	if (thr->iomap[desc] != NULL) {
+		return XI_EVLOOP_RV_ERR_ARGS;
+	}
+
+	io = xi_mem_alloc(sizeof(xg_evloop_io_t));
+	if (io == NULL) {
+		return XI_EVLOOP_RV_ERR_NOMEM;
+	}
+	io->desc = desc;
+	io->evts = evts;
+	io->func = func;
+	io->arg = arg;
+	io->next = NULL;
+
+	pfd.desc = desc;
+	pfd.evts = evts;
+	pfd.context = io;
+	if (xi_pollset_add(thr->pset, pfd) != XI_POLLSET_RV_OK) {
+		xi_mem_free(io);
+		return XI_EVLOOP_RV_ERR_OP;
+	}
+
+	thr->iomap[desc] = io;
+
+	return XI_EVLOOP_RV_OK;
+}
+
+xi_evloop_re xi_evloop_modify(xi_evloop_t *loop, xint32 idx, xint32 desc,
+		xint32 evts) {
+	xi_pollfd_t pfd;
+	xg_evloop_io_t *io;
+	xg_evloop_thr_t *thr;
+
+	if (loop == NULL || idx < 0 || idx >= loop->nloops || desc < 0) {
+		return XI_EVLOOP_RV_ERR_ARGS;
+	}
+
+	thr = &(loop->thrs[idx]);
+	if (desc >= thr->iomax || thr->iomap[desc] == NULL) {
+		return XI_EVLOOP_RV_ERR_NF;
+	}
+
+	io = thr->iomap[desc];
+	if (io->evts == evts) {
+		return XI_EVLOOP_RV_OK;
+	}
+
+	pfd.desc = desc;
+	pfd.evts = evts;
+	pfd.context = io;
+	if (xi_pollset_modify(thr->pset, pfd) != XI_POLLSET_RV_OK) {
+		return XI_EVLOOP_RV_ERR_OP;
+	}
+	io->evts = evts;
+
+	return XI_EVLOOP_RV_OK;
+}
+
+xi_evloop_re xi_evloop_remove(xi_evloop_t *loop, xint32 idx, xint32 desc) {
+	xi_pollfd_t pfd;
+	xg_evloop_io_t *io;
+	xg_evloop_thr_t *thr;
+
+	if (loop == NULL || idx < 0 || idx >= loop->nloops || desc < 0) {
+		return XI_EVLOOP_RV_ERR_ARGS;
+	}
+
+	thr = &(loop->thrs[idx]);
+	if (desc >= thr->iomax || thr->iomap[desc] == NULL) {
+		return XI_EVLOOP_RV_ERR_NF;
+	}
+
+	io = thr->iomap[desc];
+
+	pfd.desc = desc;
+	pfd.evts = io->evts;
+	pfd.context = NULL;
+	xi_pollset_remove(thr->pset, pfd);
+
+	thr->iomap[desc] = NULL;
+
+	// the current batch may still hold it
+	io->func = NULL;
+	io->next = thr->garbage;
+	thr->garbage = io;
+
+	return XI_EVLOOP_RV_OK;
+}
+
+xi_evloop_re xi_evloop_post(xi_evloop_t *loop, xint32 idx,
+		xi_evloop_task_fn func, xvoid *arg) {
+	xg_evloop_task_t *task;
+
+	if (loop == NULL || idx < 0 || idx >= loop->nloops || func == NULL) {
+		return XI_EVLOOP_RV_ERR_ARGS;
+	}
+
+	task = xi_mem_alloc(sizeof(xg_evloop_task_t));
+	if (task == NULL) {
+		return XI_EVLOOP_RV_ERR_NOMEM;
+	}
+	task->tfunc = func;
+	task->afunc = NULL;
+	task->csock = -1;
+	task->arg = arg;
+
+	return xg_evloop_enqueue(loop, idx, task);
+}
+
+xi_evloop_re xi_evloop_handoff(xi_evloop_t *loop, xint32 idx, xint32 csock,
+		xi_evloop_accept_fn func, xvoid *arg) {
+	xg_evloop_task_t *task;
+
+	if (loop == NULL || idx < 0 || idx >= loop->nloops || csock < 0
+			|| func == NULL) {
+		return XI_EVLOOP_RV_ERR_ARGS;
+	}
+
+	task = xi_mem_alloc(sizeof(xg_evloop_task_t));
+	if (task == NULL) {
+		return XI_EVLOOP_RV_ERR_NOMEM;
+	}
+	task->tfunc = NULL;
+	task->afunc = func;
+	task->csock = csock;
+	task->arg = arg;
+
+	return xg_evloop_enqueue(loop, idx, task);
+}
+
+xi_evloop_re xi_evloop_listen(xi_evloop_t *loop, xint32 lsock,
+		xi_evloop_accept_fn func, xvoid *arg) {
+	xi_evloop_re ret;
+	xg_evloop_lsnr_t *lsnr;
+
+	if (loop == NULL || lsock < 0 || func == NULL) {
+		return XI_EVLOOP_RV_ERR_ARGS;
+	}
+
+	if (xi_socket_opt_set(lsock, XI_SOCK_OPT_NONBLOCK, TRUE) != XI_SOCK_RV_OK) {
+		return XI_EVLOOP_RV_ERR_OP;
+	}
+
+	lsnr = xi_mem_alloc(sizeof(xg_evloop_lsnr_t));
+	if (lsnr == NULL) {
+		return XI_EVLOOP_RV_ERR_NOMEM;
+	}
+	lsnr->lsock = lsock;
+	lsnr->func = func;
+	lsnr->arg = arg;
+
+	ret = xi_evloop_post(loop, 0, xg_evloop_listen_task, lsnr);
+	if (ret != XI_EVLOOP_RV_OK) {
+		xi_mem_free(lsnr);
+		return ret;
+	}
+
+	xi_thread_mutex_lock(&loop->lock);
+	lsnr->next = loop->lsnrs;
+	loop->lsnrs = lsnr;
+	xi_thread_mutex_unlock(&loop->lock);
+
+	return XI_EVLOOP_RV_OK;
+}
@@ -18,138 +18,390 @@
  * File : xg_hashtb.c
  */
 
-#include "xi/xi_hashtb.h"
+#include "xg_hashtb.h"
 
+#include "xi/xi_arrays.h"
 #include "xi/xi_mem.h"
 #include "xi/xi_clock.h"
 #include "xi/xi_log.h"
+#include "xi/xi_string.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define XG_HASHTB_SSE2
+#endif
 
 // ----------------------------------------------
 // Inner Structures
 // ----------------------------------------------
 
-// XXX : tunable == 2^n - 1
-#define XG_HASHTB_INIT_MAX 15
+/*
+ * The table is an open addressing one, whose slots are probed by the group.
+ * Each slot has a control byte : EMPTY, DELETED, or the high bit and the low
+ * 7 bits of the hash when it is full. EMPTY is 0, so that a new array of
+ * calloc is not touched until it is used. A lookup compares the 16 control bytes of a group at once,
+ * and only the slots whose byte matches are compared with the key.
+ *
+ * Growing the table does not rehash everything at once : the old array is
+ * kept, and each insertion moves a few groups of it into the new one.
+ * The lookups look into both until the old one becomes empty.
+ */
+
+#define XG_HASHTB_GROUP    16
+#define XG_HASHTB_INIT_CAP 16   // XXX : tunable == 2^n, a multiple of the group
+#define XG_HASHTB_MIGRATE  2    // groups moved by an insertion while resizing
+
+#define XG_HASHTB_EMPTY    ((xuint8) 0x00)
+#define XG_HASHTB_DELETED  ((xuint8) 0x01)
+#define XG_HASHTB_FULL(c)  ((c) & 0x80)
+#define XG_HASHTB_H2(h)    ((xuint8) (0x80 | ((h) & 0x7F)))
+
+#define XG_HASHTB_LIMIT(cap)  ((cap) - ((cap) >> 3))   // 7/8 load
 
-typedef struct _xg_hashtb_entry {
-	struct _xg_hashtb_entry *next;
-	xuint32 hashid;
+typedef struct _xg_hashtb_slot {
 	const xvoid *key;
-	xint32 klen;
 	const xvoid *val;
-} xg_hashtb_entry_t;
+	xuint64 hash;
+	xint32 klen;
+} xg_hashtb_slot_t;
+
+typedef struct _xg_hashtb_arr {
+	xuint8 *ctrl;             // cap bytes, followed by the slots
+	xg_hashtb_slot_t *slots;
+	xuint32 cap;              // 0 : not allocated
+	xuint32 used;             // full and deleted slots
+	xuint32 count;            // full slots
+} xg_hashtb_arr_t;
 
 struct _xi_hashtb_idx {
 	xi_hashtb_t *ht;
-	xg_hashtb_entry_t *curr;
-	xg_hashtb_entry_t *next;
+	xg_hashtb_slot_t *curr;
+	xuint32 arr;              // 0 : cur, 1 : old
 	xuint32 index;
 };
 
 struct _xi_hashtb {
-	xg_hashtb_entry_t **array;
+	xg_hashtb_arr_t cur;
+	xg_hashtb_arr_t old;      // being moved into cur
+	xuint32 migrated;         // the groups of old moved already
 	xi_hashtb_idx_t iterator; // For xi_hash_first(NULL, ...)
-	xuint32 count;
-	xuint32 max;
-	xuint32 seed;
+	xuint64 seed;
 	xi_hashtb_keygen hash_func;
-	xg_hashtb_entry_t *free; // List of recycled entries
 };
 
 // ----------------------------------------------
 // Global Variables
 // ----------------------------------------------
 
+static const xuint64 _g_hashtb_secret[4] = {
+		0xa0761d6478bd642fULL, 0xe7037ed1a0b428dbULL,
+		0x8ebc6af09c88c6e3ULL, 0x589965cc75374cc3ULL };
+
 // ----------------------------------------------
 // Part Internal Functions
 // ----------------------------------------------
 
-static xg_hashtb_entry_t **xg_hashtb_alloc_array(xi_hashtb_t *htb, xuint32 max) {
-	return xi_mem_calloc(sizeof(*htb->array), (max + 1));
+// the 128 bits product of a and b : the low half into a, the high half into b
+static xvoid xg_hashtb_mum(xuint64 *a, xuint64 *b) {
+#if defined(__SIZEOF_INT128__)
+	__uint128_t r = (__uint128_t) (*a) * (*b);
+	*a = (xuint64) r;
+	*b = (xuint64) (r >> 64);
+#else
+	xuint64 ha = *a >> 32, hb = *b >> 32;
+	xuint64 la = (xuint32) *a, lb = (xuint32) *b;
+	xuint64 rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+	xuint64 t = rl + (rm0 << 32), c = (t < rl);
+	xuint64 lo = t + (rm1 << 32);
+
+	c += (lo < t);
+	*a = lo;
+	*b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
 }
 
-static void xg_hashtb_expand_array(xi_hashtb_t *htb) {
-	xi_hashtb_idx_t *hi;
-	xg_hashtb_entry_t **new_array;
-	xuint32 new_max;
-
-	new_max = htb->max * 2 + 1;
-	new_array = xg_hashtb_alloc_array(htb, new_max);
-	for (hi = xi_hashtb_first(htb); hi; hi = xi_hashtb_next(hi)) {
-		xuint32 i = hi->curr->hashid & new_max;
-		hi->curr->next = new_array[i];
-		new_array[i] = hi->curr;
-	}
-	xi_mem_free(htb->array);
-	htb->array = new_array;
-	htb->max = new_max;
+xuint64 xg_hashtb_mix(xuint64 a, xuint64 b) {
+	xg_hashtb_mum(&a, &b);
+	return a ^ b;
 }
 
-static xuint32 xg_hashtb_keygen_default(const xvoid *char_key, xint32 *klen,
-		xuint32 hash) {
-	const xuint8 *key = (const xuint8 *) char_key;
-	const xuint8 *p;
-	xint32 i;
+static xuint64 xg_hashtb_r8(const xuint8 *p) {
+	return ((xuint64) p[0]) | ((xuint64) p[1] << 8) | ((xuint64) p[2] << 16)
+			| ((xuint64) p[3] << 24) | ((xuint64) p[4] << 32)
+			| ((xuint64) p[5] << 40) | ((xuint64) p[6] << 48)
+			| ((xuint64) p[7] << 56);
+}
 
-	/*
-	 * This is the popular `times 33' hash algorithm which is used by
-	 * perl and also appears in Berkeley DB. This is one of the best
-	 * known hash functions for strings because it is both computed
-	 * very fast and distributes very well.
-	 *                  -- Ralf S. Engelschall <rse@engelschall.com>
-	 */
+static xuint64 xg_hashtb_r4(const xuint8 *p) {
+	return ((xuint64) p[0]) | ((xuint64) p[1] << 8) | ((xuint64) p[2] << 16)
+			| ((xuint64) p[3] << 24);
+}
 
-	if (XI_HASHTB_KEY_STRING == (*klen)) {
-		for (p = key; *p; p++) {
-			hash = hash * 33 + (xint32)(*p);
+/*
+ * The wyhash (by Wang Yi, in the public domain) without its 48 bytes lanes.
+ * It is seeded by the table, so that the collisions can not be chosen
+ * from the outside.
+ */
+xuint64 xg_hashtb_hash64(const xvoid *key, xsize len, xuint64 seed) {
+	const xuint64 *s = _g_hashtb_secret;
+	const xuint8 *p = key;
+	xuint64 a, b;
+	xsize i;
+
+	seed ^= xg_hashtb_mix(seed ^ s[0], s[1]);
+	if (len <= 16) {
+		if (len >= 4) {
+			a = (xg_hashtb_r4(p) << 32) | xg_hashtb_r4(p + ((len >> 3) << 2));
+			b = (xg_hashtb_r4(p + len - 4) << 32)
+					| xg_hashtb_r4(p + len - 4 - ((len >> 3) << 2));
+		} else if (len > 0) {
+			a = ((xuint64) p[0] << 16) | ((xuint64) p[len >> 1] << 8) | p[len - 1];
+			b = 0;
+		} else {
+			a = b = 0;
 		}
-		*klen = (xint32)(p - key);
 	} else {
-		for (p = key, i = *klen; i; i--, p++) {
-			hash = hash * 33 + (xuint32)(*p);
+		i = len;
+		while (i > 16) {
+			seed = xg_hashtb_mix(xg_hashtb_r8(p) ^ s[1], xg_hashtb_r8(p + 8) ^ seed);
+			p += 16;
+			i -= 16;
 		}
+		a = xg_hashtb_r8(p + i - 16);
+		b = xg_hashtb_r8(p + i - 8);
 	}
+	a ^= s[1];
+	b ^= seed;
+	xg_hashtb_mum(&a, &b);
 
-	return hash;
+	return xg_hashtb_mix(a ^ s[0] ^ (xuint64) len, b ^ s[1]);
 }
 
-static xg_hashtb_entry_t **xg_hashtb_find_entry(xi_hashtb_t *htb,
-		const xvoid *key, xint32 klen, const xvoid *val) {
-	xg_hashtb_entry_t **hep, *he;
-	xuint32 hashid;
+xuint64 xg_hashtb_hash(xi_hashtb_keygen func, xuint64 seed, const xvoid *key,
+		xint32 *klen) {
+	if (func) {
+		// spread the custom hash over 64 bits
+		return xg_hashtb_mix(func(key, klen) ^ _g_hashtb_secret[2],
+				seed ^ _g_hashtb_secret[3]);
+	}
+	if (XI_HASHTB_KEY_STRING == (*klen)) {
+		*klen = (xint32) xi_strlen(key);
+	}
+	return xg_hashtb_hash64(key, (xsize) (*klen), seed);
+}
 
-	if (htb->hash_func) {
-		hashid = htb->hash_func(key, &klen);
-	} else {
-		hashid = xg_hashtb_keygen_default(key, &klen, htb->seed);
+xuint64 xg_hashtb_seed(const xvoid *salt) {
+	xuint64 now = (xuint64) xi_clock_msec();
+
+	return xg_hashtb_mix(now ^ (xuintptr) salt,
+			((xuintptr) &now) ^ _g_hashtb_secret[0]);
+}
+
+// the bits of the slots in the group g whose control byte is c
+static xuint32 xg_hashtb_match(const xuint8 *g, xuint8 c) {
+#ifdef XG_HASHTB_SSE2
+	__m128i v = _mm_loadu_si128((const __m128i *) g);
+	return (xuint32) _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8((char) c)));
+#else
+	xuint32 i, m = 0;
+	for (i = 0; i < XG_HASHTB_GROUP; i++) {
+		m |= (xuint32) (g[i] == c) << i;
 	}
+	return m;
+#endif
+}
+
+// the bits of the slots in the group g which are empty or deleted
+static xuint32 xg_hashtb_match_free(const xuint8 *g) {
+#ifdef XG_HASHTB_SSE2
+	return ~(xuint32) _mm_movemask_epi8(_mm_loadu_si128((const __m128i *) g))
+			& 0xFFFF;
+#else
+	xuint32 i, m = 0;
+	for (i = 0; i < XG_HASHTB_GROUP; i++) {
+		m |= (xuint32) (1 ^ (g[i] >> 7)) << i;
+	}
+	return m;
+#endif
+}
+
+static xuint32 xg_hashtb_lowbit(xuint32 m) {
+#if defined(__GNUC__)
+	return (xuint32) __builtin_ctz(m);
+#else
+	return (xuint32) xi_arrays_bscan32((xint32) m) - 1;
+#endif
+}
+
+static xbool xg_hashtb_alloc_array(xg_hashtb_arr_t *arr, xuint32 cap) {
+	arr->ctrl = xi_mem_calloc(1, cap + sizeof(xg_hashtb_slot_t) * cap);
+	if (arr->ctrl == NULL) {
+		return FALSE;
+	}
+	arr->slots = (xg_hashtb_slot_t *) (arr->ctrl + cap);
+	arr->cap = cap;
+	arr->used = 0;
+	arr->count = 0;
+	return TRUE;
+}
+
+static xvoid xg_hashtb_free_array(xg_hashtb_arr_t *arr) {
+	if (arr->ctrl != NULL) {
+		xi_mem_free(arr->ctrl);
+	}
+	xi_mem_set(arr, 0, sizeof(xg_hashtb_arr_t));
+}
+
+static xg_hashtb_slot_t *xg_hashtb_find_entry(xg_hashtb_arr_t *arr,
+		const xvoid *key, xint32 klen, xuint64 hash) {
+	xuint32 mask, pos, step, m;
+	xuint8 *g;
+	xg_hashtb_slot_t *s;
 
-	// scan linked list
-	for (hep = &htb->array[hashid & htb->max], he = *hep; he; hep = &he->next, he
-			= *hep) {
-		if (he->hashid == hashid && he->klen == klen && xi_mem_cmp(he->key,
-				key, (xsize)klen) == 0) {
-			break;
+	if (arr->cap == 0) {
+		return NULL;
+	}
+
+	mask = arr->cap / XG_HASHTB_GROUP - 1;
+	pos = (xuint32) (hash >> 7) & mask;
+	for (step = 1; step <= mask + 1; step++) {
+		g = arr->ctrl + pos * XG_HASHTB_GROUP;
+		for (m = xg_hashtb_match(g, XG_HASHTB_H2(hash)); m; m &= m - 1) {
+			s = &arr->slots[pos * XG_HASHTB_GROUP + xg_hashtb_lowbit(m)];
+			if (s->hash == hash && s->klen == klen
+					&& xi_mem_cmp(s->key, key, (xsize) klen) == 0) {
+				return s;
+			}
 		}
+		if (xg_hashtb_match(g, XG_HASHTB_EMPTY)) {
+			return NULL;
+		}
+		pos = (pos + step) & mask; // triangular : every group is visited
 	}
-	if (he || !val) {
-		return hep;
+	return NULL;
+}
+
+// a free slot for the hash, which is taken
+static xg_hashtb_slot_t *xg_hashtb_take_slot(xg_hashtb_arr_t *arr,
+		xuint64 hash) {
+	xuint32 mask, pos, step, m, i;
+
+	mask = arr->cap / XG_HASHTB_GROUP - 1;
+	pos = (xuint32) (hash >> 7) & mask;
+	for (step = 1; step <= mask + 1; step++) {
+		m = xg_hashtb_match_free(arr->ctrl + pos * XG_HASHTB_GROUP);
+		if (m) {
+			i = pos * XG_HASHTB_GROUP + xg_hashtb_lowbit(m);
+			if (arr->ctrl[i] == XG_HASHTB_EMPTY) {
+				arr->used++;
+			}
+			arr->ctrl[i] = XG_HASHTB_H2(hash);
+			arr->count++;
+			return &arr->slots[i];
+		}
+		pos = (pos + step) & mask;
 	}
+	return NULL;
+}
+
+static xvoid xg_hashtb_drop_slot(xg_hashtb_arr_t *arr, xg_hashtb_slot_t *s) {
+	xuint32 i = (xuint32) (s - arr->slots);
+	xuint8 *g = arr->ctrl + (i & ~(XG_HASHTB_GROUP - 1));
 
-	// add a new entry for non-NULL values
-	if ((he = htb->free) != NULL) {
-		htb->free = he->next;
+	// a group which has an empty slot has never been probed through
+	if (xg_hashtb_match(g, XG_HASHTB_EMPTY)) {
+		arr->ctrl[i] = XG_HASHTB_EMPTY;
+		arr->used--;
 	} else {
-		he = xi_mem_alloc(sizeof(*he));
-	}
-	he->next = NULL;
-	he->hashid = hashid;
-	he->key = key;
-	he->klen = klen;
-	he->val = val;
-	*hep = he;
-	htb->count++;
-	return hep;
+		arr->ctrl[i] = XG_HASHTB_DELETED;
+	}
+	arr->count--;
+}
+
+// move the next groups of the old array into the current one
+static xvoid xg_hashtb_migrate(xi_hashtb_t *htb, xuint32 groups) {
+	xg_hashtb_arr_t *old = &htb->old;
+	xg_hashtb_slot_t *s;
+	xuint32 i, end;
+
+	end = (htb->migrated + groups) * XG_HASHTB_GROUP;
+	if (end > old->cap) {
+		end = old->cap;
+	}
+	for (i = htb->migrated * XG_HASHTB_GROUP; i < end; i++) {
+		if (XG_HASHTB_FULL(old->ctrl[i])) {
+			s = xg_hashtb_take_slot(&htb->cur, old->slots[i].hash);
+			*s = old->slots[i];
+			// the later lookups in old still probe through it
+			old->ctrl[i] = XG_HASHTB_DELETED;
+			old->count--;
+		}
+	}
+	htb->migrated = end / XG_HASHTB_GROUP;
+
+	if (end == old->cap) {
+		xg_hashtb_free_array(old);
+		htb->migrated = 0;
+	}
+}
+
+/*
+ * Start a resize : the current array becomes the old one.
+ * The new array is at most half full after the whole migration, so that
+ * the migration always ends before the new array needs to grow again.
+ */
+static xbool xg_hashtb_expand_array(xi_hashtb_t *htb) {
+	xg_hashtb_arr_t arr;
+	xuint32 cap = htb->cur.cap;
+
+	if (htb->old.cap != 0) {
+		xg_hashtb_migrate(htb, htb->old.cap / XG_HASHTB_GROUP);
+	}
+	// reuse the same size, if the most of the used ones are deleted
+	while (cap < (htb->cur.count + 1) * 2) {
+		cap <<= 1;
+	}
+	if (!xg_hashtb_alloc_array(&arr, cap)) {
+		return FALSE;
+	}
+	htb->old = htb->cur;
+	htb->cur = arr;
+	htb->migrated = 0;
+	return TRUE;
+}
+
+static xvoid xg_hashtb_copy_array(xg_hashtb_arr_t *dst, xg_hashtb_arr_t *src) {
+	xg_hashtb_slot_t *s;
+	xuint32 i;
+
+	for (i = 0; i < src->cap; i++) {
+		if (XG_HASHTB_FULL(src->ctrl[i])) {
+			s = xg_hashtb_take_slot(dst, src->slots[i].hash);
+			*s = src->slots[i];
+		}
+	}
+}
+
+static xvoid xg_hashtb_put(xi_hashtb_t *htb, const xvoid *key, xint32 klen,
+		xuint64 hash, const xvoid *val) {
+	xg_hashtb_slot_t *s;
+
+	if (htb->old.cap != 0) {
+		xg_hashtb_migrate(htb, XG_HASHTB_MIGRATE);
+	}
+	if (htb->cur.used >= XG_HASHTB_LIMIT(htb->cur.cap)) {
+		// out of memory : go on with the current one, while it has a room
+		xg_hashtb_expand_array(htb);
+	}
+
+	s = xg_hashtb_take_slot(&htb->cur, hash);
+	if (s == NULL) {
+		return;
+	}
+	s->key = key;
+	s->klen = klen;
+	s->hash = hash;
+	s->val = val;
 }
 
 // ----------------------------------------------
@@ -158,16 +410,16 @@ static xg_hashtb_entry_t **xg_hashtb_find_entry(xi_hashtb_t *htb,
 
 xi_hashtb_t *xi_hashtb_create() {
 	xi_hashtb_t *htb;
-	xuint64 now = (xuint64) xi_clock_msec();
 
-	htb = xi_mem_alloc(sizeof(xi_hashtb_t));
-	htb->free = NULL;
-	htb->count = 0;
-	htb->max = XG_HASHTB_INIT_MAX;
-	htb->seed
-			= (xuint32) (((xuint32)(now >> 32)) ^ now ^ ((xuintptr) htb) ^ ((xuintptr) &now))
-					- 1;
-	htb->array = xg_hashtb_alloc_array(htb, htb->max);
+	htb = xi_mem_calloc(1, sizeof(xi_hashtb_t));
+	if (htb == NULL) {
+		return NULL;
+	}
+	if (!xg_hashtb_alloc_array(&htb->cur, XG_HASHTB_INIT_CAP)) {
+		xi_mem_free(htb);
+		return NULL;
+	}
+	htb->seed = xg_hashtb_seed(htb);
 	htb->hash_func = NULL;
 
 	return htb;
@@ -175,50 +427,61 @@ xi_hashtb_t *xi_hashtb_create() {
 
 xi_hashtb_t *xi_hashtb_create_custom(xi_hashtb_keygen func) {
 	xi_hashtb_t *htb = xi_hashtb_create();
-	htb->hash_func = func;
+	if (htb != NULL) {
+		htb->hash_func = func;
+	}
 	return htb;
 }
 
 xvoid xi_hashtb_set(xi_hashtb_t *htb, const xvoid *key, xint32 klen,
 		const xvoid *val) {
-	xg_hashtb_entry_t **hep;
-	hep = xg_hashtb_find_entry(htb, key, klen, val);
-	if (*hep) {
+	xg_hashtb_arr_t *arr = &htb->cur;
+	xg_hashtb_slot_t *s;
+	xuint64 hash;
+
+	hash = xg_hashtb_hash(htb->hash_func, htb->seed, key, &klen);
+	s = xg_hashtb_find_entry(arr, key, klen, hash);
+	if (s == NULL && htb->old.cap != 0) {
+		arr = &htb->old;
+		s = xg_hashtb_find_entry(arr, key, klen, hash);
+	}
+
+	if (s != NULL) {
 		if (val == NULL) {
-			// delete entry
-			xg_hashtb_entry_t *old = *hep;
-			*hep = (*hep)->next;
-			old->next = htb->free;
-			htb->free = old;
-			htb->count--;
+			// delete entry (it moves nothing, for the running iterations)
+			xg_hashtb_drop_slot(arr, s);
 		} else {
 			// replace entry
-			(*hep)->val = val;
-			// check that the collision rate isn't too high
-			if (htb->count > htb->max) {
-				xg_hashtb_expand_array(htb);
-			}
+			s->val = val;
 		}
+	} else if (val != NULL) {
+		xg_hashtb_put(htb, key, klen, hash, val);
 	}
 	/* else key not present and val==NULL */
 }
 
 xvoid *xi_hashtb_get(xi_hashtb_t *htb, const xvoid *key, xint32 klen) {
-	xg_hashtb_entry_t *he;
-	he = *xg_hashtb_find_entry(htb, key, klen, NULL);
-	if (he) {
-		return (xvoid *) he->val;
+	xg_hashtb_slot_t *s;
+	xuint64 hash;
+
+	hash = xg_hashtb_hash(htb->hash_func, htb->seed, key, &klen);
+	s = xg_hashtb_find_entry(&htb->cur, key, klen, hash);
+	if (s == NULL && htb->old.cap != 0) {
+		s = xg_hashtb_find_entry(&htb->old, key, klen, hash);
+	}
+	if (s) {
+		return (xvoid *) s->val;
 	} else {
 		return NULL;
 	}
 }
 
 xuint32 xi_hashtb_count(xi_hashtb_t *htb) {
-	return htb->count;
+	return htb->cur.count + htb->old.count;
 }
 
 xuint32 xi_hashtb_max(xi_hashtb_t *htb) {
-	return htb->max;
+	return XG_HASHTB_LIMIT(htb->cur.cap);
 }
 
 xi_hashtb_idx_t *xi_hashtb_first(xi_hashtb_t *htb) {
@@ -226,22 +489,27 @@ xi_hashtb_idx_t *xi_hashtb_first(xi_hashtb_t *htb) {
 
 	hi = &htb->iterator;
 	hi->ht = htb;
+	hi->arr = 0;
 	hi->index = 0;
 	hi->curr = NULL;
-	hi->next = NULL;
 	return xi_hashtb_next(hi);
 }
 
 xi_hashtb_idx_t *xi_hashtb_next(xi_hashtb_idx_t *hidx) {
-	hidx->curr = hidx->next;
-	while (!hidx->curr) {
-		if (hidx->index > hidx->ht->max) {
-			return NULL;
+	xg_hashtb_arr_t *arr;
+
+	for (; hidx->arr < 2; hidx->arr++, hidx->index = 0) {
+		arr = (hidx->arr == 0) ? &hidx->ht->cur : &hidx->ht->old;
+		while (hidx->index < arr->cap) {
+			if (XG_HASHTB_FULL(arr->ctrl[hidx->index])) {
+				hidx->curr = &arr->slots[hidx->index++];
+				return hidx;
+			}
+			hidx->index++;
 		}
-		hidx->curr = hidx->ht->array[hidx->index++];
 	}
-	hidx->next = hidx->curr->next;
-	return hidx;
+	hidx->curr = NULL;
+	return NULL;
 }
 
 xvoid xi_hashtb_this(xi_hashtb_idx_t *hidx, const xvoid **key, xint32 *klen,
@@ -258,54 +526,41 @@ xvoid xi_hashtb_this(xi_hashtb_idx_t *hidx, const xvoid **key, xint32 *klen,
 }
 
 xvoid xi_hashtb_clear(xi_hashtb_t *htb) {
-	xi_hashtb_idx_t *hidx;
-	for (hidx = xi_hashtb_first(htb); hidx; hidx = xi_hashtb_next(hidx)) {
-		xi_hashtb_set(htb, hidx->curr->key, hidx->curr->klen, NULL);
-	}
+	xg_hashtb_free_array(&htb->old);
+	htb->migrated = 0;
+	xi_mem_set(htb->cur.ctrl, XG_HASHTB_EMPTY, htb->cur.cap);
+	htb->cur.used = 0;
+	htb->cur.count = 0;
 }
 
 xi_hashtb_t *xi_hashtb_clone(xi_hashtb_t *htb) {
 	xi_hashtb_t *newtb;
-	xg_hashtb_entry_t *new_vals;
-	xuint32 i, j;
-
-	newtb = xi_mem_alloc(
-			sizeof(xi_hashtb_t) + sizeof(*newtb->array) * (htb->max + 1)
-					+ sizeof(xg_hashtb_entry_t) * htb->count);
-	newtb->free = NULL;
-	newtb->count = htb->count;
-	newtb->max = htb->max;
+	xuint32 cap = XG_HASHTB_INIT_CAP;
+
+	newtb = xi_mem_calloc(1, sizeof(xi_hashtb_t));
+	if (newtb == NULL) {
+		return NULL;
+	}
+	while (XG_HASHTB_LIMIT(cap) <= xi_hashtb_count(htb)) {
+		cap <<= 1;
+	}
+	if (!xg_hashtb_alloc_array(&newtb->cur, cap)) {
+		xi_mem_free(newtb);
+		return NULL;
+	}
 	newtb->seed = htb->seed;
 	newtb->hash_func = htb->hash_func;
-	newtb->array
-			= (xg_hashtb_entry_t **) ((char *) newtb + sizeof(xi_hashtb_t));
-
-	new_vals = (xg_hashtb_entry_t *) ((char *) (newtb) + sizeof(xi_hashtb_t)
-			+ sizeof(*newtb->array) * (htb->max + 1));
-	for (i = 0, j = 0; i <= newtb->max; i++) {
-		xg_hashtb_entry_t **new_entry = &(newtb->array[i]);
-		xg_hashtb_entry_t *orig_entry = htb->array[i];
-		while (orig_entry) {
-			*new_entry = &new_vals[j++];
-			(*new_entry)->hashid = orig_entry->hashid;
-			(*new_entry)->key = orig_entry->key;
-			(*new_entry)->klen = orig_entry->klen;
-			(*new_entry)->val = orig_entry->val;
-			new_entry = &((*new_entry)->next);
-			orig_entry = orig_entry->next;
-		}
-		*new_entry = NULL;
-	}
+
+	// the resizing one is cloned as a whole
+	xg_hashtb_copy_array(&newtb->cur, &htb->cur);
+	xg_hashtb_copy_array(&newtb->cur, &htb->old);
 	return newtb;
 }
 
 xvoid xi_hashtb_destroy(xi_hashtb_t *ht) {
 	if (ht) {
-		if (ht->array) {
-			xi_mem_free(ht->array);
-		}
-		if (ht->free) {
-			xi_mem_free(ht->free);
-		}
+		xg_hashtb_free_array(&ht->cur);
+		xg_hashtb_free_array(&ht->old);
+		xi_mem_free(ht);
 	}
 }
@@ -0,0 +1,33 @@
+/*
+ * Copyright 2013 Cheolmin Jo (webos21@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * File   : xg_hashtb.h
+ */
+
+#ifndef _XG_HASHTB_H_
+#define _XG_HASHTB_H_
+
+#include "xi/xi_hashtb.h"
+
+// the hashing shared by xi_hashtb and xi_hashtb_conc (xg_hashtb.c)
+_XI_API_INTERN xuint64 xg_hashtb_mix(xuint64 a, xuint64 b);
+_XI_API_INTERN xuint64 xg_hashtb_hash64(const xvoid *key, xsize len, xuint64 seed);
+_XI_API_INTERN xuint64 xg_hashtb_hash(xi_hashtb_keygen func, xuint64 seed,
+		const xvoid *key, xint32 *klen);
+_XI_API_INTERN xuint64 xg_hashtb_seed(const xvoid *salt);
+
+#endif // _XG_HASHTB_H_
@@ -0,0 +1,460 @@
+/*
+ * Copyright 2013 Cheolmin Jo (webos21@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * File : xg_hashtb_conc.c
+ */
+
+#include "xg_hashtb.h"
+
+#include "xi/xi_atomic.h"
+#include "xi/xi_mem.h"
+#include "xi/xi_thread.h"
+
+// ----------------------------------------------
+// Inner Structures
+// ----------------------------------------------
+
+/*
+ * The buckets are the chains of the nodes, which are linked and unlinked
+ * by the writers under the lock of their stripe. The readers follow
+ * the chains without any lock, so a node is never changed but its value,
+ * and the resize copies the nodes into a new array instead of relinking them.
+ *
+ * A reader counts itself on one of the striped counters of the current
+ * epoch parity. The unlinked nodes wait on a list until the epoch is flipped
+ * and the counters of the old parity drop to zero, and then they are freed.
+ * Nobody waits for that : the lists are checked by the next writers.
+ */
+
+#define XG_HCONC_INIT_CAP  16  // XXX : tunable == 2^n >= XG_HCONC_STRIPES
+#define XG_HCONC_STRIPES   16  // the locks of the writers
+#define XG_HCONC_READERS   16  // the counters of the readers, 2^n
+#define XG_HCONC_RETIRE    64  // the unlinked ones to start a grace period
+#define XG_HCONC_CACHELINE 64
+
+// the head of a node and an array, for the list to be freed
+typedef struct _xg_hconc_obj {
+	struct _xg_hconc_obj *dead;
+} xg_hconc_obj_t;
+
+typedef struct _xg_hconc_node {
+	xg_hconc_obj_t obj;
+	struct _xg_hconc_node *volatile next;
+	const xvoid *volatile val;
+	xuint64 hash;
+	xint32 klen;
+	// the copy of the key follows
+} xg_hconc_node_t;
+
+typedef struct _xg_hconc_arr {
+	xg_hconc_obj_t obj;
+	xuint32 mask;
+	xg_hconc_node_t *volatile heads[1];
+} xg_hconc_arr_t;
+
+typedef struct _xg_hconc_reader {
+	volatile xuint32 cnt[2];
+	xchar pad[XG_HCONC_CACHELINE - sizeof(xuint32) * 2];
+} xg_hconc_reader_t;
+
+struct _xi_hashtb_conc {
+	xg_hconc_reader_t readers[XG_HCONC_READERS];
+	xg_hconc_arr_t *volatile arr;
+	volatile xuint32 count;
+	volatile xuint32 epoch;
+	xuint64 seed;
+	xi_hashtb_keygen hash_func;
+	xi_thread_mutex_t locks[XG_HCONC_STRIPES];
+	xi_thread_mutex_t rlock;  // for the lists below
+	xg_hconc_obj_t *pending;  // unlinked, before the grace period
+	xuint32 npending;
+	xg_hconc_obj_t *volatile waiting; // unlinked, in the grace period
+	xuint32 wait_idx;         // the epoch parity which the waiting ones wait
+};
+
+#define XG_HCONC_KEY(n)  ((const xvoid *) ((n) + 1))
+
+// ----------------------------------------------
+// Part Internal Functions
+// ----------------------------------------------
+
+// start a lookup : the ticket of the counter taken
+static xuint32 xg_hconc_enter(xi_hashtb_conc_t *htb) {
+	xuint32 slot, idx;
+	xuintptr stack = (xuintptr) &slot;
+
+	// the stacks of the threads are far apart
+	slot = (xuint32) ((stack >> 12) ^ (stack >> 20)) & (XG_HCONC_READERS - 1);
+	for (;;) {
+		idx = xi_atomic_read32(&htb->epoch) & 1;
+		xi_atomic_inc32(&htb->readers[slot].cnt[idx]);
+		// flipped before being counted : count on the new side
+		if ((xi_atomic_read32(&htb->epoch) & 1) == idx) {
+			break;
+		}
+		xi_atomic_dec32(&htb->readers[slot].cnt[idx]);
+	}
+	return (slot << 1) | idx;
+}
+
+static xvoid xg_hconc_leave(xi_hashtb_conc_t *htb, xuint32 ticket) {
+	xi_atomic_dec32(&htb->readers[ticket >> 1].cnt[ticket & 1]);
+}
+
+static xuint32 xg_hconc_readers(xi_hashtb_conc_t *htb, xuint32 idx) {
+	xuint32 i, sum = 0;
+
+	for (i = 0; i < XG_HCONC_READERS; i++) {
+		sum += xi_atomic_read32(&htb->readers[i].cnt[idx]);
+	}
+	return sum;
+}
+
+static xvoid xg_hconc_free_list(xg_hconc_obj_t *obj) {
+	xg_hconc_obj_t *dead;
+
+	while (obj != NULL) {
+		dead = obj->dead;
+		xi_mem_free(obj);
+		obj = dead;
+	}
+}
+
+/*
+ * Put the unlinked ones (head ... tail) on the pending list,
+ * and free the ones whose grace period is over.
+ */
+static xvoid xg_hconc_retire(xi_hashtb_conc_t *htb, xg_hconc_obj_t *head,
+		xg_hconc_obj_t *tail, xuint32 n) {
+	xg_hconc_obj_t *done = NULL, *obj;
+
+	xi_thread_mutex_lock(&htb->rlock);
+	if (head != NULL) {
+		tail->dead = htb->pending;
+		htb->pending = head;
+		htb->npending += n;
+	}
+	for (;;) {
+		if (htb->waiting != NULL) {
+			if (xg_hconc_readers(htb, htb->wait_idx) != 0) {
+				break;
+			}
+			while (htb->waiting != NULL) {
+				obj = htb->waiting;
+				htb->waiting = obj->dead;
+				obj->dead = done;
+				done = obj;
+			}
+		}
+		if (htb->npending < XG_HCONC_RETIRE) {
+			break;
+		}
+		// the new readers count on the other side from now on
+		htb->waiting = htb->pending;
+		htb->pending = NULL;
+		htb->npending = 0;
+		htb->wait_idx = xi_atomic_inc32(&htb->epoch) & 1;
+	}
+	xi_thread_mutex_unlock(&htb->rlock);
+
+	xg_hconc_free_list(done);
+}
+
+static xg_hconc_arr_t *xg_hconc_alloc_array(xuint32 cap) {
+	xg_hconc_arr_t *arr;
+
+	arr = xi_mem_calloc(1, sizeof(xg_hconc_arr_t)
+			+ sizeof(xg_hconc_node_t *) * (cap - 1));
+	if (arr != NULL) {
+		arr->mask = cap - 1;
+	}
+	return arr;
+}
+
+static xg_hconc_node_t *xg_hconc_alloc_node(const xvoid *key, xint32 klen,
+		xuint64 hash, const xvoid *val) {
+	xg_hconc_node_t *n;
+
+	n = xi_mem_alloc(sizeof(xg_hconc_node_t) + (xsize) klen);
+	if (n != NULL) {
+		n->obj.dead = NULL;
+		n->next = NULL;
+		n->val = val;
+		n->hash = hash;
+		n->klen = klen;
+		xi_mem_copy(n + 1, key, (xsize) klen);
+	}
+	return n;
+}
+
+// double the buckets, with all the stripes locked
+static xvoid xg_hconc_expand(xi_hashtb_conc_t *htb) {
+	xg_hconc_arr_t *old, *arr;
+	xg_hconc_node_t *n, *c;
+	xg_hconc_obj_t *head = NULL, *tail = NULL;
+	xuint32 i, b, ndead = 0;
+
+	for (i = 0; i < XG_HCONC_STRIPES; i++) {
+		xi_thread_mutex_lock(&htb->locks[i]);
+	}
+
+	old = htb->arr;
+	if (xi_atomic_read32(&htb->count) <= old->mask + 1) {
+		goto out; // done by another writer
+	}
+	arr = xg_hconc_alloc_array((old->mask + 1) * 2);
+	if (arr == NULL) {
+		goto out;
+	}
+
+	// the readers of the old array still follow the old chains
+	for (i = 0; i <= old->mask; i++) {
+		for (n = old->heads[i]; n != NULL; n = n->next) {
+			c = xg_hconc_alloc_node(XG_HCONC_KEY(n), n->klen, n->hash, n->val);
+			if (c == NULL) {
+				for (b = 0; b <= arr->mask; b++) {
+					while ((n = arr->heads[b]) != NULL) {
+						arr->heads[b] = n->next;
+						xi_mem_free(n);
+					}
+				}
+				xi_mem_free(arr);
+				goto out;
+			}
+			b = (xuint32) n->hash & arr->mask;
+			c->next = arr->heads[b];
+			arr->heads[b] = c;
+		}
+	}
+	xi_atomic_xchgptr((volatile xvoid **) &htb->arr, arr);
+
+	// retire the old nodes and the old array
+	tail = &old->obj;
+	head = tail;
+	ndead = 1;
+	for (i = 0; i <= old->mask; i++) {
+		for (n = old->heads[i]; n != NULL; n = n->next) {
+			n->obj.dead = head;
+			head = &n->obj;
+			ndead++;
+		}
+	}
+
+out:
+	for (i = XG_HCONC_STRIPES; i > 0; i--) {
+		xi_thread_mutex_unlock(&htb->locks[i - 1]);
+	}
+	if (head != NULL) {
+		xg_hconc_retire(htb, head, tail, ndead);
+	}
+}
+
+// ----------------------------------------------
+// XI Functions
+// ----------------------------------------------
+
+xi_hashtb_conc_t *xi_hashtb_conc_create(xi_hashtb_keygen func) {
+	xi_hashtb_conc_t *htb;
+	xuint32 i;
+
+	htb = xi_mem_calloc(1, sizeof(xi_hashtb_conc_t));
+	if (htb == NULL) {
+		return NULL;
+	}
+	htb->arr = xg_hconc_alloc_array(XG_HCONC_INIT_CAP);
+	if (htb->arr == NULL) {
+		xi_mem_free(htb);
+		return NULL;
+	}
+	for (i = 0; i < XG_HCONC_STRIPES; i++) {
+		if (xi_thread_mutex_create(&htb->locks[i], "xi_hashtb_conc")
+				!= XI_MUTEX_RV_OK) {
+			while (i > 0) {
+				xi_thread_mutex_destroy(&htb->locks[--i]);
+			}
+			xi_mem_free(htb->arr);
+			xi_mem_free(htb);
+			return NULL;
+		}
+	}
+	if (xi_thread_mutex_create(&htb->rlock, "xi_hashtb_conc") != XI_MUTEX_RV_OK) {
+		for (i = 0; i < XG_HCONC_STRIPES; i++) {
+			xi_thread_mutex_destroy(&htb->locks[i]);
+		}
+		xi_mem_free(htb->arr);
+		xi_mem_free(htb);
+		return NULL;
+	}
+	htb->seed = xg_hashtb_seed(htb);
+	htb->hash_func = func;
+
+	return htb;
+}
+
+xvoid xi_hashtb_conc_set(xi_hashtb_conc_t *htb, const xvoid *key, xint32 klen,
+		const xvoid *val) {
+	xi_thread_mutex_t *lock;
+	xg_hconc_arr_t *arr;
+	xg_hconc_node_t *volatile *pn;
+	xg_hconc_node_t *n, *dead = NULL;
+	xuint64 hash;
+	xbool grow = FALSE;
+
+	hash = xg_hashtb_hash(htb->hash_func, htb->seed, key, &klen);
+	lock = &htb->locks[(xuint32) hash & (XG_HCONC_STRIPES - 1)];
+
+	xi_thread_mutex_lock(lock);
+	// the array is not changed while a stripe is locked
+	arr = htb->arr;
+	for (pn = &arr->heads[(xuint32) hash & arr->mask]; (n = *pn) != NULL; pn
+			= &n->next) {
+		if (n->hash == hash && n->klen == klen
+				&& xi_mem_cmp(XG_HCONC_KEY(n), key, (xsize) klen) == 0) {
+			break;
+		}
+	}
+	if (n != NULL) {
+		if (val != NULL) {
+			// replace entry
+			xi_atomic_xchgptr((volatile xvoid **) &n->val, (xvoid *) val);
+		} else {
+			// delete entry : the readers on it still go on to its next
+			xi_atomic_xchgptr((volatile xvoid **) pn, n->next);
+			xi_atomic_dec32(&htb->count);
+			dead = n;
+		}
+	} else if (val != NULL) {
+		n = xg_hconc_alloc_node(key, klen, hash, val);
+		if (n != NULL) {
+			pn = &arr->heads[(xuint32) hash & arr->mask];
+			n->next = *pn;
+			xi_atomic_xchgptr((volatile xvoid **) pn, n);
+			grow = (xi_atomic_inc32(&htb->count) >= arr->mask + 1);
+		}
+	}
+	/* else key not present and val==NULL */
+	xi_thread_mutex_unlock(lock);
+
+	if (dead != NULL) {
+		xg_hconc_retire(htb, &dead->obj, &dead->obj, 1);
+	} else if (htb->waiting != NULL) {
+		xg_hconc_retire(htb, NULL, NULL, 0);
+	}
+	if (grow) {
+		xg_hconc_expand(htb);
+	}
+}
+
+xvoid *xi_hashtb_conc_get(xi_hashtb_conc_t *htb, const xvoid *key, xint32 klen) {
+	xg_hconc_arr_t *arr;
+	xg_hconc_node_t *n;
+	const xvoid *val = NULL;
+	xuint64 hash;
+	xuint32 ticket;
+
+	hash = xg_hashtb_hash(htb->hash_func, htb->seed, key, &klen);
+
+	ticket = xg_hconc_enter(htb);
+	arr = htb->arr;
+	for (n = arr->heads[(xuint32) hash & arr->mask]; n != NULL; n = n->next) {
+		if (n->hash == hash && n->klen == klen
+				&& xi_mem_cmp(XG_HCONC_KEY(n), key, (xsize) klen) == 0) {
+			val = n->val;
+			break;
+		}
+	}
+	xg_hconc_leave(htb, ticket);
+
+	return (xvoid *) val;
+}
+
+xuint32 xi_hashtb_conc_count(xi_hashtb_conc_t *htb) {
+	return xi_atomic_read32(&htb->count);
+}
+
+xi_hashtb_conc_idx_t *xi_hashtb_conc_first(xi_hashtb_conc_t *htb,
+		xi_hashtb_conc_idx_t *hidx) {
+	hidx->ht = htb;
+	hidx->slot = xg_hconc_enter(htb);
+	hidx->arr = htb->arr;
+	hidx->curr = NULL;
+	hidx->index = 0;
+	return xi_hashtb_conc_next(hidx);
+}
+
+xi_hashtb_conc_idx_t *xi_hashtb_conc_next(xi_hashtb_conc_idx_t *hidx) {
+	xg_hconc_arr_t *arr = hidx->arr;
+	xg_hconc_node_t *n;
+
+	n = (hidx->curr != NULL) ? ((xg_hconc_node_t *) hidx->curr)->next : NULL;
+	while (n == NULL) {
+		if (hidx->index > arr->mask) {
+			xi_hashtb_conc_done(hidx);
+			return NULL;
+		}
+		n = arr->heads[hidx->index++];
+	}
+	hidx->curr = n;
+	return hidx;
+}
+
+xvoid xi_hashtb_conc_this(xi_hashtb_conc_idx_t *hidx, const xvoid **key,
+		xint32 *klen, xvoid **val) {
+	xg_hconc_node_t *n = hidx->curr;
+
+	if (key) {
+		*key = XG_HCONC_KEY(n);
+	}
+	if (klen) {
+		*klen = n->klen;
+	}
+	if (val) {
+		*val = (xvoid *) n->val;
+	}
+}
+
+xvoid xi_hashtb_conc_done(xi_hashtb_conc_idx_t *hidx) {
+	if (hidx->ht != NULL) {
+		xg_hconc_leave(hidx->ht, hidx->slot);
+		hidx->ht = NULL;
+		hidx->curr = NULL;
+	}
+}
+
+xvoid xi_hashtb_conc_destroy(xi_hashtb_conc_t *htb) {
+	xg_hconc_node_t *n;
+	xuint32 i;
+
+	if (htb == NULL) {
+		return;
+	}
+
+	for (i = 0; i <= htb->arr->mask; i++) {
+		while ((n = htb->arr->heads[i]) != NULL) {
+			htb->arr->heads[i] = n->next;
+			xi_mem_free(n);
+		}
+	}
+	xi_mem_free(htb->arr);
+	xg_hconc_free_list(htb->pending);
+	xg_hconc_free_list(htb->waiting);
+	for (i = 0; i < XG_HCONC_STRIPES; i++) {
+		xi_thread_mutex_destroy(&htb->locks[i]);
+	}
+	xi_thread_mutex_destroy(&htb->rlock);
+	xi_mem_free(htb);
+}
@@ -27,10 +27,57 @@
 
 #include "xi/xi_log.h"
 
+#include "xi/xi_atomic.h"
 #include "xi/xi_mem.h"
 #include "xi/xi_string.h"
 #include "xi/xi_clock.h"
 #include "xi/xi_file.h"
+#include "xi/xi_thread.h"
+
+// ----------------------------------------------
+// Definitions
+// ----------------------------------------------
+
+#define XG_LOG_ASYNC_DEF    1024   // slots of the ring
+#define XG_LOG_ASYNC_BATCH  64     // slots of a writev
+#define XG_LOG_ASYNC_IDLE   100    // msecs of the writer to sleep
+
+#define XG_LOG_BIN_MAGIC    "XILOGBIN"
+#define XG_LOG_BIN_VERSION  1
+#define XG_LOG_BIN_ORDER    0x01020304
+#define XG_LOG_BIN_SEEN     4096   // entries of the table of the recorded strings
+#define XG_LOG_BIN_PROBE    16     // probes of the table before recording again
+#define XG_LOG_BIN_RDBUF    (128 * 1024)
+#define XG_LOG_BIN_WRBUF    (64 * 1024)
+
+#define XG_LOG_BIN_OFF      0
+#define XG_LOG_BIN_BUSY     1      // starting or stopping
+#define XG_LOG_BIN_ON       2
+
+#define XG_LOG_REC_STR      'S'    // a string, whose key is its pointer
+#define XG_LOG_REC_LOG      'L'    // a log, with the keys of its strings
+
+#define XG_LOG_OPT_DATE     0x01
+#define XG_LOG_OPT_FILE     0x02
+#define XG_LOG_OPT_FUNC     0x04
+#define XG_LOG_OPT_LINE     0x08
+
+// the length modifiers of a conversion
+enum {
+	XG_LOG_LMOD_NONE = 0,
+	XG_LOG_LMOD_HH,
+	XG_LOG_LMOD_H,
+	XG_LOG_LMOD_L,
+	XG_LOG_LMOD_LL,
+	XG_LOG_LMOD_J,
+	XG_LOG_LMOD_Z,
+	XG_LOG_LMOD_T,
+	XG_LOG_LMOD_LD
+};
+
+// the precision of a conversion, which is not a literal
+#define XG_LOG_PREC_NONE    (-1)
+#define XG_LOG_PREC_STAR    (-2)   // the last '*' argument
 
 // ----------------------------------------------
 // Inner Structures
@@ -41,32 +88,149 @@ struct _st_logger {
 	xi_logopt_t lopt;
 };
 
+/**
+ * A slot of the ring (bounded MPSC queue)
+ * seq == pos     : empty, and the producer of pos may take it
+ * seq == pos + 1 : filled, and the writer may write it
+ */
+typedef struct _st_log_slot {
+	volatile xuint32 seq;
+	xuint32 len;
+	xuint32 bin;   // a record of the binary mode
+	xchar line[XI_LOG_LINE_MAX];
+} xg_log_slot_t;
+
+typedef struct _st_log_async {
+	xg_log_slot_t *slots;
+	xuint32 mask;
+	xi_log_overflow_e overflow;
+	volatile xuint32 dropped;
+
+	// the producers
+	volatile xuint32 enq;
+	xchar pad[60];
+
+	// the writer
+	volatile xuint32 deq;
+	volatile xuint32 sleeping;
+	volatile xuint32 running;
+	volatile xuint32 stopped;
+	xi_thread_mutex_t lock;
+	xi_thread_cond_t cond;
+} xg_log_async_t;
+
+/**
+ * The header of a file of the binary mode
+ */
+typedef struct _st_log_bin_head {
+	xchar magic[8];   // XG_LOG_BIN_MAGIC
+	xuint32 version;  // XG_LOG_BIN_VERSION
+	xuint32 order;    // XG_LOG_BIN_ORDER in the byte order of the writer
+	xuint32 ptrsize;  // sizeof(xvoid *) of the writer
+	xuint32 recsize;  // sizeof(xg_log_rec_t) of the writer
+	xint64 msec;      // xi_clock_msec at the start
+	xint64 ntick;     // xi_clock_ntick at the start
+} xg_log_bin_head_t;
+
+/**
+ * The header of a record, which is followed by
+ * - XG_LOG_REC_STR : the string with '\0'
+ * - XG_LOG_REC_LOG : the arguments in the order of the format
+ *   ('*' and %c : xint32, the integers and %p : xint64, the floats : double,
+ *    %s : xuint16 length (0xFFFF : NULL) and the bytes)
+ */
+typedef struct _st_log_rec {
+	xuint16 len;      // bytes of the whole record
+	xuint8 type;      // XG_LOG_REC_*
+	xuint8 level;     // xi_log_level_e of a log
+	xuint8 opts;      // XG_LOG_OPT_* of a log
+	xuint8 rsv[3];
+	xuint32 line;     // line of a log
+	xuint32 rsv2;
+	xint64 ntick;     // xi_clock_ntick of a log
+	xuint64 fmt;      // the format of a log, or the key of a string
+	xuint64 file;     // the file of a log
+	xuint64 func;     // the function of a log
+} xg_log_rec_t;
+
+/**
+ * A conversion of a format : %[flags][width][.precision][length]conv
+ */
+typedef struct _st_log_spec {
+	const xchar *beg;   // '%'
+	const xchar *lmod;  // the length modifier, or conv if none
+	xint32 lmodk;       // XG_LOG_LMOD_*
+	xint32 stars;       // '*' of the width and the precision
+	xint32 prec;        // the precision, or XG_LOG_PREC_*
+	xchar conv;
+} xg_log_spec_t;
+
+/**
+ * The strings of the decoder : an open addressing table
+ */
+typedef struct _st_log_bin_dict {
+	xuint64 *keys;
+	xchar **strs;
+	xuint32 mask;
+	xuint32 count;
+} xg_log_bin_dict_t;
+
+/**
+ * The buffered reader of the decoder
+ */
+typedef struct _st_log_bin_rd {
+	xint32 fd;
+	xchar *buf;
+	xsize pos;
+	xsize end;
+} xg_log_bin_rd_t;
+
 // ----------------------------------------------
 // Global Variables
 // ----------------------------------------------
 
 static xi_logger_t _g_logger_list[XI_LOG_INST_MAX];
 static xi_logger_id_t _g_logger_ids[XI_LOG_INST_MAX];
-static xint32 _g_logger_count = 0;
+static volatile xuint32 _g_logger_count = 0;
+static volatile xuint32 _g_logger_lock = 0;
 static xi_logger_t *_g_logger_def = NULL;
 static xi_log_fn _g_log_fn = NULL;
 
+static volatile xvoid *_g_log_async = NULL;
+static volatile xuint32 _g_log_users = 0;
+
+static volatile xuint32 _g_log_bin = XG_LOG_BIN_OFF;
+static xint32 _g_log_bin_fd = -1;
+static volatile xvoid *_g_log_bin_seen[XG_LOG_BIN_SEEN];
+
+static const xchar *_g_log_level_str[] = { "ALL", "TRACE", "DEBUG", "INFO",
+		"WARN", "ERROR", "FATAL", "PRINT", "OFF" };
+
 // ----------------------------------------------
 // Part Internal Functions
 // ----------------------------------------------
 
+static xvoid xg_logger_lock() {
+	while (xi_atomic_cas32(&_g_logger_lock, 1, 0) != 0) {
+		xi_thread_yield();
+	}
+}
+
+static xvoid xg_logger_unlock() {
+	xi_atomic_xchg32(&_g_logger_lock, 0);
+}
+
 static xint32 xg_logger_find(const xvoid *key) {
 	xint32 i;
-	xbool found = FALSE;
+	xint32 count = (xint32) xi_atomic_read32(&_g_logger_count);
 
-	for (i = 0; i < _g_logger_count; i++) {
+	for (i = 0; i < count; i++) {
 		if (xi_strcmp(key, _g_logger_list[i].id) == 0) {
-			found = TRUE;
-			break;
+			return i;
 		}
 	}
 
-	return (found ? i : -1);
+	return -1;
 }
 
 static xvoid xg_logger_set_optdef(xi_logopt_t *opt) {
@@ -77,14 +241,970 @@ static xvoid xg_logger_set_optdef(xi_logopt_t *opt) {
 	opt->showLine = TRUE;
 }
 
-static xvoid xg_logger_write_def(const xchar *msg) {
+// the offset after appending ret bytes, which may be truncated or failed
+static xsize xg_logger_advance(xsize off, xint32 ret, xsize buflen) {
+	if (ret < 0 || (off + ret) >= buflen) {
+		return buflen - 1;
+	}
+	return off + ret;
+}
+
+// append '|' and str, without formatting
+static xsize xg_logger_append(xchar *buf, xsize off, xsize buflen,
+		const xchar *str) {
+	xsize len = xi_strlen(str);
+
+	if (off + 1 + len >= buflen) {
+		len = (off + 1 >= buflen - 1) ? 0 : (buflen - 2 - off);
+	}
+	if (off + 1 < buflen) {
+		buf[off++] = '|';
+	}
+	xi_mem_copy(buf + off, str, len);
+
+	return off + len;
+}
+
+/**
+ * Put the decoration of a log into buf
+ * : LEVEL|date|file|function|line|
+ *
+ * when is the time of the log, or NULL for now
+ */
+static xsize xg_logger_prefix(xchar *buf, xsize buflen, const xi_logopt_t *lopt,
+		xi_log_level_e level, const xi_time_t *when, const xchar *fname,
+		const xchar *function, xuint32 line) {
+	xsize off = 0;
+
+	if (level != XI_LOG_LEVEL_PRINT) {
+		// the level names are far shorter than any buffer
+		off = xi_strlen(_g_log_level_str[level]);
+		xi_mem_copy(buf, _g_log_level_str[level], off);
+
+		if (lopt->showDate == TRUE) {
+			xi_time_t now;
+
+			if (when == NULL) {
+				xi_clock_gettime(&now);
+				when = &now;
+			}
+			off = xg_logger_advance(off, xi_snprintf(buf + off, buflen - off,
+					"|%d-%02d-%02d %02d:%02d:%02d.%03d", when->year, when->mon,
+					when->day, when->hour, when->min, when->sec, when->msec),
+					buflen);
+		}
+		if (lopt->showFile == TRUE) {
+			off = xg_logger_append(buf, off, buflen, xi_pathname_basename(fname));
+		}
+		if (lopt->showFunc == TRUE) {
+			off = xg_logger_append(buf, off, buflen, function);
+		}
+		if (lopt->showLine == TRUE) {
+			xchar lstr[12];
+			xint32 i = (xint32) sizeof(lstr) - 1;
+
+			// %05u
+			lstr[i] = '\0';
+			do {
+				lstr[--i] = (xchar) ('0' + (line % 10));
+				line /= 10;
+			} while (line > 0 || i > (xint32) sizeof(lstr) - 6);
+			off = xg_logger_append(buf, off, buflen, lstr + i);
+		}
+		off = xg_logger_append(buf, off, buflen, "");
+	}
+
+	return off;
+}
+
+/**
+ * Format a log into buf by one pass
+ * : LEVEL|date|file|function|line|message
+ */
+static xsize xg_logger_format(xchar *buf, xsize buflen, xi_logger_t *rlog,
+		xi_log_level_e level, const xchar *fname, const xchar *function,
+		xuint32 line, const xchar *format, va_list va) {
+	xsize off;
+
+	off = xg_logger_prefix(buf, buflen, &rlog->lopt, level, NULL, fname,
+			function, line);
+	off = xg_logger_advance(off, vsnprintf(buf + off, buflen - off, format, va),
+			buflen);
+	buf[off] = '\0';
+
+	return off;
+}
+
+static xvoid xg_logger_write_def(const xchar *msg, xsize len) {
 	static xint32 deffd = -1;
 
 	if (deffd < 0) {
 		deffd = xi_file_get_stdout();
 	}
 
-	xi_file_write(deffd, msg, xi_strlen(msg));
+	xi_file_write(deffd, msg, len);
+}
+
+static xvoid xg_logger_async_wake(xg_log_async_t *alog) {
+	xi_thread_mutex_lock(&alog->lock);
+	xi_thread_cond_signal(&alog->cond);
+	xi_thread_mutex_unlock(&alog->lock);
+}
+
+// take a slot to fill, or NULL if dropped
+static xg_log_slot_t *xg_logger_async_take(xg_log_async_t *alog,
+		xuint32 *ppos) {
+	xuint32 pos;
+	xint32 dif;
+	xg_log_slot_t *slot;
+
+	pos = xi_atomic_read32(&alog->enq);
+	for (;;) {
+		slot = &alog->slots[pos & alog->mask];
+		dif = (xint32) (xi_atomic_read32(&slot->seq) - pos);
+		if (dif == 0) {
+			if (xi_atomic_cas32(&alog->enq, pos + 1, pos) == pos) {
+				break;
+			}
+		} else if (dif < 0) {
+			// the writer has not written this slot of the last round
+			if (alog->overflow == XI_LOG_OVERFLOW_DROP) {
+				xi_atomic_inc32(&alog->dropped);
+				return NULL;
+			}
+			xg_logger_async_wake(alog);
+			xi_thread_yield();
+		}
+		pos = xi_atomic_read32(&alog->enq);
+	}
+
+	*ppos = pos;
+	return slot;
+}
+
+// hand a filled slot to the writer
+static xvoid xg_logger_async_give(xg_log_async_t *alog, xg_log_slot_t *slot,
+		xuint32 pos) {
+	xi_atomic_xchg32(&slot->seq, pos + 1);
+
+	// only the first one after the writer falls asleep pays the signal
+	if (xi_atomic_read32(&alog->sleeping)
+			&& xi_atomic_xchg32(&alog->sleeping, 0)) {
+		xg_logger_async_wake(alog);
+	}
+}
+
+static xvoid xg_logger_async_put(xg_log_async_t *alog, xi_logger_t *rlog,
+		xi_log_level_e level, const xchar *fname, const xchar *function,
+		xuint32 line, const xchar *format, va_list va) {
+	xuint32 pos;
+	xg_log_slot_t *slot;
+
+	slot = xg_logger_async_take(alog, &pos);
+	if (slot == NULL) {
+		return;
+	}
+	slot->len = (xuint32) xg_logger_format(slot->line, sizeof(slot->line),
+			rlog, level, fname, function, line, format, va);
+	slot->bin = FALSE;
+	xg_logger_async_give(alog, slot, pos);
+}
+
+static xvoid xg_logger_async_out(xi_file_iovec_t *iov, xint32 cnt, xbool bin) {
+	static xint32 deffd = -1;
+	xint32 i, fd;
+	xssize ret;
+
+	if (bin) {
+		// xi_logger_bin_stop closes it after the ring is flushed
+		fd = _g_log_bin_fd;
+	} else if (_g_log_fn != NULL) {
+		for (i = 0; i < cnt; i++) {
+			_g_log_fn(iov[i].iov_base);
+		}
+		return;
+	} else {
+		if (deffd < 0) {
+			deffd = xi_file_get_stdout();
+		}
+		fd = deffd;
+	}
+
+	ret = xi_file_writev(fd, iov, cnt);
+	if (ret < 0) {
+		return;
+	}
+	// the rest of a short write, one by one
+	for (i = 0; i < cnt; i++) {
+		if ((xsize) ret >= iov[i].iov_len) {
+			ret -= (xssize) iov[i].iov_len;
+			continue;
+		}
+		xi_file_write(fd, (xchar *) iov[i].iov_base + ret,
+				iov[i].iov_len - ret);
+		ret = 0;
+	}
+}
+
+static xvoid *xg_logger_async_main(xvoid *arg) {
+	xg_log_async_t *alog = arg;
+	xi_file_iovec_t iov[XG_LOG_ASYNC_BATCH];
+	xg_log_slot_t *slot;
+	xint32 i, cnt;
+	xbool bin = FALSE;
+
+	for (;;) {
+		for (cnt = 0; cnt < XG_LOG_ASYNC_BATCH; cnt++) {
+			slot = &alog->slots[(alog->deq + cnt) & alog->mask];
+			if (xi_atomic_read32(&slot->seq) != alog->deq + cnt + 1) {
+				break;
+			}
+			// a batch goes to one place
+			if (cnt > 0 && (xbool) slot->bin != bin) {
+				break;
+			}
+			bin = (xbool) slot->bin;
+			iov[cnt].iov_base = slot->line;
+			iov[cnt].iov_len = slot->len;
+		}
+
+		if (cnt > 0) {
+			xg_logger_async_out(iov, cnt, bin);
+			// give the slots back to the next round
+			for (i = 0; i < cnt; i++) {
+				slot = &alog->slots[(alog->deq + i) & alog->mask];
+				xi_atomic_xchg32(&slot->seq, alog->deq + i + alog->mask + 1);
+			}
+			alog->deq += cnt;
+			continue;
+		}
+
+		if (!xi_atomic_read32(&alog->running)) {
+			break;
+		}
+
+		xi_thread_mutex_lock(&alog->lock);
+		xi_atomic_xchg32(&alog->sleeping, 1);
+		// a producer may have filled it before seeing sleeping
+		slot = &alog->slots[alog->deq & alog->mask];
+		if (xi_atomic_read32(&slot->seq) != alog->deq + 1
+				&& xi_atomic_read32(&alog->running)) {
+			xi_thread_cond_timedwait(&alog->cond, &alog->lock,
+					XG_LOG_ASYNC_IDLE);
+		}
+		xi_atomic_xchg32(&alog->sleeping, 0);
+		xi_thread_mutex_unlock(&alog->lock);
+	}
+
+	xi_atomic_xchg32(&alog->stopped, 1);
+	return NULL;
+}
+
+static xbool xg_logger_isflag(xchar c) {
+	return (c == '-' || c == '+' || c == ' ' || c == '#' || c == '0'
+			|| c == '\'');
+}
+
+static const xchar *xg_logger_digits(const xchar *p) {
+	while (*p >= '0' && *p <= '9') {
+		p++;
+	}
+	return p;
+}
+
+/**
+ * Parse the next conversion of a format into spec
+ * : the next of the conversion, or NULL at the end
+ */
+static const xchar *xg_logger_spec(const xchar *p, xg_log_spec_t *spec) {
+	for (;;) {
+		while (*p != '\0' && *p != '%') {
+			p++;
+		}
+		if (*p == '\0') {
+			return NULL;
+		}
+		if (p[1] != '%') {
+			break;
+		}
+		p += 2;
+	}
+
+	spec->beg = p++;
+	spec->stars = 0;
+	spec->prec = XG_LOG_PREC_NONE;
+	while (xg_logger_isflag(*p)) {
+		p++;
+	}
+	if (*p == '*') {
+		spec->stars++;
+		p++;
+	} else {
+		p = xg_logger_digits(p);
+	}
+	if (*p == '.') {
+		p++;
+		if (*p == '*') {
+			spec->stars++;
+			spec->prec = XG_LOG_PREC_STAR;
+			p++;
+		} else {
+			spec->prec = xi_strtoi(p, NULL, 10);
+			p = xg_logger_digits(p);
+		}
+	}
+
+	spec->lmod = p;
+	switch (*p) {
+	case 'h':
+		spec->lmodk = (p[1] == 'h') ? XG_LOG_LMOD_HH : XG_LOG_LMOD_H;
+		break;
+	case 'l':
+		spec->lmodk = (p[1] == 'l') ? XG_LOG_LMOD_LL : XG_LOG_LMOD_L;
+		break;
+	case 'q':
+		spec->lmodk = XG_LOG_LMOD_LL;
+		break;
+	case 'j':
+		spec->lmodk = XG_LOG_LMOD_J;
+		break;
+	case 'z':
+		spec->lmodk = XG_LOG_LMOD_Z;
+		break;
+	case 't':
+		spec->lmodk = XG_LOG_LMOD_T;
+		break;
+	case 'L':
+		spec->lmodk = XG_LOG_LMOD_LD;
+		break;
+	default:
+		spec->lmodk = XG_LOG_LMOD_NONE;
+		break;
+	}
+	if (spec->lmodk == XG_LOG_LMOD_HH || (spec->lmodk == XG_LOG_LMOD_LL
+			&& *p == 'l')) {
+		p += 2;
+	} else if (spec->lmodk != XG_LOG_LMOD_NONE) {
+		p++;
+	}
+
+	spec->conv = *p;
+	if (*p == '\0') {
+		return NULL;
+	}
+	return p + 1;
+}
+
+// put n bytes of v at *off, FALSE if no room
+static xbool xg_logger_bin_arg(xchar *buf, xsize *off, xsize buflen,
+		const xvoid *v, xsize n) {
+	if (*off + n > buflen) {
+		return FALSE;
+	}
+	xi_mem_copy(buf + *off, v, n);
+	*off += n;
+	return TRUE;
+}
+
+/**
+ * Record a log into buf without formatting
+ * : xg_log_rec_t and the raw arguments
+ *
+ * The arguments which do not fit are left out, and so is the rest of them.
+ */
+static xsize xg_logger_bin_encode(xchar *buf, xsize buflen, xi_logger_t *rlog,
+		xi_log_level_e level, const xchar *fname, const xchar *function,
+		xuint32 line, const xchar *format, va_list va) {
+	xg_log_rec_t rec;
+	xg_log_spec_t spec;
+	const xchar *p = format;
+	xsize off = sizeof(rec);
+	xint32 i, ival, prec;
+	xint64 lval;
+	double dval;
+	const xchar *sval;
+	xuint16 slen;
+	xbool room = TRUE;
+
+	while (room && (p = xg_logger_spec(p, &spec)) != NULL) {
+		prec = spec.prec;
+		for (i = 0; room && i < spec.stars; i++) {
+			ival = va_arg(va, xint32);
+			room = xg_logger_bin_arg(buf, &off, buflen, &ival, sizeof(ival));
+		}
+		if (!room) {
+			break;
+		}
+		if (prec == XG_LOG_PREC_STAR) {
+			// a negative one is taken as if omitted
+			prec = (ival < 0) ? XG_LOG_PREC_NONE : ival;
+		}
+
+		switch (spec.conv) {
+		case 'd':
+		case 'i':
+			switch (spec.lmodk) {
+			case XG_LOG_LMOD_HH:
+				lval = (signed char) va_arg(va, xint32);
+				break;
+			case XG_LOG_LMOD_H:
+				lval = (short) va_arg(va, xint32);
+				break;
+			case XG_LOG_LMOD_L:
+				lval = va_arg(va, long);
+				break;
+			case XG_LOG_LMOD_LL:
+			case XG_LOG_LMOD_J:
+				lval = va_arg(va, xint64);
+				break;
+			case XG_LOG_LMOD_Z:
+			case XG_LOG_LMOD_T:
+				lval = va_arg(va, xssize);
+				break;
+			default:
+				lval = va_arg(va, xint32);
+				break;
+			}
+			room = xg_logger_bin_arg(buf, &off, buflen, &lval, sizeof(lval));
+			break;
+		case 'u':
+		case 'o':
+		case 'x':
+		case 'X':
+			switch (spec.lmodk) {
+			case XG_LOG_LMOD_HH:
+				lval = (unsigned char) va_arg(va, xuint32);
+				break;
+			case XG_LOG_LMOD_H:
+				lval = (unsigned short) va_arg(va, xuint32);
+				break;
+			case XG_LOG_LMOD_L:
+				lval = (xint64) va_arg(va, unsigned long);
+				break;
+			case XG_LOG_LMOD_LL:
+			case XG_LOG_LMOD_J:
+				lval = (xint64) va_arg(va, xuint64);
+				break;
+			case XG_LOG_LMOD_Z:
+			case XG_LOG_LMOD_T:
+				lval = (xint64) va_arg(va, xsize);
+				break;
+			default:
+				lval = va_arg(va, xuint32);
+				break;
+			}
+			room = xg_logger_bin_arg(buf, &off, buflen, &lval, sizeof(lval));
+			break;
+		case 'c':
+			ival = va_arg(va, xint32);
+			room = xg_logger_bin_arg(buf, &off, buflen, &ival, sizeof(ival));
+			break;
+		case 'e':
+		case 'E':
+		case 'f':
+		case 'F':
+		case 'g':
+		case 'G':
+		case 'a':
+		case 'A':
+			if (spec.lmodk == XG_LOG_LMOD_LD) {
+				dval = (double) va_arg(va, long double);
+			} else {
+				dval = va_arg(va, double);
+			}
+			room = xg_logger_bin_arg(buf, &off, buflen, &dval, sizeof(dval));
+			break;
+		case 'p':
+			lval = (xint64) (xuintptr) va_arg(va, xvoid *);
+			room = xg_logger_bin_arg(buf, &off, buflen, &lval, sizeof(lval));
+			break;
+		case 's':
+			sval = va_arg(va, const xchar *);
+			if (spec.lmodk == XG_LOG_LMOD_L) {
+				// not the wide strings
+				sval = "(wide)";
+			}
+			if (sval == NULL) {
+				slen = 0xFFFF;
+			} else if (off + sizeof(slen) >= buflen) {
+				room = FALSE;
+				break;
+			} else {
+				// not beyond the precision, as the string may not end in it
+				lval = (xint64) (buflen - off - sizeof(slen));
+				if (lval > 0xFFFE) {
+					lval = 0xFFFE;
+				}
+				if (prec >= 0 && lval > prec) {
+					lval = prec;
+				}
+				slen = 0;
+				while (slen < lval && sval[slen] != '\0') {
+					slen++;
+				}
+			}
+			room = xg_logger_bin_arg(buf, &off, buflen, &slen, sizeof(slen));
+			if (room && slen != 0xFFFF) {
+				room = xg_logger_bin_arg(buf, &off, buflen, sval, slen);
+			}
+			break;
+		case 'n':
+			(xvoid) va_arg(va, xvoid *);
+			break;
+		default:
+			// unknown : the types of the rest are unknown, too
+			room = FALSE;
+			break;
+		}
+	}
+
+	xi_mem_set(&rec, 0, sizeof(rec));
+	rec.len = (xuint16) off;
+	rec.type = XG_LOG_REC_LOG;
+	rec.level = (xuint8) level;
+	rec.opts = (xuint8) (((rlog->lopt.showDate == TRUE) ? XG_LOG_OPT_DATE : 0)
+			| ((rlog->lopt.showFile == TRUE) ? XG_LOG_OPT_FILE : 0)
+			| ((rlog->lopt.showFunc == TRUE) ? XG_LOG_OPT_FUNC : 0)
+			| ((rlog->lopt.showLine == TRUE) ? XG_LOG_OPT_LINE : 0));
+	rec.line = line;
+	rec.ntick = xi_clock_ntick();
+	rec.fmt = (xuint64) (xuintptr) format;
+	rec.file = (xuint64) (xuintptr) fname;
+	rec.func = (xuint64) (xuintptr) function;
+	xi_mem_copy(buf, &rec, sizeof(rec));
+
+	return off;
+}
+
+// record a string into buf : xg_log_rec_t and the string
+static xsize xg_logger_bin_encode_str(xchar *buf, xsize buflen,
+		const xchar *str) {
+	xg_log_rec_t rec;
+	xsize len = xi_strlen(str);
+
+	if (sizeof(rec) + len + 1 > buflen) {
+		len = buflen - sizeof(rec) - 1;
+	}
+
+	xi_mem_set(&rec, 0, sizeof(rec));
+	rec.len = (xuint16) (sizeof(rec) + len + 1);
+	rec.type = XG_LOG_REC_STR;
+	rec.fmt = (xuint64) (xuintptr) str;
+	xi_mem_copy(buf, &rec, sizeof(rec));
+	xi_mem_copy(buf + sizeof(rec), str, len);
+	buf[sizeof(rec) + len] = '\0';
+
+	return rec.len;
+}
+
+/**
+ * Check whether str is recorded already, or mark it to be recorded now
+ * : TRUE if recorded, or FALSE with the marked entry (NULL : no room)
+ */
+static xbool xg_logger_bin_seen(const xchar *str, volatile xvoid ***entry) {
+	xuintptr hash = ((xuintptr) str >> 3) * 2654435761U;
+	xuint32 i, idx;
+	xvoid *cur;
+
+	for (i = 0; i < XG_LOG_BIN_PROBE; i++) {
+		idx = (xuint32) (hash + i) & (XG_LOG_BIN_SEEN - 1);
+		cur = (xvoid *) _g_log_bin_seen[idx];
+		if (cur == NULL) {
+			cur = xi_atomic_casptr(&_g_log_bin_seen[idx], (xvoid *) str, NULL);
+			if (cur == NULL) {
+				*entry = &_g_log_bin_seen[idx];
+				return FALSE;
+			}
+		}
+		if (cur == str) {
+			return TRUE;
+		}
+	}
+
+	*entry = NULL;
+	return FALSE;
+}
+
+// write a record of the sync mode, or put it into a slot of the async mode
+static xbool xg_logger_bin_str(xg_log_async_t *alog, const xchar *str) {
+	xuint32 pos;
+	xg_log_slot_t *slot;
+
+	if (alog != NULL) {
+		slot = xg_logger_async_take(alog, &pos);
+		if (slot == NULL) {
+			return FALSE;
+		}
+		slot->len = (xuint32) xg_logger_bin_encode_str(slot->line,
+				sizeof(slot->line), str);
+		slot->bin = TRUE;
+		xg_logger_async_give(alog, slot, pos);
+	} else {
+		xchar rec[XI_LOG_LINE_MAX];
+		xsize len;
+
+		len = xg_logger_bin_encode_str(rec, sizeof(rec), str);
+		xi_file_write(_g_log_bin_fd, rec, len);
+	}
+
+	return TRUE;
+}
+
+static xvoid xg_logger_bin_put(xg_log_async_t *alog, xi_logger_t *rlog,
+		xi_log_level_e level, const xchar *fname, const xchar *function,
+		xuint32 line, const xchar *format, va_list va) {
+	const xchar *strs[3];
+	volatile xvoid **entry;
+	xuint32 i, pos;
+	xg_log_slot_t *slot;
+
+	// the strings are recorded once, before the first log of them
+	strs[0] = format;
+	strs[1] = fname;
+	strs[2] = function;
+	for (i = 0; i < 3; i++) {
+		if (strs[i] != NULL && !xg_logger_bin_seen(strs[i], &entry)
+				&& !xg_logger_bin_str(alog, strs[i]) && entry != NULL) {
+			// dropped : record it next time
+			xi_atomic_casptr(entry, NULL, strs[i]);
+		}
+	}
+
+	if (alog != NULL) {
+		slot = xg_logger_async_take(alog, &pos);
+		if (slot == NULL) {
+			return;
+		}
+		slot->len = (xuint32) xg_logger_bin_encode(slot->line,
+				sizeof(slot->line), rlog, level, fname, function, line, format,
+				va);
+		slot->bin = TRUE;
+		xg_logger_async_give(alog, slot, pos);
+	} else {
+		xchar rec[XI_LOG_LINE_MAX];
+		xsize len;
+
+		len = xg_logger_bin_encode(rec, sizeof(rec), rlog, level, fname,
+				function, line, format, va);
+		xi_file_write(_g_log_bin_fd, rec, len);
+	}
+}
+
+static xbool xg_logger_bin_dict_init(xg_log_bin_dict_t *dict, xuint32 size) {
+	dict->keys = xi_mem_calloc(size, sizeof(xuint64));
+	dict->strs = xi_mem_calloc(size, sizeof(xchar *));
+	if (dict->keys == NULL || dict->strs == NULL) {
+		xi_mem_free(dict->keys);
+		xi_mem_free(dict->strs);
+		return FALSE;
+	}
+	dict->mask = size - 1;
+	dict->count = 0;
+	return TRUE;
+}
+
+static xvoid xg_logger_bin_dict_free(xg_log_bin_dict_t *dict) {
+	xuint32 i;
+
+	for (i = 0; i <= dict->mask; i++) {
+		xi_mem_free(dict->strs[i]);
+	}
+	xi_mem_free(dict->keys);
+	xi_mem_free(dict->strs);
+}
+
+static xuint32 xg_logger_bin_dict_idx(xg_log_bin_dict_t *dict, xuint64 key) {
+	xuint32 idx = (xuint32) ((key >> 3) * 2654435761U) & dict->mask;
+
+	// the keys of the recorded strings are not NULL
+	while (dict->keys[idx] != 0 && dict->keys[idx] != key) {
+		idx = (idx + 1) & dict->mask;
+	}
+	return idx;
+}
+
+static const xchar *xg_logger_bin_dict_get(xg_log_bin_dict_t *dict,
+		xuint64 key) {
+	return dict->strs[xg_logger_bin_dict_idx(dict, key)];
+}
+
+static xbool xg_logger_bin_dict_put(xg_log_bin_dict_t *dict, xuint64 key,
+		const xchar *str) {
+	xuint32 i, idx;
+	xsize len;
+
+	// grow at the half
+	if ((dict->count + 1) * 2 > dict->mask + 1) {
+		xg_log_bin_dict_t old = *dict;
+
+		if (!xg_logger_bin_dict_init(dict, (old.mask + 1) * 2)) {
+			*dict = old;
+			return FALSE;
+		}
+		for (i = 0; i <= old.mask; i++) {
+			if (old.keys[i] != 0) {
+				idx = xg_logger_bin_dict_idx(dict, old.keys[i]);
+				dict->keys[idx] = old.keys[i];
+				dict->strs[idx] = old.strs[i];
+				dict->count++;
+			}
+		}
+		xi_mem_free(old.keys);
+		xi_mem_free(old.strs);
+	}
+
+	idx = xg_logger_bin_dict_idx(dict, key);
+	if (dict->keys[idx] == key) {
+		// recorded again
+		return TRUE;
+	}
+	len = xi_strlen(str);
+	dict->strs[idx] = xi_mem_alloc(len + 1);
+	if (dict->strs[idx] == NULL) {
+		return FALSE;
+	}
+	xi_mem_copy(dict->strs[idx], str, len + 1);
+	dict->keys[idx] = key;
+	dict->count++;
+
+	return TRUE;
+}
+
+// the next record, or NULL at the end (or a broken one)
+static xchar *xg_logger_bin_next(xg_log_bin_rd_t *rd) {
+	xuint16 len;
+	xssize ret;
+	xchar *rec;
+
+	for (;;) {
+		if (rd->end - rd->pos >= sizeof(len)) {
+			xi_mem_copy(&len, rd->buf + rd->pos, sizeof(len));
+			if (len < sizeof(xg_log_rec_t)) {
+				return NULL;
+			}
+			if (rd->end - rd->pos >= len) {
+				rec = rd->buf + rd->pos;
+				rd->pos += len;
+				return rec;
+			}
+		}
+
+		xi_mem_move(rd->buf, rd->buf + rd->pos, rd->end - rd->pos);
+		rd->end -= rd->pos;
+		rd->pos = 0;
+		ret = xi_file_read(rd->fd, rd->buf + rd->end, XG_LOG_BIN_RDBUF - rd->end);
+		if (ret <= 0) {
+			return NULL;
+		}
+		rd->end += (xsize) ret;
+	}
+}
+
+// copy the literal [p, end) with "%%" as '%' (end == NULL : to '\0')
+static xsize xg_logger_bin_literal(xchar *buf, xsize off, xsize buflen,
+		const xchar *p, const xchar *end) {
+	while (*p != '\0' && p != end && off + 1 < buflen) {
+		if (p[0] == '%' && p[1] == '%') {
+			p++;
+		}
+		buf[off++] = *p++;
+	}
+	return off;
+}
+
+// take n bytes of the arguments, FALSE at the end
+static xbool xg_logger_bin_take(const xchar **arg, const xchar *aend,
+		xvoid *v, xsize n) {
+	if ((xsize) (aend - *arg) < n) {
+		return FALSE;
+	}
+	xi_mem_copy(v, *arg, n);
+	*arg += n;
+	return TRUE;
+}
+
+#define XG_LOG_BIN_PRINT(v) \
+	((spec.stars == 0) ? xi_snprintf(buf + off, buflen - off, sub, (v)) \
+	: (spec.stars == 1) ? xi_snprintf(buf + off, buflen - off, sub, stars[0], (v)) \
+	: xi_snprintf(buf + off, buflen - off, sub, stars[0], stars[1], (v)))
+
+/**
+ * Format the message of a log from its format and the recorded arguments,
+ * each conversion by xi_snprintf with the length modifier of the recorded type
+ */
+static xsize xg_logger_bin_message(xchar *buf, xsize off, xsize buflen,
+		const xchar *format, const xchar *arg, const xchar *aend) {
+	xg_log_spec_t spec;
+	const xchar *p = format;
+	const xchar *next;
+	xchar sub[64];
+	xchar str[XI_LOG_LINE_MAX];
+	xint32 i, ret, stars[2];
+	xint32 ival;
+	xint64 lval;
+	double dval;
+	xuint16 slen;
+	xsize slen_sub;
+
+	while ((next = xg_logger_spec(p, &spec)) != NULL) {
+		slen_sub = (xsize) (spec.lmod - spec.beg);
+		if (slen_sub + 5 > sizeof(sub)) {
+			break;
+		}
+		for (i = 0; i < spec.stars; i++) {
+			if (!xg_logger_bin_take(&arg, aend, &stars[i], sizeof(stars[i]))) {
+				break;
+			}
+		}
+		if (i < spec.stars) {
+			break;
+		}
+
+		off = xg_logger_bin_literal(buf, off, buflen, p, spec.beg);
+
+		// %[flags][width][.precision] and the new length modifier
+		xi_mem_copy(sub, spec.beg, slen_sub);
+		ret = 0;
+		switch (spec.conv) {
+		case 'd':
+		case 'i':
+		case 'u':
+		case 'o':
+		case 'x':
+		case 'X':
+		case 'p':
+			if (!xg_logger_bin_take(&arg, aend, &lval, sizeof(lval))) {
+				ret = -1;
+				break;
+			}
+			if (spec.conv == 'p' && (xint64) (xuintptr) lval == lval) {
+				// "(nil)" and the like of the text mode, too
+				sub[slen_sub++] = 'p';
+				sub[slen_sub] = '\0';
+				ret = XG_LOG_BIN_PRINT((xvoid *) (xuintptr) lval);
+				break;
+			}
+			if (spec.conv == 'p') {
+				// a pointer of a wider machine : "0x..."
+				sub[slen_sub++] = '#';
+			}
+			sub[slen_sub++] = 'l';
+			sub[slen_sub++] = 'l';
+			sub[slen_sub++] = (spec.conv == 'p') ? 'x' : spec.conv;
+			sub[slen_sub] = '\0';
+			ret = XG_LOG_BIN_PRINT(lval);
+			break;
+		case 'c':
+			if (!xg_logger_bin_take(&arg, aend, &ival, sizeof(ival))) {
+				ret = -1;
+				break;
+			}
+			sub[slen_sub++] = 'c';
+			sub[slen_sub] = '\0';
+			ret = XG_LOG_BIN_PRINT(ival);
+			break;
+		case 'e':
+		case 'E':
+		case 'f':
+		case 'F':
+		case 'g':
+		case 'G':
+		case 'a':
+		case 'A':
+			if (!xg_logger_bin_take(&arg, aend, &dval, sizeof(dval))) {
+				ret = -1;
+				break;
+			}
+			sub[slen_sub++] = spec.conv;
+			sub[slen_sub] = '\0';
+			ret = XG_LOG_BIN_PRINT(dval);
+			break;
+		case 's':
+			if (!xg_logger_bin_take(&arg, aend, &slen, sizeof(slen))) {
+				ret = -1;
+				break;
+			}
+			if (slen == 0xFFFF) {
+				xi_strcpy(str, "(null)");
+			} else {
+				if (slen >= sizeof(str)
+						|| !xg_logger_bin_take(&arg, aend, str, slen)) {
+					ret = -1;
+					break;
+				}
+				str[slen] = '\0';
+			}
+			sub[slen_sub++] = 's';
+			sub[slen_sub] = '\0';
+			ret = XG_LOG_BIN_PRINT(str);
+			break;
+		case 'n':
+			break;
+		default:
+			ret = -1;
+			break;
+		}
+		if (ret < 0) {
+			// print the rest as it is
+			off = xg_logger_bin_literal(buf, off, buflen, spec.beg, NULL);
+			buf[off] = '\0';
+			return off;
+		}
+		off = xg_logger_advance(off, ret, buflen);
+		p = next;
+	}
+
+	off = xg_logger_bin_literal(buf, off, buflen, p, NULL);
+	buf[off] = '\0';
+	return off;
+}
+
+#undef XG_LOG_BIN_PRINT
+
+// decode a log record into buf : the same as xg_logger_format
+static xsize xg_logger_bin_line(xchar *buf, xsize buflen,
+		const xg_log_bin_head_t *head, xg_log_bin_dict_t *dict,
+		const xchar *rec) {
+	xg_log_rec_t hdr;
+	xi_logopt_t lopt;
+	xi_time_t when;
+	xint64 msec;
+	const xchar *fmt;
+	const xchar *fname;
+	const xchar *func;
+	xsize off;
+	xi_log_level_e level;
+
+	xi_mem_copy(&hdr, rec, sizeof(hdr));
+	level = (hdr.level > XI_LOG_LEVEL_PRINT) ? XI_LOG_LEVEL_PRINT
+			: (xi_log_level_e) hdr.level;
+
+	lopt.level = XI_LOG_LEVEL_ALL;
+	lopt.showDate = (hdr.opts & XG_LOG_OPT_DATE) ? TRUE : FALSE;
+	lopt.showFile = (hdr.opts & XG_LOG_OPT_FILE) ? TRUE : FALSE;
+	lopt.showFunc = (hdr.opts & XG_LOG_OPT_FUNC) ? TRUE : FALSE;
+	lopt.showLine = (hdr.opts & XG_LOG_OPT_LINE) ? TRUE : FALSE;
+
+	msec = head->msec + (hdr.ntick - head->ntick) / 1000000;
+	xi_clock_sec2time(&when, (xlong) (msec / 1000));
+	when.msec = (xint32) (msec % 1000);
+
+	fname = xg_logger_bin_dict_get(dict, hdr.file);
+	func = xg_logger_bin_dict_get(dict, hdr.func);
+	off = xg_logger_prefix(buf, buflen, &lopt, level, &when,
+			(fname == NULL) ? "?" : fname, (func == NULL) ? "?" : func,
+			hdr.line);
+
+	fmt = xg_logger_bin_dict_get(dict, hdr.fmt);
+	if (fmt == NULL) {
+		off = xg_logger_advance(off, xi_snprintf(buf + off, buflen - off,
+				"(unknown format %llx)\n", hdr.fmt), buflen);
+		buf[off] = '\0';
+		return off;
+	}
+
+	return xg_logger_bin_message(buf, off, buflen, fmt, rec + sizeof(hdr),
+			rec + hdr.len);
 }
 
 // ----------------------------------------------
@@ -97,36 +1217,60 @@ xvoid xi_logger_set_handle(xi_log_fn fn) {
 
 xi_logger_t *xi_logger_fetch(const xchar *id) {
 	xint32 idx;
+	xi_logger_t *logger = NULL;
+
+	idx = xg_logger_find(id);
+	if (idx >= 0) {
+		return &_g_logger_list[idx];
+	}
 
+	xg_logger_lock();
 	idx = xg_logger_find(id);
-	if (idx < 0) {
-		xi_logger_t *logger = &_g_logger_list[_g_logger_count];
-		xi_sprintf(logger->id, "%s", id);
+	if (idx >= 0) {
+		logger = &_g_logger_list[idx];
+	} else if (_g_logger_count < XI_LOG_INST_MAX) {
+		logger = &_g_logger_list[_g_logger_count];
+		xi_strncpy(logger->id, id, sizeof(logger->id) - 1);
+		logger->id[sizeof(logger->id) - 1] = '\0';
 		xg_logger_set_optdef(&logger->lopt);
-		_g_logger_count++;
-		return logger;
-	} else {
-		xi_logger_t *logger = &_g_logger_list[idx];
-		return logger;
+		// publish it to the lock-free finders
+		xi_atomic_inc32(&_g_logger_count);
 	}
+	xg_logger_unlock();
+
+	return logger;
 }
 
 xvoid xi_logger_get_ids(xuint32 *count, xi_logger_id_t **ids) {
-	xint32 i = 0;
+	xuint32 i = 0;
 
-	(*count) = (xuint32)_g_logger_count;
+	xg_logger_lock();
+	(*count) = _g_logger_count;
 	for (i = 0; i < _g_logger_count; i++) {
 		xi_strcpy(_g_logger_ids[i].id, _g_logger_list[i].id);
 	}
+	xg_logger_unlock();
 
 	(*ids) = _g_logger_ids;
 }
 
 xi_logopt_t xi_logger_get_conf(xi_logger_t *logger) {
+	if (logger == NULL) {
+		if (_g_logger_def == NULL) {
+			_g_logger_def = xi_logger_fetch("DEFLOG");
+		}
+		logger = _g_logger_def;
+	}
 	return logger->lopt;
 }
 
 xvoid xi_logger_set_conf(xi_logger_t *logger, xi_logopt_t opt) {
+	if (logger == NULL) {
+		if (_g_logger_def == NULL) {
+			_g_logger_def = xi_logger_fetch("DEFLOG");
+		}
+		logger = _g_logger_def;
+	}
 	logger->lopt = opt;
 }
 
@@ -134,6 +1278,9 @@ xvoid xi_logger_write(xi_logger_t *logger, xi_log_level_e level,
 		const xchar *fname, const xchar *function, xuint32 line,
 		const xchar *format, ...) {
 	xi_logger_t *rlog = NULL;
+	xg_log_async_t *alog;
+	xbool done = FALSE;
+	va_list va;
 
 	if (_g_logger_def == NULL) {
 		_g_logger_def = xi_logger_fetch("DEFLOG");
@@ -141,104 +1288,314 @@ xvoid xi_logger_write(xi_logger_t *logger, xi_log_level_e level,
 
 	rlog = (logger == NULL) ? _g_logger_def : logger;
 
-	if (level >= rlog->lopt.level) {
+	if (level < rlog->lopt.level || level < XI_LOG_LEVEL_TRACE
+			|| level > XI_LOG_LEVEL_PRINT) {
+		return;
+	}
+
+	va_start(va, format);
+
+	// the sync mode uses no shared state, and takes no guard
+	if (_g_log_async != NULL
+			|| xi_atomic_read32(&_g_log_bin) != XG_LOG_BIN_OFF) {
+		// xi_logger_async_stop waits for the users before freeing the ring
+		xi_atomic_inc32(&_g_log_users);
+		alog = (xg_log_async_t *) _g_log_async;
+		if (xi_atomic_read32(&_g_log_bin) == XG_LOG_BIN_ON) {
+			xg_logger_bin_put(alog, rlog, level, fname, function, line, format,
+					va);
+			done = TRUE;
+		} else if (alog != NULL) {
+			xg_logger_async_put(alog, rlog, level, fname, function, line,
+					format, va);
+			done = TRUE;
+		}
+		xi_atomic_dec32(&_g_log_users);
+	}
+
+	if (!done) {
 		xchar log[XI_LOG_LINE_MAX];
-		xchar msg[XI_LOG_LINE_MAX - 64];
+		xsize len;
 
-		va_list va;
+		len = xg_logger_format(log, sizeof(log), rlog, level, fname, function,
+				line, format, va);
+		if (_g_log_fn == NULL) {
+			xg_logger_write_def(log, len);
+		} else {
+			_g_log_fn(log);
+		}
+	}
 
-		// Boost Variables
-		xsize totch = 0;
+	va_end(va);
+}
 
-		xi_mem_set(log, 0, sizeof(log));
-		xi_mem_set(msg, 0, sizeof(msg));
+xi_log_re xi_logger_async_start(xuint32 slots, xi_log_overflow_e overflow) {
+	xg_log_async_t *alog;
+	xi_thread_t tid;
+	xuint32 i, size;
 
-		va_start(va, format);
-		vsnprintf(msg, sizeof(msg), format, va);
-		va_end(va);
+	if (overflow != XI_LOG_OVERFLOW_DROP && overflow != XI_LOG_OVERFLOW_BLOCK) {
+		return XI_LOG_RV_ERR_ARGS;
+	}
+	if (slots == 0) {
+		slots = XG_LOG_ASYNC_DEF;
+	}
+	if (slots > 0x10000000) {
+		return XI_LOG_RV_ERR_ARGS;
+	}
+	for (size = 2; size < slots; size <<= 1) {
+		// round up to a power of 2
+	}
 
-		switch (level) {
-		case XI_LOG_LEVEL_TRACE:
-			xi_strncpy(log, "TRACE", 5);
-			totch = 5;
-			break;
-		case XI_LOG_LEVEL_DEBUG:
-			xi_strncpy(log, "DEBUG", 5);
-			totch = 5;
-			break;
-		case XI_LOG_LEVEL_INFO:
-			xi_strncpy(log, "INFO", 4);
-			totch = 4;
-			break;
-		case XI_LOG_LEVEL_WARN:
-			xi_strncpy(log, "WARN", 4);
-			totch = 4;
-			break;
-		case XI_LOG_LEVEL_ERROR:
-			xi_strncpy(log, "ERROR", 5);
-			totch = 5;
-			break;
-		case XI_LOG_LEVEL_FATAL:
-			xi_strncpy(log, "FATAL", 5);
-			totch = 5;
-			break;
-		case XI_LOG_LEVEL_PRINT:
-			if (_g_log_fn == NULL) {
-				xg_logger_write_def(msg);
-			} else {
-				_g_log_fn(msg);
-			}
-			return;
-		default:
-			return;
-		}
+	if (_g_log_async != NULL) {
+		return XI_LOG_RV_ERR_BUSY;
+	}
 
-		if (rlog->lopt.showDate == TRUE) {
-			xchar tstr[25];
-			xi_time_t now;
+	alog = xi_mem_calloc(1, sizeof(xg_log_async_t));
+	if (alog == NULL) {
+		return XI_LOG_RV_ERR_NOMEM;
+	}
+	alog->slots = xi_mem_alloc(size * sizeof(xg_log_slot_t));
+	if (alog->slots == NULL) {
+		xi_mem_free(alog);
+		return XI_LOG_RV_ERR_NOMEM;
+	}
+	for (i = 0; i < size; i++) {
+		alog->slots[i].seq = i;
+	}
+	alog->mask = size - 1;
+	alog->overflow = overflow;
+	alog->running = 1;
+	if (xi_thread_mutex_create(&alog->lock, "xi_log_async") != XI_MUTEX_RV_OK) {
+		xi_mem_free(alog->slots);
+		xi_mem_free(alog);
+		return XI_LOG_RV_ERR_OP;
+	}
+	if (xi_thread_cond_create(&alog->cond, "xi_log_async") != XI_COND_RV_OK) {
+		xi_thread_mutex_destroy(&alog->lock);
+		xi_mem_free(alog->slots);
+		xi_mem_free(alog);
+		return XI_LOG_RV_ERR_OP;
+	}
 
-			xi_clock_gettime(&now);
+	if (xi_thread_create(&tid, "xi_log_async", xg_logger_async_main, alog,
+			64 * 1024, XCFG_THREAD_PRIOR_NORM) != XI_THREAD_RV_OK) {
+		xi_thread_cond_destroy(&alog->cond);
+		xi_thread_mutex_destroy(&alog->lock);
+		xi_mem_free(alog->slots);
+		xi_mem_free(alog);
+		return XI_LOG_RV_ERR_OP;
+	}
 
-			xi_sprintf(tstr, "|%d-%02d-%02d %02d:%02d:%02d.%03d", now.year,
-					now.mon, now.day, now.hour, now.min, now.sec, now.msec);
-			xi_strcat(log + (totch - 2), tstr);
-			totch += 24;
+	if (xi_atomic_casptr(&_g_log_async, alog, NULL) != NULL) {
+		// another thread has started it in the meantime
+		alog->running = 0;
+		xg_logger_async_wake(alog);
+		while (!xi_atomic_read32(&alog->stopped)) {
+			xi_thread_sleep(1);
 		}
+		xi_thread_cond_destroy(&alog->cond);
+		xi_thread_mutex_destroy(&alog->lock);
+		xi_mem_free(alog->slots);
+		xi_mem_free(alog);
+		return XI_LOG_RV_ERR_BUSY;
+	}
 
-		if (rlog->lopt.showFile == TRUE) {
-			xi_strcat(log + (totch - 2), "|");
-			totch += 1;
-			xi_strcat(log + (totch - 2), xi_pathname_basename(fname));
-			totch += xi_strlen(xi_pathname_basename(fname));
-		}
+	return XI_LOG_RV_OK;
+}
+
+xvoid xi_logger_async_flush() {
+	xg_log_async_t *alog;
+	xuint32 last;
 
-		if (rlog->lopt.showFunc == TRUE) {
-			xi_strcat(log + (totch - 2), "|");
-			totch += 1;
-			xi_strcat(log, function);
-			totch += xi_strlen(function);
+	xi_atomic_inc32(&_g_log_users);
+	alog = (xg_log_async_t *) _g_log_async;
+	if (alog != NULL) {
+		last = xi_atomic_read32(&alog->enq);
+		while ((xint32) (last - alog->deq) > 0) {
+			xg_logger_async_wake(alog);
+			xi_thread_sleep(1);
 		}
+	}
+	xi_atomic_dec32(&_g_log_users);
+}
 
-		if (rlog->lopt.showLine == TRUE) {
-			xchar lstr[8];// 8
+xvoid xi_logger_async_stop() {
+	xg_log_async_t *alog;
 
-			xi_strcat(log + (totch - 2), "|");
-			totch += 1;
+	alog = xi_atomic_xchgptr(&_g_log_async, NULL);
+	if (alog == NULL) {
+		return;
+	}
 
-			xi_sprintf(lstr, "%05u", line);
-			xi_strcat(log + (totch - 2), lstr);
-			totch += 5;
-		}
+	// the new logs go to the sync mode, and the old ones finish their slots
+	while (xi_atomic_read32(&_g_log_users) > 0) {
+		xi_thread_yield();
+	}
 
-		xi_strcat(log + (totch - 2), "|");
-		totch += 1;
-		xi_strcat(log + (totch - 2), msg);
-		totch += xi_strlen(msg);
+	xi_thread_mutex_lock(&alog->lock);
+	xi_atomic_xchg32(&alog->running, 0);
+	xi_thread_cond_signal(&alog->cond);
+	xi_thread_mutex_unlock(&alog->lock);
 
-		if (_g_log_fn == NULL) {
-			xg_logger_write_def(log);
-		} else {
-			_g_log_fn(log);
+	// the writer drains the ring before it stops
+	while (!xi_atomic_read32(&alog->stopped)) {
+		xi_thread_sleep(1);
+	}
+
+	xi_thread_cond_destroy(&alog->cond);
+	xi_thread_mutex_destroy(&alog->lock);
+	xi_mem_free(alog->slots);
+	xi_mem_free(alog);
+}
+
+xuint32 xi_logger_async_dropped() {
+	xg_log_async_t *alog;
+	xuint32 dropped = 0;
+
+	xi_atomic_inc32(&_g_log_users);
+	alog = (xg_log_async_t *) _g_log_async;
+	if (alog != NULL) {
+		dropped = xi_atomic_read32(&alog->dropped);
+	}
+	xi_atomic_dec32(&_g_log_users);
+
+	return dropped;
+}
+
+xi_log_re xi_logger_bin_start(const xchar *pathname) {
+	xg_log_bin_head_t head;
+	xint32 fd;
+
+	if (pathname == NULL) {
+		return XI_LOG_RV_ERR_ARGS;
+	}
+	if (xi_atomic_cas32(&_g_log_bin, XG_LOG_BIN_BUSY, XG_LOG_BIN_OFF)
+			!= XG_LOG_BIN_OFF) {
+		return XI_LOG_RV_ERR_BUSY;
+	}
+
+	fd = xi_file_open(pathname, XI_FILE_MODE_WRITE | XI_FILE_MODE_CREATE
+			| XI_FILE_MODE_TRUNCATE | XI_FILE_MODE_APPEND, 0644);
+	if (fd < 0) {
+		xi_atomic_xchg32(&_g_log_bin, XG_LOG_BIN_OFF);
+		return XI_LOG_RV_ERR_OP;
+	}
+
+	xi_mem_set(&head, 0, sizeof(head));
+	xi_mem_copy(head.magic, XG_LOG_BIN_MAGIC, sizeof(head.magic));
+	head.version = XG_LOG_BIN_VERSION;
+	head.order = XG_LOG_BIN_ORDER;
+	head.ptrsize = sizeof(xvoid *);
+	head.recsize = sizeof(xg_log_rec_t);
+	head.msec = xi_clock_msec();
+	head.ntick = xi_clock_ntick();
+	if (xi_file_write(fd, &head, sizeof(head)) != (xssize) sizeof(head)) {
+		xi_file_close(fd);
+		xi_atomic_xchg32(&_g_log_bin, XG_LOG_BIN_OFF);
+		return XI_LOG_RV_ERR_OP;
+	}
+
+	// a new file has none of the strings
+	xi_mem_set((xvoid *) _g_log_bin_seen, 0, sizeof(_g_log_bin_seen));
+	_g_log_bin_fd = fd;
+	xi_atomic_xchg32(&_g_log_bin, XG_LOG_BIN_ON);
+
+	return XI_LOG_RV_OK;
+}
+
+xvoid xi_logger_bin_stop() {
+	xint32 fd;
+
+	if (xi_atomic_cas32(&_g_log_bin, XG_LOG_BIN_BUSY, XG_LOG_BIN_ON)
+			!= XG_LOG_BIN_ON) {
+		return;
+	}
+
+	// the new logs go to the text, and the old ones finish their records
+	while (xi_atomic_read32(&_g_log_users) > 0) {
+		xi_thread_yield();
+	}
+	xi_logger_async_flush();
+
+	fd = _g_log_bin_fd;
+	_g_log_bin_fd = -1;
+	xi_file_close(fd);
+	xi_atomic_xchg32(&_g_log_bin, XG_LOG_BIN_OFF);
+}
+
+xi_log_re xi_logger_bin_decode(xint32 infd, xint32 outfd) {
+	xg_log_bin_head_t head;
+	xg_log_bin_dict_t dict;
+	xg_log_bin_rd_t rd;
+	xg_log_rec_t hdr;
+	xchar *rec;
+	xchar *out;
+	xsize olen = 0;
+	xchar line[XI_LOG_LINE_MAX];
+	xsize len;
+	xi_log_re ret = XI_LOG_RV_OK;
+
+	if (xi_file_read(infd, &head, sizeof(head)) != (xssize) sizeof(head)
+			|| xi_mem_cmp(head.magic, XG_LOG_BIN_MAGIC, sizeof(head.magic)) != 0
+			|| head.version != XG_LOG_BIN_VERSION
+			|| head.order != XG_LOG_BIN_ORDER
+			|| head.ptrsize != sizeof(xvoid *)
+			|| head.recsize != sizeof(xg_log_rec_t)) {
+		return XI_LOG_RV_ERR_ARGS;
+	}
+
+	rd.fd = infd;
+	rd.pos = 0;
+	rd.end = 0;
+	rd.buf = xi_mem_alloc(XG_LOG_BIN_RDBUF + XG_LOG_BIN_WRBUF);
+	if (rd.buf == NULL) {
+		return XI_LOG_RV_ERR_NOMEM;
+	}
+	out = rd.buf + XG_LOG_BIN_RDBUF;
+	if (!xg_logger_bin_dict_init(&dict, 1024)) {
+		xi_mem_free(rd.buf);
+		return XI_LOG_RV_ERR_NOMEM;
+	}
+
+	// 1st pass : the strings, which may come after their first logs
+	while ((rec = xg_logger_bin_next(&rd)) != NULL) {
+		xi_mem_copy(&hdr, rec, sizeof(hdr));
+		if (hdr.type == XG_LOG_REC_STR) {
+			rec[hdr.len - 1] = '\0';
+			if (!xg_logger_bin_dict_put(&dict, hdr.fmt, rec + sizeof(hdr))) {
+				ret = XI_LOG_RV_ERR_NOMEM;
+				goto out;
+			}
+		}
+	}
+
+	// 2nd pass : the logs
+	if (xi_file_seek(infd, sizeof(head), XI_FILE_SEEK_SET) != sizeof(head)) {
+		ret = XI_LOG_RV_ERR_OP;
+		goto out;
+	}
+	rd.pos = 0;
+	rd.end = 0;
+	while ((rec = xg_logger_bin_next(&rd)) != NULL) {
+		xi_mem_copy(&hdr, rec, sizeof(hdr));
+		if (hdr.type != XG_LOG_REC_LOG) {
+			continue;
 		}
+		len = xg_logger_bin_line(line, sizeof(line), &head, &dict, rec);
+		if (olen + len > XG_LOG_BIN_WRBUF) {
+			xi_file_write(outfd, out, olen);
+			olen = 0;
+		}
+		xi_mem_copy(out + olen, line, len);
+		olen += len;
+	}
+	if (olen > 0) {
+		xi_file_write(outfd, out, olen);
 	}
+
+out:
+	xg_logger_bin_dict_free(&dict);
+	xi_mem_free(rd.buf);
+	return ret;
 }
@@ -0,0 +1,480 @@
+/*
+ * Copyright 2013 Cheolmin Jo (webos21@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * File : xg_mem_pool.c
+ */
+
+#include "xi/xi_mem.h"
+
+#include "xi/xi_thread.h"
+
+// ----------------------------------------------
+// Definitions
+// ----------------------------------------------
+
+#define XG_MEM_ALIGN        (sizeof(xvoid *) * 2)
+#define XG_MEM_ROUNDUP(n)   (((n) + XG_MEM_ALIGN - 1) & ~(XG_MEM_ALIGN - 1))
+
+#define XG_ARENA_CHUNK_DEF  (64 * 1024)
+#define XG_ARENA_HDR        XG_MEM_ROUNDUP(sizeof(xg_arena_chunk_t))
+
+#define XG_SLAB_ROUNDS      32           // objects of a magazine
+#define XG_SLAB_PAGE        (64 * 1024)  // minimum bytes of a page
+#define XG_SLAB_PAGE_OBJS   64           // minimum objects of a page
+#define XG_SLAB_HDR         XG_MEM_ROUNDUP(sizeof(xg_slab_page_t))
+
+// ----------------------------------------------
+// Inner Structures
+// ----------------------------------------------
+
+typedef struct _st_arena_chunk xg_arena_chunk_t;
+struct _st_arena_chunk {
+	xg_arena_chunk_t *next;
+	xsize size;   // bytes of the data after the header
+	xsize used;
+};
+
+struct _xi_mem_arena {
+	xg_arena_chunk_t *first;  // the chunks of the default size
+	xg_arena_chunk_t *cur;    // the chunk to bump
+	xg_arena_chunk_t *big;    // the blocks of the large requests
+	xsize chunk;
+	xsize used;
+};
+
+typedef struct _st_slab_mag xg_slab_mag_t;
+struct _st_slab_mag {
+	xg_slab_mag_t *next;
+	xuint32 cnt;
+	xvoid *objs[XG_SLAB_ROUNDS];
+};
+
+// the magazines of a thread
+typedef struct _st_slab_cache xg_slab_cache_t;
+struct _st_slab_cache {
+	xg_slab_cache_t *next;  // all the caches of the slab
+	xg_slab_mag_t *loaded;
+	xg_slab_mag_t *prev;
+};
+
+typedef struct _st_slab_page xg_slab_page_t;
+struct _st_slab_page {
+	xg_slab_page_t *next;
+};
+
+struct _xi_mem_slab {
+	xsize objsize;
+	xsize pagesize;
+	xi_thread_key_t key;      // xg_slab_cache_t of the thread
+
+	// the depot, under the lock
+	xi_thread_mutex_t lock;
+	xg_slab_mag_t *full;
+	xg_slab_mag_t *empty;
+	xvoid *loose;             // the free objects, linked by their first word
+	xchar *carve;             // the rest of the last page
+	xchar *carve_end;
+	xg_slab_page_t *pages;
+	xg_slab_cache_t *caches;
+};
+
+// ----------------------------------------------
+// Part Internal Functions
+// ----------------------------------------------
+
+static xg_arena_chunk_t *xg_arena_chunk_new(xsize size) {
+	xg_arena_chunk_t *c;
+
+	c = xi_mem_alloc(XG_ARENA_HDR + size);
+	if (c == NULL) {
+		return NULL;
+	}
+	c->next = NULL;
+	c->size = size;
+	c->used = 0;
+
+	return c;
+}
+
+// take an object from the depot (under the lock)
+static xvoid *xg_slab_take(xi_mem_slab_t *slab) {
+	xvoid *obj = slab->loose;
+	xg_slab_page_t *page;
+
+	if (obj != NULL) {
+		slab->loose = *(xvoid **) obj;
+		return obj;
+	}
+
+	if (slab->carve == NULL
+			|| (xsize) (slab->carve_end - slab->carve) < slab->objsize) {
+		page = xi_mem_alloc(slab->pagesize);
+		if (page == NULL) {
+			return NULL;
+		}
+		page->next = slab->pages;
+		slab->pages = page;
+		slab->carve = (xchar *) page + XG_SLAB_HDR;
+		slab->carve_end = (xchar *) page + slab->pagesize;
+	}
+
+	obj = slab->carve;
+	slab->carve += slab->objsize;
+
+	return obj;
+}
+
+// give an object to the depot (under the lock)
+static xvoid xg_slab_put(xi_mem_slab_t *slab, xvoid *obj) {
+	*(xvoid **) obj = slab->loose;
+	slab->loose = obj;
+}
+
+// the cache of the calling thread, which is made at the first call
+static xg_slab_cache_t *xg_slab_cache(xi_mem_slab_t *slab) {
+	xg_slab_cache_t *cache;
+
+	cache = xi_thread_key_get(slab->key);
+	if (cache != NULL) {
+		return cache;
+	}
+
+	cache = xi_mem_calloc(1, sizeof(xg_slab_cache_t));
+	if (cache == NULL) {
+		return NULL;
+	}
+	cache->loaded = xi_mem_calloc(1, sizeof(xg_slab_mag_t));
+	cache->prev = xi_mem_calloc(1, sizeof(xg_slab_mag_t));
+	if (cache->loaded == NULL || cache->prev == NULL
+			|| xi_thread_key_set(slab->key, cache) != XI_TKEY_RV_OK) {
+		xi_mem_free(cache->loaded);
+		xi_mem_free(cache->prev);
+		xi_mem_free(cache);
+		return NULL;
+	}
+
+	xi_thread_mutex_lock(&slab->lock);
+	cache->next = slab->caches;
+	slab->caches = cache;
+	xi_thread_mutex_unlock(&slab->lock);
+
+	return cache;
+}
+
+static xvoid xg_slab_swap(xg_slab_cache_t *cache) {
+	xg_slab_mag_t *mag = cache->loaded;
+
+	cache->loaded = cache->prev;
+	cache->prev = mag;
+}
+
+static xvoid xg_slab_mag_free(xg_slab_mag_t *mag) {
+	xg_slab_mag_t *next;
+
+	while (mag != NULL) {
+		next = mag->next;
+		xi_mem_free(mag);
+		mag = next;
+	}
+}
+
+// ----------------------------------------------
+// XI Functions
+// ----------------------------------------------
+
+xi_mem_arena_t *xi_mem_arena_create(xsize chunk) {
+	xi_mem_arena_t *arena;
+
+	arena = xi_mem_calloc(1, sizeof(xi_mem_arena_t));
+	if (arena == NULL) {
+		return NULL;
+	}
+	arena->chunk = (chunk == 0) ? XG_ARENA_CHUNK_DEF : XG_MEM_ROUNDUP(chunk);
+
+	return arena;
+}
+
+xvoid *xi_mem_arena_alloc(xi_mem_arena_t *arena, xsize size) {
+	xg_arena_chunk_t *c;
+	xg_arena_chunk_t *n;
+	xvoid *ptr;
+
+	size = (size == 0) ? XG_MEM_ALIGN : XG_MEM_ROUNDUP(size);
+
+	if (size > arena->chunk / 4) {
+		c = xg_arena_chunk_new(size);
+		if (c == NULL) {
+			return NULL;
+		}
+		c->used = size;
+		c->next = arena->big;
+		arena->big = c;
+		arena->used += size;
+		return (xchar *) c + XG_ARENA_HDR;
+	}
+
+	c = arena->cur;
+	while (c == NULL || c->used + size > c->size) {
+		if (c != NULL && c->next != NULL) {
+			// kept by xi_mem_arena_reset
+			c = c->next;
+			c->used = 0;
+			continue;
+		}
+		n = xg_arena_chunk_new(arena->chunk);
+		if (n == NULL) {
+			return NULL;
+		}
+		if (c == NULL) {
+			arena->first = n;
+		} else {
+			c->next = n;
+		}
+		c = n;
+	}
+	arena->cur = c;
+
+	ptr = (xchar *) c + XG_ARENA_HDR + c->used;
+	c->used += size;
+	arena->used += size;
+
+	return ptr;
+}
+
+xvoid *xi_mem_arena_calloc(xi_mem_arena_t *arena, xsize nmemb, xsize size) {
+	xvoid *ptr;
+
+	if (size != 0 && nmemb > ((xsize) -1) / size) {
+		return NULL;
+	}
+	ptr = xi_mem_arena_alloc(arena, nmemb * size);
+	if (ptr != NULL) {
+		xi_mem_set(ptr, 0, nmemb * size);
+	}
+
+	return ptr;
+}
+
+xsize xi_mem_arena_used(xi_mem_arena_t *arena) {
+	return arena->used;
+}
+
+xvoid xi_mem_arena_reset(xi_mem_arena_t *arena) {
+	xg_arena_chunk_t *next;
+
+	while (arena->big != NULL) {
+		next = arena->big->next;
+		xi_mem_free(arena->big);
+		arena->big = next;
+	}
+
+	// the rest of the chunks are cleared when they are reached
+	arena->cur = arena->first;
+	if (arena->cur != NULL) {
+		arena->cur->used = 0;
+	}
+	arena->used = 0;
+}
+
+xvoid xi_mem_arena_destroy(xi_mem_arena_t *arena) {
+	xg_arena_chunk_t *next;
+
+	if (arena == NULL) {
+		return;
+	}
+
+	xi_mem_arena_reset(arena);
+	while (arena->first != NULL) {
+		next = arena->first->next;
+		xi_mem_free(arena->first);
+		arena->first = next;
+	}
+	xi_mem_free(arena);
+}
+
+xi_mem_slab_t *xi_mem_slab_create(xsize objsize) {
+	xi_mem_slab_t *slab;
+
+	if (objsize == 0) {
+		return NULL;
+	}
+
+	slab = xi_mem_calloc(1, sizeof(xi_mem_slab_t));
+	if (slab == NULL) {
+		return NULL;
+	}
+
+	// a free object keeps the link in its first word
+	if (objsize < sizeof(xvoid *)) {
+		objsize = sizeof(xvoid *);
+	}
+	slab->objsize = XG_MEM_ROUNDUP(objsize);
+	slab->pagesize = XG_SLAB_HDR + (slab->objsize * XG_SLAB_PAGE_OBJS);
+	if (slab->pagesize < XG_SLAB_PAGE) {
+		slab->pagesize = XG_SLAB_PAGE;
+	}
+
+	if (xi_thread_key_create(&slab->key) != XI_TKEY_RV_OK) {
+		xi_mem_free(slab);
+		return NULL;
+	}
+	if (xi_thread_mutex_create(&slab->lock, "xi_mem_slab")
+			!= XI_MUTEX_RV_OK) {
+		xi_thread_key_destroy(slab->key);
+		xi_mem_free(slab);
+		return NULL;
+	}
+
+	return slab;
+}
+
+xvoid *xi_mem_slab_alloc(xi_mem_slab_t *slab) {
+	xg_slab_cache_t *cache;
+	xg_slab_mag_t *mag;
+	xvoid *obj;
+
+	cache = xg_slab_cache(slab);
+	if (cache == NULL) {
+		// no cache : straight from the depot
+		xi_thread_mutex_lock(&slab->lock);
+		obj = xg_slab_take(slab);
+		xi_thread_mutex_unlock(&slab->lock);
+		return obj;
+	}
+
+	if (cache->loaded->cnt == 0) {
+		if (cache->prev->cnt > 0) {
+			xg_slab_swap(cache);
+		} else {
+			xi_thread_mutex_lock(&slab->lock);
+			if (slab->full != NULL) {
+				// exchange the empty one for a full one
+				mag = slab->full;
+				slab->full = mag->next;
+				cache->loaded->next = slab->empty;
+				slab->empty = cache->loaded;
+				cache->loaded = mag;
+			} else {
+				while (cache->loaded->cnt < XG_SLAB_ROUNDS) {
+					obj = xg_slab_take(slab);
+					if (obj == NULL) {
+						break;
+					}
+					cache->loaded->objs[cache->loaded->cnt++] = obj;
+				}
+			}
+			xi_thread_mutex_unlock(&slab->lock);
+
+			if (cache->loaded->cnt == 0) {
+				return NULL;
+			}
+		}
+	}
+
+	return cache->loaded->objs[--cache->loaded->cnt];
+}
+
+xvoid xi_mem_slab_free(xi_mem_slab_t *slab, xvoid *obj) {
+	xg_slab_cache_t *cache;
+	xg_slab_mag_t *mag;
+
+	if (obj == NULL) {
+		return;
+	}
+
+	cache = xg_slab_cache(slab);
+	if (cache == NULL) {
+		xi_thread_mutex_lock(&slab->lock);
+		xg_slab_put(slab, obj);
+		xi_thread_mutex_unlock(&slab->lock);
+		return;
+	}
+
+	if (cache->loaded->cnt == XG_SLAB_ROUNDS) {
+		if (cache->prev->cnt == 0) {
+			xg_slab_swap(cache);
+		} else {
+			xi_thread_mutex_lock(&slab->lock);
+			mag = slab->empty;
+			if (mag != NULL) {
+				slab->empty = mag->next;
+			} else {
+				mag = xi_mem_alloc(sizeof(xg_slab_mag_t));
+			}
+			if (mag == NULL) {
+				xg_slab_put(slab, obj);
+				xi_thread_mutex_unlock(&slab->lock);
+				return;
+			}
+			// hand the full one over, and load the empty one
+			cache->prev->next = slab->full;
+			slab->full = cache->prev;
+			cache->prev = cache->loaded;
+			cache->loaded = mag;
+			mag->cnt = 0;
+			xi_thread_mutex_unlock(&slab->lock);
+		}
+	}
+
+	cache->loaded->objs[cache->loaded->cnt++] = obj;
+}
+
+xvoid xi_mem_slab_flush(xi_mem_slab_t *slab) {
+	xg_slab_cache_t *cache;
+
+	cache = xi_thread_key_get(slab->key);
+	if (cache == NULL) {
+		return;
+	}
+
+	xi_thread_mutex_lock(&slab->lock);
+	while (cache->loaded->cnt > 0) {
+		xg_slab_put(slab, cache->loaded->objs[--cache->loaded->cnt]);
+	}
+	while (cache->prev->cnt > 0) {
+		xg_slab_put(slab, cache->prev->objs[--cache->prev->cnt]);
+	}
+	xi_thread_mutex_unlock(&slab->lock);
+}
+
+xvoid xi_mem_slab_destroy(xi_mem_slab_t *slab) {
+	xg_slab_cache_t *cache;
+	xg_slab_page_t *page;
+
+	if (slab == NULL) {
+		return;
+	}
+
+	while (slab->caches != NULL) {
+		cache = slab->caches;
+		slab->caches = cache->next;
+		xi_mem_free(cache->loaded);
+		xi_mem_free(cache->prev);
+		xi_mem_free(cache);
+	}
+	xg_slab_mag_free(slab->full);
+	xg_slab_mag_free(slab->empty);
+	while (slab->pages != NULL) {
+		page = slab->pages;
+		slab->pages = page->next;
+		xi_mem_free(page);
+	}
+
+	xi_thread_mutex_destroy(&slab->lock);
+	xi_thread_key_destroy(slab->key);
+	xi_mem_free(slab);
+}
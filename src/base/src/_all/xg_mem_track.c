@@ -0,0 +1,519 @@
+/*
+ * Copyright 2013 Cheolmin Jo (webos21@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * File : xg_mem_track.c
+ */
+
+#include "xg_mem_track.h"
+
+#include "xi/xi_atomic.h"
+#include "xi/xi_string.h"
+#include "xi/xi_thread.h"
+
+// ----------------------------------------------
+// Definitions
+// ----------------------------------------------
+
+#define XG_MEM_MAGIC        ((xuintptr) 0xA110C8EDU)
+#define XG_MEM_HDR_ALIGN    (sizeof(xvoid *) * 2)
+#define XG_MEM_HDR_SPACE    ((sizeof(xg_mem_hdr_t) + XG_MEM_HDR_ALIGN - 1) \
+		& ~(XG_MEM_HDR_ALIGN - 1))
+
+#define XG_MEM_TAG_NAME     32
+#define XG_MEM_SITE_MAX     1024   // entries of the table of the sampled sites
+#define XG_MEM_SITE_DEPTH   8      // frames of a site
+#define XG_MEM_SITE_SKIP    4      // the most frames of the allocator in front of the caller
+#define XG_MEM_DUMP_MAX     32
+
+// ----------------------------------------------
+// Inner Structures
+// ----------------------------------------------
+
+/**
+ * The header in front of a tracked allocation.
+ * The magic is next to the user pointer, so that a pointer of the system
+ * allocator is told by reading only the word in front of it.
+ */
+typedef struct _st_mem_hdr {
+	xsize size;
+	xuint16 tag;
+	xuint16 rsv;
+	xuint32 site;       // the sampled site + 1, or 0
+	xuintptr magic;     // XG_MEM_MAGIC ^ the user pointer
+} xg_mem_hdr_t;
+
+typedef struct _st_mem_tag {
+	xchar name[XG_MEM_TAG_NAME];
+	volatile xuint64 bytes;
+	volatile xuint64 bytes_peak;
+	volatile xuint64 count;
+	volatile xuint64 count_peak;
+} xg_mem_tag_t;
+
+typedef struct _st_mem_site {
+	xuint32 hash;       // 0 : empty
+	xuint32 tag;
+	xint32 depth;
+	xvoid *frames[XG_MEM_SITE_DEPTH];
+	xuint32 samples;    // the sampled allocations
+	xuint32 live;       // the sampled allocations not freed yet
+	xuint64 live_bytes;
+} xg_mem_site_t;
+
+// the state of a thread
+typedef struct _st_mem_thr {
+	xuint32 tag;
+	xuint32 countdown;  // allocations to the next sample (0 : not loaded yet)
+} xg_mem_thr_t;
+
+// ----------------------------------------------
+// Global Variables
+// ----------------------------------------------
+
+volatile xuint32 xg_mem_track_state = 0;
+
+static volatile xuint32 _g_mem_lock = 0;
+static xbool _g_mem_init = FALSE;
+static xi_thread_key_t _g_mem_key;
+static xuint32 _g_mem_sample = 0;
+
+static xg_mem_tag_t _g_mem_tags[XI_MEM_TAG_MAX] = { { "default", 0, 0, 0, 0 } };
+static volatile xuint32 _g_mem_tag_count = 1;
+
+static xg_mem_site_t _g_mem_sites[XG_MEM_SITE_MAX];
+
+// ----------------------------------------------
+// Part Internal Functions
+// ----------------------------------------------
+
+static xvoid xg_mem_track_lock() {
+	while (xi_atomic_cas32(&_g_mem_lock, 1, 0) != 0) {
+		xi_thread_yield();
+	}
+}
+
+static xvoid xg_mem_track_unlock() {
+	xi_atomic_xchg32(&_g_mem_lock, 0);
+}
+
+// under the lock
+static xbool xg_mem_track_init() {
+	if (!_g_mem_init) {
+		if (xi_thread_key_create(&_g_mem_key) != XI_TKEY_RV_OK) {
+			return FALSE;
+		}
+		_g_mem_init = TRUE;
+	}
+	return TRUE;
+}
+
+// the state of the calling thread, which is made if create
+static xg_mem_thr_t *xg_mem_track_thr(xbool create) {
+	xg_mem_thr_t *thr;
+
+	thr = xi_thread_key_get(_g_mem_key);
+	if (thr != NULL || !create) {
+		return thr;
+	}
+
+	// not tracked, and not freed at the exit of the thread
+	thr = xg_mem_raw_calloc(1, sizeof(xg_mem_thr_t));
+	if (thr == NULL) {
+		return NULL;
+	}
+	thr->countdown = _g_mem_sample;
+	if (xi_thread_key_set(_g_mem_key, thr) != XI_TKEY_RV_OK) {
+		xg_mem_raw_free(thr);
+		return NULL;
+	}
+
+	return thr;
+}
+
+static xvoid xg_mem_track_peak(volatile xuint64 *peak, xuint64 cur) {
+	xuint64 old = *peak;
+
+	while (cur > old) {
+		if (xi_atomic_cas64(peak, cur, old) == old) {
+			break;
+		}
+		old = *peak;
+	}
+}
+
+static xvoid xg_mem_track_add(xuint32 tag, xsize size) {
+	xg_mem_tag_t *t = &_g_mem_tags[tag];
+
+	xg_mem_track_peak(&t->bytes_peak, xi_atomic_add64(&t->bytes, size) + size);
+	xg_mem_track_peak(&t->count_peak, xi_atomic_inc64(&t->count) + 1);
+}
+
+static xvoid xg_mem_track_sub(xuint32 tag, xsize size) {
+	xg_mem_tag_t *t = &_g_mem_tags[tag];
+
+	xi_atomic_sub64(&t->bytes, size);
+	xi_atomic_dec64(&t->count);
+}
+
+// count a call stack to its site : the site + 1, or 0
+static xuint32 xg_mem_track_site(xuint32 tag, xsize size, xvoid **frames,
+		xint32 n, xvoid *from) {
+	xvoid **caller = frames;
+	xg_mem_site_t *s = NULL;
+	xuint32 hash = 2166136261U;
+	xuint32 i, idx;
+
+	// the frames of the allocator depend on the inlining and the tail calls,
+	// so that the stack is cut at the return address of xi_mem_*
+	for (i = 0; i < (xuint32) n && i <= XG_MEM_SITE_SKIP; i++) {
+		if (frames[i] == from) {
+			caller = frames + i;
+			n -= (xint32) i;
+			break;
+		}
+	}
+	if (n > XG_MEM_SITE_DEPTH) {
+		n = XG_MEM_SITE_DEPTH;
+	}
+	if (n < 0) {
+		n = 0;
+	}
+	for (i = 0; i < (xuint32) n; i++) {
+		hash = (hash ^ (xuint32) ((xuintptr) caller[i] >> 2)) * 16777619U;
+	}
+	hash = (hash ^ tag) * 16777619U;
+	if (hash == 0) {
+		hash = 1;
+	}
+
+	xg_mem_track_lock();
+	for (i = 0; i < XG_MEM_SITE_MAX; i++) {
+		idx = (hash + i) & (XG_MEM_SITE_MAX - 1);
+		s = &_g_mem_sites[idx];
+		if (s->hash == 0) {
+			s->hash = hash;
+			s->tag = tag;
+			s->depth = n;
+			xi_mem_copy(s->frames, caller, sizeof(xvoid *) * n);
+			break;
+		}
+		if (s->hash == hash && s->tag == tag && s->depth == n
+				&& xi_mem_cmp(s->frames, caller, sizeof(xvoid *) * n) == 0) {
+			break;
+		}
+	}
+	if (i == XG_MEM_SITE_MAX) {
+		xg_mem_track_unlock();
+		return 0;
+	}
+	s->samples++;
+	s->live++;
+	s->live_bytes += size;
+	xg_mem_track_unlock();
+
+	return idx + 1;
+}
+
+static xvoid xg_mem_track_site_resize(xuint32 site, xsize oldsize,
+		xsize newsize, xbool freed) {
+	xg_mem_site_t *s = &_g_mem_sites[site - 1];
+
+	xg_mem_track_lock();
+	s->live_bytes = s->live_bytes - oldsize + newsize;
+	if (freed) {
+		s->live--;
+	}
+	xg_mem_track_unlock();
+}
+
+// the header of a tracked allocation, or NULL
+static xg_mem_hdr_t *xg_mem_track_hdr(xvoid *ptr) {
+	if (*((xuintptr *) ptr - 1) != (XG_MEM_MAGIC ^ (xuintptr) ptr)) {
+		return NULL;
+	}
+	return (xg_mem_hdr_t *) ((xchar *) ptr - sizeof(xg_mem_hdr_t));
+}
+
+// ----------------------------------------------
+// Internal Functions
+// ----------------------------------------------
+
+xvoid *xg_mem_track_alloc(xsize size, xbool zero, xvoid *caller) {
+	xvoid *frames[XG_MEM_SITE_DEPTH + XG_MEM_SITE_SKIP];
+	xg_mem_thr_t *thr;
+	xg_mem_hdr_t *hdr;
+	xchar *raw;
+	xuint32 tag, site = 0;
+
+	if (size > ((xsize) -1) - XG_MEM_HDR_SPACE) {
+		return NULL;
+	}
+	raw = zero ? xg_mem_raw_calloc(1, XG_MEM_HDR_SPACE + size)
+			: xg_mem_raw_alloc(XG_MEM_HDR_SPACE + size);
+	if (raw == NULL) {
+		return NULL;
+	}
+
+	thr = xg_mem_track_thr(_g_mem_sample > 0);
+	tag = (thr == NULL) ? XI_MEM_TAG_DEFAULT : thr->tag;
+	if (thr != NULL && _g_mem_sample > 0) {
+		// the state may be made by xi_mem_track_tag_set before the start
+		if (thr->countdown == 0) {
+			thr->countdown = _g_mem_sample;
+		}
+		if (--thr->countdown == 0) {
+			thr->countdown = _g_mem_sample;
+			site = xg_mem_track_site(tag, size, frames,
+					xg_mem_backtrace(frames, XG_MEM_SITE_DEPTH + XG_MEM_SITE_SKIP),
+					caller);
+		}
+	}
+	xg_mem_track_add(tag, size);
+
+	hdr = (xg_mem_hdr_t *) (raw + XG_MEM_HDR_SPACE - sizeof(xg_mem_hdr_t));
+	hdr->size = size;
+	hdr->tag = (xuint16) tag;
+	hdr->site = site;
+	hdr->magic = XG_MEM_MAGIC ^ (xuintptr) (raw + XG_MEM_HDR_SPACE);
+
+	return raw + XG_MEM_HDR_SPACE;
+}
+
+xvoid *xg_mem_track_realloc(xvoid *ptr, xsize size, xvoid *caller) {
+	xg_mem_hdr_t *hdr;
+	xchar *raw;
+	xsize oldsize;
+	xuint32 tag, site;
+
+	if (ptr == NULL) {
+		if (xg_mem_track_state & XG_MEM_TRACK_ON) {
+			return xg_mem_track_alloc(size, FALSE, caller);
+		}
+		return xg_mem_raw_alloc(size);
+	}
+
+	hdr = xg_mem_track_hdr(ptr);
+	if (hdr == NULL) {
+		// its old size is unknown, and so it stays untracked
+		return xg_mem_raw_realloc(ptr, size);
+	}
+	if (size > ((xsize) -1) - XG_MEM_HDR_SPACE) {
+		return NULL;
+	}
+
+	oldsize = hdr->size;
+	tag = hdr->tag;
+	site = hdr->site;
+	raw = xg_mem_raw_realloc((xchar *) ptr - XG_MEM_HDR_SPACE,
+			XG_MEM_HDR_SPACE + size);
+	if (raw == NULL) {
+		return NULL;
+	}
+
+	// it keeps the tag of the first allocation
+	xg_mem_track_sub(tag, oldsize);
+	xg_mem_track_add(tag, size);
+	if (site != 0) {
+		xg_mem_track_site_resize(site, oldsize, size, FALSE);
+	}
+
+	hdr = (xg_mem_hdr_t *) (raw + XG_MEM_HDR_SPACE - sizeof(xg_mem_hdr_t));
+	hdr->size = size;
+	hdr->magic = XG_MEM_MAGIC ^ (xuintptr) (raw + XG_MEM_HDR_SPACE);
+
+	return raw + XG_MEM_HDR_SPACE;
+}
+
+xvoid xg_mem_track_free(xvoid *ptr) {
+	xg_mem_hdr_t *hdr;
+
+	if (ptr == NULL) {
+		return;
+	}
+
+	hdr = xg_mem_track_hdr(ptr);
+	if (hdr == NULL) {
+		xg_mem_raw_free(ptr);
+		return;
+	}
+
+	xg_mem_track_sub(hdr->tag, hdr->size);
+	if (hdr->site != 0) {
+		xg_mem_track_site_resize(hdr->site, hdr->size, 0, TRUE);
+	}
+	// not to be taken for a tracked one, if the memory is reused as it is
+	hdr->magic = 0;
+
+	xg_mem_raw_free((xchar *) ptr - XG_MEM_HDR_SPACE);
+}
+
+// ----------------------------------------------
+// XI Functions
+// ----------------------------------------------
+
+xi_mem_re xi_mem_track_start(xuint32 sample) {
+	xg_mem_track_lock();
+	if (!xg_mem_track_init()) {
+		xg_mem_track_unlock();
+		return XI_MEM_RV_ERR_OP;
+	}
+	_g_mem_sample = sample;
+	xi_atomic_xchg32(&xg_mem_track_state, XG_MEM_TRACK_ON | XG_MEM_TRACK_EVER);
+	xg_mem_track_unlock();
+
+	return XI_MEM_RV_OK;
+}
+
+xvoid xi_mem_track_stop() {
+	xg_mem_track_lock();
+	if (xg_mem_track_state & XG_MEM_TRACK_EVER) {
+		// the frees still look for the header
+		xi_atomic_xchg32(&xg_mem_track_state, XG_MEM_TRACK_EVER);
+	}
+	xg_mem_track_unlock();
+}
+
+xint32 xi_mem_track_tag(const xchar *name) {
+	xuint32 i;
+	xint32 tag;
+
+	if (name == NULL) {
+		return XI_MEM_RV_ERR_ARGS;
+	}
+
+	xg_mem_track_lock();
+	for (i = 0; i < _g_mem_tag_count; i++) {
+		if (xi_strncmp(_g_mem_tags[i].name, name, XG_MEM_TAG_NAME - 1) == 0) {
+			xg_mem_track_unlock();
+			return (xint32) i;
+		}
+	}
+	if (_g_mem_tag_count == XI_MEM_TAG_MAX) {
+		xg_mem_track_unlock();
+		return XI_MEM_RV_ERR_FULL;
+	}
+	tag = (xint32) _g_mem_tag_count;
+	xi_strncpy(_g_mem_tags[tag].name, name, XG_MEM_TAG_NAME - 1);
+	xi_atomic_inc32(&_g_mem_tag_count);
+	xg_mem_track_unlock();
+
+	return tag;
+}
+
+xint32 xi_mem_track_tag_set(xint32 tag) {
+	xg_mem_thr_t *thr;
+	xint32 old;
+
+	if (tag < 0 || (xuint32) tag >= xi_atomic_read32(&_g_mem_tag_count)) {
+		return XI_MEM_RV_ERR_ARGS;
+	}
+
+	xg_mem_track_lock();
+	if (!xg_mem_track_init()) {
+		xg_mem_track_unlock();
+		return XI_MEM_RV_ERR_OP;
+	}
+	xg_mem_track_unlock();
+
+	thr = xg_mem_track_thr(TRUE);
+	if (thr == NULL) {
+		return XI_MEM_RV_ERR_OP;
+	}
+	old = (xint32) thr->tag;
+	thr->tag = (xuint32) tag;
+
+	return old;
+}
+
+xi_mem_re xi_mem_track_stat(xint32 tag, xi_mem_stat_t *stat) {
+	xg_mem_tag_t *t;
+
+	if (tag < 0 || (xuint32) tag >= xi_atomic_read32(&_g_mem_tag_count)
+			|| stat == NULL) {
+		return XI_MEM_RV_ERR_ARGS;
+	}
+
+	t = &_g_mem_tags[tag];
+	stat->bytes = xi_atomic_read64(&t->bytes);
+	stat->bytes_peak = xi_atomic_read64(&t->bytes_peak);
+	stat->count = xi_atomic_read64(&t->count);
+	stat->count_peak = xi_atomic_read64(&t->count_peak);
+
+	return XI_MEM_RV_OK;
+}
+
+xvoid xi_mem_track_dump(xi_logger_t *logger, xuint32 nsites) {
+	xg_mem_site_t top[XG_MEM_DUMP_MAX];
+	xi_mem_stat_t stat;
+	xuint32 i, j, k, n = 0;
+	xint32 f;
+	xchar frames[XG_MEM_SITE_DEPTH * 20];
+	xsize off;
+
+	for (i = 0; i < xi_atomic_read32(&_g_mem_tag_count); i++) {
+		xi_mem_track_stat((xint32) i, &stat);
+		if (stat.count_peak == 0) {
+			continue;
+		}
+		xi_logger_write(logger, XI_LOG_LEVEL_INFO, __FILE__, __FUNCTION__,
+				__LINE__, "mem tag=%s bytes=%llu (peak %llu) count=%llu (peak %llu)\n",
+				_g_mem_tags[i].name, stat.bytes, stat.bytes_peak, stat.count,
+				stat.count_peak);
+	}
+
+	if (nsites > XG_MEM_DUMP_MAX) {
+		nsites = XG_MEM_DUMP_MAX;
+	}
+
+	// copy the sites holding the most, and write them out of the lock,
+	// since the logger may allocate
+	xg_mem_track_lock();
+	for (i = 0; i < XG_MEM_SITE_MAX; i++) {
+		if (_g_mem_sites[i].hash == 0 || _g_mem_sites[i].live_bytes == 0) {
+			continue;
+		}
+		for (j = 0; j < n && top[j].live_bytes >= _g_mem_sites[i].live_bytes; j++) {
+			// find the place
+		}
+		if (j == nsites) {
+			continue;
+		}
+		if (n < nsites) {
+			n++;
+		}
+		for (k = n - 1; k > j; k--) {
+			top[k] = top[k - 1];
+		}
+		top[j] = _g_mem_sites[i];
+	}
+	xg_mem_track_unlock();
+
+	for (i = 0; i < n; i++) {
+		off = 0;
+		frames[0] = '\0';
+		for (f = 0; f < top[i].depth && off < sizeof(frames); f++) {
+			j = (xuint32) xi_snprintf(frames + off, sizeof(frames) - off, " %p",
+					top[i].frames[f]);
+			off = (j >= sizeof(frames) - off) ? sizeof(frames) : off + j;
+		}
+		xi_logger_write(logger, XI_LOG_LEVEL_INFO, __FILE__, __FUNCTION__,
+				__LINE__, "mem site tag=%s live=%u (%llu bytes) samples=%u (~%llu allocs) at%s\n",
+				_g_mem_tags[top[i].tag].name, top[i].live, top[i].live_bytes,
+				top[i].samples, (xuint64) top[i].samples * _g_mem_sample,
+				frames);
+	}
+}
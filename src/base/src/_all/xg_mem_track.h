@@ -0,0 +1,52 @@
+/*
+ * Copyright 2013 Cheolmin Jo (webos21@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * File   : xg_mem_track.h
+ */
+
+#ifndef _XG_MEM_TRACK_H_
+#define _XG_MEM_TRACK_H_
+
+#include "xi/xi_mem.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#pragma intrinsic(_ReturnAddress)
+#define XG_MEM_CALLER()    _ReturnAddress()
+#else
+#define XG_MEM_CALLER()    __builtin_return_address(0)
+#endif
+
+#define XG_MEM_TRACK_ON    0x1   // the new allocations are tracked
+#define XG_MEM_TRACK_EVER  0x2   // some allocations may have the header
+
+_XI_API_INTERN extern volatile xuint32 xg_mem_track_state;
+
+// the allocator of the system (xg_mem.c of each platform)
+_XI_API_INTERN xvoid  *xg_mem_raw_alloc(xsize size);
+_XI_API_INTERN xvoid  *xg_mem_raw_calloc(xsize nmemb, xsize size);
+_XI_API_INTERN xvoid  *xg_mem_raw_realloc(xvoid *ptr, xsize size);
+_XI_API_INTERN xvoid   xg_mem_raw_free(xvoid *ptr);
+_XI_API_INTERN xint32  xg_mem_backtrace(xvoid **frames, xint32 max);
+
+// the tracking allocator (xg_mem_track.c)
+// the caller is XG_MEM_CALLER() of xi_mem_*, where the sampled call stack starts
+_XI_API_INTERN xvoid  *xg_mem_track_alloc(xsize size, xbool zero, xvoid *caller);
+_XI_API_INTERN xvoid  *xg_mem_track_realloc(xvoid *ptr, xsize size, xvoid *caller);
+_XI_API_INTERN xvoid   xg_mem_track_free(xvoid *ptr);
+
+#endif // _XG_MEM_TRACK_H_
@@ -0,0 +1,488 @@
+/*
+ * Copyright 2013 Cheolmin Jo (webos21@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * File : xg_queue.c
+ */
+
+#include "xi/xi_queue.h"
+
+#include "xi/xi_atomic.h"
+#include "xi/xi_clock.h"
+#include "xi/xi_mem.h"
+#include "xi/xi_thread.h"
+
+// ----------------------------------------------
+// Inner Structures
+// ----------------------------------------------
+
+#define XG_QUEUE_CACHELINE   64
+#define XG_QUEUE_SPIN        128       // tries of put/take before sleeping
+#define XG_QUEUE_CAP_MAX     0x40000000
+
+/*
+ * The sleepers on one side of a queue. The other side checks 'waiters'
+ * after its push/pop (with a full fence against the registration below),
+ * and takes the lock only when somebody sleeps.
+ */
+typedef struct _st_queue_wait {
+	volatile xuint32 waiters;
+	xi_thread_mutex_t lock;
+	xi_thread_cond_t cond;
+} xg_queue_wait_t;
+
+/*
+ * SPSC : Lamport's ring. Each index is written by one side only, and each
+ * side caches the last seen index of the other side, so that it touches
+ * the other's cache line only when the ring looks full (or empty).
+ */
+struct _xi_queue_spsc {
+	// consumer
+	volatile xuint32 head;
+	xuint32 tail_cache;
+	xchar pad0[XG_QUEUE_CACHELINE - 2 * sizeof(xuint32)];
+
+	// producer
+	volatile xuint32 tail;
+	xuint32 head_cache;
+	xchar pad1[XG_QUEUE_CACHELINE - 2 * sizeof(xuint32)];
+
+	xuint32 mask;
+	xvoid **ring;
+	xg_queue_wait_t wput;   // producer waiting for room
+	xg_queue_wait_t wtake;  // consumer waiting for an item
+};
+
+/*
+ * MPMC : D. Vyukov's bounded queue. A cell's sequence tells whose turn it
+ * is : pos for the producer of pos, pos + 1 for the consumer of pos.
+ * The producers (consumers) claim a position with a CAS on enq (deq).
+ */
+typedef struct _st_queue_cell {
+	volatile xuint32 seq;
+	xvoid *data;
+} xg_queue_cell_t;
+
+struct _xi_queue_mpmc {
+	xchar pad0[XG_QUEUE_CACHELINE];
+	volatile xuint32 enq;
+	xchar pad1[XG_QUEUE_CACHELINE - sizeof(xuint32)];
+	volatile xuint32 deq;
+	xchar pad2[XG_QUEUE_CACHELINE - sizeof(xuint32)];
+
+	xuint32 mask;
+	xg_queue_cell_t *cells;
+	xg_queue_wait_t wput;
+	xg_queue_wait_t wtake;
+};
+
+// the non-blocking operation of put/take, without waking the other side
+typedef xi_queue_re (*xg_queue_op)(xvoid *q, xvoid **item);
+
+// ----------------------------------------------
+// Inner Functions
+// ----------------------------------------------
+
+static xuint32 xg_queue_pow2(xuint32 capacity) {
+	xuint32 size = 2;
+
+	while (size < capacity) {
+		size <<= 1;
+	}
+	return size;
+}
+
+static xint32 xg_queue_wait_init(xg_queue_wait_t *w) {
+	w->waiters = 0;
+	if (xi_thread_mutex_create(&w->lock, "queue") != XI_MUTEX_RV_OK) {
+		return -1;
+	}
+	if (xi_thread_cond_create(&w->cond, "queue") != XI_COND_RV_OK) {
+		xi_thread_mutex_destroy(&w->lock);
+		return -1;
+	}
+	return 0;
+}
+
+static xvoid xg_queue_wait_fini(xg_queue_wait_t *w) {
+	xi_thread_cond_destroy(&w->cond);
+	xi_thread_mutex_destroy(&w->lock);
+}
+
+_XI_INLINE xvoid xg_queue_wake(xg_queue_wait_t *w) {
+	xi_atomic_fence(XI_ATOMIC_SEQ_CST);
+	if (xi_atomic_load32_explicit(&w->waiters, XI_ATOMIC_RELAXED) > 0) {
+		xi_thread_mutex_lock(&w->lock);
+		xi_thread_cond_broadcast(&w->cond);
+		xi_thread_mutex_unlock(&w->lock);
+	}
+}
+
+/*
+ * Retry 'op' until it succeeds or 'msec' passes : spin first, then sleep
+ * on 'w'. A sleeper registers itself and retries under the lock, so that
+ * an item (room) made after the retry is followed by a wake-up.
+ * The sleepers of the other side ('ow') are woken up out of the lock.
+ */
+static xi_queue_re xg_queue_block(xvoid *q, xg_queue_op op, xvoid **item,
+		xg_queue_wait_t *w, xg_queue_wait_t *ow, xint32 msec) {
+	xi_queue_re ret;
+	xint32 spin;
+	xint64 now, until = 0;
+
+	for (spin = 0; spin < XG_QUEUE_SPIN; spin++) {
+		ret = op(q, item);
+		if (ret == XI_QUEUE_RV_OK) {
+			xg_queue_wake(ow);
+			return ret;
+		}
+		if (msec == 0) {
+			return ret;
+		}
+		if (spin >= (XG_QUEUE_SPIN / 2)) {
+			xi_thread_yield();
+		}
+	}
+
+	if (msec > 0) {
+		until = xi_clock_ntick() + ((xint64) msec * 1000000LL);
+	}
+
+	xi_thread_mutex_lock(&w->lock);
+	for (;;) {
+		xi_atomic_add32_explicit(&w->waiters, 1, XI_ATOMIC_SEQ_CST);
+		ret = op(q, item);
+		if (ret == XI_QUEUE_RV_OK) {
+			xi_atomic_sub32_explicit(&w->waiters, 1, XI_ATOMIC_RELAXED);
+			break;
+		}
+		if (msec < 0) {
+			xi_thread_cond_wait(&w->cond, &w->lock);
+		} else {
+			now = xi_clock_ntick();
+			if (now >= until) {
+				xi_atomic_sub32_explicit(&w->waiters, 1, XI_ATOMIC_RELAXED);
+				ret = XI_QUEUE_RV_ERR_TIMEOUT;
+				break;
+			}
+			xi_thread_cond_timedwait(&w->cond, &w->lock,
+					(xuint32) ((until - now + 999999LL) / 1000000LL));
+		}
+		xi_atomic_sub32_explicit(&w->waiters, 1, XI_ATOMIC_RELAXED);
+	}
+	xi_thread_mutex_unlock(&w->lock);
+
+	if (ret == XI_QUEUE_RV_OK) {
+		xg_queue_wake(ow);
+	}
+	return ret;
+}
+
+// ----------------------------------------------
+// XI Functions - SPSC
+// ----------------------------------------------
+
+xi_queue_spsc_t *xi_queue_spsc_create(xuint32 capacity) {
+	xi_queue_spsc_t *q;
+
+	if (capacity == 0 || capacity > XG_QUEUE_CAP_MAX) {
+		return NULL;
+	}
+
+	q = xi_mem_calloc(1, sizeof(xi_queue_spsc_t));
+	if (q == NULL) {
+		return NULL;
+	}
+
+	q->mask = xg_queue_pow2(capacity) - 1;
+	q->ring = xi_mem_calloc(q->mask + 1, sizeof(xvoid *));
+	if (q->ring == NULL) {
+		xi_mem_free(q);
+		return NULL;
+	}
+
+	if (xg_queue_wait_init(&q->wput) != 0) {
+		xi_mem_free(q->ring);
+		xi_mem_free(q);
+		return NULL;
+	}
+	if (xg_queue_wait_init(&q->wtake) != 0) {
+		xg_queue_wait_fini(&q->wput);
+		xi_mem_free(q->ring);
+		xi_mem_free(q);
+		return NULL;
+	}
+
+	return q;
+}
+
+static xi_queue_re xg_queue_spsc_push(xvoid *qp, xvoid **item) {
+	xi_queue_spsc_t *q = qp;
+	xuint32 tail;
+
+	tail = q->tail;
+	if (tail - q->head_cache > q->mask) {
+		q->head_cache = xi_atomic_load32_explicit(&q->head, XI_ATOMIC_ACQUIRE);
+		if (tail - q->head_cache > q->mask) {
+			return XI_QUEUE_RV_ERR_FULL;
+		}
+	}
+
+	q->ring[tail & q->mask] = (*item);
+	xi_atomic_store32_explicit(&q->tail, tail + 1, XI_ATOMIC_RELEASE);
+
+	return XI_QUEUE_RV_OK;
+}
+
+static xi_queue_re xg_queue_spsc_pop(xvoid *qp, xvoid **item) {
+	xi_queue_spsc_t *q = qp;
+	xuint32 head;
+
+	head = q->head;
+	if (head == q->tail_cache) {
+		q->tail_cache = xi_atomic_load32_explicit(&q->tail, XI_ATOMIC_ACQUIRE);
+		if (head == q->tail_cache) {
+			return XI_QUEUE_RV_ERR_EMPTY;
+		}
+	}
+
+	(*item) = q->ring[head & q->mask];
+	xi_atomic_store32_explicit(&q->head, head + 1, XI_ATOMIC_RELEASE);
+
+	return XI_QUEUE_RV_OK;
+}
+
+xi_queue_re xi_queue_spsc_push(xi_queue_spsc_t *q, xvoid *item) {
+	if (q == NULL) {
+		return XI_QUEUE_RV_ERR_ARGS;
+	}
+	if (xg_queue_spsc_push(q, &item) != XI_QUEUE_RV_OK) {
+		return XI_QUEUE_RV_ERR_FULL;
+	}
+	xg_queue_wake(&q->wtake);
+	return XI_QUEUE_RV_OK;
+}
+
+xi_queue_re xi_queue_spsc_pop(xi_queue_spsc_t *q, xvoid **item) {
+	if (q == NULL || item == NULL) {
+		return XI_QUEUE_RV_ERR_ARGS;
+	}
+	if (xg_queue_spsc_pop(q, item) != XI_QUEUE_RV_OK) {
+		return XI_QUEUE_RV_ERR_EMPTY;
+	}
+	xg_queue_wake(&q->wput);
+	return XI_QUEUE_RV_OK;
+}
+
+xi_queue_re xi_queue_spsc_put(xi_queue_spsc_t *q, xvoid *item, xint32 msec) {
+	if (q == NULL) {
+		return XI_QUEUE_RV_ERR_ARGS;
+	}
+	return xg_queue_block(q, xg_queue_spsc_push, &item, &q->wput, &q->wtake, msec);
+}
+
+xi_queue_re xi_queue_spsc_take(xi_queue_spsc_t *q, xvoid **item, xint32 msec) {
+	if (q == NULL || item == NULL) {
+		return XI_QUEUE_RV_ERR_ARGS;
+	}
+	return xg_queue_block(q, xg_queue_spsc_pop, item, &q->wtake, &q->wput, msec);
+}
+
+xuint32 xi_queue_spsc_count(xi_queue_spsc_t *q) {
+	if (q == NULL) {
+		return 0;
+	}
+	return xi_atomic_load32_explicit(&q->tail, XI_ATOMIC_ACQUIRE)
+			- xi_atomic_load32_explicit(&q->head, XI_ATOMIC_ACQUIRE);
+}
+
+xi_queue_re xi_queue_spsc_destroy(xi_queue_spsc_t *q) {
+	if (q == NULL) {
+		return XI_QUEUE_RV_ERR_ARGS;
+	}
+
+	xg_queue_wait_fini(&q->wtake);
+	xg_queue_wait_fini(&q->wput);
+	xi_mem_free(q->ring);
+	xi_mem_free(q);
+
+	return XI_QUEUE_RV_OK;
+}
+
+// ----------------------------------------------
+// XI Functions - MPMC
+// ----------------------------------------------
+
+xi_queue_mpmc_t *xi_queue_mpmc_create(xuint32 capacity) {
+	xuint32 i;
+	xi_queue_mpmc_t *q;
+
+	if (capacity == 0 || capacity > XG_QUEUE_CAP_MAX) {
+		return NULL;
+	}
+
+	q = xi_mem_calloc(1, sizeof(xi_queue_mpmc_t));
+	if (q == NULL) {
+		return NULL;
+	}
+
+	q->mask = xg_queue_pow2(capacity) - 1;
+	q->cells = xi_mem_calloc(q->mask + 1, sizeof(xg_queue_cell_t));
+	if (q->cells == NULL) {
+		xi_mem_free(q);
+		return NULL;
+	}
+	for (i = 0; i <= q->mask; i++) {
+		q->cells[i].seq = i;
+	}
+
+	if (xg_queue_wait_init(&q->wput) != 0) {
+		xi_mem_free(q->cells);
+		xi_mem_free(q);
+		return NULL;
+	}
+	if (xg_queue_wait_init(&q->wtake) != 0) {
+		xg_queue_wait_fini(&q->wput);
+		xi_mem_free(q->cells);
+		xi_mem_free(q);
+		return NULL;
+	}
+
+	return q;
+}
+
+static xi_queue_re xg_queue_mpmc_push(xvoid *qp, xvoid **item) {
+	xi_queue_mpmc_t *q = qp;
+	xuint32 pos, seq, old;
+	xint32 dif;
+	xg_queue_cell_t *cell;
+
+	pos = xi_atomic_load32_explicit(&q->enq, XI_ATOMIC_RELAXED);
+	for (;;) {
+		cell = &q->cells[pos & q->mask];
+		seq = xi_atomic_load32_explicit(&cell->seq, XI_ATOMIC_ACQUIRE);
+		dif = (xint32) (seq - pos);
+		if (dif == 0) {
+			old = xi_atomic_cas32_explicit(&q->enq, pos + 1, pos, XI_ATOMIC_RELAXED);
+			if (old == pos) {
+				break;
+			}
+			pos = old;
+		} else if (dif < 0) {
+			// the consumer of (pos - size) has not finished
+			return XI_QUEUE_RV_ERR_FULL;
+		} else {
+			pos = xi_atomic_load32_explicit(&q->enq, XI_ATOMIC_RELAXED);
+		}
+	}
+
+	cell->data = (*item);
+	xi_atomic_store32_explicit(&cell->seq, pos + 1, XI_ATOMIC_RELEASE);
+
+	return XI_QUEUE_RV_OK;
+}
+
+static xi_queue_re xg_queue_mpmc_pop(xvoid *qp, xvoid **item) {
+	xi_queue_mpmc_t *q = qp;
+	xuint32 pos, seq, old;
+	xint32 dif;
+	xg_queue_cell_t *cell;
+
+	pos = xi_atomic_load32_explicit(&q->deq, XI_ATOMIC_RELAXED);
+	for (;;) {
+		cell = &q->cells[pos & q->mask];
+		seq = xi_atomic_load32_explicit(&cell->seq, XI_ATOMIC_ACQUIRE);
+		dif = (xint32) (seq - (pos + 1));
+		if (dif == 0) {
+			old = xi_atomic_cas32_explicit(&q->deq, pos + 1, pos, XI_ATOMIC_RELAXED);
+			if (old == pos) {
+				break;
+			}
+			pos = old;
+		} else if (dif < 0) {
+			// the producer of pos has not finished
+			return XI_QUEUE_RV_ERR_EMPTY;
+		} else {
+			pos = xi_atomic_load32_explicit(&q->deq, XI_ATOMIC_RELAXED);
+		}
+	}
+
+	(*item) = cell->data;
+	xi_atomic_store32_explicit(&cell->seq, pos + q->mask + 1, XI_ATOMIC_RELEASE);
+
+	return XI_QUEUE_RV_OK;
+}
+
+xi_queue_re xi_queue_mpmc_push(xi_queue_mpmc_t *q, xvoid *item) {
+	if (q == NULL) {
+		return XI_QUEUE_RV_ERR_ARGS;
+	}
+	if (xg_queue_mpmc_push(q, &item) != XI_QUEUE_RV_OK) {
+		return XI_QUEUE_RV_ERR_FULL;
+	}
+	xg_queue_wake(&q->wtake);
+	return XI_QUEUE_RV_OK;
+}
+
+xi_queue_re xi_queue_mpmc_pop(xi_queue_mpmc_t *q, xvoid **item) {
+	if (q == NULL || item == NULL) {
+		return XI_QUEUE_RV_ERR_ARGS;
+	}
+	if (xg_queue_mpmc_pop(q, item) != XI_QUEUE_RV_OK) {
+		return XI_QUEUE_RV_ERR_EMPTY;
+	}
+	xg_queue_wake(&q->wput);
+	return XI_QUEUE_RV_OK;
+}
+
+xi_queue_re xi_queue_mpmc_put(xi_queue_mpmc_t *q, xvoid *item, xint32 msec) {
+	if (q == NULL) {
+		return XI_QUEUE_RV_ERR_ARGS;
+	}
+	return xg_queue_block(q, xg_queue_mpmc_push, &item, &q->wput, &q->wtake, msec);
+}
+
+xi_queue_re xi_queue_mpmc_take(xi_queue_mpmc_t *q, xvoid **item, xint32 msec) {
+	if (q == NULL || item == NULL) {
+		return XI_QUEUE_RV_ERR_ARGS;
+	}
+	return xg_queue_block(q, xg_queue_mpmc_pop, item, &q->wtake, &q->wput, msec);
+}
+
+xuint32 xi_queue_mpmc_count(xi_queue_mpmc_t *q) {
+	xuint32 enq, deq;
+
+	if (q == NULL) {
+		return 0;
+	}
+
+	deq = xi_atomic_load32_explicit(&q->deq, XI_ATOMIC_ACQUIRE);
+	enq = xi_atomic_load32_explicit(&q->enq, XI_ATOMIC_ACQUIRE);
+	return ((xint32) (enq - deq) > 0) ? (enq - deq) : 0;
+}
+
+xi_queue_re xi_queue_mpmc_destroy(xi_queue_mpmc_t *q) {
+	if (q == NULL) {
+		return XI_QUEUE_RV_ERR_ARGS;
+	}
+
+	xg_queue_wait_fini(&q->wtake);
+	xg_queue_wait_fini(&q->wput);
+	xi_mem_free(q->cells);
+	xi_mem_free(q);
+
+	return XI_QUEUE_RV_OK;
+}
@@ -0,0 +1,139 @@
+/*
+ * Copyright 2013 Cheolmin Jo (webos21@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * File : xg_socket_lgroup.c
+ */
+
+#include "xi/xi_socket.h"
+
+#include "xi/xi_mem.h"
+
+// ----------------------------------------------
+// Inner Structures
+// ----------------------------------------------
+
+struct _xi_sock_lgroup {
+	xint32 count;
+	xint32 fds[1];
+};
+
+// ----------------------------------------------
+// Inner Functions
+// ----------------------------------------------
+
+static xint32 xg_lgroup_listener(const xi_sock_addr_bin_t *baddr,
+		xint32 backlog, xbool *shared) {
+	xint32 sfd;
+
+	sfd = xi_socket_open((xi_sock_family_e) baddr->family,
+			XI_SOCK_TYPE_STREAM, XI_SOCK_PROTO_TCP);
+	if (sfd < 0) {
+		return sfd;
+	}
+
+	xi_socket_opt_set(sfd, XI_SOCK_OPT_REUSEADDR, TRUE);
+	*shared = (xi_socket_opt_set(sfd, XI_SOCK_OPT_REUSEPORT, TRUE)
+			== XI_SOCK_RV_OK);
+
+	if (xi_socket_bind_bin(sfd, baddr) != XI_SOCK_RV_OK
+			|| xi_socket_listen(sfd, backlog) != XI_SOCK_RV_OK) {
+		xi_socket_close(sfd);
+		return XI_SOCK_RV_ERR_INUSE;
+	}
+
+	return sfd;
+}
+
+// ----------------------------------------------
+// XI Functions
+// ----------------------------------------------
+
+xi_sock_lgroup_t *xi_socket_lgroup_open(const xi_sock_addr_bin_t *baddr,
+		xint32 count, xint32 backlog) {
+	xint32 i;
+	xbool shared = FALSE;
+	xi_sock_addr_bin_t addr;
+	xi_sock_lgroup_t *grp;
+
+	if (baddr == NULL || count <= 0) {
+		return NULL;
+	}
+
+	grp = xi_mem_calloc(1, sizeof(xi_sock_lgroup_t) + sizeof(xint32)
+			* (count - 1));
+	if (grp == NULL) {
+		return NULL;
+	}
+
+	addr = *baddr;
+	for (i = 0; i < count; i++) {
+		grp->fds[i] = xg_lgroup_listener(&addr, backlog, &shared);
+		if (grp->fds[i] < 0) {
+			xi_socket_lgroup_close(grp);
+			return NULL;
+		}
+		grp->count++;
+
+		if (i == 0) {
+			if (!shared) {
+				// every worker accepts on the single listener
+				break;
+			}
+			if (addr.port == 0) {
+				// the others follow the port picked by the first one
+				xi_sock_addr_bin_t laddr;
+				if (xi_socket_get_local_bin(grp->fds[0], &laddr)
+						!= XI_SOCK_RV_OK) {
+					xi_socket_lgroup_close(grp);
+					return NULL;
+				}
+				addr.port = laddr.port;
+			}
+		}
+	}
+
+	return grp;
+}
+
+xint32 xi_socket_lgroup_count(xi_sock_lgroup_t *grp) {
+	if (grp == NULL) {
+		return XI_SOCK_RV_ERR_ARGS;
+	}
+	return grp->count;
+}
+
+xint32 xi_socket_lgroup_fd(xi_sock_lgroup_t *grp, xint32 idx) {
+	if (grp == NULL || idx < 0) {
+		return XI_SOCK_RV_ERR_ARGS;
+	}
+	return grp->fds[idx % grp->count];
+}
+
+xi_sock_re xi_socket_lgroup_close(xi_sock_lgroup_t *grp) {
+	xint32 i;
+
+	if (grp == NULL) {
+		return XI_SOCK_RV_ERR_ARGS;
+	}
+
+	for (i = 0; i < grp->count; i++) {
+		xi_socket_close(grp->fds[i]);
+	}
+	xi_mem_free(grp);
+
+	return XI_SOCK_RV_OK;
+}
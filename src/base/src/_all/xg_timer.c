@@ -0,0 +1,460 @@
+/*
+ * Copyright 2013 Cheolmin Jo (webos21@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * File : xg_timer.c
+ */
+
+#include "xi/xi_timer.h"
+
+#include "xi/xi_clock.h"
+#include "xi/xi_mem.h"
+
+// ----------------------------------------------
+// Inner Structures
+// ----------------------------------------------
+
+/*
+ * Level 0 has a bucket per tick, and each upper level has a bucket per
+ * the whole span of the level below it (256 ticks, 16K ticks, 1M ticks).
+ * A far timer waits in an upper level, and is moved down (cascaded)
+ * when the wheel below it wraps around. The wheels span 2^26 ticks;
+ * a farther timer is parked in the last bucket and cascaded again.
+ */
+#define XG_TIMER_L0_BITS     8
+#define XG_TIMER_LN_BITS     6
+#define XG_TIMER_L0_SIZE     (1 << XG_TIMER_L0_BITS)
+#define XG_TIMER_LN_SIZE     (1 << XG_TIMER_LN_BITS)
+#define XG_TIMER_L0_MASK     (XG_TIMER_L0_SIZE - 1)
+#define XG_TIMER_LN_MASK     (XG_TIMER_LN_SIZE - 1)
+#define XG_TIMER_LEVELS      4
+#define XG_TIMER_SHIFT(l)    (XG_TIMER_L0_BITS + ((l) - 1) * XG_TIMER_LN_BITS)
+#define XG_TIMER_SPAN        (((xuint64) 1) << XG_TIMER_SHIFT(XG_TIMER_LEVELS))
+#define XG_TIMER_BUCKET(l,i) (((l) == 0) ? (i) : \
+		(XG_TIMER_L0_SIZE + ((l) - 1) * XG_TIMER_LN_SIZE + (i)))
+#define XG_TIMER_BUCKETS     XG_TIMER_BUCKET(XG_TIMER_LEVELS, 0)
+#define XG_TIMER_FIRING      XG_TIMER_BUCKETS  // expired, to be called
+#define XG_TIMER_NONE        (-1)
+#define XG_TIMER_NODES_INIT  64
+#define XG_TIMER_NSEC_MSEC   1000000LL
+
+typedef struct _st_timer_node {
+	xuint64 expire;     // tick
+	xuint32 interval;   // ticks, 0 for a one-shot timer
+	xuint32 gen;
+	xi_timer_fn func;
+	xvoid *arg;
+	xint32 prev;
+	xint32 next;        // also the link of the free-list
+	xint32 bucket;      // XG_TIMER_NONE if the node is free
+} xg_timer_node_t;
+
+struct _xi_timer {
+	xg_timer_node_t *nodes;
+	xint32 size;
+	xint32 used;
+	xint32 free;
+	xuint64 now;        // the next tick to be processed
+	xint64 res;         // nanoseconds of a tick
+	xint64 base;        // xi_clock_ntick() of the tick 0
+	xint32 lcnt[XG_TIMER_LEVELS];
+	xint32 heads[XG_TIMER_BUCKETS + 1];
+};
+
+// ----------------------------------------------
+// Inner Functions
+// ----------------------------------------------
+
+static xint32 xg_timer_level(xint32 bucket) {
+	if (bucket < XG_TIMER_L0_SIZE) {
+		return 0;
+	}
+	return 1 + ((bucket - XG_TIMER_L0_SIZE) >> XG_TIMER_LN_BITS);
+}
+
+static xuint64 xg_timer_tick(xi_timer_t *timer, xint64 ntick) {
+	if (ntick <= timer->base) {
+		return 0;
+	}
+	return (xuint64) ((ntick - timer->base) / timer->res);
+}
+
+static xint64 xg_timer_id(xi_timer_t *timer, xint32 idx) {
+	return (((xint64) (timer->nodes[idx].gen & 0x7FFFFFFF)) << 32) | idx;
+}
+
+static xvoid xg_timer_link(xi_timer_t *timer, xint32 idx, xint32 bucket) {
+	xg_timer_node_t *node = &(timer->nodes[idx]);
+
+	node->bucket = bucket;
+	node->prev = XG_TIMER_NONE;
+	node->next = timer->heads[bucket];
+	if (node->next != XG_TIMER_NONE) {
+		timer->nodes[node->next].prev = idx;
+	}
+	timer->heads[bucket] = idx;
+
+	if (bucket != XG_TIMER_FIRING) {
+		timer->lcnt[xg_timer_level(bucket)]++;
+	}
+}
+
+static xvoid xg_timer_unlink(xi_timer_t *timer, xint32 idx) {
+	xg_timer_node_t *node = &(timer->nodes[idx]);
+
+	if (node->prev != XG_TIMER_NONE) {
+		timer->nodes[node->prev].next = node->next;
+	} else {
+		timer->heads[node->bucket] = node->next;
+	}
+	if (node->next != XG_TIMER_NONE) {
+		timer->nodes[node->next].prev = node->prev;
+	}
+
+	if (node->bucket != XG_TIMER_FIRING) {
+		timer->lcnt[xg_timer_level(node->bucket)]--;
+	}
+	node->prev = node->next = XG_TIMER_NONE;
+}
+
+static xvoid xg_timer_insert(xi_timer_t *timer, xint32 idx) {
+	xg_timer_node_t *node = &(timer->nodes[idx]);
+	xuint64 expire, delta;
+	xint32 l;
+
+	if (node->expire < timer->now) {
+		node->expire = timer->now;
+	}
+
+	expire = node->expire;
+	delta = expire - timer->now;
+
+	if (delta < XG_TIMER_L0_SIZE) {
+		xg_timer_link(timer, idx,
+				XG_TIMER_BUCKET(0, (xint32) (expire & XG_TIMER_L0_MASK)));
+		return;
+	}
+
+	if (delta >= XG_TIMER_SPAN) {
+		expire = timer->now + XG_TIMER_SPAN - 1;
+		delta = XG_TIMER_SPAN - 1;
+	}
+
+	for (l = 1; l < XG_TIMER_LEVELS; l++) {
+		if (delta < (((xuint64) 1) << XG_TIMER_SHIFT(l + 1))) {
+			break;
+		}
+	}
+
+	xg_timer_link(timer, idx, XG_TIMER_BUCKET(l,
+			(xint32) ((expire >> XG_TIMER_SHIFT(l)) & XG_TIMER_LN_MASK)));
+}
+
+static xvoid xg_timer_cascade(xi_timer_t *timer, xint32 level) {
+	xint32 bucket = XG_TIMER_BUCKET(level,
+			(xint32) ((timer->now >> XG_TIMER_SHIFT(level)) & XG_TIMER_LN_MASK));
+
+	while (timer->heads[bucket] != XG_TIMER_NONE) {
+		xint32 idx = timer->heads[bucket];
+		xg_timer_unlink(timer, idx);
+		xg_timer_insert(timer, idx);
+	}
+}
+
+static xint32 xg_timer_alloc(xi_timer_t *timer) {
+	xint32 idx;
+
+	if (timer->free == XG_TIMER_NONE) {
+		xint32 i;
+		xint32 nsize = timer->size * 2;
+		xg_timer_node_t *nodes;
+
+		if (nsize <= timer->size) {
+			return XG_TIMER_NONE;
+		}
+
+		nodes = xi_mem_realloc(timer->nodes,
+				(xsize) nsize * sizeof(xg_timer_node_t));
+		if (nodes == NULL) {
+			return XG_TIMER_NONE;
+		}
+
+		for (i = timer->size; i < nsize; i++) {
+			nodes[i].gen = 0;
+			nodes[i].bucket = XG_TIMER_NONE;
+			nodes[i].next = (i + 1 < nsize) ? (i + 1) : XG_TIMER_NONE;
+		}
+		timer->free = timer->size;
+		timer->nodes = nodes;
+		timer->size = nsize;
+	}
+
+	idx = timer->free;
+	timer->free = timer->nodes[idx].next;
+	timer->used++;
+
+	return idx;
+}
+
+static xvoid xg_timer_release(xi_timer_t *timer, xint32 idx) {
+	xg_timer_node_t *node = &(timer->nodes[idx]);
+
+	node->gen++;
+	node->bucket = XG_TIMER_NONE;
+	node->func = NULL;
+	node->arg = NULL;
+	node->next = timer->free;
+	timer->free = idx;
+	timer->used--;
+}
+
+static xuint64 xg_timer_earliest(xi_timer_t *timer) {
+	xint32 j, l;
+	xuint64 best = XI_ULLONG_MAX;
+
+	if (timer->lcnt[0] > 0) {
+		for (j = 0; j < XG_TIMER_L0_SIZE; j++) {
+			if (timer->heads[(timer->now + j) & XG_TIMER_L0_MASK] != XG_TIMER_NONE) {
+				return timer->now + j;
+			}
+		}
+	}
+
+	// the earliest cascade is the upper bound of the earliest expiry
+	for (l = 1; l < XG_TIMER_LEVELS; l++) {
+		xint32 shift = XG_TIMER_SHIFT(l);
+		xuint64 cur = timer->now >> shift;
+		xint32 start = ((timer->now & ((((xuint64) 1) << shift) - 1)) == 0) ? 0 : 1;
+
+		if (timer->lcnt[l] == 0) {
+			continue;
+		}
+
+		for (j = start; j < start + XG_TIMER_LN_SIZE; j++) {
+			xint32 bucket = XG_TIMER_BUCKET(l, (xint32) ((cur + j) & XG_TIMER_LN_MASK));
+			if (timer->heads[bucket] != XG_TIMER_NONE) {
+				xuint64 tick = (cur + j) << shift;
+				if (tick < best) {
+					best = tick;
+				}
+				break;
+			}
+		}
+	}
+
+	return best;
+}
+
+// ----------------------------------------------
+// XI Functions
+// ----------------------------------------------
+
+xi_timer_t *xi_timer_create(xuint32 resolution) {
+	xint32 i;
+	xi_timer_t *timer;
+
+	timer = xi_mem_calloc(1, sizeof(xi_timer_t));
+	if (timer == NULL) {
+		return NULL;
+	}
+
+	timer->nodes = xi_mem_calloc(XG_TIMER_NODES_INIT, sizeof(xg_timer_node_t));
+	if (timer->nodes == NULL) {
+		xi_mem_free(timer);
+		return NULL;
+	}
+	for (i = 0; i < XG_TIMER_NODES_INIT; i++) {
+		timer->nodes[i].bucket = XG_TIMER_NONE;
+		timer->nodes[i].next = (i + 1 < XG_TIMER_NODES_INIT) ? (i + 1) : XG_TIMER_NONE;
+	}
+	timer->size = XG_TIMER_NODES_INIT;
+	timer->free = 0;
+
+	for (i = 0; i <= XG_TIMER_BUCKETS; i++) {
+		timer->heads[i] = XG_TIMER_NONE;
+	}
+
+	timer->res = ((resolution == 0) ? 1 : (xint64) resolution) * XG_TIMER_NSEC_MSEC;
+	timer->base = xi_clock_ntick();
+	timer->now = 0;
+
+	return timer;
+}
+
+xi_timer_re xi_timer_destroy(xi_timer_t *timer) {
+	if (timer == NULL) {
+		return XI_TIMER_RV_ERR_ARGS;
+	}
+
+	xi_mem_free(timer->nodes);
+	xi_mem_free(timer);
+
+	return XI_TIMER_RV_OK;
+}
+
+xint64 xi_timer_add(xi_timer_t *timer, xuint32 msecs, xuint32 interval,
+		xi_timer_fn func, xvoid *arg) {
+	xint32 idx;
+	xint64 due;
+	xg_timer_node_t *node;
+
+	if (timer == NULL || func == NULL) {
+		return XI_TIMER_RV_ERR_ARGS;
+	}
+
+	idx = xg_timer_alloc(timer);
+	if (idx == XG_TIMER_NONE) {
+		return XI_TIMER_RV_ERR_NOMEM;
+	}
+
+	node = &(timer->nodes[idx]);
+	node->func = func;
+	node->arg = arg;
+
+	// the first tick which starts after the due time : never early
+	due = xi_clock_ntick() + ((xint64) msecs * XG_TIMER_NSEC_MSEC) - timer->base;
+	node->expire = (due <= 0) ? 0 : (xuint64) ((due + timer->res - 1) / timer->res);
+	node->interval = (interval == 0) ? 0 : (xuint32) ((((xint64) interval
+			* XG_TIMER_NSEC_MSEC) + timer->res - 1) / timer->res);
+
+	xg_timer_insert(timer, idx);
+
+	return xg_timer_id(timer, idx);
+}
+
+xi_timer_re xi_timer_cancel(xi_timer_t *timer, xint64 tid) {
+	xint32 idx;
+
+	if (timer == NULL || tid < 0) {
+		return XI_TIMER_RV_ERR_ARGS;
+	}
+
+	idx = (xint32) (tid & 0xFFFFFFFF);
+	if (idx >= timer->size || timer->nodes[idx].bucket == XG_TIMER_NONE
+			|| xg_timer_id(timer, idx) != tid) {
+		return XI_TIMER_RV_ERR_NF;
+	}
+
+	xg_timer_unlink(timer, idx);
+	xg_timer_release(timer, idx);
+
+	return XI_TIMER_RV_OK;
+}
+
+xint32 xi_timer_count(xi_timer_t *timer) {
+	if (timer == NULL) {
+		return XI_TIMER_RV_ERR_ARGS;
+	}
+	return timer->used;
+}
+
+xint32 xi_timer_next(xi_timer_t *timer) {
+	xuint64 tick;
+	xint64 wait;
+
+	if (timer == NULL) {
+		return XI_TIMER_RV_ERR_ARGS;
+	}
+
+	if (timer->used == 0) {
+		return -1;
+	}
+
+	tick = xg_timer_earliest(timer);
+	if (tick == XI_ULLONG_MAX) {
+		return -1;
+	}
+
+	wait = timer->base + ((xint64) tick * timer->res) - xi_clock_ntick();
+	if (wait <= 0) {
+		return 0;
+	}
+
+	wait = (wait + XG_TIMER_NSEC_MSEC - 1) / XG_TIMER_NSEC_MSEC;
+	return (wait > XI_INT_MAX) ? XI_INT_MAX : (xint32) wait;
+}
+
+xint32 xi_timer_run(xi_timer_t *timer) {
+	xint32 fired = 0;
+	xuint64 target;
+
+	if (timer == NULL) {
+		return XI_TIMER_RV_ERR_ARGS;
+	}
+
+	target = xg_timer_tick(timer, xi_clock_ntick());
+
+	while (timer->now <= target) {
+		xuint64 tick = timer->now;
+		xint32 bucket;
+
+		if (timer->used == 0) {
+			timer->now = target + 1;
+			break;
+		}
+
+		if ((tick & XG_TIMER_L0_MASK) == 0) {
+			xint32 l;
+			for (l = 1; l < XG_TIMER_LEVELS; l++) {
+				xg_timer_cascade(timer, l);
+				if (((tick >> XG_TIMER_SHIFT(l)) & XG_TIMER_LN_MASK) != 0) {
+					break;
+				}
+			}
+		}
+
+		// the callbacks can add timers, which must not join this tick
+		bucket = XG_TIMER_BUCKET(0, (xint32) (tick & XG_TIMER_L0_MASK));
+		while (timer->heads[bucket] != XG_TIMER_NONE) {
+			xint32 idx = timer->heads[bucket];
+			xg_timer_unlink(timer, idx);
+			xg_timer_link(timer, idx, XG_TIMER_FIRING);
+		}
+		timer->now = tick + 1;
+
+		while (timer->heads[XG_TIMER_FIRING] != XG_TIMER_NONE) {
+			xint32 idx = timer->heads[XG_TIMER_FIRING];
+			xg_timer_node_t *node = &(timer->nodes[idx]);
+			xi_timer_fn func = node->func;
+			xvoid *arg = node->arg;
+			xint64 tid = xg_timer_id(timer, idx);
+
+			xg_timer_unlink(timer, idx);
+			if (node->expire > tick) {
+				xg_timer_insert(timer, idx);
+				continue;
+			}
+
+			if (node->interval > 0) {
+				node->expire = tick + node->interval;
+				xg_timer_insert(timer, idx);
+			} else {
+				xg_timer_release(timer, idx);
+			}
+
+			func(timer, tid, arg);
+			fired++;
+		}
+
+		// nothing to call until the next cascade
+		if (timer->lcnt[0] == 0 && timer->now <= target) {
+			xuint64 skip = (timer->now + XG_TIMER_L0_MASK) & ~((xuint64) XG_TIMER_L0_MASK);
+			timer->now = (skip < target + 1) ? skip : target + 1;
+		}
+	}
+
+	return fired;
+}
@@ -0,0 +1,783 @@
+/*
+ * Copyright 2013 Cheolmin Jo (webos21@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * File   : xg_aio.c
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#ifdef __linux__
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#define XG_AIO_EVENTFD
+#ifdef __NR_io_uring_setup
+#include <linux/io_uring.h>
+#ifdef IORING_FEAT_RW_CUR_POS
+// READ/WRITE/RECV/SEND/ACCEPT and the probe came with the same kernel (5.6)
+#define XG_AIO_URING
+#endif // IORING_FEAT_RW_CUR_POS
+#endif // __NR_io_uring_setup
+#endif // __linux__
+
+#include "xg_fd.h"
+
+#include "xi/xi_aio.h"
+#include "xi/xi_atomic.h"
+#include "xi/xi_log.h"
+#include "xi/xi_mem.h"
+#include "xi/xi_thread.h"
+
+// ----------------------------------------------
+// Inner Structure
+// ----------------------------------------------
+
+#define XG_AIO_THREADS_DEF   4
+#define XG_AIO_URING_MAX     4096
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL         0
+#endif
+
+#ifdef XG_AIO_URING
+typedef struct _st_aio_ring {
+	xint32 fd;
+	xuint32 sq_entries;
+	xuint32 sq_mask;
+	volatile xuint32 *sq_head;
+	volatile xuint32 *sq_tail;
+	xuint32 *sq_array;
+	struct io_uring_sqe *sqes;
+	xuint32 cq_mask;
+	volatile xuint32 *cq_head;
+	volatile xuint32 *cq_tail;
+	struct io_uring_cqe *cqes;
+	xvoid *sq_ptr;
+	xsize sq_len;
+	xvoid *cq_ptr;
+	xsize cq_len;
+	xsize sqe_len;
+} xg_aio_ring_t;
+#endif // XG_AIO_URING
+
+struct _xi_aio {
+	xint32 backend;
+	xint32 depth;
+	xint32 inflight;           // owner thread only
+	xint32 efd[2];             // [0] : read-end, [1] : write-end
+#ifdef XG_AIO_URING
+	xg_aio_ring_t ring;
+#endif // XG_AIO_URING
+	xi_thread_mutex_t lock;
+	xi_thread_cond_t cond;
+	xi_aio_req_t *qhead;       // guarded by lock
+	xi_aio_req_t *qtail;       // guarded by lock
+	xi_aio_req_t *dhead;       // guarded by lock
+	xi_aio_req_t *dtail;       // guarded by lock
+	xbool signaled;            // guarded by lock
+	xbool running;             // guarded by lock
+	xint32 alive;              // guarded by lock
+};
+
+// ----------------------------------------------
+// Inner Functions
+// ----------------------------------------------
+
+static xssize xg_aio_err(xint32 err) {
+	switch (err) {
+	case EAGAIN:
+#if EWOULDBLOCK != EAGAIN
+	case EWOULDBLOCK:
+#endif
+		return XI_AIO_RV_ERR_TRYLATER;
+	case EBADF:
+	case ENOTSOCK:
+		return XI_AIO_RV_ERR_FD;
+	case ECANCELED:
+	case EINTR:
+		return XI_AIO_RV_ERR_CANCELED;
+	case ENOMEM:
+	case ENOBUFS:
+		return XI_AIO_RV_ERR_NOMEM;
+	case EINVAL:
+	case EFAULT:
+		return XI_AIO_RV_ERR_ARGS;
+	default:
+		return XI_AIO_RV_ERR_OP;
+	}
+}
+
+/*
+ * The completion descriptor is an eventfd on linux, and a pipe on
+ * the other posix systems. io_uring signals the eventfd by itself.
+ */
+static xint32 xg_aio_notify_open(xint32 efd[2]) {
+#ifdef XG_AIO_EVENTFD
+	efd[0] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (efd[0] < 0) {
+		return -1;
+	}
+	efd[1] = efd[0];
+#else // !XG_AIO_EVENTFD
+	if (pipe(efd) < 0) {
+		return -1;
+	}
+	fcntl(efd[0], F_SETFL, fcntl(efd[0], F_GETFL) | O_NONBLOCK);
+	fcntl(efd[1], F_SETFL, fcntl(efd[1], F_GETFL) | O_NONBLOCK);
+	fcntl(efd[0], F_SETFD, FD_CLOEXEC);
+	fcntl(efd[1], F_SETFD, FD_CLOEXEC);
+#endif // XG_AIO_EVENTFD
+	return 0;
+}
+
+static xvoid xg_aio_notify_close(xint32 efd[2]) {
+	if (efd[0] >= 0) {
+		close(efd[0]);
+	}
+	if (efd[1] >= 0 && efd[1] != efd[0]) {
+		close(efd[1]);
+	}
+	efd[0] = efd[1] = -1;
+}
+
+static xvoid xg_aio_notify(xi_aio_t *aio) {
+	xssize rv;
+#ifdef XG_AIO_EVENTFD
+	xuint64 one = 1;
+	rv = write(aio->efd[1], &one, sizeof(one));
+#else // !XG_AIO_EVENTFD
+	xchar one = 1;
+	rv = write(aio->efd[1], &one, sizeof(one));
+#endif // XG_AIO_EVENTFD
+	// EAGAIN means that the owner is already signaled
+	if (rv < 0 && errno != EAGAIN) {
+		log_error(XDLOG, "cannot signal the completion (errno=%d)\n", errno);
+	}
+}
+
+static xvoid xg_aio_notify_drain(xi_aio_t *aio) {
+#ifdef XG_AIO_EVENTFD
+	xuint64 cnt;
+	// eventfd is reset by one read
+	if (read(aio->efd[0], &cnt, sizeof(cnt)) < 0) {
+		return;
+	}
+#else // !XG_AIO_EVENTFD
+	xchar buf[64];
+	while (read(aio->efd[0], buf, sizeof(buf)) > 0) {
+		// consume all
+	}
+#endif // XG_AIO_EVENTFD
+}
+
+static xint32 xg_aio_notify_wait(xi_aio_t *aio, xint32 msecs) {
+	xint32 rv;
+	struct pollfd pfd;
+
+	pfd.fd = aio->efd[0];
+	pfd.events = POLLIN;
+	pfd.revents = 0;
+
+	rv = poll(&pfd, 1, (msecs < 0) ? -1 : msecs);
+	return (rv > 0) ? 0 : -1;
+}
+
+/*
+ * The accepted socket has to be known to the descriptor table,
+ * like the one of xi_socket_accept.
+ */
+static xssize xg_aio_accepted(xi_aio_req_t *req, xint32 rsock) {
+	if (xg_fd_open(rsock, xg_fd_get(req->fd)) < 0) {
+		close(rsock);
+		return XI_AIO_RV_ERR_FD;
+	}
+	return rsock;
+}
+
+// ----------------------------------------------
+// Inner Functions : io_uring
+// ----------------------------------------------
+
+#ifdef XG_AIO_URING
+static xbool xg_aio_uring_probe(xint32 fd) {
+	xint32 i;
+	xbool ok = TRUE;
+	struct io_uring_probe *probe;
+	static const xint32 ops[] = { IORING_OP_READ, IORING_OP_WRITE,
+			IORING_OP_RECV, IORING_OP_SEND, IORING_OP_ACCEPT, IORING_OP_FSYNC };
+
+	probe = xi_mem_calloc(1, sizeof(*probe) + 256
+			* sizeof(struct io_uring_probe_op));
+	if (probe == NULL) {
+		return FALSE;
+	}
+	if (syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe, 256)
+			< 0) {
+		xi_mem_free(probe);
+		return FALSE;
+	}
+	for (i = 0; i < (xint32) (sizeof(ops) / sizeof(ops[0])); i++) {
+		if (ops[i] > probe->last_op
+				|| !(probe->ops[ops[i]].flags & IO_URING_OP_SUPPORTED)) {
+			ok = FALSE;
+			break;
+		}
+	}
+	xi_mem_free(probe);
+	return ok;
+}
+
+static xvoid xg_aio_uring_close(xg_aio_ring_t *r) {
+	if (r->sqes != NULL && r->sqes != MAP_FAILED) {
+		munmap(r->sqes, r->sqe_len);
+	}
+	if (r->cq_ptr != NULL && r->cq_ptr != MAP_FAILED) {
+		munmap(r->cq_ptr, r->cq_len);
+	}
+	if (r->sq_ptr != NULL && r->sq_ptr != MAP_FAILED) {
+		munmap(r->sq_ptr, r->sq_len);
+	}
+	if (r->fd >= 0) {
+		close(r->fd);
+	}
+	xi_mem_set(r, 0, sizeof(*r));
+	r->fd = -1;
+}
+
+static xint32 xg_aio_uring_open(xi_aio_t *aio) {
+	struct io_uring_params p;
+	xg_aio_ring_t *r = &aio->ring;
+	xuint32 entries = (aio->depth > XG_AIO_URING_MAX) ? XG_AIO_URING_MAX
+			: (xuint32) aio->depth;
+
+	xi_mem_set(&p, 0, sizeof(p));
+	r->fd = (xint32) syscall(__NR_io_uring_setup, entries, &p);
+	if (r->fd < 0) {
+		r->fd = -1;
+		return -1;
+	}
+	if (!(p.features & IORING_FEAT_RW_CUR_POS) || !xg_aio_uring_probe(r->fd)) {
+		xg_aio_uring_close(r);
+		return -1;
+	}
+
+	r->sq_len = p.sq_off.array + p.sq_entries * sizeof(xuint32);
+	r->cq_len = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+	r->sqe_len = p.sq_entries * sizeof(struct io_uring_sqe);
+
+	r->sq_ptr = mmap(NULL, r->sq_len, PROT_READ | PROT_WRITE,
+			MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_SQ_RING);
+	r->cq_ptr = mmap(NULL, r->cq_len, PROT_READ | PROT_WRITE,
+			MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_CQ_RING);
+	r->sqes = mmap(NULL, r->sqe_len, PROT_READ | PROT_WRITE,
+			MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_SQES);
+	if (r->sq_ptr == MAP_FAILED || r->cq_ptr == MAP_FAILED
+			|| r->sqes == MAP_FAILED) {
+		xg_aio_uring_close(r);
+		return -1;
+	}
+
+	r->sq_entries = p.sq_entries;
+	r->sq_mask = *(xuint32 *) ((xchar *) r->sq_ptr + p.sq_off.ring_mask);
+	r->sq_head = (xuint32 *) ((xchar *) r->sq_ptr + p.sq_off.head);
+	r->sq_tail = (xuint32 *) ((xchar *) r->sq_ptr + p.sq_off.tail);
+	r->sq_array = (xuint32 *) ((xchar *) r->sq_ptr + p.sq_off.array);
+	r->cq_mask = *(xuint32 *) ((xchar *) r->cq_ptr + p.cq_off.ring_mask);
+	r->cq_head = (xuint32 *) ((xchar *) r->cq_ptr + p.cq_off.head);
+	r->cq_tail = (xuint32 *) ((xchar *) r->cq_ptr + p.cq_off.tail);
+	r->cqes = (struct io_uring_cqe *) ((xchar *) r->cq_ptr + p.cq_off.cqes);
+
+	if (syscall(__NR_io_uring_register, r->fd, IORING_REGISTER_EVENTFD,
+			&aio->efd[0], 1) < 0) {
+		xg_aio_uring_close(r);
+		return -1;
+	}
+
+	// never more in flight than the completion ring holds
+	if ((xuint32) aio->depth > p.cq_entries) {
+		aio->depth = (xint32) p.cq_entries;
+	}
+
+	return 0;
+}
+
+static xvoid xg_aio_uring_prep(struct io_uring_sqe *sqe, xi_aio_req_t *req) {
+	xi_mem_set(sqe, 0, sizeof(*sqe));
+	sqe->fd = req->fd;
+	sqe->user_data = (xuint64) (xuintptr) req;
+
+	switch (req->op) {
+	case XI_AIO_OP_READ:
+	case XI_AIO_OP_WRITE:
+		sqe->opcode = (req->op == XI_AIO_OP_READ) ? IORING_OP_READ
+				: IORING_OP_WRITE;
+		sqe->addr = (xuint64) (xuintptr) req->buf;
+		sqe->len = (xuint32) req->len;
+		sqe->off = (req->off < 0) ? (xuint64) -1 : (xuint64) req->off;
+		break;
+	case XI_AIO_OP_RECV:
+		sqe->opcode = IORING_OP_RECV;
+		sqe->addr = (xuint64) (xuintptr) req->buf;
+		sqe->len = (xuint32) req->len;
+		break;
+	case XI_AIO_OP_SEND:
+		sqe->opcode = IORING_OP_SEND;
+		sqe->addr = (xuint64) (xuintptr) req->buf;
+		sqe->len = (xuint32) req->len;
+		sqe->msg_flags = MSG_NOSIGNAL;
+		break;
+	case XI_AIO_OP_ACCEPT:
+		sqe->opcode = IORING_OP_ACCEPT;
+		sqe->accept_flags = ((req->flags & XI_SOCK_ACCEPT_NONBLOCK) ? SOCK_NONBLOCK : 0)
+				| ((req->flags & XI_SOCK_ACCEPT_CLOEXEC) ? SOCK_CLOEXEC : 0);
+		break;
+	case XI_AIO_OP_FSYNC:
+		sqe->opcode = IORING_OP_FSYNC;
+		sqe->fsync_flags = (req->flags & XI_AIO_FSYNC_DATA) ? IORING_FSYNC_DATASYNC : 0;
+		break;
+	}
+}
+
+/*
+ * Hand the queued entries over to the kernel.
+ * The ones left by a failure (EAGAIN/EBUSY) are taken by the next call.
+ */
+static xvoid xg_aio_uring_enter(xi_aio_t *aio) {
+	xg_aio_ring_t *r = &aio->ring;
+	xuint32 nsub;
+	xint32 rv;
+
+	for (;;) {
+		nsub = *r->sq_tail - xi_atomic_load32_explicit(r->sq_head, XI_ATOMIC_ACQUIRE);
+		if (nsub == 0) {
+			return;
+		}
+		rv = (xint32) syscall(__NR_io_uring_enter, r->fd, nsub, 0, 0, NULL, 0);
+		if (rv < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			if (errno != EAGAIN && errno != EBUSY) {
+				log_error(XDLOG, "io_uring_enter failed (errno=%d)\n", errno);
+			}
+			return;
+		}
+		if ((xuint32) rv >= nsub) {
+			return;
+		}
+	}
+}
+
+static xint32 xg_aio_uring_submit(xi_aio_t *aio, xi_aio_req_t **reqs,
+		xint32 nreqs) {
+	xg_aio_ring_t *r = &aio->ring;
+	xuint32 head, tail, idx;
+	xint32 i;
+
+	tail = *r->sq_tail;
+	head = xi_atomic_load32_explicit(r->sq_head, XI_ATOMIC_ACQUIRE);
+	for (i = 0; i < nreqs; i++) {
+		if (tail - head >= r->sq_entries) {
+			break;
+		}
+		idx = tail & r->sq_mask;
+		xg_aio_uring_prep(&r->sqes[idx], reqs[i]);
+		r->sq_array[idx] = idx;
+		tail++;
+	}
+	if (i == 0) {
+		return XI_AIO_RV_ERR_FULL;
+	}
+
+	// the entries are visible to the kernel before the new tail
+	xi_atomic_store32_explicit(r->sq_tail, tail, XI_ATOMIC_RELEASE);
+	aio->inflight += i;
+	xg_aio_uring_enter(aio);
+
+	return i;
+}
+
+static xint32 xg_aio_uring_reap(xi_aio_t *aio) {
+	xg_aio_ring_t *r = &aio->ring;
+	xuint32 head, tail;
+	xint32 n = 0;
+
+	// entries left by a busy kernel
+	xg_aio_uring_enter(aio);
+	xg_aio_notify_drain(aio);
+
+	head = *r->cq_head;
+	tail = xi_atomic_load32_explicit(r->cq_tail, XI_ATOMIC_ACQUIRE);
+	while (head != tail) {
+		struct io_uring_cqe *cqe = &r->cqes[head & r->cq_mask];
+		xi_aio_req_t *req = (xi_aio_req_t *) (xuintptr) cqe->user_data;
+
+		if (cqe->res < 0) {
+			req->res = xg_aio_err(-cqe->res);
+		} else if (req->op == XI_AIO_OP_ACCEPT) {
+			req->res = xg_aio_accepted(req, cqe->res);
+		} else {
+			req->res = cqe->res;
+		}
+
+		// free the slot before the callback, which may submit again
+		head++;
+		xi_atomic_store32_explicit(r->cq_head, head, XI_ATOMIC_RELEASE);
+		aio->inflight--;
+		n++;
+
+		if (req->func != NULL) {
+			req->func(aio, req);
+		}
+	}
+
+	return n;
+}
+#endif // XG_AIO_URING
+
+// ----------------------------------------------
+// Inner Functions : worker threads
+// ----------------------------------------------
+
+static xssize xg_aio_do(xi_aio_req_t *req) {
+	xssize rv = -1;
+
+	do {
+		switch (req->op) {
+		case XI_AIO_OP_READ:
+			rv = (req->off < 0) ? read(req->fd, req->buf, req->len)
+					: pread(req->fd, req->buf, req->len, req->off);
+			break;
+		case XI_AIO_OP_WRITE:
+			rv = (req->off < 0) ? write(req->fd, req->buf, req->len)
+					: pwrite(req->fd, req->buf, req->len, req->off);
+			break;
+		case XI_AIO_OP_RECV:
+			rv = recv(req->fd, req->buf, req->len, 0);
+			break;
+		case XI_AIO_OP_SEND:
+			rv = send(req->fd, req->buf, req->len, MSG_NOSIGNAL);
+			break;
+		case XI_AIO_OP_ACCEPT:
+			rv = accept(req->fd, NULL, NULL);
+			if (rv >= 0) {
+				if ((req->flags & XI_SOCK_ACCEPT_NONBLOCK)) {
+					fcntl(rv, F_SETFL, fcntl(rv, F_GETFL) | O_NONBLOCK);
+				}
+				if ((req->flags & XI_SOCK_ACCEPT_CLOEXEC)) {
+					fcntl(rv, F_SETFD, FD_CLOEXEC);
+				}
+				return xg_aio_accepted(req, (xint32) rv);
+			}
+			break;
+		case XI_AIO_OP_FSYNC:
+			rv = (req->flags & XI_AIO_FSYNC_DATA) ? fdatasync(req->fd)
+					: fsync(req->fd);
+			break;
+		}
+	} while (rv < 0 && errno == EINTR);
+
+	return (rv < 0) ? xg_aio_err(errno) : rv;
+}
+
+static xvoid *xg_aio_worker(xvoid *arg) {
+	xi_aio_t *aio = arg;
+	xi_aio_req_t *req;
+
+	xi_thread_mutex_lock(&aio->lock);
+	for (;;) {
+		while (aio->qhead == NULL && aio->running) {
+			xi_thread_cond_wait(&aio->cond, &aio->lock);
+		}
+		if (aio->qhead == NULL) {
+			break;
+		}
+		req = aio->qhead;
+		aio->qhead = req->next;
+		if (aio->qhead == NULL) {
+			aio->qtail = NULL;
+		}
+		xi_thread_mutex_unlock(&aio->lock);
+
+		req->res = xg_aio_do(req);
+		req->next = NULL;
+
+		xi_thread_mutex_lock(&aio->lock);
+		if (aio->dtail == NULL) {
+			aio->dhead = req;
+		} else {
+			aio->dtail->next = req;
+		}
+		aio->dtail = req;
+		// one signal is enough until the owner takes the list
+		if (!aio->signaled) {
+			aio->signaled = TRUE;
+			xg_aio_notify(aio);
+		}
+	}
+	aio->alive--;
+	xi_thread_cond_broadcast(&aio->cond);
+	xi_thread_mutex_unlock(&aio->lock);
+
+	return NULL;
+}
+
+static xint32 xg_aio_threads_submit(xi_aio_t *aio, xi_aio_req_t **reqs,
+		xint32 nreqs) {
+	xint32 i;
+
+	xi_thread_mutex_lock(&aio->lock);
+	for (i = 0; i < nreqs; i++) {
+		reqs[i]->next = NULL;
+		if (aio->qtail == NULL) {
+			aio->qhead = reqs[i];
+		} else {
+			aio->qtail->next = reqs[i];
+		}
+		aio->qtail = reqs[i];
+	}
+	if (nreqs == 1) {
+		xi_thread_cond_signal(&aio->cond);
+	} else {
+		xi_thread_cond_broadcast(&aio->cond);
+	}
+	xi_thread_mutex_unlock(&aio->lock);
+
+	aio->inflight += nreqs;
+	return nreqs;
+}
+
+static xint32 xg_aio_threads_reap(xi_aio_t *aio) {
+	xi_aio_req_t *req, *next;
+	xint32 n = 0;
+
+	xi_thread_mutex_lock(&aio->lock);
+	req = aio->dhead;
+	aio->dhead = NULL;
+	aio->dtail = NULL;
+	aio->signaled = FALSE;
+	xg_aio_notify_drain(aio);
+	xi_thread_mutex_unlock(&aio->lock);
+
+	for (; req != NULL; req = next) {
+		next = req->next;
+		aio->inflight--;
+		n++;
+		if (req->func != NULL) {
+			req->func(aio, req);
+		}
+	}
+
+	return n;
+}
+
+static xint32 xg_aio_threads_start(xi_aio_t *aio, xuint32 nthreads) {
+	xuint32 i;
+	xi_thread_t tid;
+
+	aio->running = TRUE;
+	for (i = 0; i < nthreads; i++) {
+		xi_thread_mutex_lock(&aio->lock);
+		aio->alive++;
+		xi_thread_mutex_unlock(&aio->lock);
+		if (xi_thread_create(&tid, "xg_aio", xg_aio_worker, aio, 256 * 1024,
+				XCFG_THREAD_PRIOR_NORM) != XI_THREAD_RV_OK) {
+			xi_thread_mutex_lock(&aio->lock);
+			aio->alive--;
+			xi_thread_mutex_unlock(&aio->lock);
+			break;
+		}
+	}
+
+	return (i == 0) ? -1 : 0;
+}
+
+static xvoid xg_aio_threads_stop(xi_aio_t *aio) {
+	xi_thread_mutex_lock(&aio->lock);
+	aio->running = FALSE;
+	xi_thread_cond_broadcast(&aio->cond);
+	while (aio->alive > 0) {
+		xi_thread_cond_wait(&aio->cond, &aio->lock);
+	}
+	xi_thread_mutex_unlock(&aio->lock);
+}
+
+// ----------------------------------------------
+// XI Functions
+// ----------------------------------------------
+
+xi_aio_t *xi_aio_create(xuint32 depth, xuint32 nthreads, xint32 opt) {
+	xi_aio_t *aio;
+
+	if (depth == 0 || depth > 0x7FFFFFFF) {
+		return NULL;
+	}
+
+	aio = xi_mem_calloc(1, sizeof(xi_aio_t));
+	if (aio == NULL) {
+		return NULL;
+	}
+	aio->depth = (xint32) depth;
+	aio->efd[0] = aio->efd[1] = -1;
+#ifdef XG_AIO_URING
+	aio->ring.fd = -1;
+#endif // XG_AIO_URING
+
+	if (xg_aio_notify_open(aio->efd) < 0) {
+		xi_mem_free(aio);
+		return NULL;
+	}
+	if (xi_thread_mutex_create(&aio->lock, "xg_aio") != XI_MUTEX_RV_OK) {
+		xg_aio_notify_close(aio->efd);
+		xi_mem_free(aio);
+		return NULL;
+	}
+	if (xi_thread_cond_create(&aio->cond, "xg_aio") != XI_COND_RV_OK) {
+		xi_thread_mutex_destroy(&aio->lock);
+		xg_aio_notify_close(aio->efd);
+		xi_mem_free(aio);
+		return NULL;
+	}
+
+#ifdef XG_AIO_URING
+	if (!(opt & XI_AIO_OPT_THREADS) && xg_aio_uring_open(aio) == 0) {
+		aio->backend = XI_AIO_BACKEND_URING;
+		return aio;
+	}
+#else // !XG_AIO_URING
+	UNUSED(opt);
+#endif // XG_AIO_URING
+
+	aio->backend = XI_AIO_BACKEND_THREADS;
+	if (xg_aio_threads_start(aio, (nthreads == 0) ? XG_AIO_THREADS_DEF
+			: nthreads) < 0) {
+		xi_aio_destroy(aio);
+		return NULL;
+	}
+
+	return aio;
+}
+
+xint32 xi_aio_backend(xi_aio_t *aio) {
+	if (aio == NULL) {
+		return XI_AIO_RV_ERR_ARGS;
+	}
+	return aio->backend;
+}
+
+xint32 xi_aio_fd(xi_aio_t *aio) {
+	if (aio == NULL) {
+		return XI_AIO_RV_ERR_ARGS;
+	}
+	return aio->efd[0];
+}
+
+xint32 xi_aio_submit(xi_aio_t *aio, xi_aio_req_t **reqs, xint32 nreqs) {
+	xint32 i;
+
+	if (aio == NULL || reqs == NULL || nreqs <= 0) {
+		return XI_AIO_RV_ERR_ARGS;
+	}
+
+	// submit up to the first bad one
+	for (i = 0; i < nreqs; i++) {
+		if (reqs[i] == NULL || reqs[i]->fd < 0
+				|| reqs[i]->op < XI_AIO_OP_READ || reqs[i]->op > XI_AIO_OP_FSYNC) {
+			break;
+		}
+	}
+	if (i == 0) {
+		return XI_AIO_RV_ERR_ARGS;
+	}
+	nreqs = i;
+
+	if (aio->inflight >= aio->depth) {
+		return XI_AIO_RV_ERR_FULL;
+	}
+	if (nreqs > aio->depth - aio->inflight) {
+		nreqs = aio->depth - aio->inflight;
+	}
+
+#ifdef XG_AIO_URING
+	if (aio->backend == XI_AIO_BACKEND_URING) {
+		return xg_aio_uring_submit(aio, reqs, nreqs);
+	}
+#endif // XG_AIO_URING
+	return xg_aio_threads_submit(aio, reqs, nreqs);
+}
+
+xint32 xi_aio_complete(xi_aio_t *aio, xint32 msecs) {
+	xint32 n;
+
+	if (aio == NULL) {
+		return XI_AIO_RV_ERR_ARGS;
+	}
+
+	for (;;) {
+#ifdef XG_AIO_URING
+		if (aio->backend == XI_AIO_BACKEND_URING) {
+			n = xg_aio_uring_reap(aio);
+		} else
+#endif // XG_AIO_URING
+		{
+			n = xg_aio_threads_reap(aio);
+		}
+		if (n > 0) {
+			return n;
+		}
+		if (msecs == 0 || xg_aio_notify_wait(aio, msecs) < 0) {
+			return XI_AIO_RV_ERR_TIMEOUT;
+		}
+		// a positive time is waited once only
+		if (msecs > 0) {
+			msecs = 0;
+		}
+	}
+}
+
+xint32 xi_aio_pending(xi_aio_t *aio) {
+	if (aio == NULL) {
+		return XI_AIO_RV_ERR_ARGS;
+	}
+	return aio->inflight;
+}
+
+xi_aio_re xi_aio_destroy(xi_aio_t *aio) {
+	if (aio == NULL) {
+		return XI_AIO_RV_ERR_ARGS;
+	}
+
+	if (aio->inflight > 0) {
+		log_error(XDLOG, "%d requests are still in flight\n", aio->inflight);
+	}
+
+#ifdef XG_AIO_URING
+	xg_aio_uring_close(&aio->ring);
+#endif // XG_AIO_URING
+	xg_aio_threads_stop(aio);
+
+	xi_thread_cond_destroy(&aio->cond);
+	xi_thread_mutex_destroy(&aio->lock);
+	xg_aio_notify_close(aio->efd);
+	xi_mem_free(aio);
+
+	return XI_AIO_RV_OK;
+}
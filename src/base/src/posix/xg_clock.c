@@ -23,6 +23,10 @@
 #include <sys/time.h>
 #include <time.h>
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
 #include "xi/xi_clock.h"
 
 #define DATE_MAX        2147483647L
@@ -33,12 +37,20 @@
 #define LEAPYEAR(year)  (!((year) % 4) && (((year) % 100) || !((year) % 400)))
 #define YEARSIZE(year)  (LEAPYEAR(year) ? 366 : 365)
 
+#define XG_CYCLES_UNKNOWN  0  // not probed yet
+#define XG_CYCLES_CPU      1  // the counter of the CPU
+#define XG_CYCLES_NTICK    2  // xi_clock_ntick
+
 // ----------------------------------------------
 // Global Variables
 // ----------------------------------------------
 
 static struct timeval _g_start = { -1, -1 };
 
+static volatile xint32 _g_cycles_src = XG_CYCLES_UNKNOWN;
+static volatile xuint64 _g_cycles_hz = 0;
+static volatile double _g_cycles_nspc = 1.0; // nanoseconds per cycle
+
 static xint32 _g_clock_tzhour = 0;
 static xlong _g_clock_gsdiff = 0;
 
@@ -176,6 +188,39 @@ static xlong xg_mktime(register xi_time_t *stt) {
 	return (xint32) seconds;
 }
 
+static xint32 xg_cycles_probe() {
+#if defined(__x86_64__) || defined(__i386__)
+	xuint32 a, b, c, d;
+
+	// the invariant TSC ticks at a constant rate across P/C-states
+	if (__get_cpuid(0x80000007, &a, &b, &c, &d) && (d & (1 << 8))) {
+		return XG_CYCLES_CPU;
+	}
+	return XG_CYCLES_NTICK;
+#elif defined(__aarch64__)
+	// the generic timer is constant by the architecture
+	return XG_CYCLES_CPU;
+#else
+	return XG_CYCLES_NTICK;
+#endif
+}
+
+static xuint64 xg_cycles_read() {
+#if defined(__x86_64__) || defined(__i386__)
+	xuint32 lo, hi;
+
+	__asm__ __volatile__("rdtsc" : "=a" (lo), "=d" (hi));
+	return ((xuint64) hi << 32) | lo;
+#elif defined(__aarch64__)
+	xuint64 val;
+
+	__asm__ __volatile__("mrs %0, cntvct_el0" : "=r" (val));
+	return val;
+#else
+	return (xuint64) xi_clock_ntick();
+#endif
+}
+
 // ----------------------------------------------
 // XI Functions
 // ----------------------------------------------
@@ -190,16 +235,106 @@ xint64 xi_clock_msec() {
 }
 
 xint64 xi_clock_ntick() {
-	struct timeval now;
+#ifdef CLOCK_MONOTONIC
+	struct timespec now;
 
-	if (_g_start.tv_sec == -1) {
-		gettimeofday(&_g_start, NULL);
+	// not affected by xi_clock_settime or the adjustment of the system time
+	if (clock_gettime(CLOCK_MONOTONIC, &now) == 0) {
+		return ((xint64) now.tv_sec * 1000000000LL) + now.tv_nsec;
 	}
+#endif // CLOCK_MONOTONIC
+	{
+		struct timeval tv;
 
-	gettimeofday(&now, NULL);
+		if (_g_start.tv_sec == -1) {
+			gettimeofday(&_g_start, NULL);
+		}
+
+		gettimeofday(&tv, NULL);
+
+		return ((xint64) (tv.tv_sec - _g_start.tv_sec) * 1000000000LL)
+				+ ((xint64) (tv.tv_usec - _g_start.tv_usec) * 1000LL);
+	}
+}
+
+xint64 xi_clock_ntick_coarse() {
+#if defined(CLOCK_MONOTONIC_COARSE)
+	struct timespec now;
+
+	// read from the vDSO page, without the hardware clock
+	if (clock_gettime(CLOCK_MONOTONIC_COARSE, &now) == 0) {
+		return ((xint64) now.tv_sec * 1000000000LL) + now.tv_nsec;
+	}
+#elif defined(CLOCK_MONOTONIC_RAW_APPROX)
+	struct timespec now;
 
-	return (xint64) (((double)(now.tv_sec - _g_start.tv_sec) * 1E9)
-			+ (((double)now.tv_usec) * 1E3));
+	if (clock_gettime(CLOCK_MONOTONIC_RAW_APPROX, &now) == 0) {
+		return ((xint64) now.tv_sec * 1000000000LL) + now.tv_nsec;
+	}
+#endif
+	return xi_clock_ntick();
+}
+
+xuint64 xi_clock_cycles() {
+	if (_g_cycles_src == XG_CYCLES_CPU) {
+		return xg_cycles_read();
+	}
+	if (_g_cycles_src == XG_CYCLES_UNKNOWN) {
+		_g_cycles_src = xg_cycles_probe();
+		return xi_clock_cycles();
+	}
+	return (xuint64) xi_clock_ntick();
+}
+
+xuint64 xi_clock_cycles_hz() {
+	xuint64 hz;
+
+	if (_g_cycles_hz != 0) {
+		return _g_cycles_hz;
+	}
+
+	if (_g_cycles_src == XG_CYCLES_UNKNOWN) {
+		_g_cycles_src = xg_cycles_probe();
+	}
+
+	if (_g_cycles_src != XG_CYCLES_CPU) {
+		hz = 1000000000ULL;
+	} else {
+#if defined(__aarch64__)
+		__asm__ __volatile__("mrs %0, cntfrq_el0" : "=r" (hz));
+#else
+		struct timespec ts;
+		xint64 n0, n1;
+		xuint64 c0, c1;
+
+		n0 = xi_clock_ntick();
+		c0 = xg_cycles_read();
+
+		ts.tv_sec = 0;
+		ts.tv_nsec = 10000000L;
+		while (nanosleep(&ts, &ts) < 0 && errno == EINTR) {
+			// sleep the rest
+		}
+
+		n1 = xi_clock_ntick();
+		c1 = xg_cycles_read();
+
+		hz = (xuint64) ((double) (c1 - c0) * 1E9 / (double) (n1 - n0));
+#endif
+	}
+
+	// the rate first, and then the flag of the calibration
+	_g_cycles_nspc = 1E9 / (double) hz;
+	_g_cycles_hz = hz;
+
+	return hz;
+}
+
+xint64 xi_clock_cycles2nsec(xuint64 cycles) {
+	if (_g_cycles_hz == 0) {
+		xi_clock_cycles_hz();
+	}
+	return (xint64) ((double) cycles * _g_cycles_nspc);
 }
 
 xint32 xi_clock_get_tz() {
@@ -20,6 +20,13 @@
 
 #include "xg_fd.h"
 
+#include <fcntl.h>
+#include <unistd.h>
+#if defined(__APPLE__)
+#include <sys/param.h>
+#endif
+
+#include "xi/xi_atomic.h"
 #include "xi/xi_mem.h"
 #include "xi/xi_log.h"
 #include "xi/xi_string.h"
@@ -28,94 +35,190 @@
 // Global Variables
 // ----------------------------------------------
 
-static xg_fd_t _g_fds[XCFG_FD_MAX];
-static xbool _g_fd_init = FALSE;
-static xint32 _g_fd_total = 0;
+/**
+ * The slots live in chunks, which are allocated on the first touch
+ * and never freed, so that a slot pointer stays valid without a lock.
+ * The first chunk is static and holds the standard streams.
+ */
+#define XG_FD_CHUNK_BITS   10
+#define XG_FD_CHUNK_SIZE   (1 << XG_FD_CHUNK_BITS)
+#define XG_FD_CHUNK_MAX    1024  // 1M descriptors
+
+static xg_fd_t _g_fd_chunk0[XG_FD_CHUNK_SIZE] = {
+	{ XG_FD_TYPE_FILE, { { XI_FILE_MODE_READ, (xi_file_perm_e) 0x400, NULL } } },
+	{ XG_FD_TYPE_FILE, { { (xi_file_mode_e) (XI_FILE_MODE_WRITE
+			| XI_FILE_MODE_APPEND), (xi_file_perm_e) 0x200, NULL } } },
+	{ XG_FD_TYPE_FILE, { { (xi_file_mode_e) (XI_FILE_MODE_WRITE
+			| XI_FILE_MODE_APPEND), (xi_file_perm_e) 0x200, NULL } } }
+};
+
+static volatile xvoid *_g_fd_chunks[XG_FD_CHUNK_MAX] = { _g_fd_chunk0 };
+
+static volatile xuint32 _g_fd_total = 3;
 
 // ----------------------------------------------
 // Inner Functions
 // ----------------------------------------------
 
-static xvoid xg_fd_init() {
-	if (!_g_fd_init) {
-		xi_mem_set(_g_fds, 0, sizeof(_g_fds));
-
-		// STDIN
-		_g_fds[0].type = XG_FD_TYPE_FILE;
-		_g_fds[0].desc.f.mode = XI_FILE_MODE_READ;
-		_g_fds[0].desc.f.perm = 0x400;
-		_g_fds[0].desc.f.path = NULL;
-
-		// STDOUT
-		_g_fds[1].type = XG_FD_TYPE_FILE;
-		_g_fds[1].desc.f.mode = XI_FILE_MODE_WRITE | XI_FILE_MODE_APPEND;
-		_g_fds[1].desc.f.perm = 0x200;
-		_g_fds[1].desc.f.path = NULL;
-
-		// STDERR
-		_g_fds[2].type = XG_FD_TYPE_FILE;
-		_g_fds[2].desc.f.mode = XI_FILE_MODE_WRITE | XI_FILE_MODE_APPEND;
-		_g_fds[2].desc.f.perm = 0x200;
-		_g_fds[2].desc.f.path = NULL;
-
-		_g_fd_total = 3;
-		_g_fd_init = TRUE;
+static xg_fd_t *xg_fd_slot(xint32 idx) {
+	xint32 cidx = idx >> XG_FD_CHUNK_BITS;
+	xg_fd_t *chunk;
+
+	if (idx < 0 || cidx >= XG_FD_CHUNK_MAX) {
+		log_error(XDLOG, "idx=%d\n", idx);
+		return NULL;
+	}
+
+	chunk = (xg_fd_t *) _g_fd_chunks[cidx];
+	if (chunk == NULL) {
+		xg_fd_t *prev;
+
+		chunk = xi_mem_calloc(XG_FD_CHUNK_SIZE, sizeof(xg_fd_t));
+		if (chunk == NULL) {
+			log_error(XDLOG, "cannot allocate the chunk of idx=%d\n", idx);
+			return NULL;
+		}
+		// another thread may have installed one in the meantime
+		prev = xi_atomic_casptr(&_g_fd_chunks[cidx], chunk, NULL);
+		if (prev != NULL) {
+			xi_mem_free(chunk);
+			chunk = prev;
+		}
+	}
+
+	return &(chunk[idx & (XG_FD_CHUNK_SIZE - 1)]);
+}
+
+#ifdef XG_FD_KEEP_PATH
+static xvoid xg_fd_path_free(xg_fd_t *slot, xuint32 type) {
+	if ((type == XG_FD_TYPE_FILE || type == XG_FD_TYPE_PIPE)
+			&& slot->desc.f.path != NULL) {
+		xi_mem_free(slot->desc.f.path);
+		slot->desc.f.path = NULL;
 	}
 }
+#endif // XG_FD_KEEP_PATH
 
 // ----------------------------------------------
 // XG Interface Functions
 // ----------------------------------------------
 
 _XI_API_INTERN xint32 xg_fd_count() {
-	return _g_fd_total;
+	return (xint32) xi_atomic_read32(&_g_fd_total);
 }
 
 _XI_API_INTERN xg_fd_t * xg_fd_get(xint32 idx) {
-	if (idx < 0 || idx >= XCFG_FD_MAX) {
-		log_error(XDLOG, "idx=%d\n", idx);
-		return NULL;
-	}
-	if (!_g_fd_init) {
-		xg_fd_init();
-	}
-	return &(_g_fds[idx]);
+	return xg_fd_slot(idx);
 }
 
 _XI_API_INTERN xint32 xg_fd_open(xint32 idx, xg_fd_t *fd) {
-	if (!_g_fd_init) {
-		xg_fd_init();
-	}
-	if (idx < 0 || idx >= XCFG_FD_MAX || fd == NULL || (fd->type
-			!= XG_FD_TYPE_FILE && fd->type != XG_FD_TYPE_SOCK)) {
+	xg_fd_t *slot;
+	xuint32 old;
+
+	if (fd == NULL || (fd->type != XG_FD_TYPE_FILE && fd->type
+			!= XG_FD_TYPE_SOCK && fd->type != XG_FD_TYPE_PIPE)) {
 		log_error(XDLOG, "idx=%d/fd=%p/fd->type=%d\n", idx, fd, (fd) ? fd->type : 0);
 		return -1;
 	}
-	xi_mem_copy(&(_g_fds[idx]), fd, sizeof(xg_fd_t));
-	if (fd->type == XG_FD_TYPE_FILE && fd->desc.f.path != NULL) {
-		_g_fds[idx].desc.f.path = xi_mem_alloc(xi_strlen(fd->desc.f.path)+1);
-		xi_strcpy(_g_fds[idx].desc.f.path, fd->desc.f.path);
+	slot = xg_fd_slot(idx);
+	if (slot == NULL) {
+		return -1;
 	}
-	_g_fd_total++;
-	if (_g_fd_total > (XCFG_FD_MAX - 10)) {
-		log_warn(XDLOG, "FD-Total is very close to Limit(4096)\n");
+
+	// a descriptor closed natively leaves its slot in use
+	old = xi_atomic_xchg32(&slot->type, XG_FD_TYPE_NOTUSED);
+#ifdef XG_FD_KEEP_PATH
+	xg_fd_path_free(slot, old);
+#endif // XG_FD_KEEP_PATH
+
+	slot->desc = fd->desc;
+	if (fd->type != XG_FD_TYPE_SOCK) {
+		slot->desc.f.path = NULL;
+#ifdef XG_FD_KEEP_PATH
+		if (fd->type == XG_FD_TYPE_FILE && fd->desc.f.path != NULL) {
+			slot->desc.f.path = xi_mem_alloc(xi_strlen(fd->desc.f.path) + 1);
+			if (slot->desc.f.path != NULL) {
+				xi_strcpy(slot->desc.f.path, fd->desc.f.path);
+			}
+		}
+#endif // XG_FD_KEEP_PATH
+	}
+
+	// publish the slot
+	xi_atomic_xchg32(&slot->type, fd->type);
+	if (old == XG_FD_TYPE_NOTUSED) {
+		xi_atomic_inc32(&_g_fd_total);
 	}
 
 	return idx;
 }
 
 _XI_API_INTERN xint32 xg_fd_close(xint32 idx) {
-	if (idx < 0 || idx >= XCFG_FD_MAX) {
-		log_error(XDLOG, "idx=%d\n", idx);
+	xg_fd_t *slot;
+	xuint32 old;
+
+	slot = xg_fd_slot(idx);
+	if (slot == NULL) {
 		return -1;
 	}
 
-	if (_g_fds[idx].type == XG_FD_TYPE_FILE && _g_fds[idx].desc.f.path != NULL) {
-		xi_mem_free(_g_fds[idx].desc.f.path);
-		_g_fds[idx].desc.f.path = NULL;
+	old = xi_atomic_xchg32(&slot->type, XG_FD_TYPE_NOTUSED);
+	if (old == XG_FD_TYPE_NOTUSED) {
+		return 0;
 	}
-	xi_mem_set(&(_g_fds[idx]), 0, sizeof(xg_fd_t));
-	_g_fd_total--;
+#ifdef XG_FD_KEEP_PATH
+	xg_fd_path_free(slot, old);
+#endif // XG_FD_KEEP_PATH
+	xi_atomic_dec32(&_g_fd_total);
 
 	return 0;
 }
+
+_XI_API_INTERN xssize xg_fd_path(xint32 idx, xchar *buf, xsize buflen) {
+	xssize ret;
+
+	if (idx < 0 || buf == NULL || buflen == 0) {
+		return -1;
+	}
+
+#if defined(__linux__)
+	{
+		xchar link[32];
+
+		xi_snprintf(link, sizeof(link), "/proc/self/fd/%d", idx);
+		ret = readlink(link, buf, buflen - 1);
+		if (ret < 0) {
+			buf[0] = '\0';
+			return -1;
+		}
+		buf[ret] = '\0';
+	}
+#elif defined(__APPLE__)
+	{
+		xchar path[MAXPATHLEN];
+
+		if (fcntl(idx, F_GETPATH, path) < 0) {
+			buf[0] = '\0';
+			return -1;
+		}
+		xi_strncpy(buf, path, buflen - 1);
+		buf[buflen - 1] = '\0';
+		ret = xi_strlen(buf);
+	}
+#else  // XG_FD_KEEP_PATH
+	{
+		xg_fd_t *slot = xg_fd_slot(idx);
+
+		if (slot == NULL || slot->type != XG_FD_TYPE_FILE
+				|| slot->desc.f.path == NULL) {
+			buf[0] = '\0';
+			return -1;
+		}
+		xi_strncpy(buf, slot->desc.f.path, buflen - 1);
+		buf[buflen - 1] = '\0';
+		ret = xi_strlen(buf);
+	}
+#endif
+
+	return ret;
+}
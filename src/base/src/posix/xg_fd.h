@@ -31,13 +31,21 @@ typedef enum _e_fd_type {
 	XG_FD_TYPE_PIPE    = 3
 } xg_fd_type_e;
 
+/**
+ * The kernel tells the path of an open descriptor on these systems,
+ * so that the table does not keep a copy of it.
+ */
+#if !defined(__linux__) && !defined(__APPLE__)
+#define XG_FD_KEEP_PATH
+#endif
+
 typedef struct _st_fd {
-	xg_fd_type_e          type;
+	volatile xuint32      type;    // xg_fd_type_e, published after desc
 	union _u_desc {
 		struct _st_file {
 			xi_file_mode_e    mode;
 			xi_file_perm_e    perm;
-			xchar            *path;
+			xchar            *path;    // given to xg_fd_open, kept only with XG_FD_KEEP_PATH
 		} f;
 		struct _st_sock {
 			xi_sock_family_e  family;
@@ -53,4 +61,6 @@ _XI_API_INTERN xg_fd_t *xg_fd_get(xint32 idx);
 _XI_API_INTERN xint32   xg_fd_open(xint32 idx, xg_fd_t *fd);
 _XI_API_INTERN xint32   xg_fd_close(xint32 idx);
 
+_XI_API_INTERN xssize   xg_fd_path(xint32 idx, xchar *buf, xsize buflen);
+
 #endif //_XG_FD_H_
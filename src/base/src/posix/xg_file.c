@@ -32,11 +32,16 @@
 #include <dirent.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <stdlib.h>
 #include <time.h>
+#include <poll.h>
 #include <unistd.h>
 #include <sys/ioctl.h>
 #include <sys/stat.h>
 #include <sys/uio.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
 
 #ifdef __APPLE__
 #include <sys/mount.h>
@@ -49,6 +54,23 @@
 #include "xi/xi_mem.h"
 #include "xi/xi_string.h"
 
+// ----------------------------------------------
+// Definitions
+// ----------------------------------------------
+
+#if defined(__linux__) && !defined(XI_BUILD_android)
+#define XG_FILE_SPLICE
+#if defined(__NR_copy_file_range)
+#define XG_FILE_COPY_RANGE
+#endif
+#endif
+
+#if defined(__linux__) && !defined(XI_BUILD_android)
+#define XG_FILE_PREADV
+#endif
+
+#define XG_FILE_XFER_CHUNK   (64 * 1024)  // buffer and relay pipe unit
+
 // ----------------------------------------------
 // Inner Structure
 // ----------------------------------------------
@@ -58,6 +80,223 @@ struct _xi_dir {
 	xchar pathname[XCFG_PATHNAME_MAX];
 };
 
+// ----------------------------------------------
+// Inner Functions
+// ----------------------------------------------
+
+static xssize xg_file_err_xfer(xint32 err) {
+	switch (err) {
+	case EAGAIN:
+		return XI_FILE_RV_ERR_AGAIN;
+	case EACCES:
+	case EPERM:
+		return XI_FILE_RV_ERR_PERM;
+	case EBADF:
+		return XI_FILE_RV_ERR_FD;
+	case EINTR:
+		return XI_FILE_RV_ERR_INTR;
+	case EISDIR:
+		return XI_FILE_RV_ERR_DIR;
+	case EFBIG:
+		return XI_FILE_RV_ERR_BIG;
+	case ENOSPC:
+		return XI_FILE_RV_ERR_OVER;
+	case ENOMEM:
+		return XI_FILE_RV_ERR_NOMEM;
+	case EIO:
+		return XI_FILE_RV_ERR_IO;
+	default:
+		return XI_FILE_RV_ERR_ARGS;
+	}
+}
+
+static mode_t xg_file_mode(xint32 fd) {
+	struct stat st;
+	return (fstat(fd, &st) == 0) ? st.st_mode : 0;
+}
+
+// wait for a non-blocking output, not to drop the data already taken
+static void xg_file_wait_out(xint32 fd) {
+	struct pollfd pfd;
+
+	pfd.fd = fd;
+	pfd.events = POLLOUT;
+	pfd.revents = 0;
+	poll(&pfd, 1, -1);
+}
+
+static xssize xg_file_write_all(xint32 fd, xoff64 *off, const xchar *buf,
+		xssize len) {
+	xssize ret, done = 0;
+
+	while (done < len) {
+		if (off != NULL) {
+			ret = pwrite(fd, buf + done, (size_t) (len - done), *off);
+		} else {
+			ret = write(fd, buf + done, (size_t) (len - done));
+		}
+		if (ret < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			if (errno == EAGAIN) {
+				xg_file_wait_out(fd);
+				continue;
+			}
+			break;
+		}
+		if (off != NULL) {
+			*off += ret;
+		}
+		done += ret;
+	}
+
+	return done;
+}
+
+static xssize xg_file_copy_buf(xint32 infd, xoff64 *inoff, xint32 outfd,
+		xoff64 *outoff, xsize count, xbool loop) {
+	xchar *buf;
+	xsize want;
+	xssize rn, wn, done = 0;
+
+	buf = xi_mem_alloc(XG_FILE_XFER_CHUNK);
+	if (buf == NULL) {
+		return XI_FILE_RV_ERR_NOMEM;
+	}
+
+	while ((xsize) done < count) {
+		want = count - (xsize) done;
+		if (want > XG_FILE_XFER_CHUNK) {
+			want = XG_FILE_XFER_CHUNK;
+		}
+		if (inoff != NULL) {
+			rn = pread(infd, buf, want, *inoff);
+		} else {
+			rn = read(infd, buf, want);
+		}
+		if (rn <= 0) {
+			if (rn < 0 && done == 0) {
+				done = xg_file_err_xfer(errno);
+			}
+			break;
+		}
+		wn = xg_file_write_all(outfd, outoff, buf, rn);
+		if (inoff != NULL) {
+			*inoff += wn;
+		}
+		done += wn;
+		if (wn < rn) {
+			if (done == 0) {
+				done = xg_file_err_xfer(errno);
+			}
+			break;
+		}
+		if (!loop || (xsize) rn < want) {
+			break;
+		}
+	}
+
+	xi_mem_free(buf);
+	return done;
+}
+
+#ifdef XG_FILE_SPLICE
+static xuint32 xg_file_splice_flags(xint32 flags) {
+	xuint32 fl = 0;
+
+	if (flags & XI_FILE_SPLICE_MOVE) {
+		fl |= SPLICE_F_MOVE;
+	}
+	if (flags & XI_FILE_SPLICE_NONBLOCK) {
+		fl |= SPLICE_F_NONBLOCK;
+	}
+	if (flags & XI_FILE_SPLICE_MORE) {
+		fl |= SPLICE_F_MORE;
+	}
+	return fl;
+}
+
+static xssize xg_file_splice_once(xint32 infd, xoff64 *inoff, xint32 outfd,
+		xoff64 *outoff, xsize count, xuint32 fl) {
+	loff_t ioff = (inoff != NULL) ? *inoff : 0;
+	loff_t ooff = (outoff != NULL) ? *outoff : 0;
+	xssize ret;
+
+	ret = splice(infd, (inoff != NULL) ? &ioff : NULL, outfd,
+			(outoff != NULL) ? &ooff : NULL, count, fl);
+	if (ret > 0) {
+		if (inoff != NULL) {
+			*inoff = ioff;
+		}
+		if (outoff != NULL) {
+			*outoff = ooff;
+		}
+	}
+	return ret;
+}
+
+/*
+ * Neither side is a pipe : file/socket -> pipe -> file/socket.
+ * A regular file input is moved up to count, the others stop after
+ * one chunk, not to block on the input again.
+ * Returns -1 (with errno) only if nothing is moved.
+ */
+static xssize xg_file_splice_relay(xint32 infd, xoff64 *inoff, xint32 outfd,
+		xoff64 *outoff, xsize count, xuint32 fl, xbool loop) {
+	xint32 p[2];
+	xsize want;
+	xssize in, out, left, done = 0;
+	xint32 err = 0;
+
+	if (pipe(p) < 0) {
+		return -1;
+	}
+
+	while ((xsize) done < count) {
+		want = count - (xsize) done;
+		if (want > XG_FILE_XFER_CHUNK) {
+			want = XG_FILE_XFER_CHUNK;
+		}
+		in = xg_file_splice_once(infd, inoff, p[1], NULL, want, fl);
+		if (in <= 0) {
+			err = (in < 0) ? errno : 0;
+			break;
+		}
+		// the pipe must be emptied, or the data is lost
+		for (left = in; left > 0;) {
+			out = xg_file_splice_once(p[0], NULL, outfd, outoff, left,
+					fl & ~SPLICE_F_NONBLOCK);
+			if (out < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				if (errno == EAGAIN) {
+					xg_file_wait_out(outfd);
+					continue;
+				}
+				err = errno;
+				break;
+			}
+			left -= out;
+		}
+		done += in - left;
+		if (left > 0 || !loop || (xsize) in < want) {
+			break;
+		}
+	}
+
+	close(p[0]);
+	close(p[1]);
+
+	if (done == 0 && err != 0) {
+		errno = err;
+		return -1;
+	}
+	return done;
+}
+#endif // XG_FILE_SPLICE
+
 // ----------------------------------------------
 // XI Functions
 // ----------------------------------------------
@@ -239,6 +478,174 @@ xssize xi_file_writev(xint32 fd, const xi_file_iovec_t *iov, xint32 iovlen) {
 	return ret;
 }
 
+xssize xi_file_pread(xint32 fd, xvoid *buf, xsize buflen, xoff64 off) {
+	xssize ret;
+
+	if (fd < 0 || buf == NULL || off < 0) {
+		return XI_FILE_RV_ERR_ARGS;
+	}
+
+	ret = pread(fd, buf, buflen, (off_t) off);
+	if (ret < 0) {
+		return xg_file_err_xfer(errno);
+	}
+
+	return ret;
+}
+
+xssize xi_file_pwrite(xint32 fd, const xvoid *buf, xsize buflen, xoff64 off) {
+	xssize ret;
+
+	if (fd < 0 || buf == NULL || off < 0) {
+		return XI_FILE_RV_ERR_ARGS;
+	}
+
+	ret = pwrite(fd, buf, buflen, (off_t) off);
+	if (ret < 0) {
+		return xg_file_err_xfer(errno);
+	}
+
+	return ret;
+}
+
+xssize xi_file_preadv(xint32 fd, const xi_file_iovec_t *iov, xint32 iovlen,
+		xoff64 off) {
+	xssize ret;
+
+	if (fd < 0 || iov == NULL || iovlen < 0 || off < 0) {
+		return XI_FILE_RV_ERR_ARGS;
+	}
+
+#ifdef XG_FILE_PREADV
+	ret = preadv(fd, (const struct iovec *) iov, iovlen, (off_t) off);
+	if (ret < 0) {
+		return xg_file_err_xfer(errno);
+	}
+#else // !XG_FILE_PREADV
+	{
+		xint32 i;
+		xssize rn;
+
+		// one by one, until a short read
+		for (i = 0, ret = 0; i < iovlen; i++) {
+			rn = pread(fd, iov[i].iov_base, iov[i].iov_len, (off_t) (off + ret));
+			if (rn < 0) {
+				return (ret > 0) ? ret : xg_file_err_xfer(errno);
+			}
+			ret += rn;
+			if ((xsize) rn < iov[i].iov_len) {
+				break;
+			}
+		}
+	}
+#endif // XG_FILE_PREADV
+
+	return ret;
+}
+
+xssize xi_file_pwritev(xint32 fd, const xi_file_iovec_t *iov, xint32 iovlen,
+		xoff64 off) {
+	xssize ret;
+
+	if (fd < 0 || iov == NULL || iovlen < 0 || off < 0) {
+		return XI_FILE_RV_ERR_ARGS;
+	}
+
+#ifdef XG_FILE_PREADV
+	ret = pwritev(fd, (const struct iovec *) iov, iovlen, (off_t) off);
+	if (ret < 0) {
+		return xg_file_err_xfer(errno);
+	}
+#else // !XG_FILE_PREADV
+	{
+		xint32 i;
+		xssize wn;
+
+		for (i = 0, ret = 0; i < iovlen; i++) {
+			wn = pwrite(fd, iov[i].iov_base, iov[i].iov_len, (off_t) (off + ret));
+			if (wn < 0) {
+				return (ret > 0) ? ret : xg_file_err_xfer(errno);
+			}
+			ret += wn;
+			if ((xsize) wn < iov[i].iov_len) {
+				break;
+			}
+		}
+	}
+#endif // XG_FILE_PREADV
+
+	return ret;
+}
+
+xi_file_re xi_file_advise(xint32 fd, xoff64 off, xoff64 len, xint32 advice) {
+	if (fd < 0 || off < 0 || len < 0) {
+		return XI_FILE_RV_ERR_ARGS;
+	}
+
+#if defined(POSIX_FADV_NORMAL)
+	{
+		xint32 adv, ret;
+
+		switch (advice) {
+		case XI_FILE_ADVICE_NORMAL:
+			adv = POSIX_FADV_NORMAL;
+			break;
+		case XI_FILE_ADVICE_SEQUENTIAL:
+			adv = POSIX_FADV_SEQUENTIAL;
+			break;
+		case XI_FILE_ADVICE_RANDOM:
+			adv = POSIX_FADV_RANDOM;
+			break;
+		case XI_FILE_ADVICE_WILLNEED:
+			adv = POSIX_FADV_WILLNEED;
+			break;
+		case XI_FILE_ADVICE_DONTNEED:
+			adv = POSIX_FADV_DONTNEED;
+			break;
+		default:
+			return XI_FILE_RV_ERR_ARGS;
+		}
+
+		// it returns the error number, not -1
+		ret = posix_fadvise(fd, (off_t) off, (off_t) len, adv);
+		if (ret != 0) {
+			return (ret == ESPIPE) ? XI_FILE_RV_ERR_NS
+					: (xi_file_re) xg_file_err_xfer(ret);
+		}
+	}
+#elif defined(__APPLE__)
+	switch (advice) {
+	case XI_FILE_ADVICE_NORMAL:
+	case XI_FILE_ADVICE_SEQUENTIAL:
+	case XI_FILE_ADVICE_RANDOM:
+		if (fcntl(fd, F_RDAHEAD, (advice == XI_FILE_ADVICE_RANDOM) ? 0 : 1) < 0) {
+			return (xi_file_re) xg_file_err_xfer(errno);
+		}
+		break;
+	case XI_FILE_ADVICE_WILLNEED: {
+		struct radvisory ra;
+		ra.ra_offset = (off_t) off;
+		ra.ra_count = (len == 0 || len > 0x7FFFFFFF) ? 0x7FFFFFFF : (xint32) len;
+		if (fcntl(fd, F_RDADVISE, &ra) < 0) {
+			return (xi_file_re) xg_file_err_xfer(errno);
+		}
+		break;
+	}
+	case XI_FILE_ADVICE_DONTNEED:
+		return XI_FILE_RV_ERR_NS;
+	default:
+		return XI_FILE_RV_ERR_ARGS;
+	}
+#else
+	if (advice < XI_FILE_ADVICE_NORMAL || advice > XI_FILE_ADVICE_DONTNEED) {
+		return XI_FILE_RV_ERR_ARGS;
+	}
+	return XI_FILE_RV_ERR_NS;
+#endif
+
+	return XI_FILE_RV_OK;
+}
+
 xoff64 xi_file_seek(xint32 fd, xoff64 pos, xint32 whence) {
 	xoff64 ret;
 
@@ -356,6 +763,36 @@ xi_file_re xi_file_sync(xint32 fd) {
 	return XI_FILE_RV_OK;
 }
 
+xsize xi_file_direct_align() {
+	static xsize align = 0;
+
+	if (align == 0) {
+		xlong psize = sysconf(_SC_PAGESIZE);
+		// O_DIRECT needs the logical block size, which the page size covers
+		align = (psize > 0) ? (xsize) psize : 4096;
+	}
+	return align;
+}
+
+xvoid *xi_file_direct_alloc(xsize size) {
+	xvoid *buf = NULL;
+	xsize align = xi_file_direct_align();
+
+	if (size == 0) {
+		return NULL;
+	}
+
+	size = (size + align - 1) & ~(align - 1);
+	if (posix_memalign(&buf, align, size) != 0) {
+		return NULL;
+	}
+	return buf;
+}
+
+xvoid xi_file_direct_free(xvoid *buf) {
+	free(buf);
+}
+
 xi_file_re xi_file_pipe(xint32 fd[2]) {
 	xint32 ret;
 	xg_fd_t pfd[2];
@@ -392,6 +829,125 @@ xi_file_re xi_file_pipe(xint32 fd[2]) {
 	return XI_FILE_RV_OK;
 }
 
+xssize xi_file_splice(xint32 infd, xoff64 *inoff, xint32 outfd,
+		xoff64 *outoff, xsize count, xint32 flags) {
+	mode_t imode, omode;
+	xssize ret;
+
+	if (infd < 0 || outfd < 0) {
+		return XI_FILE_RV_ERR_ARGS;
+	}
+
+	if (count == 0) {
+		return 0;
+	}
+
+	// only the regular files have an offset
+	imode = xg_file_mode(infd);
+	omode = xg_file_mode(outfd);
+	if (!S_ISREG(imode)) {
+		inoff = NULL;
+	}
+	if (!S_ISREG(omode)) {
+		outoff = NULL;
+	}
+
+#ifdef XG_FILE_SPLICE
+	{
+		xuint32 fl = xg_file_splice_flags(flags);
+
+		if (S_ISFIFO(imode) || S_ISFIFO(omode)) {
+			ret = xg_file_splice_once(infd, inoff, outfd, outoff, count, fl);
+		} else {
+			ret = xg_file_splice_relay(infd, inoff, outfd, outoff, count, fl,
+					S_ISREG(imode));
+		}
+		if (ret >= 0) {
+			return ret;
+		}
+		if (errno != EINVAL && errno != ENOSYS) {
+			return xg_file_err_xfer(errno);
+		}
+		// not supported by the file system : fall back
+	}
+#else // !XG_FILE_SPLICE
+	UNUSED(flags);
+#endif // XG_FILE_SPLICE
+
+	ret = xg_file_copy_buf(infd, inoff, outfd, outoff, count, S_ISREG(imode));
+	return ret;
+}
+
+xssize xi_file_tee(xint32 infd, xint32 outfd, xsize count, xint32 flags) {
+	if (infd < 0 || outfd < 0) {
+		return XI_FILE_RV_ERR_ARGS;
+	}
+
+#ifdef XG_FILE_SPLICE
+	{
+		xssize ret = tee(infd, outfd, count, xg_file_splice_flags(flags));
+		if (ret < 0) {
+			return (errno == ENOSYS) ? XI_FILE_RV_ERR_NS
+					: xg_file_err_xfer(errno);
+		}
+		return ret;
+	}
+#else // !XG_FILE_SPLICE
+	UNUSED(count);
+	UNUSED(flags);
+	return XI_FILE_RV_ERR_NS;
+#endif // XG_FILE_SPLICE
+}
+
+xssize xi_file_copy_range(xint32 infd, xoff64 *inoff, xint32 outfd,
+		xoff64 *outoff, xsize count) {
+#ifdef XG_FILE_COPY_RANGE
+	loff_t ioff, ooff;
+	xssize ret, done = 0;
+#endif
+
+	if (infd < 0 || outfd < 0) {
+		return XI_FILE_RV_ERR_ARGS;
+	}
+
+#ifdef XG_FILE_COPY_RANGE
+	ioff = (inoff != NULL) ? *inoff : 0;
+	ooff = (outoff != NULL) ? *outoff : 0;
+	while ((xsize) done < count) {
+		ret = syscall(__NR_copy_file_range, infd,
+				(inoff != NULL) ? &ioff : NULL, outfd,
+				(outoff != NULL) ? &ooff : NULL, count - (xsize) done, 0);
+		if (ret < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			if (done > 0) {
+				break;
+			}
+			if (errno == ENOSYS || errno == EXDEV || errno == EINVAL
+					|| errno == EOPNOTSUPP || errno == EBADF) {
+				// old kernel, other file systems, append mode or not files
+				return xi_file_splice(infd, inoff, outfd, outoff, count, 0);
+			}
+			return xg_file_err_xfer(errno);
+		}
+		if (ret == 0) {
+			break;
+		}
+		done += ret;
+	}
+	if (inoff != NULL) {
+		*inoff = ioff;
+	}
+	if (outoff != NULL) {
+		*outoff = ooff;
+	}
+	return done;
+#else // !XG_FILE_COPY_RANGE
+	return xi_file_splice(infd, inoff, outfd, outoff, count, 0);
+#endif // XG_FILE_COPY_RANGE
+}
+
 xi_file_re xi_file_close(xint32 fd) {
 	xint32 ret;
 
@@ -625,7 +1181,6 @@ xi_file_re xi_file_fstat(xint32 fd, xi_file_stat_t *s) {
 
 	xint32 masked_value;
 	xint32 ret;
-	xg_fd_t *fdesc = NULL;
 
 	if (fd < 0 || s == NULL) {
 		return XI_FILE_RV_ERR_ARGS;
@@ -682,10 +1237,9 @@ xi_file_re xi_file_fstat(xint32 fd, xi_file_stat_t *s) {
 	s->accessed = (se.st_atime * 1000);
 	s->modified = (se.st_mtime * 1000);
 
-	fdesc = xg_fd_get(fd);
-
-	xi_strcpy(s->pathname, fdesc->desc.f.path);
-	xi_strcpy(s->filename, xi_pathname_basename(fdesc->desc.f.path));
+	// the standard streams, sockets and pipes may have no path
+	xg_fd_path(fd, s->pathname, sizeof(s->pathname));
+	xi_strcpy(s->filename, xi_pathname_basename(s->pathname));
 
 	return XI_FILE_RV_OK;
 }
@@ -21,25 +21,77 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(__GLIBC__) || defined(__APPLE__)
+#include <execinfo.h>
+#endif
+
 #include "xi/xi_mem.h"
 
+#include "../_all/xg_mem_track.h"
+
+// ----------------------------------------------
+// Internal Functions
+// ----------------------------------------------
+
+xvoid *xg_mem_raw_alloc(xsize size) {
+	return malloc(size);
+}
+
+xvoid *xg_mem_raw_calloc(xsize nmemb, xsize size) {
+	return calloc(nmemb, size);
+}
+
+xvoid *xg_mem_raw_realloc(xvoid *ptr, xsize size) {
+	return realloc(ptr, size);
+}
+
+xvoid xg_mem_raw_free(xvoid *ptr) {
+	free(ptr);
+}
+
+xint32 xg_mem_backtrace(xvoid **frames, xint32 max) {
+#if defined(__GLIBC__) || defined(__APPLE__)
+	return backtrace(frames, max);
+#else  // no unwinder : the sites are told by the tag only
+	UNUSED(frames);
+	UNUSED(max);
+	return 0;
+#endif
+}
+
 // ----------------------------------------------
 // XI Functions
 // ----------------------------------------------
 
 xvoid *xi_mem_alloc(xsize size) {
+	if (xg_mem_track_state & XG_MEM_TRACK_ON) {
+		return xg_mem_track_alloc(size, FALSE, XG_MEM_CALLER());
+	}
 	return malloc(size);
 }
 
 xvoid *xi_mem_calloc(xsize nmemb, xsize size) {
+	if (xg_mem_track_state & XG_MEM_TRACK_ON) {
+		if (size != 0 && nmemb > ((xsize) -1) / size) {
+			return NULL;
+		}
+		return xg_mem_track_alloc(nmemb * size, TRUE, XG_MEM_CALLER());
+	}
 	return calloc(nmemb, size);
 }
 
 xvoid *xi_mem_realloc(xvoid *ptr, xsize size) {
+	if (xg_mem_track_state) {
+		return xg_mem_track_realloc(ptr, size, XG_MEM_CALLER());
+	}
 	return realloc(ptr, size);
 }
 
 xvoid xi_mem_free(xvoid *ptr) {
+	if (xg_mem_track_state) {
+		xg_mem_track_free(ptr);
+		return;
+	}
 	free(ptr);
 }
 
@@ -22,7 +22,6 @@
 #include <poll.h>
 
 #ifdef __APPLE__
-#include <stdio.h>
 #include <sys/event.h>
 #include <sys/time.h>
 #else
@@ -41,13 +40,35 @@
 // Inner Structure
 // ----------------------------------------------
 
+#define XG_POLLSET_SLOT_NONE    (-1)  // end of the free-list
+#define XG_POLLSET_SLOT_USED    (-2)  // the slot holds a registration
+
+#define XG_POLLSET_FDMAP_INIT   64
+
+/*
+ * A registration lives in a fixed slot for its whole life.
+ * The slot index (and its generation, for epoll) is handed to the kernel,
+ * so a signaled event finds its registration without any search, and
+ * an event for a slot released in the meantime is recognized as stale.
+ */
+typedef struct _st_pollset_slot {
+	xi_pollfd_t pfd;
+	xuint32 gen;
+	xint32 next;
+	xuint32 pos;
+} xg_pollset_slot_t;
+
 struct _xi_pollset {
-	xi_pollfd_t *pfds;
+	xg_pollset_slot_t *slots;
 	xuint32 size;
 	xuint32 used;
 	xi_pollset_opt_e opt;
 	xi_thread_mutex_t lock;
+	xint32 free;
+	xint32 *fdmap;
+	xint32 fdmax;
 	struct pollfd *rfds;
+	xuint32 *rslot;
 	xint32 epfd;
 };
 
@@ -105,46 +126,178 @@ static xi_poll_event_e xg_pollset_events_2pi(xint32 events) {
 	return ret;
 }
 
+#ifndef __APPLE__
+static uint32_t xg_pollset_events_2ep(xint32 events) {
+	uint32_t ret = 0;
+
+	if (events & XI_POLL_EVENT_IN) {
+		ret |= EPOLLIN;
+	}
+	if (events & XI_POLL_EVENT_PRI) {
+		ret |= EPOLLPRI;
+	}
+	if (events & XI_POLL_EVENT_OUT) {
+		ret |= EPOLLOUT;
+	}
+	if (events & XI_POLL_EVENT_ET) {
+		ret |= EPOLLET;
+	}
+	if (events & XI_POLL_EVENT_ONESHOT) {
+		ret |= EPOLLONESHOT;
+	}
+
+	return ret;
+}
+
+static xint32 xg_pollset_events_2ei(uint32_t events) {
+	xint32 ret = 0;
+
+	if (events & EPOLLIN) {
+		ret |= XI_POLL_EVENT_IN;
+	}
+	if (events & EPOLLPRI) {
+		ret |= XI_POLL_EVENT_PRI;
+	}
+	if (events & EPOLLOUT) {
+		ret |= XI_POLL_EVENT_OUT;
+	}
+	if (events & EPOLLERR) {
+		ret |= XI_POLL_EVENT_ERR;
+	}
+	if (events & EPOLLHUP) {
+		ret |= XI_POLL_EVENT_HUP;
+	}
+
+	return ret;
+}
+
+static xuint64 xg_pollset_token(xint32 idx, xuint32 gen) {
+	return (((xuint64)gen) << 32) | (xuint32)idx;
+}
+#else // __APPLE__
+static xuint16 xg_pollset_events_2kf(xint32 events) {
+	xuint16 ret = EV_ADD | EV_ENABLE;
+
+	if (events & XI_POLL_EVENT_ET) {
+		ret |= EV_CLEAR;
+	}
+	if (events & XI_POLL_EVENT_ONESHOT) {
+		// keep the filter registered, so that modify can re-arm it
+		ret |= EV_DISPATCH;
+	}
+
+	return ret;
+}
+#endif // !__APPLE__
+
+static xvoid xg_pollset_lock(xi_pollset_t *pset) {
+	if (pset->opt & XI_POLLSET_OPT_USELOCK) {
+		xi_thread_mutex_lock(&pset->lock);
+	}
+}
+
+static xvoid xg_pollset_unlock(xi_pollset_t *pset) {
+	if (pset->opt & XI_POLLSET_OPT_USELOCK) {
+		xi_thread_mutex_unlock(&pset->lock);
+	}
+}
+
+static xint32 xg_pollset_slot_alloc(xi_pollset_t *pset) {
+	xint32 idx = pset->free;
+
+	if (idx != XG_POLLSET_SLOT_NONE) {
+		pset->free = pset->slots[idx].next;
+		pset->slots[idx].next = XG_POLLSET_SLOT_USED;
+	}
+
+	return idx;
+}
+
+static xvoid xg_pollset_slot_free(xi_pollset_t *pset, xint32 idx) {
+	pset->slots[idx].gen++;
+	pset->slots[idx].next = pset->free;
+	pset->free = idx;
+}
+
+static xint32 xg_pollset_fd_find(xi_pollset_t *pset, xint32 desc) {
+	if (desc < 0 || desc >= pset->fdmax) {
+		return XG_POLLSET_SLOT_NONE;
+	}
+	return pset->fdmap[desc] - 1;
+}
+
+static xint32 xg_pollset_fd_map(xi_pollset_t *pset, xint32 desc, xint32 idx) {
+	if (desc >= pset->fdmax) {
+		xint32 nmax = pset->fdmax;
+		xint32 *nmap;
+
+		while (nmax <= desc) {
+			nmax *= 2;
+		}
+
+		nmap = xi_mem_realloc(pset->fdmap, sizeof(xint32) * (xuint32)nmax);
+		if (nmap == NULL) {
+			return -1;
+		}
+		xi_mem_set(nmap + pset->fdmax, 0,
+				sizeof(xint32) * (xuint32)(nmax - pset->fdmax));
+
+		pset->fdmap = nmap;
+		pset->fdmax = nmax;
+	}
+
+	pset->fdmap[desc] = idx + 1;
+
+	return 0;
+}
+
+static xvoid xg_pollset_free(xi_pollset_t *pset) {
+	xi_mem_free(pset->rslot);
+	xi_mem_free(pset->rfds);
+	xi_mem_free(pset->fdmap);
+	xi_mem_free(pset->slots);
+	xi_mem_free(pset);
+}
+
 // ----------------------------------------------
 // XI Functions
 // ----------------------------------------------
 
 xi_pollset_t *xi_pollset_create(xuint32 size, xint32 opt) {
 	xint32 rv;
+	xuint32 i;
 
 	xi_pollset_t *pset = xi_mem_calloc(1, sizeof(xi_pollset_t));
 	if (pset == NULL) {
 		return NULL;
 	}
 
-	pset->pfds = (xi_pollfd_t *)xi_mem_calloc(size, sizeof(xi_pollfd_t));
-	if (pset->pfds == NULL) {
-		xi_mem_free(pset);
+	pset->slots = xi_mem_calloc(size, sizeof(xg_pollset_slot_t));
+	pset->fdmap = xi_mem_calloc(XG_POLLSET_FDMAP_INIT, sizeof(xint32));
+	if (pset->slots == NULL || pset->fdmap == NULL) {
+		xg_pollset_free(pset);
 		return NULL;
 	}
 
+	for (i = 0; i < size; i++) {
+		pset->slots[i].next = (i + 1 < size) ? (xint32)(i + 1)
+				: XG_POLLSET_SLOT_NONE;
+	}
+
 	pset->size = size;
 	pset->used = 0;
 	pset->opt = opt;
-
-	if (pset->opt & XI_POLLSET_OPT_USELOCK) {
-		rv = xi_thread_mutex_create(&pset->lock, "xg_poll");
-		if (rv < 0) {
-			xi_mem_free(pset->pfds);
-			xi_mem_free(pset);
-			return NULL;
-		}
-	}
+	pset->free = (size > 0) ? 0 : XG_POLLSET_SLOT_NONE;
+	pset->fdmax = XG_POLLSET_FDMAP_INIT;
 
 	if (pset->opt & XI_POLLSET_OPT_EPOLL) {
 #ifdef __APPLE__
 		pset->epfd = kqueue();
 #else
-		pset->epfd = epoll_create((xint32)size);
+		pset->epfd = epoll_create((size > 0) ? (xint32)size : 1);
 #endif
 		if (pset->epfd < 0) {
-			xi_mem_free(pset->pfds);
-			xi_mem_free(pset);
+			xg_pollset_free(pset);
 			return NULL;
 		}
 
@@ -153,13 +306,22 @@ xi_pollset_t *xi_pollset_create(xuint32 size, xint32 opt) {
 			fcntl(pset->epfd, F_SETFD, rv | FD_CLOEXEC);
 		}
 #endif
-
-		pset->rfds = NULL;
 	} else {
 		pset->rfds = xi_mem_calloc(size, sizeof(struct pollfd));
-		if (pset->rfds == NULL) {
-			xi_mem_free(pset->pfds);
-			xi_mem_free(pset);
+		pset->rslot = xi_mem_calloc(size, sizeof(xuint32));
+		if (pset->rfds == NULL || pset->rslot == NULL) {
+			xg_pollset_free(pset);
+			return NULL;
+		}
+	}
+
+	if (pset->opt & XI_POLLSET_OPT_USELOCK) {
+		rv = xi_thread_mutex_create(&pset->lock, "xg_poll");
+		if (rv < 0) {
+			if (pset->opt & XI_POLLSET_OPT_EPOLL) {
+				close(pset->epfd);
+			}
+			xg_pollset_free(pset);
 			return NULL;
 		}
 	}
@@ -168,21 +330,35 @@ xi_pollset_t *xi_pollset_create(xuint32 size, xint32 opt) {
 }
 
 xi_pollset_re xi_pollset_add(xi_pollset_t *pset, xi_pollfd_t fd) {
-	if (pset == NULL) {
+	xint32 idx;
+	xg_pollset_slot_t *slot;
+
+	if (pset == NULL || fd.desc < 0) {
 		return XI_POLLSET_RV_ERR_ARGS;
 	}
 
-	if (pset->opt & XI_POLLSET_OPT_USELOCK) {
-		xi_thread_mutex_lock(&pset->lock);
-	}
+	xg_pollset_lock(pset);
 
 	if (pset->used >= pset->size) {
-		if (pset->opt & XI_POLLSET_OPT_USELOCK) {
-			xi_thread_mutex_unlock(&pset->lock);
-		}
+		xg_pollset_unlock(pset);
 		return XI_POLLSET_RV_ERR_OVER;
 	}
 
+	if (xg_pollset_fd_find(pset, fd.desc) >= 0) {
+		xg_pollset_unlock(pset);
+		return XI_POLLSET_RV_ERR_ARGS;
+	}
+
+	idx = xg_pollset_slot_alloc(pset);
+	if (xg_pollset_fd_map(pset, fd.desc, idx) < 0) {
+		xg_pollset_slot_free(pset, idx);
+		xg_pollset_unlock(pset);
+		return XI_POLLSET_RV_ERR_OP;
+	}
+
+	slot = &(pset->slots[idx]);
+	slot->pfd = fd;
+
 	if (pset->opt & XI_POLLSET_OPT_EPOLL) {
 		xint32 rv;
 #ifdef __APPLE__
@@ -190,96 +366,78 @@ xi_pollset_re xi_pollset_add(xi_pollset_t *pset, xi_pollfd_t fd) {
 		struct kevent ev[2];
 
 		if (fd.evts & XI_POLL_EVENT_IN) {
-			printf("[poll_add] POLL_EVENT_IN>  desc: %d, ctx: %p\n", fd.desc, fd.context);
-			EV_SET(&ev[n++], fd.desc, EVFILT_READ, EV_ADD | EV_CLEAR, 0, 0, 0);
+			EV_SET(&ev[n++], fd.desc, EVFILT_READ,
+					xg_pollset_events_2kf(fd.evts), 0, 0, (xvoid *)(xintptr)idx);
 		}
 		if (fd.evts & XI_POLL_EVENT_OUT) {
-			printf("[poll_add] POLL_EVENT_OUT> desc: %d, ctx: %p\n", fd.desc, fd.context);
-			EV_SET(&ev[n++], fd.desc, EVFILT_WRITE, EV_ADD | EV_CLEAR, 0, 0, 0);
+			EV_SET(&ev[n++], fd.desc, EVFILT_WRITE,
+					xg_pollset_events_2kf(fd.evts), 0, 0, (xvoid *)(xintptr)idx);
 		}
 
 		rv = kevent(pset->epfd, ev, n, NULL, 0, NULL);
 #else // !__APPLE__
 		struct epoll_event ev;
 
-		ev.events = (uint32_t)EPOLLET;
-		if (fd.evts & XI_POLL_EVENT_IN) {
-			ev.events |= EPOLLIN;
-		}
-		if (fd.evts & XI_POLL_EVENT_OUT) {
-			ev.events |= EPOLLOUT;
-		}
-		ev.data.fd = fd.desc;
+		ev.events = xg_pollset_events_2ep(fd.evts);
+		ev.data.u64 = xg_pollset_token(idx, slot->gen);
 
-		rv = epoll_ctl(pset->epfd, EPOLL_CTL_ADD, ev.data.fd, &ev);
+		rv = epoll_ctl(pset->epfd, EPOLL_CTL_ADD, fd.desc, &ev);
 #endif // __APPLE__
 		if (rv < 0) {
-			if (pset->opt & XI_POLLSET_OPT_USELOCK) {
-				xi_thread_mutex_unlock(&pset->lock);
-			}
+			pset->fdmap[fd.desc] = 0;
+			xg_pollset_slot_free(pset, idx);
+			xg_pollset_unlock(pset);
 			return XI_POLLSET_RV_ERR_OP;
 		}
 	} else {
-		pset->rfds[pset->used].fd = fd.desc;
-		pset->rfds[pset->used].events = xg_pollset_events_2pg(fd.evts);
-		pset->rfds[pset->used].revents = 0;
+		slot->pos = pset->used;
+		pset->rfds[slot->pos].fd = fd.desc;
+		pset->rfds[slot->pos].events = xg_pollset_events_2pg(fd.evts);
+		pset->rfds[slot->pos].revents = 0;
+		pset->rslot[slot->pos] = (xuint32)idx;
 	}
 
-	pset->pfds[pset->used].desc = fd.desc;
-	pset->pfds[pset->used].evts = fd.evts;
-	pset->pfds[pset->used].context = fd.context;
-
 	pset->used++;
 
-	if (pset->opt & XI_POLLSET_OPT_USELOCK) {
-		xi_thread_mutex_unlock(&pset->lock);
-	}
+	xg_pollset_unlock(pset);
 
 	return XI_POLLSET_RV_OK;
 }
 
-xi_pollset_re xi_pollset_remove(xi_pollset_t *pset, xi_pollfd_t fd) {
-	xuint32 i;
-	xbool found;
+xi_pollset_re xi_pollset_modify(xi_pollset_t *pset, xi_pollfd_t fd) {
+	xint32 idx;
+	xg_pollset_slot_t *slot;
 
 	if (pset == NULL) {
 		return XI_POLLSET_RV_ERR_ARGS;
 	}
 
-	if (pset->opt & XI_POLLSET_OPT_USELOCK) {
-		xi_thread_mutex_lock(&pset->lock);
-	}
+	xg_pollset_lock(pset);
 
-	found = FALSE;
-	for (i = 0; i < pset->used; i++) {
-		if (pset->pfds[i].desc == fd.desc) {
-			xi_mem_copy(&(pset->pfds[i]), &(pset->pfds[i + 1]),
-					sizeof(xi_pollfd_t) * (pset->used - i - 1));
-			if (!(pset->opt & XI_POLLSET_OPT_EPOLL)) {
-				xi_mem_copy(&(pset->rfds[i]), &(pset->rfds[i + 1]),
-						sizeof(struct pollfd) * (pset->used - i - 1));
-			}
-			found = TRUE;
-			break;
-		}
-	}
-
-	if (!found) {
-		if (pset->opt & XI_POLLSET_OPT_USELOCK) {
-			xi_thread_mutex_unlock(&pset->lock);
-		}
+	idx = xg_pollset_fd_find(pset, fd.desc);
+	if (idx < 0) {
+		xg_pollset_unlock(pset);
 		return XI_POLLSET_RV_ERR_NF;
 	}
 
+	slot = &(pset->slots[idx]);
+
 	if (pset->opt & XI_POLLSET_OPT_EPOLL) {
 		xint32 rv;
 #ifdef __APPLE__
 		xint32 n = 0;
 		struct kevent ev[2];
 
-		if (fd.evts == XI_POLL_EVENT_IN) {
+		if (fd.evts & XI_POLL_EVENT_IN) {
+			EV_SET(&ev[n++], fd.desc, EVFILT_READ,
+					xg_pollset_events_2kf(fd.evts), 0, 0, (xvoid *)(xintptr)idx);
+		} else if (slot->pfd.evts & XI_POLL_EVENT_IN) {
 			EV_SET(&ev[n++], fd.desc, EVFILT_READ, EV_DELETE, 0, 0, 0);
-		} else if (fd.evts == XI_POLL_EVENT_OUT) {
+		}
+		if (fd.evts & XI_POLL_EVENT_OUT) {
+			EV_SET(&ev[n++], fd.desc, EVFILT_WRITE,
+					xg_pollset_events_2kf(fd.evts), 0, 0, (xvoid *)(xintptr)idx);
+		} else if (slot->pfd.evts & XI_POLL_EVENT_OUT) {
 			EV_SET(&ev[n++], fd.desc, EVFILT_WRITE, EV_DELETE, 0, 0, 0);
 		}
 
@@ -287,160 +445,137 @@ xi_pollset_re xi_pollset_remove(xi_pollset_t *pset, xi_pollfd_t fd) {
 #else // !__APPLE__
 		struct epoll_event ev;
 
-		ev.events = (uint32_t)EPOLLET;
-		if (fd.evts & XI_POLL_EVENT_IN) {
-			ev.events |= EPOLLIN;
-		}
-		if (fd.evts & XI_POLL_EVENT_OUT) {
-			ev.events |= EPOLLOUT;
-		}
-		ev.data.fd = fd.desc;
+		ev.events = xg_pollset_events_2ep(fd.evts);
+		ev.data.u64 = xg_pollset_token(idx, slot->gen);
 
-		rv = epoll_ctl(pset->epfd, EPOLL_CTL_DEL, ev.data.fd, &ev);
+		rv = epoll_ctl(pset->epfd, EPOLL_CTL_MOD, fd.desc, &ev);
 #endif // __APPLE__
 		if (rv < 0) {
-			if (pset->opt & XI_POLLSET_OPT_USELOCK) {
-				xi_thread_mutex_unlock(&pset->lock);
-			}
+			xg_pollset_unlock(pset);
 			return XI_POLLSET_RV_ERR_OP;
 		}
+	} else {
+		pset->rfds[slot->pos].events = xg_pollset_events_2pg(fd.evts);
+		pset->rfds[slot->pos].revents = 0;
 	}
 
-	pset->used--;
+	slot->pfd = fd;
 
-	if (pset->opt & XI_POLLSET_OPT_USELOCK) {
-		xi_thread_mutex_unlock(&pset->lock);
-	}
+	xg_pollset_unlock(pset);
 
 	return XI_POLLSET_RV_OK;
 }
 
-xi_pollset_re xi_pollset_destroy(xi_pollset_t *pset) {
+xi_pollset_re xi_pollset_remove(xi_pollset_t *pset, xi_pollfd_t fd) {
+	xint32 idx;
+	xg_pollset_slot_t *slot;
+
 	if (pset == NULL) {
 		return XI_POLLSET_RV_ERR_ARGS;
 	}
 
-	if (pset->opt & XI_POLLSET_OPT_USELOCK) {
-		xi_thread_mutex_lock(&pset->lock);
+	xg_pollset_lock(pset);
+
+	idx = xg_pollset_fd_find(pset, fd.desc);
+	if (idx < 0) {
+		xg_pollset_unlock(pset);
+		return XI_POLLSET_RV_ERR_NF;
 	}
 
-	if (pset->opt & XI_POLLSET_OPT_EPOLL) {
-#ifndef __APPLE__
-		xuint32 i;
-		xi_pollfd_t fd;
+	slot = &(pset->slots[idx]);
 
+	if (pset->opt & XI_POLLSET_OPT_EPOLL) {
 		xint32 rv;
-		struct epoll_event ev;
+#ifdef __APPLE__
+		xint32 n = 0;
+		struct kevent ev[2];
 
-		for (i = 0; i < pset->used; i++) {
-			fd = pset->pfds[i];
+		if (slot->pfd.evts & XI_POLL_EVENT_IN) {
+			EV_SET(&ev[n++], fd.desc, EVFILT_READ, EV_DELETE, 0, 0, 0);
+		}
+		if (slot->pfd.evts & XI_POLL_EVENT_OUT) {
+			EV_SET(&ev[n++], fd.desc, EVFILT_WRITE, EV_DELETE, 0, 0, 0);
+		}
 
-			ev.events = (uint32_t)EPOLLET;
-			if (fd.evts & XI_POLL_EVENT_IN) {
-				ev.events |= EPOLLIN;
-			}
-			if (fd.evts & XI_POLL_EVENT_OUT) {
-				ev.events |= EPOLLOUT;
-			}
-			ev.data.fd = fd.desc;
+		rv = kevent(pset->epfd, ev, n, NULL, 0, NULL);
+#else // !__APPLE__
+		struct epoll_event ev;
 
-			rv = epoll_ctl(pset->epfd, EPOLL_CTL_DEL, ev.data.fd, &ev);
-			if (rv < 0) {
-				if (pset->opt & XI_POLLSET_OPT_USELOCK) {
-					xi_thread_mutex_unlock(&pset->lock);
-				}
-				return XI_POLLSET_RV_ERR_OP;
-			}
+		ev.events = 0;
+		ev.data.u64 = 0;
+
+		rv = epoll_ctl(pset->epfd, EPOLL_CTL_DEL, fd.desc, &ev);
+#endif // __APPLE__
+		// a closed descriptor has already left the kernel set
+		if (rv < 0 && errno != EBADF && errno != ENOENT) {
+			xg_pollset_unlock(pset);
+			return XI_POLLSET_RV_ERR_OP;
 		}
-#endif // !__APPLE__
-		close(pset->epfd);
 	} else {
-		xi_mem_free(pset->rfds);
+		xuint32 last = pset->used - 1;
+
+		// fill the hole with the last descriptor
+		pset->rfds[slot->pos] = pset->rfds[last];
+		pset->rslot[slot->pos] = pset->rslot[last];
+		pset->slots[pset->rslot[slot->pos]].pos = slot->pos;
+	}
+
+	pset->fdmap[fd.desc] = 0;
+	xg_pollset_slot_free(pset, idx);
+
+	pset->used--;
+
+	xg_pollset_unlock(pset);
+
+	return XI_POLLSET_RV_OK;
+}
+
+xi_pollset_re xi_pollset_destroy(xi_pollset_t *pset) {
+	if (pset == NULL) {
+		return XI_POLLSET_RV_ERR_ARGS;
+	}
+
+	if (pset->opt & XI_POLLSET_OPT_EPOLL) {
+		// closing the kernel set drops every registration at once
+		close(pset->epfd);
 	}
 
 	if (pset->opt & XI_POLLSET_OPT_USELOCK) {
-		xi_thread_mutex_unlock(&pset->lock);
+		xi_thread_mutex_destroy(&pset->lock);
 	}
 
-	xi_thread_mutex_destroy(&pset->lock);
-	xi_mem_free(pset->pfds);
-	xi_mem_free(pset);
+	xg_pollset_free(pset);
 
 	return XI_POLLSET_RV_OK;
 }
 
 xint32 xi_pollset_poll(xi_pollset_t *pset, xi_pollfd_t *rfds, xint32 rlen,
 		xint32 msecs) {
-	xint32 ret, loopcnt;
-	xuint32 i, j;
+	xint32 ret, i, n;
 
-	if (pset == NULL || rfds == NULL) {
+	if (pset == NULL || rfds == NULL || rlen <= 0) {
 		return XI_POLLSET_RV_ERR_ARGS;
 	}
 
-	if (pset->opt & XI_POLLSET_OPT_USELOCK) {
-		xi_thread_mutex_lock(&pset->lock);
-	}
-
 	if (pset->opt & XI_POLLSET_OPT_EPOLL) {
+		// The kernel set is waited on without the lock,
+		// so other threads can add or remove descriptors meanwhile.
 #ifdef __APPLE__
 		struct kevent ev[rlen];
-		struct timeval tv;
 		struct timespec ts;
 
-		gettimeofday(&tv, NULL);
-		ts.tv_sec = tv.tv_sec + (msecs / 1000);
-		ts.tv_nsec = tv.tv_usec * 1000 + (msecs % 1000) * 1000000;
+		ts.tv_sec = msecs / 1000;
+		ts.tv_nsec = (msecs % 1000) * 1000000;
 
-		ret = kevent(pset->epfd, NULL, 0, ev, rlen, NULL);
-//		ret = kevent(pset->epfd, NULL, 0, ev, rlen, &ts);
-		printf("[poll_poll] ret: %d\n", ret);
+		ret = kevent(pset->epfd, NULL, 0, ev, rlen, (msecs < 0) ? NULL : &ts);
 #else // !__APPLE__
 		struct epoll_event ev[rlen];
 
 		ret = epoll_wait(pset->epfd, ev, rlen, msecs);
 #endif // __APPLE__
-		if (ret > 0) {
-			loopcnt = (ret > rlen) ? rlen : ret;
-			for (i = 0; i < (xuint32)loopcnt; i++) {
-				for (j = 0; j < pset->used; j++) {
-#ifdef __APPLE__
-					if ((xint32)ev[i].ident == pset->pfds[j].desc) {
-						rfds[i].desc = pset->pfds[j].desc;
-						rfds[i].evts = 0;
-						if (ev[i].filter == EVFILT_READ) {
-							rfds[i].evts |= XI_POLL_EVENT_IN;
-						} else if (ev[i].filter == EVFILT_WRITE) {
-							rfds[i].evts |= XI_POLL_EVENT_OUT;
-						}
-						rfds[i].context = pset->pfds[j].context;
-						break;
-					}
-#else // !__APPLE__
-					if (ev[i].data.fd == pset->pfds[j].desc) {
-						rfds[i].desc = pset->pfds[j].desc;
-						rfds[i].evts = 0;
-						if (ev[i].events & EPOLLIN) {
-							rfds[i].evts |= XI_POLL_EVENT_IN;
-						}
-						if (ev[i].events & EPOLLOUT) {
-							rfds[i].evts |= XI_POLL_EVENT_OUT;
-						}
-						rfds[i].context = pset->pfds[j].context;
-						break;
-					}
-#endif // __APPLE__
-				}
-			}
-		} else if (ret == 0) {
-			if (pset->opt & XI_POLLSET_OPT_USELOCK) {
-				xi_thread_mutex_unlock(&pset->lock);
-			}
+		if (ret == 0) {
 			return XI_POLLSET_RV_ERR_TIMEOUT;
-		} else {
-			if (pset->opt & XI_POLLSET_OPT_USELOCK) {
-				xi_thread_mutex_unlock(&pset->lock);
-			}
+		} else if (ret < 0) {
 			switch (errno) {
 			case EINTR:
 				return XI_POLLSET_RV_ERR_INTR;
@@ -449,27 +584,70 @@ xint32 xi_pollset_poll(xi_pollset_t *pset, xi_pollfd_t *rfds, xint32 rlen,
 				return XI_POLLSET_RV_ERR_ARGS;
 			}
 		}
-	} else {
-		ret = poll(pset->rfds, pset->used, msecs);
-		if (ret > 0) {
-			loopcnt = (ret > rlen) ? rlen : ret;
-			for (i = 0, j = 0; i < pset->used && j < (xuint32)loopcnt; i++) {
-				if (pset->rfds[i].revents) {
-					rfds[j] = pset->pfds[i];
-					rfds[j].evts = xg_pollset_events_2pi(
-							pset->rfds[i].revents);
-					j++;
-				}
+
+		xg_pollset_lock(pset);
+
+		for (i = 0, n = 0; i < ret; i++) {
+			xg_pollset_slot_t *slot;
+#ifdef __APPLE__
+			xint32 idx = (xint32)(xintptr)ev[i].udata;
+
+			if (idx < 0 || (xuint32)idx >= pset->size) {
+				continue;
 			}
-		} else if (ret == 0) {
-			if (pset->opt & XI_POLLSET_OPT_USELOCK) {
-				xi_thread_mutex_unlock(&pset->lock);
+			slot = &(pset->slots[idx]);
+			if (slot->next != XG_POLLSET_SLOT_USED
+					|| slot->pfd.desc != (xint32)ev[i].ident) {
+				continue;
 			}
-			return XI_POLLSET_RV_ERR_TIMEOUT;
-		} else {
-			if (pset->opt & XI_POLLSET_OPT_USELOCK) {
-				xi_thread_mutex_unlock(&pset->lock);
+
+			rfds[n].evts = 0;
+			if (ev[i].filter == EVFILT_READ) {
+				rfds[n].evts |= XI_POLL_EVENT_IN;
+			} else if (ev[i].filter == EVFILT_WRITE) {
+				rfds[n].evts |= XI_POLL_EVENT_OUT;
+			}
+			if (ev[i].flags & EV_EOF) {
+				rfds[n].evts |= XI_POLL_EVENT_HUP;
+			}
+			if (ev[i].flags & EV_ERROR) {
+				rfds[n].evts |= XI_POLL_EVENT_ERR;
 			}
+#else // !__APPLE__
+			xuint32 idx = (xuint32)ev[i].data.u64;
+
+			if (idx >= pset->size) {
+				continue;
+			}
+			slot = &(pset->slots[idx]);
+			if (slot->next != XG_POLLSET_SLOT_USED
+					|| slot->gen != (xuint32)(ev[i].data.u64 >> 32)) {
+				continue;
+			}
+
+			rfds[n].evts = xg_pollset_events_2ei(ev[i].events);
+#endif // __APPLE__
+			rfds[n].desc = slot->pfd.desc;
+			rfds[n].context = slot->pfd.context;
+			n++;
+		}
+
+		xg_pollset_unlock(pset);
+
+		if (n == 0) {
+			// every event belonged to a descriptor removed while waiting
+			return XI_POLLSET_RV_ERR_INTR;
+		}
+	} else {
+		// poll() scans the shared array, so it is waited on with the lock
+		xg_pollset_lock(pset);
+
+		ret = poll(pset->rfds, pset->used, msecs);
+		if (ret == 0) {
+			xg_pollset_unlock(pset);
+			return XI_POLLSET_RV_ERR_TIMEOUT;
+		} else if (ret < 0) {
+			xg_pollset_unlock(pset);
 			switch (errno) {
 			case EINTR:
 				return XI_POLLSET_RV_ERR_INTR;
@@ -478,11 +656,21 @@ xint32 xi_pollset_poll(xi_pollset_t *pset, xi_pollfd_t *rfds, xint32 rlen,
 				return XI_POLLSET_RV_ERR_ARGS;
 			}
 		}
-	}
 
-	if (pset->opt & XI_POLLSET_OPT_USELOCK) {
-		xi_thread_mutex_unlock(&pset->lock);
+		for (i = 0, n = 0; (xuint32)i < pset->used && n < rlen; i++) {
+			if (pset->rfds[i].revents) {
+				rfds[n] = pset->slots[pset->rslot[i]].pfd;
+				rfds[n].evts = xg_pollset_events_2pi(pset->rfds[i].revents);
+				if (pset->slots[pset->rslot[i]].pfd.evts & XI_POLL_EVENT_ONESHOT) {
+					// disarmed until xi_pollset_modify
+					pset->rfds[i].events = 0;
+				}
+				n++;
+			}
+		}
+
+		xg_pollset_unlock(pset);
 	}
 
-	return loopcnt;
+	return n;
 }
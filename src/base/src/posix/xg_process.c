@@ -167,6 +167,7 @@ xi_proc_mutex_re xi_proc_mutex_destroy(xi_proc_mutex_t *lock) {
 	return XI_PROC_MUTEX_RV_OK;
 }
 
+#if defined(XCFG_DEBUG) && (XCFG_LOG_LEVEL_MIN <= 5) // used by log_error only
 static const xchar * xg_proc_errmsg(xint32 errnum) {
 	switch (errnum) {
 	case EACCES:
@@ -210,6 +211,7 @@ static const xchar * xg_proc_errmsg(xint32 errnum) {
 		return "";
 	}
 }
+#endif // XCFG_DEBUG && XCFG_LOG_LEVEL_MIN <= 5
 
 xint32 xi_proc_create(xchar * const cmdp[], xint32 cmdln, xchar * const envp[],
 		xint32 envln, const xchar *workdir) {
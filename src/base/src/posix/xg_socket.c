@@ -18,6 +18,9 @@
  * File   : xg_socket.c
  */
 
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
 #ifndef _LARGEFILE64_SOURCE
 #define _LARGEFILE64_SOURCE
 #endif
@@ -40,12 +43,27 @@
 #include <netdb.h>
 #include <net/if.h>
 #include <poll.h>
+#include <string.h>
 
 #include "xg_fd.h"
 
 #include "xi/xi_mem.h"
 #include "xi/xi_string.h"
 
+// ----------------------------------------------
+// Definitions
+// ----------------------------------------------
+
+#if defined(__linux__) && defined(MSG_WAITFORONE) && !defined(XI_BUILD_android)
+#define XG_SOCK_MMSG
+#endif
+
+#if defined(__linux__) && defined(SOCK_NONBLOCK) && !defined(XI_BUILD_android)
+#define XG_SOCK_ACCEPT4
+#endif
+
+#define XG_SOCK_MMSG_MAX    32       // datagrams per recvmmsg/sendmmsg call
+
 // ----------------------------------------------
 // Part Internal Functions
 // ----------------------------------------------
@@ -150,6 +168,12 @@ static xint32 xg_sock_opt_2pg(xi_sock_opt_e opt) {
 		return O_NONBLOCK;
 	case XI_SOCK_OPT_REUSEADDR:
 		return SO_REUSEADDR;
+	case XI_SOCK_OPT_REUSEPORT:
+#ifdef SO_REUSEPORT
+		return SO_REUSEPORT;
+#else
+		return -1;
+#endif
 	case XI_SOCK_OPT_SENDBUF:
 		return SO_SNDBUF;
 	case XI_SOCK_OPT_RECVBUF:
@@ -187,6 +211,123 @@ static xint32 xg_sock_get_if_idx(xint32 sfd, const xchar *ip) {
 	return 0;
 }
 
+// ----------------------------------------------
+// Part Binary Address
+// ----------------------------------------------
+
+typedef union _u_sockaddr {
+	struct sockaddr      sa;
+	struct sockaddr_in   in4;
+	struct sockaddr_in6  in6;
+} xg_sockaddr_t;
+
+static socklen_t xg_sock_bin_2sa(const xi_sock_addr_bin_t *bin, xg_sockaddr_t *sa) {
+	switch (bin->family) {
+	case XI_SOCK_FAMILY_INET:
+		memset(&sa->in4, 0, sizeof(sa->in4));
+		sa->in4.sin_family = AF_INET;
+		sa->in4.sin_port = htons(bin->port);
+		memcpy(&sa->in4.sin_addr, bin->addr, 4);
+		return sizeof(sa->in4);
+	case XI_SOCK_FAMILY_INET6:
+		memset(&sa->in6, 0, sizeof(sa->in6));
+		sa->in6.sin6_family = AF_INET6;
+		sa->in6.sin6_port = htons(bin->port);
+		sa->in6.sin6_scope_id = bin->scope;
+		memcpy(&sa->in6.sin6_addr, bin->addr, 16);
+		return sizeof(sa->in6);
+	default:
+		return 0;
+	}
+}
+
+static xi_sock_re xg_sock_sa_2bin(const xg_sockaddr_t *sa, xi_sock_addr_bin_t *bin) {
+	switch (sa->sa.sa_family) {
+	case AF_INET:
+		bin->family = XI_SOCK_FAMILY_INET;
+		bin->port = ntohs(sa->in4.sin_port);
+		bin->scope = 0;
+		memcpy(bin->addr, &sa->in4.sin_addr, 4);
+		memset(bin->addr + 4, 0, 12);
+		return XI_SOCK_RV_OK;
+	case AF_INET6:
+		bin->family = XI_SOCK_FAMILY_INET6;
+		bin->port = ntohs(sa->in6.sin6_port);
+		bin->scope = sa->in6.sin6_scope_id;
+		memcpy(bin->addr, &sa->in6.sin6_addr, 16);
+		return XI_SOCK_RV_OK;
+	default:
+		memset(bin, 0, sizeof(*bin));
+		return XI_SOCK_RV_ERR_NS;
+	}
+}
+
+static xi_sock_re xg_sock_err_conn(xint32 err) {
+	switch (err) {
+	case EAGAIN:
+#if EWOULDBLOCK != EAGAIN
+	case EWOULDBLOCK:
+#endif
+	case EINPROGRESS:
+		return XI_SOCK_RV_ERR_TRYLATER;
+	case EINTR:
+		return XI_SOCK_RV_ERR_INTR;
+	case EACCES:
+	case EROFS:
+	case EPERM:
+		return XI_SOCK_RV_ERR_PERM;
+	case EBADF:
+		return XI_SOCK_RV_ERR_FD;
+	case ENOTSOCK:
+		return XI_SOCK_RV_ERR_NOTSOCK;
+	case EAFNOSUPPORT:
+	case EADDRNOTAVAIL:
+	case EFAULT:
+		return XI_SOCK_RV_ERR_ADDR;
+	case EADDRINUSE:
+		return XI_SOCK_RV_ERR_INUSE;
+	case ECONNREFUSED:
+		return XI_SOCK_RV_ERR_REFUSED;
+	case ENETUNREACH:
+	case EHOSTUNREACH:
+		return XI_SOCK_RV_ERR_UNREACH;
+	case EISCONN:
+		return XI_SOCK_RV_ERR_ALREADY;
+	case ETIMEDOUT:
+		return XI_SOCK_RV_ERR_TIMEOUT;
+	default:
+		return XI_SOCK_RV_ERR_ARGS;
+	}
+}
+
+static xi_sock_re xg_sock_err_io(xint32 err) {
+	switch (err) {
+	case EAGAIN:
+#if EWOULDBLOCK != EAGAIN
+	case EWOULDBLOCK:
+#endif
+		return XI_SOCK_RV_ERR_TRYLATER;
+	case EBADF:
+		return XI_SOCK_RV_ERR_FD;
+	case ENOTSOCK:
+		return XI_SOCK_RV_ERR_NOTSOCK;
+	case ENOTCONN:
+		return XI_SOCK_RV_ERR_NOTCONN;
+	case ECONNREFUSED:
+		return XI_SOCK_RV_ERR_REFUSED;
+	case ENOBUFS:
+		return XI_SOCK_RV_ERR_OVERFLOW;
+	case EOPNOTSUPP:
+		return XI_SOCK_RV_ERR_NS;
+	case EDESTADDRREQ:
+		return XI_SOCK_RV_ERR_ADDR;
+	case EINTR:
+		return XI_SOCK_RV_ERR_INTR;
+	default:
+		return XI_SOCK_RV_ERR_ARGS;
+	}
+}
+
 // ----------------------------------------------
 // XI Functions
 // ----------------------------------------------
@@ -332,6 +473,10 @@ xint32 xi_socket_accept(xint32 sfd, xi_sock_addr_t *fromaddr) {
 		rsock = accept(sfd, (struct sockaddr *) &addr, &addrlen);
 		if (rsock < 0) {
 			switch (errno) {
+			case EAGAIN:
+				return XI_SOCK_RV_ERR_TRYLATER;
+			case EINTR:
+				return XI_SOCK_RV_ERR_INTR;
 			case EACCES:
 			case EROFS:
 			case EPERM:
@@ -371,6 +516,10 @@ xint32 xi_socket_accept(xint32 sfd, xi_sock_addr_t *fromaddr) {
 		rsock = accept(sfd, (struct sockaddr *) &addr, &addrlen);
 		if (rsock < 0) {
 			switch (errno) {
+			case EAGAIN:
+				return XI_SOCK_RV_ERR_TRYLATER;
+			case EINTR:
+				return XI_SOCK_RV_ERR_INTR;
 			case EACCES:
 			case EROFS:
 			case EPERM:
@@ -410,6 +559,10 @@ xint32 xi_socket_accept(xint32 sfd, xi_sock_addr_t *fromaddr) {
 		rsock = accept(sfd, (struct sockaddr *) &addr, &addrlen);
 		if (rsock < 0) {
 			switch (errno) {
+			case EAGAIN:
+				return XI_SOCK_RV_ERR_TRYLATER;
+			case EINTR:
+				return XI_SOCK_RV_ERR_INTR;
 			case EACCES:
 			case EROFS:
 			case EPERM:
@@ -1103,6 +1256,427 @@ xi_sock_re xi_socket_get_local(xint32 sfd, xi_sock_addr_t *addr) {
 	return XI_SOCK_RV_OK;
 }
 
+xi_sock_re xi_socket_addr_pton(const xi_sock_addr_t *addr,
+		xi_sock_addr_bin_t *baddr) {
+	if (addr == NULL || baddr == NULL) {
+		return XI_SOCK_RV_ERR_ARGS;
+	}
+
+	xi_mem_set(baddr, 0, sizeof(*baddr));
+	switch (addr->family) {
+	case XI_SOCK_FAMILY_INET:
+		if (!inet_pton(AF_INET, addr->host, baddr->addr)) {
+			return XI_SOCK_RV_ERR_ADDR;
+		}
+		break;
+	case XI_SOCK_FAMILY_INET6:
+		if (!inet_pton(AF_INET6, addr->host, baddr->addr)) {
+			return XI_SOCK_RV_ERR_ADDR;
+		}
+		break;
+	default:
+		return XI_SOCK_RV_ERR_NS;
+	}
+	baddr->family = (xuint16) addr->family;
+	baddr->port = addr->port;
+
+	return XI_SOCK_RV_OK;
+}
+
+xi_sock_re xi_socket_addr_ntop(const xi_sock_addr_bin_t *baddr,
+		xi_sock_addr_t *addr) {
+	if (baddr == NULL || addr == NULL) {
+		return XI_SOCK_RV_ERR_ARGS;
+	}
+
+	switch (baddr->family) {
+	case XI_SOCK_FAMILY_INET:
+		inet_ntop(AF_INET, baddr->addr, addr->host, sizeof(addr->host));
+		break;
+	case XI_SOCK_FAMILY_INET6:
+		inet_ntop(AF_INET6, baddr->addr, addr->host, sizeof(addr->host));
+		break;
+	default:
+		return XI_SOCK_RV_ERR_NS;
+	}
+	addr->family = (xi_sock_family_e) baddr->family;
+	addr->port = baddr->port;
+
+	return XI_SOCK_RV_OK;
+}
+
+xi_sock_re xi_socket_bind_bin(xint32 sfd, const xi_sock_addr_bin_t *baddr) {
+	xg_sockaddr_t addr;
+	socklen_t alen;
+
+	if (sfd < 0 || baddr == NULL) {
+		return XI_SOCK_RV_ERR_ARGS;
+	}
+
+	alen = xg_sock_bin_2sa(baddr, &addr);
+	if (alen == 0) {
+		return XI_SOCK_RV_ERR_ARGS;
+	}
+
+	if (bind(sfd, &addr.sa, alen) < 0) {
+		return xg_sock_err_conn(errno);
+	}
+
+	return XI_SOCK_RV_OK;
+}
+
+xint32 xi_socket_accept_bin(xint32 sfd, xi_sock_addr_bin_t *fromaddr) {
+	xint32 rsock;
+	xg_sockaddr_t addr;
+	socklen_t alen = sizeof(addr);
+
+	if (sfd < 0) {
+		return XI_SOCK_RV_ERR_ARGS;
+	}
+
+	addr.sa.sa_family = AF_UNSPEC;
+	rsock = accept(sfd, &addr.sa, &alen);
+	if (rsock < 0) {
+		return xg_sock_err_conn(errno);
+	}
+
+	if (xg_fd_open(rsock, xg_fd_get(sfd)) < 0) {
+		close(rsock);
+		return XI_SOCK_RV_ERR_FD;
+	}
+
+	if (fromaddr != NULL) {
+		xg_sock_sa_2bin(&addr, fromaddr);
+	}
+
+	return rsock;
+}
+
+static xint32 xg_sock_accept_flags(xint32 rsock, xint32 flags) {
+	if (flags & XI_SOCK_ACCEPT_NONBLOCK) {
+		xint32 fl = fcntl(rsock, F_GETFL, 0);
+		if (fl < 0 || fcntl(rsock, F_SETFL, fl | O_NONBLOCK) < 0) {
+			return -1;
+		}
+	}
+	if (flags & XI_SOCK_ACCEPT_CLOEXEC) {
+		xint32 fl = fcntl(rsock, F_GETFD, 0);
+		if (fl < 0 || fcntl(rsock, F_SETFD, fl | FD_CLOEXEC) < 0) {
+			return -1;
+		}
+	}
+	return 0;
+}
+
+xint32 xi_socket_accept4(xint32 sfd, xi_sock_addr_bin_t *fromaddr,
+		xint32 flags) {
+	xint32 rsock;
+	xg_sockaddr_t addr;
+	socklen_t alen = sizeof(addr);
+
+	if (sfd < 0) {
+		return XI_SOCK_RV_ERR_ARGS;
+	}
+
+	addr.sa.sa_family = AF_UNSPEC;
+#ifdef XG_SOCK_ACCEPT4
+	rsock = accept4(sfd, &addr.sa, &alen,
+			((flags & XI_SOCK_ACCEPT_NONBLOCK) ? SOCK_NONBLOCK : 0)
+					| ((flags & XI_SOCK_ACCEPT_CLOEXEC) ? SOCK_CLOEXEC : 0));
+	if (rsock < 0 && errno == ENOSYS) {
+		alen = sizeof(addr);
+		rsock = accept(sfd, &addr.sa, &alen);
+		if (rsock >= 0 && xg_sock_accept_flags(rsock, flags) < 0) {
+			close(rsock);
+			return XI_SOCK_RV_ERR_FD;
+		}
+	}
+#else // !XG_SOCK_ACCEPT4
+	rsock = accept(sfd, &addr.sa, &alen);
+	if (rsock >= 0 && xg_sock_accept_flags(rsock, flags) < 0) {
+		close(rsock);
+		return XI_SOCK_RV_ERR_FD;
+	}
+#endif // XG_SOCK_ACCEPT4
+	if (rsock < 0) {
+		return xg_sock_err_conn(errno);
+	}
+
+	if (xg_fd_open(rsock, xg_fd_get(sfd)) < 0) {
+		close(rsock);
+		return XI_SOCK_RV_ERR_FD;
+	}
+
+	if (fromaddr != NULL) {
+		xg_sock_sa_2bin(&addr, fromaddr);
+	}
+
+	return rsock;
+}
+
+xi_sock_re xi_socket_connect_bin(xint32 sfd, const xi_sock_addr_bin_t *caddr) {
+	xg_sockaddr_t addr;
+	socklen_t alen;
+
+	if (sfd < 0 || caddr == NULL) {
+		return XI_SOCK_RV_ERR_ARGS;
+	}
+
+	if (caddr->family == XI_SOCK_FAMILY_UNSPEC) {
+		memset(&addr, 0, sizeof(addr));
+		addr.sa.sa_family = AF_UNSPEC;
+		alen = sizeof(addr.sa);
+	} else {
+		alen = xg_sock_bin_2sa(caddr, &addr);
+		if (alen == 0) {
+			return XI_SOCK_RV_ERR_ARGS;
+		}
+	}
+
+	if (connect(sfd, &addr.sa, alen) < 0) {
+		return xg_sock_err_conn(errno);
+	}
+
+	return XI_SOCK_RV_OK;
+}
+
+xssize xi_socket_recvfrom_bin(xint32 sfd, xvoid *buf, xsize blen,
+		xi_sock_addr_bin_t *fromaddr) {
+	xssize ret;
+	xg_sockaddr_t addr;
+	socklen_t alen = sizeof(addr);
+
+	if (sfd < 0 || buf == NULL || blen <= 0) {
+		return XI_SOCK_RV_ERR_ARGS;
+	}
+
+	addr.sa.sa_family = AF_UNSPEC;
+	ret = recvfrom(sfd, buf, blen, 0, &addr.sa, &alen);
+	if (ret < 0) {
+		return xg_sock_err_io(errno);
+	}
+
+	if (fromaddr != NULL) {
+		xg_sock_sa_2bin(&addr, fromaddr);
+	}
+
+	return ret;
+}
+
+xssize xi_socket_sendto_bin(xint32 sfd, const xvoid *buf, xsize blen,
+		const xi_sock_addr_bin_t *toaddr) {
+	xssize ret;
+	xg_sockaddr_t addr;
+	socklen_t alen;
+
+	if (sfd < 0 || buf == NULL || blen <= 0 || toaddr == NULL) {
+		return XI_SOCK_RV_ERR_ARGS;
+	}
+
+	alen = xg_sock_bin_2sa(toaddr, &addr);
+	if (alen == 0) {
+		return XI_SOCK_RV_ERR_ADDR;
+	}
+
+	ret = sendto(sfd, buf, blen, 0, &addr.sa, alen);
+	if (ret < 0) {
+		return xg_sock_err_io(errno);
+	}
+
+	return ret;
+}
+
+xi_sock_re xi_socket_get_peer_bin(xint32 sfd, xi_sock_addr_bin_t *addr) {
+	xg_sockaddr_t xaddr;
+	socklen_t alen = sizeof(xaddr);
+
+	if (sfd < 0 || addr == NULL) {
+		return XI_SOCK_RV_ERR_ARGS;
+	}
+
+	if (getpeername(sfd, &xaddr.sa, &alen) < 0) {
+		return xg_sock_err_io(errno);
+	}
+
+	return xg_sock_sa_2bin(&xaddr, addr);
+}
+
+xi_sock_re xi_socket_get_local_bin(xint32 sfd, xi_sock_addr_bin_t *addr) {
+	xg_sockaddr_t xaddr;
+	socklen_t alen = sizeof(xaddr);
+
+	if (sfd < 0 || addr == NULL) {
+		return XI_SOCK_RV_ERR_ARGS;
+	}
+
+	if (getsockname(sfd, &xaddr.sa, &alen) < 0) {
+		return xg_sock_err_io(errno);
+	}
+
+	return xg_sock_sa_2bin(&xaddr, addr);
+}
+
+xint32 xi_socket_recvmmsg(xint32 sfd, xi_sock_msg_t *msgs, xint32 count) {
+	xint32 i, done = 0;
+
+	if (sfd < 0 || msgs == NULL || count <= 0) {
+		return XI_SOCK_RV_ERR_ARGS;
+	}
+
+#ifdef XG_SOCK_MMSG
+	while (done < count) {
+		struct mmsghdr hdr[XG_SOCK_MMSG_MAX];
+		struct iovec iov[XG_SOCK_MMSG_MAX];
+		xg_sockaddr_t addr[XG_SOCK_MMSG_MAX];
+		xint32 ret, n = count - done;
+
+		if (n > XG_SOCK_MMSG_MAX) {
+			n = XG_SOCK_MMSG_MAX;
+		}
+		memset(hdr, 0, sizeof(struct mmsghdr) * n);
+		for (i = 0; i < n; i++) {
+			iov[i].iov_base = msgs[done + i].buf;
+			iov[i].iov_len = msgs[done + i].blen;
+			addr[i].sa.sa_family = AF_UNSPEC;
+			hdr[i].msg_hdr.msg_name = &addr[i];
+			hdr[i].msg_hdr.msg_namelen = sizeof(addr[i]);
+			hdr[i].msg_hdr.msg_iov = &iov[i];
+			hdr[i].msg_hdr.msg_iovlen = 1;
+		}
+
+		// wait for the first datagram only
+		ret = recvmmsg(sfd, hdr, (xuint32) n,
+				(done == 0) ? MSG_WAITFORONE : MSG_DONTWAIT, NULL);
+		if (ret < 0) {
+			if (done > 0) {
+				return done;
+			}
+			if (errno == ENOSYS) {
+				break;
+			}
+			return xg_sock_err_io(errno);
+		}
+
+		for (i = 0; i < ret; i++) {
+			msgs[done + i].len = (xssize) hdr[i].msg_len;
+			xg_sock_sa_2bin(&addr[i], &msgs[done + i].addr);
+		}
+		done += ret;
+		if (ret < n) {
+			break;
+		}
+	}
+	if (done > 0) {
+		return done;
+	}
+#endif // XG_SOCK_MMSG
+
+	// one datagram per call : only the first one can block
+	for (i = 0; i < count; i++) {
+		xssize ret;
+		xg_sockaddr_t addr;
+		socklen_t alen = sizeof(addr);
+
+		addr.sa.sa_family = AF_UNSPEC;
+		ret = recvfrom(sfd, msgs[i].buf, msgs[i].blen, (i == 0) ? 0 : MSG_DONTWAIT,
+				&addr.sa, &alen);
+		if (ret < 0) {
+			if (i > 0) {
+				break;
+			}
+			return xg_sock_err_io(errno);
+		}
+		msgs[i].len = ret;
+		xg_sock_sa_2bin(&addr, &msgs[i].addr);
+	}
+
+	return i;
+}
+
+xint32 xi_socket_sendmmsg(xint32 sfd, xi_sock_msg_t *msgs, xint32 count) {
+	xint32 i, done = 0;
+
+	if (sfd < 0 || msgs == NULL || count <= 0) {
+		return XI_SOCK_RV_ERR_ARGS;
+	}
+
+#ifdef XG_SOCK_MMSG
+	while (done < count) {
+		struct mmsghdr hdr[XG_SOCK_MMSG_MAX];
+		struct iovec iov[XG_SOCK_MMSG_MAX];
+		xg_sockaddr_t addr[XG_SOCK_MMSG_MAX];
+		xint32 ret, n = count - done;
+
+		if (n > XG_SOCK_MMSG_MAX) {
+			n = XG_SOCK_MMSG_MAX;
+		}
+		memset(hdr, 0, sizeof(struct mmsghdr) * n);
+		for (i = 0; i < n; i++) {
+			xi_sock_msg_t *msg = &msgs[done + i];
+
+			if (msg->addr.family != XI_SOCK_FAMILY_UNSPEC) {
+				socklen_t alen = xg_sock_bin_2sa(&msg->addr, &addr[i]);
+				if (alen == 0) {
+					break;
+				}
+				hdr[i].msg_hdr.msg_name = &addr[i];
+				hdr[i].msg_hdr.msg_namelen = alen;
+			}
+			iov[i].iov_base = msg->buf;
+			iov[i].iov_len = msg->blen;
+			hdr[i].msg_hdr.msg_iov = &iov[i];
+			hdr[i].msg_hdr.msg_iovlen = 1;
+		}
+		if (i == 0) {
+			// an invalid address at the head
+			return (done > 0) ? done : XI_SOCK_RV_ERR_ADDR;
+		}
+		n = i;
+
+		ret = sendmmsg(sfd, hdr, (xuint32) n, 0);
+		if (ret < 0) {
+			if (done > 0) {
+				return done;
+			}
+			if (errno == ENOSYS) {
+				break;
+			}
+			return xg_sock_err_io(errno);
+		}
+
+		for (i = 0; i < ret; i++) {
+			msgs[done + i].len = (xssize) hdr[i].msg_len;
+		}
+		done += ret;
+		if (ret < n) {
+			break;
+		}
+	}
+	if (done > 0) {
+		return done;
+	}
+#endif // XG_SOCK_MMSG
+
+	for (i = 0; i < count; i++) {
+		xssize ret;
+
+		if (msgs[i].addr.family == XI_SOCK_FAMILY_UNSPEC) {
+			ret = xi_socket_send(sfd, msgs[i].buf, msgs[i].blen);
+		} else {
+			ret = xi_socket_sendto_bin(sfd, msgs[i].buf, msgs[i].blen, &msgs[i].addr);
+		}
+		if (ret < 0) {
+			if (i > 0) {
+				break;
+			}
+			return (xint32) ret;
+		}
+		msgs[i].len = ret;
+	}
+
+	return i;
+}
+
 xi_sock_re xi_mcast_join(xint32 sfd, xi_sock_addr_t iface, xi_sock_addr_t grp,
 		xi_sock_addr_t *src) {
 	xg_fd_t *sdesc;
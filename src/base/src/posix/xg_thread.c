@@ -77,7 +77,19 @@ static xg_threads_info_t _g_thr_info = {
 /* all_threads_suspended */0,
 /* threads_waiting_to_start */0, };
 
-static xi_hashtb_t *_g_thr_db = NULL;
+static xi_hashtb_conc_t *_g_thr_db = NULL;
+
+/*
+ * The data of the calling thread, for the lookups of itself
+ * (suspend-checks, signal handler) which must not take _g_thr_lock.
+ * _g_thr_db is still used for the other threads and the enumeration.
+ */
+#if defined(XI_BUILD_android) || defined(XI_BUILD_bcm7403) || defined(XI_BUILD_smp8654)
+static pthread_key_t _g_thr_self_key;
+static pthread_once_t _g_thr_self_once = PTHREAD_ONCE_INIT;
+#else
+static __thread xg_thread_dat_t *_g_thr_self = NULL;
+#endif
 
 // ----------------------------------------------
 // Part Internal Functions
@@ -101,12 +113,39 @@ static xi_hashtb_t *_g_thr_db = NULL;
 #    endif // __x86_64
 #endif
 
+#if defined(XI_BUILD_android) || defined(XI_BUILD_bcm7403) || defined(XI_BUILD_smp8654)
+static xvoid xg_thread_self_init() {
+	pthread_key_create(&_g_thr_self_key, NULL);
+}
+
+_XI_INLINE xvoid xg_thread_self_set(xg_thread_dat_t *tdat) {
+	pthread_once(&_g_thr_self_once, xg_thread_self_init);
+	pthread_setspecific(_g_thr_self_key, tdat);
+}
+
+_XI_INLINE xg_thread_dat_t *xg_thread_self_get() {
+	pthread_once(&_g_thr_self_once, xg_thread_self_init);
+	return pthread_getspecific(_g_thr_self_key);
+}
+#else
+_XI_INLINE xvoid xg_thread_self_set(xg_thread_dat_t *tdat) {
+	_g_thr_self = tdat;
+}
+
+_XI_INLINE xg_thread_dat_t *xg_thread_self_get() {
+	return _g_thr_self;
+}
+#endif
+
 _XI_INLINE xg_thread_dat_t *xg_thread_tdat_get(xi_thread_t tid) {
-	xg_thread_dat_t *tdat;
-	pthread_mutex_lock(&_g_thr_lock);
-	tdat = xi_hashtb_get(_g_thr_db, &tid, sizeof(xi_thread_t));
-	pthread_mutex_unlock(&_g_thr_lock);
-	return tdat;
+	xg_thread_dat_t *tdat = xg_thread_self_get();
+
+	if (tdat != NULL && tdat->tid == tid) {
+		return tdat;
+	}
+
+	// it takes no lock
+	return xi_hashtb_conc_get(_g_thr_db, &tid, sizeof(xi_thread_t));
 }
 
 static xi_thread_re xg_thread_disable_suspend(xi_thread_t tid, xvoid *stack_top) {
@@ -212,9 +251,11 @@ static xvoid xg_thrmain_init() {
 	tdat->blocking = XI_THREAD_SUSBLK_NOBLOCK;
 
 	pthread_mutex_lock(&_g_thr_lock);
-	xi_hashtb_set(_g_thr_db, &tdat->tid, sizeof(xi_thread_t), tdat);
+	xi_hashtb_conc_set(_g_thr_db, &tdat->tid, sizeof(xi_thread_t), tdat);
 	pthread_mutex_unlock(&_g_thr_lock);
 
+	xg_thread_self_set(tdat);
+
 	//	log_print(XDLOG, "[MAIN_THREAD] =======================\n");
 	//	log_print(XDLOG, "tdat->entry = %p\n", tdat->entry);
 	//	log_print(XDLOG, "tdat->args = %p\n", tdat->args);
@@ -289,12 +330,13 @@ static xvoid *xg_thread_starter(xvoid *args) {
 	tdat->tid = xi_thread_self();
 	tdat->stack_base = &tdat;
 	tdat->stack_top = &tdat;
+	xg_thread_self_set(tdat);
 
 	// Lock the world!!
 	pthread_mutex_lock(&_g_thr_lock);
 
 	// Add the thread to HashTable
-	xi_hashtb_set(_g_thr_db, &tdat->tid, sizeof(xi_thread_t), tdat);
+	xi_hashtb_conc_set(_g_thr_db, &tdat->tid, sizeof(xi_thread_t), tdat);
 
 	// Wait if all-suspended
 	_g_thr_info.threads_waiting_to_start++;
@@ -334,7 +376,8 @@ static xvoid *xg_thread_starter(xvoid *args) {
 	//	log_print(XDLOG, "tdat->blocking = %d\n", tdat->blocking);
 	//	log_print(XDLOG, "=====================================\n");
 
-	xi_hashtb_set(_g_thr_db, &tdat->tid, sizeof(xi_thread_t), NULL);
+	xi_hashtb_conc_set(_g_thr_db, &tdat->tid, sizeof(xi_thread_t), NULL);
+	xg_thread_self_set(NULL);
 	_g_thr_info.threads_count--;
 	xi_mem_free(tdat);
 	pthread_mutex_unlock(&_g_thr_lock);
@@ -357,7 +400,7 @@ xi_thread_re xi_thread_create(xi_thread_t *tid, const xchar *tname,
 #endif
 
 	if (_g_thr_db == NULL) {
-		_g_thr_db = xi_hashtb_create();
+		_g_thr_db = xi_hashtb_conc_create(NULL);
 		xg_sighnd_init();
 		xg_thrattr_init();
 		xg_thrmain_init();
@@ -505,7 +548,8 @@ xi_thread_re xi_thread_suspend(xi_thread_t tid) {
 }
 
 xi_thread_re xi_thread_suspend_all() {
-	xi_hashtb_idx_t *hidx = NULL;
+	xi_hashtb_conc_idx_t iter;
+	xi_hashtb_conc_idx_t *hidx = NULL;
 	xg_thread_dat_t *self = xg_thread_tdat_get(xi_thread_self());
 
 	pthread_mutex_lock(&_g_thr_lock);
@@ -519,13 +563,13 @@ xi_thread_re xi_thread_suspend_all() {
 	//	log_print(XDLOG, "=====================================\n");
 	//	log_print(XDLOG, "[SUSPEND_ALL] self = %p\n", self);
 
-	for (hidx = xi_hashtb_first(_g_thr_db); hidx; hidx = xi_hashtb_next(hidx)) {
+	for (hidx = xi_hashtb_conc_first(_g_thr_db, &iter); hidx; hidx = xi_hashtb_conc_next(hidx)) {
 		xint32 klen = 0;
 		xvoid *vkey = NULL;
 		xvoid *vdat = NULL;
 		xg_thread_dat_t *tdat = NULL;
 
-		xi_hashtb_this(hidx, (const void**)&vkey, &klen, &vdat);
+		xi_hashtb_conc_this(hidx, (const void**)&vkey, &klen, &vdat);
 		tdat = vdat;
 
 		if (tdat == self) {
@@ -543,9 +587,9 @@ xi_thread_re xi_thread_suspend_all() {
 	}
 
 	// TODO : check this
-	//	for (hidx = xi_hashtb_first(_g_thr_db); hidx; hidx = xi_hashtb_next(hidx)) {
+	//	for (hidx = xi_hashtb_conc_first(_g_thr_db, &iter); hidx; hidx = xi_hashtb_conc_next(hidx)) {
 	//		xg_thread_dat_t *tdat = NULL;
-	//		xi_hashtb_this(hidx, NULL, NULL, (xvoid **) &tdat);
+	//		xi_hashtb_conc_this(hidx, NULL, NULL, (xvoid **) &tdat);
 	//		if (tdat == self) {
 	//			log_print(XDLOG, "[SUSPEND_ALL] SKIP : tdat->tname = %s\n", tdat->tname);
 	//			continue;
@@ -597,18 +641,19 @@ xi_thread_re xi_thread_resume(xi_thread_t tid) {
 }
 
 xi_thread_re xi_thread_resume_all() {
-	xi_hashtb_idx_t *hidx = NULL;
+	xi_hashtb_conc_idx_t iter;
+	xi_hashtb_conc_idx_t *hidx = NULL;
 	xg_thread_dat_t *self = xg_thread_tdat_get(xi_thread_self());
 
 	pthread_mutex_lock(&_g_thr_lock);
 
-	for (hidx = xi_hashtb_first(_g_thr_db); hidx; hidx = xi_hashtb_next(hidx)) {
+	for (hidx = xi_hashtb_conc_first(_g_thr_db, &iter); hidx; hidx = xi_hashtb_conc_next(hidx)) {
 		xint32 klen = 0;
 		xvoid *vkey = NULL;
 		xvoid *vdat = NULL;
 		xg_thread_dat_t *tdat = NULL;
 
-		xi_hashtb_this(hidx, (const xvoid **)&vkey, &klen, &vdat);
+		xi_hashtb_conc_this(hidx, (const xvoid **)&vkey, &klen, &vdat);
 		tdat = vdat;
 
 		if (tdat == self) {
@@ -626,9 +671,9 @@ xi_thread_re xi_thread_resume_all() {
 	}
 
 	// TODO : check this
-	//	for (hidx = xi_hashtb_first(_g_thr_db); hidx; hidx = xi_hashtb_next(hidx)) {
+	//	for (hidx = xi_hashtb_conc_first(_g_thr_db, &iter); hidx; hidx = xi_hashtb_conc_next(hidx)) {
 	//		xg_thread_dat_t *tdat = NULL;
-	//		xi_hashtb_this(hidx, NULL, NULL, (xvoid **) &tdat);
+	//		xi_hashtb_conc_this(hidx, NULL, NULL, (xvoid **) &tdat);
 	//		while (tdat->state == XI_THREAD_STATE_SUSPENDED) {
 	//			xi_thread_yield();
 	//		}
@@ -713,7 +758,7 @@ xi_thread_re xi_thread_disable_suspend_fast(xi_thread_t tid) {
 
 xi_thread_t xi_thread_self() {
 	if (_g_thr_db == NULL) {
-		_g_thr_db = xi_hashtb_create();
+		_g_thr_db = xi_hashtb_conc_create(NULL);
 		xg_sighnd_init();
 		xg_thrattr_init();
 		xg_thrmain_init();
@@ -773,7 +818,7 @@ xi_thread_re xi_thread_set_prior(xi_thread_t tid, xint32 new_prior) {
 	}
 #else
 	if (_g_thr_db == NULL) {
-		_g_thr_db = xi_hashtb_create();
+		_g_thr_db = xi_hashtb_conc_create(NULL);
 		xg_sighnd_init();
 		xg_thrattr_init();
 		xg_thrmain_init();
@@ -799,7 +844,7 @@ xi_thread_re xi_thread_get_prior(xi_thread_t tid, xint32 *prior) {
 	}
 #else
 	if (_g_thr_db == NULL) {
-		_g_thr_db = xi_hashtb_create();
+		_g_thr_db = xi_hashtb_conc_create(NULL);
 		xg_sighnd_init();
 		xg_thrattr_init();
 		xg_thrmain_init();
@@ -877,7 +922,7 @@ xint32 xi_thread_is_suspendable(xi_thread_t tid) {
 	return tdat->blocking;
 }
 
-xvoid *xi_thread_list() {
+xi_hashtb_conc_t *xi_thread_list() {
 	return _g_thr_db;
 }
 
@@ -18,7 +18,9 @@
  * File : xg_thread_sync.c
  */
 
+#define _GNU_SOURCE
 #include <pthread.h>
+#include <sched.h>
 #include <errno.h>
 #ifdef __APPLE__
 #include <sys/time.h>
@@ -26,6 +28,7 @@
 
 #include "xi/xi_thread.h"
 
+#include "xi/xi_atomic.h"
 #include "xi/xi_mem.h"
 #include "xi/xi_log.h"
 #include "xi/xi_string.h"
@@ -34,132 +37,93 @@
 // Inner Structure
 // ----------------------------------------------
 
+/*
+ * A mutex/cond/rwlock/seqlock handle is the address of its own element,
+ * allocated on creation and freed on destruction. So there is neither a limit
+ * on the number of objects nor a shared table to scan or to index on each call.
+ */
+
 typedef struct _st_thread_mutex {
-	xint32 used;
 	xchar oname[XCFG_ONAME_MAX];
 	pthread_mutex_t lock;
 } xg_thread_mutex_t;
 
 typedef struct _st_thread_cond {
-	xint32 used;
 	xchar oname[XCFG_ONAME_MAX];
 	pthread_cond_t cond;
 } xg_thread_cond_t;
 
-typedef struct _st_thread_mutex_pool {
-	xint32 init;
-	xint32 counter;
-	xintptr last;
-	xg_thread_mutex_t locks[XCFG_MUTEX_MAX];
-} xg_thr_locks_t;
+typedef struct _st_thread_rwlock {
+	xchar oname[XCFG_ONAME_MAX];
+	pthread_rwlock_t lock;
+} xg_thread_rwlock_t;
+
+typedef struct _st_thread_seqlock {
+	volatile xuint32 seq; // odd while a write is in progress
+	xchar oname[XCFG_ONAME_MAX];
+	pthread_mutex_t wlock; // serializes the writers
+} xg_thread_seqlock_t;
 
-typedef struct _st_thread_cond_pool {
-	xint32 init;
-	xint32 counter;
-	xintptr last;
-	xg_thread_cond_t conds[XCFG_COND_MAX];
-} xg_thr_conds_t;
+// spins of a seqlock reader before yielding to the writer
+#define XG_SEQLOCK_SPIN 64
 
 // ----------------------------------------------
 // Global Variables
 // ----------------------------------------------
 
-static xg_thr_locks_t _g_thr_locks;
-static xg_thr_conds_t _g_thr_conds;
+static volatile xuint32 _g_thr_locks = 0; // the number of living mutexes
+static volatile xuint32 _g_thr_conds = 0; // the number of living conds
 
 // ----------------------------------------------
 // Part Internal Functions
 // ----------------------------------------------
 
-static xintptr xg_tmutex_alloc() {
-	xintptr i;
-
-	if (!_g_thr_locks.init) {
-		xi_mem_set(&_g_thr_locks, 0, sizeof(_g_thr_locks));
-		_g_thr_locks.init = 1;
-	}
-
-	for (i = _g_thr_locks.last; i < XCFG_MUTEX_MAX; i++) {
-		if (!_g_thr_locks.locks[i].used) {
-			_g_thr_locks.locks[i].used = 1;
-			_g_thr_locks.last = i;
-			_g_thr_locks.counter++;
-			//log_trace(XDLOG, "[1st] idx=%d / total=%d\n", i, _g_thr_locks.counter);
-			return i;
-		}
+_XI_INLINE xg_thread_mutex_t *xg_tmutex_get(xi_thread_mutex_t *lock) {
+	if (lock == NULL || (*lock) == 0 || (*lock) == (xi_thread_mutex_t)-1) {
+		return NULL;
 	}
-
-	if (_g_thr_locks.counter < XCFG_MUTEX_MAX) {
-		_g_thr_locks.last = 0;
-	}
-
-	for (i = _g_thr_locks.last; i < XCFG_MUTEX_MAX; i++) {
-		if (!_g_thr_locks.locks[i].used) {
-			_g_thr_locks.locks[i].used = 1;
-			_g_thr_locks.last = i;
-			_g_thr_locks.counter++;
-			//log_trace(XDLOG, "[2nd] idx=%d / total=%d\n", i, _g_thr_locks.counter);
-			return i;
-		}
-	}
-
-	log_error(XDLOG, "Cannot find free mutex-element!!\n");
-	return -1;
+	return (xg_thread_mutex_t *) (*lock);
 }
 
-static xintptr xg_tmutex_free(xintptr idx) {
-	if (_g_thr_locks.locks[idx].used) {
-		_g_thr_locks.counter--;
-		_g_thr_locks.locks[idx].used = 0;
-		xi_mem_set(_g_thr_locks.locks[idx].oname, 0, XCFG_ONAME_MAX);
+_XI_INLINE xg_thread_cond_t *xg_tcond_get(xi_thread_cond_t *cond) {
+	if (cond == NULL || (*cond) == 0 || (*cond) == (xi_thread_cond_t)-1) {
+		return NULL;
 	}
-	return idx;
+	return (xg_thread_cond_t *) (*cond);
 }
 
-static xintptr xg_tcond_alloc() {
-	xintptr i;
-
-	if (!_g_thr_locks.init) {
-		xi_mem_set(&_g_thr_conds, 0, sizeof(_g_thr_conds));
-		_g_thr_conds.init = 1;
-	}
-
-	for (i = _g_thr_conds.last; i < XCFG_COND_MAX; i++) {
-		if (!_g_thr_conds.conds[i].used) {
-			_g_thr_conds.conds[i].used = 1;
-			_g_thr_conds.last = i;
-			_g_thr_conds.counter++;
-			//log_trace(XDLOG, "[1st] idx=%d / total=%d\n", i, _g_thr_conds.counter);
-			return i;
-		}
-	}
-
-	if (_g_thr_conds.counter < XCFG_COND_MAX) {
-		_g_thr_conds.last = 0;
+_XI_INLINE xg_thread_rwlock_t *xg_trwlock_get(xi_thread_rwlock_t *rwlock) {
+	if (rwlock == NULL || (*rwlock) == 0 || (*rwlock) == (xi_thread_rwlock_t)-1) {
+		return NULL;
 	}
+	return (xg_thread_rwlock_t *) (*rwlock);
+}
 
-	for (i = _g_thr_conds.last; i < XCFG_COND_MAX; i++) {
-		if (!_g_thr_conds.conds[i].used) {
-			_g_thr_conds.conds[i].used = 1;
-			_g_thr_conds.last = i;
-			_g_thr_conds.counter++;
-			//log_trace(XDLOG, "[2nd] idx=%d / total=%d\n", i, _g_thr_conds.counter);
-			return i;
-		}
+_XI_INLINE xg_thread_seqlock_t *xg_tseqlock_get(xi_thread_seqlock_t *seqlock) {
+	if (seqlock == NULL || (*seqlock) == 0 || (*seqlock) == (xi_thread_seqlock_t)-1) {
+		return NULL;
 	}
-
-	log_error(XDLOG, "Cannot find free cond-element!!\n");
-	return -1;
+	return (xg_thread_seqlock_t *) (*seqlock);
 }
 
-static xintptr xg_tcond_free(xintptr idx) {
-	if (_g_thr_conds.conds[idx].used) {
-		_g_thr_conds.counter--;
-		_g_thr_conds.conds[idx].used = 0;
-		xi_mem_set(_g_thr_conds.conds[idx].oname, 0, XCFG_ONAME_MAX);
-
+_XI_INLINE xi_thread_rwlock_re xg_trwlock_rv(xint32 ret) {
+	switch (ret) {
+	case 0:
+		return XI_RWLOCK_RV_OK;
+	case EBUSY:
+		return XI_RWLOCK_RV_ERR_BUSY;
+	case EAGAIN:
+		return XI_RWLOCK_RV_ERR_NOMORE;
+	case EDEADLK:
+		return XI_RWLOCK_RV_ERR_AGAIN;
+	case ENOMEM:
+		return XI_RWLOCK_RV_ERR_NOMEM;
+	case EPERM:
+		return XI_RWLOCK_RV_ERR_PERM;
+	case EINVAL:
+	default:
+		return XI_RWLOCK_RV_ERR_ARGS;
 	}
-	return idx;
 }
 
 // ----------------------------------------------
@@ -172,23 +136,34 @@ static xintptr xg_tcond_free(xintptr idx) {
 
 xi_thread_mutex_re xi_thread_mutex_create(xi_thread_mutex_t *lock, xchar *mname) {
 	xint32 ret;
-	xintptr idx;
 	xg_thread_mutex_t *flock;
+	pthread_mutexattr_t attr;
 
-	idx = xg_tmutex_alloc();
-	if (idx < 0) {
-		log_error(XDLOG, "Cannot create mutex : [%s]!!! (total=%d)\n", mname,
-				_g_thr_locks.counter);
-		(*lock) = (xi_thread_mutex_t)-1;
-		return XI_MUTEX_RV_ERR_NOMORE;
+	(*lock) = (xi_thread_mutex_t)-1;
+
+	flock = xi_mem_alloc(sizeof(xg_thread_mutex_t));
+	if (flock == NULL) {
+		log_error(XDLOG, "Cannot create mutex : [%s]!!! (total=%u)\n", mname,
+				_g_thr_locks);
+		return XI_MUTEX_RV_ERR_NOMEM;
 	}
-	flock = &(_g_thr_locks.locks[idx]);
 
-	ret = pthread_mutex_init(&flock->lock, NULL);
+	pthread_mutexattr_init(&attr);
+#ifdef PTHREAD_ADAPTIVE_MUTEX_INITIALIZER_NP
+	// spin for a while (bounded by the kernel) before sleeping on the futex
+	pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_ADAPTIVE_NP);
+#endif
+	ret = pthread_mutex_init(&flock->lock, &attr);
+	pthread_mutexattr_destroy(&attr);
+	if (ret != 0) {
+		xi_mem_free(flock);
+	}
 	switch (ret) {
 	case 0:
 		xi_strncpy(flock->oname, mname, (XCFG_ONAME_MAX - 1));
-		(*lock) = (xi_thread_mutex_t) (idx);
+		flock->oname[XCFG_ONAME_MAX - 1] = '\0';
+		xi_atomic_inc32(&_g_thr_locks);
+		(*lock) = (xi_thread_mutex_t) flock;
 		return XI_MUTEX_RV_OK;
 	case EAGAIN:
 		return XI_MUTEX_RV_ERR_NOMORE;
@@ -206,15 +181,12 @@ xi_thread_mutex_re xi_thread_mutex_create(xi_thread_mutex_t *lock, xchar *mname)
 
 xi_thread_mutex_re xi_thread_mutex_lock(xi_thread_mutex_t *lock) {
 	xint32 ret;
-	xintptr idx = (xintptr)(*lock);
-	xg_thread_mutex_t *flock = NULL;
+	xg_thread_mutex_t *flock = xg_tmutex_get(lock);
 
-	if (idx > XCFG_MUTEX_MAX) {
+	if (flock == NULL) {
 		return XI_MUTEX_RV_ERR_ARGS;
 	}
 
-	flock = &(_g_thr_locks.locks[idx]);
-
 	ret = pthread_mutex_lock(&flock->lock);
 	switch (ret) {
 	case 0:
@@ -233,15 +205,12 @@ xi_thread_mutex_re xi_thread_mutex_lock(xi_thread_mutex_t *lock) {
 
 xi_thread_mutex_re xi_thread_mutex_trylock(xi_thread_mutex_t *lock) {
 	xint32 ret;
-	xintptr idx = (xintptr)(*lock);
-	xg_thread_mutex_t *flock = NULL;
+	xg_thread_mutex_t *flock = xg_tmutex_get(lock);
 
-	if (idx > XCFG_MUTEX_MAX) {
+	if (flock == NULL) {
 		return XI_MUTEX_RV_ERR_ARGS;
 	}
 
-	flock = &(_g_thr_locks.locks[idx]);
-
 	ret = pthread_mutex_trylock(&flock->lock);
 	switch (ret) {
 	case 0:
@@ -260,15 +229,12 @@ xi_thread_mutex_re xi_thread_mutex_trylock(xi_thread_mutex_t *lock) {
 
 xi_thread_mutex_re xi_thread_mutex_unlock(xi_thread_mutex_t *lock) {
 	xint32 ret;
-	xintptr idx = (xintptr)(*lock);
-	xg_thread_mutex_t *flock = NULL;
+	xg_thread_mutex_t *flock = xg_tmutex_get(lock);
 
-	if (idx > XCFG_MUTEX_MAX) {
+	if (flock == NULL) {
 		return XI_MUTEX_RV_ERR_ARGS;
 	}
 
-	flock = &(_g_thr_locks.locks[idx]);
-
 	ret = pthread_mutex_unlock(&flock->lock);
 	switch (ret) {
 	case 0:
@@ -285,19 +251,18 @@ xi_thread_mutex_re xi_thread_mutex_unlock(xi_thread_mutex_t *lock) {
 
 xi_thread_mutex_re xi_thread_mutex_destroy(xi_thread_mutex_t *lock) {
 	xint32 ret;
-	xintptr idx = (xintptr)(*lock);
-	xg_thread_mutex_t *flock = NULL;
+	xg_thread_mutex_t *flock = xg_tmutex_get(lock);
 
-	if (idx > XCFG_MUTEX_MAX) {
+	if (flock == NULL) {
 		return XI_MUTEX_RV_ERR_ARGS;
 	}
 
-	flock = &(_g_thr_locks.locks[idx]);
-
 	ret = pthread_mutex_destroy(&(flock->lock));
 	switch (ret) {
 	case 0:
-		xg_tmutex_free(idx);
+		xi_mem_free(flock);
+		xi_atomic_sub32(&_g_thr_locks, 1);
+		(*lock) = (xi_thread_mutex_t)-1;
 		return XI_MUTEX_RV_OK;
 	case EBUSY:
 		return XI_MUTEX_RV_ERR_BUSY;
@@ -313,23 +278,27 @@ xi_thread_mutex_re xi_thread_mutex_destroy(xi_thread_mutex_t *lock) {
 
 xi_thread_cond_re xi_thread_cond_create(xi_thread_cond_t *cond, xchar *cname) {
 	xint32 ret;
-	xintptr idx;
 	xg_thread_cond_t *fcond;
 
-	idx = xg_tcond_alloc();
-	if (idx < 0) {
-		log_error(XDLOG, "Cannot create cond : [%s]!!! (total=%d)\n", cname,
-				_g_thr_conds.counter);
-		(*cond) = (xi_thread_cond_t)-1;
-		return XI_COND_RV_ERR_NOMORE;
+	(*cond) = (xi_thread_cond_t)-1;
+
+	fcond = xi_mem_alloc(sizeof(xg_thread_cond_t));
+	if (fcond == NULL) {
+		log_error(XDLOG, "Cannot create cond : [%s]!!! (total=%u)\n", cname,
+				_g_thr_conds);
+		return XI_COND_RV_ERR_NOMEM;
 	}
-	fcond = &(_g_thr_conds.conds[idx]);
 
 	ret = pthread_cond_init(&fcond->cond, NULL);
+	if (ret != 0) {
+		xi_mem_free(fcond);
+	}
 	switch (ret) {
 	case 0:
 		xi_strncpy(fcond->oname, cname, (XCFG_ONAME_MAX - 1));
-		(*cond) = (xi_thread_cond_t)idx;
+		fcond->oname[XCFG_ONAME_MAX - 1] = '\0';
+		xi_atomic_inc32(&_g_thr_conds);
+		(*cond) = (xi_thread_cond_t) fcond;
 		return XI_COND_RV_OK;
 	case EAGAIN:
 		return XI_COND_RV_ERR_NOMORE;
@@ -346,18 +315,13 @@ xi_thread_cond_re xi_thread_cond_create(xi_thread_cond_t *cond, xchar *cname) {
 xi_thread_cond_re xi_thread_cond_wait(xi_thread_cond_t *cond,
 		xi_thread_mutex_t *lock) {
 	xint32 ret;
-	xintptr cidx = (xintptr)(*cond);
-	xintptr lidx = (xintptr)(*lock);
-	xg_thread_cond_t *fcond = NULL;
-	xg_thread_mutex_t *flock = NULL;
+	xg_thread_cond_t *fcond = xg_tcond_get(cond);
+	xg_thread_mutex_t *flock = xg_tmutex_get(lock);
 
-	if (cidx > XCFG_COND_MAX || lidx > XCFG_MUTEX_MAX) {
-		return XI_MUTEX_RV_ERR_ARGS;
+	if (fcond == NULL || flock == NULL) {
+		return XI_COND_RV_ERR_ARGS;
 	}
 
-	fcond = &(_g_thr_conds.conds[cidx]);
-	flock = &(_g_thr_locks.locks[lidx]);
-
 	ret = pthread_cond_wait(&fcond->cond, &flock->lock);
 	switch (ret) {
 	case 0:
@@ -377,18 +341,13 @@ xi_thread_cond_re xi_thread_cond_timedwait(xi_thread_cond_t *cond,
 #endif
 	struct timespec ts;
 	xint32 ret;
-	xintptr cidx = (xintptr)(*cond);
-	xintptr lidx = (xintptr)(*lock);
-	xg_thread_cond_t *fcond = NULL;
-	xg_thread_mutex_t *flock = NULL;
+	xg_thread_cond_t *fcond = xg_tcond_get(cond);
+	xg_thread_mutex_t *flock = xg_tmutex_get(lock);
 
-	if (cidx > XCFG_COND_MAX || lidx > XCFG_MUTEX_MAX) {
-		return XI_MUTEX_RV_ERR_ARGS;
+	if (fcond == NULL || flock == NULL) {
+		return XI_COND_RV_ERR_ARGS;
 	}
 
-	fcond = &(_g_thr_conds.conds[cidx]);
-	flock = &(_g_thr_locks.locks[lidx]);
-
 #ifdef __APPLE__
 	ret = gettimeofday(&tv, NULL);
 #else
@@ -431,15 +390,12 @@ xi_thread_cond_re xi_thread_cond_timedwait(xi_thread_cond_t *cond,
 
 xi_thread_cond_re xi_thread_cond_broadcast(xi_thread_cond_t *cond) {
 	xint32 ret;
-	xintptr cidx = (xintptr)(*cond);
-	xg_thread_cond_t *fcond = NULL;
+	xg_thread_cond_t *fcond = xg_tcond_get(cond);
 
-	if (cidx > XCFG_COND_MAX) {
-		return XI_MUTEX_RV_ERR_ARGS;
+	if (fcond == NULL) {
+		return XI_COND_RV_ERR_ARGS;
 	}
 
-	fcond = &(_g_thr_conds.conds[cidx]);
-
 	ret = pthread_cond_broadcast(&fcond->cond);
 	switch (ret) {
 	case 0:
@@ -452,15 +408,12 @@ xi_thread_cond_re xi_thread_cond_broadcast(xi_thread_cond_t *cond) {
 
 xi_thread_cond_re xi_thread_cond_signal(xi_thread_cond_t *cond) {
 	xint32 ret;
-	xintptr cidx = (xintptr)(*cond);
-	xg_thread_cond_t *fcond = NULL;
+	xg_thread_cond_t *fcond = xg_tcond_get(cond);
 
-	if (cidx > XCFG_COND_MAX) {
-		return XI_MUTEX_RV_ERR_ARGS;
+	if (fcond == NULL) {
+		return XI_COND_RV_ERR_ARGS;
 	}
 
-	fcond = &(_g_thr_conds.conds[cidx]);
-
 	ret = pthread_cond_signal(&fcond->cond);
 	switch (ret) {
 	case 0:
@@ -473,19 +426,18 @@ xi_thread_cond_re xi_thread_cond_signal(xi_thread_cond_t *cond) {
 
 xi_thread_cond_re xi_thread_cond_destroy(xi_thread_cond_t *cond) {
 	xint32 ret;
-	xintptr cidx = (xintptr)(*cond);
-	xg_thread_cond_t *fcond = NULL;
+	xg_thread_cond_t *fcond = xg_tcond_get(cond);
 
-	if (cidx > XCFG_COND_MAX) {
-		return XI_MUTEX_RV_ERR_ARGS;
+	if (fcond == NULL) {
+		return XI_COND_RV_ERR_ARGS;
 	}
 
-	fcond = &(_g_thr_conds.conds[cidx]);
-
 	ret = pthread_cond_destroy(&(fcond->cond));
 	switch (ret) {
 	case 0:
-		xg_tcond_free(cidx);
+		xi_mem_free(fcond);
+		xi_atomic_sub32(&_g_thr_conds, 1);
+		(*cond) = (xi_thread_cond_t)-1;
 		return XI_COND_RV_OK;
 	case EBUSY:
 		return XI_COND_RV_ERR_BUSY;
@@ -494,3 +446,194 @@ xi_thread_cond_re xi_thread_cond_destroy(xi_thread_cond_t *cond) {
 		return XI_COND_RV_ERR_ARGS;
 	}
 }
+
+//------------
+// RWLock
+//------------
+
+xi_thread_rwlock_re xi_thread_rwlock_create(xi_thread_rwlock_t *rwlock, xchar *rname) {
+	xint32 ret;
+	xg_thread_rwlock_t *frw;
+
+	(*rwlock) = (xi_thread_rwlock_t)-1;
+
+	frw = xi_mem_alloc(sizeof(xg_thread_rwlock_t));
+	if (frw == NULL) {
+		log_error(XDLOG, "Cannot create rwlock : [%s]!!!\n", rname);
+		return XI_RWLOCK_RV_ERR_NOMEM;
+	}
+
+	ret = pthread_rwlock_init(&frw->lock, NULL);
+	if (ret != 0) {
+		xi_mem_free(frw);
+		return xg_trwlock_rv(ret);
+	}
+
+	xi_strncpy(frw->oname, rname, (XCFG_ONAME_MAX - 1));
+	frw->oname[XCFG_ONAME_MAX - 1] = '\0';
+	(*rwlock) = (xi_thread_rwlock_t) frw;
+	return XI_RWLOCK_RV_OK;
+}
+
+xi_thread_rwlock_re xi_thread_rwlock_rdlock(xi_thread_rwlock_t *rwlock) {
+	xg_thread_rwlock_t *frw = xg_trwlock_get(rwlock);
+
+	if (frw == NULL) {
+		return XI_RWLOCK_RV_ERR_ARGS;
+	}
+	return xg_trwlock_rv(pthread_rwlock_rdlock(&frw->lock));
+}
+
+xi_thread_rwlock_re xi_thread_rwlock_tryrdlock(xi_thread_rwlock_t *rwlock) {
+	xg_thread_rwlock_t *frw = xg_trwlock_get(rwlock);
+
+	if (frw == NULL) {
+		return XI_RWLOCK_RV_ERR_ARGS;
+	}
+	return xg_trwlock_rv(pthread_rwlock_tryrdlock(&frw->lock));
+}
+
+xi_thread_rwlock_re xi_thread_rwlock_wrlock(xi_thread_rwlock_t *rwlock) {
+	xg_thread_rwlock_t *frw = xg_trwlock_get(rwlock);
+
+	if (frw == NULL) {
+		return XI_RWLOCK_RV_ERR_ARGS;
+	}
+	return xg_trwlock_rv(pthread_rwlock_wrlock(&frw->lock));
+}
+
+xi_thread_rwlock_re xi_thread_rwlock_trywrlock(xi_thread_rwlock_t *rwlock) {
+	xg_thread_rwlock_t *frw = xg_trwlock_get(rwlock);
+
+	if (frw == NULL) {
+		return XI_RWLOCK_RV_ERR_ARGS;
+	}
+	return xg_trwlock_rv(pthread_rwlock_trywrlock(&frw->lock));
+}
+
+xi_thread_rwlock_re xi_thread_rwlock_unlock(xi_thread_rwlock_t *rwlock) {
+	xg_thread_rwlock_t *frw = xg_trwlock_get(rwlock);
+
+	if (frw == NULL) {
+		return XI_RWLOCK_RV_ERR_ARGS;
+	}
+	return xg_trwlock_rv(pthread_rwlock_unlock(&frw->lock));
+}
+
+xi_thread_rwlock_re xi_thread_rwlock_destroy(xi_thread_rwlock_t *rwlock) {
+	xint32 ret;
+	xg_thread_rwlock_t *frw = xg_trwlock_get(rwlock);
+
+	if (frw == NULL) {
+		return XI_RWLOCK_RV_ERR_ARGS;
+	}
+
+	ret = pthread_rwlock_destroy(&frw->lock);
+	if (ret != 0) {
+		return xg_trwlock_rv(ret);
+	}
+
+	xi_mem_free(frw);
+	(*rwlock) = (xi_thread_rwlock_t)-1;
+	return XI_RWLOCK_RV_OK;
+}
+
+//------------
+// SeqLock
+//------------
+
+xi_thread_seqlock_re xi_thread_seqlock_create(xi_thread_seqlock_t *seqlock, xchar *sname) {
+	xg_thread_seqlock_t *fseq;
+
+	(*seqlock) = (xi_thread_seqlock_t)-1;
+
+	fseq = xi_mem_alloc(sizeof(xg_thread_seqlock_t));
+	if (fseq == NULL) {
+		log_error(XDLOG, "Cannot create seqlock : [%s]!!!\n", sname);
+		return XI_SEQLOCK_RV_ERR_NOMEM;
+	}
+
+	if (pthread_mutex_init(&fseq->wlock, NULL) != 0) {
+		xi_mem_free(fseq);
+		return XI_SEQLOCK_RV_ERR_NOMEM;
+	}
+
+	fseq->seq = 0;
+	xi_strncpy(fseq->oname, sname, (XCFG_ONAME_MAX - 1));
+	fseq->oname[XCFG_ONAME_MAX - 1] = '\0';
+	(*seqlock) = (xi_thread_seqlock_t) fseq;
+	return XI_SEQLOCK_RV_OK;
+}
+
+xi_thread_seqlock_re xi_thread_seqlock_lock(xi_thread_seqlock_t *seqlock) {
+	xg_thread_seqlock_t *fseq = xg_tseqlock_get(seqlock);
+
+	if (fseq == NULL) {
+		return XI_SEQLOCK_RV_ERR_ARGS;
+	}
+
+	pthread_mutex_lock(&fseq->wlock);
+	xi_atomic_store32_explicit(&fseq->seq, fseq->seq + 1, XI_ATOMIC_RELAXED);
+	xi_atomic_fence(XI_ATOMIC_RELEASE); // the odd sequence is visible before the data
+	return XI_SEQLOCK_RV_OK;
+}
+
+xi_thread_seqlock_re xi_thread_seqlock_unlock(xi_thread_seqlock_t *seqlock) {
+	xg_thread_seqlock_t *fseq = xg_tseqlock_get(seqlock);
+
+	if (fseq == NULL) {
+		return XI_SEQLOCK_RV_ERR_ARGS;
+	}
+
+	// the data is visible before the even sequence
+	xi_atomic_store32_explicit(&fseq->seq, fseq->seq + 1, XI_ATOMIC_RELEASE);
+	pthread_mutex_unlock(&fseq->wlock);
+	return XI_SEQLOCK_RV_OK;
+}
+
+xuint32 xi_thread_seqlock_read_begin(xi_thread_seqlock_t *seqlock) {
+	xuint32 seq;
+	xint32 spin = 0;
+	xg_thread_seqlock_t *fseq = xg_tseqlock_get(seqlock);
+
+	if (fseq == NULL) {
+		return 0;
+	}
+
+	// the sequence is read before the data
+	for (;;) {
+		seq = xi_atomic_load32_explicit(&fseq->seq, XI_ATOMIC_ACQUIRE);
+		if ((seq & 1) == 0) {
+			break;
+		}
+		if (++spin >= XG_SEQLOCK_SPIN) {
+			sched_yield();
+			spin = 0;
+		}
+	}
+	return seq;
+}
+
+xbool xi_thread_seqlock_read_retry(xi_thread_seqlock_t *seqlock, xuint32 seq) {
+	xg_thread_seqlock_t *fseq = xg_tseqlock_get(seqlock);
+
+	if (fseq == NULL) {
+		return FALSE;
+	}
+
+	xi_atomic_fence(XI_ATOMIC_ACQUIRE); // the data is read before the sequence
+	return (xi_atomic_load32_explicit(&fseq->seq, XI_ATOMIC_RELAXED) != seq);
+}
+
+xi_thread_seqlock_re xi_thread_seqlock_destroy(xi_thread_seqlock_t *seqlock) {
+	xg_thread_seqlock_t *fseq = xg_tseqlock_get(seqlock);
+
+	if (fseq == NULL) {
+		return XI_SEQLOCK_RV_ERR_ARGS;
+	}
+
+	pthread_mutex_destroy(&fseq->wlock);
+	xi_mem_free(fseq);
+	(*seqlock) = (xi_thread_seqlock_t)-1;
+	return XI_SEQLOCK_RV_OK;
+}
@@ -0,0 +1,389 @@
+/*
+ * Copyright 2013 Cheolmin Jo (webos21@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * File   : xg_aio.c
+ */
+
+#include "xg_fd.h"
+
+#include "xi/xi_aio.h"
+#include "xi/xi_log.h"
+#include "xi/xi_mem.h"
+#include "xi/xi_string.h"
+#include "xi/xi_thread.h"
+
+// ----------------------------------------------
+// Inner Structure
+// ----------------------------------------------
+
+#define XG_AIO_THREADS_DEF   4
+
+/*
+ * Win32 has the worker threads only.
+ */
+struct _xi_aio {
+	xint32 backend;
+	xint32 depth;
+	xint32 inflight;           // owner thread only
+	xint32 efd;                // loopback UDP socket connected to itself
+	xi_thread_mutex_t lock;
+	xi_thread_cond_t cond;
+	xi_aio_req_t *qhead;       // guarded by lock
+	xi_aio_req_t *qtail;       // guarded by lock
+	xi_aio_req_t *dhead;       // guarded by lock
+	xi_aio_req_t *dtail;       // guarded by lock
+	xbool signaled;            // guarded by lock
+	xbool running;             // guarded by lock
+	xint32 alive;              // guarded by lock
+};
+
+// ----------------------------------------------
+// Inner Functions
+// ----------------------------------------------
+
+/*
+ * The completion descriptor is a socket, because select() takes sockets only.
+ */
+static xint32 xg_aio_notify_open() {
+	xint32 sock;
+	xi_sock_addr_t addr = { XI_SOCK_FAMILY_INET, XI_SOCK_TYPE_DATAGRAM,
+			XI_SOCK_PROTO_UDP, { '\0' }, 0 };
+
+	sock = xi_socket_open(addr.family, addr.type, addr.proto);
+	if (sock < 0) {
+		return -1;
+	}
+
+	xi_strcpy(addr.host, "127.0.0.1");
+	if (xi_socket_bind(sock, addr) != XI_SOCK_RV_OK
+			|| xi_socket_get_local(sock, &addr) != XI_SOCK_RV_OK
+			|| xi_socket_connect(sock, addr) != XI_SOCK_RV_OK
+			|| xi_socket_opt_set(sock, XI_SOCK_OPT_NONBLOCK, TRUE) != XI_SOCK_RV_OK) {
+		xi_socket_close(sock);
+		return -1;
+	}
+
+	return sock;
+}
+
+static xvoid xg_aio_notify(xi_aio_t *aio) {
+	xchar one = 1;
+	// a full buffer means that the owner is already signaled
+	xi_socket_send(aio->efd, &one, sizeof(one));
+}
+
+static xvoid xg_aio_notify_drain(xi_aio_t *aio) {
+	xchar buf[64];
+	while (xi_socket_recv(aio->efd, buf, sizeof(buf)) > 0) {
+		// consume all
+	}
+}
+
+static xint32 xg_aio_notify_wait(xi_aio_t *aio, xint32 msecs) {
+	fd_set rset;
+	struct timeval tv;
+
+	FD_ZERO(&rset);
+	FD_SET(xg_fd_get(aio->efd)->desc.s.fd, &rset);
+	tv.tv_sec = msecs / 1000;
+	tv.tv_usec = (msecs % 1000) * 1000;
+
+	return (select(0, &rset, NULL, NULL, (msecs < 0) ? NULL : &tv) > 0) ? 0 : -1;
+}
+
+static xssize xg_aio_err_sock(xssize rv) {
+	switch (rv) {
+	case XI_SOCK_RV_ERR_TRYLATER:
+		return XI_AIO_RV_ERR_TRYLATER;
+	case XI_SOCK_RV_ERR_FD:
+	case XI_SOCK_RV_ERR_NOTSOCK:
+		return XI_AIO_RV_ERR_FD;
+	case XI_SOCK_RV_ERR_INTR:
+		return XI_AIO_RV_ERR_CANCELED;
+	default:
+		return XI_AIO_RV_ERR_OP;
+	}
+}
+
+static xssize xg_aio_do(xi_aio_req_t *req) {
+	xssize rv = XI_AIO_RV_ERR_ARGS;
+
+	switch (req->op) {
+	case XI_AIO_OP_READ:
+		rv = (req->off < 0) ? xi_file_read(req->fd, req->buf, req->len)
+				: xi_file_pread(req->fd, req->buf, req->len, req->off);
+		return (rv < 0) ? XI_AIO_RV_ERR_OP : rv;
+	case XI_AIO_OP_WRITE:
+		rv = (req->off < 0) ? xi_file_write(req->fd, req->buf, req->len)
+				: xi_file_pwrite(req->fd, req->buf, req->len, req->off);
+		return (rv < 0) ? XI_AIO_RV_ERR_OP : rv;
+	case XI_AIO_OP_RECV:
+		rv = xi_socket_recv(req->fd, req->buf, req->len);
+		break;
+	case XI_AIO_OP_SEND:
+		rv = xi_socket_send(req->fd, req->buf, req->len);
+		break;
+	case XI_AIO_OP_ACCEPT:
+		rv = xi_socket_accept4(req->fd, NULL, req->flags);
+		break;
+	case XI_AIO_OP_FSYNC:
+		// no fdatasync on win32
+		return (xi_file_sync(req->fd) == XI_FILE_RV_OK) ? 0 : XI_AIO_RV_ERR_OP;
+	}
+
+	return (rv < 0) ? xg_aio_err_sock(rv) : rv;
+}
+
+static xvoid *xg_aio_worker(xvoid *arg) {
+	xi_aio_t *aio = arg;
+	xi_aio_req_t *req;
+
+	xi_thread_mutex_lock(&aio->lock);
+	for (;;) {
+		while (aio->qhead == NULL && aio->running) {
+			xi_thread_cond_wait(&aio->cond, &aio->lock);
+		}
+		if (aio->qhead == NULL) {
+			break;
+		}
+		req = aio->qhead;
+		aio->qhead = req->next;
+		if (aio->qhead == NULL) {
+			aio->qtail = NULL;
+		}
+		xi_thread_mutex_unlock(&aio->lock);
+
+		req->res = xg_aio_do(req);
+		req->next = NULL;
+
+		xi_thread_mutex_lock(&aio->lock);
+		if (aio->dtail == NULL) {
+			aio->dhead = req;
+		} else {
+			aio->dtail->next = req;
+		}
+		aio->dtail = req;
+		// one signal is enough until the owner takes the list
+		if (!aio->signaled) {
+			aio->signaled = TRUE;
+			xg_aio_notify(aio);
+		}
+	}
+	aio->alive--;
+	xi_thread_cond_broadcast(&aio->cond);
+	xi_thread_mutex_unlock(&aio->lock);
+
+	return NULL;
+}
+
+static xvoid xg_aio_stop(xi_aio_t *aio) {
+	xi_thread_mutex_lock(&aio->lock);
+	aio->running = FALSE;
+	xi_thread_cond_broadcast(&aio->cond);
+	while (aio->alive > 0) {
+		xi_thread_cond_wait(&aio->cond, &aio->lock);
+	}
+	xi_thread_mutex_unlock(&aio->lock);
+}
+
+// ----------------------------------------------
+// XI Functions
+// ----------------------------------------------
+
+xi_aio_t *xi_aio_create(xuint32 depth, xuint32 nthreads, xint32 opt) {
+	xuint32 i;
+	xi_aio_t *aio;
+	xi_thread_t tid;
+
+	UNUSED(opt);
+
+	if (depth == 0 || depth > 0x7FFFFFFF) {
+		return NULL;
+	}
+
+	aio = xi_mem_calloc(1, sizeof(xi_aio_t));
+	if (aio == NULL) {
+		return NULL;
+	}
+	aio->backend = XI_AIO_BACKEND_THREADS;
+	aio->depth = (xint32) depth;
+
+	aio->efd = xg_aio_notify_open();
+	if (aio->efd < 0) {
+		xi_mem_free(aio);
+		return NULL;
+	}
+	if (xi_thread_mutex_create(&aio->lock, "xg_aio") != XI_MUTEX_RV_OK) {
+		xi_socket_close(aio->efd);
+		xi_mem_free(aio);
+		return NULL;
+	}
+	if (xi_thread_cond_create(&aio->cond, "xg_aio") != XI_COND_RV_OK) {
+		xi_thread_mutex_destroy(&aio->lock);
+		xi_socket_close(aio->efd);
+		xi_mem_free(aio);
+		return NULL;
+	}
+
+	if (nthreads == 0) {
+		nthreads = XG_AIO_THREADS_DEF;
+	}
+	aio->running = TRUE;
+	for (i = 0; i < nthreads; i++) {
+		xi_thread_mutex_lock(&aio->lock);
+		aio->alive++;
+		xi_thread_mutex_unlock(&aio->lock);
+		if (xi_thread_create(&tid, "xg_aio", xg_aio_worker, aio, 256 * 1024,
+				XCFG_THREAD_PRIOR_NORM) != XI_THREAD_RV_OK) {
+			xi_thread_mutex_lock(&aio->lock);
+			aio->alive--;
+			xi_thread_mutex_unlock(&aio->lock);
+			break;
+		}
+	}
+	if (i == 0) {
+		xi_aio_destroy(aio);
+		return NULL;
+	}
+
+	return aio;
+}
+
+xint32 xi_aio_backend(xi_aio_t *aio) {
+	if (aio == NULL) {
+		return XI_AIO_RV_ERR_ARGS;
+	}
+	return aio->backend;
+}
+
+xint32 xi_aio_fd(xi_aio_t *aio) {
+	if (aio == NULL) {
+		return XI_AIO_RV_ERR_ARGS;
+	}
+	return aio->efd;
+}
+
+xint32 xi_aio_submit(xi_aio_t *aio, xi_aio_req_t **reqs, xint32 nreqs) {
+	xint32 i;
+
+	if (aio == NULL || reqs == NULL || nreqs <= 0) {
+		return XI_AIO_RV_ERR_ARGS;
+	}
+
+	// submit up to the first bad one
+	for (i = 0; i < nreqs; i++) {
+		if (reqs[i] == NULL || reqs[i]->fd < 0
+				|| reqs[i]->op < XI_AIO_OP_READ || reqs[i]->op > XI_AIO_OP_FSYNC) {
+			break;
+		}
+	}
+	if (i == 0) {
+		return XI_AIO_RV_ERR_ARGS;
+	}
+	nreqs = i;
+
+	if (aio->inflight >= aio->depth) {
+		return XI_AIO_RV_ERR_FULL;
+	}
+	if (nreqs > aio->depth - aio->inflight) {
+		nreqs = aio->depth - aio->inflight;
+	}
+
+	xi_thread_mutex_lock(&aio->lock);
+	for (i = 0; i < nreqs; i++) {
+		reqs[i]->next = NULL;
+		if (aio->qtail == NULL) {
+			aio->qhead = reqs[i];
+		} else {
+			aio->qtail->next = reqs[i];
+		}
+		aio->qtail = reqs[i];
+	}
+	if (nreqs == 1) {
+		xi_thread_cond_signal(&aio->cond);
+	} else {
+		xi_thread_cond_broadcast(&aio->cond);
+	}
+	xi_thread_mutex_unlock(&aio->lock);
+
+	aio->inflight += nreqs;
+	return nreqs;
+}
+
+xint32 xi_aio_complete(xi_aio_t *aio, xint32 msecs) {
+	xi_aio_req_t *req, *next;
+	xint32 n;
+
+	if (aio == NULL) {
+		return XI_AIO_RV_ERR_ARGS;
+	}
+
+	for (;;) {
+		xi_thread_mutex_lock(&aio->lock);
+		req = aio->dhead;
+		aio->dhead = NULL;
+		aio->dtail = NULL;
+		aio->signaled = FALSE;
+		xg_aio_notify_drain(aio);
+		xi_thread_mutex_unlock(&aio->lock);
+
+		for (n = 0; req != NULL; req = next) {
+			next = req->next;
+			aio->inflight--;
+			n++;
+			if (req->func != NULL) {
+				req->func(aio, req);
+			}
+		}
+		if (n > 0) {
+			return n;
+		}
+		if (msecs == 0 || xg_aio_notify_wait(aio, msecs) < 0) {
+			return XI_AIO_RV_ERR_TIMEOUT;
+		}
+		// a positive time is waited once only
+		if (msecs > 0) {
+			msecs = 0;
+		}
+	}
+}
+
+xint32 xi_aio_pending(xi_aio_t *aio) {
+	if (aio == NULL) {
+		return XI_AIO_RV_ERR_ARGS;
+	}
+	return aio->inflight;
+}
+
+xi_aio_re xi_aio_destroy(xi_aio_t *aio) {
+	if (aio == NULL) {
+		return XI_AIO_RV_ERR_ARGS;
+	}
+
+	if (aio->inflight > 0) {
+		log_error(XDLOG, "%d requests are still in flight\n", aio->inflight);
+	}
+
+	xg_aio_stop(aio);
+
+	xi_thread_cond_destroy(&aio->cond);
+	xi_thread_mutex_destroy(&aio->lock);
+	xi_socket_close(aio->efd);
+	xi_mem_free(aio);
+
+	return XI_AIO_RV_OK;
+}
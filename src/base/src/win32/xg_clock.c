@@ -19,6 +19,7 @@
  */
 
 #include <windows.h>
+#include <intrin.h>
 
 #include <errno.h>
 #include <time.h>
@@ -35,12 +36,20 @@
 #define LEAPYEAR(year)  (!((year) % 4) && (((year) % 100) || !((year) % 400))) 
 #define YEARSIZE(year)  (LEAPYEAR(year) ? 366 : 365) 
 
+#define XG_CYCLES_UNKNOWN  0  // not probed yet
+#define XG_CYCLES_CPU      1  // the counter of the CPU
+#define XG_CYCLES_NTICK    2  // xi_clock_ntick
+
 // ----------------------------------------------
 // Global Variables
 // ----------------------------------------------
 
 static LARGE_INTEGER _g_frequency;
 
+static volatile xint32 _g_cycles_src = XG_CYCLES_UNKNOWN;
+static volatile xuint64 _g_cycles_hz = 0;
+static volatile double _g_cycles_nspc = 1.0; // nanoseconds per cycle
+
 static xint32 _g_clock_tzhour = 0;
 static xlong _g_clock_gsdiff = 0;
 
@@ -178,6 +187,22 @@ static xlong xg_mktime(register xi_time_t *stt) {
 	return (xint32) seconds;
 }
 
+static xint32 xg_cycles_probe() {
+#if defined(_M_IX86) || defined(_M_X64)
+	int regs[4];
+
+	// the invariant TSC ticks at a constant rate across P/C-states
+	__cpuid(regs, 0x80000000);
+	if ((unsigned int) regs[0] >= 0x80000007) {
+		__cpuid(regs, 0x80000007);
+		if (regs[3] & (1 << 8)) {
+			return XG_CYCLES_CPU;
+		}
+	}
+#endif
+	return XG_CYCLES_NTICK;
+}
+
 // ----------------------------------------------
 // XI Functions
 // ----------------------------------------------
@@ -201,6 +226,7 @@ xint64 xi_clock_ntick() {
 
 	if (!init) {
 		QueryPerformanceFrequency(&_g_frequency);
+		init = TRUE;
 	}
 
 	if (QueryPerformanceCounter(&count)) {
@@ -210,6 +236,67 @@ xint64 xi_clock_ntick() {
 	}
 }
 
+xint64 xi_clock_ntick_coarse() {
+#if (_WIN32_WINNT >= 0x0600)
+	return (xint64) GetTickCount64() * 1000000LL;
+#else
+	return (xint64) GetTickCount() * 1000000LL;
+#endif
+}
+
+xuint64 xi_clock_cycles() {
+#if defined(_M_IX86) || defined(_M_X64)
+	if (_g_cycles_src == XG_CYCLES_CPU) {
+		return __rdtsc();
+	}
+#endif
+	if (_g_cycles_src == XG_CYCLES_UNKNOWN) {
+		_g_cycles_src = xg_cycles_probe();
+		return xi_clock_cycles();
+	}
+	return (xuint64) xi_clock_ntick();
+}
+
+xuint64 xi_clock_cycles_hz() {
+	xuint64 hz;
+
+	if (_g_cycles_hz != 0) {
+		return _g_cycles_hz;
+	}
+
+	if (_g_cycles_src == XG_CYCLES_UNKNOWN) {
+		_g_cycles_src = xg_cycles_probe();
+	}
+
+	if (_g_cycles_src != XG_CYCLES_CPU) {
+		hz = 1000000000ULL;
+	} else {
+		xint64 n0, n1;
+		xuint64 c0, c1;
+
+		n0 = xi_clock_ntick();
+		c0 = xi_clock_cycles();
+		Sleep(10);
+		n1 = xi_clock_ntick();
+		c1 = xi_clock_cycles();
+
+		hz = (xuint64) ((double) (xint64) (c1 - c0) * 1E9 / (double) (n1 - n0));
+	}
+
+	// the rate first, and then the flag of the calibration
+	_g_cycles_nspc = 1E9 / (double) hz;
+	_g_cycles_hz = hz;
+
+	return hz;
+}
+
+xint64 xi_clock_cycles2nsec(xuint64 cycles) {
+	if (_g_cycles_hz == 0) {
+		xi_clock_cycles_hz();
+	}
+	return (xint64) ((double) (xint64) cycles * _g_cycles_nspc);
+}
+
 xint32 xi_clock_get_tz() {
 	return _g_clock_tzhour;
 }
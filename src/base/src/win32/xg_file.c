@@ -30,6 +30,12 @@
 #include <direct.h>
 #include <io.h>
 
+// ----------------------------------------------
+// Definitions
+// ----------------------------------------------
+
+#define XG_FILE_XFER_CHUNK   (64 * 1024)  // buffer unit of xi_file_splice
+
 // ----------------------------------------------
 // Inner Structure
 // ----------------------------------------------
@@ -79,6 +85,10 @@ xint32 xi_file_open(const xchar *pathname, xint32 mode, xint32 perm) {
 	if ((mode & XI_FILE_MODE_EXCL) && !(mode & XI_FILE_MODE_CREATE)) {
 		return XI_FILE_RV_ERR_ARGS;
 	}
+	if (mode & XI_FILE_MODE_DIRECT) {
+		// the buffers should come from xi_file_direct_alloc
+		attributes |= FILE_FLAG_NO_BUFFERING | FILE_FLAG_WRITE_THROUGH;
+	}
 
 	pfd.desc.f.fd = CreateFile(pathname, oflags, sharemode, NULL, createflags,
 			attributes, 0);
@@ -198,14 +208,14 @@ xssize xi_file_readv(xint32 fd, const xi_file_iovec_t *iov, xint32 iovlen) {
 
 	while (i < iovlen) {
 		if (fdesc->type == XG_FD_TYPE_FILE || fdesc->type == XG_FD_TYPE_PIPE) {
-			ret = ReadFile(fdesc->desc.f.fd, iov[i].iov_base, iov[i].iov_len,
+			ret = ReadFile(fdesc->desc.f.fd, iov[i].iov_base, (DWORD) iov[i].iov_len,
 					&rbytes, NULL);
 			if (!ret) {
 				break;
 			}
 		} else if (fdesc->type == XG_FD_TYPE_SOCK) {
 			rbytes = recv(fdesc->desc.s.fd, (xchar *)iov[i].iov_base,
-					iov[i].iov_len, 0);
+					(xint32) iov[i].iov_len, 0);
 			if ((xint32)rbytes == SOCKET_ERROR) {
 				break;
 			}
@@ -235,14 +245,14 @@ xssize xi_file_writev(xint32 fd, const xi_file_iovec_t *iov, xint32 iovlen) {
 
 	while (i < iovlen) {
 		if (fdesc->type == XG_FD_TYPE_FILE || fdesc->type == XG_FD_TYPE_PIPE) {
-			ret = WriteFile(fdesc->desc.f.fd, iov[i].iov_base, iov[i].iov_len,
+			ret = WriteFile(fdesc->desc.f.fd, iov[i].iov_base, (DWORD) iov[i].iov_len,
 					&wbytes, NULL);
 			if (!ret) {
 				break;
 			}
 		} else if (fdesc->type == XG_FD_TYPE_SOCK) {
 			wbytes = send(fdesc->desc.s.fd, (xchar *)iov[i].iov_base,
-					iov[i].iov_len, 0);
+					(xint32) iov[i].iov_len, 0);
 			if ((xint32)wbytes == SOCKET_ERROR) {
 				break;
 			}
@@ -254,6 +264,127 @@ xssize xi_file_writev(xint32 fd, const xi_file_iovec_t *iov, xint32 iovlen) {
 	return totalWrite;
 }
 
+xssize xi_file_pread(xint32 fd, xvoid *buf, xsize buflen, xoff64 off) {
+	BOOL ret;
+	DWORD rbytes = 0;
+	OVERLAPPED ov;
+	xg_fd_t *fdesc;
+
+	if (fd < 0 || buf == NULL || off < 0) {
+		return XI_FILE_RV_ERR_ARGS;
+	}
+
+	fdesc = xg_fd_get(fd);
+	if (fdesc == NULL || fdesc->type != XG_FD_TYPE_FILE) {
+		return XI_FILE_RV_ERR_FD;
+	}
+
+	// the offset of a synchronous handle is given by OVERLAPPED
+	xi_mem_set(&ov, 0, sizeof(ov));
+	ov.Offset = (DWORD) (off & 0xFFFFFFFF);
+	ov.OffsetHigh = (DWORD) (off >> 32);
+
+	ret = ReadFile(fdesc->desc.f.fd, buf, (DWORD) buflen, &rbytes, &ov);
+	if (!ret) {
+		return (GetLastError() == ERROR_HANDLE_EOF) ? 0 : XI_FILE_RV_ERR_IO;
+	}
+
+	return rbytes;
+}
+
+xssize xi_file_pwrite(xint32 fd, const xvoid *buf, xsize buflen, xoff64 off) {
+	BOOL ret;
+	DWORD wbytes = 0;
+	OVERLAPPED ov;
+	xg_fd_t *fdesc;
+
+	if (fd < 0 || buf == NULL || off < 0) {
+		return XI_FILE_RV_ERR_ARGS;
+	}
+
+	fdesc = xg_fd_get(fd);
+	if (fdesc == NULL || fdesc->type != XG_FD_TYPE_FILE) {
+		return XI_FILE_RV_ERR_FD;
+	}
+
+	xi_mem_set(&ov, 0, sizeof(ov));
+	ov.Offset = (DWORD) (off & 0xFFFFFFFF);
+	ov.OffsetHigh = (DWORD) (off >> 32);
+
+	ret = WriteFile(fdesc->desc.f.fd, buf, (DWORD) buflen, &wbytes, &ov);
+	if (!ret) {
+		return XI_FILE_RV_ERR_IO;
+	}
+
+	return wbytes;
+}
+
+xssize xi_file_preadv(xint32 fd, const xi_file_iovec_t *iov, xint32 iovlen,
+		xoff64 off) {
+	xint32 i;
+	xssize rn, ret = 0;
+
+	if (fd < 0 || iov == NULL || iovlen < 0 || off < 0) {
+		return XI_FILE_RV_ERR_ARGS;
+	}
+
+	// one by one, until a short read
+	for (i = 0; i < iovlen; i++) {
+		rn = xi_file_pread(fd, iov[i].iov_base, (DWORD) iov[i].iov_len, off + ret);
+		if (rn < 0) {
+			return (ret > 0) ? ret : rn;
+		}
+		ret += rn;
+		if ((xsize) rn < iov[i].iov_len) {
+			break;
+		}
+	}
+
+	return ret;
+}
+
+xssize xi_file_pwritev(xint32 fd, const xi_file_iovec_t *iov, xint32 iovlen,
+		xoff64 off) {
+	xint32 i;
+	xssize wn, ret = 0;
+
+	if (fd < 0 || iov == NULL || iovlen < 0 || off < 0) {
+		return XI_FILE_RV_ERR_ARGS;
+	}
+
+	for (i = 0; i < iovlen; i++) {
+		wn = xi_file_pwrite(fd, iov[i].iov_base, (DWORD) iov[i].iov_len, off + ret);
+		if (wn < 0) {
+			return (ret > 0) ? ret : wn;
+		}
+		ret += wn;
+		if ((xsize) wn < iov[i].iov_len) {
+			break;
+		}
+	}
+
+	return ret;
+}
+
+xi_file_re xi_file_advise(xint32 fd, xoff64 off, xoff64 len, xint32 advice) {
+	if (fd < 0 || off < 0 || len < 0) {
+		return XI_FILE_RV_ERR_ARGS;
+	}
+
+	// win32 takes the pattern at open only (FILE_FLAG_SEQUENTIAL_SCAN)
+	switch (advice) {
+	case XI_FILE_ADVICE_NORMAL:
+		return XI_FILE_RV_OK;
+	case XI_FILE_ADVICE_SEQUENTIAL:
+	case XI_FILE_ADVICE_RANDOM:
+	case XI_FILE_ADVICE_WILLNEED:
+	case XI_FILE_ADVICE_DONTNEED:
+		return XI_FILE_RV_ERR_NS;
+	default:
+		return XI_FILE_RV_ERR_ARGS;
+	}
+}
+
 xint64 xi_file_seek(xint32 fd, xint64 pos, xint32 whence) {
 	LARGE_INTEGER ret;
 
@@ -389,6 +520,32 @@ xi_file_re xi_file_sync(xint32 fd) {
 	return XI_FILE_RV_OK;
 }
 
+xsize xi_file_direct_align() {
+	static xsize align = 0;
+
+	if (align == 0) {
+		SYSTEM_INFO si;
+		// FILE_FLAG_NO_BUFFERING needs the sector size, which the page size covers
+		GetSystemInfo(&si);
+		align = si.dwPageSize;
+	}
+	return align;
+}
+
+xvoid *xi_file_direct_alloc(xsize size) {
+	if (size == 0) {
+		return NULL;
+	}
+	// VirtualAlloc gives the pages, aligned by the page size
+	return VirtualAlloc(NULL, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+}
+
+xvoid xi_file_direct_free(xvoid *buf) {
+	if (buf != NULL) {
+		VirtualFree(buf, 0, MEM_RELEASE);
+	}
+}
+
 xi_file_re xi_file_pipe(xint32 fd[2]) {
 	HANDLE hr = NULL;
 	HANDLE hw = NULL;
@@ -425,6 +582,100 @@ xi_file_re xi_file_pipe(xint32 fd[2]) {
 	return XI_FILE_RV_OK;
 }
 
+xssize xi_file_splice(xint32 infd, xoff64 *inoff, xint32 outfd,
+		xoff64 *outoff, xsize count, xint32 flags) {
+	xchar *buf;
+	xg_fd_t *idesc;
+	xg_fd_t *odesc;
+	xoff64 ipos = 0, opos = 0;
+	xsize want;
+	xssize rn, wn, ret, done = 0;
+
+	UNUSED(flags);
+
+	if (infd < 0 || outfd < 0) {
+		return XI_FILE_RV_ERR_ARGS;
+	}
+
+	if (count == 0) {
+		return 0;
+	}
+
+	// no splice here : copy through a buffer
+	idesc = xg_fd_get(infd);
+	odesc = xg_fd_get(outfd);
+	if (idesc->type != XG_FD_TYPE_FILE) {
+		inoff = NULL;
+	}
+	if (odesc->type != XG_FD_TYPE_FILE) {
+		outoff = NULL;
+	}
+
+	buf = xi_mem_alloc(XG_FILE_XFER_CHUNK);
+	if (buf == NULL) {
+		return XI_FILE_RV_ERR_NOMEM;
+	}
+
+	// the positional transfer keeps the file positions
+	if (inoff != NULL) {
+		ipos = xi_file_seek(infd, 0, XI_FILE_SEEK_CUR);
+		xi_file_seek(infd, *inoff, XI_FILE_SEEK_SET);
+	}
+	if (outoff != NULL) {
+		opos = xi_file_seek(outfd, 0, XI_FILE_SEEK_CUR);
+		xi_file_seek(outfd, *outoff, XI_FILE_SEEK_SET);
+	}
+
+	while ((xsize) done < count) {
+		want = count - (xsize) done;
+		if (want > XG_FILE_XFER_CHUNK) {
+			want = XG_FILE_XFER_CHUNK;
+		}
+		rn = xi_file_read(infd, buf, want);
+		if (rn <= 0) {
+			if (rn < 0 && done == 0) {
+				done = rn;
+			}
+			break;
+		}
+		for (wn = 0; wn < rn; wn += ret) {
+			ret = xi_file_write(outfd, buf + wn, rn - wn);
+			if (ret <= 0) {
+				break;
+			}
+		}
+		done += wn;
+		if (wn < rn || idesc->type != XG_FD_TYPE_FILE || (xsize) rn < want) {
+			break;
+		}
+	}
+
+	if (inoff != NULL) {
+		*inoff += (done > 0) ? done : 0;
+		xi_file_seek(infd, ipos, XI_FILE_SEEK_SET);
+	}
+	if (outoff != NULL) {
+		*outoff += (done > 0) ? done : 0;
+		xi_file_seek(outfd, opos, XI_FILE_SEEK_SET);
+	}
+
+	xi_mem_free(buf);
+	return done;
+}
+
+xssize xi_file_tee(xint32 infd, xint32 outfd, xsize count, xint32 flags) {
+	UNUSED(infd);
+	UNUSED(outfd);
+	UNUSED(count);
+	UNUSED(flags);
+	return XI_FILE_RV_ERR_NS;
+}
+
+xssize xi_file_copy_range(xint32 infd, xoff64 *inoff, xint32 outfd,
+		xoff64 *outoff, xsize count) {
+	return xi_file_splice(infd, inoff, outfd, outoff, count, 0);
+}
+
 xi_file_re xi_file_close(xint32 fd) {
 	xbool ret;
 	xg_fd_t *fdesc;
@@ -23,19 +23,21 @@
 
 #include "xi/xi_mem.h"
 
+#include "../_all/xg_mem_track.h"
+
 // ----------------------------------------------
-// XI Functions
+// Internal Functions
 // ----------------------------------------------
 
-xvoid *xi_mem_alloc(xsize size) {
+xvoid *xg_mem_raw_alloc(xsize size) {
 	return LocalAlloc(LMEM_FIXED, size);
 }
 
-xvoid *xi_mem_calloc(xsize nmemb, xsize size) {
+xvoid *xg_mem_raw_calloc(xsize nmemb, xsize size) {
 	return LocalAlloc(LPTR, nmemb * size);
 }
 
-xvoid *xi_mem_realloc(xvoid *ptr, xsize size) {
+xvoid *xg_mem_raw_realloc(xvoid *ptr, xsize size) {
 	if (ptr == NULL) {
 		return LocalAlloc(LMEM_FIXED, size);
 	} else {
@@ -43,7 +45,47 @@ xvoid *xi_mem_realloc(xvoid *ptr, xsize size) {
 	}
 }
 
+xvoid xg_mem_raw_free(xvoid *ptr) {
+	LocalFree(ptr);
+}
+
+xint32 xg_mem_backtrace(xvoid **frames, xint32 max) {
+	return (xint32) RtlCaptureStackBackTrace(0, (DWORD) max, frames, NULL);
+}
+
+// ----------------------------------------------
+// XI Functions
+// ----------------------------------------------
+
+xvoid *xi_mem_alloc(xsize size) {
+	if (xg_mem_track_state & XG_MEM_TRACK_ON) {
+		return xg_mem_track_alloc(size, FALSE, XG_MEM_CALLER());
+	}
+	return LocalAlloc(LMEM_FIXED, size);
+}
+
+xvoid *xi_mem_calloc(xsize nmemb, xsize size) {
+	if (xg_mem_track_state & XG_MEM_TRACK_ON) {
+		if (size != 0 && nmemb > ((xsize) -1) / size) {
+			return NULL;
+		}
+		return xg_mem_track_alloc(nmemb * size, TRUE, XG_MEM_CALLER());
+	}
+	return LocalAlloc(LPTR, nmemb * size);
+}
+
+xvoid *xi_mem_realloc(xvoid *ptr, xsize size) {
+	if (xg_mem_track_state) {
+		return xg_mem_track_realloc(ptr, size, XG_MEM_CALLER());
+	}
+	return xg_mem_raw_realloc(ptr, size);
+}
+
 xvoid xi_mem_free(xvoid *ptr) {
+	if (xg_mem_track_state) {
+		xg_mem_track_free(ptr);
+		return;
+	}
 	LocalFree(ptr);
 }
 
@@ -128,6 +128,67 @@ xi_pollset_re xi_pollset_add(xi_pollset_t *pset, xi_pollfd_t fd) {
 	return XI_POLLSET_RV_OK;
 }
 
+xi_pollset_re xi_pollset_modify(xi_pollset_t *pset, xi_pollfd_t fd) {
+	xuint32 i;
+	xg_fd_t *sdesc;
+
+	if (pset == NULL) {
+		return XI_POLLSET_RV_ERR_ARGS;
+	}
+
+	if (fd.desc < 0) {
+		return XI_POLLSET_RV_ERR_ARGS;
+	}
+
+	if (pset->opt & XI_POLLSET_OPT_USELOCK) {
+		xi_thread_mutex_lock(&pset->lock);
+	}
+
+	sdesc = xg_fd_get(fd.desc);
+	if (sdesc == NULL) {
+		if (pset->opt & XI_POLLSET_OPT_USELOCK) {
+			xi_thread_mutex_unlock(&pset->lock);
+		}
+		return XI_POLLSET_RV_ERR_ARGS;
+	}
+
+	for (i=0; i<pset->used; i++) {
+		if (pset->pfds[i].desc == fd.desc) {
+			break;
+		}
+	}
+
+	if (i >= pset->used) {
+		if (pset->opt & XI_POLLSET_OPT_USELOCK) {
+			xi_thread_mutex_unlock(&pset->lock);
+		}
+		return XI_POLLSET_RV_ERR_NF;
+	}
+
+	FD_CLR(sdesc->desc.s.fd, &pset->set_read);
+	FD_CLR(sdesc->desc.s.fd, &pset->set_write);
+	FD_CLR(sdesc->desc.s.fd, &pset->set_except);
+
+	if (fd.evts & XI_POLL_EVENT_IN) {
+		FD_SET(sdesc->desc.s.fd, &pset->set_read);
+	}
+	if (fd.evts & XI_POLL_EVENT_OUT) {
+		FD_SET(sdesc->desc.s.fd, &pset->set_write);
+	}
+	if (fd.evts & XI_POLL_EVENT_ERR) {
+		FD_SET(sdesc->desc.s.fd, &pset->set_except);
+	}
+
+	pset->pfds[i].evts = fd.evts;
+	pset->pfds[i].context = fd.context;
+
+	if (pset->opt & XI_POLLSET_OPT_USELOCK) {
+		xi_thread_mutex_unlock(&pset->lock);
+	}
+
+	return XI_POLLSET_RV_OK;
+}
+
 xi_pollset_re xi_pollset_remove(xi_pollset_t *pset, xi_pollfd_t fd) {
 	xuint32 i;
 	xbool found;
@@ -251,6 +312,12 @@ xint32 xi_pollset_poll(xi_pollset_t *pset, xi_pollfd_t *rfds, xint32 rlen,
 			if (ret_events) {
 				rfds[j].evts = ret_events;
 				j++;
+				if (pset->pfds[i].evts & XI_POLL_EVENT_ONESHOT) {
+					// disarmed until xi_pollset_modify
+					FD_CLR(sdesc->desc.s.fd, &pset->set_read);
+					FD_CLR(sdesc->desc.s.fd, &pset->set_write);
+					FD_CLR(sdesc->desc.s.fd, &pset->set_except);
+				}
 			}
 		}
 	} else if (ret == 0) {
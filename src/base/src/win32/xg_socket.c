@@ -449,6 +449,116 @@ xint32 xg_inet_pton(int af, const char *src, void *dst) {
 	}
 }
 
+// ----------------------------------------------
+// Binary Address
+// ----------------------------------------------
+
+typedef union _u_sockaddr {
+	struct sockaddr      sa;
+	struct sockaddr_in   in4;
+	struct sockaddr_in6  in6;
+} xg_sockaddr_t;
+
+static xint32 xg_sock_bin_2sa(const xi_sock_addr_bin_t *bin, xg_sockaddr_t *sa) {
+	switch (bin->family) {
+	case XI_SOCK_FAMILY_INET:
+		memset(&sa->in4, 0, sizeof(sa->in4));
+		sa->in4.sin_family = AF_INET;
+		sa->in4.sin_port = htons(bin->port);
+		memcpy(&sa->in4.sin_addr, bin->addr, 4);
+		return sizeof(sa->in4);
+	case XI_SOCK_FAMILY_INET6:
+		memset(&sa->in6, 0, sizeof(sa->in6));
+		sa->in6.sin6_family = AF_INET6;
+		sa->in6.sin6_port = htons(bin->port);
+		sa->in6.sin6_scope_id = bin->scope;
+		memcpy(&sa->in6.sin6_addr, bin->addr, 16);
+		return sizeof(sa->in6);
+	default:
+		return 0;
+	}
+}
+
+static xi_sock_re xg_sock_sa_2bin(const xg_sockaddr_t *sa, xi_sock_addr_bin_t *bin) {
+	switch (sa->sa.sa_family) {
+	case AF_INET:
+		bin->family = XI_SOCK_FAMILY_INET;
+		bin->port = ntohs(sa->in4.sin_port);
+		bin->scope = 0;
+		memcpy(bin->addr, &sa->in4.sin_addr, 4);
+		memset(bin->addr + 4, 0, 12);
+		return XI_SOCK_RV_OK;
+	case AF_INET6:
+		bin->family = XI_SOCK_FAMILY_INET6;
+		bin->port = ntohs(sa->in6.sin6_port);
+		bin->scope = sa->in6.sin6_scope_id;
+		memcpy(bin->addr, &sa->in6.sin6_addr, 16);
+		return XI_SOCK_RV_OK;
+	default:
+		memset(bin, 0, sizeof(*bin));
+		return XI_SOCK_RV_ERR_NS;
+	}
+}
+
+static xi_sock_re xg_sock_err_conn(xint32 err) {
+	switch (err) {
+	case WSAEWOULDBLOCK:
+	case WSAEINPROGRESS:
+		return XI_SOCK_RV_ERR_TRYLATER;
+	case WSAEINTR:
+		return XI_SOCK_RV_ERR_INTR;
+	case WSAEACCES:
+		return XI_SOCK_RV_ERR_PERM;
+	case WSAEBADF:
+		return XI_SOCK_RV_ERR_FD;
+	case WSAENOTSOCK:
+		return XI_SOCK_RV_ERR_NOTSOCK;
+	case WSAEAFNOSUPPORT:
+	case WSAEADDRNOTAVAIL:
+	case WSAEFAULT:
+		return XI_SOCK_RV_ERR_ADDR;
+	case WSAEADDRINUSE:
+		return XI_SOCK_RV_ERR_INUSE;
+	case WSAECONNREFUSED:
+		return XI_SOCK_RV_ERR_REFUSED;
+	case WSAENETUNREACH:
+	case WSAEHOSTUNREACH:
+		return XI_SOCK_RV_ERR_UNREACH;
+	case WSAEISCONN:
+		return XI_SOCK_RV_ERR_ALREADY;
+	case WSAETIMEDOUT:
+		return XI_SOCK_RV_ERR_TIMEOUT;
+	default:
+		return XI_SOCK_RV_ERR_ARGS;
+	}
+}
+
+static xi_sock_re xg_sock_err_io(xint32 err) {
+	switch (err) {
+	case WSAEWOULDBLOCK:
+		return XI_SOCK_RV_ERR_TRYLATER;
+	case WSAEBADF:
+		return XI_SOCK_RV_ERR_FD;
+	case WSAENOTSOCK:
+		return XI_SOCK_RV_ERR_NOTSOCK;
+	case WSAENOTCONN:
+		return XI_SOCK_RV_ERR_NOTCONN;
+	case WSAECONNREFUSED:
+	case WSAECONNRESET:
+		return XI_SOCK_RV_ERR_REFUSED;
+	case WSAENOBUFS:
+		return XI_SOCK_RV_ERR_OVERFLOW;
+	case WSAEOPNOTSUPP:
+		return XI_SOCK_RV_ERR_NS;
+	case WSAEDESTADDRREQ:
+		return XI_SOCK_RV_ERR_ADDR;
+	case WSAEINTR:
+		return XI_SOCK_RV_ERR_INTR;
+	default:
+		return XI_SOCK_RV_ERR_ARGS;
+	}
+}
+
 // ----------------------------------------------
 // XI Functions
 // ----------------------------------------------
@@ -1290,6 +1400,329 @@ xi_sock_re xi_socket_get_local(xint32 sfd, xi_sock_addr_t *addr) {
 	return XI_SOCK_RV_OK;
 }
 
+xi_sock_re xi_socket_addr_pton(const xi_sock_addr_t *addr,
+		xi_sock_addr_bin_t *baddr) {
+	if (addr == NULL || baddr == NULL) {
+		return XI_SOCK_RV_ERR_ARGS;
+	}
+
+	xi_mem_set(baddr, 0, sizeof(*baddr));
+	switch (addr->family) {
+	case XI_SOCK_FAMILY_INET:
+		if (xg_inet_pton(AF_INET, addr->host, baddr->addr) <= 0) {
+			return XI_SOCK_RV_ERR_ADDR;
+		}
+		break;
+	case XI_SOCK_FAMILY_INET6:
+		if (xg_inet_pton(AF_INET6, addr->host, baddr->addr) <= 0) {
+			return XI_SOCK_RV_ERR_ADDR;
+		}
+		break;
+	default:
+		return XI_SOCK_RV_ERR_NS;
+	}
+	baddr->family = (xuint16) addr->family;
+	baddr->port = addr->port;
+
+	return XI_SOCK_RV_OK;
+}
+
+xi_sock_re xi_socket_addr_ntop(const xi_sock_addr_bin_t *baddr,
+		xi_sock_addr_t *addr) {
+	if (baddr == NULL || addr == NULL) {
+		return XI_SOCK_RV_ERR_ARGS;
+	}
+
+	switch (baddr->family) {
+	case XI_SOCK_FAMILY_INET:
+		xg_inet_ntop(AF_INET, baddr->addr, addr->host, sizeof(addr->host));
+		break;
+	case XI_SOCK_FAMILY_INET6:
+		xg_inet_ntop(AF_INET6, baddr->addr, addr->host, sizeof(addr->host));
+		break;
+	default:
+		return XI_SOCK_RV_ERR_NS;
+	}
+	addr->family = (xi_sock_family_e) baddr->family;
+	addr->port = baddr->port;
+
+	return XI_SOCK_RV_OK;
+}
+
+xi_sock_re xi_socket_bind_bin(xint32 sfd, const xi_sock_addr_bin_t *baddr) {
+	xg_sockaddr_t addr;
+	xint32 alen;
+	xg_fd_t *sdesc;
+
+	if (sfd < 0 || baddr == NULL) {
+		return XI_SOCK_RV_ERR_ARGS;
+	}
+
+	alen = xg_sock_bin_2sa(baddr, &addr);
+	if (alen == 0) {
+		return XI_SOCK_RV_ERR_ARGS;
+	}
+
+	sdesc = xg_fd_get(sfd);
+
+	if (bind(sdesc->desc.s.fd, &addr.sa, alen) == SOCKET_ERROR) {
+		return xg_sock_err_conn(WSAGetLastError());
+	}
+
+	return XI_SOCK_RV_OK;
+}
+
+xint32 xi_socket_accept_bin(xint32 sfd, xi_sock_addr_bin_t *fromaddr) {
+	xg_fd_t pfd;
+	xg_fd_t *sdesc;
+	xg_sockaddr_t addr;
+	xint32 alen = sizeof(addr);
+	xint32 ret;
+
+	if (sfd < 0) {
+		return XI_SOCK_RV_ERR_ARGS;
+	}
+
+	sdesc = xg_fd_get(sfd);
+
+	addr.sa.sa_family = AF_UNSPEC;
+	pfd.desc.s.fd = accept(sdesc->desc.s.fd, &addr.sa, &alen);
+	if (pfd.desc.s.fd == INVALID_SOCKET) {
+		return xg_sock_err_conn(WSAGetLastError());
+	}
+
+	pfd.type = XG_FD_TYPE_SOCK;
+	pfd.desc.s.family = sdesc->desc.s.family;
+	pfd.desc.s.type = sdesc->desc.s.type;
+	pfd.desc.s.proto = sdesc->desc.s.proto;
+
+	ret = xg_fd_open(&pfd);
+	if (ret < 0) {
+		closesocket(pfd.desc.s.fd);
+		return XI_SOCK_RV_ERR_FD;
+	}
+
+	if (fromaddr != NULL) {
+		xg_sock_sa_2bin(&addr, fromaddr);
+	}
+
+	return ret;
+}
+
+xint32 xi_socket_accept4(xint32 sfd, xi_sock_addr_bin_t *fromaddr,
+		xint32 flags) {
+	xint32 rsock;
+	SOCKET rs;
+
+	rsock = xi_socket_accept_bin(sfd, fromaddr);
+	if (rsock < 0) {
+		return rsock;
+	}
+
+	rs = xg_fd_get(rsock)->desc.s.fd;
+	if (flags & XI_SOCK_ACCEPT_NONBLOCK) {
+		u_long nb = 1;
+		if (ioctlsocket(rs, FIONBIO, &nb) == SOCKET_ERROR) {
+			xi_socket_close(rsock);
+			return XI_SOCK_RV_ERR_FD;
+		}
+	}
+	if (flags & XI_SOCK_ACCEPT_CLOEXEC) {
+		// the nearest thing : not inherited by the child processes
+		SetHandleInformation((HANDLE) rs, HANDLE_FLAG_INHERIT, 0);
+	}
+
+	return rsock;
+}
+
+xi_sock_re xi_socket_connect_bin(xint32 sfd, const xi_sock_addr_bin_t *caddr) {
+	xg_sockaddr_t addr;
+	xint32 alen;
+	xg_fd_t *sdesc;
+
+	if (sfd < 0 || caddr == NULL) {
+		return XI_SOCK_RV_ERR_ARGS;
+	}
+
+	if (caddr->family == XI_SOCK_FAMILY_UNSPEC) {
+		memset(&addr, 0, sizeof(addr));
+		addr.sa.sa_family = AF_UNSPEC;
+		alen = sizeof(addr.sa);
+	} else {
+		alen = xg_sock_bin_2sa(caddr, &addr);
+		if (alen == 0) {
+			return XI_SOCK_RV_ERR_ARGS;
+		}
+	}
+
+	sdesc = xg_fd_get(sfd);
+
+	if (connect(sdesc->desc.s.fd, &addr.sa, alen) == SOCKET_ERROR) {
+		return xg_sock_err_conn(WSAGetLastError());
+	}
+
+	return XI_SOCK_RV_OK;
+}
+
+xssize xi_socket_recvfrom_bin(xint32 sfd, xvoid *buf, xsize blen,
+		xi_sock_addr_bin_t *fromaddr) {
+	xssize ret;
+	xg_fd_t *sdesc;
+	xg_sockaddr_t addr;
+	xint32 alen = sizeof(addr);
+
+	if (sfd < 0 || buf == NULL || blen <= 0) {
+		return XI_SOCK_RV_ERR_ARGS;
+	}
+
+	sdesc = xg_fd_get(sfd);
+
+	addr.sa.sa_family = AF_UNSPEC;
+	ret = recvfrom(sdesc->desc.s.fd, (xchar *) buf, (xint32) blen, 0, &addr.sa,
+			&alen);
+	if (ret == SOCKET_ERROR) {
+		return xg_sock_err_io(WSAGetLastError());
+	}
+
+	if (fromaddr != NULL) {
+		xg_sock_sa_2bin(&addr, fromaddr);
+	}
+
+	return ret;
+}
+
+xssize xi_socket_sendto_bin(xint32 sfd, const xvoid *buf, xsize blen,
+		const xi_sock_addr_bin_t *toaddr) {
+	xssize ret;
+	xg_fd_t *sdesc;
+	xg_sockaddr_t addr;
+	xint32 alen;
+
+	if (sfd < 0 || buf == NULL || blen <= 0 || toaddr == NULL) {
+		return XI_SOCK_RV_ERR_ARGS;
+	}
+
+	alen = xg_sock_bin_2sa(toaddr, &addr);
+	if (alen == 0) {
+		return XI_SOCK_RV_ERR_ADDR;
+	}
+
+	sdesc = xg_fd_get(sfd);
+
+	ret = sendto(sdesc->desc.s.fd, (const xchar *) buf, (xint32) blen, 0,
+			&addr.sa, alen);
+	if (ret == SOCKET_ERROR) {
+		return xg_sock_err_io(WSAGetLastError());
+	}
+
+	return ret;
+}
+
+xi_sock_re xi_socket_get_peer_bin(xint32 sfd, xi_sock_addr_bin_t *addr) {
+	xg_fd_t *sdesc;
+	xg_sockaddr_t xaddr;
+	xint32 alen = sizeof(xaddr);
+
+	if (sfd < 0 || addr == NULL) {
+		return XI_SOCK_RV_ERR_ARGS;
+	}
+
+	sdesc = xg_fd_get(sfd);
+
+	if (getpeername(sdesc->desc.s.fd, &xaddr.sa, &alen) == SOCKET_ERROR) {
+		return xg_sock_err_io(WSAGetLastError());
+	}
+
+	return xg_sock_sa_2bin(&xaddr, addr);
+}
+
+xi_sock_re xi_socket_get_local_bin(xint32 sfd, xi_sock_addr_bin_t *addr) {
+	xg_fd_t *sdesc;
+	xg_sockaddr_t xaddr;
+	xint32 alen = sizeof(xaddr);
+
+	if (sfd < 0 || addr == NULL) {
+		return XI_SOCK_RV_ERR_ARGS;
+	}
+
+	sdesc = xg_fd_get(sfd);
+
+	if (getsockname(sdesc->desc.s.fd, &xaddr.sa, &alen) == SOCKET_ERROR) {
+		return xg_sock_err_io(WSAGetLastError());
+	}
+
+	return xg_sock_sa_2bin(&xaddr, addr);
+}
+
+xint32 xi_socket_recvmmsg(xint32 sfd, xi_sock_msg_t *msgs, xint32 count) {
+	xint32 i;
+	xg_fd_t *sdesc;
+
+	if (sfd < 0 || msgs == NULL || count <= 0) {
+		return XI_SOCK_RV_ERR_ARGS;
+	}
+
+	sdesc = xg_fd_get(sfd);
+
+	// no recvmmsg : only the first recvfrom can block,
+	// the others are done while a datagram is pending.
+	for (i = 0; i < count; i++) {
+		xssize ret;
+		xg_sockaddr_t addr;
+		xint32 alen = sizeof(addr);
+
+		if (i > 0) {
+			u_long pending = 0;
+			if (ioctlsocket(sdesc->desc.s.fd, FIONREAD, &pending) == SOCKET_ERROR
+					|| pending == 0) {
+				break;
+			}
+		}
+
+		addr.sa.sa_family = AF_UNSPEC;
+		ret = recvfrom(sdesc->desc.s.fd, (xchar *) msgs[i].buf,
+				(xint32) msgs[i].blen, 0, &addr.sa, &alen);
+		if (ret == SOCKET_ERROR) {
+			if (i > 0) {
+				break;
+			}
+			return xg_sock_err_io(WSAGetLastError());
+		}
+		msgs[i].len = ret;
+		xg_sock_sa_2bin(&addr, &msgs[i].addr);
+	}
+
+	return i;
+}
+
+xint32 xi_socket_sendmmsg(xint32 sfd, xi_sock_msg_t *msgs, xint32 count) {
+	xint32 i;
+
+	if (sfd < 0 || msgs == NULL || count <= 0) {
+		return XI_SOCK_RV_ERR_ARGS;
+	}
+
+	// no sendmmsg : one datagram per call
+	for (i = 0; i < count; i++) {
+		xssize ret;
+
+		if (msgs[i].addr.family == XI_SOCK_FAMILY_UNSPEC) {
+			ret = xi_socket_send(sfd, msgs[i].buf, msgs[i].blen);
+		} else {
+			ret = xi_socket_sendto_bin(sfd, msgs[i].buf, msgs[i].blen, &msgs[i].addr);
+		}
+		if (ret < 0) {
+			if (i > 0) {
+				break;
+			}
+			return (xint32) ret;
+		}
+		msgs[i].len = ret;
+	}
+
+	return i;
+}
+
 xi_sock_re xi_mcast_join(xint32 sfd, xi_sock_addr_t iface, xi_sock_addr_t grp,
 		xi_sock_addr_t *src) {
 	xg_fd_t *sdesc;
@@ -75,6 +75,9 @@ static HANDLE _g_thr_cond = NULL;
 
 static DWORD _g_thr_self = 0;
 
+// the data of the calling thread, to look itself up without _g_thr_lock
+static DWORD _g_thr_tdat = TLS_OUT_OF_INDEXES;
+
 static xg_threads_info_t _g_thr_info = {
 /* current_threads */1,
 /* peak_threads */1,
@@ -82,17 +85,23 @@ static xg_threads_info_t _g_thr_info = {
 /* all_threads_suspended */0,
 /* threads_waiting_to_start */0, };
 
-static xi_hashtb_t *_g_thr_db = NULL;
+static xi_hashtb_conc_t *_g_thr_db = NULL;
 
 // ----------------------------------------------
 // Part Internal Functions
 // ----------------------------------------------
 _XI_INLINE xg_thread_dat_t *xg_thread_tdat_get(xi_thread_t tid) {
-	xg_thread_dat_t *tdat;
-	EnterCriticalSection(&_g_thr_lock);
-	tdat = (xg_thread_dat_t *) xi_hashtb_get(_g_thr_db, &tid, sizeof(xi_thread_t));
-	LeaveCriticalSection(&_g_thr_lock);
-	return tdat;
+	xg_thread_dat_t *tdat = NULL;
+
+	if (_g_thr_tdat != TLS_OUT_OF_INDEXES) {
+		tdat = (xg_thread_dat_t *) TlsGetValue(_g_thr_tdat);
+	}
+	if (tdat != NULL && tdat->tid == tid) {
+		return tdat;
+	}
+
+	// it takes no lock
+	return xi_hashtb_conc_get(_g_thr_db, &tid, sizeof(xi_thread_t));
 }
 
 static xvoid xg_thrmain_init() {
@@ -121,6 +130,7 @@ static xvoid xg_thrmain_init() {
 	//	log_print(XDLOG, "meminfo.Type = %d\n", meminfo.Type);
 
 	_g_thr_self = TlsAlloc();
+	_g_thr_tdat = TlsAlloc();
 
 	tdat->entry = NULL;
 	tdat->args = NULL;
@@ -148,9 +158,11 @@ static xvoid xg_thrmain_init() {
 	tdat->blocking = XI_THREAD_SUSBLK_NOBLOCK;
 
 	EnterCriticalSection(&_g_thr_lock);
-	xi_hashtb_set(_g_thr_db, &tdat->tid, sizeof(xi_thread_t), tdat);
+	xi_hashtb_conc_set(_g_thr_db, &tdat->tid, sizeof(xi_thread_t), tdat);
 	LeaveCriticalSection(&_g_thr_lock);
 
+	TlsSetValue(_g_thr_tdat, tdat);
+
 	//	log_print(XDLOG, "[MAIN_THREAD] =======================\n");
 	//	log_print(XDLOG, "tdat->entry = %p\n", tdat->entry);
 	//	log_print(XDLOG, "tdat->args = %p\n", tdat->args);
@@ -197,12 +209,13 @@ static xvoid *xg_thread_starter(xvoid *args) {
 	tdat->tid = xi_thread_self();
 	tdat->stack_base = &tdat;
 	tdat->stack_top = &tdat;
+	TlsSetValue(_g_thr_tdat, tdat);
 
 	// Lock the world!!
 	EnterCriticalSection(&_g_thr_lock);
 
 	// Add the thread to HashTable
-	xi_hashtb_set(_g_thr_db, &tdat->tid, sizeof(xi_thread_t), tdat);
+	xi_hashtb_conc_set(_g_thr_db, &tdat->tid, sizeof(xi_thread_t), tdat);
 
 	// Wait if all-suspended
 	_g_thr_info.threads_waiting_to_start++;
@@ -243,7 +256,8 @@ static xvoid *xg_thread_starter(xvoid *args) {
 	//	log_print(XDLOG, "tdat->prior = %d\n", tdat->prior);
 	//	log_print(XDLOG, "=====================================\n");
 
-	xi_hashtb_set(_g_thr_db, &tdat->tid, sizeof(xi_thread_t), NULL);
+	xi_hashtb_conc_set(_g_thr_db, &tdat->tid, sizeof(xi_thread_t), NULL);
+	TlsSetValue(_g_thr_tdat, NULL);
 	_g_thr_info.threads_count--;
 	xi_mem_free(tdat);
 	LeaveCriticalSection(&_g_thr_lock);
@@ -262,7 +276,7 @@ xi_thread_re xi_thread_create(xi_thread_t *tid, const xchar *tname,
 	xg_thread_dat_t *tdat = NULL;
 
 	if (_g_thr_db == NULL) {
-		_g_thr_db = xi_hashtb_create();
+		_g_thr_db = xi_hashtb_conc_create(NULL);
 		InitializeCriticalSectionAndSpinCount(&_g_thr_lock, 0x80000400);
 		_g_thr_cond = CreateMutex(NULL, FALSE, NULL);
 		xg_thrmain_init();
@@ -362,7 +376,8 @@ xi_thread_re xi_thread_suspend(xi_thread_t tid) {
 }
 
 xi_thread_re xi_thread_suspend_all() {
-	xi_hashtb_idx_t *hidx = NULL;
+	xi_hashtb_conc_idx_t iter;
+	xi_hashtb_conc_idx_t *hidx = NULL;
 	xg_thread_dat_t *self = xg_thread_tdat_get(xi_thread_self());
 
 	EnterCriticalSection(&_g_thr_lock);
@@ -375,12 +390,12 @@ xi_thread_re xi_thread_suspend_all() {
 	//	log_print(XDLOG, "_g_thr_info.threads_waiting_to_start = %d\n", _g_thr_info.threads_waiting_to_start);
 	//	log_print(XDLOG, "=====================================\n");
 
-	for (hidx = xi_hashtb_first(_g_thr_db); hidx; hidx = xi_hashtb_next(hidx)) {
+	for (hidx = xi_hashtb_conc_first(_g_thr_db, &iter); hidx; hidx = xi_hashtb_conc_next(hidx)) {
 		xi_thread_t *key = NULL;
 		xint32 klen = 0;
 		xg_thread_dat_t *tdat = NULL;
 
-		xi_hashtb_this(hidx, (const xvoid **) &key, &klen, (xvoid **) &tdat);
+		xi_hashtb_conc_this(hidx, (const xvoid **) &key, &klen, (xvoid **) &tdat);
 
 		//log_print(XDLOG, "[SUSPEND_ALL] tdat->tname = %s : ", tdat->tname);
 
@@ -467,19 +482,20 @@ xi_thread_re xi_thread_resume(xi_thread_t tid) {
 }
 
 xi_thread_re xi_thread_resume_all(xi_thread_t tid) {
-	xi_hashtb_idx_t *hidx = NULL;
+	xi_hashtb_conc_idx_t iter;
+	xi_hashtb_conc_idx_t *hidx = NULL;
 	xg_thread_dat_t *self = xg_thread_tdat_get(xi_thread_self());
 
 	UNUSED(tid);
 
 	EnterCriticalSection(&_g_thr_lock);
 
-	for (hidx = xi_hashtb_first(_g_thr_db); hidx; hidx = xi_hashtb_next(hidx)) {
+	for (hidx = xi_hashtb_conc_first(_g_thr_db, &iter); hidx; hidx = xi_hashtb_conc_next(hidx)) {
 		xi_thread_t *key = NULL;
 		xint32 klen = 0;
 		xg_thread_dat_t *tdat = NULL;
 
-		xi_hashtb_this(hidx, (const xvoid **) &key, &klen, (xvoid **) &tdat);
+		xi_hashtb_conc_this(hidx, (const xvoid **) &key, &klen, (xvoid **) &tdat);
 
 		//log_print(XDLOG, "[RESUME_ALL] tdat->tname = %s  : ", tdat->tname);
 
@@ -623,7 +639,7 @@ xi_thread_t xi_thread_self() {
 	HANDLE htarget;
 
 	if (_g_thr_db == NULL) {
-		_g_thr_db = xi_hashtb_create();
+		_g_thr_db = xi_hashtb_conc_create(NULL);
 		InitializeCriticalSectionAndSpinCount(&_g_thr_lock, 0x80000400);
 		_g_thr_cond = CreateMutex(NULL, FALSE, NULL);
 		xg_thrmain_init();
@@ -761,7 +777,7 @@ xint32 xi_thread_is_suspendable(xi_thread_t tid) {
 	return tdat->blocking;
 }
 
-xvoid *xi_thread_list() {
+xi_hashtb_conc_t *xi_thread_list() {
 	return _g_thr_db;
 }
 
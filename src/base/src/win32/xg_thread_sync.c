@@ -22,6 +22,7 @@
 
 #include "xi/xi_thread.h"
 
+#include "xi/xi_atomic.h"
 #include "xi/xi_mem.h"
 #include "xi/xi_log.h"
 #include "xi/xi_string.h"
@@ -30,15 +31,17 @@
 // Inner Structure
 // ----------------------------------------------
 
+/*
+ * A mutex/cond/rwlock/seqlock handle is the address of its own element,
+ * allocated on creation and freed on destruction (see posix/xg_thread_sync.c).
+ */
+
 typedef struct _st_thread_mutex {
-	xint32 used;
 	xchar oname[XCFG_ONAME_MAX];
-	HANDLE lock;
-//CRITICAL_SECTION  lock;
+	CRITICAL_SECTION lock;
 } xg_thread_mutex_t;
 
 typedef struct _st_thread_cond {
-	xint32 used;
 	xchar oname[XCFG_ONAME_MAX];
 	HANDLE cond;
 	CRITICAL_SECTION csec;
@@ -47,122 +50,61 @@ typedef struct _st_thread_cond {
 	xuint32 generation;
 } xg_thread_cond_t;
 
-typedef struct _st_thread_mutex_pool {
-	xint32 init;
-	xint32 counter;
-	xuintptr last;
-	xg_thread_mutex_t locks[XCFG_MUTEX_MAX];
-} xg_thr_locks_t;
+typedef struct _st_thread_rwlock {
+	xchar oname[XCFG_ONAME_MAX];
+	SRWLOCK lock;
+	xint32 wlocked; // SRWLOCK is released by the mode it was acquired
+} xg_thread_rwlock_t;
+
+typedef struct _st_thread_seqlock {
+	volatile LONG seq; // odd while a write is in progress
+	xchar oname[XCFG_ONAME_MAX];
+	CRITICAL_SECTION wlock; // serializes the writers
+} xg_thread_seqlock_t;
+
+// spins of a contended mutex before waiting on the kernel
+#define XG_MUTEX_SPIN   4000
 
-typedef struct _st_thread_cond_pool {
-	xint32 init;
-	xint32 counter;
-	xuintptr last;
-	xg_thread_cond_t conds[XCFG_COND_MAX];
-} xg_thr_conds_t;
+// spins of a seqlock reader before yielding to the writer
+#define XG_SEQLOCK_SPIN 64
 
 // ----------------------------------------------
 // Global Variables
 // ----------------------------------------------
 
-static xg_thr_locks_t _g_thr_locks;
-static xg_thr_conds_t _g_thr_conds;
+static volatile xuint32 _g_thr_locks = 0; // the number of living mutexes
+static volatile xuint32 _g_thr_conds = 0; // the number of living conds
 
 // ----------------------------------------------
 // Part Internal Functions
 // ----------------------------------------------
 
-static xuintptr xg_tmutex_alloc() {
-	xuintptr i;
-
-	if (!_g_thr_locks.init) {
-		xi_mem_set(&_g_thr_locks, 0, sizeof(_g_thr_locks));
-		_g_thr_locks.init = 1;
-	}
-
-	for (i = _g_thr_locks.last; i < XCFG_MUTEX_MAX; i++) {
-		if (!_g_thr_locks.locks[i].used) {
-			_g_thr_locks.locks[i].used = 1;
-			_g_thr_locks.last = i;
-			_g_thr_locks.counter++;
-			//log_trace(XDLOG, "[1st] idx=%d / total=%d\n", i, _g_thr_locks.counter);
-			return i;
-		}
-	}
-
-	if (_g_thr_locks.counter < XCFG_MUTEX_MAX) {
-		_g_thr_locks.last = 0;
-	}
-
-	for (i = _g_thr_locks.last; i < XCFG_MUTEX_MAX; i++) {
-		if (!_g_thr_locks.locks[i].used) {
-			_g_thr_locks.locks[i].used = 1;
-			_g_thr_locks.last = i;
-			_g_thr_locks.counter++;
-			//log_trace(XDLOG, "[2nd] idx=%d / total=%d\n", i, _g_thr_locks.counter);
-			return i;
-		}
+_XI_INLINE xg_thread_mutex_t *xg_tmutex_get(xi_thread_mutex_t *lock) {
+	if (lock == NULL || (*lock) == 0 || (*lock) == (xi_thread_mutex_t)-1) {
+		return NULL;
 	}
-
-	log_error(XDLOG, "Cannot find free mutex-element!!\n");
-	return -1;
+	return (xg_thread_mutex_t *) (*lock);
 }
 
-static xuintptr xg_tmutex_free(xuintptr idx) {
-	if (_g_thr_locks.locks[idx].used) {
-		_g_thr_locks.counter--;
-		_g_thr_locks.locks[idx].used = 0;
-		xi_mem_set(_g_thr_locks.locks[idx].oname, 0, XCFG_ONAME_MAX);
+_XI_INLINE xg_thread_cond_t *xg_tcond_get(xi_thread_cond_t *cond) {
+	if (cond == NULL || (*cond) == 0 || (*cond) == (xi_thread_cond_t)-1) {
+		return NULL;
 	}
-	return idx;
+	return (xg_thread_cond_t *) (*cond);
 }
 
-static xuintptr xg_tcond_alloc() {
-	xuintptr i;
-
-	if (!_g_thr_locks.init) {
-		xi_mem_set(&_g_thr_conds, 0, sizeof(_g_thr_conds));
-		_g_thr_conds.init = 1;
-	}
-
-	for (i = _g_thr_conds.last; i < XCFG_COND_MAX; i++) {
-		if (!_g_thr_conds.conds[i].used) {
-			_g_thr_conds.conds[i].used = 1;
-			_g_thr_conds.last = i;
-			_g_thr_conds.counter++;
-			//log_trace(XDLOG, "[1st] idx=%d / total=%d\n", i, _g_thr_conds.counter);
-			return i;
-		}
-	}
-
-	if (_g_thr_conds.counter < XCFG_COND_MAX) {
-		_g_thr_conds.last = 0;
-	}
-
-	for (i = _g_thr_conds.last; i < XCFG_COND_MAX; i++) {
-		if (!_g_thr_conds.conds[i].used) {
-			_g_thr_conds.conds[i].used = 1;
-			_g_thr_conds.last = i;
-			_g_thr_conds.counter++;
-			//log_trace(XDLOG, "[2nd] idx=%d / total=%d\n", i, _g_thr_conds.counter);
-			return i;
-		}
+_XI_INLINE xg_thread_rwlock_t *xg_trwlock_get(xi_thread_rwlock_t *rwlock) {
+	if (rwlock == NULL || (*rwlock) == 0 || (*rwlock) == (xi_thread_rwlock_t)-1) {
+		return NULL;
 	}
-
-	log_error(XDLOG, "Cannot find free cond-element!!\n");
-	return -1;
+	return (xg_thread_rwlock_t *) (*rwlock);
 }
 
-static xuintptr xg_tcond_free(xuintptr idx) {
-	if (_g_thr_conds.conds[idx].used) {
-		_g_thr_conds.counter--;
-		_g_thr_conds.conds[idx].used = 0;
-		_g_thr_conds.conds[idx].nwait = 0;
-		_g_thr_conds.conds[idx].nwake = 0;
-		_g_thr_conds.conds[idx].generation = 0;
-		xi_mem_set(_g_thr_conds.conds[idx].oname, 0, XCFG_ONAME_MAX);
+_XI_INLINE xg_thread_seqlock_t *xg_tseqlock_get(xi_thread_seqlock_t *seqlock) {
+	if (seqlock == NULL || (*seqlock) == 0 || (*seqlock) == (xi_thread_seqlock_t)-1) {
+		return NULL;
 	}
-	return idx;
+	return (xg_thread_seqlock_t *) (*seqlock);
 }
 
 // ----------------------------------------------
@@ -174,117 +116,79 @@ static xuintptr xg_tcond_free(xuintptr idx) {
 //------------
 
 xi_thread_mutex_re xi_thread_mutex_create(xi_thread_mutex_t *lock, xchar *mname) {
-	xuintptr idx;
 	xg_thread_mutex_t *flock;
 
-	idx = xg_tmutex_alloc();
-	if ((xintptr)idx < 0) {
-		log_error(XDLOG, "Cannot create mutex : [%s]!!! (total=%d)\n", mname, _g_thr_locks.counter);
-		(*lock) = -1;
-		return XI_MUTEX_RV_ERR_NOMORE;
+	(*lock) = (xi_thread_mutex_t)-1;
+
+	flock = (xg_thread_mutex_t *) xi_mem_alloc(sizeof(xg_thread_mutex_t));
+	if (flock == NULL) {
+		log_error(XDLOG, "Cannot create mutex : [%s]!!! (total=%u)\n", mname, _g_thr_locks);
+		return XI_MUTEX_RV_ERR_NOMEM;
 	}
-	flock = &(_g_thr_locks.locks[idx]);
 
-	flock->lock = CreateMutex(NULL, FALSE, NULL);
-	if (flock->lock == NULL) {
-		return XI_MUTEX_RV_ERR_ARGS;
+	if (!InitializeCriticalSectionAndSpinCount(&flock->lock, XG_MUTEX_SPIN)) {
+		xi_mem_free(flock);
+		return XI_MUTEX_RV_ERR_NOMEM;
 	}
-	//InitializeCriticalSection(&flock->lock);
 
-	(*lock) = (xi_thread_mutex_t) (idx);
 	xi_strncpy(flock->oname, mname, (XCFG_ONAME_MAX - 1));
+	flock->oname[XCFG_ONAME_MAX - 1] = '\0';
+	xi_atomic_inc32(&_g_thr_locks);
+	(*lock) = (xi_thread_mutex_t) flock;
 
 	return XI_MUTEX_RV_OK;
 }
 
 xi_thread_mutex_re xi_thread_mutex_lock(xi_thread_mutex_t *lock) {
-	DWORD ret;
-	xuintptr idx = (*lock);
-	xg_thread_mutex_t *flock = NULL;
+	xg_thread_mutex_t *flock = xg_tmutex_get(lock);
 
-	if (idx > XCFG_MUTEX_MAX) {
+	if (flock == NULL) {
 		return XI_MUTEX_RV_ERR_ARGS;
 	}
 
-	flock = &(_g_thr_locks.locks[idx]);
-
-	ret = WaitForSingleObject(flock->lock, INFINITE);
-	if ((ret != WAIT_OBJECT_0) && (ret != WAIT_ABANDONED)) {
-		return (ret == WAIT_TIMEOUT) ? XI_MUTEX_RV_ERR_BUSY
-				: XI_MUTEX_RV_ERR_ARGS;
-	}
-
-	//EnterCriticalSection(&flock->lock);
+	EnterCriticalSection(&flock->lock);
 
 	return XI_MUTEX_RV_OK;
 }
 
 xi_thread_mutex_re xi_thread_mutex_trylock(xi_thread_mutex_t *lock) {
-	DWORD ret;
-	xuintptr idx = (*lock);
-	xg_thread_mutex_t *flock = NULL;
+	xg_thread_mutex_t *flock = xg_tmutex_get(lock);
 
-	if (idx > XCFG_MUTEX_MAX) {
+	if (flock == NULL) {
 		return XI_MUTEX_RV_ERR_ARGS;
 	}
 
-	flock = &(_g_thr_locks.locks[idx]);
-
-	ret = WaitForSingleObject(flock->lock, INFINITE);
-	if ((ret != WAIT_OBJECT_0) && (ret != WAIT_ABANDONED)) {
-		return (ret == WAIT_TIMEOUT) ? XI_MUTEX_RV_ERR_BUSY
-				: XI_MUTEX_RV_ERR_ARGS;
-	} else {
+	if (TryEnterCriticalSection(&flock->lock)) {
 		return XI_MUTEX_RV_OK;
+	} else {
+		return XI_MUTEX_RV_ERR_BUSY;
 	}
-
-	//if (TryEnterCriticalSection(&flock->lock)) {
-	//	return XI_MUTEX_RV_OK;
-	//} else {
-	//	return XI_MUTEX_RV_ERR_BUSY;
-	//}
 }
 
 xi_thread_mutex_re xi_thread_mutex_unlock(xi_thread_mutex_t *lock) {
-	xbool ret;
-	xuintptr idx = (*lock);
-	xg_thread_mutex_t *flock = NULL;
-
-	if (idx > XCFG_MUTEX_MAX) {
-		return XI_MUTEX_RV_ERR_ARGS;
-	}
+	xg_thread_mutex_t *flock = xg_tmutex_get(lock);
 
-	flock = &(_g_thr_locks.locks[idx]);
-
-	ret = ReleaseMutex(flock->lock);
-	if (!ret) {
+	if (flock == NULL) {
 		return XI_MUTEX_RV_ERR_ARGS;
 	}
 
-	//LeaveCriticalSection(&flock->lock);
+	LeaveCriticalSection(&flock->lock);
 
 	return XI_MUTEX_RV_OK;
 }
 
 xi_thread_mutex_re xi_thread_mutex_destroy(xi_thread_mutex_t *lock) {
-	xbool ret;
-	xuintptr idx = (*lock);
-	xg_thread_mutex_t *flock = NULL;
-
-	if (idx > XCFG_MUTEX_MAX) {
-		return XI_MUTEX_RV_ERR_ARGS;
-	}
-
-	flock = &(_g_thr_locks.locks[idx]);
+	xg_thread_mutex_t *flock = xg_tmutex_get(lock);
 
-	ret = CloseHandle(flock->lock);
-	if (!ret) {
+	if (flock == NULL) {
 		return XI_MUTEX_RV_ERR_ARGS;
 	}
 
-	//DeleteCriticalSection(&flock->lock);
+	DeleteCriticalSection(&flock->lock);
 
-	xg_tmutex_free(idx);
+	xi_mem_free(flock);
+	xi_atomic_sub32(&_g_thr_locks, 1);
+	(*lock) = (xi_thread_mutex_t)-1;
 
 	return XI_MUTEX_RV_OK;
 }
@@ -294,25 +198,27 @@ xi_thread_mutex_re xi_thread_mutex_destroy(xi_thread_mutex_t *lock) {
 //------------
 
 xi_thread_cond_re xi_thread_cond_create(xi_thread_cond_t *cond, xchar *cname) {
-	xuintptr idx;
 	xg_thread_cond_t *fcond;
 
-	idx = xg_tcond_alloc();
-	if ((xintptr)idx < 0) {
-		log_error(XDLOG, "Cannot create cond : [%s]!!! (total=%d)\n", cname, _g_thr_conds.counter);
-		(*cond) = -1;
-		return XI_COND_RV_ERR_NOMORE;
+	(*cond) = (xi_thread_cond_t)-1;
+
+	fcond = (xg_thread_cond_t *) xi_mem_calloc(1, sizeof(xg_thread_cond_t));
+	if (fcond == NULL) {
+		log_error(XDLOG, "Cannot create cond : [%s]!!! (total=%u)\n", cname, _g_thr_conds);
+		return XI_COND_RV_ERR_NOMEM;
 	}
-	fcond = &(_g_thr_conds.conds[idx]);
 
 	fcond->cond = CreateSemaphore(NULL, 0, LONG_MAX, NULL);
 	if (fcond->cond == NULL) {
+		xi_mem_free(fcond);
 		return XI_COND_RV_ERR_ARGS;
 	}
 	InitializeCriticalSection(&fcond->csec);
 
 	xi_strncpy(fcond->oname, cname, (XCFG_ONAME_MAX - 1));
-	(*cond) = (xi_thread_cond_t) (idx);
+	fcond->oname[XCFG_ONAME_MAX - 1] = '\0';
+	xi_atomic_inc32(&_g_thr_conds);
+	(*cond) = (xi_thread_cond_t) fcond;
 
 	return XI_COND_RV_OK;
 }
@@ -330,20 +236,13 @@ xi_thread_cond_re xi_thread_cond_timedwait(xi_thread_cond_t *cond,
 	xint32 wake = 0;
 	xint32 generation;
 
-	xuintptr cidx = (*cond);
-	xuintptr lidx = (*lock);
-	xg_thread_cond_t *fcond = NULL;
-	xg_thread_mutex_t *flock = NULL;
+	xg_thread_cond_t *fcond = xg_tcond_get(cond);
+	xg_thread_mutex_t *flock = xg_tmutex_get(lock);
 
-	if (cidx > XCFG_COND_MAX || lidx > XCFG_MUTEX_MAX) {
-		return XI_MUTEX_RV_ERR_ARGS;
+	if (fcond == NULL || flock == NULL) {
+		return XI_COND_RV_ERR_ARGS;
 	}
 
-	fcond = &(_g_thr_conds.conds[cidx]);
-	flock = &(_g_thr_locks.locks[lidx]);
-
-	UNUSED(flock);
-
 	EnterCriticalSection(&fcond->csec);
 	fcond->nwait++;
 	generation = fcond->generation;
@@ -388,15 +287,12 @@ xi_thread_cond_re xi_thread_cond_timedwait(xi_thread_cond_t *cond,
 xi_thread_cond_re xi_thread_cond_broadcast(xi_thread_cond_t *cond) {
 	xuint32 num_wake = 0;
 
-	xuintptr cidx = (*cond);
-	xg_thread_cond_t *fcond = NULL;
+	xg_thread_cond_t *fcond = xg_tcond_get(cond);
 
-	if (cidx > XCFG_COND_MAX) {
-		return XI_MUTEX_RV_ERR_ARGS;
+	if (fcond == NULL) {
+		return XI_COND_RV_ERR_ARGS;
 	}
 
-	fcond = &(_g_thr_conds.conds[cidx]);
-
 	EnterCriticalSection(&fcond->csec);
 	if (fcond->nwait > fcond->nwake) {
 		num_wake = fcond->nwait - fcond->nwake;
@@ -415,15 +311,12 @@ xi_thread_cond_re xi_thread_cond_broadcast(xi_thread_cond_t *cond) {
 xi_thread_cond_re xi_thread_cond_signal(xi_thread_cond_t *cond) {
 	xuint32 wake = 0;
 
-	xuintptr cidx = (*cond);
-	xg_thread_cond_t *fcond = NULL;
+	xg_thread_cond_t *fcond = xg_tcond_get(cond);
 
-	if (cidx > XCFG_COND_MAX) {
-		return XI_MUTEX_RV_ERR_ARGS;
+	if (fcond == NULL) {
+		return XI_COND_RV_ERR_ARGS;
 	}
 
-	fcond = &(_g_thr_conds.conds[cidx]);
-
 	EnterCriticalSection(&fcond->csec);
 	if (fcond->nwait > fcond->nwake) {
 		wake = 1;
@@ -441,22 +334,235 @@ xi_thread_cond_re xi_thread_cond_signal(xi_thread_cond_t *cond) {
 
 xi_thread_cond_re xi_thread_cond_destroy(xi_thread_cond_t *cond) {
 	xbool ret;
-	xuintptr cidx = (*cond);
-	xg_thread_cond_t *fcond = NULL;
+	xg_thread_cond_t *fcond = xg_tcond_get(cond);
 
-	if (cidx > XCFG_COND_MAX) {
-		return XI_MUTEX_RV_ERR_ARGS;
+	if (fcond == NULL) {
+		return XI_COND_RV_ERR_ARGS;
 	}
 
-	fcond = &(_g_thr_conds.conds[cidx]);
-
 	ret = CloseHandle(fcond->cond);
 	if (!ret) {
 		return XI_COND_RV_ERR_BUSY;
 	}
 
 	DeleteCriticalSection(&fcond->csec);
-	xg_tcond_free(cidx);
+	xi_mem_free(fcond);
+	xi_atomic_sub32(&_g_thr_conds, 1);
+	(*cond) = (xi_thread_cond_t)-1;
 
 	return XI_COND_RV_OK;
 }
+
+//------------
+// RWLock
+//------------
+
+xi_thread_rwlock_re xi_thread_rwlock_create(xi_thread_rwlock_t *rwlock, xchar *rname) {
+	xg_thread_rwlock_t *frw;
+
+	(*rwlock) = (xi_thread_rwlock_t)-1;
+
+	frw = (xg_thread_rwlock_t *) xi_mem_alloc(sizeof(xg_thread_rwlock_t));
+	if (frw == NULL) {
+		log_error(XDLOG, "Cannot create rwlock : [%s]!!!\n", rname);
+		return XI_RWLOCK_RV_ERR_NOMEM;
+	}
+
+	InitializeSRWLock(&frw->lock);
+	frw->wlocked = FALSE;
+
+	xi_strncpy(frw->oname, rname, (XCFG_ONAME_MAX - 1));
+	frw->oname[XCFG_ONAME_MAX - 1] = '\0';
+	(*rwlock) = (xi_thread_rwlock_t) frw;
+
+	return XI_RWLOCK_RV_OK;
+}
+
+xi_thread_rwlock_re xi_thread_rwlock_rdlock(xi_thread_rwlock_t *rwlock) {
+	xg_thread_rwlock_t *frw = xg_trwlock_get(rwlock);
+
+	if (frw == NULL) {
+		return XI_RWLOCK_RV_ERR_ARGS;
+	}
+
+	AcquireSRWLockShared(&frw->lock);
+
+	return XI_RWLOCK_RV_OK;
+}
+
+xi_thread_rwlock_re xi_thread_rwlock_tryrdlock(xi_thread_rwlock_t *rwlock) {
+	xg_thread_rwlock_t *frw = xg_trwlock_get(rwlock);
+
+	if (frw == NULL) {
+		return XI_RWLOCK_RV_ERR_ARGS;
+	}
+
+	if (TryAcquireSRWLockShared(&frw->lock)) {
+		return XI_RWLOCK_RV_OK;
+	} else {
+		return XI_RWLOCK_RV_ERR_BUSY;
+	}
+}
+
+xi_thread_rwlock_re xi_thread_rwlock_wrlock(xi_thread_rwlock_t *rwlock) {
+	xg_thread_rwlock_t *frw = xg_trwlock_get(rwlock);
+
+	if (frw == NULL) {
+		return XI_RWLOCK_RV_ERR_ARGS;
+	}
+
+	AcquireSRWLockExclusive(&frw->lock);
+	frw->wlocked = TRUE;
+
+	return XI_RWLOCK_RV_OK;
+}
+
+xi_thread_rwlock_re xi_thread_rwlock_trywrlock(xi_thread_rwlock_t *rwlock) {
+	xg_thread_rwlock_t *frw = xg_trwlock_get(rwlock);
+
+	if (frw == NULL) {
+		return XI_RWLOCK_RV_ERR_ARGS;
+	}
+
+	if (TryAcquireSRWLockExclusive(&frw->lock)) {
+		frw->wlocked = TRUE;
+		return XI_RWLOCK_RV_OK;
+	} else {
+		return XI_RWLOCK_RV_ERR_BUSY;
+	}
+}
+
+xi_thread_rwlock_re xi_thread_rwlock_unlock(xi_thread_rwlock_t *rwlock) {
+	xg_thread_rwlock_t *frw = xg_trwlock_get(rwlock);
+
+	if (frw == NULL) {
+		return XI_RWLOCK_RV_ERR_ARGS;
+	}
+
+	// no reader can hold the lock while wlocked is set
+	if (frw->wlocked) {
+		frw->wlocked = FALSE;
+		ReleaseSRWLockExclusive(&frw->lock);
+	} else {
+		ReleaseSRWLockShared(&frw->lock);
+	}
+
+	return XI_RWLOCK_RV_OK;
+}
+
+xi_thread_rwlock_re xi_thread_rwlock_destroy(xi_thread_rwlock_t *rwlock) {
+	xg_thread_rwlock_t *frw = xg_trwlock_get(rwlock);
+
+	if (frw == NULL) {
+		return XI_RWLOCK_RV_ERR_ARGS;
+	}
+
+	xi_mem_free(frw);
+	(*rwlock) = (xi_thread_rwlock_t)-1;
+
+	return XI_RWLOCK_RV_OK;
+}
+
+//------------
+// SeqLock
+//------------
+
+xi_thread_seqlock_re xi_thread_seqlock_create(xi_thread_seqlock_t *seqlock, xchar *sname) {
+	xg_thread_seqlock_t *fseq;
+
+	(*seqlock) = (xi_thread_seqlock_t)-1;
+
+	fseq = (xg_thread_seqlock_t *) xi_mem_alloc(sizeof(xg_thread_seqlock_t));
+	if (fseq == NULL) {
+		log_error(XDLOG, "Cannot create seqlock : [%s]!!!\n", sname);
+		return XI_SEQLOCK_RV_ERR_NOMEM;
+	}
+
+	if (!InitializeCriticalSectionAndSpinCount(&fseq->wlock, XG_MUTEX_SPIN)) {
+		xi_mem_free(fseq);
+		return XI_SEQLOCK_RV_ERR_NOMEM;
+	}
+
+	fseq->seq = 0;
+	xi_strncpy(fseq->oname, sname, (XCFG_ONAME_MAX - 1));
+	fseq->oname[XCFG_ONAME_MAX - 1] = '\0';
+	(*seqlock) = (xi_thread_seqlock_t) fseq;
+
+	return XI_SEQLOCK_RV_OK;
+}
+
+xi_thread_seqlock_re xi_thread_seqlock_lock(xi_thread_seqlock_t *seqlock) {
+	xg_thread_seqlock_t *fseq = xg_tseqlock_get(seqlock);
+
+	if (fseq == NULL) {
+		return XI_SEQLOCK_RV_ERR_ARGS;
+	}
+
+	EnterCriticalSection(&fseq->wlock);
+	InterlockedIncrement(&fseq->seq); // full barrier
+
+	return XI_SEQLOCK_RV_OK;
+}
+
+xi_thread_seqlock_re xi_thread_seqlock_unlock(xi_thread_seqlock_t *seqlock) {
+	xg_thread_seqlock_t *fseq = xg_tseqlock_get(seqlock);
+
+	if (fseq == NULL) {
+		return XI_SEQLOCK_RV_ERR_ARGS;
+	}
+
+	InterlockedIncrement(&fseq->seq); // full barrier
+	LeaveCriticalSection(&fseq->wlock);
+
+	return XI_SEQLOCK_RV_OK;
+}
+
+xuint32 xi_thread_seqlock_read_begin(xi_thread_seqlock_t *seqlock) {
+	xuint32 seq;
+	xint32 spin = 0;
+	xg_thread_seqlock_t *fseq = xg_tseqlock_get(seqlock);
+
+	if (fseq == NULL) {
+		return 0;
+	}
+
+	for (;;) {
+		seq = (xuint32) fseq->seq;
+		if ((seq & 1) == 0) {
+			break;
+		}
+		if (++spin >= XG_SEQLOCK_SPIN) {
+			SwitchToThread();
+			spin = 0;
+		}
+	}
+	MemoryBarrier(); // the sequence is read before the data
+
+	return seq;
+}
+
+xbool xi_thread_seqlock_read_retry(xi_thread_seqlock_t *seqlock, xuint32 seq) {
+	xg_thread_seqlock_t *fseq = xg_tseqlock_get(seqlock);
+
+	if (fseq == NULL) {
+		return FALSE;
+	}
+
+	MemoryBarrier(); // the data is read before the sequence
+
+	return ((xuint32) fseq->seq != seq);
+}
+
+xi_thread_seqlock_re xi_thread_seqlock_destroy(xi_thread_seqlock_t *seqlock) {
+	xg_thread_seqlock_t *fseq = xg_tseqlock_get(seqlock);
+
+	if (fseq == NULL) {
+		return XI_SEQLOCK_RV_ERR_ARGS;
+	}
+
+	DeleteCriticalSection(&fseq->wlock);
+	xi_mem_free(fseq);
+	(*seqlock) = (xi_thread_seqlock_t)-1;
+
+	return XI_SEQLOCK_RV_OK;
+}
@@ -48,26 +48,40 @@ int tc_pre();
 //            XI Test-Case           //
 ///////////////////////////////////////
 
+int tc_xi_aio();
 int tc_xi_arrays();
 int tc_xi_base64();
 int tc_xi_clock();
 int tc_xi_ctype();
 int tc_xi_dso();
 int tc_xi_env();
+int tc_xi_evloop_echosrv();
+int tc_xi_evloop_loop();
 int tc_xi_file_dop();
 int tc_xi_file_fop();
+int tc_xi_file_xfer();
+int tc_xi_file_pio();
 int tc_xi_hashtb();
+int tc_xi_hashtb_conc();
 int tc_xi_log();
+int tc_xi_log_min();
 int tc_xi_mem();
+int tc_xi_mem_pool();
 int tc_xi_poll_echosrv();
+int tc_xi_poll_trig();
 int tc_xi_proc();
+int tc_xi_queue();
 int tc_xi_select_echosrv();
 int tc_xi_socket_basic();
+int tc_xi_socket_bin();
+int tc_xi_socket_lgroup();
 int tc_xi_socket_mcast();
 int tc_xi_sysinfo();
 int tc_xi_thread_basic();
 int tc_xi_thread_java();
+int tc_xi_thread_lock();
 int tc_xi_thread_stress();
+int tc_xi_timer();
 
 /**
  * End Declaration
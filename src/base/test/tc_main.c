@@ -57,18 +57,32 @@ int main(int argc, char **argv) {
 	printf("--------------------------------------------------------------\n");
 
 	XI_TC_TEST(tc_xi_log());
+	XI_TC_TEST(tc_xi_log_min());
 	XI_TC_TEST(tc_xi_mem());
+	XI_TC_TEST(tc_xi_mem_pool());
 	XI_TC_TEST(tc_xi_hashtb());
+	XI_TC_TEST(tc_xi_hashtb_conc());
 	XI_TC_TEST(tc_xi_clock());
+	XI_TC_TEST(tc_xi_timer());
 	XI_TC_TEST(tc_xi_thread_basic());
 	XI_TC_TEST(tc_xi_thread_java());
+	XI_TC_TEST(tc_xi_thread_lock());
+	XI_TC_TEST(tc_xi_queue());
 	XI_TC_TEST(tc_xi_thread_stress());
 	XI_TC_TEST(tc_xi_dso());
 	XI_TC_TEST(tc_xi_file_fop());
 	XI_TC_TEST(tc_xi_file_dop());
+	XI_TC_TEST(tc_xi_file_xfer());
+	XI_TC_TEST(tc_xi_file_pio());
+	XI_TC_TEST(tc_xi_aio());
 	XI_TC_TEST(tc_xi_socket_basic());
+	XI_TC_TEST(tc_xi_socket_bin());
+	XI_TC_TEST(tc_xi_socket_lgroup());
 	XI_TC_TEST(tc_xi_socket_mcast());
+	XI_TC_TEST(tc_xi_poll_trig());
 	XI_TC_TEST(tc_xi_poll_echosrv());
+	XI_TC_TEST(tc_xi_evloop_loop());
+	XI_TC_TEST(tc_xi_evloop_echosrv());
 	XI_TC_TEST(tc_xi_select_echosrv());
 	XI_TC_TEST(tc_xi_arrays());
 	XI_TC_TEST(tc_xi_base64());
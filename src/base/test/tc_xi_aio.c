@@ -0,0 +1,339 @@
+/*
+ * Copyright 2013 Cheolmin Jo (webos21@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * File : tc_xi_aio.c
+ */
+
+#include "xi/xi_aio.h"
+
+#include "xi/xi_clock.h"
+#include "xi/xi_log.h"
+#include "xi/xi_mem.h"
+#include "xi/xi_poll.h"
+#include "xi/xi_string.h"
+
+#define TC_AIO_BLOCKS  64
+#define TC_AIO_BSIZE   4096
+#define TC_AIO_DEPTH   32
+#define TC_AIO_FILE    "aio_test.dat"
+
+static xchar _g_blk[TC_AIO_BLOCKS][TC_AIO_BSIZE];
+static xi_aio_req_t _g_req[TC_AIO_BLOCKS];
+
+static xint32 _g_done;
+static xint32 _g_errors;
+
+static xvoid tc_aio_done(xi_aio_t *aio, xi_aio_req_t *req) {
+	UNUSED(aio);
+	if (req->op != XI_AIO_OP_ACCEPT && req->res != (xssize) req->len) {
+		_g_errors++;
+	}
+	_g_done++;
+}
+
+static xvoid tc_aio_prep(xi_aio_req_t *req, xi_aio_op_e op, xint32 fd,
+		xvoid *buf, xsize len, xoff64 off) {
+	xi_mem_set(req, 0, sizeof(*req));
+	req->op = op;
+	req->fd = fd;
+	req->buf = buf;
+	req->len = len;
+	req->off = off;
+	req->func = tc_aio_done;
+}
+
+// submit all of reqs, keeping at most the depth in flight
+static xint32 tc_aio_run(xi_aio_t *aio, xi_aio_req_t *reqs, xint32 nreqs) {
+	xi_aio_req_t *batch[TC_AIO_BLOCKS];
+	xint32 i, sent = 0, ret;
+
+	_g_done = 0;
+	_g_errors = 0;
+	for (i = 0; i < nreqs; i++) {
+		batch[i] = &reqs[i];
+	}
+
+	while (_g_done < nreqs) {
+		if (sent < nreqs) {
+			ret = xi_aio_submit(aio, &batch[sent], nreqs - sent);
+			if (ret > 0) {
+				sent += ret;
+			} else if (ret != XI_AIO_RV_ERR_FULL) {
+				return ret;
+			}
+		}
+		if (xi_aio_complete(aio, 1000) == XI_AIO_RV_ERR_TIMEOUT) {
+			return XI_AIO_RV_ERR_TIMEOUT;
+		}
+	}
+
+	return _g_errors;
+}
+
+static xint32 tc_aio_file(xi_aio_t *aio) {
+	xint32 i, j, fd, ret;
+
+	xi_file_remove(TC_AIO_FILE);
+	fd = xi_file_open(TC_AIO_FILE, XI_FILE_MODE_READ | XI_FILE_MODE_WRITE
+			| XI_FILE_MODE_CREATE, 0644);
+	if (fd < 0) {
+		return fd;
+	}
+
+	// write in the reverse order by offset
+	for (i = 0; i < TC_AIO_BLOCKS; i++) {
+		xi_mem_set(_g_blk[i], 'A' + (i % 26), TC_AIO_BSIZE);
+		tc_aio_prep(&_g_req[i], XI_AIO_OP_WRITE, fd, _g_blk[i], TC_AIO_BSIZE,
+				(xoff64) (TC_AIO_BLOCKS - 1 - i) * TC_AIO_BSIZE);
+	}
+	ret = tc_aio_run(aio, _g_req, TC_AIO_BLOCKS);
+	if (ret != 0) {
+		xi_file_close(fd);
+		return ret;
+	}
+
+	tc_aio_prep(&_g_req[0], XI_AIO_OP_FSYNC, fd, NULL, 0, 0);
+	_g_req[0].flags = XI_AIO_FSYNC_DATA;
+	ret = tc_aio_run(aio, _g_req, 1);
+	if (ret != 0) {
+		xi_file_close(fd);
+		return ret;
+	}
+
+	for (i = 0; i < TC_AIO_BLOCKS; i++) {
+		xi_mem_set(_g_blk[i], 0, TC_AIO_BSIZE);
+		tc_aio_prep(&_g_req[i], XI_AIO_OP_READ, fd, _g_blk[i], TC_AIO_BSIZE,
+				(xoff64) i * TC_AIO_BSIZE);
+	}
+	ret = tc_aio_run(aio, _g_req, TC_AIO_BLOCKS);
+	xi_file_close(fd);
+	if (ret != 0) {
+		return ret;
+	}
+	for (i = 0; i < TC_AIO_BLOCKS; i++) {
+		xchar expect = 'A' + ((TC_AIO_BLOCKS - 1 - i) % 26);
+		for (j = 0; j < TC_AIO_BSIZE; j++) {
+			if (_g_blk[i][j] != expect) {
+				return -100 - i;
+			}
+		}
+	}
+
+	return 0;
+}
+
+static xint32 tc_aio_socket(xi_aio_t *aio) {
+	xint32 lsn, clt, svr = -1, ret;
+	xchar buf[16];
+	xi_sock_addr_t addr = { XI_SOCK_FAMILY_INET, XI_SOCK_TYPE_STREAM,
+			XI_SOCK_PROTO_TCP, { '\0' }, 0 };
+	xi_sock_addr_bin_t baddr;
+	xi_aio_req_t *preq;
+
+	xi_strcpy(addr.host, "127.0.0.1");
+	xi_socket_addr_pton(&addr, &baddr);
+	lsn = xi_socket_open(XI_SOCK_FAMILY_INET, XI_SOCK_TYPE_STREAM,
+			XI_SOCK_PROTO_TCP);
+	clt = xi_socket_open(XI_SOCK_FAMILY_INET, XI_SOCK_TYPE_STREAM,
+			XI_SOCK_PROTO_TCP);
+	if (lsn < 0 || clt < 0 || xi_socket_bind_bin(lsn, &baddr) != XI_SOCK_RV_OK
+			|| xi_socket_listen(lsn, 4) != XI_SOCK_RV_OK
+			|| xi_socket_get_local_bin(lsn, &baddr) != XI_SOCK_RV_OK) {
+		return -1;
+	}
+
+	// accept is in flight before the connection comes
+	tc_aio_prep(&_g_req[0], XI_AIO_OP_ACCEPT, lsn, NULL, 0, 0);
+	_g_req[0].flags = XI_SOCK_ACCEPT_CLOEXEC;
+	preq = &_g_req[0];
+	_g_done = 0;
+	if (xi_aio_submit(aio, &preq, 1) != 1
+			|| xi_socket_connect_bin(clt, &baddr) != XI_SOCK_RV_OK) {
+		return -2;
+	}
+	while (_g_done == 0) {
+		if (xi_aio_complete(aio, 1000) == XI_AIO_RV_ERR_TIMEOUT) {
+			return -3;
+		}
+	}
+	svr = (xint32) _g_req[0].res;
+	if (svr < 0) {
+		return -4;
+	}
+
+	// recv is in flight before the data comes
+	tc_aio_prep(&_g_req[0], XI_AIO_OP_RECV, svr, buf, 5, 0);
+	tc_aio_prep(&_g_req[1], XI_AIO_OP_SEND, svr, "world", 5, 0);
+	_g_done = 0;
+	_g_errors = 0;
+	if (xi_aio_submit(aio, &preq, 1) != 1
+			|| xi_socket_send(clt, "hello", 5) != 5) {
+		return -5;
+	}
+	while (_g_done == 0) {
+		if (xi_aio_complete(aio, 1000) == XI_AIO_RV_ERR_TIMEOUT) {
+			return -6;
+		}
+	}
+	if (_g_req[0].res != 5 || xi_mem_cmp(buf, "hello", 5) != 0) {
+		return -7;
+	}
+
+	ret = tc_aio_run(aio, &_g_req[1], 1);
+	if (ret != 0 || xi_socket_recv(clt, buf + 8, 5) != 5
+			|| xi_mem_cmp(buf + 8, "world", 5) != 0) {
+		return -8;
+	}
+
+	xi_socket_close(svr);
+	xi_socket_close(clt);
+	xi_socket_close(lsn);
+
+	return 0;
+}
+
+static xint64 tc_aio_bench(xi_aio_t *aio) {
+	xint32 i, fd, ret;
+	xint64 start;
+
+	fd = xi_file_open(TC_AIO_FILE, XI_FILE_MODE_READ, 0644);
+	if (fd < 0) {
+		return -1;
+	}
+	for (i = 0; i < TC_AIO_BLOCKS; i++) {
+		tc_aio_prep(&_g_req[i], XI_AIO_OP_READ, fd, _g_blk[i], TC_AIO_BSIZE,
+				(xoff64) i * TC_AIO_BSIZE);
+	}
+	start = xi_clock_ntick();
+	for (i = 0; i < 16; i++) {
+		ret = tc_aio_run(aio, _g_req, TC_AIO_BLOCKS);
+		if (ret != 0) {
+			xi_file_close(fd);
+			return -1;
+		}
+	}
+	xi_file_close(fd);
+
+	return (xi_clock_ntick() - start) / 16;
+}
+
+static void tc_info() {
+	log_print(XDLOG, "====================================================\n");
+	log_print(XDLOG, "                     xi_aio.h\n");
+	log_print(XDLOG, "----------------------------------------------------\n");
+	log_print(XDLOG, " * Functions)\n");
+	log_print(XDLOG, "   - xi_aio_create / destroy\n");
+	log_print(XDLOG, "   - xi_aio_submit / complete / pending\n");
+	log_print(XDLOG, "   - xi_aio_backend / fd\n");
+	log_print(XDLOG, "====================================================\n\n");
+}
+
+int tc_xi_aio() {
+	xint32 t = 1;
+	xchar *tcname = "xi_aio.h";
+
+	xint32 i, ret;
+	xint64 ns[2];
+	xi_aio_t *aio[2];
+	xi_aio_req_t *preq;
+	xi_pollset_t *pset;
+	xi_pollfd_t pfd;
+	static const xchar *bname[] = { "?", "threads", "io_uring" };
+
+	tc_info();
+
+	log_print(XDLOG, "[%s:%02d] xi_aio_create ###############\n", tcname, t++);
+	aio[0] = xi_aio_create(TC_AIO_DEPTH, 0, 0);
+	aio[1] = xi_aio_create(TC_AIO_DEPTH, 2, XI_AIO_OPT_THREADS);
+	if (aio[0] == NULL || aio[1] == NULL
+			|| xi_aio_backend(aio[1]) != XI_AIO_BACKEND_THREADS) {
+		log_print(XDLOG, "    - result : failed!!!\n\n");
+		return -1;
+	}
+	log_print(XDLOG, "    - result : pass. (default=%s)\n\n",
+			bname[xi_aio_backend(aio[0])]);
+
+	for (i = 0; i < 2; i++) {
+		log_print(XDLOG, "[%s:%02d] file batch (%s) ########\n", tcname, t++,
+				bname[xi_aio_backend(aio[i])]);
+		ret = tc_aio_file(aio[i]);
+		if (ret != 0) {
+			log_print(XDLOG, "    - result : failed!!! (ret=%d)\n\n", ret);
+			return -1;
+		}
+		log_print(XDLOG, "    - result : pass.\n\n");
+
+		log_print(XDLOG, "[%s:%02d] accept/recv/send (%s) ##\n", tcname, t++,
+				bname[xi_aio_backend(aio[i])]);
+		ret = tc_aio_socket(aio[i]);
+		if (ret != 0) {
+			log_print(XDLOG, "    - result : failed!!! (ret=%d)\n\n", ret);
+			return -1;
+		}
+		log_print(XDLOG, "    - result : pass.\n\n");
+	}
+
+	log_print(XDLOG, "[%s:%02d] xi_aio_fd in pollset ########\n", tcname, t++);
+	pset = xi_pollset_create(4, 0);
+	pfd.desc = xi_aio_fd(aio[0]);
+	pfd.evts = XI_POLL_EVENT_IN;
+	pfd.context = aio[0];
+	if (pset == NULL || xi_pollset_add(pset, pfd) != XI_POLLSET_RV_OK) {
+		log_print(XDLOG, "    - result : failed!!! (pollset)\n\n");
+		return -1;
+	}
+	i = xi_file_open(TC_AIO_FILE, XI_FILE_MODE_READ, 0644);
+	tc_aio_prep(&_g_req[0], XI_AIO_OP_READ, i, _g_blk[0], TC_AIO_BSIZE, 0);
+	preq = &_g_req[0];
+	_g_done = 0;
+	_g_errors = 0;
+	if (xi_aio_submit(aio[0], &preq, 1) != 1
+			|| xi_pollset_poll(pset, &pfd, 1, 1000) != 1
+			|| pfd.context != aio[0]
+			|| xi_aio_complete(aio[0], 0) != 1 || _g_done != 1 || _g_errors != 0
+			|| xi_aio_pending(aio[0]) != 0) {
+		log_print(XDLOG, "    - result : failed!!!\n\n");
+		return -1;
+	}
+	xi_file_close(i);
+	xi_pollset_destroy(pset);
+	log_print(XDLOG, "    - result : pass.\n\n");
+
+	log_print(XDLOG, "[%s:%02d] %d x %d bytes reads ########\n", tcname, t++,
+			TC_AIO_BLOCKS, TC_AIO_BSIZE);
+	ns[0] = tc_aio_bench(aio[0]);
+	ns[1] = tc_aio_bench(aio[1]);
+	if (ns[0] < 0 || ns[1] < 0) {
+		log_print(XDLOG, "    - result : failed!!!\n\n");
+		return -1;
+	}
+	log_print(XDLOG, "    - result : pass. (%s=%lld us, threads=%lld us)\n\n",
+			bname[xi_aio_backend(aio[0])], ns[0] / 1000, ns[1] / 1000);
+
+	log_print(XDLOG, "[%s:%02d] xi_aio_destroy ##############\n", tcname, t++);
+	if (xi_aio_destroy(aio[0]) != XI_AIO_RV_OK
+			|| xi_aio_destroy(aio[1]) != XI_AIO_RV_OK) {
+		log_print(XDLOG, "    - result : failed!!!\n\n");
+		return -1;
+	}
+	xi_file_remove(TC_AIO_FILE);
+	log_print(XDLOG, "    - result : pass.\n\n");
+
+	log_print(XDLOG, "============ DONE [xi_aio.h] ============\n\n");
+
+	return 0;
+}
@@ -21,7 +21,9 @@
 #include "xi/xi_clock.h"
 
 #include "xi/xi_log.h"
-#include "xi/xi_clock.h"
+#include "xi/xi_thread.h"
+
+#define TC_CLOCK_LOOP  1000000
 
 static void tc_info() {
 	log_print(XDLOG, "\n\n");
@@ -31,6 +33,10 @@ static void tc_info() {
 	log_print(XDLOG, " * Functions)\n");
 	log_print(XDLOG, "   - xi_clock_msec\n");
 	log_print(XDLOG, "   - xi_clock_ntick\n");
+	log_print(XDLOG, "   - xi_clock_ntick_coarse\n");
+	log_print(XDLOG, "   - xi_clock_cycles\n");
+	log_print(XDLOG, "   - xi_clock_cycles_hz\n");
+	log_print(XDLOG, "   - xi_clock_cycles2nsec\n");
 	log_print(XDLOG, "   - xi_clock_gettime\n");
 	log_print(XDLOG, "   - xi_clock_settime\n");
 	log_print(XDLOG, "   - xi_clock_get_tz\n");
@@ -49,6 +55,9 @@ int tc_xi_clock() {
 
 	xi_time_t t1, t2;
 	xint64 tick1, tick2;
+	xint64 elapsed, coarse, precise;
+	xuint64 hz, cyc1, cyc2;
+	xint32 i;
 
 	tc_info();
 
@@ -71,6 +80,65 @@ int tc_xi_clock() {
 	}
 	log_print(XDLOG, "    - result : pass. (tick2=%lld)\n\n", tick2);
 
+	log_print(XDLOG, "[%s:%02d] xi_clock_ntick_coarse #######\n", tcname, t++);
+	tick1 = xi_clock_ntick_coarse();
+	xi_thread_sleep(30);
+	tick2 = xi_clock_ntick_coarse();
+	elapsed = xi_clock_ntick() - xi_clock_ntick_coarse();
+	// it lags behind xi_clock_ntick by a scheduler tick at most
+	if (tick1 <= 0 || tick2 - tick1 < 10000000LL || elapsed < -20000000LL
+			|| elapsed > 20000000LL) {
+		log_print(XDLOG, "    - result : failed!!! (diff=%lld, lag=%lld)\n\n",
+				tick2 - tick1, elapsed);
+		return -1;
+	}
+	log_print(XDLOG, "    - result : pass. (30ms=%lld ns, lag=%lld ns)\n\n",
+			tick2 - tick1, elapsed);
+
+	log_print(XDLOG, "[%s:%02d] xi_clock_cycles_hz ##########\n", tcname, t++);
+	hz = xi_clock_cycles_hz();
+	if (hz == 0) {
+		log_print(XDLOG, "    - result : failed!!!\n\n");
+		return -1;
+	}
+	log_print(XDLOG, "    - result : pass. (hz=%llu)\n\n", hz);
+
+	log_print(XDLOG, "[%s:%02d] xi_clock_cycles2nsec ########\n", tcname, t++);
+	tick1 = xi_clock_ntick();
+	cyc1 = xi_clock_cycles();
+	xi_thread_sleep(20);
+	cyc2 = xi_clock_cycles();
+	tick2 = xi_clock_ntick();
+	elapsed = xi_clock_cycles2nsec(cyc2 - cyc1);
+	if (cyc2 <= cyc1 || elapsed > (tick2 - tick1)
+			|| elapsed < (tick2 - tick1) * 9 / 10) {
+		log_print(XDLOG, "    - result : failed!!! (cycles=%lld ns, ntick=%lld ns)\n\n",
+				elapsed, tick2 - tick1);
+		return -1;
+	}
+	log_print(XDLOG, "    - result : pass. (cycles=%lld ns, ntick=%lld ns)\n\n",
+			elapsed, tick2 - tick1);
+
+	log_print(XDLOG, "[%s:%02d] Cost of a reading ###########\n", tcname, t++);
+	tick1 = xi_clock_ntick();
+	for (i = 0; i < TC_CLOCK_LOOP; i++) {
+		xi_clock_ntick();
+	}
+	precise = xi_clock_ntick() - tick1;
+	tick1 = xi_clock_ntick();
+	for (i = 0; i < TC_CLOCK_LOOP; i++) {
+		xi_clock_ntick_coarse();
+	}
+	coarse = xi_clock_ntick() - tick1;
+	tick1 = xi_clock_ntick();
+	for (i = 0; i < TC_CLOCK_LOOP; i++) {
+		xi_clock_cycles();
+	}
+	elapsed = xi_clock_ntick() - tick1;
+	log_print(XDLOG, "    - result : pass. (ntick=%lld ns, coarse=%lld ns, cycles=%lld ns)\n\n",
+			precise / TC_CLOCK_LOOP, coarse / TC_CLOCK_LOOP,
+			elapsed / TC_CLOCK_LOOP);
+
 	log_print(XDLOG, "[%s:%02d] xi_clock_gettime ############\n", tcname, t++);
 	ret = xi_clock_gettime(&t1);
 	if (ret != XI_CLOCK_RV_OK) {
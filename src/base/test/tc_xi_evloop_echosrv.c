@@ -0,0 +1,213 @@
+/*
+ * Copyright 2013 Cheolmin Jo (webos21@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * File : tc_xi_evloop_echosrv.c
+ */
+
+#include "xi/xtype.h"
+#include "xi/xi_atomic.h"
+#include "xi/xi_evloop.h"
+#include "xi/xi_log.h"
+#include "xi/xi_mem.h"
+#include "xi/xi_socket.h"
+#include "xi/xi_string.h"
+#include "xi/xi_thread.h"
+
+#define TC_EVLOOP_THREADS   4
+
+static volatile xuint32 _g_run = TRUE;
+static volatile xuint32 _g_client_num = 0;
+
+/* Connection Control Block (ccb) */
+struct ccb {
+	xchar			 buf[1024];
+	xssize			 buflen;
+};
+
+static xvoid tc_client_close(xi_evloop_t *loop, xint32 idx, xint32 desc,
+		struct ccb *ccbp) {
+	xi_evloop_remove(loop, idx, desc);
+	xi_socket_close(desc);
+	xi_mem_free(ccbp);
+
+	xi_atomic_sub32(&_g_client_num, 1);
+	if (xi_atomic_read32(&_g_client_num) == 0) {
+		log_print(XDLOG, "All clients have been disconnected. Exit this echo server.\n\n");
+		_g_run = FALSE;
+	}
+}
+
+static xvoid tc_client_io(xi_evloop_t *loop, xint32 idx, xint32 desc,
+		xint32 evts, xvoid *arg) {
+	xssize ret;
+	struct ccb *ccbp = (struct ccb *)arg;
+
+	if (evts & XI_POLL_EVENT_OUT) {
+		ret = xi_socket_send(desc, ccbp->buf, (xsize)ccbp->buflen);
+		if (ret < 0) {
+			log_error(XDLOG, "[loop %d] Failed to send to the socket: %d\n", idx, ret);
+			tc_client_close(loop, idx, desc, ccbp);
+			return;
+		}
+		log_print(XDLOG, "[loop %d] sent: %d bytes\n", idx, ret);
+
+		// disable write, enable read
+		xi_evloop_modify(loop, idx, desc, XI_POLL_EVENT_IN);
+		return;
+	}
+
+	ccbp->buflen = xi_socket_recv(desc, ccbp->buf, sizeof(ccbp->buf));
+	if (ccbp->buflen < 0) {
+		log_error(XDLOG, "[loop %d] Failed to recv from the socket: %d\n", idx, ccbp->buflen);
+		tc_client_close(loop, idx, desc, ccbp);
+		return;
+	} else if (ccbp->buflen == 0) {
+		log_print(XDLOG, "[loop %d] EOF! Disconnected. Close the client socket\n", idx);
+		tc_client_close(loop, idx, desc, ccbp);
+		return;
+	}
+	log_print(XDLOG, "[loop %d] received: %d bytes\n", idx, ccbp->buflen);
+
+	// disable read, enable write
+	xi_evloop_modify(loop, idx, desc, XI_POLL_EVENT_OUT);
+}
+
+static xvoid tc_client_accept(xi_evloop_t *loop, xint32 idx, xint32 csock,
+		xvoid *arg) {
+	xi_evloop_re ret;
+	struct ccb *ccbp;
+
+	UNUSED(arg);
+
+	ccbp = xi_mem_calloc(1, sizeof(struct ccb));
+	if (ccbp == NULL) {
+		log_error(XDLOG, "Failed to allocate a ccb!\n");
+		xi_socket_close(csock);
+		return;
+	}
+
+	log_print(XDLOG, "[loop %d] register client> clisock: %d\n", idx, csock);
+	ret = xi_evloop_add(loop, idx, csock, XI_POLL_EVENT_IN, tc_client_io, ccbp);
+	if (ret != XI_EVLOOP_RV_OK) {
+		log_error(XDLOG, "[loop %d] Failed to register a client: %d\n", idx, ret);
+		xi_socket_close(csock);
+		xi_mem_free(ccbp);
+		return;
+	}
+
+	xi_atomic_inc32(&_g_client_num);
+}
+
+static xint32 tc_start_server(xi_sock_t srvsock) {
+	xint32 ret;
+	xi_evloop_t *loop;
+
+	// create an event-loop
+	loop = xi_evloop_create(TC_EVLOOP_THREADS, 64);
+	if (loop == NULL) {
+		log_error(XDLOG, "Failed to create an event-loop!!\n");
+		xi_socket_close(srvsock);
+		return -1;
+	}
+
+	// accept on the first loop thread
+	ret = xi_evloop_listen(loop, srvsock, tc_client_accept, NULL);
+	if (ret == XI_EVLOOP_RV_OK) {
+		ret = xi_evloop_start(loop);
+	}
+	if (ret != XI_EVLOOP_RV_OK) {
+		log_error(XDLOG, "Failed to start the event-loop: %d\n", ret);
+		xi_evloop_destroy(loop);
+		xi_socket_close(srvsock);
+		return -1;
+	}
+
+	log_print(XDLOG, "\nThe echo server is running with %d loop threads. Connect to the port 56790\n",
+			xi_evloop_count(loop));
+
+	while (_g_run) {
+		xi_thread_sleep(100);
+	}
+
+    // cleanup resources
+	xi_evloop_stop(loop);
+	xi_evloop_destroy(loop);
+    xi_socket_close(srvsock);
+
+	log_print(XDLOG, "============ DONE [xi_evloop.h - echo server] ============\n\n");
+
+    return 0;
+}
+
+static xvoid tc_info() {
+	log_print(XDLOG, "====================================================\n");
+	log_print(XDLOG, "                      xi_evloop.h - echo server\n");
+	log_print(XDLOG, "----------------------------------------------------\n");
+	log_print(XDLOG, " * Functions)\n");
+	log_print(XDLOG, "   - xi_evloop_create\n");
+	log_print(XDLOG, "   - xi_evloop_listen\n");
+	log_print(XDLOG, "   - xi_evloop_start\n");
+	log_print(XDLOG, "   - xi_evloop_add\n");
+	log_print(XDLOG, "   - xi_evloop_modify\n");
+	log_print(XDLOG, "   - xi_evloop_remove\n");
+	log_print(XDLOG, "   - xi_evloop_stop\n");
+	log_print(XDLOG, "   - xi_evloop_destroy\n");
+	log_print(XDLOG, "====================================================\n\n");
+}
+
+xint32 tc_xi_evloop_echosrv() {
+	xint32 ret;
+	xi_sock_t srvsock;
+    xi_sock_addr_t lsnaddr = {XI_SOCK_FAMILY_INET, XI_SOCK_TYPE_STREAM,
+    		XI_SOCK_PROTO_TCP, {'\0'}, 56790};
+
+	tc_info();
+
+    // setup a listen socket
+    srvsock = xi_socket_open(lsnaddr.family, lsnaddr.type, lsnaddr.proto);
+    if (srvsock < 0) {
+        log_error(XDLOG, "Failed to creat a socket!\n");
+        return -1;
+    }
+
+    // set socket options
+    ret = xi_socket_opt_set(srvsock, XI_SOCK_OPT_REUSEADDR, TRUE);
+    if (ret < 0) {
+        log_error(XDLOG, "Failed to setsocketopt: %d\n", ret);
+        return -1;
+    }
+
+    // setup a local addr
+    xi_strcpy(lsnaddr.host, "0.0.0.0");
+
+    // bind to the listen socket
+    ret = xi_socket_bind(srvsock, lsnaddr);
+    if (ret < 0) {
+    	log_error(XDLOG, "Failed to bind a socket: %d\n", ret);
+    	return -1;
+    }
+
+    // listen
+    ret = xi_socket_listen(srvsock, 10);
+    if (ret < 0) {
+    	log_error(XDLOG, "Failed to listen to socket: %d\n", ret);
+    	return -1;
+    }
+
+    // start a server
+    return tc_start_server(srvsock);
+}
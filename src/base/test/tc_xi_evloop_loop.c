@@ -0,0 +1,252 @@
+/*
+ * Copyright 2013 Cheolmin Jo (webos21@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * File : tc_xi_evloop_loop.c
+ *
+ * An echo of the event-loop on the loopback, which runs without a client
+ * from the outside and joins the loop threads at the end.
+ */
+
+#include "xi/xi_evloop.h"
+
+#include <stdio.h>
+
+#include "xi/xi_atomic.h"
+#include "xi/xi_mem.h"
+#include "xi/xi_socket.h"
+#include "xi/xi_string.h"
+#include "xi/xi_thread.h"
+
+#define TC_EVLOOP_THREADS  2
+#define TC_EVLOOP_POSTS    100
+#define TC_EVLOOP_ECHOES   10
+#define TC_EVLOOP_WAIT     1000   // msecs for the loop threads to respond
+
+static volatile xuint32 _g_tasks = 0;
+static volatile xuint32 _g_accepted = 0;
+static volatile xuint32 _g_closed = 0;
+
+// wait for a counter to reach the value : 0 reached, -1 timeout
+static xint32 tc_evloop_wait(volatile xuint32 *cnt, xuint32 val) {
+	xint32 i;
+
+	for (i = 0; i < TC_EVLOOP_WAIT; i++) {
+		if (xi_atomic_read32(cnt) >= val) {
+			return 0;
+		}
+		xi_thread_sleep(1);
+	}
+	return -1;
+}
+
+static xvoid tc_evloop_task(xi_evloop_t *loop, xint32 idx, xvoid *arg) {
+	UNUSED(loop);
+	UNUSED(idx);
+	UNUSED(arg);
+
+	xi_atomic_inc32(&_g_tasks);
+}
+
+// the messages are small enough to be sent back at once
+static xvoid tc_evloop_io(xi_evloop_t *loop, xint32 idx, xint32 desc,
+		xint32 evts, xvoid *arg) {
+	xchar buf[256];
+	xssize ret;
+
+	UNUSED(evts);
+	UNUSED(arg);
+
+	ret = xi_socket_recv(desc, buf, sizeof(buf));
+	if (ret == XI_SOCK_RV_ERR_TRYLATER) {
+		return;
+	}
+	if (ret <= 0 || xi_socket_send(desc, buf, (xsize) ret) != ret) {
+		xi_evloop_remove(loop, idx, desc);
+		xi_socket_close(desc);
+		xi_atomic_inc32(&_g_closed);
+	}
+}
+
+static xvoid tc_evloop_accept(xi_evloop_t *loop, xint32 idx, xint32 csock,
+		xvoid *arg) {
+	UNUSED(arg);
+
+	if (xi_evloop_add(loop, idx, csock, XI_POLL_EVENT_IN, tc_evloop_io, NULL)
+			!= XI_EVLOOP_RV_OK) {
+		xi_socket_close(csock);
+		return;
+	}
+	xi_atomic_inc32(&_g_accepted);
+}
+
+// posts from this thread wake up every loop thread many times
+static xint32 tc_evloop_post(xi_evloop_t *loop) {
+	xint32 i;
+
+	for (i = 0; i < TC_EVLOOP_POSTS; i++) {
+		if (xi_evloop_post(loop, i % xi_evloop_count(loop), tc_evloop_task, NULL)
+				!= XI_EVLOOP_RV_OK) {
+			return -1;
+		}
+		if ((i % 10) == 9) {
+			// let the loop threads drain the wakeups between the bursts
+			xi_thread_sleep(1);
+		}
+	}
+	return tc_evloop_wait(&_g_tasks, TC_EVLOOP_POSTS);
+}
+
+static xint32 tc_evloop_echo(xi_sock_addr_bin_t *baddr) {
+	xchar msg[32];
+	xchar buf[32];
+	xssize len, got, ret;
+	xint32 cfd, i;
+
+	cfd = xi_socket_open(XI_SOCK_FAMILY_INET, XI_SOCK_TYPE_STREAM,
+			XI_SOCK_PROTO_IP);
+	if (cfd < 0) {
+		return -1;
+	}
+	if (xi_socket_opt_set(cfd, XI_SOCK_OPT_RCVTIMEO, TC_EVLOOP_WAIT) < 0
+			|| xi_socket_connect_bin(cfd, baddr) != XI_SOCK_RV_OK) {
+		xi_socket_close(cfd);
+		return -1;
+	}
+
+	for (i = 0; i < TC_EVLOOP_ECHOES; i++) {
+		len = xi_snprintf(msg, sizeof(msg), "echo %d", i);
+		if (xi_socket_send(cfd, msg, (xsize) len) != len) {
+			xi_socket_close(cfd);
+			return -1;
+		}
+		for (got = 0; got < len; got += ret) {
+			ret = xi_socket_recv(cfd, buf + got, (xsize) (len - got));
+			if (ret <= 0) {
+				xi_socket_close(cfd);
+				return -1;
+			}
+		}
+		if (xi_mem_cmp(msg, buf, (xsize) len) != 0) {
+			xi_socket_close(cfd);
+			return -1;
+		}
+	}
+
+	// the server side sees the EOF, and closes its socket
+	xi_socket_close(cfd);
+	return tc_evloop_wait(&_g_closed, 1);
+}
+
+static void tc_info() {
+	printf("\n\n");
+	printf("====================================================\n");
+	printf("                xi_evloop.h - loopback\n");
+	printf("----------------------------------------------------\n");
+	printf(" * Functions)\n");
+	printf("   - xi_evloop_create\n");
+	printf("   - xi_evloop_listen\n");
+	printf("   - xi_evloop_start\n");
+	printf("   - xi_evloop_post\n");
+	printf("   - xi_evloop_add\n");
+	printf("   - xi_evloop_remove\n");
+	printf("   - xi_evloop_stop\n");
+	printf("   - xi_evloop_destroy\n");
+	printf("====================================================\n\n");
+}
+
+int tc_xi_evloop_loop() {
+	xint32 t = 1;
+	xchar *tcname = "xi_evloop.h";
+	xi_evloop_t *loop;
+	xi_sock_addr_t addr = { XI_SOCK_FAMILY_INET, XI_SOCK_TYPE_STREAM,
+			XI_SOCK_PROTO_IP, { '\0' }, 0 };
+	xi_sock_addr_bin_t baddr;
+	xint32 lsn;
+	xint32 ret = 0;
+
+	tc_info();
+
+	xi_atomic_set32(&_g_tasks, 0);
+	xi_atomic_set32(&_g_accepted, 0);
+	xi_atomic_set32(&_g_closed, 0);
+
+	printf("[%s:%02d] listen on the loopback ######\n", tcname, t++);
+	xi_strcpy(addr.host, "127.0.0.1");
+	xi_socket_addr_pton(&addr, &baddr);
+	lsn = xi_socket_open(XI_SOCK_FAMILY_INET, XI_SOCK_TYPE_STREAM,
+			XI_SOCK_PROTO_IP);
+	if (lsn < 0) {
+		printf("    result : failed!!!\n\n");
+		return -1;
+	}
+	if (xi_socket_bind_bin(lsn, &baddr) != XI_SOCK_RV_OK
+			|| xi_socket_listen(lsn, 4) != XI_SOCK_RV_OK
+			|| xi_socket_get_local_bin(lsn, &baddr) != XI_SOCK_RV_OK) {
+		printf("    result : failed!!!\n\n");
+		xi_socket_close(lsn);
+		return -1;
+	}
+	printf("    result : pass.\n\n");
+
+	printf("[%s:%02d] xi_evloop_start #############\n", tcname, t++);
+	loop = xi_evloop_create(TC_EVLOOP_THREADS, 16);
+	if (loop == NULL) {
+		printf("    result : failed!!!\n\n");
+		xi_socket_close(lsn);
+		return -1;
+	}
+	if (xi_evloop_listen(loop, lsn, tc_evloop_accept, NULL) != XI_EVLOOP_RV_OK
+			|| xi_evloop_start(loop) != XI_EVLOOP_RV_OK) {
+		printf("    result : failed!!!\n\n");
+		xi_evloop_destroy(loop);
+		xi_socket_close(lsn);
+		return -1;
+	}
+	printf("    result : pass.\n\n");
+
+	printf("[%s:%02d] xi_evloop_post ##############\n", tcname, t++);
+	if (tc_evloop_post(loop) < 0) {
+		printf("    result : failed!!! (tasks=%d)\n\n", xi_atomic_read32(&_g_tasks));
+		ret = -1;
+	} else {
+		printf("    result : pass.\n\n");
+	}
+
+	if (ret == 0) {
+		printf("[%s:%02d] echo on the loopback ########\n", tcname, t++);
+		if (tc_evloop_echo(&baddr) < 0 || xi_atomic_read32(&_g_accepted) != 1) {
+			printf("    result : failed!!!\n\n");
+			ret = -1;
+		} else {
+			printf("    result : pass.\n\n");
+		}
+	}
+
+	printf("[%s:%02d] xi_evloop_stop ##############\n", tcname, t++);
+	if (xi_evloop_stop(loop) != XI_EVLOOP_RV_OK
+			|| xi_evloop_destroy(loop) != XI_EVLOOP_RV_OK) {
+		printf("    result : failed!!!\n\n");
+		ret = -1;
+	} else {
+		printf("    result : pass.\n\n");
+	}
+	xi_socket_close(lsn);
+
+	printf("=========== DONE [xi_evloop.h - loopback] ==========\n\n");
+
+	return ret;
+}
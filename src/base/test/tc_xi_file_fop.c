@@ -24,6 +24,10 @@
 #include "xi/xi_mem.h"
 #include "xi/xi_string.h"
 
+#define TC_FOP_PIPES  2600  // 5200 descriptors, over the old limit of the table
+
+static xint32 pipes[TC_FOP_PIPES][2];
+
 static void tc_info() {
 	log_print(XDLOG, "====================================================\n");
 	log_print(XDLOG, "               xi_file.h - file OP\n");
@@ -43,6 +47,7 @@ static void tc_info() {
 	log_print(XDLOG, "   - xi_file_chmod\n");
 	log_print(XDLOG, "   - xi_file_rename\n");
 	log_print(XDLOG, "   - xi_file_remove\n");
+	log_print(XDLOG, "   - xi_file_pipe\n");
 	log_print(XDLOG, "====================================================\n\n");
 }
 
@@ -55,6 +60,8 @@ int tc_xi_file_fop() {
 	xssize ret;
 
 	xint32 sin, sout, serr, tfd;
+	xint32 i, npipe;
+	xi_file_stat_t fs;
 
 	tc_info();
 
@@ -126,6 +133,17 @@ int tc_xi_file_fop() {
 	}
 	log_print(XDLOG, "    - result : pass.\n\n");
 
+	log_print(XDLOG, "[%s:%02d] Status of File (test.dat) ###\n", tcname, t++);
+	ret = xi_file_fstat(tfd, &fs);
+	if (ret < 0 || fs.type != XI_FILE_TYPE_REG || fs.size <= 0
+			|| xi_strcmp(fs.filename, "test.dat") != 0) {
+		log_print(XDLOG, "    - result : failed!!! (ret=%d, name=%s)\n\n", ret,
+				fs.filename);
+		return -1;
+	}
+	log_print(XDLOG, "    - result : pass. (path=%s, size=%lld)\n\n",
+			fs.pathname, fs.size);
+
 	log_print(XDLOG, "[%s:%02d] Seek to First ###############\n", tcname, t++);
 	ret = (xint32) xi_file_seek(tfd, 0, XI_FILE_SEEK_SET);
 	if (tfd < 0) {
@@ -177,6 +195,32 @@ int tc_xi_file_fop() {
 	}
 	log_print(XDLOG, "    - result : pass.\n\n");
 
+	log_print(XDLOG, "[%s:%02d] Many Descriptors (pipes) ####\n", tcname, t++);
+	for (npipe = 0; npipe < TC_FOP_PIPES; npipe++) {
+		// stops at the limit of the process
+		if (xi_file_pipe(pipes[npipe]) < 0) {
+			break;
+		}
+	}
+	if (npipe == 0) {
+		log_print(XDLOG, "    - result : failed!!! (no pipe)\n\n");
+		return -1;
+	}
+	tfd = pipes[npipe - 1][1];
+	ret = xi_file_write(tfd, "xi", 2);
+	if (ret == 2) {
+		ret = xi_file_read(pipes[npipe - 1][0], buf, sizeof(buf));
+	}
+	for (i = 0; i < npipe; i++) {
+		xi_file_close(pipes[i][0]);
+		xi_file_close(pipes[i][1]);
+	}
+	if (ret != 2 || buf[0] != 'x' || buf[1] != 'i') {
+		log_print(XDLOG, "    - result : failed!!! (fd=%d, ret=%d)\n\n", tfd, ret);
+		return -1;
+	}
+	log_print(XDLOG, "    - result : pass. (pipes=%d, last fd=%d)\n\n", npipe, tfd);
+
 	log_print(XDLOG, "============= DONE [xi_file.h - file OP] ===========\n\n");
 
 	return 0;
@@ -0,0 +1,251 @@
+/*
+ * Copyright 2013 Cheolmin Jo (webos21@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * File : tc_xi_file_pio.c
+ */
+
+#include "xi/xi_file.h"
+
+#include "xi/xi_atomic.h"
+#include "xi/xi_clock.h"
+#include "xi/xi_log.h"
+#include "xi/xi_mem.h"
+#include "xi/xi_thread.h"
+
+#define TC_PIO_FILE     "pio_test.dat"
+#define TC_PIO_BLOCKS   256
+#define TC_PIO_BSIZE    4096
+#define TC_PIO_THREADS  4
+#define TC_PIO_ROUNDS   64
+
+static xint32 _g_fd;
+static xbool _g_seek;
+static xi_thread_mutex_t _g_lock;
+static volatile xuint32 _g_done;
+static volatile xuint32 _g_errors;
+
+static xchar tc_pio_byte(xint32 blk) {
+	return (xchar) ('a' + (blk % 26));
+}
+
+static xint32 tc_pio_check(const xchar *buf, xint32 blk) {
+	xint32 i;
+	for (i = 0; i < TC_PIO_BSIZE; i++) {
+		if (buf[i] != tc_pio_byte(blk)) {
+			return -1;
+		}
+	}
+	return 0;
+}
+
+// every thread reads all blocks, starting at a different one
+static void *tc_pio_reader(void *arg) {
+	xint32 id = (xint32) (xintptr) arg;
+	xint32 r, i, blk;
+	xssize rn;
+	xchar buf[TC_PIO_BSIZE];
+
+	for (r = 0; r < TC_PIO_ROUNDS; r++) {
+		for (i = 0; i < TC_PIO_BLOCKS; i++) {
+			blk = (i + id * (TC_PIO_BLOCKS / TC_PIO_THREADS)) % TC_PIO_BLOCKS;
+			if (_g_seek) {
+				// the old way : the file offset is shared
+				xi_thread_mutex_lock(&_g_lock);
+				xi_file_seek(_g_fd, (xoff64) blk * TC_PIO_BSIZE, XI_FILE_SEEK_SET);
+				rn = xi_file_read(_g_fd, buf, TC_PIO_BSIZE);
+				xi_thread_mutex_unlock(&_g_lock);
+			} else {
+				rn = xi_file_pread(_g_fd, buf, TC_PIO_BSIZE,
+						(xoff64) blk * TC_PIO_BSIZE);
+			}
+			if (rn != TC_PIO_BSIZE || tc_pio_check(buf, blk) != 0) {
+				xi_atomic_inc32(&_g_errors);
+			}
+		}
+	}
+
+	xi_atomic_inc32(&_g_done);
+	return NULL;
+}
+
+static xint64 tc_pio_run(xbool seek) {
+	xint32 i;
+	xint64 start;
+	xi_thread_t tid;
+
+	_g_seek = seek;
+	_g_done = 0;
+	_g_errors = 0;
+
+	start = xi_clock_ntick();
+	for (i = 0; i < TC_PIO_THREADS; i++) {
+		if (xi_thread_create(&tid, "TPIO", tc_pio_reader, (xvoid *) (xintptr) i,
+				256 * 1024, XCFG_THREAD_PRIOR_NORM) != XI_THREAD_RV_OK) {
+			return -1;
+		}
+	}
+	while (xi_atomic_read32(&_g_done) < TC_PIO_THREADS) {
+		xi_thread_usleep(1000);
+	}
+
+	return (_g_errors == 0) ? (xi_clock_ntick() - start) : -1;
+}
+
+static void tc_info() {
+	log_print(XDLOG, "====================================================\n");
+	log_print(XDLOG, "              xi_file.h - positional I/O\n");
+	log_print(XDLOG, "----------------------------------------------------\n");
+	log_print(XDLOG, " * Functions)\n");
+	log_print(XDLOG, "   - xi_file_pread / pwrite\n");
+	log_print(XDLOG, "   - xi_file_preadv / pwritev\n");
+	log_print(XDLOG, "   - xi_file_advise\n");
+	log_print(XDLOG, "   - xi_file_direct_align / alloc / free\n");
+	log_print(XDLOG, "====================================================\n\n");
+}
+
+int tc_xi_file_pio() {
+	xint32 t = 1;
+	xchar *tcname = "xi_file.h";
+
+	xint32 i, fd;
+	xssize ret;
+	xint64 ns_seek, ns_pread;
+	xchar buf[TC_PIO_BSIZE];
+	xchar *dbuf;
+	xi_file_iovec_t iov[3];
+
+	tc_info();
+
+	log_print(XDLOG, "[%s:%02d] xi_file_pwrite ##############\n", tcname, t++);
+	xi_file_remove(TC_PIO_FILE);
+	fd = xi_file_open(TC_PIO_FILE, XI_FILE_MODE_READ | XI_FILE_MODE_WRITE
+			| XI_FILE_MODE_CREATE, 0644);
+	if (fd < 0) {
+		log_print(XDLOG, "    - result : failed!!! (open=%d)\n\n", fd);
+		return -1;
+	}
+	// the last block first, so that the others fill the hole
+	for (i = TC_PIO_BLOCKS - 1; i >= 0; i--) {
+		xi_mem_set(buf, tc_pio_byte(i), TC_PIO_BSIZE);
+		ret = xi_file_pwrite(fd, buf, TC_PIO_BSIZE, (xoff64) i * TC_PIO_BSIZE);
+		if (ret != TC_PIO_BSIZE) {
+			log_print(XDLOG, "    - result : failed!!! (blk=%d, ret=%d)\n\n", i, ret);
+			return -1;
+		}
+	}
+	if (xi_file_seek(fd, 0, XI_FILE_SEEK_CUR) != 0) {
+		log_print(XDLOG, "    - result : failed!!! (offset moved)\n\n");
+		return -1;
+	}
+	log_print(XDLOG, "    - result : pass.\n\n");
+
+	log_print(XDLOG, "[%s:%02d] xi_file_pread ###############\n", tcname, t++);
+	ret = xi_file_pread(fd, buf, TC_PIO_BSIZE, (xoff64) 7 * TC_PIO_BSIZE);
+	if (ret != TC_PIO_BSIZE || tc_pio_check(buf, 7) != 0
+			|| xi_file_pread(fd, buf, TC_PIO_BSIZE,
+					(xoff64) TC_PIO_BLOCKS * TC_PIO_BSIZE) != 0
+			|| xi_file_pread(fd, buf, TC_PIO_BSIZE, -1) != XI_FILE_RV_ERR_ARGS) {
+		log_print(XDLOG, "    - result : failed!!! (ret=%d)\n\n", ret);
+		return -1;
+	}
+	log_print(XDLOG, "    - result : pass.\n\n");
+
+	log_print(XDLOG, "[%s:%02d] xi_file_preadv / pwritev ####\n", tcname, t++);
+	iov[0].iov_base = buf;
+	iov[0].iov_len = 100;
+	iov[1].iov_base = buf + 100;
+	iov[1].iov_len = TC_PIO_BSIZE - 200;
+	iov[2].iov_base = buf + TC_PIO_BSIZE - 100;
+	iov[2].iov_len = 100;
+	ret = xi_file_preadv(fd, iov, 3, (xoff64) 9 * TC_PIO_BSIZE);
+	if (ret != TC_PIO_BSIZE || tc_pio_check(buf, 9) != 0) {
+		log_print(XDLOG, "    - result : failed!!! (preadv=%d)\n\n", ret);
+		return -1;
+	}
+	ret = xi_file_pwritev(fd, iov, 3, (xoff64) 11 * TC_PIO_BSIZE);
+	if (ret != TC_PIO_BSIZE
+			|| xi_file_pread(fd, buf, TC_PIO_BSIZE, (xoff64) 11 * TC_PIO_BSIZE)
+					!= TC_PIO_BSIZE || tc_pio_check(buf, 9) != 0) {
+		log_print(XDLOG, "    - result : failed!!! (pwritev=%d)\n\n", ret);
+		return -1;
+	}
+	// restore the block
+	xi_mem_set(buf, tc_pio_byte(11), TC_PIO_BSIZE);
+	xi_file_pwrite(fd, buf, TC_PIO_BSIZE, (xoff64) 11 * TC_PIO_BSIZE);
+	log_print(XDLOG, "    - result : pass.\n\n");
+
+	log_print(XDLOG, "[%s:%02d] xi_file_advise ##############\n", tcname, t++);
+	for (i = XI_FILE_ADVICE_NORMAL; i <= XI_FILE_ADVICE_DONTNEED; i++) {
+		ret = xi_file_advise(fd, 0, 0, i);
+		if (ret != XI_FILE_RV_OK && ret != XI_FILE_RV_ERR_NS) {
+			log_print(XDLOG, "    - result : failed!!! (advice=%d, ret=%d)\n\n",
+					i, ret);
+			return -1;
+		}
+	}
+	if (xi_file_advise(fd, 0, 0, 99) != XI_FILE_RV_ERR_ARGS) {
+		log_print(XDLOG, "    - result : failed!!! (bad advice)\n\n");
+		return -1;
+	}
+	log_print(XDLOG, "    - result : pass.\n\n");
+
+	log_print(XDLOG, "[%s:%02d] %d threads reading one fd ####\n", tcname, t++,
+			TC_PIO_THREADS);
+	_g_fd = fd;
+	xi_thread_mutex_create(&_g_lock, "tc_pio");
+	ns_seek = tc_pio_run(TRUE);
+	ns_pread = tc_pio_run(FALSE);
+	xi_thread_mutex_destroy(&_g_lock);
+	if (ns_seek < 0 || ns_pread < 0) {
+		log_print(XDLOG, "    - result : failed!!! (errors=%u)\n\n", _g_errors);
+		return -1;
+	}
+	log_print(XDLOG, "    - result : pass. (seek+read=%lld us, pread=%lld us)\n\n",
+			ns_seek / 1000, ns_pread / 1000);
+	xi_file_close(fd);
+
+	log_print(XDLOG, "[%s:%02d] xi_file_direct_alloc ########\n", tcname, t++);
+	dbuf = xi_file_direct_alloc(TC_PIO_BSIZE + 1);
+	if (dbuf == NULL || ((xuintptr) dbuf % xi_file_direct_align()) != 0) {
+		log_print(XDLOG, "    - result : failed!!! (alloc)\n\n");
+		return -1;
+	}
+	fd = xi_file_open(TC_PIO_FILE, XI_FILE_MODE_READ | XI_FILE_MODE_DIRECT, 0644);
+	if (fd < 0) {
+		// some file systems (tmpfs) refuse the direct I/O
+		log_print(XDLOG, "    - result : pass. (align=%d, no direct I/O here)\n\n",
+				xi_file_direct_align());
+	} else {
+		ret = xi_file_pread(fd, dbuf, xi_file_direct_align(),
+				(xoff64) xi_file_direct_align() * 2);
+		xi_file_close(fd);
+		if (ret != (xssize) xi_file_direct_align()
+				|| tc_pio_check(dbuf, (xint32) (xi_file_direct_align() * 2
+						/ TC_PIO_BSIZE)) != 0) {
+			log_print(XDLOG, "    - result : failed!!! (ret=%d)\n\n", ret);
+			return -1;
+		}
+		log_print(XDLOG, "    - result : pass. (align=%d)\n\n",
+				xi_file_direct_align());
+	}
+	xi_file_direct_free(dbuf);
+	xi_file_remove(TC_PIO_FILE);
+
+	log_print(XDLOG, "========= DONE [xi_file.h - positional I/O] ========\n\n");
+
+	return 0;
+}
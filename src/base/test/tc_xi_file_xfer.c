@@ -0,0 +1,270 @@
+/*
+ * Copyright 2013 Cheolmin Jo (webos21@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * File : tc_xi_file_xfer.c
+ */
+
+#include "xi/xi_file.h"
+
+#include "xi/xi_clock.h"
+#include "xi/xi_log.h"
+#include "xi/xi_mem.h"
+#include "xi/xi_socket.h"
+#include "xi/xi_string.h"
+
+#define TC_XFER_SIZE   (1024 * 1024)
+#define TC_XFER_CHUNK  (16 * 1024)
+#define TC_XFER_SOCK   (32 * 1024)
+#define TC_XFER_LOOPS  16
+
+static xchar _g_buf[TC_XFER_CHUNK];
+
+static xchar tc_xfer_byte(xoff64 pos) {
+	return (xchar) ((pos * 7) + (pos >> 11));
+}
+
+// check the bytes [off, off + len) of the file against the pattern
+static xint32 tc_xfer_verify(const xchar *path, xoff64 off, xoff64 len) {
+	xint32 fd, i;
+	xssize rn;
+	xoff64 pos = 0;
+
+	fd = xi_file_open(path, XI_FILE_MODE_READ, 0644);
+	if (fd < 0) {
+		return -1;
+	}
+	while ((rn = xi_file_read(fd, _g_buf, sizeof(_g_buf))) > 0) {
+		for (i = 0; i < rn; i++, pos++) {
+			if (pos >= off && pos < off + len
+					&& _g_buf[i] != tc_xfer_byte(pos - off)) {
+				xi_file_close(fd);
+				return -1;
+			}
+		}
+	}
+	xi_file_close(fd);
+	return (pos >= off + len) ? 0 : -1;
+}
+
+static xint32 tc_xfer_reopen(const xchar *path) {
+	xi_file_remove(path);
+	return xi_file_open(path, XI_FILE_MODE_READ | XI_FILE_MODE_WRITE
+			| XI_FILE_MODE_CREATE, 0644);
+}
+
+static xint64 tc_xfer_copy_buf(xint32 in, xint32 out) {
+	xint32 i;
+	xssize rn;
+	xint64 start = xi_clock_ntick();
+
+	for (i = 0; i < TC_XFER_LOOPS; i++) {
+		xi_file_seek(in, 0, XI_FILE_SEEK_SET);
+		xi_file_seek(out, 0, XI_FILE_SEEK_SET);
+		while ((rn = xi_file_read(in, _g_buf, sizeof(_g_buf))) > 0) {
+			if (xi_file_write(out, _g_buf, rn) != rn) {
+				return -1;
+			}
+		}
+	}
+	return (xi_clock_ntick() - start) / TC_XFER_LOOPS;
+}
+
+static xint64 tc_xfer_copy_range(xint32 in, xint32 out) {
+	xint32 i;
+	xoff64 ioff, ooff;
+	xint64 start = xi_clock_ntick();
+
+	for (i = 0; i < TC_XFER_LOOPS; i++) {
+		ioff = 0;
+		ooff = 0;
+		if (xi_file_copy_range(in, &ioff, out, &ooff, TC_XFER_SIZE)
+				!= TC_XFER_SIZE) {
+			return -1;
+		}
+	}
+	return (xi_clock_ntick() - start) / TC_XFER_LOOPS;
+}
+
+static void tc_info() {
+	log_print(XDLOG, "====================================================\n");
+	log_print(XDLOG, "              xi_file.h - transfer\n");
+	log_print(XDLOG, "----------------------------------------------------\n");
+	log_print(XDLOG, " * Functions)\n");
+	log_print(XDLOG, "   - xi_file_copy_range\n");
+	log_print(XDLOG, "   - xi_file_splice\n");
+	log_print(XDLOG, "   - xi_file_tee\n");
+	log_print(XDLOG, "====================================================\n\n");
+}
+
+int tc_xi_file_xfer() {
+	xint32 t = 1;
+	xchar *tcname = "xi_file.h";
+
+	xint32 i, src, dst, lsn, clt, svr;
+	xint32 pa[2], pb[2];
+	xssize ret, got;
+	xoff64 pos, ioff, ooff;
+	xint64 ns_buf, ns_range;
+	xi_sock_addr_t addr = { XI_SOCK_FAMILY_INET, XI_SOCK_TYPE_STREAM,
+			XI_SOCK_PROTO_TCP, { '\0' }, 0 };
+	xi_sock_addr_bin_t baddr;
+
+	tc_info();
+
+	log_print(XDLOG, "[%s:%02d] Make source (%d bytes) #####\n", tcname, t++,
+			TC_XFER_SIZE);
+	src = tc_xfer_reopen("xfer_src.dat");
+	dst = tc_xfer_reopen("xfer_dst.dat");
+	if (src < 0 || dst < 0) {
+		log_print(XDLOG, "    - result : failed!!! (src=%d, dst=%d)\n\n", src, dst);
+		return -1;
+	}
+	for (pos = 0; pos < TC_XFER_SIZE;) {
+		for (i = 0; i < TC_XFER_CHUNK; i++, pos++) {
+			_g_buf[i] = tc_xfer_byte(pos);
+		}
+		if (xi_file_write(src, _g_buf, TC_XFER_CHUNK) != TC_XFER_CHUNK) {
+			log_print(XDLOG, "    - result : failed!!! (write)\n\n");
+			return -1;
+		}
+	}
+	log_print(XDLOG, "    - result : pass.\n\n");
+
+	log_print(XDLOG, "[%s:%02d] xi_file_copy_range ##########\n", tcname, t++);
+	xi_file_seek(src, 100, XI_FILE_SEEK_SET);
+	ioff = 0;
+	ooff = 10;
+	ret = xi_file_copy_range(src, &ioff, dst, &ooff, TC_XFER_SIZE);
+	if (ret != TC_XFER_SIZE || ioff != TC_XFER_SIZE
+			|| ooff != TC_XFER_SIZE + 10
+			|| xi_file_seek(src, 0, XI_FILE_SEEK_CUR) != 100
+			|| tc_xfer_verify("xfer_dst.dat", 10, TC_XFER_SIZE) != 0) {
+		log_print(XDLOG, "    - result : failed!!! (ret=%d)\n\n", ret);
+		return -1;
+	}
+	log_print(XDLOG, "    - result : pass.\n\n");
+
+	log_print(XDLOG, "[%s:%02d] xi_file_splice (file/pipe) ##\n", tcname, t++);
+	xi_file_close(dst);
+	dst = tc_xfer_reopen("xfer_dst.dat");
+	if (xi_file_pipe(pa) != XI_FILE_RV_OK || dst < 0) {
+		log_print(XDLOG, "    - result : failed!!! (pipe)\n\n");
+		return -1;
+	}
+	ioff = 0;
+	ooff = 0;
+	for (got = 0; got < TC_XFER_SIZE; got += ret) {
+		// no more than the pipe holds
+		ret = xi_file_splice(src, &ioff, pa[1], NULL, TC_XFER_CHUNK, 0);
+		if (ret != TC_XFER_CHUNK
+				|| xi_file_splice(pa[0], NULL, dst, &ooff, ret, 0) != ret) {
+			log_print(XDLOG, "    - result : failed!!! (got=%d, ret=%d)\n\n",
+					got, ret);
+			return -1;
+		}
+	}
+	if (tc_xfer_verify("xfer_dst.dat", 0, TC_XFER_SIZE) != 0) {
+		log_print(XDLOG, "    - result : failed!!! (verify)\n\n");
+		return -1;
+	}
+	log_print(XDLOG, "    - result : pass.\n\n");
+
+	log_print(XDLOG, "[%s:%02d] xi_file_tee ################\n", tcname, t++);
+	if (xi_file_pipe(pb) != XI_FILE_RV_OK) {
+		log_print(XDLOG, "    - result : failed!!! (pipe)\n\n");
+		return -1;
+	}
+	xi_file_write(pa[1], "tee-data", 8);
+	ret = xi_file_tee(pa[0], pb[1], 8, 0);
+	if (ret == XI_FILE_RV_ERR_NS) {
+		xi_file_read(pa[0], _g_buf, 8);
+		log_print(XDLOG, "    - result : pass. (not supported)\n\n");
+	} else if (ret != 8 || xi_file_read(pa[0], _g_buf, 8) != 8
+			|| xi_mem_cmp(_g_buf, "tee-data", 8) != 0
+			|| xi_file_read(pb[0], _g_buf, 8) != 8
+			|| xi_mem_cmp(_g_buf, "tee-data", 8) != 0) {
+		log_print(XDLOG, "    - result : failed!!! (ret=%d)\n\n", ret);
+		return -1;
+	} else {
+		log_print(XDLOG, "    - result : pass.\n\n");
+	}
+	xi_file_close(pa[0]);
+	xi_file_close(pa[1]);
+	xi_file_close(pb[0]);
+	xi_file_close(pb[1]);
+
+	log_print(XDLOG, "[%s:%02d] xi_file_splice (socket/file) \n", tcname, t++);
+	xi_strcpy(addr.host, "127.0.0.1");
+	xi_socket_addr_pton(&addr, &baddr);
+	lsn = xi_socket_open(XI_SOCK_FAMILY_INET, XI_SOCK_TYPE_STREAM,
+			XI_SOCK_PROTO_TCP);
+	clt = xi_socket_open(XI_SOCK_FAMILY_INET, XI_SOCK_TYPE_STREAM,
+			XI_SOCK_PROTO_TCP);
+	if (lsn < 0 || clt < 0 || xi_socket_bind_bin(lsn, &baddr) != XI_SOCK_RV_OK
+			|| xi_socket_listen(lsn, 4) != XI_SOCK_RV_OK
+			|| xi_socket_get_local_bin(lsn, &baddr) != XI_SOCK_RV_OK
+			|| xi_socket_connect_bin(clt, &baddr) != XI_SOCK_RV_OK) {
+		log_print(XDLOG, "    - result : failed!!! (socket)\n\n");
+		return -1;
+	}
+	svr = xi_socket_accept_bin(lsn, NULL);
+	xi_file_close(dst);
+	dst = tc_xfer_reopen("xfer_dst.dat");
+	ioff = 0;
+	// file -> socket (relayed by a pipe), then socket -> file
+	ret = xi_file_splice(src, &ioff, clt, NULL, TC_XFER_SOCK, 0);
+	if (svr < 0 || ret != TC_XFER_SOCK) {
+		log_print(XDLOG, "    - result : failed!!! (svr=%d, ret=%d)\n\n", svr, ret);
+		return -1;
+	}
+	ooff = 0;
+	for (got = 0; got < TC_XFER_SOCK; got += ret) {
+		ret = xi_file_splice(svr, NULL, dst, &ooff, TC_XFER_SOCK - got, 0);
+		if (ret <= 0) {
+			log_print(XDLOG, "    - result : failed!!! (got=%d, ret=%d)\n\n",
+					got, ret);
+			return -1;
+		}
+	}
+	if (tc_xfer_verify("xfer_dst.dat", 0, TC_XFER_SOCK) != 0) {
+		log_print(XDLOG, "    - result : failed!!! (verify)\n\n");
+		return -1;
+	}
+	xi_socket_close(svr);
+	xi_socket_close(clt);
+	xi_socket_close(lsn);
+	log_print(XDLOG, "    - result : pass.\n\n");
+
+	log_print(XDLOG, "[%s:%02d] copy_range vs read/write ####\n", tcname, t++);
+	ns_buf = tc_xfer_copy_buf(src, dst);
+	ns_range = tc_xfer_copy_range(src, dst);
+	if (ns_buf < 0 || ns_range < 0) {
+		log_print(XDLOG, "    - result : failed!!!\n\n");
+		return -1;
+	}
+	log_print(XDLOG, "    - result : pass. (read/write=%lld us, copy_range=%lld us)\n\n",
+			ns_buf / 1000, ns_range / 1000);
+
+	xi_file_close(src);
+	xi_file_close(dst);
+	xi_file_remove("xfer_src.dat");
+	xi_file_remove("xfer_dst.dat");
+
+	log_print(XDLOG, "============ DONE [xi_file.h - transfer] ===========\n\n");
+
+	return 0;
+}
@@ -20,11 +20,21 @@
 
 #include "xi/xi_hashtb.h"
 
+#include "xi/xi_clock.h"
 #include "xi/xi_log.h"
 #include "xi/xi_mem.h"
 #include "xi/xi_string.h"
 
 #define MAX_KEYGEN 102
+#define MAX_BULK   200000
+#define MAX_SAME   300
+
+// every key collides
+static xuint32 tc_keygen_same(const xvoid *key, xint32 *klen) {
+	UNUSED(key);
+	UNUSED(klen);
+	return 7;
+}
 
 static void tc_info() {
 	log_print(XDLOG, "\n\n");
@@ -40,6 +50,9 @@ static void tc_info() {
 	log_print(XDLOG, "   - xi_hashtb_clear\n");
 	log_print(XDLOG, "   - xi_hashtb_set (again)\n");
 	log_print(XDLOG, "   - xi_hashtb_first / xi_hashtb_next #2\n");
+	log_print(XDLOG, "   - xi_hashtb_clone\n");
+	log_print(XDLOG, "   - xi_hashtb_set / get / delete (bulk)\n");
+	log_print(XDLOG, "   - xi_hashtb_create_custom\n");
 	log_print(XDLOG, "   - xi_hashtb_destroy\n");
 	log_print(XDLOG, "====================================================\n\n");
 }
@@ -54,6 +67,10 @@ int tc_xi_hashtb() {
 	xchar *rval = NULL;
 	xint32 cnt;
 
+	xi_hashtb_t *ctb = NULL;
+	xint32 *bulk = NULL;
+	xint64 tick, lat, lat_max;
+
 	xint32 td_intkey[MAX_KEYGEN];
 	xchar td_strkey[MAX_KEYGEN][32];
 	xchar td_strval[MAX_KEYGEN][32];
@@ -144,10 +161,91 @@ int tc_xi_hashtb() {
 	}
 	log_print(XDLOG, "\n");
 
+	log_print(XDLOG, "[%s:%02d] xi_hashtb_clone #############\n", tcname, t++);
+	ctb = xi_hashtb_clone(htb);
+	if (ctb == NULL || xi_hashtb_count(ctb) != MAX_KEYGEN) {
+		log_print(XDLOG, "    - result : failed!!!\n\n");
+		return -1;
+	}
+	for (cnt = 0; cnt < MAX_KEYGEN; cnt++) {
+		if (xi_hashtb_get(ctb, td_strkey[cnt], XI_HASHTB_KEY_STRING) != td_strval[cnt]) {
+			log_print(XDLOG, "    - result : failed!!! (key=%s)\n\n", td_strkey[cnt]);
+			return -1;
+		}
+	}
+	xi_hashtb_destroy(ctb);
+	log_print(XDLOG, "    - result : pass.\n\n");
+
 	log_print(XDLOG, "[%s:%02d] xi_hashtb_destroy ###########\n", tcname, t++);
 	xi_hashtb_destroy(htb);
 	log_print(XDLOG, "    - result : pass.\n\n");
 
+	log_print(XDLOG, "[%s:%02d] set / get / delete (bulk) ###\n", tcname, t++);
+	bulk = xi_mem_alloc(sizeof(xint32) * MAX_BULK);
+	htb = xi_hashtb_create();
+	if (bulk == NULL || htb == NULL) {
+		log_print(XDLOG, "    - result : failed!!! (create)\n\n");
+		return -1;
+	}
+	lat_max = 0;
+	for (cnt = 0; cnt < MAX_BULK; cnt++) {
+		bulk[cnt] = cnt;
+		tick = xi_clock_ntick();
+		xi_hashtb_set(htb, &bulk[cnt], sizeof(xint32), &bulk[cnt]);
+		lat = xi_clock_ntick() - tick;
+		if (lat > lat_max) {
+			lat_max = lat;
+		}
+	}
+	for (cnt = 0; cnt < MAX_BULK; cnt += 2) {
+		xi_hashtb_set(htb, &bulk[cnt], sizeof(xint32), NULL);
+	}
+	if (xi_hashtb_count(htb) != MAX_BULK / 2) {
+		log_print(XDLOG, "    - result : failed!!! (count=%u)\n\n", xi_hashtb_count(htb));
+		return -1;
+	}
+	for (cnt = 0; cnt < MAX_BULK; cnt++) {
+		rval = xi_hashtb_get(htb, &cnt, sizeof(cnt));
+		if ((cnt % 2 == 0 && rval != NULL)
+				|| (cnt % 2 == 1 && rval != (xchar *) &bulk[cnt])) {
+			log_print(XDLOG, "    - result : failed!!! (key=%d)\n\n", cnt);
+			return -1;
+		}
+	}
+	for (cnt = 0, hidx = xi_hashtb_first(htb); hidx; hidx = xi_hashtb_next(hidx)) {
+		cnt++;
+	}
+	if (cnt != MAX_BULK / 2) {
+		log_print(XDLOG, "    - result : failed!!! (iterated=%d)\n\n", cnt);
+		return -1;
+	}
+	log_print(XDLOG, "    - result : pass. (count = %d / max = %d / worst set = %lld ns)\n\n",
+			xi_hashtb_count(htb), xi_hashtb_max(htb), lat_max);
+	xi_hashtb_destroy(htb);
+
+	log_print(XDLOG, "[%s:%02d] xi_hashtb_create_custom #####\n", tcname, t++);
+	htb = xi_hashtb_create_custom(tc_keygen_same);
+	if (htb == NULL) {
+		log_print(XDLOG, "    - result : failed!!! (create)\n\n");
+		return -1;
+	}
+	for (cnt = 0; cnt < MAX_SAME; cnt++) {
+		xi_hashtb_set(htb, &bulk[cnt], sizeof(xint32), &bulk[cnt]);
+	}
+	for (cnt = 0; cnt < MAX_SAME; cnt++) {
+		if (xi_hashtb_get(htb, &cnt, sizeof(cnt)) != &bulk[cnt]) {
+			log_print(XDLOG, "    - result : failed!!! (key=%d)\n\n", cnt);
+			return -1;
+		}
+	}
+	if (xi_hashtb_count(htb) != MAX_SAME) {
+		log_print(XDLOG, "    - result : failed!!! (count=%u)\n\n", xi_hashtb_count(htb));
+		return -1;
+	}
+	xi_hashtb_destroy(htb);
+	xi_mem_free(bulk);
+	log_print(XDLOG, "    - result : pass.\n\n");
+
 	log_print(XDLOG, "================== DONE [xi_hashtb.h] ==============\n\n");
 
 	return 0;
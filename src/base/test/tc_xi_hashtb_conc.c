@@ -0,0 +1,223 @@
+/*
+ * Copyright 2013 Cheolmin Jo (webos21@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * File : tc_xi_hashtb_conc.c
+ */
+
+#include "xi/xi_hashtb.h"
+
+#include "xi/xi_atomic.h"
+#include "xi/xi_clock.h"
+#include "xi/xi_log.h"
+#include "xi/xi_mem.h"
+#include "xi/xi_thread.h"
+
+#define TC_CONC_KEYS     1000   // always present
+#define TC_CONC_CHURN    1000   // inserted and deleted by the writer
+#define TC_CONC_READERS  3
+#define TC_CONC_ROUNDS   200
+#define TC_CONC_LOOKUPS  200000
+
+static xi_hashtb_conc_t *_g_htb;
+static xint32 _g_vals[2][TC_CONC_KEYS + TC_CONC_CHURN];
+static xint32 _g_keys[TC_CONC_KEYS];
+static volatile xuint32 _g_stop;
+static volatile xuint32 _g_done;
+static volatile xuint32 _g_errors;
+
+// the stable keys must always be found, with one of their two values
+static void *tc_conc_reader(void *arg) {
+	xint32 i = 0, k;
+	xint32 *v;
+
+	UNUSED(arg);
+
+	while (!xi_atomic_read32(&_g_stop)) {
+		k = i++ % TC_CONC_KEYS;
+		v = xi_hashtb_conc_get(_g_htb, &k, sizeof(k));
+		if (v != &_g_vals[0][k] && v != &_g_vals[1][k]) {
+			xi_atomic_inc32(&_g_errors);
+		}
+	}
+
+	xi_atomic_inc32(&_g_done);
+	return NULL;
+}
+
+// churn the other keys and flip the values of the stable ones
+static void *tc_conc_writer(void *arg) {
+	xint32 r, k;
+
+	UNUSED(arg);
+
+	for (r = 0; r < TC_CONC_ROUNDS; r++) {
+		for (k = TC_CONC_KEYS; k < TC_CONC_KEYS + TC_CONC_CHURN; k++) {
+			xi_hashtb_conc_set(_g_htb, &k, sizeof(k), &_g_vals[0][k]);
+		}
+		for (k = 0; k < TC_CONC_KEYS; k++) {
+			xi_hashtb_conc_set(_g_htb, &k, sizeof(k), &_g_vals[r & 1][k]);
+		}
+		for (k = TC_CONC_KEYS; k < TC_CONC_KEYS + TC_CONC_CHURN; k++) {
+			xi_hashtb_conc_set(_g_htb, &k, sizeof(k), NULL);
+		}
+	}
+
+	xi_atomic_set32(&_g_stop, 1);
+	xi_atomic_inc32(&_g_done);
+	return NULL;
+}
+
+static void tc_info() {
+	log_print(XDLOG, "====================================================\n");
+	log_print(XDLOG, "              xi_hashtb.h - concurrent\n");
+	log_print(XDLOG, "----------------------------------------------------\n");
+	log_print(XDLOG, " * Functions)\n");
+	log_print(XDLOG, "   - xi_hashtb_conc_create / destroy\n");
+	log_print(XDLOG, "   - xi_hashtb_conc_set / get / count\n");
+	log_print(XDLOG, "   - xi_hashtb_conc_first / next / this / done\n");
+	log_print(XDLOG, "====================================================\n\n");
+}
+
+int tc_xi_hashtb_conc() {
+	xint32 t = 1;
+	xchar *tcname = "xi_hashtb.h";
+
+	xi_hashtb_conc_idx_t iter;
+	xi_hashtb_conc_idx_t *hidx;
+	xi_hashtb_t *htb;
+	xi_thread_mutex_t lock;
+	xi_thread_t tid;
+	const xvoid *key;
+	xint32 klen, i, k;
+	xvoid *val;
+	xint64 start, ns_lock, ns_conc;
+
+	tc_info();
+
+	log_print(XDLOG, "[%s:%02d] xi_hashtb_conc_set / get ####\n", tcname, t++);
+	_g_htb = xi_hashtb_conc_create(NULL);
+	if (_g_htb == NULL) {
+		log_print(XDLOG, "    - result : failed!!! (create)\n\n");
+		return -1;
+	}
+	for (k = 0; k < TC_CONC_KEYS + TC_CONC_CHURN; k++) {
+		xi_hashtb_conc_set(_g_htb, &k, sizeof(k), &_g_vals[0][k]);
+	}
+	// the keys are copied : k is not the key any more
+	for (k = 0; k < TC_CONC_KEYS + TC_CONC_CHURN; k++) {
+		if (xi_hashtb_conc_get(_g_htb, &k, sizeof(k)) != &_g_vals[0][k]) {
+			log_print(XDLOG, "    - result : failed!!! (key=%d)\n\n", k);
+			return -1;
+		}
+	}
+	for (k = TC_CONC_KEYS; k < TC_CONC_KEYS + TC_CONC_CHURN; k++) {
+		xi_hashtb_conc_set(_g_htb, &k, sizeof(k), NULL);
+	}
+	if (xi_hashtb_conc_count(_g_htb) != TC_CONC_KEYS) {
+		log_print(XDLOG, "    - result : failed!!! (count=%u)\n\n",
+				xi_hashtb_conc_count(_g_htb));
+		return -1;
+	}
+	log_print(XDLOG, "    - result : pass. (count=%u)\n\n",
+			xi_hashtb_conc_count(_g_htb));
+
+	log_print(XDLOG, "[%s:%02d] xi_hashtb_conc_first / next ##\n", tcname, t++);
+	for (i = 0, hidx = xi_hashtb_conc_first(_g_htb, &iter); hidx; hidx
+			= xi_hashtb_conc_next(hidx)) {
+		xi_hashtb_conc_this(hidx, &key, &klen, &val);
+		if (klen != sizeof(xint32) || val != &_g_vals[0][*(const xint32 *) key]) {
+			log_print(XDLOG, "    - result : failed!!! (klen=%d)\n\n", klen);
+			return -1;
+		}
+		// deleting the current one while iterating
+		if (*(const xint32 *) key % 2 == 1) {
+			xi_hashtb_conc_set(_g_htb, key, klen, NULL);
+		}
+		i++;
+	}
+	if (i != TC_CONC_KEYS || xi_hashtb_conc_count(_g_htb) != TC_CONC_KEYS / 2) {
+		log_print(XDLOG, "    - result : failed!!! (iterated=%d)\n\n", i);
+		return -1;
+	}
+	// left in the middle
+	hidx = xi_hashtb_conc_first(_g_htb, &iter);
+	xi_hashtb_conc_done(hidx);
+	xi_hashtb_conc_done(hidx);
+	for (k = 1; k < TC_CONC_KEYS; k += 2) {
+		xi_hashtb_conc_set(_g_htb, &k, sizeof(k), &_g_vals[0][k]);
+	}
+	log_print(XDLOG, "    - result : pass.\n\n");
+
+	log_print(XDLOG, "[%s:%02d] %d readers and a writer ######\n", tcname, t++,
+			TC_CONC_READERS);
+	_g_stop = 0;
+	_g_done = 0;
+	_g_errors = 0;
+	for (i = 0; i < TC_CONC_READERS; i++) {
+		if (xi_thread_create(&tid, "THCONC_R", tc_conc_reader, NULL, 256 * 1024,
+				XCFG_THREAD_PRIOR_NORM) != XI_THREAD_RV_OK) {
+			log_print(XDLOG, "    - result : failed!!! (thread)\n\n");
+			return -1;
+		}
+	}
+	if (xi_thread_create(&tid, "THCONC_W", tc_conc_writer, NULL, 256 * 1024,
+			XCFG_THREAD_PRIOR_NORM) != XI_THREAD_RV_OK) {
+		xi_atomic_set32(&_g_stop, 1);
+		log_print(XDLOG, "    - result : failed!!! (thread)\n\n");
+		return -1;
+	}
+	while (xi_atomic_read32(&_g_done) < TC_CONC_READERS + 1) {
+		xi_thread_sleep(10);
+	}
+	if (_g_errors != 0 || xi_hashtb_conc_count(_g_htb) != TC_CONC_KEYS) {
+		log_print(XDLOG, "    - result : failed!!! (errors=%u, count=%u)\n\n",
+				_g_errors, xi_hashtb_conc_count(_g_htb));
+		return -1;
+	}
+	log_print(XDLOG, "    - result : pass.\n\n");
+
+	log_print(XDLOG, "[%s:%02d] lookup : mutex+hashtb vs conc #\n", tcname, t++);
+	htb = xi_hashtb_create();
+	xi_thread_mutex_create(&lock, "tc_hashtb_conc");
+	for (k = 0; k < TC_CONC_KEYS; k++) {
+		_g_keys[k] = k;
+		xi_hashtb_set(htb, &_g_keys[k], sizeof(xint32), &_g_vals[0][k]);
+	}
+	start = xi_clock_ntick();
+	for (i = 0; i < TC_CONC_LOOKUPS; i++) {
+		k = i % TC_CONC_KEYS;
+		xi_thread_mutex_lock(&lock);
+		val = xi_hashtb_get(htb, &k, sizeof(k));
+		xi_thread_mutex_unlock(&lock);
+	}
+	ns_lock = (xi_clock_ntick() - start) / TC_CONC_LOOKUPS;
+	start = xi_clock_ntick();
+	for (i = 0; i < TC_CONC_LOOKUPS; i++) {
+		k = i % TC_CONC_KEYS;
+		val = xi_hashtb_conc_get(_g_htb, &k, sizeof(k));
+	}
+	ns_conc = (xi_clock_ntick() - start) / TC_CONC_LOOKUPS;
+	xi_thread_mutex_destroy(&lock);
+	xi_hashtb_destroy(htb);
+	xi_hashtb_conc_destroy(_g_htb);
+	log_print(XDLOG, "    - result : pass. (mutex+hashtb=%lld ns, conc=%lld ns)\n\n",
+			ns_lock, ns_conc);
+
+	log_print(XDLOG, "======= DONE [xi_hashtb.h - concurrent] ============\n\n");
+
+	return 0;
+}
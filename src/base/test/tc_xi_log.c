@@ -22,10 +22,110 @@
 
 #include <stdio.h>
 
+#include "xi/xi_atomic.h"
+#include "xi/xi_clock.h"
+#include "xi/xi_file.h"
+#include "xi/xi_mem.h"
+#include "xi/xi_string.h"
+#include "xi/xi_thread.h"
+
+#define TC_LOG_THREADS  4
+#define TC_LOG_COUNT    5000
+
+#define TC_LOG_BIN      "log_test.bin"
+#define TC_LOG_TXT      "log_test.txt"
+#define TC_LOG_TXTMAX   (1024 * 1024)
+#define TC_LOG_BINCNT   100
+
+// every kind of the conversions, compared with xi_snprintf
+#define TC_LOG_BIN_FMT  "n=%d f=%.3f s=%-5s| x=%#x c=%c w=[%*d] l=%lld p=%p z=%zu h=%hhd u=%hu e=%e " \
+		"t=%.*s m=%.2s 0=%p 100%%\n"
+#define TC_LOG_BIN_ARGS(i) (i), 3.14159 * (i), "abc", 0xbeef + (i), 'A' + ((i) % 26), \
+		6, -(i), (xint64) (i) << 40, (xvoid *) &_g_alog, (xsize) (i), (xint32) (i) + 200, \
+		(xint32) (i) + 65530, 1.5e-7 * (i), (xint32) (i) % 8, _g_unterm, _g_long, (xvoid *) NULL
+
+static xi_logger_t *_g_alog;
+static xchar *_g_unterm;                   // not terminated by '\0'
+static xchar _g_long[XI_LOG_LINE_MAX * 2]; // longer than a record
+static volatile xuint32 _g_lines;
+static volatile xuint32 _g_broken;
+static volatile xuint32 _g_done;
+
 static void tc_xi_log_handle(xchar *msg) {
 	printf("[New Handle] %s", msg);
 }
 
+// called by the writer thread of the async mode
+static void tc_xi_log_count(xchar *msg) {
+	if (xi_strncmp(msg, "INFO|", 5) != 0
+			|| msg[xi_strlen(msg) - 1] != '\n') {
+		xi_atomic_inc32(&_g_broken);
+	}
+	xi_atomic_inc32(&_g_lines);
+}
+
+// the counted logs are not compiled out by XCFG_LOG_LEVEL_MIN
+static void *tc_xi_log_thread(void *arg) {
+	xint32 i;
+
+	for (i = 0; i < TC_LOG_COUNT; i++) {
+		xi_logger_write(_g_alog, XI_LOG_LEVEL_INFO, __FILE__, __FUNCTION__,
+				__LINE__, "thread=%d, seq=%d\n", (xint32) (xintptr) arg, i);
+	}
+	xi_atomic_inc32(&_g_done);
+
+	return NULL;
+}
+
+// decode TC_LOG_BIN into TC_LOG_TXT, and read it into buf
+static xssize tc_xi_log_decode(xchar *buf, xsize buflen) {
+	xint32 infd, outfd;
+	xssize ret;
+	xi_log_re lret;
+
+	infd = xi_file_open(TC_LOG_BIN, XI_FILE_MODE_READ, 0644);
+	outfd = xi_file_open(TC_LOG_TXT, XI_FILE_MODE_READ | XI_FILE_MODE_WRITE
+			| XI_FILE_MODE_CREATE | XI_FILE_MODE_TRUNCATE, 0644);
+	if (infd < 0 || outfd < 0) {
+		return -1;
+	}
+	lret = xi_logger_bin_decode(infd, outfd);
+	xi_file_close(infd);
+	if (lret != XI_LOG_RV_OK) {
+		xi_file_close(outfd);
+		return -1;
+	}
+	xi_file_seek(outfd, 0, XI_FILE_SEEK_SET);
+	ret = xi_file_read(outfd, buf, buflen - 1);
+	xi_file_close(outfd);
+	if (ret >= 0) {
+		buf[ret] = '\0';
+	}
+	return ret;
+}
+
+// returns nanoseconds per log
+static xint64 tc_xi_log_burst() {
+	xint32 i;
+	xint64 start;
+	xi_thread_t tid;
+
+	_g_lines = 0;
+	_g_broken = 0;
+	_g_done = 0;
+
+	start = xi_clock_ntick();
+	for (i = 0; i < TC_LOG_THREADS; i++) {
+		xi_thread_create(&tid, "TLOG", tc_xi_log_thread, (xvoid *) (xintptr) i,
+				256 * 1024, XCFG_THREAD_PRIOR_NORM);
+	}
+	while (xi_atomic_read32(&_g_done) < TC_LOG_THREADS) {
+		xi_thread_sleep(1);
+	}
+
+	return (xi_clock_ntick() - start) / (TC_LOG_THREADS * TC_LOG_COUNT);
+}
+
 static void tc_info() {
 	printf("\n\n");
 	printf("====================================================\n");
@@ -38,6 +138,13 @@ static void tc_info() {
 	printf("   - xi_logger_set_conf\n");
 	printf("   - xi_logger_set_handle\n");
 	printf("   - xi_logger_write\n");
+	printf("   - xi_logger_async_start\n");
+	printf("   - xi_logger_async_flush\n");
+	printf("   - xi_logger_async_stop\n");
+	printf("   - xi_logger_async_dropped\n");
+	printf("   - xi_logger_bin_start\n");
+	printf("   - xi_logger_bin_stop\n");
+	printf("   - xi_logger_bin_decode\n");
 	printf("====================================================\n\n");
 }
 
@@ -50,6 +157,11 @@ int tc_xi_log() {
 	xi_logopt_t topt;
 	xuint32 cnt, j;
 	xi_logger_id_t *ids;
+	xi_log_re ret;
+	xint64 ns;
+	xchar *txt, *exp, *p;
+	xsize elen;
+	xssize tlen;
 
 	tc_info();
 
@@ -116,6 +228,112 @@ int tc_xi_log() {
 	}
 	printf("\n");
 
+	printf("[%s:%02d] async mode (block) ##########\n", tcname, t++);
+	_g_alog = logger_get("TC_ALOG");
+	xi_logger_set_handle(tc_xi_log_count);
+	ret = xi_logger_async_start(256, XI_LOG_OVERFLOW_BLOCK);
+	if (ret != XI_LOG_RV_OK
+			|| xi_logger_async_start(256, XI_LOG_OVERFLOW_BLOCK)
+					!= XI_LOG_RV_ERR_BUSY) {
+		xi_logger_set_handle(NULL);
+		printf("    result : failed!!! (ret=%d)\n\n", ret);
+		return -1;
+	}
+	ns = tc_xi_log_burst();
+	xi_logger_async_flush();
+	if (_g_lines != TC_LOG_THREADS * TC_LOG_COUNT || _g_broken != 0) {
+		xi_logger_async_stop();
+		xi_logger_set_handle(NULL);
+		printf("    result : failed!!! (lines=%u, broken=%u)\n\n", _g_lines,
+				_g_broken);
+		return -1;
+	}
+	xi_logger_async_stop();
+	printf("    result : pass. (lines=%u, %lld ns/log)\n\n", _g_lines, ns);
+
+	printf("[%s:%02d] async mode (drop) ###########\n", tcname, t++);
+	xi_logger_async_start(16, XI_LOG_OVERFLOW_DROP);
+	ns = tc_xi_log_burst();
+	xi_logger_async_flush();
+	cnt = xi_logger_async_dropped();
+	xi_logger_async_stop();
+	xi_logger_set_handle(NULL);
+	if (_g_lines + cnt != TC_LOG_THREADS * TC_LOG_COUNT || _g_broken != 0) {
+		printf("    result : failed!!! (lines=%u, dropped=%u)\n\n", _g_lines, cnt);
+		return -1;
+	}
+	printf("    result : pass. (lines=%u, dropped=%u, %lld ns/log)\n\n", _g_lines,
+			cnt, ns);
+
+	printf("[%s:%02d] binary mode (sync) #########\n", tcname, t++);
+	txt = xi_mem_alloc(TC_LOG_TXTMAX);
+	exp = xi_mem_alloc(TC_LOG_TXTMAX);
+	tlog = logger_get("TC_BLOG");
+	topt = xi_logger_get_conf(tlog);
+	topt.showFile = FALSE;
+	topt.showFunc = FALSE;
+	topt.showLine = FALSE;
+	xi_logger_set_conf(tlog, topt);
+	_g_unterm = xi_mem_alloc(8);
+	xi_mem_copy(_g_unterm, "abcdefgh", 8);
+	xi_mem_set(_g_long, 'm', sizeof(_g_long) - 1);
+	ret = xi_logger_bin_start(TC_LOG_BIN);
+	if (ret != XI_LOG_RV_OK
+			|| xi_logger_bin_start(TC_LOG_BIN) != XI_LOG_RV_ERR_BUSY) {
+		xi_mem_free(_g_unterm);
+		printf("    result : failed!!! (ret=%d)\n\n", ret);
+		return -1;
+	}
+	elen = 0;
+	for (j = 0; j < TC_LOG_BINCNT; j++) {
+		xi_logger_write(tlog, XI_LOG_LEVEL_INFO, __FILE__, __FUNCTION__,
+				__LINE__, TC_LOG_BIN_FMT, TC_LOG_BIN_ARGS((xint32) j));
+		elen += xi_snprintf(exp + elen, TC_LOG_TXTMAX - elen,
+				"INFO|" TC_LOG_BIN_FMT, TC_LOG_BIN_ARGS((xint32) j));
+	}
+	log_debug(tlog, "below the level : not recorded\n");
+	xi_logger_bin_stop();
+	xi_mem_free(_g_unterm);
+	tlen = tc_xi_log_decode(txt, TC_LOG_TXTMAX);
+	if (tlen != (xssize) elen || xi_strcmp(txt, exp) != 0) {
+		printf("    result : failed!!! (decoded=%d, expected=%d)\n", (xint32) tlen,
+				(xint32) elen);
+		printf("    %s", txt);
+		printf("    %s\n", exp);
+		return -1;
+	}
+	printf("    result : pass. (%d logs)\n", TC_LOG_BINCNT);
+	printf("    %.*s\n\n", (xint32) (xi_strchr(exp, '\n') - exp), exp);
+
+	printf("[%s:%02d] binary mode (async) ########\n", tcname, t++);
+	_g_alog = tlog;
+	xi_logger_async_start(1024, XI_LOG_OVERFLOW_BLOCK);
+	xi_logger_bin_start(TC_LOG_BIN);
+	ns = tc_xi_log_burst();
+	xi_logger_bin_stop();
+	xi_logger_async_stop();
+	tlen = tc_xi_log_decode(txt, TC_LOG_TXTMAX);
+	cnt = 0;
+	for (p = txt; tlen > 0 && *p != '\0'; p = xi_strchr(p, '\n') + 1) {
+		if (xi_strncmp(p, "INFO|thread=", 12) != 0
+				|| xi_strchr(p, '\n') == NULL) {
+			break;
+		}
+		cnt++;
+	}
+	xi_mem_free(txt);
+	xi_mem_free(exp);
+	xi_file_remove(TC_LOG_BIN);
+	xi_file_remove(TC_LOG_TXT);
+	if (cnt != TC_LOG_THREADS * TC_LOG_COUNT) {
+		printf("    result : failed!!! (lines=%u)\n\n", cnt);
+		return -1;
+	}
+	printf("    result : pass. (lines=%u, %lld ns/log)\n\n", cnt, ns);
+
+	printf("[%s:%02d] sync mode after stop ########\n", tcname, t++);
+	log_info(_g_alog, "%s\n\n", tmsg);
+
 	printf("================== DONE [xi_log.h] =================\n\n");
 
 	return 0;
@@ -0,0 +1,76 @@
+/*
+ * Copyright 2013 Cheolmin Jo (webos21@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * File : tc_xi_log_min.c
+ *
+ * This file is built with XCFG_LOG_LEVEL_MIN of 3, whatever the others are.
+ */
+
+#undef XCFG_LOG_LEVEL_MIN
+#define XCFG_LOG_LEVEL_MIN  3
+
+#include "xi/xi_log.h"
+
+#include <stdio.h>
+
+static void tc_info() {
+	printf("\n\n");
+	printf("====================================================\n");
+	printf("             xi_log.h (XCFG_LOG_LEVEL_MIN)\n");
+	printf("----------------------------------------------------\n");
+	printf(" * Macros)\n");
+	printf("   - log_trace\n");
+	printf("   - log_debug\n");
+	printf("   - log_info\n");
+	printf("====================================================\n\n");
+}
+
+int tc_xi_log_min() {
+	xint32 t = 1;
+	xchar *tcname = "xi_log.h";
+
+	xi_logger_t *tlog;
+	xint32 evals = 0;
+
+	tc_info();
+
+	tlog = logger_get("TC_LOG_MIN");
+	UNUSED(tlog);
+
+	printf("[%s:%02d] below the minimum level #####\n", tcname, t++);
+	log_trace(tlog, "trace : %d\n", evals++);
+	log_debug(tlog, "debug : %d\n", evals++);
+	if (evals != 0) {
+		printf("    result : failed!!! (evals=%d)\n\n", evals);
+		return -1;
+	}
+	printf("    result : pass. (not evaluated)\n\n");
+
+#ifdef XCFG_DEBUG
+	printf("[%s:%02d] at the minimum level ########\n", tcname, t++);
+	log_info(tlog, "info : %d\n", evals++);
+	if (evals != 1) {
+		printf("    result : failed!!! (evals=%d)\n\n", evals);
+		return -1;
+	}
+	printf("    result : pass. (evaluated)\n\n");
+#endif // XCFG_DEBUG
+
+	printf("================== DONE [xi_log.h] =================\n\n");
+
+	return 0;
+}
@@ -20,7 +20,39 @@
 
 #include "xi/xi_mem.h"
 
+#include <stdio.h>
+
+#include "xi/xi_clock.h"
 #include "xi/xi_log.h"
+#include "xi/xi_string.h"
+
+#define TC_TRACK_N     100
+#define TC_TRACK_SIZE  100
+#define TC_TRACK_LOOP  100000
+
+static xint32 _g_track_sites = 0;
+
+// counts the sites of "tc_mem" written by xi_mem_track_dump
+static xvoid tc_track_sink(xchar *msg) {
+	if (xi_strstr(msg, "mem site tag=tc_mem ") != NULL) {
+		_g_track_sites++;
+	}
+	printf("%s", msg);
+}
+
+// nanoseconds per alloc and free
+static xint64 tc_track_loop() {
+	xint32 i;
+	xint64 start;
+	xvoid *p;
+
+	start = xi_clock_ntick();
+	for (i = 0; i < TC_TRACK_LOOP; i++) {
+		p = xi_mem_alloc(64 + (i & 63));
+		xi_mem_free(p);
+	}
+	return (xi_clock_ntick() - start) / TC_TRACK_LOOP;
+}
 
 static void tc_info() {
 	log_print(XDLOG, "\n\n");
@@ -39,6 +71,9 @@ static void tc_info() {
 	log_print(XDLOG, "   - xi_mem_free\n");
 	log_print(XDLOG, "   - xi_mem_read\n");
 	log_print(XDLOG, "   - xi_mem_write\n");
+	log_print(XDLOG, "   - xi_mem_track_start / stop\n");
+	log_print(XDLOG, "   - xi_mem_track_tag / tag_set\n");
+	log_print(XDLOG, "   - xi_mem_track_stat / dump\n");
 	log_print(XDLOG, "====================================================\n\n");
 }
 
@@ -52,6 +87,11 @@ int tc_xi_mem() {
 	xssize ret = 0;
 	xchar buf[64];
 
+	xint32 tag, old, i;
+	xchar *tp[TC_TRACK_N];
+	xi_mem_stat_t st;
+	xint64 ns_off, ns_on;
+
 	tc_info();
 
 	log_print(XDLOG, "[%s:%02d] alloc[char]/calloc[int] #####\n", tcname, t++);
@@ -146,6 +186,86 @@ int tc_xi_mem() {
 	xi_mem_free(tc);
 	log_print(XDLOG, "    - result : pass.\n\n");
 
+	log_print(XDLOG, "[%s:%02d] track_start / tag ############\n", tcname, t++);
+	tag = xi_mem_track_tag("tc_mem");
+	if (tag <= XI_MEM_TAG_DEFAULT || xi_mem_track_tag("tc_mem") != tag) {
+		log_print(XDLOG, "    - result : failed!!! (tag=%d)\n\n", tag);
+		return -1;
+	}
+	// the tag is set before the start, which still samples every one
+	old = xi_mem_track_tag_set(tag);
+	if (old != XI_MEM_TAG_DEFAULT) {
+		log_print(XDLOG, "    - result : failed!!! (old=%d)\n\n", old);
+		return -1;
+	}
+	if (xi_mem_track_start(1) != XI_MEM_RV_OK) {
+		log_print(XDLOG, "    - result : failed!!! (start)\n\n");
+		return -1;
+	}
+	log_print(XDLOG, "    - result : pass. (tag=%d)\n\n", tag);
+
+	log_print(XDLOG, "[%s:%02d] track alloc / realloc #######\n", tcname, t++);
+	for (i = 0; i < TC_TRACK_N; i++) {
+		tp[i] = xi_mem_alloc(TC_TRACK_SIZE);
+		if (tp[i] == NULL) {
+			log_print(XDLOG, "    - result : failed!!! (alloc)\n\n");
+			return -1;
+		}
+		xi_mem_set(tp[i], 'T', TC_TRACK_SIZE);
+	}
+	xi_mem_track_stat(tag, &st);
+	if (st.bytes != TC_TRACK_N * TC_TRACK_SIZE || st.count != TC_TRACK_N) {
+		log_print(XDLOG, "    - result : failed!!! (bytes=%llu, count=%llu)\n\n",
+				st.bytes, st.count);
+		return -1;
+	}
+	tp[0] = xi_mem_realloc(tp[0], TC_TRACK_SIZE * 3);
+	xi_mem_track_stat(tag, &st);
+	if (tp[0] == NULL || tp[0][TC_TRACK_SIZE - 1] != 'T'
+			|| st.bytes != (TC_TRACK_N + 2) * TC_TRACK_SIZE
+			|| st.bytes_peak != st.bytes || st.count_peak != TC_TRACK_N) {
+		log_print(XDLOG, "    - result : failed!!! (bytes=%llu, peak=%llu)\n\n",
+				st.bytes, st.bytes_peak);
+		return -1;
+	}
+	log_print(XDLOG, "    - result : pass. (bytes=%llu, count=%llu)\n\n",
+			st.bytes, st.count);
+
+	log_print(XDLOG, "[%s:%02d] track_dump ###################\n", tcname, t++);
+	_g_track_sites = 0;
+	xi_logger_set_handle(tc_track_sink);
+	xi_mem_track_dump(XDLOG, 4);
+	xi_logger_set_handle(NULL);
+	if (_g_track_sites == 0) {
+		log_print(XDLOG, "    - result : failed!!! (no site)\n\n");
+		return -1;
+	}
+	log_print(XDLOG, "    - result : pass. (sites=%d)\n\n", _g_track_sites);
+
+	log_print(XDLOG, "[%s:%02d] track free ###################\n", tcname, t++);
+	for (i = 0; i < TC_TRACK_N; i++) {
+		xi_mem_free(tp[i]);
+	}
+	xi_mem_track_stat(tag, &st);
+	xi_mem_track_tag_set(old);
+	if (st.bytes != 0 || st.count != 0
+			|| st.bytes_peak != (TC_TRACK_N + 2) * TC_TRACK_SIZE) {
+		log_print(XDLOG, "    - result : failed!!! (bytes=%llu, count=%llu)\n\n",
+				st.bytes, st.count);
+		return -1;
+	}
+	log_print(XDLOG, "    - result : pass.\n\n");
+
+	log_print(XDLOG, "[%s:%02d] track overhead (sample=256) ##\n", tcname, t++);
+	xi_mem_track_stop();
+	ns_off = tc_track_loop();
+	xi_mem_track_start(256);
+	ns_on = tc_track_loop();
+	xi_mem_track_stop();
+	log_print(XDLOG, "    - result : pass. (off=%lld ns, on=%lld ns)\n\n",
+			ns_off, ns_on);
+
+	// ti was allocated before the tracking
 	log_print(XDLOG, "[%s:%02d] free [int] ##################\n", tcname, t++);
 	xi_mem_free(ti);
 	log_print(XDLOG, "    - result : pass.\n\n");
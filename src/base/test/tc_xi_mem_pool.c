@@ -0,0 +1,221 @@
+/*
+ * Copyright 2013 Cheolmin Jo (webos21@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * File : tc_xi_mem_pool.c
+ */
+
+#include "xi/xi_mem.h"
+
+#include "xi/xi_atomic.h"
+#include "xi/xi_clock.h"
+#include "xi/xi_log.h"
+#include "xi/xi_thread.h"
+
+#define TC_POOL_OBJSIZE  72
+#define TC_POOL_OBJS     1000
+#define TC_POOL_THREADS  4
+#define TC_POOL_ROUNDS   2000
+#define TC_POOL_BATCH    64
+
+static xi_mem_slab_t *_g_slab;
+static xbool _g_use_slab;
+static volatile xuint32 _g_done;
+static volatile xuint32 _g_errors;
+
+// every thread allocates a batch, checks it and frees it
+static void *tc_pool_worker(void *arg) {
+	xint32 id = (xint32) (xintptr) arg;
+	xint32 r, i;
+	xchar *objs[TC_POOL_BATCH];
+
+	for (r = 0; r < TC_POOL_ROUNDS; r++) {
+		for (i = 0; i < TC_POOL_BATCH; i++) {
+			objs[i] = _g_use_slab ? xi_mem_slab_alloc(_g_slab)
+					: xi_mem_alloc(TC_POOL_OBJSIZE);
+			if (objs[i] == NULL) {
+				xi_atomic_inc32(&_g_errors);
+				break;
+			}
+			xi_mem_set(objs[i], id, TC_POOL_OBJSIZE);
+		}
+		while (--i >= 0) {
+			if (objs[i][0] != (xchar) id
+					|| objs[i][TC_POOL_OBJSIZE - 1] != (xchar) id) {
+				xi_atomic_inc32(&_g_errors);
+			}
+			if (_g_use_slab) {
+				xi_mem_slab_free(_g_slab, objs[i]);
+			} else {
+				xi_mem_free(objs[i]);
+			}
+		}
+	}
+	if (_g_use_slab) {
+		xi_mem_slab_flush(_g_slab);
+	}
+
+	xi_atomic_inc32(&_g_done);
+	return NULL;
+}
+
+// returns nanoseconds per alloc and free
+static xint64 tc_pool_run(xbool slab) {
+	xint32 i;
+	xint64 start;
+	xi_thread_t tid;
+
+	_g_use_slab = slab;
+	_g_done = 0;
+	_g_errors = 0;
+
+	start = xi_clock_ntick();
+	for (i = 0; i < TC_POOL_THREADS; i++) {
+		if (xi_thread_create(&tid, "TPOOL", tc_pool_worker,
+				(xvoid *) (xintptr) (i + 1), 256 * 1024, XCFG_THREAD_PRIOR_NORM)
+				!= XI_THREAD_RV_OK) {
+			return -1;
+		}
+	}
+	while (xi_atomic_read32(&_g_done) < TC_POOL_THREADS) {
+		xi_thread_sleep(1);
+	}
+
+	if (_g_errors != 0) {
+		return -1;
+	}
+	return (xi_clock_ntick() - start)
+			/ (TC_POOL_THREADS * TC_POOL_ROUNDS * TC_POOL_BATCH);
+}
+
+static void tc_info() {
+	log_print(XDLOG, "====================================================\n");
+	log_print(XDLOG, "              xi_mem.h - arena and slab\n");
+	log_print(XDLOG, "----------------------------------------------------\n");
+	log_print(XDLOG, " * Functions)\n");
+	log_print(XDLOG, "   - xi_mem_arena_create / destroy\n");
+	log_print(XDLOG, "   - xi_mem_arena_alloc / calloc\n");
+	log_print(XDLOG, "   - xi_mem_arena_used / reset\n");
+	log_print(XDLOG, "   - xi_mem_slab_create / destroy\n");
+	log_print(XDLOG, "   - xi_mem_slab_alloc / free / flush\n");
+	log_print(XDLOG, "====================================================\n\n");
+}
+
+int tc_xi_mem_pool() {
+	xint32 t = 1;
+	xchar *tcname = "xi_mem.h";
+
+	xi_mem_arena_t *arena;
+	xchar *first, *p, *prev;
+	xint32 i;
+	xint64 ns_malloc, ns_slab;
+	xchar **objs;
+
+	tc_info();
+
+	log_print(XDLOG, "[%s:%02d] xi_mem_arena_alloc ##########\n", tcname, t++);
+	arena = xi_mem_arena_create(4096);
+	if (arena == NULL) {
+		log_print(XDLOG, "    - result : failed!!! (create)\n\n");
+		return -1;
+	}
+	first = prev = NULL;
+	for (i = 1; i <= 500; i++) {
+		p = xi_mem_arena_alloc(arena, (xsize) (i % 37));
+		if (p == NULL || ((xuintptr) p % (sizeof(xvoid *) * 2)) != 0) {
+			log_print(XDLOG, "    - result : failed!!! (i=%d, p=%p)\n\n", i, p);
+			return -1;
+		}
+		// the previous one is not overwritten by this one
+		xi_mem_set(p, 'a' + (i % 26), (xsize) (i % 37));
+		if (prev != NULL && (i - 1) % 37 != 0 && prev[0] != 'a' + ((i - 1) % 26)) {
+			log_print(XDLOG, "    - result : failed!!! (overlap at %d)\n\n", i);
+			return -1;
+		}
+		if (first == NULL) {
+			first = p;
+		}
+		prev = p;
+	}
+	p = xi_mem_arena_calloc(arena, 100, 20);
+	if (p == NULL || p[0] != 0 || p[1999] != 0) {
+		log_print(XDLOG, "    - result : failed!!! (big calloc)\n\n");
+		return -1;
+	}
+	log_print(XDLOG, "    - result : pass. (used=%lu)\n\n",
+			(unsigned long) xi_mem_arena_used(arena));
+
+	log_print(XDLOG, "[%s:%02d] xi_mem_arena_reset ##########\n", tcname, t++);
+	xi_mem_arena_reset(arena);
+	p = xi_mem_arena_alloc(arena, 10);
+	if (xi_mem_arena_used(arena) != sizeof(xvoid *) * 2 || p != first) {
+		log_print(XDLOG, "    - result : failed!!! (p=%p, first=%p)\n\n", p, first);
+		return -1;
+	}
+	xi_mem_arena_destroy(arena);
+	log_print(XDLOG, "    - result : pass.\n\n");
+
+	log_print(XDLOG, "[%s:%02d] xi_mem_slab_alloc / free ####\n", tcname, t++);
+	_g_slab = xi_mem_slab_create(TC_POOL_OBJSIZE);
+	objs = xi_mem_alloc(sizeof(xchar *) * TC_POOL_OBJS);
+	if (_g_slab == NULL || objs == NULL) {
+		log_print(XDLOG, "    - result : failed!!! (create)\n\n");
+		return -1;
+	}
+	for (i = 0; i < TC_POOL_OBJS; i++) {
+		objs[i] = xi_mem_slab_alloc(_g_slab);
+		if (objs[i] == NULL || ((xuintptr) objs[i] % (sizeof(xvoid *) * 2)) != 0) {
+			log_print(XDLOG, "    - result : failed!!! (i=%d)\n\n", i);
+			return -1;
+		}
+		xi_mem_set(objs[i], (xchar) i, TC_POOL_OBJSIZE);
+	}
+	for (i = 0; i < TC_POOL_OBJS; i++) {
+		if (objs[i][0] != (xchar) i || objs[i][TC_POOL_OBJSIZE - 1] != (xchar) i) {
+			log_print(XDLOG, "    - result : failed!!! (overlap at %d)\n\n", i);
+			return -1;
+		}
+	}
+	for (i = 0; i < TC_POOL_OBJS; i++) {
+		xi_mem_slab_free(_g_slab, objs[i]);
+	}
+	// the last freed comes back first
+	p = xi_mem_slab_alloc(_g_slab);
+	if (p != objs[TC_POOL_OBJS - 1]) {
+		log_print(XDLOG, "    - result : failed!!! (not reused)\n\n");
+		return -1;
+	}
+	xi_mem_slab_free(_g_slab, p);
+	xi_mem_slab_flush(_g_slab);
+	xi_mem_free(objs);
+	log_print(XDLOG, "    - result : pass.\n\n");
+
+	log_print(XDLOG, "[%s:%02d] %d threads : malloc vs slab ##\n", tcname, t++,
+			TC_POOL_THREADS);
+	ns_malloc = tc_pool_run(FALSE);
+	ns_slab = tc_pool_run(TRUE);
+	xi_mem_slab_destroy(_g_slab);
+	if (ns_malloc < 0 || ns_slab < 0) {
+		log_print(XDLOG, "    - result : failed!!! (errors=%u)\n\n", _g_errors);
+		return -1;
+	}
+	log_print(XDLOG, "    - result : pass. (malloc=%lld ns, slab=%lld ns)\n\n",
+			ns_malloc, ns_slab);
+
+	log_print(XDLOG, "======= DONE [xi_mem.h - arena and slab] ===========\n\n");
+
+	return 0;
+}
@@ -61,21 +61,10 @@ static xvoid tc_client_send(xi_pollset_t *pset, xi_pollfd_t *pfd) {
 	cpfd.evts = XI_POLL_EVENT_IN;
 	cpfd.context = ecbp;
 
-	// disable write
-    ret = xi_pollset_remove(pset, *pfd);
+	// disable write, enable read
+	ret = xi_pollset_modify(pset, cpfd);
 	if (ret != XI_POLLSET_RV_OK) {
-		log_error(XDLOG, "Failed to remove the write filter: %d\n", ret);
-        --_g_client_num;
-		_g_run = FALSE;
-        xi_socket_close(pfd->desc);
-        xi_mem_free(ecbp);
-        return;
-	}
-
-	// enable read
-	ret = xi_pollset_add(pset, cpfd);
-	if (ret != XI_POLLSET_RV_OK) {
-		log_error(XDLOG, "Failed to add a read filter: %d\n", ret);
+		log_error(XDLOG, "Failed to switch to the read filter: %d\n", ret);
         --_g_client_num;
 		_g_run = FALSE;
         xi_socket_close(pfd->desc);
@@ -124,20 +113,10 @@ static xvoid tc_client_recv(xi_pollset_t *pset, xi_pollfd_t *pfd) {
 	cpfd.evts = XI_POLL_EVENT_OUT;
 	cpfd.context = ecbp;
 
-    // disable read
-    ret = xi_pollset_remove(pset, *pfd);
-	if (ret != XI_POLLSET_RV_OK) {
-		log_error(XDLOG, "Failed to remove the read filter: %d\n", ret);
-		_g_run = FALSE;
-        xi_socket_close(pfd->desc);
-        xi_mem_free(ecbp);
-        return;
-	}
-
-	// enable write
-	ret = xi_pollset_add(pset, cpfd);
+	// disable read, enable write
+	ret = xi_pollset_modify(pset, cpfd);
 	if (ret != XI_POLLSET_RV_OK) {
-		log_error(XDLOG, "Failed to add a write filter: %d\n", ret);
+		log_error(XDLOG, "Failed to switch to the write filter: %d\n", ret);
 		_g_run = FALSE;
         xi_socket_close(pfd->desc);
         xi_mem_free(ecbp);
@@ -274,6 +253,7 @@ static xvoid tc_info() {
 	log_print(XDLOG, " * Functions)\n");
 	log_print(XDLOG, "   - xi_pollset_create\n");
 	log_print(XDLOG, "   - xi_pollset_add\n");
+	log_print(XDLOG, "   - xi_pollset_modify\n");
 	log_print(XDLOG, "   - xi_pollset_remove\n");
 	log_print(XDLOG, "   - xi_pollset_destroy\n");
 	log_print(XDLOG, "====================================================\n\n");
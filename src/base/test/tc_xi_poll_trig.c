@@ -0,0 +1,203 @@
+/*
+ * Copyright 2013 Cheolmin Jo (webos21@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * File : tc_xi_poll_trig.c
+ *
+ * XI_POLL_EVENT_ONESHOT and XI_POLL_EVENT_ET on a connection of the loopback.
+ */
+
+#include "xi/xi_poll.h"
+
+#include <stdio.h>
+
+#include "xi/xi_socket.h"
+#include "xi/xi_string.h"
+
+#define TC_POLL_WAIT  1000   // msecs for an event to come
+#define TC_POLL_NONE  100    // msecs for no event to come
+
+// a connected pair of the loopback : sfd[0] is the client, sfd[1] is the server
+static xint32 tc_poll_pair(xint32 sfd[2]) {
+	xi_sock_addr_t addr = { XI_SOCK_FAMILY_INET, XI_SOCK_TYPE_STREAM,
+			XI_SOCK_PROTO_IP, { '\0' }, 0 };
+	xi_sock_addr_bin_t baddr;
+	xint32 lsn;
+
+	sfd[0] = -1;
+	sfd[1] = -1;
+
+	xi_strcpy(addr.host, "127.0.0.1");
+	xi_socket_addr_pton(&addr, &baddr);
+	lsn = xi_socket_open(XI_SOCK_FAMILY_INET, XI_SOCK_TYPE_STREAM,
+			XI_SOCK_PROTO_IP);
+	if (lsn < 0) {
+		return -1;
+	}
+	if (xi_socket_bind_bin(lsn, &baddr) == XI_SOCK_RV_OK
+			&& xi_socket_listen(lsn, 1) == XI_SOCK_RV_OK
+			&& xi_socket_get_local_bin(lsn, &baddr) == XI_SOCK_RV_OK) {
+		sfd[0] = xi_socket_open(XI_SOCK_FAMILY_INET, XI_SOCK_TYPE_STREAM,
+				XI_SOCK_PROTO_IP);
+		if (sfd[0] >= 0 && xi_socket_connect_bin(sfd[0], &baddr) == XI_SOCK_RV_OK) {
+			sfd[1] = xi_socket_accept_bin(lsn, NULL);
+		}
+	}
+	xi_socket_close(lsn);
+
+	if (sfd[1] < 0) {
+		if (sfd[0] >= 0) {
+			xi_socket_close(sfd[0]);
+		}
+		return -1;
+	}
+	return 0;
+}
+
+// the events of the server side in msecs : 1 signaled, 0 not, -1 error
+static xint32 tc_poll_wait(xi_pollset_t *pset, xint32 sfd, xint32 msecs) {
+	xi_pollfd_t rfds[2];
+	xint32 ret;
+
+	ret = xi_pollset_poll(pset, rfds, 2, msecs);
+	if (ret == XI_POLLSET_RV_ERR_TIMEOUT || ret == 0) {
+		return 0;
+	}
+	if (ret != 1 || rfds[0].desc != sfd || !(rfds[0].evts & XI_POLL_EVENT_IN)) {
+		return -1;
+	}
+	return 1;
+}
+
+// ONESHOT : the next data is not signaled until xi_pollset_modify
+static xint32 tc_poll_oneshot(xint32 opt) {
+	xi_pollset_t *pset;
+	xi_pollfd_t pfd;
+	xint32 sfd[2];
+	xint32 ret = -1;
+
+	if (tc_poll_pair(sfd) < 0) {
+		return -1;
+	}
+	pset = xi_pollset_create(4, opt);
+	if (pset == NULL) {
+		xi_socket_close(sfd[0]);
+		xi_socket_close(sfd[1]);
+		return -1;
+	}
+
+	pfd.desc = sfd[1];
+	pfd.evts = XI_POLL_EVENT_IN | XI_POLL_EVENT_ONESHOT;
+	pfd.context = NULL;
+	if (xi_pollset_add(pset, pfd) == XI_POLLSET_RV_OK
+			&& xi_socket_send(sfd[0], "a", 1) == 1
+			&& tc_poll_wait(pset, sfd[1], TC_POLL_WAIT) == 1
+			&& xi_socket_send(sfd[0], "b", 1) == 1
+			&& tc_poll_wait(pset, sfd[1], TC_POLL_NONE) == 0
+			&& xi_pollset_modify(pset, pfd) == XI_POLLSET_RV_OK
+			&& tc_poll_wait(pset, sfd[1], TC_POLL_WAIT) == 1
+			&& tc_poll_wait(pset, sfd[1], TC_POLL_NONE) == 0) {
+		ret = 0;
+	}
+
+	xi_pollset_destroy(pset);
+	xi_socket_close(sfd[0]);
+	xi_socket_close(sfd[1]);
+	return ret;
+}
+
+#ifndef _WIN32
+// ET : the unread data is signaled once, and the new data once again
+static xint32 tc_poll_edge() {
+	xi_pollset_t *pset;
+	xi_pollfd_t pfd;
+	xint32 sfd[2];
+	xint32 ret = -1;
+
+	if (tc_poll_pair(sfd) < 0) {
+		return -1;
+	}
+	pset = xi_pollset_create(4, XI_POLLSET_OPT_EPOLL);
+	if (pset == NULL) {
+		xi_socket_close(sfd[0]);
+		xi_socket_close(sfd[1]);
+		return -1;
+	}
+
+	pfd.desc = sfd[1];
+	pfd.evts = XI_POLL_EVENT_IN | XI_POLL_EVENT_ET;
+	pfd.context = NULL;
+	if (xi_pollset_add(pset, pfd) == XI_POLLSET_RV_OK
+			&& xi_socket_send(sfd[0], "a", 1) == 1
+			&& tc_poll_wait(pset, sfd[1], TC_POLL_WAIT) == 1
+			&& tc_poll_wait(pset, sfd[1], TC_POLL_NONE) == 0
+			&& xi_socket_send(sfd[0], "b", 1) == 1
+			&& tc_poll_wait(pset, sfd[1], TC_POLL_WAIT) == 1
+			&& tc_poll_wait(pset, sfd[1], TC_POLL_NONE) == 0) {
+		ret = 0;
+	}
+
+	xi_pollset_destroy(pset);
+	xi_socket_close(sfd[0]);
+	xi_socket_close(sfd[1]);
+	return ret;
+}
+#endif // !_WIN32
+
+static void tc_info() {
+	printf("\n\n");
+	printf("====================================================\n");
+	printf("                xi_poll.h - triggers\n");
+	printf("----------------------------------------------------\n");
+	printf(" * Events)\n");
+	printf("   - XI_POLL_EVENT_ONESHOT\n");
+	printf("   - XI_POLL_EVENT_ET\n");
+	printf("====================================================\n\n");
+}
+
+int tc_xi_poll_trig() {
+	xint32 t = 1;
+	xchar *tcname = "xi_poll.h";
+
+	tc_info();
+
+	printf("[%s:%02d] oneshot (poll) ##############\n", tcname, t++);
+	if (tc_poll_oneshot(0) < 0) {
+		printf("    result : failed!!!\n\n");
+		return -1;
+	}
+	printf("    result : pass.\n\n");
+
+	printf("[%s:%02d] oneshot (epoll) #############\n", tcname, t++);
+	if (tc_poll_oneshot(XI_POLLSET_OPT_EPOLL) < 0) {
+		printf("    result : failed!!!\n\n");
+		return -1;
+	}
+	printf("    result : pass.\n\n");
+
+#ifndef _WIN32
+	printf("[%s:%02d] edge-triggered (epoll) ######\n", tcname, t++);
+	if (tc_poll_edge() < 0) {
+		printf("    result : failed!!!\n\n");
+		return -1;
+	}
+	printf("    result : pass.\n\n");
+#endif // !_WIN32
+
+	printf("=========== DONE [xi_poll.h - triggers] ============\n\n");
+
+	return 0;
+}
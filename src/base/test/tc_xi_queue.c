@@ -0,0 +1,278 @@
+/*
+ * Copyright 2013 Cheolmin Jo (webos21@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * File : tc_xi_queue.c
+ */
+
+#include "xi/xi_queue.h"
+
+#include "xi/xi_atomic.h"
+#include "xi/xi_clock.h"
+#include "xi/xi_log.h"
+#include "xi/xi_thread.h"
+
+#define TC_QUEUE_ITEMS      1000000
+#define TC_QUEUE_SIZE       1024
+#define TC_QUEUE_PRODUCERS  2
+#define TC_QUEUE_CONSUMERS  2
+
+static xi_queue_spsc_t *_g_spsc;
+static xi_queue_mpmc_t *_g_mpmc;
+
+static xbool _g_blocking;
+static volatile xuint32 _g_done;
+static volatile xuint32 _g_errors;
+static volatile xuint64 _g_sum;
+
+// items are (1 .. n), so that the sum tells a lost or doubled item
+static xuint64 tc_queue_sum(xuint64 n) {
+	return n * (n + 1) / 2;
+}
+
+static void *tc_spsc_producer(void *arg) {
+	xuintptr i;
+
+	UNUSED(arg);
+
+	for (i = 1; i <= TC_QUEUE_ITEMS; i++) {
+		if (_g_blocking) {
+			if (xi_queue_spsc_put(_g_spsc, (xvoid *) i, -1) != XI_QUEUE_RV_OK) {
+				xi_atomic_inc32(&_g_errors);
+			}
+		} else {
+			while (xi_queue_spsc_push(_g_spsc, (xvoid *) i) != XI_QUEUE_RV_OK) {
+				xi_thread_yield();
+			}
+		}
+	}
+
+	xi_atomic_inc32(&_g_done);
+	return NULL;
+}
+
+static void *tc_spsc_consumer(void *arg) {
+	xuintptr i, expect = 1;
+	xvoid *item;
+	xuint64 sum = 0;
+
+	UNUSED(arg);
+
+	for (i = 1; i <= TC_QUEUE_ITEMS; i++) {
+		if (_g_blocking) {
+			if (xi_queue_spsc_take(_g_spsc, &item, -1) != XI_QUEUE_RV_OK) {
+				xi_atomic_inc32(&_g_errors);
+				continue;
+			}
+		} else {
+			while (xi_queue_spsc_pop(_g_spsc, &item) != XI_QUEUE_RV_OK) {
+				xi_thread_yield();
+			}
+		}
+		// FIFO
+		if ((xuintptr) item != expect++) {
+			xi_atomic_inc32(&_g_errors);
+		}
+		sum += (xuintptr) item;
+	}
+
+	xi_atomic_add64(&_g_sum, sum);
+	xi_atomic_inc32(&_g_done);
+	return NULL;
+}
+
+static void *tc_mpmc_producer(void *arg) {
+	xuintptr i;
+	xuintptr base = (xuintptr) arg * (TC_QUEUE_ITEMS / TC_QUEUE_PRODUCERS);
+
+	for (i = 1; i <= TC_QUEUE_ITEMS / TC_QUEUE_PRODUCERS; i++) {
+		if (_g_blocking) {
+			if (xi_queue_mpmc_put(_g_mpmc, (xvoid *) (base + i), -1) != XI_QUEUE_RV_OK) {
+				xi_atomic_inc32(&_g_errors);
+			}
+		} else {
+			while (xi_queue_mpmc_push(_g_mpmc, (xvoid *) (base + i)) != XI_QUEUE_RV_OK) {
+				xi_thread_yield();
+			}
+		}
+	}
+
+	xi_atomic_inc32(&_g_done);
+	return NULL;
+}
+
+static void *tc_mpmc_consumer(void *arg) {
+	xuintptr i;
+	xvoid *item;
+	xuint64 sum = 0;
+
+	UNUSED(arg);
+
+	for (i = 0; i < TC_QUEUE_ITEMS / TC_QUEUE_CONSUMERS; i++) {
+		if (_g_blocking) {
+			if (xi_queue_mpmc_take(_g_mpmc, &item, -1) != XI_QUEUE_RV_OK) {
+				xi_atomic_inc32(&_g_errors);
+				continue;
+			}
+		} else {
+			while (xi_queue_mpmc_pop(_g_mpmc, &item) != XI_QUEUE_RV_OK) {
+				xi_thread_yield();
+			}
+		}
+		sum += (xuintptr) item;
+	}
+
+	xi_atomic_add64(&_g_sum, sum);
+	xi_atomic_inc32(&_g_done);
+	return NULL;
+}
+
+static xint32 tc_queue_run(const xchar *title, xbool blocking,
+		xi_thread_fn producer, xint32 nprod, xi_thread_fn consumer, xint32 ncons) {
+	xint32 i, ret;
+	xint64 start, elapsed;
+	xi_thread_t tid;
+
+	_g_blocking = blocking;
+	_g_done = 0;
+	_g_errors = 0;
+	_g_sum = 0;
+
+	start = xi_clock_ntick();
+	for (i = 0; i < nprod + ncons; i++) {
+		ret = xi_thread_create(&tid, "TQUEUE", (i < nprod) ? producer : consumer,
+				(xvoid *) (xintptr) ((i < nprod) ? i : (i - nprod)),
+				256 * 1024, XCFG_THREAD_PRIOR_NORM);
+		if (ret != XI_THREAD_RV_OK) {
+			log_print(XDLOG, "    - result : failed!!! (thread=%d, ret=%d)\n\n", i, ret);
+			return -1;
+		}
+	}
+	while (xi_atomic_read32(&_g_done) < (xuint32) (nprod + ncons)) {
+		xi_thread_usleep(1000);
+	}
+	elapsed = xi_clock_ntick() - start;
+
+	if (_g_errors != 0 || _g_sum != tc_queue_sum(TC_QUEUE_ITEMS)) {
+		log_print(XDLOG, "    - result : failed!!! (%s: errors=%u, sum=%llu)\n\n",
+				title, _g_errors, _g_sum);
+		return -1;
+	}
+
+	log_print(XDLOG, "    - result : pass. (%-16s: %5lld ms, %6lld Kops/s)\n",
+			title, elapsed / 1000000,
+			((xint64) TC_QUEUE_ITEMS * 1000LL) / ((elapsed / 1000) + 1));
+	return 0;
+}
+
+static void tc_info() {
+	log_print(XDLOG, "====================================================\n");
+	log_print(XDLOG, "                     xi_queue.h\n");
+	log_print(XDLOG, "----------------------------------------------------\n");
+	log_print(XDLOG, " * Functions)\n");
+	log_print(XDLOG, "   - xi_queue_spsc_create / destroy\n");
+	log_print(XDLOG, "   - xi_queue_spsc_push / pop / put / take\n");
+	log_print(XDLOG, "   - xi_queue_mpmc_create / destroy\n");
+	log_print(XDLOG, "   - xi_queue_mpmc_push / pop / put / take\n");
+	log_print(XDLOG, " * Test Items)\n");
+	log_print(XDLOG, "   > throughput of %d items\n", TC_QUEUE_ITEMS);
+	log_print(XDLOG, "====================================================\n\n");
+}
+
+int tc_xi_queue() {
+	xint32 t = 1;
+	xchar *tcname = "xi_queue.h";
+
+	xint32 i;
+	xvoid *item;
+	xint64 start, elapsed;
+
+	tc_info();
+
+	log_print(XDLOG, "[%s:%02d] create queues ###############\n", tcname, t++);
+	_g_spsc = xi_queue_spsc_create(TC_QUEUE_SIZE);
+	_g_mpmc = xi_queue_mpmc_create(TC_QUEUE_SIZE);
+	if (_g_spsc == NULL || _g_mpmc == NULL) {
+		log_print(XDLOG, "    - result : failed!!!\n\n");
+		return -1;
+	}
+	log_print(XDLOG, "    - result : pass.\n\n");
+
+	log_print(XDLOG, "[%s:%02d] full / empty ################\n", tcname, t++);
+	for (i = 0; i < TC_QUEUE_SIZE; i++) {
+		if (xi_queue_spsc_push(_g_spsc, NULL) != XI_QUEUE_RV_OK
+				|| xi_queue_mpmc_push(_g_mpmc, NULL) != XI_QUEUE_RV_OK) {
+			log_print(XDLOG, "    - result : failed!!! (push=%d)\n\n", i);
+			return -1;
+		}
+	}
+	if (xi_queue_spsc_push(_g_spsc, NULL) != XI_QUEUE_RV_ERR_FULL
+			|| xi_queue_mpmc_push(_g_mpmc, NULL) != XI_QUEUE_RV_ERR_FULL
+			|| xi_queue_spsc_count(_g_spsc) != TC_QUEUE_SIZE
+			|| xi_queue_mpmc_count(_g_mpmc) != TC_QUEUE_SIZE) {
+		log_print(XDLOG, "    - result : failed!!! (not full)\n\n");
+		return -1;
+	}
+	for (i = 0; i < TC_QUEUE_SIZE; i++) {
+		if (xi_queue_spsc_pop(_g_spsc, &item) != XI_QUEUE_RV_OK
+				|| xi_queue_mpmc_pop(_g_mpmc, &item) != XI_QUEUE_RV_OK) {
+			log_print(XDLOG, "    - result : failed!!! (pop=%d)\n\n", i);
+			return -1;
+		}
+	}
+	if (xi_queue_spsc_pop(_g_spsc, &item) != XI_QUEUE_RV_ERR_EMPTY
+			|| xi_queue_mpmc_pop(_g_mpmc, &item) != XI_QUEUE_RV_ERR_EMPTY) {
+		log_print(XDLOG, "    - result : failed!!! (not empty)\n\n");
+		return -1;
+	}
+	log_print(XDLOG, "    - result : pass.\n\n");
+
+	log_print(XDLOG, "[%s:%02d] take timeout ################\n", tcname, t++);
+	start = xi_clock_ntick();
+	if (xi_queue_mpmc_take(_g_mpmc, &item, 50) != XI_QUEUE_RV_ERR_TIMEOUT) {
+		log_print(XDLOG, "    - result : failed!!!\n\n");
+		return -1;
+	}
+	elapsed = (xi_clock_ntick() - start) / 1000000;
+	if (elapsed < 50) {
+		log_print(XDLOG, "    - result : failed!!! (elapsed=%lldms)\n\n", elapsed);
+		return -1;
+	}
+	log_print(XDLOG, "    - result : pass. (elapsed=%lldms)\n\n", elapsed);
+
+	log_print(XDLOG, "[%s:%02d] throughput ##################\n", tcname, t++);
+	if (tc_queue_run("spsc push/pop", FALSE, tc_spsc_producer, 1, tc_spsc_consumer, 1) != 0
+			|| tc_queue_run("spsc put/take", TRUE, tc_spsc_producer, 1, tc_spsc_consumer, 1) != 0
+			|| tc_queue_run("mpmc push/pop", FALSE, tc_mpmc_producer, TC_QUEUE_PRODUCERS,
+					tc_mpmc_consumer, TC_QUEUE_CONSUMERS) != 0
+			|| tc_queue_run("mpmc put/take", TRUE, tc_mpmc_producer, TC_QUEUE_PRODUCERS,
+					tc_mpmc_consumer, TC_QUEUE_CONSUMERS) != 0) {
+		return -1;
+	}
+	log_print(XDLOG, "\n");
+
+	log_print(XDLOG, "[%s:%02d] destroy queues ##############\n", tcname, t++);
+	if (xi_queue_spsc_destroy(_g_spsc) != XI_QUEUE_RV_OK
+			|| xi_queue_mpmc_destroy(_g_mpmc) != XI_QUEUE_RV_OK) {
+		log_print(XDLOG, "    - result : failed!!!\n\n");
+		return -1;
+	}
+	log_print(XDLOG, "    - result : pass.\n\n");
+
+	log_print(XDLOG, "============ DONE [xi_queue.h] ============\n\n");
+
+	return 0;
+}
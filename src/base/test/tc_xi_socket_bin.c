@@ -0,0 +1,269 @@
+/*
+ * Copyright 2013 Cheolmin Jo (webos21@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * File : tc_xi_socket_bin.c
+ */
+
+#include "xi/xi_socket.h"
+
+#include "xi/xi_clock.h"
+#include "xi/xi_log.h"
+#include "xi/xi_mem.h"
+#include "xi/xi_string.h"
+
+#define TC_BIN_LOOPS 20000
+#define TC_BIN_BURST 64
+
+static xchar _g_txbuf[TC_BIN_BURST][16];
+static xchar _g_rxbuf[TC_BIN_BURST][64];
+
+static xint32 tc_bin_loopback(xi_sock_addr_bin_t *baddr) {
+	xi_sock_addr_t addr = { XI_SOCK_FAMILY_INET, XI_SOCK_TYPE_DATAGRAM,
+			XI_SOCK_PROTO_IP, { '\0' }, 0 };
+
+	xi_strcpy(addr.host, "127.0.0.1");
+	return xi_socket_addr_pton(&addr, baddr);
+}
+
+static xint64 tc_bin_udp_text(xint32 tx, xint32 rx, xi_sock_addr_bin_t *to) {
+	xint32 i;
+	xint64 start;
+	xchar buf[64];
+	xi_sock_addr_t toaddr;
+	xi_sock_addr_t from;
+
+	xi_mem_set(&toaddr, 0, sizeof(toaddr));
+	xi_socket_addr_ntop(to, &toaddr);
+
+	start = xi_clock_ntick();
+	for (i = 0; i < TC_BIN_LOOPS; i++) {
+		if (xi_socket_sendto(tx, "0123456789", 10, toaddr) != 10
+				|| xi_socket_recvfrom(rx, buf, sizeof(buf), &from) != 10) {
+			return -1;
+		}
+	}
+	return (xi_clock_ntick() - start) / TC_BIN_LOOPS;
+}
+
+static xint64 tc_bin_udp_bin(xint32 tx, xint32 rx, xi_sock_addr_bin_t *to) {
+	xint32 i;
+	xint64 start;
+	xchar buf[64];
+	xi_sock_addr_bin_t from;
+
+	start = xi_clock_ntick();
+	for (i = 0; i < TC_BIN_LOOPS; i++) {
+		if (xi_socket_sendto_bin(tx, "0123456789", 10, to) != 10
+				|| xi_socket_recvfrom_bin(rx, buf, sizeof(buf), &from) != 10) {
+			return -1;
+		}
+	}
+	return (xi_clock_ntick() - start) / TC_BIN_LOOPS;
+}
+
+static xint32 tc_bin_burst(xint32 tx, xint32 rx, xi_sock_addr_bin_t *to,
+		xi_sock_addr_bin_t *from, xint32 *calls) {
+	xint32 i, ret, got = 0;
+	xi_sock_msg_t msgs[TC_BIN_BURST];
+
+	for (i = 0; i < TC_BIN_BURST; i++) {
+		xi_snprintf(_g_txbuf[i], sizeof(_g_txbuf[i]), "burst-%02d", i);
+		msgs[i].buf = _g_txbuf[i];
+		msgs[i].blen = xi_strlen(_g_txbuf[i]);
+		msgs[i].len = 0;
+		msgs[i].addr = *to;
+	}
+	ret = xi_socket_sendmmsg(tx, msgs, TC_BIN_BURST);
+	if (ret != TC_BIN_BURST || msgs[TC_BIN_BURST - 1].len != 8) {
+		return -1;
+	}
+
+	*calls = 0;
+	while (got < TC_BIN_BURST) {
+		for (i = 0; i < TC_BIN_BURST - got; i++) {
+			msgs[i].buf = _g_rxbuf[got + i];
+			msgs[i].blen = sizeof(_g_rxbuf[0]);
+		}
+		ret = xi_socket_recvmmsg(rx, msgs, TC_BIN_BURST - got);
+		if (ret <= 0) {
+			return -1;
+		}
+		for (i = 0; i < ret; i++) {
+			if (msgs[i].len != 8
+					|| xi_mem_cmp(msgs[i].buf, _g_txbuf[got + i], 8) != 0
+					|| (from != NULL
+							&& xi_mem_cmp(&msgs[i].addr, from, sizeof(*from)) != 0)) {
+				return -1;
+			}
+		}
+		got += ret;
+		(*calls)++;
+	}
+	return got;
+}
+
+static void tc_info() {
+	log_print(XDLOG, "====================================================\n");
+	log_print(XDLOG, "                 xi_socket.h - bin\n");
+	log_print(XDLOG, "----------------------------------------------------\n");
+	log_print(XDLOG, " * Functions)\n");
+	log_print(XDLOG, "   - xi_socket_addr_pton / ntop\n");
+	log_print(XDLOG, "   - xi_socket_bind_bin\n");
+	log_print(XDLOG, "   - xi_socket_connect_bin / accept_bin\n");
+	log_print(XDLOG, "   - xi_socket_get_local_bin / get_peer_bin\n");
+	log_print(XDLOG, "   - xi_socket_sendto_bin / recvfrom_bin\n");
+	log_print(XDLOG, "   - xi_socket_sendmmsg / recvmmsg\n");
+	log_print(XDLOG, " * Test Items)\n");
+	log_print(XDLOG, "   > udp round-trips of text and binary address\n");
+	log_print(XDLOG, "====================================================\n\n");
+}
+
+int tc_xi_socket_bin() {
+	xint32 t = 1;
+	xchar *tcname = "xi_socket.h";
+
+	xint32 ret, i, calls;
+	xint32 tx, rx, lsn, clt, svr;
+	xchar buf[64];
+	xint64 ns_text, ns_bin, start;
+
+	xi_sock_addr_t addr;
+	xi_sock_addr_bin_t baddr, laddr, taddr, from, peer;
+
+	tc_info();
+
+	log_print(XDLOG, "[%s:%02d] xi_socket_addr_pton / ntop ##\n", tcname, t++);
+	xi_mem_set(&addr, 0, sizeof(addr));
+	addr.family = XI_SOCK_FAMILY_INET6;
+	addr.port = 9876;
+	xi_strcpy(addr.host, "fe80::1:2");
+	if (xi_socket_addr_pton(&addr, &baddr) != XI_SOCK_RV_OK
+			|| baddr.addr[0] != 0xfe || baddr.addr[15] != 2 || baddr.port != 9876) {
+		log_print(XDLOG, "    - result : failed!!! (pton)\n\n");
+		return -1;
+	}
+	xi_mem_set(&addr, 0, sizeof(addr));
+	if (xi_socket_addr_ntop(&baddr, &addr) != XI_SOCK_RV_OK
+			|| xi_strcmp(addr.host, "fe80::1:2") != 0 || addr.port != 9876) {
+		log_print(XDLOG, "    - result : failed!!! (ntop=%s)\n\n", addr.host);
+		return -1;
+	}
+	xi_strcpy(addr.host, "not-an-address");
+	if (xi_socket_addr_pton(&addr, &baddr) != XI_SOCK_RV_ERR_ADDR) {
+		log_print(XDLOG, "    - result : failed!!! (invalid)\n\n");
+		return -1;
+	}
+	log_print(XDLOG, "    - result : pass.\n\n");
+
+	log_print(XDLOG, "[%s:%02d] udp sendto_bin / recvfrom_bin \n", tcname, t++);
+	tx = xi_socket_open(XI_SOCK_FAMILY_INET, XI_SOCK_TYPE_DATAGRAM, XI_SOCK_PROTO_IP);
+	rx = xi_socket_open(XI_SOCK_FAMILY_INET, XI_SOCK_TYPE_DATAGRAM, XI_SOCK_PROTO_IP);
+	if (tx < 0 || rx < 0) {
+		log_print(XDLOG, "    - result : failed!!! (open)\n\n");
+		return -1;
+	}
+	tc_bin_loopback(&baddr);
+	if (xi_socket_bind_bin(rx, &baddr) != XI_SOCK_RV_OK
+			|| xi_socket_bind_bin(tx, &baddr) != XI_SOCK_RV_OK
+			|| xi_socket_get_local_bin(rx, &laddr) != XI_SOCK_RV_OK
+			|| xi_socket_get_local_bin(tx, &taddr) != XI_SOCK_RV_OK
+			|| laddr.port == 0) {
+		log_print(XDLOG, "    - result : failed!!! (bind)\n\n");
+		return -1;
+	}
+	ret = (xint32) xi_socket_sendto_bin(tx, "Hello, BIN!!", 12, &laddr);
+	if (ret != 12) {
+		log_print(XDLOG, "    - result : failed!!! (sendto=%d)\n\n", ret);
+		return -1;
+	}
+	xi_mem_set(buf, 0, sizeof(buf));
+	ret = (xint32) xi_socket_recvfrom_bin(rx, buf, sizeof(buf), &from);
+	if (ret != 12 || xi_strcmp(buf, "Hello, BIN!!") != 0
+			|| xi_mem_cmp(&from, &taddr, sizeof(from)) != 0) {
+		log_print(XDLOG, "    - result : failed!!! (recvfrom=%d)\n\n", ret);
+		return -1;
+	}
+	log_print(XDLOG, "    - result : pass. (port=%d, from=%d)\n\n", laddr.port, from.port);
+
+	log_print(XDLOG, "[%s:%02d] udp round-trip ##############\n", tcname, t++);
+	ns_text = tc_bin_udp_text(tx, rx, &laddr);
+	ns_bin = tc_bin_udp_bin(tx, rx, &laddr);
+	if (ns_text < 0 || ns_bin < 0) {
+		log_print(XDLOG, "    - result : failed!!!\n\n");
+		return -1;
+	}
+	log_print(XDLOG, "    - result : pass. (text=%lld ns/op, bin=%lld ns/op)\n\n",
+			ns_text, ns_bin);
+
+	log_print(XDLOG, "[%s:%02d] udp sendmmsg / recvmmsg ####\n", tcname, t++);
+	ret = tc_bin_burst(tx, rx, &laddr, &taddr, &calls);
+	if (ret != TC_BIN_BURST) {
+		log_print(XDLOG, "    - result : failed!!! (ret=%d)\n\n", ret);
+		return -1;
+	}
+	start = xi_clock_ntick();
+	for (i = 0; i < TC_BIN_LOOPS / TC_BIN_BURST; i++) {
+		xint32 c;
+		if (tc_bin_burst(tx, rx, &laddr, NULL, &c) != TC_BIN_BURST) {
+			log_print(XDLOG, "    - result : failed!!! (loop=%d)\n\n", i);
+			return -1;
+		}
+	}
+	log_print(XDLOG, "    - result : pass. (recv calls=%d, burst=%lld ns/op)\n\n",
+			calls, (xi_clock_ntick() - start) / ((TC_BIN_LOOPS / TC_BIN_BURST) * TC_BIN_BURST));
+	xi_socket_close(tx);
+	xi_socket_close(rx);
+
+	log_print(XDLOG, "[%s:%02d] tcp connect_bin / accept_bin \n", tcname, t++);
+	lsn = xi_socket_open(XI_SOCK_FAMILY_INET, XI_SOCK_TYPE_STREAM, XI_SOCK_PROTO_IP);
+	clt = xi_socket_open(XI_SOCK_FAMILY_INET, XI_SOCK_TYPE_STREAM, XI_SOCK_PROTO_IP);
+	if (lsn < 0 || clt < 0) {
+		log_print(XDLOG, "    - result : failed!!! (open)\n\n");
+		return -1;
+	}
+	tc_bin_loopback(&baddr);
+	if (xi_socket_bind_bin(lsn, &baddr) != XI_SOCK_RV_OK
+			|| xi_socket_listen(lsn, 4) != XI_SOCK_RV_OK
+			|| xi_socket_get_local_bin(lsn, &laddr) != XI_SOCK_RV_OK) {
+		log_print(XDLOG, "    - result : failed!!! (listen)\n\n");
+		return -1;
+	}
+	ret = xi_socket_connect_bin(clt, &laddr);
+	if (ret != XI_SOCK_RV_OK) {
+		log_print(XDLOG, "    - result : failed!!! (connect=%d)\n\n", ret);
+		return -1;
+	}
+	svr = xi_socket_accept_bin(lsn, &from);
+	if (svr < 0 || xi_socket_get_local_bin(clt, &taddr) != XI_SOCK_RV_OK
+			|| xi_mem_cmp(&from, &taddr, sizeof(from)) != 0) {
+		log_print(XDLOG, "    - result : failed!!! (accept=%d)\n\n", svr);
+		return -1;
+	}
+	if (xi_socket_get_peer_bin(clt, &peer) != XI_SOCK_RV_OK
+			|| xi_mem_cmp(&peer, &laddr, sizeof(peer)) != 0) {
+		log_print(XDLOG, "    - result : failed!!! (peer)\n\n");
+		return -1;
+	}
+	log_print(XDLOG, "    - result : pass. (client=%d, from=%d)\n\n", svr, from.port);
+	xi_socket_close(svr);
+	xi_socket_close(clt);
+	xi_socket_close(lsn);
+
+	log_print(XDLOG, "============ DONE [xi_socket.h - bin] ==============\n\n");
+
+	return 0;
+}
@@ -0,0 +1,172 @@
+/*
+ * Copyright 2013 Cheolmin Jo (webos21@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * File : tc_xi_socket_lgroup.c
+ */
+
+#include "xi/xi_socket.h"
+
+#include "xi/xi_atomic.h"
+#include "xi/xi_clock.h"
+#include "xi/xi_log.h"
+#include "xi/xi_string.h"
+#include "xi/xi_thread.h"
+
+#define TC_LG_WORKERS  4
+#define TC_LG_CONNS    2000
+
+static xi_sock_lgroup_t *_g_grp;
+
+static volatile xuint32 _g_stop;
+static volatile xuint32 _g_done;
+static volatile xuint32 _g_total;
+static volatile xuint32 _g_errors;
+static xuint32 _g_accepted[TC_LG_WORKERS];
+
+static void *tc_lg_worker(void *arg) {
+	xint32 id = (xint32) (xintptr) arg;
+	xint32 lfd = xi_socket_lgroup_fd(_g_grp, id);
+	xint32 rsock, nb;
+
+	while (!xi_atomic_read32(&_g_stop)) {
+		rsock = xi_socket_accept4(lfd, NULL,
+				XI_SOCK_ACCEPT_NONBLOCK | XI_SOCK_ACCEPT_CLOEXEC);
+		if (rsock == XI_SOCK_RV_ERR_TRYLATER || rsock == XI_SOCK_RV_ERR_INTR) {
+			xi_thread_usleep(100);
+			continue;
+		}
+		if (rsock < 0) {
+			xi_atomic_inc32(&_g_errors);
+			continue;
+		}
+		// the flag must be there without any xi_socket_opt_set
+		nb = TRUE;
+		if (xi_socket_opt_get(rsock, XI_SOCK_OPT_NONBLOCK, &nb)
+				== XI_SOCK_RV_OK && !nb) {
+			xi_atomic_inc32(&_g_errors);
+		}
+		xi_socket_close(rsock);
+		_g_accepted[id]++;
+		xi_atomic_inc32(&_g_total);
+	}
+
+	xi_atomic_inc32(&_g_done);
+	return NULL;
+}
+
+static void tc_info() {
+	log_print(XDLOG, "====================================================\n");
+	log_print(XDLOG, "              xi_socket.h - lgroup\n");
+	log_print(XDLOG, "----------------------------------------------------\n");
+	log_print(XDLOG, " * Functions)\n");
+	log_print(XDLOG, "   - xi_socket_lgroup_open / count / fd / close\n");
+	log_print(XDLOG, "   - xi_socket_accept4\n");
+	log_print(XDLOG, " * Test Items)\n");
+	log_print(XDLOG, "   > %d connections to %d workers\n", TC_LG_CONNS,
+			TC_LG_WORKERS);
+	log_print(XDLOG, "====================================================\n\n");
+}
+
+int tc_xi_socket_lgroup() {
+	xint32 t = 1;
+	xchar *tcname = "xi_socket.h";
+
+	xint32 i, ret, clt;
+	xint64 start, elapsed;
+	xi_sock_addr_t addr = { XI_SOCK_FAMILY_INET, XI_SOCK_TYPE_STREAM,
+			XI_SOCK_PROTO_TCP, { '\0' }, 0 };
+	xi_sock_addr_bin_t baddr;
+	xi_thread_t tid;
+
+	tc_info();
+
+	log_print(XDLOG, "[%s:%02d] xi_socket_lgroup_open #######\n", tcname, t++);
+	xi_strcpy(addr.host, "127.0.0.1");
+	xi_socket_addr_pton(&addr, &baddr);
+	_g_grp = xi_socket_lgroup_open(&baddr, TC_LG_WORKERS, 128);
+	if (_g_grp == NULL) {
+		log_print(XDLOG, "    - result : failed!!!\n\n");
+		return -1;
+	}
+	for (i = 0; i < TC_LG_WORKERS; i++) {
+		xi_socket_opt_set(xi_socket_lgroup_fd(_g_grp, i), XI_SOCK_OPT_NONBLOCK,
+				TRUE);
+	}
+	xi_socket_get_local_bin(xi_socket_lgroup_fd(_g_grp, 0), &baddr);
+	log_print(XDLOG, "    - result : pass. (listeners=%d, port=%d)\n\n",
+			xi_socket_lgroup_count(_g_grp), baddr.port);
+
+	log_print(XDLOG, "[%s:%02d] accept4 by workers ##########\n", tcname, t++);
+	_g_stop = 0;
+	_g_done = 0;
+	_g_total = 0;
+	_g_errors = 0;
+	for (i = 0; i < TC_LG_WORKERS; i++) {
+		_g_accepted[i] = 0;
+		ret = xi_thread_create(&tid, "TLGROUP", tc_lg_worker,
+				(xvoid *) (xintptr) i, 256 * 1024, XCFG_THREAD_PRIOR_NORM);
+		if (ret != XI_THREAD_RV_OK) {
+			log_print(XDLOG, "    - result : failed!!! (thread=%d, ret=%d)\n\n",
+					i, ret);
+			return -1;
+		}
+	}
+
+	start = xi_clock_ntick();
+	for (i = 0; i < TC_LG_CONNS; i++) {
+		clt = xi_socket_open(XI_SOCK_FAMILY_INET, XI_SOCK_TYPE_STREAM,
+				XI_SOCK_PROTO_TCP);
+		if (clt < 0 || xi_socket_connect_bin(clt, &baddr) != XI_SOCK_RV_OK) {
+			log_print(XDLOG, "    - result : failed!!! (connect=%d)\n\n", i);
+			return -1;
+		}
+		xi_socket_close(clt);
+	}
+	for (i = 0; i < 5000 && xi_atomic_read32(&_g_total) < TC_LG_CONNS; i++) {
+		xi_thread_usleep(1000);
+	}
+	elapsed = xi_clock_ntick() - start;
+
+	xi_atomic_set32(&_g_stop, 1);
+	while (xi_atomic_read32(&_g_done) < TC_LG_WORKERS) {
+		xi_thread_usleep(1000);
+	}
+
+	if (_g_total != TC_LG_CONNS || _g_errors != 0) {
+		log_print(XDLOG, "    - result : failed!!! (accepted=%u, errors=%u)\n\n",
+				_g_total, _g_errors);
+		return -1;
+	}
+	log_print(XDLOG, "    - result : pass. (%lld ms, %lld conns/s)\n",
+			elapsed / 1000000, ((xint64) TC_LG_CONNS * 1000000LL)
+					/ ((elapsed / 1000) + 1));
+	for (i = 0; i < TC_LG_WORKERS; i++) {
+		log_print(XDLOG, "      worker[%d] : %u\n", i, _g_accepted[i]);
+	}
+	log_print(XDLOG, "\n");
+
+	log_print(XDLOG, "[%s:%02d] xi_socket_lgroup_close ######\n", tcname, t++);
+	if (xi_socket_lgroup_close(_g_grp) != XI_SOCK_RV_OK) {
+		log_print(XDLOG, "    - result : failed!!!\n\n");
+		return -1;
+	}
+	log_print(XDLOG, "    - result : pass.\n\n");
+
+	log_print(XDLOG, "============ DONE [xi_socket.h - lgroup] ===========\n\n");
+
+	return 0;
+}
@@ -21,6 +21,7 @@
 #include "xi/xi_thread.h"
 
 #include "xi/xi_log.h"
+#include "xi/xi_mem.h"
 #include "xi/xi_clock.h"
 
 static xi_thread_t _g_tid1;
@@ -28,6 +29,8 @@ static xi_thread_t _g_tid2;
 static xi_thread_cond_t _g_cond;
 static xi_thread_mutex_t _g_mutex;
 
+#define TC_SYNC_OBJECTS 4096
+
 static xbool _g_trun;
 
 static xint32 _g_ecode;
@@ -216,6 +219,9 @@ int tc_xi_thread_basic() {
 	xint32 prior = 0;
 	xint64 ssec = 0;
 	xint64 esec = 0;
+	xint32 i;
+	xi_thread_mutex_t *mtxs;
+	xi_thread_cond_t *cnds;
 
 	tc_info();
 
@@ -263,7 +269,7 @@ int tc_xi_thread_basic() {
 		log_print(XDLOG, "    - result : failed!!! (ret=%d)\n\n", ret);
 		return -1;
 	}
-	log_print(XDLOG, "    - result : pass. (_g_mutex=%d)\n\n", _g_mutex);
+	log_print(XDLOG, "    - result : pass. (_g_mutex=%p)\n\n", (xvoid *) _g_mutex);
 
 	log_print(XDLOG, "[%s:%02d] create control cond #########\n", tcname, t++);
 	ret = xi_thread_cond_create(&_g_cond, "TCOND");
@@ -271,7 +277,40 @@ int tc_xi_thread_basic() {
 		log_print(XDLOG, "    - result : failed!!! (ret=%d)\n\n", ret);
 		return -1;
 	}
-	log_print(XDLOG, "    - result : pass. (_g_cond=%d)\n\n", _g_cond);
+	log_print(XDLOG, "    - result : pass. (_g_cond=%p)\n\n", (xvoid *) _g_cond);
+
+	log_print(XDLOG, "[%s:%02d] create many mutex/cond ######\n", tcname, t++);
+	mtxs = xi_mem_calloc(TC_SYNC_OBJECTS, sizeof(xi_thread_mutex_t));
+	cnds = xi_mem_calloc(TC_SYNC_OBJECTS, sizeof(xi_thread_cond_t));
+	if (mtxs == NULL || cnds == NULL) {
+		log_print(XDLOG, "    - result : failed!!! (no memory)\n\n");
+		return -1;
+	}
+	for (i = 0; i < TC_SYNC_OBJECTS; i++) {
+		ret = xi_thread_mutex_create(&mtxs[i], "TMANY");
+		if (ret != XI_MUTEX_RV_OK) {
+			log_print(XDLOG, "    - result : failed!!! (mutex=%d, ret=%d)\n\n", i, ret);
+			return -1;
+		}
+		ret = xi_thread_cond_create(&cnds[i], "TMANY");
+		if (ret != XI_COND_RV_OK) {
+			log_print(XDLOG, "    - result : failed!!! (cond=%d, ret=%d)\n\n", i, ret);
+			return -1;
+		}
+	}
+	for (i = 0; i < TC_SYNC_OBJECTS; i++) {
+		if (xi_thread_mutex_lock(&mtxs[i]) != XI_MUTEX_RV_OK
+				|| xi_thread_cond_signal(&cnds[i]) != XI_COND_RV_OK
+				|| xi_thread_mutex_unlock(&mtxs[i]) != XI_MUTEX_RV_OK
+				|| xi_thread_cond_destroy(&cnds[i]) != XI_COND_RV_OK
+				|| xi_thread_mutex_destroy(&mtxs[i]) != XI_MUTEX_RV_OK) {
+			log_print(XDLOG, "    - result : failed!!! (index=%d)\n\n", i);
+			return -1;
+		}
+	}
+	xi_mem_free(cnds);
+	xi_mem_free(mtxs);
+	log_print(XDLOG, "    - result : pass. (count=%d)\n\n", TC_SYNC_OBJECTS);
 
 	log_print(XDLOG, "[%s:%02d] create test threads #########\n", tcname, t++);
 	ret = xi_thread_create(&_g_tid1, "TEST_THREAD01", test_thread1, NULL,
@@ -0,0 +1,230 @@
+/*
+ * Copyright 2013 Cheolmin Jo (webos21@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * File : tc_xi_thread_lock.c
+ */
+
+#include "xi/xi_thread.h"
+
+#include "xi/xi_atomic.h"
+#include "xi/xi_clock.h"
+#include "xi/xi_log.h"
+
+#define TC_LOCK_THREADS   4
+#define TC_LOCK_LOOPS     200000
+#define TC_LOCK_WRITE_1OF 16      // 1 write per 16 operations
+
+typedef enum _e_tc_lock_kind {
+	TC_LOCK_MUTEX,
+	TC_LOCK_RWLOCK_MUTEX,
+	TC_LOCK_RWLOCK,
+	TC_LOCK_SEQLOCK
+} tc_lock_kind_e;
+
+static xi_thread_mutex_t _g_mutex;
+static xi_thread_rwlock_t _g_rwlock;
+static xi_thread_seqlock_t _g_seqlock;
+
+static tc_lock_kind_e _g_kind;
+static volatile xuint32 _g_done;
+static volatile xuint32 _g_torn;
+static volatile xuint32 _g_retry;
+
+// the protected data : a and b are always equal out of the critical section
+static volatile xuint64 _g_a;
+static volatile xuint64 _g_b;
+
+static void *tc_lock_worker(void *arg) {
+	xint32 i;
+	xint32 id = (xint32) (xintptr) arg;
+	xuint32 seq, retry = 0;
+	xuint64 a, b;
+
+	for (i = 0; i < TC_LOCK_LOOPS; i++) {
+		xbool write = ((i + id) % TC_LOCK_WRITE_1OF) == 0;
+
+		switch (_g_kind) {
+		case TC_LOCK_MUTEX:
+			// every operation is a write
+			xi_thread_mutex_lock(&_g_mutex);
+			_g_a++;
+			_g_b++;
+			xi_thread_mutex_unlock(&_g_mutex);
+			break;
+		case TC_LOCK_RWLOCK_MUTEX:
+			// read-mostly, but the readers exclude each other
+			xi_thread_mutex_lock(&_g_mutex);
+			if (write) {
+				_g_a++;
+				_g_b++;
+			} else if (_g_a != _g_b) {
+				xi_atomic_inc32(&_g_torn);
+			}
+			xi_thread_mutex_unlock(&_g_mutex);
+			break;
+		case TC_LOCK_RWLOCK:
+			if (write) {
+				xi_thread_rwlock_wrlock(&_g_rwlock);
+				_g_a++;
+				_g_b++;
+			} else {
+				xi_thread_rwlock_rdlock(&_g_rwlock);
+				if (_g_a != _g_b) {
+					xi_atomic_inc32(&_g_torn);
+				}
+			}
+			xi_thread_rwlock_unlock(&_g_rwlock);
+			break;
+		case TC_LOCK_SEQLOCK:
+			if (write) {
+				xi_thread_seqlock_lock(&_g_seqlock);
+				_g_a++;
+				_g_b++;
+				xi_thread_seqlock_unlock(&_g_seqlock);
+			} else {
+				do {
+					seq = xi_thread_seqlock_read_begin(&_g_seqlock);
+					a = _g_a;
+					b = _g_b;
+				} while (xi_thread_seqlock_read_retry(&_g_seqlock, seq) && ++retry);
+				if (a != b) {
+					xi_atomic_inc32(&_g_torn);
+				}
+			}
+			break;
+		}
+	}
+
+	xi_atomic_add32(&_g_retry, retry);
+	xi_atomic_inc32(&_g_done);
+	return NULL;
+}
+
+static xint32 tc_lock_run(const xchar *title, tc_lock_kind_e kind) {
+	xint32 i, ret;
+	xint64 start, elapsed;
+	xuint64 expected;
+	xi_thread_t tid;
+
+	_g_kind = kind;
+	_g_done = 0;
+	_g_torn = 0;
+	_g_retry = 0;
+	_g_a = 0;
+	_g_b = 0;
+
+	start = xi_clock_ntick();
+	for (i = 0; i < TC_LOCK_THREADS; i++) {
+		ret = xi_thread_create(&tid, "TLOCK", tc_lock_worker, (xvoid *) (xintptr) i,
+				256 * 1024, XCFG_THREAD_PRIOR_NORM);
+		if (ret != XI_THREAD_RV_OK) {
+			log_print(XDLOG, "    - result : failed!!! (thread=%d, ret=%d)\n\n", i, ret);
+			return -1;
+		}
+	}
+	while (xi_atomic_read32(&_g_done) < TC_LOCK_THREADS) {
+		xi_thread_usleep(1000);
+	}
+	elapsed = xi_clock_ntick() - start;
+
+	if (kind == TC_LOCK_MUTEX) {
+		expected = (xuint64) TC_LOCK_THREADS * TC_LOCK_LOOPS;
+	} else {
+		expected = (xuint64) TC_LOCK_THREADS * (TC_LOCK_LOOPS / TC_LOCK_WRITE_1OF);
+	}
+	if (_g_a != expected || _g_b != expected || _g_torn != 0) {
+		log_print(XDLOG, "    - result : failed!!! (%s: a=%llu, b=%llu, torn=%u)\n\n",
+				title, _g_a, _g_b, _g_torn);
+		return -1;
+	}
+
+	log_print(XDLOG, "    - result : pass. (%-14s: %4lld ms, %6lld ns/op, retry=%u)\n",
+			title, elapsed / 1000000,
+			elapsed / ((xint64) TC_LOCK_THREADS * TC_LOCK_LOOPS), _g_retry);
+	return 0;
+}
+
+static void tc_info() {
+	log_print(XDLOG, "====================================================\n");
+	log_print(XDLOG, "                xi_thread.h - lock\n");
+	log_print(XDLOG, "----------------------------------------------------\n");
+	log_print(XDLOG, " * Test Items)\n");
+	log_print(XDLOG, "   > contention of %d threads\n", TC_LOCK_THREADS);
+	log_print(XDLOG, "     - mutex (write only)\n");
+	log_print(XDLOG, "     - mutex / rwlock / seqlock (1/%d writes)\n", TC_LOCK_WRITE_1OF);
+	log_print(XDLOG, "====================================================\n\n");
+}
+
+int tc_xi_thread_lock() {
+	xint32 t = 1;
+	xchar *tcname = "xi_thread.h";
+
+	xint32 ret;
+
+	tc_info();
+
+	log_print(XDLOG, "[%s:%02d] create locks ################\n", tcname, t++);
+	ret = xi_thread_mutex_create(&_g_mutex, "TLMUTEX");
+	if (ret != XI_MUTEX_RV_OK) {
+		log_print(XDLOG, "    - result : failed!!! (mutex ret=%d)\n\n", ret);
+		return -1;
+	}
+	ret = xi_thread_rwlock_create(&_g_rwlock, "TLRWLOCK");
+	if (ret != XI_RWLOCK_RV_OK) {
+		log_print(XDLOG, "    - result : failed!!! (rwlock ret=%d)\n\n", ret);
+		return -1;
+	}
+	ret = xi_thread_seqlock_create(&_g_seqlock, "TLSEQLOCK");
+	if (ret != XI_SEQLOCK_RV_OK) {
+		log_print(XDLOG, "    - result : failed!!! (seqlock ret=%d)\n\n", ret);
+		return -1;
+	}
+	log_print(XDLOG, "    - result : pass.\n\n");
+
+	log_print(XDLOG, "[%s:%02d] rwlock try-locks ############\n", tcname, t++);
+	if (xi_thread_rwlock_tryrdlock(&_g_rwlock) != XI_RWLOCK_RV_OK
+			|| xi_thread_rwlock_trywrlock(&_g_rwlock) != XI_RWLOCK_RV_ERR_BUSY
+			|| xi_thread_rwlock_unlock(&_g_rwlock) != XI_RWLOCK_RV_OK
+			|| xi_thread_rwlock_trywrlock(&_g_rwlock) != XI_RWLOCK_RV_OK
+			|| xi_thread_rwlock_unlock(&_g_rwlock) != XI_RWLOCK_RV_OK) {
+		log_print(XDLOG, "    - result : failed!!!\n\n");
+		return -1;
+	}
+	log_print(XDLOG, "    - result : pass.\n\n");
+
+	log_print(XDLOG, "[%s:%02d] contention ##################\n", tcname, t++);
+	if (tc_lock_run("mutex(write)", TC_LOCK_MUTEX) != 0
+			|| tc_lock_run("mutex(read)", TC_LOCK_RWLOCK_MUTEX) != 0
+			|| tc_lock_run("rwlock(read)", TC_LOCK_RWLOCK) != 0
+			|| tc_lock_run("seqlock(read)", TC_LOCK_SEQLOCK) != 0) {
+		return -1;
+	}
+	log_print(XDLOG, "\n");
+
+	log_print(XDLOG, "[%s:%02d] destroy locks ###############\n", tcname, t++);
+	if (xi_thread_seqlock_destroy(&_g_seqlock) != XI_SEQLOCK_RV_OK
+			|| xi_thread_rwlock_destroy(&_g_rwlock) != XI_RWLOCK_RV_OK
+			|| xi_thread_mutex_destroy(&_g_mutex) != XI_MUTEX_RV_OK) {
+		log_print(XDLOG, "    - result : failed!!!\n\n");
+		return -1;
+	}
+	log_print(XDLOG, "    - result : pass.\n\n");
+
+	log_print(XDLOG, "============ DONE [xi_thread.h - lock] =============\n\n");
+
+	return 0;
+}
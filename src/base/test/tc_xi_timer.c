@@ -0,0 +1,152 @@
+/*
+ * Copyright 2013 Cheolmin Jo (webos21@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * File : tc_xi_timer.c
+ */
+
+#include "xi/xi_timer.h"
+
+#include "xi/xi_clock.h"
+#include "xi/xi_log.h"
+#include "xi/xi_thread.h"
+
+#define MAX_TIMERS 10000
+#define MAX_DELAY  1000
+
+static xint64 _g_start;
+static xint32 _g_fired;
+static xint32 _g_early;
+static xint32 _g_repeat;
+
+static void tc_on_timer(xi_timer_t *timer, xint64 tid, xvoid *arg) {
+	xint64 due = (xint64) (xintptr) arg;
+	xint64 elapsed = (xi_clock_ntick() - _g_start) / 1000000;
+
+	UNUSED(timer);
+	UNUSED(tid);
+
+	if (elapsed < due) {
+		_g_early++;
+	}
+	_g_fired++;
+}
+
+static void tc_on_repeat(xi_timer_t *timer, xint64 tid, xvoid *arg) {
+	UNUSED(arg);
+
+	if (++_g_repeat == 5) {
+		xi_timer_cancel(timer, tid);
+	}
+}
+
+static void tc_info() {
+	log_print(XDLOG, "\n\n");
+	log_print(XDLOG, "====================================================\n");
+	log_print(XDLOG, "                     xi_timer.h\n");
+	log_print(XDLOG, "----------------------------------------------------\n");
+	log_print(XDLOG, " * Functions)\n");
+	log_print(XDLOG, "   - xi_timer_create\n");
+	log_print(XDLOG, "   - xi_timer_add\n");
+	log_print(XDLOG, "   - xi_timer_cancel\n");
+	log_print(XDLOG, "   - xi_timer_next / xi_timer_run\n");
+	log_print(XDLOG, "   - xi_timer_destroy\n");
+	log_print(XDLOG, "====================================================\n\n");
+}
+
+int tc_xi_timer() {
+	xint32 t = 1;
+	xchar *tcname = "xi_timer.h";
+
+	xi_timer_t *timer;
+	xint64 tids[MAX_TIMERS];
+	xint64 far;
+	xint32 cnt, canceled, loops;
+
+	tc_info();
+
+	log_print(XDLOG, "[%s:%02d] xi_timer_create #############\n", tcname, t++);
+	timer = xi_timer_create(1);
+	if (timer == NULL) {
+		log_print(XDLOG, "    - result : failed!!!\n\n");
+		return -1;
+	}
+	log_print(XDLOG, "    - result : pass. (timer=%p)\n\n", timer);
+
+	log_print(XDLOG, "[%s:%02d] xi_timer_add ################\n", tcname, t++);
+	_g_start = xi_clock_ntick();
+	for (cnt = 0; cnt < MAX_TIMERS; cnt++) {
+		xint32 delay = (cnt * 7919) % MAX_DELAY;
+		tids[cnt] = xi_timer_add(timer, (xuint32) delay, 0, tc_on_timer,
+				(xvoid *) (xintptr) delay);
+		if (tids[cnt] < 0) {
+			log_print(XDLOG, "    - result : failed!!! (ret=%lld)\n\n", tids[cnt]);
+			return -1;
+		}
+	}
+	if (xi_timer_add(timer, 10, 20, tc_on_repeat, NULL) < 0) {
+		log_print(XDLOG, "    - result : failed!!! (repeat)\n\n");
+		return -1;
+	}
+	far = xi_timer_add(timer, 86400000, 0, tc_on_timer, NULL);
+	log_print(XDLOG, "    - result : pass. (count=%d)\n\n", xi_timer_count(timer));
+
+	log_print(XDLOG, "[%s:%02d] xi_timer_cancel #############\n", tcname, t++);
+	for (cnt = 0, canceled = 0; cnt < MAX_TIMERS; cnt += 2) {
+		if (xi_timer_cancel(timer, tids[cnt]) == XI_TIMER_RV_OK) {
+			canceled++;
+		}
+	}
+	if (canceled != MAX_TIMERS / 2
+			|| xi_timer_cancel(timer, tids[0]) != XI_TIMER_RV_ERR_NF) {
+		log_print(XDLOG, "    - result : failed!!! (canceled=%d)\n\n", canceled);
+		return -1;
+	}
+	log_print(XDLOG, "    - result : pass. (count=%d)\n\n", xi_timer_count(timer));
+
+	log_print(XDLOG, "[%s:%02d] xi_timer_next / run #########\n", tcname, t++);
+	loops = 0;
+	while (xi_timer_count(timer) > 1) {
+		xint32 wait = xi_timer_next(timer);
+		if (wait > 0) {
+			xi_thread_sleep((xuint32) wait);
+		}
+		xi_timer_run(timer);
+		loops++;
+	}
+	if (_g_fired != MAX_TIMERS / 2 || _g_early != 0 || _g_repeat != 5) {
+		log_print(XDLOG, "    - result : failed!!! (fired=%d, early=%d, repeat=%d)\n\n",
+				_g_fired, _g_early, _g_repeat);
+		return -1;
+	}
+	log_print(XDLOG, "    - result : pass. (fired=%d, loops=%d, elapsed=%lldms)\n\n",
+			_g_fired, loops, (xi_clock_ntick() - _g_start) / 1000000);
+
+	log_print(XDLOG, "[%s:%02d] xi_timer_destroy ############\n", tcname, t++);
+	if (xi_timer_cancel(timer, far) != XI_TIMER_RV_OK || xi_timer_next(timer) != -1) {
+		log_print(XDLOG, "    - result : failed!!! (far timer)\n\n");
+		return -1;
+	}
+	if (xi_timer_destroy(timer) != XI_TIMER_RV_OK) {
+		log_print(XDLOG, "    - result : failed!!!\n\n");
+		return -1;
+	}
+	log_print(XDLOG, "    - result : pass.\n\n");
+
+	log_print(XDLOG, "============ DONE [xi_timer.h] ============\n\n");
+
+	return 0;
+}
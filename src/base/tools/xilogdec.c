@@ -0,0 +1,71 @@
+/*
+ * Copyright 2013 Cheolmin Jo (webos21@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * File : xilogdec.c
+ *
+ * Decode a file of the binary log mode (xi_logger_bin_start) into the text.
+ * The format strings are in the file itself, but the byte order and
+ * the pointer size must be the same as the program which recorded it.
+ *
+ * Build : make -C src/base TARGET=<target> tools (or with the test build)
+ * Usage : xilogdec <recorded file> [<text file>]
+ */
+
+#include <stdio.h>
+
+#include "xi/xi_file.h"
+#include "xi/xi_log.h"
+
+int main(int argc, char *argv[]) {
+	xint32 infd, outfd;
+	xi_log_re ret;
+
+	if (argc < 2) {
+		fprintf(stderr, "Usage : %s <recorded file> [<text file>]\n", argv[0]);
+		return 1;
+	}
+
+	infd = xi_file_open(argv[1], XI_FILE_MODE_READ, 0644);
+	if (infd < 0) {
+		fprintf(stderr, "cannot open %s\n", argv[1]);
+		return 1;
+	}
+
+	if (argc > 2) {
+		outfd = xi_file_open(argv[2], XI_FILE_MODE_WRITE | XI_FILE_MODE_CREATE
+				| XI_FILE_MODE_TRUNCATE, 0644);
+		if (outfd < 0) {
+			fprintf(stderr, "cannot open %s\n", argv[2]);
+			xi_file_close(infd);
+			return 1;
+		}
+	} else {
+		outfd = xi_file_get_stdout();
+	}
+
+	ret = xi_logger_bin_decode(infd, outfd);
+	if (ret != XI_LOG_RV_OK) {
+		fprintf(stderr, "cannot decode %s (ret=%d)\n", argv[1], ret);
+	}
+
+	xi_file_close(infd);
+	if (argc > 2) {
+		xi_file_close(outfd);
+	}
+
+	return (ret == XI_LOG_RV_OK) ? 0 : 1;
+}